@@ -5,6 +5,7 @@
 #include <time.h>
 
 #include <openssl/bn.h>
+#include <openssl/crypto.h>
 #include <openssl/asn1.h>
 #include <openssl/asn1t.h>
 #include <openssl/ossl_typ.h>
@@ -18,7 +19,9 @@
 
 /**
  * @brief Classe usada para representar números grandes. 
- * A limitação do tamanho do número depende da memória disponível
+ * A limitação do tamanho do número depende da memória disponível.
+ * As operações com long não criam BigIntegers temporários, e as multiplicações e divisões
+ * usam um BN_CTX reaproveitado por thread.
  */
 class BigInteger
 {
@@ -200,6 +203,19 @@ public:
 	
 	
 	int compare(BigInteger const& a) const throw();
+
+	/**
+	 * Compara o valor com um inteiro, sem criar um BigInteger temporário.
+	 * @param a valor inteiro.
+	 * @return -1, 0 ou 1 se o BigInteger é menor, igual ou maior que a.
+	 * */
+	int compare(long const a) const throw();
+
+	/**
+	 * Troca os valores de dois BigIntegers sem copiá-los.
+	 * @param b referência para objeto BigInteger.
+	 * */
+	void swap(BigInteger& b) throw();
 	
 	/**
 	 * Operador de soma.
@@ -260,6 +276,20 @@ public:
 	
 	
 protected:
+	/**
+	 * Retorna o BN_CTX da thread atual, criado no primeiro uso e liberado quando a thread termina.
+	 * Os BIGNUMs temporários das operações são obtidos dele com BN_CTX_start() e BN_CTX_get().
+	 * @throw BigIntegerException no caso de falta de memória ao criar o BN_CTX.
+	 * */
+	static BN_CTX* getContext() throw(BigIntegerException);
+	static void init();
+	static void freeContext(void *ctx);
+	static unsigned long magnitude(long const a) throw();
+
+	static CRYPTO_ONCE once;
+	static CRYPTO_THREAD_LOCAL context;
+	static bool contextReady;
+
 	BIGNUM* bigInt;
 };
 
@@ -0,0 +1,117 @@
+#ifndef BLOOMFILTER_H_
+#define BLOOMFILTER_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+/**
+ * @brief Filtro de Bloom sobre resumos de 64 bits.
+ * Responde se um valor certamente não pertence ao conjunto ou se talvez
+ * pertença, com uma taxa de falsos positivos escolhida na criação. Usado
+ * para descartar consultas a índices grandes (por exemplo, números de série
+ * de LCRs) sem acessá-los, já que quase todas as consultas são negativas.
+ * As k posições de cada valor vêm das duas metades do resumo (hashing duplo),
+ * de forma que o resumo é calculado uma única vez por consulta.
+ * Depois de preenchido, o filtro pode ser consultado por várias threads; os
+ * contadores de consultas são atualizados atomicamente.
+ * @ingroup Util
+ */
+class BloomFilter
+{
+
+public:
+
+	/**
+	 * Cria um filtro vazio dimensionado para a quantidade de valores e a taxa de falsos positivos.
+	 * @param entries quantidade de valores que serão adicionados.
+	 * @param falsePositiveRate taxa de falsos positivos desejada, entre 0 e 1 (1% usa cerca de 9,6 bits por valor).
+	 * @param maxSizeBits limite do tamanho do filtro em bits; 0 não limita. Se o limite for
+	 * menor que o necessário, a taxa de falsos positivos será maior que a pedida.
+	 */
+	BloomFilter(unsigned long entries, double falsePositiveRate, unsigned long maxSizeBits = 0);
+
+	/**
+	 * Destrutor padrão.
+	 */
+	virtual ~BloomFilter();
+
+	/**
+	 * Adiciona um valor. Não deve ser chamado enquanto outras threads consultam o filtro.
+	 * @param hash resumo do valor, por exemplo obtido por hash().
+	 */
+	void add(uint64_t hash);
+
+	/**
+	 * @param hash resumo do valor.
+	 * @return false se o valor certamente não foi adicionado.
+	 */
+	bool mightContain(uint64_t hash) const;
+
+	/**
+	 * @return tamanho do filtro em bits.
+	 */
+	unsigned long getSizeBits() const;
+
+	/**
+	 * @return quantidade de posições testadas por valor.
+	 */
+	unsigned int getHashCount() const;
+
+	/**
+	 * @return taxa de falsos positivos esperada para a quantidade de valores informada na criação.
+	 */
+	double getFalsePositiveRate() const;
+
+	/**
+	 * @return quantidade de consultas feitas por mightContain().
+	 */
+	uint64_t getLookups() const;
+
+	/**
+	 * @return quantidade de consultas que o filtro descartou (resultado false).
+	 */
+	uint64_t getRejections() const;
+
+	/**
+	 * FNV-1a de 64 bits.
+	 * @param data dados.
+	 * @param length tamanho dos dados.
+	 * @return resumo dos dados.
+	 */
+	static uint64_t hash(const unsigned char *data, unsigned long length);
+
+	/**
+	 * Marca as posições de um valor em um filtro externo, por exemplo gravado em arquivo.
+	 * @param bits filtro, com sizeBits / 8 bytes.
+	 * @param sizeBits tamanho do filtro em bits, múltiplo de 8.
+	 * @param hashes quantidade de posições por valor.
+	 * @param hash resumo do valor.
+	 */
+	static void set(unsigned char *bits, unsigned long sizeBits, unsigned int hashes, uint64_t hash);
+
+	/**
+	 * Testa as posições de um valor em um filtro externo.
+	 * @return false se o valor certamente não foi adicionado.
+	 * @see set()
+	 */
+	static bool test(const unsigned char *bits, unsigned long sizeBits, unsigned int hashes, uint64_t hash);
+
+protected:
+
+	std::vector<unsigned char> bits;
+	unsigned long sizeBits;
+	unsigned int hashes;
+	unsigned long entries;
+	/* contadores de 64 bits, que não estouram em um processo de longa duração; atualizados
+	 * com as operações atômicas do GCC, já que o CRYPTO_atomic_add do OpenSSL 1.1 só trata int */
+	mutable uint64_t lookups;
+	mutable uint64_t rejections;
+
+private:
+
+	BloomFilter(const BloomFilter &);
+	BloomFilter& operator=(const BloomFilter &);
+};
+
+#endif /* BLOOMFILTER_H_ */
@@ -12,6 +12,7 @@
 
 #include "BigInteger.h"
 #include <libcryptosec/exception/CertificationException.h>
+#include <libcryptosec/exception/EncodeException.h>
 
 
 
@@ -22,7 +23,7 @@
 /**
  * @brief Implementa a representação da data.
  * É utilizada em certificados, LCRs.
- * Utiliza o formato epoch (time_t) para representar datas internamente. 
+ * Utiliza o formato epoch em 64 bits para representar datas internamente. 
   */
 class DateTime
 {
@@ -77,8 +78,9 @@ public:
 	 * Cria um objeto DateTime com uma data específica.
 	 * @param utc string no formato UTCTime(YYMMDDHHMMSSZ) ou GeneralizedTime (YYYYMMDDHHMMSSZ).
 	 * Notar que ambos estão no fuso Zulu (GMT+0). 
+	 * @throw EncodeException caso a string não esteja em um dos dois formatos.
 	 */	
-	DateTime(std::string utc) throw(BigIntegerException);
+	DateTime(std::string utc) throw(BigIntegerException, EncodeException);
 	
 	/**
 	 * Destrutor.
@@ -89,7 +91,7 @@ public:
 	 * Obtem representação da data em formato Xml
 	 * @return data em formato Xml
 	 */	
-	std::string getXmlEncoded(std::string tab = "") const throw(BigIntegerException);
+	std::string getXmlEncoded(std::string tab = "") const throw(BigIntegerException, EncodeException);
 
 	/**
 	 * Define a data do objeto DateTime.
@@ -113,25 +115,25 @@ public:
 	 * Obtem data em segundos.
 	 * @return data em segundos. 
 	 */
-	BigInteger const& getSeconds() const throw();
+	BigInteger getSeconds() const throw(BigIntegerException);
 	
 	/**
 	 * Obtem data em formato ASN1.
 	 * @return objeto ASN1_TIME no formato UTCTime se ano inferior a 2050, GeneralizedTime caso contrario.
 	 */
-	ASN1_TIME* getAsn1Time() const throw(BigIntegerException);
+	ASN1_TIME* getAsn1Time() const throw(BigIntegerException, EncodeException);
 	
 	/**
 	* Obtem data em formato ASN1.
 	* @return objeto ASN1_TIME no formato GeneralizedTime (YYYYMMDDHHMMSSZ).
 	*/
-	ASN1_TIME* getGeneralizedTime() const throw(BigIntegerException);
+	ASN1_TIME* getGeneralizedTime() const throw(BigIntegerException, EncodeException);
 	
 	/**
 	* Obtem data em formato ASN1.
 	* @return objeto ASN1_TIME no formato UTCTime (YYMMDDHHMMSSZ).
 	*/
-	ASN1_TIME* getUTCTime() const throw(BigIntegerException);
+	ASN1_TIME* getUTCTime() const throw(BigIntegerException, EncodeException);
 			
 	/**
 	 * Obtem data em formato ISO8601.
@@ -150,67 +152,14 @@ public:
 	 * @param epoch referência para segundos.
 	 * @return estrutura com ano, mês, dia, hora, minuto e segundo.
 	 * */
-	static DateTime::DateVal getDate(BigInteger const& epoch) throw(BigIntegerException)
-	{
-		const long SECS_DAY = 86400L;
-		DateTime::DateVal ret;							
-		BigInteger yearsSinceEpoch(0L);
-		BigInteger leapDays(0L);
-		BigInteger daysSinceEpoch(0L);		
-		BigInteger tmp;			
-		BigInteger hours(epoch);
-		BigInteger days(epoch);
-		int dayOfYear;
-		int sizeOfMonth;
-		
-		hours.mod(SECS_DAY);
-		days.div(SECS_DAY);
-		
-		tmp = hours % 60;
-		ret.sec = static_cast<int>(tmp.getValue());
-					
-		tmp = (hours % 3600).div(60);
-		ret.min = static_cast<int>(tmp.getValue());
-		
-		hours.div(3600);
-		ret.hour = static_cast<int>(hours.getValue());
-		
-		ret.year = 1970;
-		//remover
-		//int anos = 0;
-		//BigInteger sum(0L);
-		//cout << "days inicial " <<days.toDec() << endl;
-		//
-		while(days >= DateTime::getYearSize(ret.year))
-		{
-			days.sub(DateTime::getYearSize(ret.year));
-			ret.year++;
-			
-			//remover
-			//anos++;
-			//sum.add(DateTime::getYearSize(ret.year));
-		}
-		//cout << "sum "<< sum.toDec() << endl;
-		//cout << "days restantes " << days.toDec() << endl;
-		//cout << "anos" << anos << endl;
-		
-		ret.dayOfYear = static_cast<int>(days.getValue());
-		dayOfYear = ret.dayOfYear;
-		
-		ret.mon = 0;
-		sizeOfMonth = DateTime::getMonthSize(ret.mon, ret.year);
-		while(dayOfYear >= sizeOfMonth)
-		{
-			dayOfYear-= sizeOfMonth;
-			ret.mon++;
-			sizeOfMonth = DateTime::getMonthSize(ret.mon, ret.year);
-		}
-		ret.dayOfMonth = dayOfYear + 1;
-		
-		ret.dayOfWeek = DateTime::getDayOfWeek(ret.year, ret.mon, ret.dayOfMonth);
-		
-		return ret;
-	}
+	static DateTime::DateVal getDate(BigInteger const& epoch) throw(BigIntegerException);
+
+	/**
+	 * Transforma do formato em segundos (epoch) para ano, mês, dia, hora, minuto e segundo.
+	 * @param epoch segundos, inclusive anteriores a 1970.
+	 * @return estrutura com ano, mês, dia, hora, minuto e segundo.
+	 * */
+	static DateTime::DateVal getDate(long long epoch) throw();
 /*	{
 		int daysOfMonths[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
 		DateTime::DateVal ret;				
@@ -351,100 +300,53 @@ public:
 	 * Transforma de formato UTCTime(YYMMDDHHMMSSZ) ou GeneralizedTime (YYYYMMDDHHMMSSZ) para epoch(segundos).
 	 * @param aString string no formato 'YYMMDDHHMMSSZ' ou 'YYYYMMDDHHMMSSZ'.
 	 * return segundos.
+	 * @throw EncodeException caso a string não esteja em um dos dois formatos.
 	 * */
-	static BigInteger date2epoch(string aString) throw(BigIntegerException)
-	{
-		int year;
-		int month; //[0-11]
-		int day; //[1-31]
-		int hour; //[0-23]
-		int min; //[0-59]
-		int sec; //[0-59]  + leap second?	
-		bool utc = false;
-		istringstream stream;
-		int gtoffset = 0; //deslocamento adicionar para substring se for generalizedtime
-		
-		utc = aString.size() == 13;
-		
-		//year
-		if(utc)
-		{
-			stream.str(aString.substr(0,2));
-			stream >> year;
-			
-			if(year >= 50)
-			{
-				year+= 1900;
-			}
-			else
-			{
-				year+= 2000;
-			}			
-		}
-		else //gt
-		{
-			stream.str(aString.substr(0,4));
-			stream >> year;
-			gtoffset = 2;
-		}
-		
-		//month
-		stream.clear();
-		stream.str(aString.substr(2 + gtoffset,2));
-		stream >> month;
-		month--;
-			
-		//day
-		stream.clear();
-		stream.str(aString.substr(4 + gtoffset,2));
-		stream >> day;
-		
-		//hour
-		stream.clear();
-		stream.str(aString.substr(6 + gtoffset,2));
-		stream >> hour;
-		
-		//min
-		stream.clear();
-		stream.str(aString.substr(8 + gtoffset,2));
-		stream >> min;
-		
-		//sec
-		stream.clear();
-		stream.str(aString.substr(10 + gtoffset,2));
-		stream >> sec;
-
-		return date2epoch(year, month, day, hour, min, sec);
-	}
+	static BigInteger date2epoch(string aString) throw(BigIntegerException, EncodeException);
 	
 	/**
 	 * Transforma do formato ano, mês [0-11], dia [1-31], hora [0-23], minuto [0-59] e segundo [0-59] (Zulu/GMT+0) para epoch.
 	 * @return segundos.
 	 * */	
-	static BigInteger date2epoch(int year, int month, int day, int hour, int min, int sec) throw(BigIntegerException)
-	{
-		BigInteger ret(0L);
-		
-		for(int i = 1970; i < year; i++)
-		{
-			ret.add(DateTime::getYearSize(i));
-		}
-		
-		for(int i = 0 ; i < month ; i ++)
-		{
-			ret.add(DateTime::getMonthSize(i, year));
-		}
-		
-		ret.add(day - 1);	
-		ret.mul(24);
-		ret.add(hour);
-		ret.mul(60);
-		ret.add(min);
-		ret.mul(60);
-		ret.add(sec);
-			
-		return ret;
-	}
+	static BigInteger date2epoch(int year, int month, int day, int hour, int min, int sec) throw(BigIntegerException);
+
+	/**
+	 * Retorna a quantidade de dias desde 1 de Janeiro de 1970 no calendário gregoriano proléptico.
+	 * @param year ano.
+	 * @param month mês [0-11].
+	 * @param day dia [1-31].
+	 * @return dias, negativo para datas anteriores a 1970.
+	 * */
+	static long long getDaysSinceEpoch(int year, int month, int day) throw();
+
+	/**
+	 * Lê uma data no formato UTCTime (YYMMDDHHMMSSZ) ou GeneralizedTime (YYYYMMDDHHMMSSZ),
+	 * conforme o tamanho, sem passar pelo OpenSSL.
+	 * No UTCTime, anos de 50 a 99 são de 1900 (RFC 5280).
+	 * @param data caracteres da data.
+	 * @param length quantidade de caracteres: 13 para UTCTime, 15 para GeneralizedTime.
+	 * @param epoch recebe a data em segundos.
+	 * @return false se a data não está em um dos dois formatos ou tem algum campo inválido.
+	 * */
+	static bool parseTime(const char *data, unsigned long length, long long &epoch) throw();
+
+	/**
+	 * Escreve uma data no formato UTCTime (YYMMDDHHMMSSZ) ou GeneralizedTime (YYYYMMDDHHMMSSZ).
+	 * @param epoch data em segundos.
+	 * @param utcTime true para UTCTime, que só guarda os dois últimos dígitos do ano.
+	 * @param out buffer com pelo menos 16 caracteres; recebe a data terminada em '\0'.
+	 * @return quantidade de caracteres escritos: 13 ou 15.
+	 * @throw EncodeException caso o ano esteja fora de 1950 a 2049 no UTCTime ou de 0 a 9999 no GeneralizedTime.
+	 * */
+	static unsigned int formatTime(long long epoch, bool utcTime, char *out) throw(EncodeException);
+
+	/**
+	 * Verifica se uma data deve ser codificada como UTCTime, o que a RFC 5280 exige
+	 * para os anos de 1950 a 2049.
+	 * @param epoch data em segundos.
+	 * @return true para UTCTime, false para GeneralizedTime.
+	 * */
+	static bool isUTCTime(long long epoch) throw();
 	
 	/***
 	 * Retorna o dia da semana dados ano, mês [0-11] e dia [1-31].
@@ -568,8 +470,9 @@ public:
 protected:
 	/*
 	 * Segundos desde  00:00:00 on January 1, 1970, Coordinated Universal Time (UTC).
+	 * 64 bits cobrem todo o intervalo do GeneralizedTime.
 	 * */
-	BigInteger seconds;
+	long long seconds;
 };
 
 #endif /*DATETIME_H_*/
@@ -6,6 +6,7 @@
 #include "ByteArray.h"
 #include "KeyPair.h"
 #include "ec/EllipticCurve.h"
+#include "ec/EllipticCurveRegistry.h"
 #include "Base64.h"
 
 #include <libcryptosec/exception/EngineException.h>
@@ -43,8 +44,9 @@ public:
 			throw (AsymmetricKeyException);
 
 	/**
-	 * Cria par por parãmetros informados por um objeto Curve
-	 * TODO
+	 * Cria par por parãmetros informados por um objeto Curve.
+	 * O grupo da curva é obtido do EllipticCurveRegistry, sendo construído e
+	 * pré-computado somente no primeiro uso da curva no processo.
 	 */
 	ECDSAKeyPair(const EllipticCurve & curve)
 			throw (AsymmetricKeyException);
@@ -71,7 +73,11 @@ public:
 			throw (AsymmetricKeyException);
 
 protected:
-	void generateKey(EC_GROUP * group) throw (AsymmetricKeyException);
+	void generateKey(const EC_GROUP * group) throw (AsymmetricKeyException);
+	/**
+	 * Cria uma cópia, que deve ser liberada pelo chamador, do grupo compartilhado da curva
+	 * @see EllipticCurveRegistry
+	 */
 	EC_GROUP *createGroup(const EllipticCurve& curve);
 	EC_GROUP *createGroup(ByteArray &derEncoded);
 };
@@ -37,6 +37,18 @@ class KeyPair
 		//TODO Este construtor deve é obsoleto. Devem ser usados os construtores das classes especializadas RSAKeyPair, DSAKeyPair e ECDSAKeyPair
 		KeyPair(AsymmetricKey::Algorithm algorithm, int length)
 				throw (AsymmetricKeyException);
+
+		/**
+		 * create a RSA KeyPair object, creating a new (possibly multi-prime) key pair
+		 * @param algorithm key pair algorithm, must be AsymmetricKey::RSA
+		 * @param length key lenght
+		 * @param primes number of primes of the modulus (2, 3 or 4)
+		 * @param parallel if true, the primes are searched concurrently
+		 * @throws AsymmetricKeyException if the key cannot be created or the algorithm is not RSA
+		 * @see RSAKeyPair::RSAKeyPair(int, int, RSAKeyPair::GenerationMode)
+		 */
+		KeyPair(AsymmetricKey::Algorithm algorithm, int length, int primes, bool parallel)
+				throw (AsymmetricKeyException);
 		
 		KeyPair(Engine *engine, std::string keyId)
 				throw (EngineException);
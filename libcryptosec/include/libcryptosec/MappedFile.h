@@ -0,0 +1,51 @@
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <string>
+
+#include <libcryptosec/exception/EncodeException.h>
+
+/**
+ * @brief Arquivo mapeado em memória somente para leitura.
+ * Permite que certificados e LCRs sejam lidos diretamente das páginas do
+ * arquivo, sem cópia para um buffer intermediário. O mapeamento é desfeito
+ * no destrutor; ponteiros obtidos por getData() não devem ser usados depois disso.
+ * @ingroup Util
+ */
+class MappedFile
+{
+
+public:
+
+	/**
+	 * Mapeia o arquivo inteiro em memória.
+	 * @param path caminho do arquivo.
+	 * @throw EncodeException caso o arquivo não possa ser aberto ou mapeado.
+	 */
+	MappedFile(std::string path) throw (EncodeException);
+
+	/**
+	 * Destrutor padrão, desfaz o mapeamento.
+	 */
+	virtual ~MappedFile();
+
+	/**
+	 * @return ponteiro para o início do conteúdo do arquivo ou NULL se o arquivo estiver vazio.
+	 */
+	const unsigned char* getData() const;
+
+	/**
+	 * @return tamanho do arquivo em bytes.
+	 */
+	unsigned long getSize() const;
+
+private:
+
+	MappedFile(const MappedFile &);
+	MappedFile& operator=(const MappedFile &);
+
+	unsigned char *data;
+	unsigned long size;
+};
+
+#endif /* MAPPEDFILE_H_ */
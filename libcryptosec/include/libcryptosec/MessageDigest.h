@@ -141,6 +141,16 @@ public:
 	 * @return objeto EVP_MD referente ao algoritmo passado.
 	 */
 	static const EVP_MD* getMessageDigest(MessageDigest::Algorithm algorithm);
+
+	/**
+	 * Retorna o algoritmo de resumo a usar em uma assinatura com a chave dada.
+	 * Chaves que assinam a mensagem inteira, como as EdDSA, não aceitam um resumo
+	 * separado; para elas o retorno é NULL, qualquer que seja o algoritmo pedido.
+	 * @param algorithm algoritmo de resumo pedido pelo chamador.
+	 * @param key chave de assinatura.
+	 * @return objeto EVP_MD a passar para EVP_DigestSignInit(), ou NULL.
+	 */
+	static const EVP_MD* getMessageDigest(MessageDigest::Algorithm algorithm, EVP_PKEY *key);
 	
 	/**
 	 * Obtem algoritmo de resumo a partir do identificador numérico do algoritmo no OpenSSL
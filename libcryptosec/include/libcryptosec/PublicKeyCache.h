@@ -0,0 +1,132 @@
+#ifndef PUBLICKEYCACHE_H_
+#define PUBLICKEYCACHE_H_
+
+/* c++ library includes */
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+/* OpenSSL includes */
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#include "ByteArray.h"
+
+/**
+ * @brief Cache LRU de chaves públicas decodificadas.
+ * As chaves são indexadas pelo SHA-256 da estrutura SubjectPublicKeyInfo
+ * codificada em DER, de forma que a mesma chave recebida várias vezes como
+ * bytes (de configuração, de um protocolo ou de um banco de dados) é
+ * decodificada uma só vez e compartilhada como um único EVP_PKEY imutável.
+ * Chaves de certificados e LCRs já decodificados não devem passar pelo cache:
+ * o OpenSSL decodifica a chave junto com a estrutura, e X509_get0_pubkey não
+ * tem custo.
+ * O cache é dividido em partições (shards), cada uma com sua própria trava
+ * e sua própria lista LRU, para que threads distintas raramente disputem
+ * a mesma trava. A capacidade total é repartida igualmente entre as partições.
+ * Os ponteiros retornados são novas referências (EVP_PKEY_up_ref) e devem ser
+ * liberados pelo chamador com EVP_PKEY_free.
+ * @ingroup AsymmetricKeys
+ */
+class PublicKeyCache
+{
+
+public:
+
+	/**
+	 * Estatísticas acumuladas do cache.
+	 */
+	struct Stats
+	{
+		unsigned long hits;
+		unsigned long misses;
+		unsigned long evictions;
+		unsigned long size;
+	};
+
+	/**
+	 * Cria um cache vazio.
+	 * @param capacity número máximo de chaves mantidas.
+	 * @param shards número de partições independentes.
+	 */
+	PublicKeyCache(unsigned int capacity = 1024, unsigned int shards = 16);
+
+	/**
+	 * Destrutor padrão, libera todas as chaves armazenadas.
+	 */
+	virtual ~PublicKeyCache();
+
+	/**
+	 * Obtém a chave de um SubjectPublicKeyInfo codificado em DER, decodificando-a e
+	 * armazenando-a caso ainda não esteja no cache.
+	 * @param derEncoded SubjectPublicKeyInfo codificado em DER.
+	 * @param length tamanho da codificação.
+	 * @return nova referência para a chave ou NULL caso a chave não possa ser decodificada.
+	 */
+	EVP_PKEY* get(const unsigned char *derEncoded, unsigned long length);
+
+	/**
+	 * Obtém a chave de um SubjectPublicKeyInfo codificado em DER.
+	 * @param derEncoded SubjectPublicKeyInfo codificado em DER, como em PublicKey(ByteArray&).
+	 * @return nova referência para a chave ou NULL caso a chave não possa ser decodificada.
+	 */
+	EVP_PKEY* get(ByteArray &derEncoded);
+
+	/**
+	 * @return estatísticas acumuladas de todas as partições.
+	 */
+	Stats getStats();
+
+	/**
+	 * @return capacidade total do cache.
+	 */
+	unsigned int getCapacity() const;
+
+	/**
+	 * Remove todas as chaves do cache e zera as estatísticas.
+	 */
+	void clear();
+
+	/**
+	 * @return o cache compartilhado pelo processo.
+	 */
+	static PublicKeyCache& getDefault();
+
+private:
+
+	struct Entry
+	{
+		std::string key;
+		EVP_PKEY *pkey;
+	};
+
+	struct Shard
+	{
+		CRYPTO_RWLOCK *lock;
+		std::list<Entry> entries;
+		std::map<std::string, std::list<Entry>::iterator> index;
+		unsigned long hits;
+		unsigned long misses;
+		unsigned long evictions;
+	};
+
+	PublicKeyCache(const PublicKeyCache &);
+	PublicKeyCache& operator=(const PublicKeyCache &);
+
+	Shard& getShard(const std::string &key);
+	EVP_PKEY* find(Shard &shard, const std::string &key);
+	EVP_PKEY* insert(Shard &shard, const std::string &key, EVP_PKEY *pkey);
+
+	static std::string getKey(const unsigned char *derEncoded, unsigned long length);
+	static void init();
+
+	std::vector<Shard*> shards;
+	unsigned int shardCapacity;
+
+	static CRYPTO_ONCE once;
+	static PublicKeyCache *defaultCache;
+};
+
+#endif /* PUBLICKEYCACHE_H_ */
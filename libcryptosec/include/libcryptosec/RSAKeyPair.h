@@ -2,6 +2,7 @@
 #define RSAKEYPAIR_H_
 
 #include <openssl/evp.h>
+#include <openssl/rsa.h>
 #include "ByteArray.h"
 #include "SymmetricKey.h"
 #include "KeyPair.h"
@@ -22,6 +23,18 @@
 class RSAKeyPair : public KeyPair
 {
 	public:
+		/**
+		 * How the primes of a new key pair are searched.
+		 * SEQUENTIAL searches one prime after the other on the calling thread.
+		 * PARALLEL searches every prime concurrently on its own thread, cancelling
+		 * the remaining searches as soon as one of them fails.
+		 */
+		enum GenerationMode
+		{
+			SEQUENTIAL,
+			PARALLEL,
+		};
+
 		/**
 		 * create a RSAKeyPair object, creating a new key pair
 
@@ -30,6 +43,17 @@ class RSAKeyPair : public KeyPair
 		 */
 		RSAKeyPair(int length)
 				throw (AsymmetricKeyException);
+
+		/**
+		 * create a RSAKeyPair object, creating a new (possibly multi-prime) key pair
+		 * @param length key lenght
+		 * @param primes number of primes of the modulus (2, 3 or 4)
+		 * @param mode prime search mode
+		 * @throws AsymmetricKeyException if the key cannot be created or the number of primes
+		 * is not supported for this key length
+		 */
+		RSAKeyPair(int length, int primes, RSAKeyPair::GenerationMode mode = RSAKeyPair::SEQUENTIAL)
+				throw (AsymmetricKeyException);
 		
 		virtual ~RSAKeyPair();
 		/**
@@ -57,6 +81,37 @@ class RSAKeyPair : public KeyPair
 		 * gets the key size
 		 * @return key size
 		 */
+
+		/**
+		 * gets the number of primes of the key modulus
+		 * @return number of primes (2 for a conventional RSA key)
+		 */
+		int getPrimesNumber()
+				throw (AsymmetricKeyException);
+
+		/**
+		 * gets the maximum number of primes supported for a modulus of the given length.
+		 * Follows the limits imposed by OpenSSL for interoperable multi-prime keys.
+		 * @param length key lenght
+		 * @return maximum number of primes
+		 */
+		static int getMaxPrimesNumber(int length);
+
+		/**
+		 * generates a new RSA key
+		 * @param length key lenght
+		 * @param primes number of primes of the modulus
+		 * @param mode prime search mode
+		 * @return the new key. The caller is responsible for freeing it
+		 * @throws AsymmetricKeyException if the key cannot be created
+		 */
+		static RSA* generateKey(int length, int primes, RSAKeyPair::GenerationMode mode)
+				throw (AsymmetricKeyException);
+
+	protected:
+		static RSA* generateKeyParallel(int length, int primes)
+				throw (AsymmetricKeyException);
+		static RSA* buildKey(BIGNUM **primes, int nprimes, const BIGNUM *e);
 };
 
 #endif /*RSAKEYPAIR_H_*/
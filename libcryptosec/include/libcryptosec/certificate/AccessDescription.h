@@ -11,6 +11,12 @@ public:
 	AccessDescription(ACCESS_DESCRIPTION *accessDescription);
 	virtual ~AccessDescription();
 	ACCESS_DESCRIPTION* getAccessDescription();
+
+	/**
+	 * Escreve a descrição de acesso em DER.
+	 */
+	void encode(DerWriter &writer) const;
+	void write(DocumentWriter &writer);
 	GeneralName getAccessLocation();
 	ObjectIdentifier getAccessMethod();
 	void setAccessLocation(GeneralName accessLocation);
@@ -34,6 +34,8 @@ public:
 	long getAuthorityCertSerialNumber();
 	X509_EXTENSION* getX509Extension();
 protected:
+	virtual void encodeValue(DerWriter &writer);
+	virtual void writeValue(DocumentWriter &writer);
 	ByteArray keyIdentifier;
 	GeneralNames authorityCertIssuer;
 	long serialNumber;
@@ -23,6 +23,8 @@ public:
 	long getPathLen();
 	X509_EXTENSION* getX509Extension();
 protected:
+	virtual void encodeValue(DerWriter &writer);
+	virtual void writeValue(DocumentWriter &writer);
 	bool ca;
 	long pathLen;
 };
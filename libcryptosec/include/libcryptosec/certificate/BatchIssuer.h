@@ -0,0 +1,304 @@
+#ifndef BATCHISSUER_H_
+#define BATCHISSUER_H_
+
+#include <openssl/evp.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <deque>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <libcryptosec/BigInteger.h>
+#include <libcryptosec/DateTime.h>
+
+#include "CertificateRequest.h"
+#include "Extension.h"
+#include "IssuanceTemplate.h"
+
+#include <libcryptosec/exception/CertificationException.h>
+#include <libcryptosec/exception/EncodeException.h>
+
+/**
+ * @brief Emissão de certificados em lote a partir de requisições.
+ * As requisições codificadas são lidas de uma fonte pela thread que chama
+ * issue() e processadas por várias threads: cada uma decodifica a requisição,
+ * verifica sua assinatura, aplica a política de emissão e assina o certificado
+ * com um IssuanceTemplate, usando um contexto de assinatura próprio. Os
+ * certificados são entregues ao destino na ordem das requisições, pela thread
+ * que chama issue().
+ * A quantidade de requisições em andamento (lidas e ainda não entregues) é
+ * limitada: quando o limite é atingido a leitura espera, de forma que uma
+ * fonte rápida ou um destino lento não acumulam requisições em memória.
+ * @see IssuanceTemplate
+ */
+class BatchIssuer
+{
+
+public:
+
+	enum Format
+	{
+		DER,
+		PEM,
+	};
+
+	/**
+	 * Resultado do processamento de uma requisição.
+	 */
+	enum Status
+	{
+		ISSUED,
+		INVALID_REQUEST,
+		INVALID_SIGNATURE,
+		REFUSED,
+		FAILED,
+	};
+
+	/**
+	 * Campos próprios de um certificado, definidos pela política.
+	 */
+	struct Issuance
+	{
+		BigInteger serialNumber;
+		DateTime notBefore;
+		DateTime notAfter;
+		/* extensões próprias do certificado, liberadas pelo BatchIssuer depois da assinatura */
+		std::vector<Extension *> extensions;
+	};
+
+	/**
+	 * Contadores e tempos de um lote. Os tempos das etapas feitas em paralelo
+	 * (decodificação, verificação, política e assinatura) somam os tempos de todas as threads.
+	 */
+	struct Metrics
+	{
+		unsigned long read;
+		unsigned long issued;
+		unsigned long invalidRequest;
+		unsigned long invalidSignature;
+		unsigned long refused;
+		unsigned long failed;
+		/* vezes em que a leitura parou porque o limite de requisições em andamento foi atingido,
+		 * uma por bloqueio, por mais que a espera dure */
+		unsigned long stalls;
+		double readMs;
+		double decodeMs;
+		double verifyMs;
+		double policyMs;
+		double signMs;
+		double writeMs;
+		double totalMs;
+	};
+
+	/**
+	 * Fonte das requisições de um lote. As requisições são entregues codificadas
+	 * e decodificadas pelas threads de processamento.
+	 */
+	class Source
+	{
+	public:
+		virtual ~Source() {}
+
+		/**
+		 * @param request recebe a próxima requisição, codificada em DER ou PEM.
+		 * @return false no fim do lote.
+		 */
+		virtual bool next(std::string &request) = 0;
+	};
+
+	/**
+	 * Política de emissão. É chamada por várias threads ao mesmo tempo.
+	 */
+	class Policy
+	{
+	public:
+		virtual ~Policy() {}
+
+		/**
+		 * Define os campos do certificado de uma requisição com assinatura válida.
+		 * @param index posição da requisição no lote, a partir de 0.
+		 * @param request requisição.
+		 * @param issuance recebe o número de série, a validade e as extensões do certificado.
+		 * @return false para recusar a requisição. Uma exceção termina a requisição com FAILED,
+		 * sem interromper o lote.
+		 */
+		virtual bool apply(unsigned long index, CertificateRequest &request, Issuance &issuance) = 0;
+	};
+
+	/**
+	 * Destino dos certificados de um lote. É chamado pela thread que chama issue(),
+	 * na ordem das requisições.
+	 */
+	class Sink
+	{
+	public:
+		virtual ~Sink() {}
+
+		/**
+		 * @param index posição da requisição no lote, a partir de 0.
+		 * @param request requisição; NULL se status for INVALID_REQUEST.
+		 * @param status resultado do processamento.
+		 * @param certificate certificado codificado no formato do BatchIssuer; vazio se status não for ISSUED.
+		 */
+		virtual void write(unsigned long index, CertificateRequest *request, Status status, const std::string &certificate) = 0;
+	};
+
+	/**
+	 * Lê requisições codificadas em PEM de um fluxo, uma a uma.
+	 * Blocos que não são requisições são ignorados.
+	 */
+	class StreamSource : public Source
+	{
+	public:
+		StreamSource(std::istream &in);
+		virtual ~StreamSource();
+
+		/**
+		 * @throw EncodeException caso o fluxo termine no meio de um bloco de requisição.
+		 */
+		virtual bool next(std::string &request);
+
+	protected:
+		std::istream &in;
+	};
+
+	/**
+	 * Política que numera os certificados em sequência e usa a mesma validade para todos.
+	 */
+	class SequentialPolicy : public Policy
+	{
+	public:
+		/**
+		 * @param firstSerialNumber número de série do certificado da primeira requisição do lote.
+		 * @param notBefore início da validade.
+		 * @param notAfter fim da validade.
+		 */
+		SequentialPolicy(const BigInteger &firstSerialNumber, const DateTime &notBefore, const DateTime &notAfter);
+		virtual ~SequentialPolicy();
+		virtual bool apply(unsigned long index, CertificateRequest &request, Issuance &issuance);
+
+	protected:
+		BigInteger firstSerialNumber;
+		DateTime notBefore;
+		DateTime notAfter;
+	};
+
+	/**
+	 * Escreve os certificados emitidos em um fluxo, um após o outro.
+	 * Requisições que não resultaram em certificado são apenas contadas.
+	 */
+	class StreamSink : public Sink
+	{
+	public:
+		StreamSink(std::ostream &out);
+		virtual ~StreamSink();
+		virtual void write(unsigned long index, CertificateRequest *request, Status status, const std::string &certificate);
+
+		/**
+		 * @return quantidade de requisições que não resultaram em certificado.
+		 */
+		unsigned long getRejected() const;
+
+	protected:
+		std::ostream &out;
+		unsigned long rejected;
+	};
+
+	/**
+	 * Cria um emissor que usa uma thread por processador e formato DER.
+	 * @param issuanceTemplate modelo com os campos invariantes e a chave do emissor; deve existir
+	 * enquanto o emissor for usado.
+	 * @param policy política de emissão; deve existir enquanto o emissor for usado.
+	 */
+	BatchIssuer(IssuanceTemplate &issuanceTemplate, Policy &policy);
+
+	/**
+	 * Destrutor padrão.
+	 */
+	virtual ~BatchIssuer();
+
+	/**
+	 * @param threads número de threads de processamento; 0 usa uma por processador.
+	 */
+	void setThreads(unsigned int threads);
+
+	/**
+	 * @param queueSize limite de requisições em andamento; 0 usa quatro por thread.
+	 */
+	void setQueueSize(unsigned int queueSize);
+
+	/**
+	 * @param format formato dos certificados entregues ao destino.
+	 */
+	void setFormat(BatchIssuer::Format format);
+
+	/**
+	 * Processa todas as requisições da fonte.
+	 * Exceções lançadas pela fonte ou pelo destino interrompem o lote e são
+	 * repassadas ao chamador, depois que as threads de processamento terminam.
+	 * @param source fonte das requisições.
+	 * @param sink destino dos certificados.
+	 * @return contadores e tempos do lote.
+	 * @throw CertificationException caso os contextos de assinatura não possam ser criados.
+	 */
+	BatchIssuer::Metrics issue(Source &source, Sink &sink);
+
+	/**
+	 * Codifica um certificado DER em PEM.
+	 * @param der certificado codificado em DER.
+	 * @return certificado codificado em PEM, com linhas de 64 caracteres.
+	 */
+	static std::string toPem(const std::string &der);
+
+protected:
+
+	struct Job
+	{
+		unsigned long index;
+		std::string encoded;
+		CertificateRequest *request;
+		Status status;
+		std::string certificate;
+	};
+
+	/**
+	 * Estado compartilhado pelas threads de um lote.
+	 */
+	struct Pipeline
+	{
+		BatchIssuer *issuer;
+		pthread_mutex_t mutex;
+		/* sinaliza às threads de processamento que há requisições ou que o lote terminou */
+		pthread_cond_t pending;
+		/* sinaliza à thread que chama issue() que uma requisição foi processada */
+		pthread_cond_t completed;
+		std::deque<Job *> queue;
+		std::map<unsigned long, Job *> done;
+		std::vector<EVP_MD_CTX *> contexts;
+		unsigned int nextContext;
+		bool finished;
+		Metrics metrics;
+	};
+
+	static void *run(void *pipeline);
+	void process(Job *job, EVP_MD_CTX *context, Metrics &metrics);
+	static double getElapsedMs(const struct timespec &begin);
+	static void release(Pipeline &pipeline);
+
+	IssuanceTemplate &issuanceTemplate;
+	Policy &policy;
+	unsigned int threads;
+	unsigned int queueSize;
+	Format format;
+
+private:
+
+	BatchIssuer(const BatchIssuer &);
+	BatchIssuer& operator=(const BatchIssuer &);
+};
+
+#endif /* BATCHISSUER_H_ */
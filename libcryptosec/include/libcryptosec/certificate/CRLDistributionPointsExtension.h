@@ -29,6 +29,8 @@ public:
 	std::vector<DistributionPoint> getDistributionPoints();
 	X509_EXTENSION* getX509Extension();
 protected:
+	virtual void encodeValue(DerWriter &writer);
+	virtual void writeValue(DocumentWriter &writer);
 	std::vector<DistributionPoint> distributionPoints;
 };
 
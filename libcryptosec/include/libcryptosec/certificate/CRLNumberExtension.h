@@ -29,6 +29,7 @@ public:
 	X509_EXTENSION* getX509Extension(); //TODO
 	
 protected:
+	virtual void writeValue(DocumentWriter &writer);
 	unsigned long serial;	
 };
 
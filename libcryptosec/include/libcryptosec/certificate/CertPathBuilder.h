@@ -0,0 +1,160 @@
+#ifndef CERTPATHBUILDER_H_
+#define CERTPATHBUILDER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <time.h>
+
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include "Certificate.h"
+#include "CertificateStore.h"
+#include <libcryptosec/DateTime.h>
+
+/**
+ * @ingroup Util
+ */
+
+/**
+ * @brief Constrói caminhos de certificação a partir de um conjunto desordenado de certificados.
+ * Os certificados intermediários candidatos são indexados pelo identificador de
+ * chave do titular (SKI) e pelo nome do titular. A partir do certificado dado, uma
+ * busca pela melhor opção primeiro (best-first) expande os caminhos parciais de
+ * menor custo: cada ligação custa 1 quando o Authority Key Identifier do certificado
+ * coincide com o SKI do emissor e 2 quando o emissor foi encontrado apenas pelo nome;
+ * entre caminhos de mesmo custo, prefere-se o que permanece válido por mais tempo.
+ * Emissores fora do período de validade, que não sejam ACs, que não tenham o uso de
+ * chave keyCertSign ou cujo pathLenConstraint seja excedido são descartados, assim
+ * como aqueles cuja chave não confere a assinatura do certificado. A busca é
+ * limitada em profundidade e em número de expansões, e seu custo pode ser
+ * consultado por getCost().
+ * O caminho retornado pode ser validado pelo CertPathValidator, usando os
+ * certificados intermediários como caminho de certificação.
+ * @see CertPathValidator
+ */
+class CertPathBuilder
+{
+public:
+
+	/**
+	 * Custo da última busca.
+	 */
+	struct Cost
+	{
+		/* caminhos parciais retirados da fila e expandidos */
+		unsigned long expansions;
+		/* emissores candidatos encontrados nos índices */
+		unsigned long candidates;
+		/* candidatos descartados por validade, uso de chave, laço ou profundidade */
+		unsigned long pruned;
+		/* verificações de assinatura realizadas */
+		unsigned long signatureChecks;
+	};
+
+	/**
+	 * Construtor.
+	 * @param pool certificados intermediários candidatos, em qualquer ordem.
+	 * @param trustedChain certificados confiáveis, onde os caminhos terminam.
+	 * @param when momento do tempo para se considerar a validade dos certificados.
+	 */
+	CertPathBuilder(std::vector<Certificate>& pool, std::vector<Certificate>& trustedChain, DateTime when = DateTime(time(NULL)));
+
+	/**
+	 * Construtor com um repositório de certificados confiáveis.
+	 * @param pool certificados intermediários candidatos, em qualquer ordem.
+	 * @param trustedStore repositório de certificados confiáveis, que deve existir enquanto o construtor for usado.
+	 * @param when momento do tempo para se considerar a validade dos certificados.
+	 */
+	CertPathBuilder(std::vector<Certificate>& pool, CertificateStore& trustedStore, DateTime when = DateTime(time(NULL)));
+
+	/**
+	 * Destrutor padrão.
+	 */
+	virtual ~CertPathBuilder();
+
+	/**
+	 * Define a quantidade máxima de certificados de um caminho, incluindo o certificado e a âncora.
+	 * @param maxDepth profundidade máxima (padrão 10).
+	 */
+	void setMaxDepth(unsigned int maxDepth);
+
+	/**
+	 * Define a quantidade máxima de caminhos parciais expandidos em uma busca.
+	 * @param maxExpansions limite de expansões (padrão 1000).
+	 */
+	void setMaxExpansions(unsigned int maxExpansions);
+
+	/**
+	 * Define o momento do tempo para se considerar a validade dos certificados.
+	 * @param when objeto DateTime.
+	 */
+	void setTime(DateTime when);
+
+	/**
+	 * Constrói o melhor caminho do certificado até um certificado confiável.
+	 * @param certificate certificado cujo caminho é procurado.
+	 * @param path recebe o caminho, começando por certificate e terminando na âncora.
+	 * @return true se um caminho foi encontrado dentro dos limites da busca.
+	 */
+	bool build(Certificate& certificate, std::vector<Certificate>& path);
+
+	/**
+	 * @return custo da última chamada de build.
+	 */
+	Cost getCost() const;
+
+protected:
+
+	/**
+	 * Caminho parcial; path[0] é o certificado e path.back() o último emissor encontrado.
+	 */
+	struct Node
+	{
+		std::vector<X509 *> path;
+		unsigned int cost;
+		const ASN1_TIME *notAfter;
+		bool complete;
+	};
+
+	/**
+	 * Ordena a fila de prioridade: menor custo e, depois, maior validade primeiro.
+	 */
+	struct NodeOrder
+	{
+		bool operator()(const Node *a, const Node *b) const;
+	};
+
+	void index(X509 *cert, std::multimap<std::string, X509 *> &byKeyIdentifier, std::multimap<unsigned long, X509 *> &bySubject);
+	void findCandidates(X509 *cert, const std::multimap<std::string, X509 *> &byKeyIdentifier,
+			const std::multimap<unsigned long, X509 *> &bySubject, std::vector<X509 *> &found);
+	bool isTrusted(X509 *cert);
+	bool accept(const Node *node, X509 *issuer);
+	bool checkSignature(X509 *cert, X509 *issuer);
+
+	static std::string getKeyIdentifier(const ASN1_OCTET_STRING *keyIdentifier);
+	/* libera os nós da busca e as referências obtidas do CertificateStore */
+	static void release(std::vector<Node *> &nodes, std::vector<X509 *> &storeIssuers);
+
+	std::vector<X509 *> pool;
+	std::multimap<std::string, X509 *> poolByKeyIdentifier;
+	std::multimap<unsigned long, X509 *> poolBySubject;
+	std::vector<X509 *> anchors;
+	std::multimap<std::string, X509 *> anchorsByKeyIdentifier;
+	std::multimap<unsigned long, X509 *> anchorsBySubject;
+	CertificateStore *trustedStore;
+	DateTime when;
+	unsigned int maxDepth;
+	unsigned int maxExpansions;
+	Cost cost;
+	/* verificações de assinatura já feitas na busca atual */
+	std::map<std::pair<X509 *, X509 *>, bool> signatures;
+
+private:
+
+	CertPathBuilder(const CertPathBuilder &);
+	CertPathBuilder& operator=(const CertPathBuilder &);
+};
+
+#endif /* CERTPATHBUILDER_H_ */
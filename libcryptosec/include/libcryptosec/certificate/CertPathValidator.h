@@ -1,12 +1,15 @@
 #ifndef CERTPATHVALIDATOR_H_
 #define CERTPATHVALIDATOR_H_
 
+#include <map>
 #include <vector>
 #include <time.h>
 
+#include "CertPathValidatorCache.h"
 #include "CertPathValidatorResult.h"
 #include "Certificate.h"
 #include "CertificateRevocationList.h"
+#include "CertificateStore.h"
 #include "ValidationFlags.h"
 #include <libcryptosec/DateTime.h>
 
@@ -17,6 +20,12 @@
 
 /**
  * @brief Valida certificados X509.
+ * A configuração de confiança (certificados e repositório confiáveis, LCRs e
+ * flags) é montada em um X509_STORE na primeira validação e reaproveitada
+ * pelas seguintes, até ser alterada por um dos métodos set. Os resultados de
+ * cada validação ficam em um objeto próprio do contexto (X509_STORE_CTX), de
+ * forma que verify(Certificate&, vector<CertPathValidatorResult>&) pode ser
+ * chamado por várias threads ao mesmo tempo sobre o mesmo validador.
   */
 class CertPathValidator
 {
@@ -34,13 +43,36 @@ public:
 	 * */
 	CertPathValidator(Certificate& untrusted, vector<Certificate>& untrustedChain, vector<Certificate>& trustedChain, DateTime when = DateTime(time(NULL)), 
 			vector<CertificateRevocationList> crls = vector<CertificateRevocationList>(), vector<ValidationFlags> flags = vector<ValidationFlags>()) 
-				: flags(flags), when(when), untrusted(untrusted), trustedChain(trustedChain), untrustedChain(untrustedChain), crls(crls)
+				: flags(flags), when(when), untrusted(untrusted), trustedChain(trustedChain), untrustedChain(untrustedChain), crls(crls),
+				  trustedStore(NULL), cache(NULL), store(NULL), lock(CRYPTO_THREAD_lock_new())
 				{}
+
+	/*
+	 * Construtor com um repositório de certificados confiáveis.
+	 * Os emissores são procurados nos índices do repositório durante a validação,
+	 * em vez de todos os certificados confiáveis serem copiados a cada chamada.
+	 * @param untrusted certificado a ser validado.
+	 * @param untrustedChain vetor contendo os certificados do caminho de certificação.
+	 * @param trustedStore repositório de certificados confiáveis, que deve existir enquanto o validador for usado.
+	 * @param when momento do tempo para se considerar a validade dos certificados.
+	 * @param crls vetor de LCRs.
+	 * @param flags vetor de flags para validação.
+	 * */
+	CertPathValidator(Certificate& untrusted, vector<Certificate>& untrustedChain, CertificateStore& trustedStore, DateTime when = DateTime(time(NULL)),
+			vector<CertificateRevocationList> crls = vector<CertificateRevocationList>(), vector<ValidationFlags> flags = vector<ValidationFlags>())
+				: flags(flags), when(when), untrusted(untrusted), trustedChain(noTrustedChain), untrustedChain(untrustedChain), crls(crls),
+				  trustedStore(&trustedStore), cache(NULL), store(NULL), lock(CRYPTO_THREAD_lock_new())
+				{}
+
+	/*
+	 * Construtor de cópia. A cópia monta sua própria configuração de confiança.
+	 * */
+	CertPathValidator(const CertPathValidator& validator);
 	
 	/*
 	 * Destrutor padrão.
 	 * */			
-	virtual ~CertPathValidator(){};
+	virtual ~CertPathValidator();
 	
 	/*
 	 * Define momento do tempo para se considerar a validade dos certificados.
@@ -65,6 +97,13 @@ public:
 	 * @param certs referência a um vetor de Certificados.
 	 * */
 	void setTrustedChain(vector<Certificate>& certs);
+
+	/*
+	 * Define o repositório de certificados confiáveis.
+	 * Pode ser usado junto com os certificados de setTrustedChain; o repositório é consultado primeiro.
+	 * @param store referência ao repositório, que deve existir enquanto o validador for usado.
+	 * */
+	void setTrustedStore(CertificateStore& store);
 	
 	/*
 	 * Define LCRs
@@ -78,6 +117,13 @@ public:
 	 * @param flag item da enum ValidationFlags.
 	 * */
 	void setVerificationFlags(ValidationFlags flag);
+
+	/*
+	 * Define um cache de resultados de validação, consultado antes de cada validação.
+	 * Um mesmo cache pode ser compartilhado por vários validadores.
+	 * @param cache referência ao cache, que deve existir enquanto o validador for usado.
+	 * */
+	void setCache(CertPathValidatorCache& cache);
 	
 	/*
 	 * Define objeto de diagnóstico de validação.
@@ -90,6 +136,37 @@ public:
 	 * @return true caso o certificado seja válido. Caso o certificado seja inválido, false é retornado e o objeto CertPathValidatorResult é instanciado.
 	 * */
 	bool verify();
+
+	/*
+	 * Valida um certificado com o caminho de certificação definido no validador.
+	 * Pode ser chamado concorrentemente, desde que a configuração não seja alterada durante as chamadas.
+	 * @param certificate certificado a ser validado.
+	 * @param results recebe as informações sobre a validação (erro e avisos).
+	 * @return true caso o certificado seja válido.
+	 * */
+	bool verify(Certificate& certificate, vector<CertPathValidatorResult>& results);
+
+	/*
+	 * Valida um certificado com o caminho de certificação informado.
+	 * Pode ser chamado concorrentemente, desde que a configuração não seja alterada durante as chamadas.
+	 * @param certificate certificado a ser validado.
+	 * @param untrustedChain certificados do caminho de certificação.
+	 * @param results recebe as informações sobre a validação (erro e avisos).
+	 * @return true caso o certificado seja válido.
+	 * */
+	bool verify(Certificate& certificate, vector<Certificate>& untrustedChain, vector<CertPathValidatorResult>& results);
+
+	/*
+	 * Valida um lote de certificados com o caminho de certificação definido no validador.
+	 * As validações são distribuídas entre várias threads e compartilham a mesma configuração
+	 * de confiança; a assinatura de cada certificado intermediário é verificada uma única vez
+	 * por lote.
+	 * @param certificates certificados a serem validados.
+	 * @param results recebe, na ordem de certificates, as informações sobre cada validação.
+	 * @param threads número de threads; 0 usa uma por processador.
+	 * @return o resultado de cada validação, na ordem de certificates.
+	 * */
+	vector<bool> verifyBatch(vector<Certificate>& certificates, vector<vector<CertPathValidatorResult> >& results, unsigned int threads = 0);
 	
 	/*
 	 * Retorna se há avisos
@@ -110,8 +187,90 @@ public:
 	 * @return 1
 	 */
 	static int callback(int ok, X509_STORE_CTX *ctx);
+
+	/*
+	 * Função callback de busca de emissores no repositório de certificados confiáveis.
+	 * @param issuer recebe o emissor encontrado.
+	 * @param ctx contexto de certificado
+	 * @param x certificado cujo emissor é procurado.
+	 * @return 1 se um emissor foi encontrado, 0 caso contrário.
+	 */
+	static int getIssuer(X509 **issuer, X509_STORE_CTX *ctx, X509 *x);
+
+	/*
+	 * Função callback de busca de certificados confiáveis pelo nome do titular.
+	 * @param ctx contexto de certificado
+	 * @param name nome do titular.
+	 * @return pilha de certificados encontrados ou NULL.
+	 */
+	static STACK_OF(X509)* lookupCerts(X509_STORE_CTX *ctx, X509_NAME *name);
 	
 protected:
+
+	/*
+	 * Verificações de assinatura já feitas em um lote, por par (certificado, emissor).
+	 * Os certificados são mantidos com uma referência extra até o fim do lote.
+	 * */
+	struct SignatureMemo
+	{
+		CRYPTO_RWLOCK *lock;
+		std::map<std::pair<X509 *, X509 *>, bool> verified;
+	};
+
+	/*
+	 * Estado compartilhado pelas threads de um lote.
+	 * */
+	struct BatchTask
+	{
+		CertPathValidator *validator;
+		vector<Certificate> *certificates;
+		vector<vector<CertPathValidatorResult> > *results;
+		vector<char> *valid;
+		SignatureMemo *memo;
+		CRYPTO_RWLOCK *lock;
+		unsigned int next;
+	};
+
+	static void initIndexes();
+
+	/*
+	 * Realiza a validação, com a memória de assinaturas de um lote quando memo não for NULL.
+	 * */
+	bool verify(Certificate& certificate, vector<Certificate>& untrustedChain, vector<CertPathValidatorResult>& results, SignatureMemo *memo);
+
+	static void *runBatch(void *task);
+
+	/*
+	 * Substitui a verificação de assinaturas e datas do OpenSSL nos contextos de um lote.
+	 * Segue a função internal_verify do OpenSSL, consultando a memória de assinaturas
+	 * para os certificados intermediários.
+	 * */
+	static int verifySignatures(X509_STORE_CTX *ctx);
+	static bool checkSignature(X509_STORE_CTX *ctx, X509 *subject, X509 *issuer, bool memoize);
+	static int checkTime(X509_STORE_CTX *ctx, X509 *cert, int depth);
+	static int reportError(X509_STORE_CTX *ctx, X509 *cert, int depth, int error);
+
+	/*
+	 * Retorna uma nova referência ao X509_STORE com a configuração de confiança, montando-o se necessário.
+	 * @param configuration recebe o resumo da configuração, usado nas chaves do cache.
+	 * */
+	X509_STORE* getStore(std::string &configuration);
+
+	/*
+	 * Monta a chave do cache para a validação de certificate com o caminho untrustedChain.
+	 * */
+	std::string getCacheKey(Certificate& certificate, vector<Certificate>& untrustedChain, const std::string &configuration);
+
+	/*
+	 * Calcula o intervalo em que o resultado de uma validação pode ser reaproveitado:
+	 * a interseção dos períodos de validade do caminho construído e das LCRs.
+	 * */
+	void getValidityInterval(X509_STORE_CTX *ctx, time_t &notBefore, time_t &notAfter);
+
+	/*
+	 * Descarta a configuração de confiança montada, após uma alteração.
+	 * */
+	void resetStore();
 	
 	/*
 	 * Opções de validação.
@@ -152,11 +311,59 @@ protected:
 	//CertPathValidatorResult** result;
 		
 	/*
-	 * Informações sobre o o resultado da validação.
-	 * Esta var estática é utilizada para obter os dados na funcao de callback em C.
-	 * Verificar problemas de concorrência com esta variável no caso de multi-threading.
+	 * Informações sobre o resultado da última chamada de verify().
+	 * */
+	vector<CertPathValidatorResult> results;
+
+	/*
+	 * Repositório de certificados confiáveis, opcional.
+	 * */
+	CertificateStore *trustedStore;
+
+	/*
+	 * Vetor vazio ao qual trustedChain se refere quando apenas o repositório é usado.
+	 * */
+	vector<Certificate> noTrustedChain;
+
+	/*
+	 * Índice do ponteiro para o repositório nos dados de extensão do X509_STORE.
+	 * */
+	static int storeIndex;
+
+	/*
+	 * Índice do vetor de resultados nos dados de extensão do X509_STORE_CTX.
+	 * */
+	static int resultsIndex;
+
+	/*
+	 * Índice da memória de assinaturas do lote nos dados de extensão do X509_STORE_CTX.
+	 * */
+	static int memoIndex;
+	static CRYPTO_ONCE indexesOnce;
+
+	/*
+	 * Cache de resultados de validação, opcional.
 	 * */
-	static vector<CertPathValidatorResult> results; 
+	CertPathValidatorCache *cache;
+
+	/*
+	 * Configuração de confiança montada, compartilhada pelas validações.
+	 * */
+	X509_STORE *store;
+
+	/*
+	 * Resumo SHA-256 da configuração de confiança montada em store, calculado quando há cache.
+	 * */
+	std::string configuration;
+
+	/*
+	 * Protege a montagem e o descarte de store.
+	 * */
+	CRYPTO_RWLOCK *lock;
+
+private:
+
+	CertPathValidator& operator=(const CertPathValidator &);
 
 };
 
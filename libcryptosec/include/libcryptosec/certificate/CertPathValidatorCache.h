@@ -0,0 +1,129 @@
+#ifndef CERTPATHVALIDATORCACHE_H_
+#define CERTPATHVALIDATORCACHE_H_
+
+/* c++ library includes */
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include <time.h>
+
+/* OpenSSL includes */
+#include <openssl/crypto.h>
+
+#include "CertPathValidatorResult.h"
+
+/**
+ * @brief Cache LRU de resultados de validação de caminhos de certificação.
+ * Cada entrada é indexada pelo resumo do certificado validado, pelos resumos do
+ * caminho de certificação informado e pela configuração de confiança do
+ * validador (certificados e repositório confiáveis com sua versão, LCRs e
+ * flags), de modo que qualquer alteração na configuração produz chaves novas.
+ * Uma entrada só é usada enquanto o momento da validação estiver dentro do
+ * intervalo em que todos os certificados do caminho construído e todas as LCRs
+ * são válidos; fora dele a entrada é descartada.
+ * Assim como PublicKeyCache, o cache é dividido em partições com travas e
+ * listas LRU próprias e pode ser compartilhado entre validadores e threads.
+ * @see CertPathValidator::setCache
+ */
+class CertPathValidatorCache
+{
+
+public:
+
+	/**
+	 * Estatísticas acumuladas do cache.
+	 */
+	struct Stats
+	{
+		unsigned long hits;
+		unsigned long misses;
+		unsigned long expirations;
+		unsigned long evictions;
+		unsigned long size;
+	};
+
+	/**
+	 * Cria um cache vazio.
+	 * @param capacity número máximo de resultados mantidos.
+	 * @param shards número de partições independentes.
+	 */
+	CertPathValidatorCache(unsigned int capacity = 4096, unsigned int shards = 16);
+
+	/**
+	 * Destrutor padrão.
+	 */
+	virtual ~CertPathValidatorCache();
+
+	/**
+	 * Busca o resultado de uma validação.
+	 * @param key chave da validação, montada pelo CertPathValidator.
+	 * @param when momento da validação.
+	 * @param valid recebe o resultado da validação.
+	 * @param results recebe as informações sobre a validação (erro e avisos).
+	 * @return true se um resultado válido no momento when foi encontrado.
+	 */
+	bool find(const std::string &key, time_t when, bool &valid, std::vector<CertPathValidatorResult> &results);
+
+	/**
+	 * Armazena o resultado de uma validação.
+	 * @param key chave da validação, montada pelo CertPathValidator.
+	 * @param notBefore início do intervalo em que o resultado pode ser usado.
+	 * @param notAfter fim do intervalo em que o resultado pode ser usado.
+	 * @param valid resultado da validação.
+	 * @param results informações sobre a validação (erro e avisos).
+	 */
+	void insert(const std::string &key, time_t notBefore, time_t notAfter, bool valid, const std::vector<CertPathValidatorResult> &results);
+
+	/**
+	 * @return estatísticas acumuladas de todas as partições.
+	 */
+	Stats getStats();
+
+	/**
+	 * @return fração das buscas atendidas pelo cache, entre 0 e 1.
+	 */
+	double getHitRate();
+
+	/**
+	 * @return capacidade total do cache.
+	 */
+	unsigned int getCapacity() const;
+
+	/**
+	 * Remove todos os resultados do cache e zera as estatísticas.
+	 */
+	void clear();
+
+private:
+
+	struct Entry
+	{
+		std::string key;
+		time_t notBefore;
+		time_t notAfter;
+		bool valid;
+		std::vector<CertPathValidatorResult> results;
+	};
+
+	struct Shard
+	{
+		CRYPTO_RWLOCK *lock;
+		std::list<Entry> entries;
+		std::map<std::string, std::list<Entry>::iterator> index;
+		unsigned long hits;
+		unsigned long misses;
+		unsigned long expirations;
+		unsigned long evictions;
+	};
+
+	CertPathValidatorCache(const CertPathValidatorCache &);
+	CertPathValidatorCache& operator=(const CertPathValidatorCache &);
+
+	Shard& getShard(const std::string &key);
+
+	std::vector<Shard*> shards;
+	unsigned int shardCapacity;
+};
+
+#endif /* CERTPATHVALIDATORCACHE_H_ */
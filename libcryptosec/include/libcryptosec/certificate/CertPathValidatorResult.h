@@ -134,10 +134,28 @@ public:
 	 * @param cve referência para o objeto CertPathValidatorResult a ser copiado.
 	 * */
 	CertPathValidatorResult(const CertPathValidatorResult& cve) 
-		: invalidCert(new Certificate(cve.getInvalidCertificate())), 
-		depth(cve.getDepth()), errorCode(cve.getErrorCode()), details(cve.getDetails())
+		: invalidCert(CertPathValidatorResult::share(cve.invalidCert)), 
+		depth(cve.getDepth()), errorCode(cve.getErrorCode()), details(cve.getDetails()), validationFlags(cve.validationFlags)
 	{
 	}
+
+	/*
+	 * Operador de atribuição.
+	 * @param cve referência para o objeto CertPathValidatorResult a ser copiado.
+	 * */
+	CertPathValidatorResult& operator=(const CertPathValidatorResult& cve)
+	{
+		if (this != &cve)
+		{
+			delete this->invalidCert;
+			this->invalidCert = CertPathValidatorResult::share(cve.invalidCert);
+			this->depth = cve.depth;
+			this->errorCode = cve.errorCode;
+			this->details = cve.details;
+			this->validationFlags = cve.validationFlags;
+		}
+		return *this;
+	}
 	
 	/*
 	 * Destrutor.
@@ -372,6 +390,7 @@ public:
 	virtual void setInvalidCertificate(Certificate *cert)
 	{
 		X509 *newCert = X509_dup(cert->getX509());
+		delete this->invalidCert;
 		this->invalidCert = new Certificate(newCert);
 	}
 	
@@ -588,6 +607,19 @@ protected:
 	 * Certificado submetido a validação.
 	 * */
 	Certificate *invalidCert;
+
+	/*
+	 * Cria um objeto Certificate que compartilha a estrutura X509 de cert, ou retorna NULL.
+	 * */
+	static Certificate* share(const Certificate *cert)
+	{
+		if (cert == NULL)
+		{
+			return NULL;
+		}
+		X509_up_ref(cert->getX509());
+		return new Certificate(cert->getX509());
+	}
 	
 	/*
 	 * Profundidade em que ocorreu erro de validação.
@@ -53,6 +53,12 @@ public:
 	std::string getXmlEncoded();
 	std::string getXmlEncoded(std::string tab);
 	virtual std::string toXml(std::string tab = "");
+
+	/**
+	 * Escreve o certificado no documento à medida que percorre seus campos, com as
+	 * extensões decodificadas uma a uma.
+	 */
+	void write(DocumentWriter &writer);
 	long getSerialNumber() throw (CertificationException);
 	BigInteger getSerialNumberBigInt() throw (CertificationException);
 	MessageDigest::Algorithm getMessageDigestAlgorithm()
@@ -67,9 +73,43 @@ public:
 	std::vector<Extension *> getExtension(Extension::Name extensionName);
 	std::vector<Extension *> getExtensions();
 	std::vector<Extension *> getUnknownExtensions();
+
+	/**
+	 * As extensões do certificado são indexadas na primeira consulta, sem serem decodificadas.
+	 * @param extensionName extensão desejada.
+	 * @return true se o certificado tem a extensão.
+	 */
+	bool hasExtension(Extension::Name extensionName) const;
+
+	/**
+	 * Os métodos a seguir decodificam somente a extensão pedida, na primeira vez em que
+	 * ela é pedida; o resultado é guardado no objeto e as chamadas seguintes devolvem
+	 * uma cópia dele, sem decodificar novamente. Podem ser chamados por várias threads.
+	 * @throw CertificationException caso o certificado não tenha a extensão ou ela não possa
+	 * ser decodificada.
+	 */
+	BasicConstraintsExtension getBasicConstraints() const throw (CertificationException);
+	KeyUsageExtension getKeyUsage() const throw (CertificationException);
+	ExtendedKeyUsageExtension getExtendedKeyUsage() const throw (CertificationException);
+	SubjectKeyIdentifierExtension getSubjectKeyIdentifier() const throw (CertificationException);
+	AuthorityKeyIdentifierExtension getAuthorityKeyIdentifier() const throw (CertificationException);
+	SubjectAlternativeNameExtension getSubjectAlternativeName() const throw (CertificationException);
+	IssuerAlternativeNameExtension getIssuerAlternativeName() const throw (CertificationException);
+	CRLDistributionPointsExtension getCRLDistributionPoints() const throw (CertificationException);
+	CertificatePoliciesExtension getCertificatePolicies() const throw (CertificationException);
+	AuthorityInformationAccessExtension getAuthorityInformationAccess() const throw (CertificationException);
+	SubjectInformationAccessExtension getSubjectInformationAccess() const throw (CertificationException);
+
 	ByteArray getFingerPrint(MessageDigest::Algorithm algorithm) const
 		throw (CertificationException, EncodeException, MessageDigestException);
 	bool verify(PublicKey &publicKey);
+	/**
+	 * Verifica a assinatura do certificado com a chave pública do emissor, já
+	 * decodificada na estrutura X509 do emissor.
+	 * @param issuer certificado do emissor.
+	 * @return true se a assinatura for válida.
+	 */
+	bool verify(const Certificate &issuer);
 	X509* getX509() const;
 	/**
 	 * create a new certificate request using the data from this certificate
@@ -83,7 +123,30 @@ public:
 	bool operator ==(const Certificate& value);
 	bool operator !=(const Certificate& value);
 protected:
+	/**
+	 * Extensões do certificado por nome, montado na primeira consulta e imutável depois disso.
+	 */
+	struct ExtensionIndex
+	{
+		/* nome de cada extensão, na ordem do certificado */
+		std::vector<Extension::Name> names;
+		/* posição da primeira extensão de cada nome, -1 se ausente */
+		int positions[Extension::DELTA_CRL_INDICATOR + 1];
+		/* extensões já decodificadas, por nome; preenchidas sob extensionIndexLock */
+		Extension *decoded[Extension::DELTA_CRL_INDICATOR + 1];
+		ExtensionIndex();
+		~ExtensionIndex();
+	};
+
+	const ExtensionIndex* getExtensionIndex() const;
+	void resetExtensionIndex();
+	const Extension* getDecodedExtension(Extension::Name extensionName, const char *where) const
+			throw (CertificationException);
+	static Extension* newExtension(X509_EXTENSION *ext, Extension::Name extensionName) throw (CertificationException);
+
 	X509 *cert;
+	mutable ExtensionIndex *extensionIndex;
+	CRYPTO_RWLOCK *extensionIndexLock;
 };
 
 #endif /*CERTIFICATE_H_*/
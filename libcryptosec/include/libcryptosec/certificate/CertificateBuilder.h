@@ -135,7 +135,8 @@ protected:
 	bool includeECDSAParameters;
 
 private:
-	int getCodification(RDNSequence& name);
+	int getCodification(X509_NAME *subject, const std::vector<std::pair<ObjectIdentifier, std::string> > &entries,
+			const std::vector<int> &positions);
 
 
 };
@@ -31,6 +31,8 @@ public:
 	std::vector<PolicyInformation> getPoliciesInformation();
 	X509_EXTENSION* getX509Extension();
 protected:
+	virtual void encodeValue(DerWriter &writer);
+	virtual void writeValue(DocumentWriter &writer);
 	std::vector<PolicyInformation> policiesInformation;
 };
 
@@ -45,6 +45,11 @@ public:
 	std::string getXmlEncoded();
 	std::string getXmlEncoded(std::string tab);
 	virtual std::string toXml(std::string tab = "");
+
+	/**
+	 * Escreve a requisição no documento à medida que percorre seus campos.
+	 */
+	void write(DocumentWriter &writer);
 	std::string getPemEncoded()
 			throw (EncodeException);
 	ByteArray getDerEncoded() const
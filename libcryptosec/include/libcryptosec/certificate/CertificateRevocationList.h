@@ -1,11 +1,13 @@
 #ifndef CERTIFICATEREVOCATIONLIST_H_
 #define CERTIFICATEREVOCATIONLIST_H_
 
+#include <openssl/crypto.h>
 #include <openssl/x509.h>
 
 #include <string>
 #include <vector>
 
+#include <libcryptosec/BloomFilter.h>
 #include <libcryptosec/ByteArray.h>
 #include <libcryptosec/Base64.h>
 #include <libcryptosec/DateTime.h>
@@ -29,6 +31,8 @@
 #include "RDNSequence.h"
 #include "RevokedCertificate.h"
 
+class Certificate;
+
 class CertificateRevocationList
 {
 public:
@@ -41,6 +45,13 @@ public:
 	virtual ~CertificateRevocationList();
 	std::string getXmlEncoded();
 	std::string getXmlEncoded(std::string tab);
+
+	/**
+	 * Escreve a LCR no documento à medida que percorre seus campos. Os certificados
+	 * revogados e as extensões são escritos um a um, sem copiar a lista.
+	 * Para LCRs que não cabem em memória, veja CertificateRevocationListReader::write().
+	 */
+	void write(DocumentWriter &writer);
 	std::string getPemEncoded() throw (EncodeException);
 	ByteArray getDerEncoded() throw (EncodeException);
 	long getSerialNumber() throw (CertificationException);
@@ -52,14 +63,87 @@ public:
 	DateTime getLastUpdate();
 	DateTime getNextUpdate();
 	std::vector<RevokedCertificate> getRevokedCertificate();
+	/**
+	 * Verifica se um número de série consta da LCR.
+	 * Na primeira consulta é montado um índice ordenado dos números de série,
+	 * compartilhado pelas consultas seguintes, inclusive de outras threads.
+	 * @param serialNumber número de série do certificado.
+	 * @return true se o certificado foi revogado.
+	 */
+	bool isRevoked(const BigInteger &serialNumber);
+	/**
+	 * Busca a entrada da LCR de um número de série, usando o mesmo índice de isRevoked.
+	 * @param serialNumber número de série do certificado.
+	 * @return entrada da LCR, que deve ser liberada pelo chamador, ou NULL se o certificado não foi revogado.
+	 */
+	RevokedCertificate* getRevocation(const BigInteger &serialNumber);
+	/**
+	 * Configura o filtro de Bloom montado junto com o índice de isRevoked, que
+	 * descarta a maior parte das consultas de certificados não revogados sem
+	 * acessar o índice. Deve ser chamado antes das consultas; o índice é
+	 * montado novamente na consulta seguinte.
+	 * @param falsePositiveRate taxa de falsos positivos; 0 desativa o filtro. O padrão é 1%.
+	 * @param maxSizeBits limite do tamanho do filtro em bits; 0 não limita.
+	 */
+	void setBloomFilter(double falsePositiveRate, unsigned long maxSizeBits = 0);
+	/**
+	 * @return filtro usado por isRevoked, com as estatísticas de consultas, ou
+	 * NULL se estiver desativado ou se o índice ainda não foi montado.
+	 */
+	const BloomFilter* getBloomFilter() const;
 	bool verify(PublicKey &publicKey);
+	/**
+	 * Verifica a assinatura da LCR com a chave pública do emissor, já
+	 * decodificada na estrutura X509 do emissor.
+	 * @param issuer certificado do emissor da LCR.
+	 * @return true se a assinatura for válida.
+	 */
+	bool verify(const Certificate &issuer);
 	X509_CRL* getX509Crl() const;
 	CertificateRevocationList& operator =(const CertificateRevocationList& value);
 	std::vector<Extension*> getExtension(Extension::Name extensionName);
 	std::vector<Extension *> getExtensions();
 	std::vector<Extension *> getUnknownExtensions();
 protected:
+	/**
+	 * Entrada do índice de números de série: resumo do número e a entrada da LCR.
+	 * Guarda-se o ponteiro, e não a posição, porque o OpenSSL ordena a lista de
+	 * entradas ao consultá-la durante a validação de caminhos.
+	 */
+	struct SerialIndexEntry
+	{
+		uint64_t hash;
+		X509_REVOKED *revoked;
+		bool operator<(const SerialIndexEntry &other) const
+		{
+			return this->hash < other.hash;
+		}
+	};
+
+	/**
+	 * Índice ordenado e o filtro de Bloom sobre os mesmos resumos.
+	 */
+	struct SerialIndex
+	{
+		std::vector<SerialIndexEntry> entries;
+		BloomFilter *filter;
+		SerialIndex() : filter(NULL) {}
+		~SerialIndex() { delete this->filter; }
+	};
+
+	X509_REVOKED* findRevoked(const BigInteger &serialNumber);
+	const SerialIndex* getSerialIndex();
+	void resetSerialIndex();
+	static uint64_t hashSerial(const ASN1_INTEGER *serial);
+	/* mesmo resumo de hashSerial(ASN1_INTEGER), sem converter o número */
+	static uint64_t hashSerial(const BIGNUM *serial);
+
 	X509_CRL *crl;
+	/* índice montado na primeira consulta, imutável depois disso */
+	SerialIndex *serialIndex;
+	CRYPTO_RWLOCK *serialIndexLock;
+	double bloomFilterRate;
+	unsigned long bloomFilterMaxBits;
 };
 
 #endif /*CERTIFICATEREVOCATIONLIST_H_*/
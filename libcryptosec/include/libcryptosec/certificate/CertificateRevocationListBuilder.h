@@ -3,6 +3,7 @@
 
 #include <openssl/x509.h>
 
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -30,10 +31,34 @@
 
 #include <libcryptosec/exception/AsymmetricKeyException.h>
 #include <libcryptosec/exception/CertificationException.h>
+#include <libcryptosec/exception/EncodeException.h>
 
 class CertificateRevocationListBuilder
 {
 public:
+	/**
+	 * Certificado revogado para a geração em fluxo.
+	 * @see sign(PrivateKey&, MessageDigest::Algorithm, const std::vector<RevokedEntry>&, std::ostream&)
+	 */
+	struct RevokedEntry
+	{
+		/* conteúdo do INTEGER DER, como em CertificateRevocationListReader::getSerialNumberContent */
+		std::string serialNumber;
+		time_t revocationDate;
+		/* UNSPECIFIED não gera a extensão reasonCode */
+		RevokedCertificate::ReasonCode reasonCode;
+
+		/* ordem crescente do número de série (tamanho e depois conteúdo) */
+		bool operator<(const RevokedEntry &other) const
+		{
+			if (this->serialNumber.size() != other.serialNumber.size())
+			{
+				return this->serialNumber.size() < other.serialNumber.size();
+			}
+			return this->serialNumber < other.serialNumber;
+		}
+	};
+
 	CertificateRevocationListBuilder();
 	CertificateRevocationListBuilder(std::string pemEncoded)
 			throw (EncodeException);
@@ -66,6 +91,27 @@ public:
 	std::vector<RevokedCertificate> getRevokedCertificate();
 	CertificateRevocationList* sign(PrivateKey &privateKey, MessageDigest::Algorithm messageDigestAlgorithm)
 			throw (CertificationException);
+	/**
+	 * Gera e assina uma LCR grande diretamente em um fluxo, sem montar a estrutura X509_CRL.
+	 * Emissor, datas e extensões são os definidos neste builder, que não é alterado e
+	 * não pode ter certificados revogados adicionados por addRevokedCertificate.
+	 * Como em sign(PrivateKey&, MessageDigest::Algorithm), a versão definida em setVersion
+	 * é ignorada: a LCR é v2 se houver extensões da LCR ou de entradas, e v1 caso contrário.
+	 * A lista revokedCertificates é codificada duas vezes, uma para o resumo do TBSCertList e
+	 * outra para a escrita, em blocos, de forma que a memória usada não depende da quantidade
+	 * de entradas (exceto para chaves EdDSA, que exigem o TBSCertList inteiro na assinatura).
+	 * @param privateKey chave do emissor.
+	 * @param messageDigestAlgorithm algoritmo de resumo; ignorado para chaves EdDSA.
+	 * @param revoked certificados revogados, em ordem estritamente crescente e com números de série não negativos.
+	 * @param out destino da LCR codificada em DER, aberto em modo binário.
+	 * @return tamanho da LCR gerada.
+	 * @throw CertificationException caso o builder tenha certificados revogados ou a assinatura falhe.
+	 * @throw EncodeException caso uma entrada seja inválida (número de série, data ou motivo fora da
+	 * RFC 5280) ou esteja fora de ordem, ou a escrita falhe.
+	 */
+	unsigned long sign(PrivateKey &privateKey, MessageDigest::Algorithm messageDigestAlgorithm,
+			const std::vector<RevokedEntry> &revoked, std::ostream &out)
+			throw (CertificationException, EncodeException);
 	X509_CRL* getX509Crl() const;
 	CertificateRevocationListBuilder& operator =(const CertificateRevocationListBuilder& value);
 	void addExtension(Extension& extension) throw (CertificationException);
@@ -77,6 +123,12 @@ public:
 
 	
 protected:
+	/* acrescenta a entrada em out, se não for NULL; retorna o tamanho da codificação ou lança
+	 * EncodeException se a data de revogação não couber no formato */
+	static unsigned long encodeRevokedEntry(const RevokedEntry &entry, std::string *out);
+	/* codifica as entradas a partir de next em um bloco de até 64 KiB e avança next */
+	static void encodeRevokedEntries(const std::vector<RevokedEntry> &revoked, unsigned long &next, std::string &chunk);
+
 	X509_CRL *crl;
 };
 
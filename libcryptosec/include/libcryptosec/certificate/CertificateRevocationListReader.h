@@ -0,0 +1,254 @@
+#ifndef CERTIFICATEREVOCATIONLISTREADER_H_
+#define CERTIFICATEREVOCATIONLISTREADER_H_
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include <libcryptosec/BigInteger.h>
+#include <libcryptosec/MappedFile.h>
+#include <libcryptosec/PublicKey.h>
+
+#include "Certificate.h"
+#include "DocumentWriter.h"
+#include "RDNSequence.h"
+#include "RevokedCertificate.h"
+
+#include <libcryptosec/exception/CertificationException.h>
+#include <libcryptosec/exception/EncodeException.h>
+
+/**
+ * @brief Leitura sequencial de LCRs codificadas em DER.
+ * Os certificados revogados são decodificados um a um diretamente do buffer
+ * (por exemplo, de um MappedFile) ou de um std::istream, sem montar a estrutura
+ * X509_CRL, de forma que LCRs com milhões de entradas possam ser percorridas
+ * com memória constante.
+ * Se a chave do emissor for informada antes da leitura, a assinatura é
+ * verificada durante a própria varredura: os bytes do TBSCertList são passados
+ * ao resumo à medida que são consumidos. Algoritmos sem resumo separado
+ * (Ed25519, RSASSA-PSS) exigem que o TBSCertList seja guardado e decodificado
+ * no final, o que anula a economia de memória.
+ * Os objetos não são reentrantes; cada thread deve usar seu próprio leitor.
+ * @see CertificateRevocationList
+ */
+class CertificateRevocationListReader
+{
+
+public:
+
+	/**
+	 * Certificado revogado lido da LCR.
+	 */
+	struct Entry
+	{
+		/* conteúdo do INTEGER (complemento de dois, big-endian); válido até a próxima leitura */
+		const unsigned char *serialNumber;
+		unsigned long serialNumberLength;
+		time_t revocationDate;
+		/* UNSPECIFIED se a entrada não tiver a extensão reasonCode */
+		RevokedCertificate::ReasonCode reasonCode;
+		/* true se o motivo for removeFromCRL (LCR delta); reasonCode é UNSPECIFIED nesse caso */
+		bool removeFromCrl;
+
+		/**
+		 * @return o número de série como BigInteger.
+		 * @throw BigIntegerException caso o número de série não possa ser convertido.
+		 */
+		BigInteger getSerialNumberBigInt() const throw (BigIntegerException);
+	};
+
+	/**
+	 * Interface para receber as entradas em read(Handler&).
+	 */
+	class Handler
+	{
+	public:
+		virtual ~Handler() {}
+
+		/**
+		 * @param entry certificado revogado lido.
+		 * @return true para continuar a leitura, false para interrompê-la.
+		 */
+		virtual bool revoked(const CertificateRevocationListReader::Entry &entry) = 0;
+	};
+
+	/**
+	 * Lê a LCR de um fluxo, em blocos.
+	 * @param stream fluxo posicionado no início da LCR, que deve existir enquanto o leitor for usado.
+	 */
+	CertificateRevocationListReader(std::istream &stream);
+
+	/**
+	 * Lê a LCR de um buffer em memória, sem cópia.
+	 * @param data buffer, que deve existir enquanto o leitor for usado.
+	 * @param length tamanho do buffer.
+	 */
+	CertificateRevocationListReader(const unsigned char *data, unsigned long length);
+
+	/**
+	 * Lê a LCR de um arquivo mapeado, sem cópia.
+	 * @param file arquivo mapeado, que deve existir enquanto o leitor for usado.
+	 */
+	CertificateRevocationListReader(const MappedFile &file);
+
+	/**
+	 * Destrutor padrão.
+	 */
+	virtual ~CertificateRevocationListReader();
+
+	/**
+	 * Define o emissor cuja chave verifica a assinatura. Deve ser chamado antes da leitura.
+	 * @param issuer certificado do emissor da LCR.
+	 * @throw CertificationException caso a leitura já tenha começado ou a chave não possa ser obtida.
+	 */
+	void setIssuer(const Certificate &issuer) throw (CertificationException);
+
+	/**
+	 * Define a chave que verifica a assinatura. Deve ser chamado antes da leitura.
+	 * @param publicKey chave pública do emissor da LCR.
+	 * @throw CertificationException caso a leitura já tenha começado.
+	 */
+	void setPublicKey(PublicKey &publicKey) throw (CertificationException);
+
+	/**
+	 * @return versão da LCR (0 para v1, 1 para v2).
+	 * @throw EncodeException caso o cabeçalho da LCR seja inválido.
+	 */
+	long getVersion() throw (EncodeException);
+
+	/**
+	 * @return nome do emissor.
+	 * @throw EncodeException caso o cabeçalho da LCR seja inválido.
+	 */
+	RDNSequence getIssuer() throw (EncodeException);
+
+	/**
+	 * @return data de emissão (thisUpdate).
+	 * @throw EncodeException caso o cabeçalho da LCR seja inválido.
+	 */
+	time_t getThisUpdate() throw (EncodeException);
+
+	/**
+	 * @return data da próxima atualização (nextUpdate), ou 0 se ausente.
+	 * @throw EncodeException caso o cabeçalho da LCR seja inválido.
+	 */
+	time_t getNextUpdate() throw (EncodeException);
+
+	/**
+	 * Lê o próximo certificado revogado.
+	 * @param entry recebe a entrada lida.
+	 * @return true se uma entrada foi lida, false no fim da lista.
+	 * @throw EncodeException caso a codificação seja inválida, o fluxo termine antes do esperado
+	 * ou a entrada tenha uma extensão crítica diferente de reasonCode.
+	 */
+	bool next(CertificateRevocationListReader::Entry &entry) throw (EncodeException);
+
+	/**
+	 * Lê as entradas restantes, passando cada uma ao handler.
+	 * @param handler recebe as entradas; pode interromper a leitura.
+	 * @return quantidade de entradas passadas ao handler.
+	 * @throw EncodeException caso a codificação seja inválida ou o fluxo termine antes do esperado.
+	 */
+	unsigned long read(CertificateRevocationListReader::Handler &handler) throw (EncodeException);
+
+	/**
+	 * Escreve o cabeçalho e as entradas restantes no documento à medida que são lidas,
+	 * com os nomes de campos de CertificateRevocationList::write(). O algoritmo de
+	 * assinatura, as extensões e a assinatura não são escritos.
+	 * @param writer documento de destino.
+	 * @return quantidade de entradas escritas.
+	 * @throw EncodeException caso a codificação seja inválida ou o fluxo termine antes do esperado.
+	 */
+	unsigned long write(DocumentWriter &writer) throw (EncodeException);
+
+	/**
+	 * Conclui a leitura, descartando as entradas restantes, e verifica a assinatura.
+	 * @return true se a chave foi informada e a assinatura é válida.
+	 * @throw EncodeException caso a codificação seja inválida ou o fluxo termine antes do esperado.
+	 */
+	bool verify() throw (EncodeException);
+
+	/**
+	 * @return quantidade de entradas lidas até o momento.
+	 */
+	unsigned long getCount() const;
+
+	/**
+	 * Codifica um número de série como o conteúdo de Entry::serialNumber, para comparação direta.
+	 * @param serialNumber número de série.
+	 * @param content recebe o conteúdo do INTEGER DER.
+	 * @return false se o número não puder ser codificado.
+	 */
+	static bool getSerialNumberContent(const BigInteger &serialNumber, std::string &content);
+
+protected:
+
+	enum State
+	{
+		START,
+		ENTRIES,
+		TRAILER,
+		DONE,
+	};
+
+	void init();
+	void readHeader() throw (EncodeException);
+	void readTrailer() throw (EncodeException);
+
+	/* garante length bytes disponíveis a partir de position */
+	bool fill(unsigned long length) throw (EncodeException);
+	/* verifica se o elemento de length bytes em offset + at termina até end e pode ser lido inteiro no buffer */
+	bool isWithin(unsigned long at, unsigned long length, unsigned long end) const;
+	/* lê um cabeçalho TLV sem consumi-lo; lança exceção se o fluxo terminar */
+	void peekHeader(unsigned long at, unsigned char &tag,
+			unsigned long &headerLength, unsigned long &contentLength, const char *where) throw (EncodeException);
+	/* avança length bytes, passando ao resumo os que pertencem ao TBSCertList */
+	void consume(unsigned long length) throw (EncodeException);
+	void skip(unsigned long length) throw (EncodeException);
+	void readEntry(const unsigned char *p, const unsigned char *end, CertificateRevocationListReader::Entry &entry) throw (EncodeException);
+	void startDigest(const unsigned char *algorithm, unsigned long length);
+
+	static bool readHeader(const unsigned char *p, const unsigned char *end,
+			unsigned char &tag, unsigned long &headerLength, unsigned long &contentLength);
+	static bool readTime(const unsigned char *p, unsigned char tag, unsigned long length, time_t &time);
+
+	std::istream *stream;
+	std::vector<unsigned char> buffer;
+	/* bytes válidos ficam em data[position, limit) */
+	const unsigned char *data;
+	unsigned long position;
+	unsigned long limit;
+	/* posição absoluta de data[position] na LCR */
+	unsigned long offset;
+
+	State state;
+	/* fim do CertificateList, segundo o seu cabeçalho */
+	unsigned long crlEnd;
+	unsigned long tbsBegin;
+	unsigned long tbsEnd;
+	unsigned long entriesEnd;
+	unsigned long count;
+
+	long version;
+	std::string issuer;
+	time_t thisUpdate;
+	time_t nextUpdate;
+
+	EVP_PKEY *key;
+	EVP_MD_CTX *digest;
+	/* TBSCertList guardado para algoritmos sem resumo separado */
+	bool keepTbs;
+	std::string tbs;
+	std::string signatureAlgorithm;
+	bool valid;
+
+private:
+
+	CertificateRevocationListReader(const CertificateRevocationListReader &);
+	CertificateRevocationListReader& operator=(const CertificateRevocationListReader &);
+};
+
+#endif /* CERTIFICATEREVOCATIONLISTREADER_H_ */
@@ -0,0 +1,261 @@
+#ifndef CERTIFICATESTORE_H_
+#define CERTIFICATESTORE_H_
+
+#include <openssl/crypto.h>
+#include <openssl/x509.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <libcryptosec/BigInteger.h>
+#include <libcryptosec/ByteArray.h>
+#include <libcryptosec/MappedFile.h>
+
+#include "Certificate.h"
+#include "CertificateView.h"
+#include "RDNSequence.h"
+
+#include <libcryptosec/exception/EncodeException.h>
+
+/**
+ * @brief Conjunto de certificados carregado em lote.
+ * Pacotes PEM e diretórios de certificados são mapeados em memória, os blocos
+ * PEM são localizados por uma varredura única do arquivo e a decodificação
+ * Base64/DER é distribuída entre várias threads.
+ * Os certificados são indexados por titular, identificador de chave (SKI),
+ * emissor e número de série e resumo SHA-256, de forma que a busca por emissores
+ * durante a validação de caminhos não precise percorrer todos os certificados.
+ * Os índices são imutáveis: cada alteração constrói uma nova versão (cópia na
+ * escrita) e a troca de versões é a única operação feita sob trava exclusiva,
+ * o que permite consultas concorrentes enquanto o repositório é atualizado.
+ * Os certificados pertencem ao repositório; os objetos Certificate retornados
+ * compartilham a mesma estrutura X509 (com contagem de referências).
+ * @see CertPathValidator
+ */
+class CertificateStore
+{
+
+public:
+
+	/**
+	 * Cria um repositório vazio, que usa uma thread por processador na carga.
+	 */
+	CertificateStore();
+
+	/**
+	 * Destrutor padrão, libera os certificados.
+	 */
+	virtual ~CertificateStore();
+
+	/**
+	 * Define a quantidade de threads usadas na decodificação.
+	 * @param threads número de threads; 0 usa uma por processador.
+	 */
+	void setThreads(unsigned int threads);
+
+	/**
+	 * Habilita o descarte de certificados repetidos, comparando o resumo SHA-256 do DER.
+	 * @param deduplicate true para descartar certificados já presentes no repositório.
+	 */
+	void setDeduplicate(bool deduplicate);
+
+	/**
+	 * Carrega todos os certificados de um arquivo PEM com um ou mais blocos
+	 * "CERTIFICATE". Outros blocos (chaves, LCRs) são ignorados.
+	 * A carga é atômica: se algum certificado for inválido nenhum é adicionado.
+	 * @param path caminho do arquivo.
+	 * @return quantidade de certificados adicionados.
+	 * @throw EncodeException caso o arquivo não possa ser lido ou algum bloco seja inválido.
+	 */
+	unsigned int loadPemBundle(std::string path) throw (EncodeException);
+
+	/**
+	 * Carrega os certificados de todos os arquivos regulares de um diretório
+	 * (sem recursão). Arquivos PEM podem conter vários certificados e arquivos
+	 * DER podem conter certificados concatenados; arquivos que não contêm
+	 * certificados são ignorados.
+	 * @param path caminho do diretório.
+	 * @return quantidade de certificados adicionados.
+	 * @throw EncodeException caso o diretório não possa ser lido ou algum bloco PEM seja inválido.
+	 */
+	unsigned int loadDirectory(std::string path) throw (EncodeException);
+
+	/**
+	 * Adiciona um certificado ao repositório.
+	 * Cada chamada publica uma nova versão, que copia os índices da atual; para
+	 * adicionar muitos certificados deve ser usado addCertificates().
+	 * @param certificate certificado a ser adicionado.
+	 * @return true se adicionado, false se descartado por ser repetido.
+	 */
+	bool addCertificate(const Certificate &certificate);
+
+	/**
+	 * Adiciona vários certificados ao repositório, publicando uma única versão.
+	 * @param certificates certificados a serem adicionados.
+	 * @return quantidade de certificados adicionados.
+	 */
+	unsigned int addCertificates(const std::vector<Certificate> &certificates);
+
+	/**
+	 * @return quantidade de certificados no repositório.
+	 */
+	unsigned int size() const;
+
+	/**
+	 * @return os certificados do repositório, na ordem de carga. Os objetos
+	 * devem ser liberados pelo chamador.
+	 */
+	std::vector<Certificate *> getCertificates() const;
+
+	/**
+	 * @return número da versão atual do repositório, incrementado a cada alteração.
+	 */
+	unsigned long getGeneration() const;
+
+	/**
+	 * @return identificador do repositório, único no processo. Junto com
+	 * getGeneration() identifica o conteúdo do repositório, mesmo que outro
+	 * repositório venha a ocupar o mesmo endereço.
+	 */
+	unsigned long getIdentifier() const;
+
+	/**
+	 * @param certificate certificado procurado.
+	 * @return true se um certificado com a mesma codificação DER está no repositório.
+	 */
+	bool contains(const Certificate &certificate) const;
+
+	/**
+	 * Busca certificados pelo nome do titular.
+	 * @param subject nome do titular.
+	 * @return certificados encontrados, que devem ser liberados pelo chamador.
+	 */
+	std::vector<Certificate *> findBySubject(RDNSequence &subject) const;
+
+	/**
+	 * Busca certificados pelo identificador de chave do titular (extensão Subject Key Identifier).
+	 * @param keyIdentifier identificador da chave.
+	 * @return certificados encontrados, que devem ser liberados pelo chamador.
+	 */
+	std::vector<Certificate *> findByKeyIdentifier(ByteArray &keyIdentifier) const;
+
+	/**
+	 * Busca um certificado pelo nome do emissor e número de série.
+	 * @param issuer nome do emissor.
+	 * @param serialNumber número de série.
+	 * @return certificado encontrado, que deve ser liberado pelo chamador, ou NULL.
+	 */
+	Certificate* findByIssuerAndSerial(RDNSequence &issuer, const BigInteger &serialNumber) const;
+
+	/**
+	 * Busca um certificado pelo resumo SHA-256 de sua codificação DER.
+	 * @param fingerprint resumo SHA-256 do certificado.
+	 * @return certificado encontrado, que deve ser liberado pelo chamador, ou NULL.
+	 */
+	Certificate* findByFingerPrint(ByteArray &fingerprint) const;
+
+	/**
+	 * Busca os possíveis emissores de um certificado: pelo Authority Key
+	 * Identifier quando presente e, na falta dele, pelo nome do emissor.
+	 * Só são retornados candidatos aceitos por X509_check_issued.
+	 * @param certificate certificado cujo emissor é procurado.
+	 * @return emissores encontrados, que devem ser liberados pelo chamador.
+	 */
+	std::vector<Certificate *> findIssuers(const Certificate &certificate) const;
+
+	/**
+	 * Versão para uso interno de findBySubject.
+	 * @param name nome do titular.
+	 * @return pilha com novas referências dos certificados, ou NULL se nenhum for encontrado.
+	 */
+	STACK_OF(X509)* getX509BySubject(X509_NAME *name) const;
+
+	/**
+	 * Versão para uso interno de findIssuers.
+	 * @param cert certificado cujo emissor é procurado.
+	 * @return pilha com novas referências dos emissores, ou NULL se nenhum for encontrado.
+	 */
+	STACK_OF(X509)* getX509Issuers(X509 *cert) const;
+
+protected:
+
+	/**
+	 * Trecho de um arquivo mapeado que contém um certificado.
+	 */
+	struct Block
+	{
+		const unsigned char *data;
+		unsigned long length;
+		bool base64;
+	};
+
+	struct DecodeTask
+	{
+		const std::vector<Block> *blocks;
+		unsigned int begin;
+		unsigned int end;
+		std::vector<X509 *> *certificates;
+		std::vector<std::string> *fingerprints;
+		bool failed;
+	};
+
+	/**
+	 * Versão imutável do conteúdo do repositório com seus índices.
+	 */
+	struct Snapshot
+	{
+		unsigned long generation;
+		std::vector<X509 *> certificates;
+		std::map<std::string, X509 *> byFingerprint;
+		std::multimap<unsigned long, X509 *> bySubject;
+		std::multimap<std::string, X509 *> byKeyIdentifier;
+		std::multimap<std::string, X509 *> byIssuerSerial;
+	};
+
+	unsigned int load(const std::vector<Block> &blocks) throw (EncodeException);
+	unsigned int getThreadCount(unsigned int jobs) const;
+
+	static void scanPem(const unsigned char *data, unsigned long length, std::vector<Block> &blocks) throw (EncodeException);
+	static void scanDer(const unsigned char *data, unsigned long length, std::vector<Block> &blocks);
+	static bool decodeBase64(const unsigned char *data, unsigned long length, std::string &out);
+	static std::string getFingerPrint(const unsigned char *der, unsigned long length);
+	static bool getFingerPrint(X509 *cert, std::string &fingerprint);
+	static void *decode(void *task);
+
+	static Snapshot* copySnapshot(const Snapshot *snapshot);
+	static void freeSnapshot(Snapshot *snapshot);
+	static bool insert(Snapshot *snapshot, X509 *cert, const std::string &fingerprint, bool deduplicate);
+	static std::string getIssuerSerialKey(X509_NAME *issuer, const ASN1_INTEGER *serial);
+	static std::string getKeyIdentifierKey(const ASN1_OCTET_STRING *keyIdentifier);
+
+	/**
+	 * Constrói uma nova versão com os certificados dados e a publica.
+	 * Assume a posse dos certificados, inclusive dos descartados.
+	 */
+	unsigned int publish(const std::vector<X509 *> &certs, const std::vector<std::string> &fingerprints);
+	void findBySubject(const Snapshot *snapshot, X509_NAME *name, std::vector<X509 *> &found) const;
+	void findIssuers(const Snapshot *snapshot, X509 *cert, std::vector<X509 *> &found) const;
+	static std::vector<Certificate *> toCertificates(const std::vector<X509 *> &certs);
+	static void initIdentifiers();
+
+	Snapshot *snapshot;
+	/* protege a troca de versões; consultas usam a trava compartilhada */
+	CRYPTO_RWLOCK *lock;
+	/* serializa as alterações, que constroem a nova versão fora da trava */
+	CRYPTO_RWLOCK *writeLock;
+	unsigned int threads;
+	bool deduplicate;
+	unsigned long identifier;
+
+	static CRYPTO_ONCE identifiersOnce;
+	static CRYPTO_RWLOCK *identifiersLock;
+	static unsigned long nextIdentifier;
+
+private:
+
+	CertificateStore(const CertificateStore &);
+	CertificateStore& operator=(const CertificateStore &);
+};
+
+#endif /* CERTIFICATESTORE_H_ */
@@ -0,0 +1,192 @@
+#ifndef CERTIFICATEVIEW_H_
+#define CERTIFICATEVIEW_H_
+
+#include <openssl/x509.h>
+
+#include <libcryptosec/ByteArray.h>
+#include <libcryptosec/BigInteger.h>
+#include <libcryptosec/DateTime.h>
+#include <libcryptosec/MessageDigest.h>
+#include <libcryptosec/PublicKey.h>
+
+#include "Certificate.h"
+#include "RDNSequence.h"
+
+#include <libcryptosec/exception/CertificationException.h>
+#include <libcryptosec/exception/EncodeException.h>
+
+/**
+ * @brief Visão somente leitura de um certificado codificado em DER.
+ * A construção percorre o DER uma única vez e guarda apenas a posição de cada
+ * campo do TBSCertificate, sem alocar memória nem decodificar valores. Cada
+ * campo é decodificado somente quando solicitado.
+ * A visão não copia o buffer de entrada: ele (ou o MappedFile de onde veio)
+ * deve permanecer válido enquanto a visão for usada.
+ * @see Certificate
+ * @see MappedFile
+ */
+class CertificateView
+{
+
+public:
+
+	/**
+	 * Campos indexados do certificado.
+	 */
+	enum Field
+	{
+		TBS_CERTIFICATE = 0,
+		VERSION = 1,
+		SERIAL_NUMBER = 2,
+		TBS_SIGNATURE_ALGORITHM = 3,
+		ISSUER = 4,
+		VALIDITY = 5,
+		NOT_BEFORE = 6,
+		NOT_AFTER = 7,
+		SUBJECT = 8,
+		SUBJECT_PUBLIC_KEY_INFO = 9,
+		ISSUER_UNIQUE_ID = 10,
+		SUBJECT_UNIQUE_ID = 11,
+		EXTENSIONS = 12,
+		SIGNATURE_ALGORITHM = 13,
+		SIGNATURE_VALUE = 14,
+		FIELD_COUNT = 15,
+	};
+
+	/**
+	 * Indexa o primeiro certificado encontrado no buffer.
+	 * Bytes após o fim do certificado são ignorados; getEncodedLength() informa
+	 * quantos bytes foram consumidos, permitindo percorrer certificados concatenados.
+	 * @param der certificado codificado em DER.
+	 * @param length tamanho do buffer.
+	 * @throw EncodeException caso o DER não tenha a estrutura de um certificado.
+	 */
+	CertificateView(const unsigned char *der, unsigned long length) throw (EncodeException);
+
+	/**
+	 * Indexa o certificado contido no ByteArray, que não é copiado.
+	 * @param derEncoded certificado codificado em DER.
+	 * @throw EncodeException caso o DER não tenha a estrutura de um certificado.
+	 */
+	CertificateView(ByteArray &derEncoded) throw (EncodeException);
+
+	virtual ~CertificateView();
+
+	/**
+	 * @return tamanho total do certificado codificado, em bytes.
+	 */
+	unsigned long getEncodedLength() const;
+
+	/**
+	 * @return ponteiro para o início do certificado no buffer de entrada.
+	 */
+	const unsigned char* getEncoded() const;
+
+	/**
+	 * @param field campo desejado.
+	 * @return true se o campo está presente no certificado.
+	 */
+	bool hasField(CertificateView::Field field) const;
+
+	/**
+	 * Obtém a codificação DER completa (tag, tamanho e conteúdo) de um campo,
+	 * apontando diretamente para o buffer de entrada.
+	 * @param field campo desejado.
+	 * @param length recebe o tamanho do campo.
+	 * @return ponteiro para o campo ou NULL caso o campo esteja ausente.
+	 */
+	const unsigned char* getField(CertificateView::Field field, unsigned long &length) const;
+
+	/**
+	 * @param field campo desejado.
+	 * @return cópia da codificação DER do campo.
+	 * @throw CertificationException caso o campo esteja ausente.
+	 */
+	ByteArray getFieldDerEncoded(CertificateView::Field field) const throw (CertificationException);
+
+	/**
+	 * @return versão do certificado (0 para v1, 2 para v3).
+	 * @throw CertificationException caso a versão não seja válida.
+	 */
+	long getVersion() const throw (CertificationException);
+
+	/**
+	 * @return número de série do certificado.
+	 * @throw CertificationException caso o número de série não possa ser decodificado.
+	 */
+	BigInteger getSerialNumberBigInt() const throw (CertificationException);
+
+	/**
+	 * @return emissor do certificado.
+	 * @throw CertificationException caso o nome não possa ser decodificado.
+	 */
+	RDNSequence getIssuer() const throw (CertificationException);
+
+	/**
+	 * @return titular do certificado.
+	 * @throw CertificationException caso o nome não possa ser decodificado.
+	 */
+	RDNSequence getSubject() const throw (CertificationException);
+
+	/**
+	 * @return hash do nome do emissor, igual ao calculado por X509_NAME_hash
+	 * (usado nos nomes de arquivos de diretórios de certificados do OpenSSL).
+	 * @throw CertificationException caso o nome não possa ser decodificado.
+	 */
+	unsigned long getIssuerHash() const throw (CertificationException);
+
+	/**
+	 * @return hash do nome do titular, igual ao calculado por X509_NAME_hash.
+	 * @throw CertificationException caso o nome não possa ser decodificado.
+	 */
+	unsigned long getSubjectHash() const throw (CertificationException);
+
+	/**
+	 * @return início da validade do certificado.
+	 * @throw CertificationException caso a data não possa ser decodificada.
+	 */
+	DateTime getNotBefore() const throw (CertificationException);
+
+	/**
+	 * @return fim da validade do certificado.
+	 * @throw CertificationException caso a data não possa ser decodificada.
+	 */
+	DateTime getNotAfter() const throw (CertificationException);
+
+	/**
+	 * @return chave pública do titular.
+	 * @throw CertificationException caso a chave não possa ser decodificada.
+	 */
+	PublicKey* getPublicKey() const throw (CertificationException, AsymmetricKeyException);
+
+	/**
+	 * @param algorithm algoritmo de resumo.
+	 * @return resumo do certificado inteiro, igual a Certificate::getFingerPrint.
+	 * @throw MessageDigestException caso o resumo não possa ser calculado.
+	 */
+	ByteArray getFingerPrint(MessageDigest::Algorithm algorithm) const throw (MessageDigestException);
+
+	/**
+	 * Decodifica o certificado inteiro.
+	 * @return novo objeto Certificate.
+	 * @throw EncodeException caso o OpenSSL não aceite a codificação.
+	 */
+	Certificate toCertificate() const throw (EncodeException);
+
+private:
+
+	void index(unsigned long length) throw (EncodeException);
+	void setField(CertificateView::Field field, const unsigned char *begin, unsigned long length);
+	X509_NAME* decodeName(CertificateView::Field field, const char *where) const throw (CertificationException);
+	DateTime decodeTime(CertificateView::Field field, const char *where) const throw (CertificationException);
+
+	static bool readHeader(const unsigned char *p, const unsigned char *end,
+			unsigned char &tag, unsigned long &headerLength, unsigned long &contentLength);
+
+	const unsigned char *der;
+	unsigned long length;
+	unsigned long offsets[FIELD_COUNT];
+	unsigned long lengths[FIELD_COUNT];
+};
+
+#endif /* CERTIFICATEVIEW_H_ */
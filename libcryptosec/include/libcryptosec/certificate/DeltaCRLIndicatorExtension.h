@@ -26,6 +26,7 @@ public:
 	void setSerial(unsigned long serial); //TODO
 	const long getSerial() const; //TODO
 protected:
+	virtual void writeValue(DocumentWriter &writer);
 	unsigned long baseCrlNumber;
 };
 
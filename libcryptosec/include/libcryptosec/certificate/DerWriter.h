@@ -0,0 +1,159 @@
+#ifndef DERWRITER_H_
+#define DERWRITER_H_
+
+#include <openssl/asn1.h>
+#include <openssl/evp.h>
+
+#include <string>
+#include <vector>
+
+#include <libcryptosec/ByteArray.h>
+#include "ObjectIdentifier.h"
+
+/**
+ * @brief Escreve estruturas ASN.1 em DER diretamente em um único buffer, sem montar
+ * as estruturas intermediárias do OpenSSL.
+ * A mesma sequência de chamadas deve ser feita duas vezes: na primeira passada
+ * são calculados os tamanhos de todos os elementos; startWriting() aloca o buffer com
+ * o tamanho total e, na segunda passada, os bytes são escritos nele.
+ * Os elementos construídos (SEQUENCE, SET, tags explícitas e o conteúdo de OCTET STRING
+ * que contém outra estrutura) são delimitados por begin() e end().
+ * A codificação é a mesma produzida pelo OpenSSL para os mesmos valores.
+ */
+class DerWriter
+{
+
+public:
+
+	enum Tag
+	{
+		BOOLEAN = 0x01,
+		INTEGER = 0x02,
+		BIT_STRING = 0x03,
+		OCTET_STRING = 0x04,
+		OBJECT = 0x06,
+		UTF8_STRING = 0x0c,
+		IA5_STRING = 0x16,
+		SEQUENCE = 0x30,
+		SET = 0x31,
+		/* somados ao número da tag, como CONTEXT_CONSTRUCTED | 1 para [1] */
+		CONTEXT_SPECIFIC = 0x80,
+		CONTEXT_CONSTRUCTED = 0xa0,
+	};
+
+	DerWriter();
+	virtual ~DerWriter();
+
+	/**
+	 * Inicia um elemento cujo conteúdo são os elementos escritos até o end() correspondente.
+	 * @param tag tag do elemento.
+	 */
+	void begin(unsigned char tag);
+
+	/**
+	 * Termina o elemento iniciado pelo último begin() ainda aberto.
+	 */
+	void end();
+
+	void writeBoolean(bool value);
+	void writeInteger(long value, unsigned char tag = DerWriter::INTEGER);
+
+	/**
+	 * Escreve um OID. Objetos sem OID fazem a codificação falhar.
+	 */
+	void writeObject(const ASN1_OBJECT *object);
+	void writeObject(const ObjectIdentifier &objectIdentifier);
+
+	/**
+	 * Escreve um elemento primitivo com o conteúdo dado, como OCTET STRING ou IA5String.
+	 */
+	void writePrimitive(unsigned char tag, const unsigned char *data, unsigned int length);
+	void writePrimitive(unsigned char tag, const std::string &data);
+
+	/**
+	 * Escreve um BIT STRING de bits nomeados: os bytes e bits zero do final são omitidos,
+	 * como faz o OpenSSL.
+	 * @param bits valor de cada bit, a partir do bit 0.
+	 * @param count quantidade de bits.
+	 */
+	void writeBitString(const bool *bits, unsigned int count, unsigned char tag = DerWriter::BIT_STRING);
+
+	/**
+	 * Escreve um elemento já codificado em DER, como o de um nome.
+	 */
+	void writeEncoded(const unsigned char *data, unsigned int length);
+
+	/**
+	 * Indica que os valores não podem ser codificados diretamente; a codificação deve
+	 * então ser feita pelo OpenSSL.
+	 */
+	void fail();
+
+	/**
+	 * Termina a passada de cálculo dos tamanhos e aloca o buffer.
+	 * @return false se a codificação falhou ou algum elemento não foi terminado.
+	 */
+	bool startWriting();
+
+	bool isWriting() const;
+
+	/**
+	 * @return true se a codificação falhou, inclusive se a segunda passada não repetiu a primeira.
+	 */
+	bool hasFailed() const;
+
+	/**
+	 * @return codificação escrita na segunda passada.
+	 */
+	ByteArray& getEncoded();
+
+	/**
+	 * Acrescenta o cabeçalho DER (tag e tamanho) de um elemento em out; usado por quem
+	 * monta a codificação em partes, como CertificateRevocationListBuilder e IssuanceTemplate.
+	 * @param tag tag do elemento.
+	 * @param length tamanho do conteúdo.
+	 * @param out destino do cabeçalho.
+	 */
+	static void encodeHeader(unsigned char tag, unsigned long length, std::string &out);
+
+	/**
+	 * @param length tamanho do conteúdo.
+	 * @return tamanho do cabeçalho DER de um elemento com esse conteúdo.
+	 */
+	static unsigned int getHeaderLength(unsigned long length);
+
+	/**
+	 * Acrescenta em out o AlgorithmIdentifier de uma assinatura, obtido como faz o
+	 * ASN1_item_sign_ctx(): pelo método de assinatura do tipo da chave, que define por
+	 * exemplo os parâmetros do RSA-PSS e os OIDs de tipos de chave de outros provedores,
+	 * ou, na falta dele, pelo OID que combina o resumo e o tipo da chave. Para isso uma
+	 * estrutura vazia é assinada uma vez.
+	 * @param key chave de assinatura.
+	 * @param md resumo, ou NULL para chaves que assinam a mensagem inteira.
+	 * @param out destino da codificação.
+	 * @return false se a chave e o resumo não formam um algoritmo de assinatura conhecido.
+	 */
+	static bool encodeSignatureAlgorithm(EVP_PKEY *key, const EVP_MD *md, std::string &out);
+
+protected:
+
+	void add(unsigned long length);
+	bool reserve(unsigned long length);
+	void writeHeader(unsigned char tag, unsigned long length);
+	/* escreve o cabeçalho em out, que deve ter getHeaderLength(length) bytes */
+	static void encodeHeader(unsigned char tag, unsigned long length, unsigned char *out);
+
+	/* tamanho do conteúdo de cada elemento construído, na ordem dos begin() */
+	std::vector<unsigned long> lengths;
+	/* posições em lengths dos elementos ainda abertos, na primeira passada */
+	std::vector<unsigned long> open;
+	unsigned long next;
+	unsigned long total;
+	ByteArray encoded;
+	unsigned char *position;
+	unsigned char *limit;
+	bool writing;
+	bool failed;
+};
+
+#endif /* DERWRITER_H_ */
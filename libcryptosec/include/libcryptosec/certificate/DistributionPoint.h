@@ -29,6 +29,12 @@ public:
 	void setCrlIssuer(GeneralNames &crlIssuer);
 	GeneralNames getCrlIssuer();
 	DIST_POINT* getDistPoint();
+
+	/**
+	 * Escreve o ponto de distribuição em DER.
+	 */
+	void encode(DerWriter &writer) const;
+	void write(DocumentWriter &writer);
 	static std::string reasonFlag2Name(DistributionPoint::ReasonFlags reason);
 protected:
 	DistributionPointName distributionPointName;
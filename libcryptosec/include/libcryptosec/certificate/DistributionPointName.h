@@ -29,6 +29,12 @@ public:
 	GeneralNames getFullName();
 	DistributionPointName::Type getType() const;
 	DIST_POINT_NAME* getDistPointName();
+
+	/**
+	 * Escreve o nome em DER. A codificação falha para nomes relativos ao emissor da LCR.
+	 */
+	void encode(DerWriter &writer) const;
+	void write(DocumentWriter &writer);
 protected:
 	GeneralNames fullName;
 	RDNSequence relativeName;
@@ -0,0 +1,71 @@
+#ifndef DOCUMENTWRITER_H_
+#define DOCUMENTWRITER_H_
+
+#include <openssl/asn1.h>
+
+#include <ostream>
+#include <string>
+#include <time.h>
+
+#include <libcryptosec/ByteArray.h>
+
+/**
+ * @brief Escreve documentos estruturados (estruturas com campos nomeados e listas)
+ * diretamente em um std::ostream, à medida que os campos são visitados, sem montar o
+ * documento em memória.
+ * Os métodos write() de Certificate, CertificateRevocationList, CertificateRequest e das
+ * extensões percorrem seus campos sempre da mesma forma; a subclasse define o formato.
+ * Cada escritor produz um único documento, cuja raiz é a primeira estrutura iniciada.
+ * @see XmlWriter
+ * @see JsonWriter
+ */
+class DocumentWriter
+{
+
+public:
+
+	DocumentWriter(std::ostream &stream);
+	virtual ~DocumentWriter();
+
+	/**
+	 * Inicia uma estrutura com campos nomeados, terminada por end().
+	 * @param name nome da estrutura; nos itens de listas, é usado apenas em XML.
+	 */
+	virtual void begin(const std::string &name) = 0;
+
+	/**
+	 * Inicia uma lista, terminada por end(). Os campos e estruturas escritos nela são os itens.
+	 */
+	virtual void beginList(const std::string &name) = 0;
+
+	virtual void end() = 0;
+
+	void write(const std::string &name, const std::string &value);
+	void write(const std::string &name, const char *value);
+	/* sem esta sobrecarga, um literal int seria ambíguo entre long e bool */
+	void write(const std::string &name, int value);
+	void write(const std::string &name, long value);
+	void write(const std::string &name, bool value);
+
+	/**
+	 * Escreve os bytes em base64.
+	 */
+	void writeBase64(const std::string &name, const unsigned char *data, unsigned int length);
+
+	/**
+	 * Escreve o instante em UTC no formato ISO 8601, como "2024-01-31T23:59:59Z".
+	 */
+	void writeTime(const std::string &name, time_t value);
+	void writeTime(const std::string &name, const ASN1_TIME *value);
+
+protected:
+
+	/**
+	 * @param text false para números e valores lógicos, que em JSON não ficam entre aspas.
+	 */
+	virtual void writeField(const std::string &name, const std::string &value, bool text) = 0;
+
+	std::ostream &stream;
+};
+
+#endif /* DOCUMENTWRITER_H_ */
@@ -27,6 +27,8 @@ public:
 	std::vector<ObjectIdentifier> getUsages();
 	X509_EXTENSION* getX509Extension();
 protected:
+	virtual void encodeValue(DerWriter &writer);
+	virtual void writeValue(DocumentWriter &writer);
 	std::vector<ObjectIdentifier> usages;
 };
 
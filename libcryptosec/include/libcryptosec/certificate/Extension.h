@@ -6,10 +6,13 @@
 
 #include <libcryptosec/Base64.h>
 
+#include "DerWriter.h"
+#include "DocumentWriter.h"
 #include "ObjectIdentifier.h"
 #include "ObjectIdentifierFactory.h"
 
 #include <libcryptosec/exception/CertificationException.h>
+#include <libcryptosec/exception/EncodeException.h>
 
 class Extension
 {
@@ -53,10 +56,42 @@ public:
 	void setCritical(bool critical);
 	bool isCritical() const;
 	virtual X509_EXTENSION* getX509Extension();
+
+	/**
+	 * As extensões que sabem escrever o próprio valor são codificadas diretamente,
+	 * sem passar pelas estruturas do OpenSSL; as demais, a partir de getX509Extension().
+	 * @return codificação DER da extensão, a mesma de i2d_X509_EXTENSION(getX509Extension()).
+	 */
+	ByteArray getDerEncoded() throw (EncodeException);
+
+	/**
+	 * Escreve a extensão no documento, com o valor decodificado pelas extensões
+	 * conhecidas e em base64 pelas demais.
+	 */
+	void write(DocumentWriter &writer);
+
 	static Extension::Name getName(int nid);
 	static Extension::Name getName(X509_EXTENSION *ext);
 protected:
 	Extension();
+
+	/**
+	 * Escreve o valor da extensão, o conteúdo de extnValue. A implementação padrão
+	 * faz a codificação falhar, para que seja feita pelo OpenSSL.
+	 */
+	virtual void encodeValue(DerWriter &writer);
+
+	/**
+	 * Escreve os campos do valor da extensão, dentro de extnValue.
+	 */
+	virtual void writeValue(DocumentWriter &writer);
+
+	/**
+	 * @return extensão com o valor escrito por encodeValue(), ou NULL se ele não puder
+	 * ser escrito diretamente.
+	 */
+	X509_EXTENSION* encodeX509Extension(int nid);
+
 	ObjectIdentifier objectIdentifier;
 	bool critical;
 	ByteArray value;
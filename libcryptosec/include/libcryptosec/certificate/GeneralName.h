@@ -5,6 +5,8 @@
 
 #include <string>
 
+#include "DerWriter.h"
+#include "DocumentWriter.h"
 #include "ObjectIdentifier.h"
 #include "RDNSequence.h"
 
@@ -46,6 +48,13 @@ public:
 	ObjectIdentifier getRegisteredId() const;
 	GeneralName::Type getType() const;
 	GENERAL_NAME* getGeneralName();
+
+	/**
+	 * Escreve o nome em DER, como getGeneralName() seria codificado pelo OpenSSL.
+	 * A codificação falha para outros nomes cujo OID não está registrado.
+	 */
+	void encode(DerWriter &writer) const;
+	void write(DocumentWriter &writer);
 	static std::string type2Name(GeneralName::Type type);
 	GeneralName& operator=(const GeneralName& value);
 	static std::string  data2IpAddress(unsigned char *data);
@@ -25,6 +25,13 @@ public:
 	std::vector<GeneralName> getGeneralNames() const;
 	int getNumberOfEntries() const;
 	GENERAL_NAMES* getInternalGeneralNames();
+
+	/**
+	 * Escreve a sequência de nomes em DER.
+	 * @param tag tag da sequência, para os usos com tag implícita.
+	 */
+	void encode(DerWriter &writer, unsigned char tag = DerWriter::SEQUENCE) const;
+	void write(DocumentWriter &writer, const std::string &name = "generalNames");
 	GeneralNames& operator=(const GeneralNames& value);
 protected:
 	std::vector<GeneralName> generalNames;
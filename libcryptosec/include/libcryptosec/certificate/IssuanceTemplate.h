@@ -0,0 +1,182 @@
+#ifndef ISSUANCETEMPLATE_H_
+#define ISSUANCETEMPLATE_H_
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#include <string>
+#include <vector>
+
+#include <libcryptosec/BigInteger.h>
+#include <libcryptosec/ByteArray.h>
+#include <libcryptosec/DateTime.h>
+#include <libcryptosec/MessageDigest.h>
+#include <libcryptosec/PrivateKey.h>
+#include <libcryptosec/PublicKey.h>
+
+#include "Certificate.h"
+#include "CertificateBuilder.h"
+#include "CertificateRequest.h"
+#include "Extension.h"
+#include "RDNSequence.h"
+
+#include <libcryptosec/exception/CertificationException.h>
+#include <libcryptosec/exception/EncodeException.h>
+
+/**
+ * @brief Modelo de emissão de certificados de uma AC.
+ * Os campos que não mudam entre os certificados emitidos (versão, algoritmo
+ * de assinatura, emissor e extensões como AIA, pontos de distribuição de
+ * LCR, políticas e uso de chave) são codificados em DER uma única vez, a
+ * partir de um CertificateBuilder. Cada emissão apenas monta o TBSCertificate
+ * com o número de série, a validade, o titular, a chave pública e as
+ * extensões próprias do certificado, e calcula a assinatura sobre ele, sem
+ * montar a estrutura X509.
+ * Depois de configurado, o modelo pode ser usado por várias threads.
+ * @see CertificateBuilder
+ */
+class IssuanceTemplate
+{
+
+public:
+
+	/**
+	 * Cria o modelo a partir dos campos invariantes de um builder.
+	 * São usados a versão, o emissor e as extensões do builder; os demais campos são ignorados.
+	 * Se houver extensões, a versão é sempre v3; um modelo sem extensões emite
+	 * certificados v3 apenas quando eles têm extensões próprias.
+	 * @param builder builder com o emissor e as extensões comuns.
+	 * @param privateKey chave privada do emissor.
+	 * @param messageDigestAlgorithm algoritmo de resumo; ignorado para chaves EdDSA.
+	 * @throw CertificationException caso o algoritmo de assinatura não seja suportado ou
+	 * o builder tenha duas extensões com o mesmo OID.
+	 * @throw EncodeException caso os campos não possam ser codificados.
+	 */
+	IssuanceTemplate(CertificateBuilder &builder, PrivateKey &privateKey, MessageDigest::Algorithm messageDigestAlgorithm)
+			throw (CertificationException, EncodeException);
+
+	/**
+	 * Destrutor padrão.
+	 */
+	virtual ~IssuanceTemplate();
+
+	/**
+	 * Define se cada certificado recebe a extensão SubjectKeyIdentifier,
+	 * calculada com o SHA-1 da chave pública (RFC 5280, seção 4.2.1.2).
+	 * Deve ser chamado antes das emissões.
+	 * @param subjectKeyIdentifier true para incluir a extensão.
+	 */
+	void setSubjectKeyIdentifier(bool subjectKeyIdentifier);
+
+	/**
+	 * @return true se cada certificado recebe a extensão SubjectKeyIdentifier.
+	 */
+	bool isSubjectKeyIdentifier() const;
+
+	/**
+	 * Emite um certificado.
+	 * @param serialNumber número de série.
+	 * @param subject titular.
+	 * @param publicKey chave pública do titular.
+	 * @param notBefore início da validade.
+	 * @param notAfter fim da validade.
+	 * @param extensions extensões próprias do certificado, acrescentadas depois das do modelo;
+	 * não podem repetir o OID de uma extensão do modelo, da SubjectKeyIdentifier ou de outra delas.
+	 * @return certificado codificado em DER.
+	 * @throw CertificationException caso a validade termine antes de começar, alguma extensão
+	 * esteja repetida ou a assinatura falhe.
+	 * @throw EncodeException caso algum campo não possa ser codificado.
+	 */
+	ByteArray issueDerEncoded(const BigInteger &serialNumber, RDNSequence &subject, PublicKey &publicKey,
+			DateTime &notBefore, DateTime &notAfter, std::vector<Extension *> &extensions) const
+			throw (CertificationException, EncodeException);
+
+	/**
+	 * Emite um certificado sem extensões próprias.
+	 * @see issueDerEncoded(const BigInteger&, RDNSequence&, PublicKey&, DateTime&, DateTime&, std::vector<Extension *>&)
+	 */
+	ByteArray issueDerEncoded(const BigInteger &serialNumber, RDNSequence &subject, PublicKey &publicKey,
+			DateTime &notBefore, DateTime &notAfter) const
+			throw (CertificationException, EncodeException);
+
+	/**
+	 * Emite um certificado para o titular e a chave pública de uma requisição,
+	 * mantendo a codificação do nome da requisição. As extensões da requisição
+	 * não são copiadas; as aceitas devem ser passadas em extensions.
+	 * A assinatura da requisição deve ter sido verificada pelo chamador.
+	 * @param signingContext contexto criado por newSigningContext(), usado por uma única thread; NULL
+	 * inicializa um contexto para a assinatura.
+	 * @see issueDerEncoded(const BigInteger&, RDNSequence&, PublicKey&, DateTime&, DateTime&, std::vector<Extension *>&)
+	 */
+	ByteArray issueDerEncoded(const BigInteger &serialNumber, CertificateRequest &request,
+			DateTime &notBefore, DateTime &notAfter, std::vector<Extension *> &extensions,
+			EVP_MD_CTX *signingContext = NULL) const
+			throw (CertificationException, EncodeException);
+
+	/**
+	 * Emite um certificado, decodificado em um objeto Certificate.
+	 * @return certificado, que deve ser liberado pelo chamador.
+	 * @see issueDerEncoded(const BigInteger&, RDNSequence&, PublicKey&, DateTime&, DateTime&, std::vector<Extension *>&)
+	 */
+	Certificate* issue(const BigInteger &serialNumber, RDNSequence &subject, PublicKey &publicKey,
+			DateTime &notBefore, DateTime &notAfter, std::vector<Extension *> &extensions) const
+			throw (CertificationException, EncodeException);
+
+	/**
+	 * Cria um contexto de assinatura já inicializado com a chave do emissor.
+	 * Quem emite muitos certificados em uma thread pode mantê-lo e passá-lo a
+	 * issueDerEncoded(), que o copia em vez de inicializar um contexto novo a cada assinatura.
+	 * @return contexto, que deve ser liberado com EVP_MD_CTX_free().
+	 * @throw CertificationException caso o contexto não possa ser inicializado.
+	 */
+	EVP_MD_CTX* newSigningContext() const throw (CertificationException);
+
+protected:
+
+	/* subject é o nome do titular já codificado em DER */
+	ByteArray encode(const BigInteger &serialNumber, const std::string &subject, X509_PUBKEY *publicKey,
+			DateTime &notBefore, DateTime &notAfter, std::vector<Extension *> &extensions,
+			EVP_MD_CTX *signingContext) const
+			throw (CertificationException, EncodeException);
+
+	static void encodeTime(time_t time, std::string &out);
+	/* acrescenta o OID em oids; retorna false se ele já estava lá */
+	static bool addExtensionOid(const ASN1_OBJECT *object, std::vector<std::string> &oids);
+
+	/* acrescenta a codificação DER de um objeto OpenSSL em out; retorna false se a codificação falhar */
+	template<class T, class U>
+	static bool append(T object, int (*i2d)(U, unsigned char **), std::string &out)
+	{
+		unsigned char *p;
+		int length;
+
+		length = i2d(object, NULL);
+		if (length <= 0)
+		{
+			return false;
+		}
+		out.resize(out.size() + length);
+		p = (unsigned char *) &out[out.size() - length];
+		return i2d(object, &p) == length;
+	}
+
+	EVP_PKEY *key;
+	const EVP_MD *md;
+	/* [0] EXPLICIT version, vazio para v1 */
+	std::string version;
+	/* AlgorithmIdentifier da assinatura, repetido no fim do certificado */
+	std::string algorithm;
+	std::string issuer;
+	/* extensões do modelo, já codificadas, sem o SEQUENCE externo */
+	std::string extensions;
+	/* conteúdo DER dos OIDs das extensões do modelo, para recusar repetições */
+	std::vector<std::string> extensionOids;
+	bool subjectKeyIdentifier;
+
+private:
+
+	IssuanceTemplate(const IssuanceTemplate &);
+	IssuanceTemplate& operator=(const IssuanceTemplate &);
+};
+
+#endif /* ISSUANCETEMPLATE_H_ */
@@ -28,6 +28,8 @@ public:
 	GeneralNames getIssuerAltName();
 	X509_EXTENSION* getX509Extension();
 protected:
+	virtual void encodeValue(DerWriter &writer);
+	virtual void writeValue(DocumentWriter &writer);
 	GeneralNames issuerAltName;
 };
 
@@ -0,0 +1,47 @@
+#ifndef JSONWRITER_H_
+#define JSONWRITER_H_
+
+#include <string>
+#include <vector>
+
+#include "DocumentWriter.h"
+
+/**
+ * @brief Escreve o documento em JSON compacto. A raiz é um objeto com um único membro,
+ * com o nome da primeira estrutura, como {"certificate":{...}}; as estruturas são objetos
+ * e as listas, arrays. Números e valores lógicos não ficam entre aspas.
+ * Bytes que não formam UTF-8 válido (por exemplo, o conteúdo de um T61String ou
+ * BMPString) são trocados pelo caractere de substituição U+FFFD.
+ */
+class JsonWriter : public DocumentWriter
+{
+
+public:
+
+	JsonWriter(std::ostream &stream);
+	virtual ~JsonWriter();
+
+	virtual void begin(const std::string &name);
+	virtual void beginList(const std::string &name);
+	virtual void end();
+
+protected:
+
+	struct Level
+	{
+		bool list;
+		bool empty;
+	};
+
+	virtual void writeField(const std::string &name, const std::string &value, bool text);
+	/* escreve a vírgula e, fora de listas, o nome do membro */
+	void separate(const std::string &name);
+	void open(const std::string &name, bool list);
+	void escape(const std::string &value);
+	/* tamanho da sequência UTF-8 que começa em pos, ou 0 se ela for inválida */
+	static unsigned int getSequenceLength(const std::string &value, std::string::size_type pos);
+
+	std::vector<JsonWriter::Level> levels;
+};
+
+#endif /* JSONWRITER_H_ */
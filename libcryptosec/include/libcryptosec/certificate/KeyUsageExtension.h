@@ -41,6 +41,8 @@ public:
 	static std::string usage2Name(KeyUsageExtension::Usage usage);
 	X509_EXTENSION* getX509Extension();
 protected:
+	virtual void encodeValue(DerWriter &writer);
+	virtual void writeValue(DocumentWriter &writer);
 	bool usages[9];
 };
 
@@ -0,0 +1,91 @@
+#ifndef OBJECTIDENTIFIERTABLE_H_
+#define OBJECTIDENTIFIERTABLE_H_
+
+#include <openssl/asn1.h>
+#include <openssl/crypto.h>
+#include <openssl/objects.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Tabela global dos identificadores de objeto conhecidos pelo OpenSSL.
+ * Na primeira consulta, todos os objetos do OpenSSL que têm OID são registrados
+ * com seu NID, sua codificação DER, sua representação em texto e seu nome curto,
+ * e podem então ser obtidos, a partir de qualquer um deles, sem que o OID seja
+ * novamente interpretado ou convertido em texto.
+ * Objetos criados depois (como os de ObjectIdentifierFactory::createObjectIdentifier)
+ * são acrescentados à tabela; as entradas nunca são alteradas nem removidas, de forma
+ * que podem ser usadas por várias threads depois de obtidas.
+ * Os ASN1_OBJECT das entradas pertencem ao OpenSSL e nunca devem ser liberados.
+ * @see ObjectIdentifierFactory
+ */
+class ObjectIdentifierTable
+{
+
+public:
+
+	struct Entry
+	{
+		ASN1_OBJECT *object;
+		int nid;
+		/* conteúdo da codificação DER, sem tag e tamanho */
+		std::string der;
+		/* OID em texto, como "2.5.29.15" */
+		std::string oid;
+		/* nome curto; o OID em texto se o objeto não tiver nome */
+		std::string name;
+	};
+
+	virtual ~ObjectIdentifierTable() {};
+
+	/**
+	 * @param nid NID do objeto.
+	 * @return entrada do objeto, ou NULL se o OpenSSL não conhecer o NID ou o objeto não tiver OID.
+	 */
+	static const ObjectIdentifierTable::Entry* findByNid(int nid);
+
+	/**
+	 * @param oid OID em texto, como "2.5.29.15".
+	 * @return entrada do objeto, ou NULL se o OID não estiver registrado.
+	 */
+	static const ObjectIdentifierTable::Entry* findByOid(const std::string &oid);
+
+	/**
+	 * @param data conteúdo da codificação DER do OID, sem tag e tamanho, como em OBJ_get0_data().
+	 * @param length tamanho do conteúdo.
+	 * @return entrada do objeto, ou NULL se o OID não estiver registrado.
+	 */
+	static const ObjectIdentifierTable::Entry* findByDer(const unsigned char *data, unsigned int length);
+
+	/**
+	 * @return quantidade de objetos registrados.
+	 */
+	static unsigned int size();
+
+private:
+
+	ObjectIdentifierTable();
+	static void init();
+	static ObjectIdentifierTable::Entry* newEntry(int nid);
+	static ObjectIdentifierTable::Entry* add(ObjectIdentifierTable::Entry *entry);
+	static void index(std::vector<Entry *> &slots, Entry *entry, std::string Entry::*key);
+	static void rehash(std::vector<Entry *> &slots, std::string Entry::*key);
+	static const ObjectIdentifierTable::Entry* find(const std::vector<Entry *> &slots, const char *data,
+			unsigned int length, std::string Entry::*key);
+	/* FNV-1a de 64 bits, também onde unsigned long tem 32 bits */
+	static uint64_t hash(const char *data, unsigned int length);
+
+	static CRYPTO_ONCE once;
+	static CRYPTO_RWLOCK *lock;
+	static std::vector<Entry *> *byNid;
+	/* tabelas de endereçamento aberto, com no máximo metade das posições ocupadas */
+	static std::vector<Entry *> *byOid;
+	static std::vector<Entry *> *byDer;
+	static unsigned int count;
+	/* NIDs existentes quando a tabela foi preenchida; os demais podem ser criados depois */
+	static int builtinNids;
+};
+
+#endif /* OBJECTIDENTIFIERTABLE_H_ */
@@ -26,6 +26,12 @@ public:
 	void addPolicyQualifierInfo(PolicyQualifierInfo &policyQualifierInfo);
 	std::vector<PolicyQualifierInfo> getPoliciesQualifierInfo();
 	POLICYINFO* getPolicyInfo() const;
+
+	/**
+	 * Escreve a política em DER.
+	 */
+	void encode(DerWriter &writer) const;
+	void write(DocumentWriter &writer);
 protected:
 	ObjectIdentifier policyIdentifier;
 	std::vector<PolicyQualifierInfo> policyQualifiers; 
@@ -34,6 +34,12 @@ public:
 	UserNotice getUserNotice();
 	PolicyQualifierInfo::Type getType();
 	POLICYQUALINFO* getPolicyQualInfo() const;
+
+	/**
+	 * Escreve o qualificador em DER. A codificação falha para qualificadores sem tipo.
+	 */
+	void encode(DerWriter &writer) const;
+	void write(DocumentWriter &writer);
 protected:
 	PolicyQualifierInfo::Type type;
 	ObjectIdentifier objectIdentifier;
@@ -9,6 +9,7 @@
 #include <map>
 
 #include <libcryptosec/ByteArray.h>
+#include "DocumentWriter.h"
 #include "ObjectIdentifier.h"
 #include "ObjectIdentifierFactory.h"
 
@@ -41,17 +42,66 @@ public:
 	RDNSequence();
 	RDNSequence(X509_NAME *rdn);
 	RDNSequence(STACK_OF(X509_NAME_ENTRY) *entries);
+	RDNSequence(const RDNSequence& value);
 	virtual ~RDNSequence();
 	std::string getXmlEncoded();
 	std::string getXmlEncoded(std::string tab);
+
+	/**
+	 * Escreve as entradas como uma lista de pares tipo e valor, na ordem do nome.
+	 * @param name nome da lista no documento, como "issuer".
+	 */
+	void write(DocumentWriter &writer, const std::string &name = "RDNSequence");
+
+	/**
+	 * Escreve o nome como write(), mas com os valores convertidos para UTF-8 conforme o
+	 * tipo de cada string (BMPString, T61String, UniversalString...), para que o documento
+	 * só contenha texto válido.
+	 * @param rdn nome a escrever; NULL escreve uma lista vazia.
+	 */
+	static void write(DocumentWriter &writer, const std::string &name, X509_NAME *rdn);
+
 	void addEntry(RDNSequence::EntryType type, std::string value);
 	void addEntry(RDNSequence::EntryType type, std::vector<std::string> values);
 	std::vector<std::string> getEntries(RDNSequence::EntryType type);
 	std::vector<std::pair<ObjectIdentifier, std::string> > getUnknownEntries();
 	std::vector<std::pair<ObjectIdentifier, std::string> > getEntries() const;
-	X509_NAME* getX509Name();
+	X509_NAME* getX509Name() const;
+
+	/**
+	 * A codificação e o resumo são calculados na primeira consulta e guardados
+	 * até a próxima alteração do nome.
+	 * @return codificação DER do nome, a mesma de getX509Name().
+	 */
+	ByteArray getDerEncoded() const;
+
+	/**
+	 * @return resumo da forma canônica do nome, igual ao de X509_NAME_hash(); nomes
+	 * que diferem apenas em maiúsculas e espaços têm o mesmo resumo.
+	 */
+	unsigned long getHash() const;
+
 	RDNSequence& operator =(const RDNSequence& value);
+
+	/**
+	 * Compara as formas canônicas dos nomes, como X509_NAME_cmp(). Os resumos
+	 * guardados são comparados antes, de forma que nomes diferentes raramente
+	 * precisam ser percorridos.
+	 */
+	bool operator ==(const RDNSequence& value) const;
+	bool operator !=(const RDNSequence& value) const;
 protected:
+	/**
+	 * Codificações do nome, imutáveis depois de montadas.
+	 */
+	struct Encoding
+	{
+		std::string der;
+		/* RDNs na forma canônica do OpenSSL, sem o SEQUENCE externo */
+		std::string canonical;
+		unsigned long hash;
+	};
+
 //	std::map<EntryType, std::vector<std::string> > entries;
 //	std::vector<std::pair<std::string, std::string> > unknownEntries;
 	
@@ -61,6 +111,20 @@ protected:
 	static int type2Id(RDNSequence::EntryType type);
 	static std::string getNameId(RDNSequence::EntryType type);
 
+	X509_NAME* buildX509Name() const;
+	const RDNSequence::Encoding* getEncoding(X509_NAME **name = NULL) const;
+	void resetEncoding();
+	static void appendCanonical(X509_NAME_ENTRY *entry, std::string &out);
+	static bool isSpace(unsigned char c);
+	static void initEncodingLock();
+
+	/* montada na primeira consulta e descartada quando o nome é alterado */
+	mutable Encoding *encoding;
+	/* um único lock para todos os nomes, que são muitos e copiados com frequência; as
+	 * seções protegidas só trocam o ponteiro, a codificação é montada fora delas */
+	static CRYPTO_ONCE encodingOnce;
+	static CRYPTO_RWLOCK *encodingLock;
+
 //	std::string getNameId(RDNSequence::EntryType type);
 };
 
@@ -0,0 +1,150 @@
+#ifndef REVOCATIONSNAPSHOT_H_
+#define REVOCATIONSNAPSHOT_H_
+
+#include <openssl/evp.h>
+
+#include <ostream>
+#include <string>
+
+#include <libcryptosec/BigInteger.h>
+#include <libcryptosec/ByteArray.h>
+#include <libcryptosec/MappedFile.h>
+#include <libcryptosec/PrivateKey.h>
+#include <libcryptosec/PublicKey.h>
+
+#include "CertificateRevocationList.h"
+#include "RevokedCertificate.h"
+
+#include <libcryptosec/exception/CertificationException.h>
+#include <libcryptosec/exception/EncodeException.h>
+
+/**
+ * @brief Cópia binária compacta dos números de série revogados de uma LCR.
+ * O arquivo é gerado uma vez a partir da LCR e aberto com mmap nas
+ * inicializações seguintes, sem decodificar nem verificar a LCR outra vez:
+ * as consultas são buscas binárias diretamente nas páginas do arquivo.
+ *
+ * Formato (versão 1, inteiros big-endian):
+ * - cabeçalho: "LCSRSNAP", versão, opções, quantidade de entradas, largura
+ *   do número de série, parâmetros do filtro de Bloom, thisUpdate,
+ *   nextUpdate, SHA-256 da LCR de origem e SHA-256 do corpo;
+ * - assinatura do cabeçalho, feita pela chave de quem gerou o arquivo;
+ * - corpo: filtro de Bloom opcional, seguido das entradas ordenadas, cada uma
+ *   com o número de série (tamanho e conteúdo do INTEGER, completado com
+ *   zeros até a largura fixa), a data de revogação e o motivo.
+ *
+ * Ao abrir o arquivo são conferidos a assinatura do cabeçalho, o resumo do
+ * corpo e o resumo da LCR de origem informado pelo chamador.
+ * Os objetos são imutáveis e podem ser consultados por várias threads.
+ * @see CertificateRevocationList
+ */
+class RevocationSnapshot
+{
+
+public:
+
+	/**
+	 * Abre e valida um arquivo gerado por write().
+	 * @param path caminho do arquivo.
+	 * @param publicKey chave que verifica a assinatura do cabeçalho.
+	 * @param crlHash resumo SHA-256 da LCR de origem, obtido por getCrlHash().
+	 * @throw EncodeException caso o arquivo não possa ser lido ou não esteja no formato esperado.
+	 * @throw CertificationException caso a assinatura, o resumo do corpo ou o resumo da LCR não confiram.
+	 */
+	RevocationSnapshot(std::string path, PublicKey &publicKey, ByteArray &crlHash)
+			throw (EncodeException, CertificationException);
+
+	/**
+	 * Destrutor padrão, desfaz o mapeamento do arquivo.
+	 */
+	virtual ~RevocationSnapshot();
+
+	/**
+	 * Gera o arquivo a partir de uma LCR. A assinatura da LCR deve ter sido verificada pelo chamador.
+	 * @param crl LCR de origem.
+	 * @param privateKey chave que assina o cabeçalho.
+	 * @param out destino do arquivo, aberto em modo binário.
+	 * @param bloomBitsPerEntry bits do filtro de Bloom por entrada; 0 não gera o filtro.
+	 * @throw EncodeException caso a LCR não possa ser codificada ou a escrita falhe.
+	 * @throw CertificationException caso o cabeçalho não possa ser assinado.
+	 */
+	static void write(CertificateRevocationList &crl, PrivateKey &privateKey, std::ostream &out,
+			unsigned int bloomBitsPerEntry = 0) throw (EncodeException, CertificationException);
+
+	/**
+	 * @param crl LCR de origem.
+	 * @return resumo SHA-256 da codificação DER da LCR.
+	 * @throw EncodeException caso a LCR não possa ser codificada.
+	 */
+	static ByteArray getCrlHash(CertificateRevocationList &crl) throw (EncodeException);
+
+	/**
+	 * @param der codificação DER da LCR, por exemplo de um MappedFile.
+	 * @param length tamanho da codificação.
+	 * @return resumo SHA-256 da codificação.
+	 */
+	static ByteArray getCrlHash(const unsigned char *der, unsigned long length);
+
+	/**
+	 * @param serialNumber número de série do certificado.
+	 * @return true se o certificado foi revogado.
+	 */
+	bool isRevoked(const BigInteger &serialNumber) const;
+
+	/**
+	 * @param serialNumber número de série do certificado.
+	 * @return entrada da LCR, que deve ser liberada pelo chamador, ou NULL se o certificado não foi revogado.
+	 */
+	RevokedCertificate* getRevocation(const BigInteger &serialNumber) const;
+
+	/**
+	 * @return quantidade de entradas.
+	 */
+	unsigned long getCount() const;
+
+	/**
+	 * @return data de emissão da LCR de origem.
+	 */
+	time_t getThisUpdate() const;
+
+	/**
+	 * @return data da próxima atualização da LCR de origem, ou 0 se ausente.
+	 */
+	time_t getNextUpdate() const;
+
+	/**
+	 * @return resumo SHA-256 da LCR de origem.
+	 */
+	ByteArray getCrlHash() const;
+
+	/**
+	 * @return true se o arquivo tem filtro de Bloom.
+	 */
+	bool hasBloomFilter() const;
+
+protected:
+
+	/* busca o número de série; retorna a entrada ou NULL */
+	const unsigned char* find(const BigInteger &serialNumber) const;
+
+	static EVP_MD_CTX* newSigningContext(EVP_PKEY *pkey, bool sign);
+
+	MappedFile *file;
+	const unsigned char *bloom;
+	unsigned long bloomBits;
+	unsigned int bloomHashes;
+	const unsigned char *records;
+	unsigned long count;
+	unsigned int serialWidth;
+	unsigned int recordSize;
+	time_t thisUpdate;
+	time_t nextUpdate;
+	ByteArray crlHash;
+
+private:
+
+	RevocationSnapshot(const RevocationSnapshot &);
+	RevocationSnapshot& operator=(const RevocationSnapshot &);
+};
+
+#endif /* REVOCATIONSNAPSHOT_H_ */
@@ -0,0 +1,157 @@
+#ifndef REVOCATIONSTATE_H_
+#define REVOCATIONSTATE_H_
+
+#include <openssl/crypto.h>
+#include <openssl/x509.h>
+
+#include <string>
+#include <vector>
+
+#include <libcryptosec/BigInteger.h>
+#include <libcryptosec/PublicKey.h>
+
+#include "CertificateRevocationList.h"
+#include "RevokedCertificate.h"
+
+#include <libcryptosec/exception/CertificationException.h>
+#include <libcryptosec/exception/EncodeException.h>
+
+/**
+ * @brief Estado de revogação de um emissor, mantido por LCRs delta.
+ * Parte de uma LCR completa (base) e aplica as LCRs delta seguintes (RFC 5280,
+ * seção 5.2.4): entradas novas são acrescentadas ou substituem as existentes e
+ * entradas com motivo removeFromCRL retiram o número de série do estado.
+ * Uma delta só é aceita se for do mesmo emissor, se estiver assinada pela chave
+ * do emissor, se seu BaseCRLNumber não for maior que o número da LCR já aplicada
+ * e se seu próprio número for maior.
+ * Assim como no CertificateStore, cada alteração constrói uma nova versão
+ * imutável (a lista ordenada de números de série) fora da trava e a troca de
+ * versões é a única operação feita sob trava exclusiva; consultas de outras
+ * threads continuam usando a versão anterior até a troca.
+ * As assinaturas são verificadas na mesma passada que lê as entradas.
+ * @see CertificateRevocationList
+ * @see DeltaCRLIndicatorExtension
+ */
+class RevocationState
+{
+
+public:
+
+	/**
+	 * Cria o estado a partir de uma LCR completa.
+	 * @param base LCR completa, com a extensão CRL Number.
+	 * @param issuerKey chave pública do emissor, usada para verificar a base e as deltas.
+	 * @throw CertificationException caso a LCR seja uma delta, não tenha CRL Number ou
+	 * não esteja assinada por issuerKey.
+	 * @throw EncodeException caso a LCR não possa ser codificada.
+	 */
+	RevocationState(CertificateRevocationList &base, PublicKey &issuerKey) throw (CertificationException, EncodeException);
+
+	/**
+	 * Destrutor padrão.
+	 */
+	virtual ~RevocationState();
+
+	/**
+	 * Aplica uma LCR delta e publica a nova versão do estado.
+	 * @param delta LCR delta do mesmo emissor.
+	 * @throw CertificationException caso a LCR não seja uma delta aplicável ao estado atual
+	 * ou não esteja assinada pela chave do emissor.
+	 * @throw EncodeException caso a LCR não possa ser codificada.
+	 */
+	void applyDelta(CertificateRevocationList &delta) throw (CertificationException, EncodeException);
+
+	/**
+	 * @param serialNumber número de série do certificado.
+	 * @return true se o certificado está revogado na versão atual.
+	 */
+	bool isRevoked(const BigInteger &serialNumber) const;
+
+	/**
+	 * @param serialNumber número de série do certificado.
+	 * @return entrada da LCR, que deve ser liberada pelo chamador, ou NULL se o certificado não está revogado.
+	 */
+	RevokedCertificate* getRevocation(const BigInteger &serialNumber) const;
+
+	/**
+	 * @return número (CRL Number) da última LCR aplicada.
+	 */
+	BigInteger getCrlNumber() const;
+
+	/**
+	 * @return data de emissão da última LCR aplicada.
+	 */
+	time_t getThisUpdate() const;
+
+	/**
+	 * @return data da próxima atualização da última LCR aplicada, ou 0 se ausente.
+	 */
+	time_t getNextUpdate() const;
+
+	/**
+	 * @return quantidade de números de série revogados.
+	 */
+	unsigned long size() const;
+
+	/**
+	 * @return número da versão atual, incrementado a cada delta aplicada.
+	 */
+	unsigned long getGeneration() const;
+
+protected:
+
+	/**
+	 * Entrada revogada; o número de série é o conteúdo do INTEGER DER.
+	 */
+	struct Entry
+	{
+		std::string serialNumber;
+		time_t revocationDate;
+		RevokedCertificate::ReasonCode reasonCode;
+		/* só em entradas de uma delta: retira o número de série do estado */
+		bool removeFromCrl;
+
+		/* tamanho e depois conteúdo: ordem total, já que o DER exige a codificação mínima */
+		bool operator<(const Entry &other) const
+		{
+			if (this->serialNumber.size() != other.serialNumber.size())
+			{
+				return this->serialNumber.size() < other.serialNumber.size();
+			}
+			return this->serialNumber < other.serialNumber;
+		}
+	};
+
+	/**
+	 * Versão imutável do estado.
+	 */
+	struct Snapshot
+	{
+		unsigned long generation;
+		BigInteger crlNumber;
+		time_t thisUpdate;
+		time_t nextUpdate;
+		std::vector<Entry> entries;
+	};
+
+	static void readEntries(CertificateRevocationList &crl, EVP_PKEY *key, Snapshot &snapshot)
+			throw (CertificationException, EncodeException);
+	static void sort(std::vector<Entry> &entries);
+	static const Entry* find(const Snapshot *snapshot, const Entry &key);
+	void release();
+
+	Snapshot *snapshot;
+	X509_NAME *issuer;
+	EVP_PKEY *issuerKey;
+	/* protege a troca de versões; consultas usam a trava compartilhada */
+	CRYPTO_RWLOCK *lock;
+	/* serializa a aplicação de deltas */
+	CRYPTO_RWLOCK *writeLock;
+
+private:
+
+	RevocationState(const RevocationState &);
+	RevocationState& operator=(const RevocationState &);
+};
+
+#endif /* REVOCATIONSTATE_H_ */
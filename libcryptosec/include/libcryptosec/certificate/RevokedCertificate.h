@@ -7,6 +7,8 @@
 #include <libcryptosec/DateTime.h>
 #include <libcryptosec/Base64.h>
 
+#include "DocumentWriter.h"
+
 #include <libcryptosec/exception/CertificationException.h>
 
 class RevokedCertificate
@@ -29,6 +31,13 @@ public:
 	virtual ~RevokedCertificate();
 	std::string getXmlEncoded();
 	std::string getXmlEncoded(std::string tab);
+	void write(DocumentWriter &writer);
+
+	/**
+	 * Escreve a entrada diretamente da estrutura do OpenSSL, sem construir o objeto,
+	 * com os mesmos campos de write(DocumentWriter&).
+	 */
+	static void write(DocumentWriter &writer, const X509_REVOKED *revoked);
 	void setCertificateSerialNumber(long certificateSerialNumber) throw (BigIntegerException);
 	void setCertificateSerialNumber(BigInteger certificateSerialNumber);
 	long getCertificateSerialNumber();
@@ -39,6 +48,31 @@ public:
 	RevokedCertificate::ReasonCode getReasonCode();
 	X509_REVOKED* getX509Revoked();
 	static std::string reasonCode2Name(RevokedCertificate::ReasonCode reasonCode);
+
+	/**
+	 * Verifica se um valor lido de uma codificação é um motivo de revogação definido pela
+	 * RFC 5280: de 0 a 10, exceto 7, que não é usado.
+	 * @param value valor do CRLReason.
+	 * @return true se o valor pode ser convertido para ReasonCode.
+	 */
+	static bool isReasonCode(long value);
+
+	/**
+	 * Converte um motivo para o valor do CRLReason da RFC 5280. Os valores de ReasonCode
+	 * não coincidem com os da RFC a partir de PRIVILEGE_WITH_DRAWN (privilegeWithdrawn é 9
+	 * e aACompromise é 10).
+	 * @param reasonCode motivo de revogação.
+	 * @return valor do CRLReason, ou -1 se reasonCode não for um valor de ReasonCode.
+	 */
+	static long toCrlReason(RevokedCertificate::ReasonCode reasonCode);
+
+	/**
+	 * Converte um valor do CRLReason da RFC 5280 para ReasonCode. removeFromCRL (8), que só
+	 * aparece em LCRs delta, e valores não definidos pela RFC resultam em UNSPECIFIED.
+	 * @param value valor do CRLReason.
+	 * @return motivo de revogação correspondente.
+	 */
+	static RevokedCertificate::ReasonCode fromCrlReason(long value);
 protected:
 	BigInteger certificateSerialNumber;
 	DateTime revocationDate;
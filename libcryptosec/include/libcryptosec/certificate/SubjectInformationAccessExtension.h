@@ -32,6 +32,8 @@ public:
 	std::string getXmlEncoded(std::string tab);
 	virtual std::string extValue2Xml(std::string tab = "");
 protected:
+	virtual void encodeValue(DerWriter &writer);
+	virtual void writeValue(DocumentWriter &writer);
 	std::vector<AccessDescription> accessDescriptions;
 };
 
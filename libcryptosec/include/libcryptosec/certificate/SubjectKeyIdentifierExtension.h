@@ -27,6 +27,8 @@ public:
 	ByteArray getKeyIdentifier() const;
 	X509_EXTENSION* getX509Extension();
 protected:
+	virtual void encodeValue(DerWriter &writer);
+	virtual void writeValue(DocumentWriter &writer);
 	ByteArray keyIdentifier;
 };
 
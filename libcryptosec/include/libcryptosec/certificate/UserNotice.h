@@ -7,6 +7,9 @@
 #include <string>
 #include <vector>
 
+#include "DerWriter.h"
+#include "DocumentWriter.h"
+
 #include <libcryptosec/exception/CertificationException.h>
 
 class UserNotice
@@ -22,6 +25,12 @@ public:
 	void setExplicitText(std::string explicitText);
 	std::string getExplicitText();
 	USERNOTICE* getUserNotice() const;
+
+	/**
+	 * Escreve o aviso em DER, com os textos em UTF8String.
+	 */
+	void encode(DerWriter &writer) const;
+	void write(DocumentWriter &writer);
 protected:
 	std::string organization;
 	std::vector<long> noticeNumbers;
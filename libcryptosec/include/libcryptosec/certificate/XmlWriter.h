@@ -0,0 +1,40 @@
+#ifndef XMLWRITER_H_
+#define XMLWRITER_H_
+
+#include <string>
+#include <vector>
+
+#include "DocumentWriter.h"
+
+/**
+ * @brief Escreve o documento em XML, com um elemento por estrutura, lista ou campo,
+ * indentado por tabulações como os métodos getXmlEncoded().
+ * Os caracteres especiais dos valores são escapados; valores com caracteres de controle,
+ * que o XML 1.0 não representa, lançam EncodeException antes de o campo ser escrito.
+ */
+class XmlWriter : public DocumentWriter
+{
+
+public:
+
+	/**
+	 * @param declaration escreve a declaração "<?xml version="1.0"?>" antes da raiz.
+	 */
+	XmlWriter(std::ostream &stream, bool declaration = true);
+	virtual ~XmlWriter();
+
+	virtual void begin(const std::string &name);
+	virtual void beginList(const std::string &name);
+	virtual void end();
+
+protected:
+
+	virtual void writeField(const std::string &name, const std::string &value, bool text);
+	void indent();
+	void escape(const std::string &value);
+
+	/* elementos abertos, para os fechamentos */
+	std::vector<std::string> names;
+};
+
+#endif /* XMLWRITER_H_ */
@@ -1,11 +1,17 @@
 #ifndef BRAINPOOLCURVEFACTORY_H_
 #define BRAINPOOLCURVEFACTORY_H_
 
+/* OpenSSL includes */
+#include <openssl/crypto.h>
+
 /* local includes */
 #include "EllipticCurve.h"
+#include "EllipticCurveRegistry.h"
 
  /**
  * @brief Classe para fabricação de curvas do padrão Brainpool.
+ * As curvas são construídas uma única vez por processo; getCurve() retorna
+ * cópias e getSharedCurve() as instâncias compartilhadas, liberadas no fim do processo.
  * @ingroup Util
  */
 class BrainpoolCurveFactory {
@@ -29,11 +35,32 @@ public:
 	};
 
 	virtual ~BrainpoolCurveFactory(){};
+
+	/**
+	 * Cria uma cópia dos parâmetros da curva.
+	 * @return nova curva, que deve ser liberada pelo chamador, ou NULL se o nome for inválido.
+	 */
 	static const EllipticCurve * getCurve(BrainpoolCurveFactory::CurveName curveName) throw(BigIntegerException);
 
+	/**
+	 * Obtém a instância compartilhada da curva, usada como chave no EllipticCurveRegistry.
+	 * @return curva imutável, que não deve ser liberada, ou NULL se o nome for inválido.
+	 */
+	static const EllipticCurve * getSharedCurve(BrainpoolCurveFactory::CurveName curveName) throw(BigIntegerException);
+
+	/**
+	 * Obtém o grupo compartilhado e pré-computado da curva.
+	 * @see EllipticCurveRegistry
+	 */
+	static const EC_GROUP * getGroup(BrainpoolCurveFactory::CurveName curveName) throw(BigIntegerException, AsymmetricKeyException);
+
 private:
 
 	BrainpoolCurveFactory();
+	static void init();
+	static void cleanup();
+	static CRYPTO_ONCE once;
+	static const EllipticCurve * curves[];
 	static const EllipticCurve * bp160r1() throw(BigIntegerException);
 	static const EllipticCurve * bp160t1() throw(BigIntegerException);
 	static const EllipticCurve * bp192r1() throw(BigIntegerException);
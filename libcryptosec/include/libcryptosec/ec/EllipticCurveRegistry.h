@@ -0,0 +1,75 @@
+#ifndef ELLIPTICCURVEREGISTRY_H_
+#define ELLIPTICCURVEREGISTRY_H_
+
+/* c++ library includes */
+#include <map>
+#include <string>
+
+/* OpenSSL includes */
+#include <openssl/ec.h>
+#include <openssl/crypto.h>
+
+/* local includes */
+#include "EllipticCurve.h"
+#include <libcryptosec/AsymmetricKey.h>
+#include <libcryptosec/exception/AsymmetricKeyException.h>
+
+ /**
+ * @brief Registro global de grupos de curvas elípticas.
+ * Cada EC_GROUP é construído uma única vez por processo, tem a tabela de
+ * múltiplos do gerador pré-computada (EC_GROUP_precompute_mult) e é então
+ * compartilhado, somente para leitura, entre threads e pares de chaves.
+ * Os grupos pertencem ao registro, que os libera no fim do processo, e nunca
+ * devem ser liberados pelo chamador; quem precisar de um grupo mutável deve usar EC_GROUP_dup.
+ * @ingroup Util
+ */
+class EllipticCurveRegistry {
+public:
+
+	virtual ~EllipticCurveRegistry(){};
+
+	/**
+	 * Obtém o grupo de uma curva descrita por seus parâmetros.
+	 * Curvas com os mesmos parâmetros compartilham o mesmo grupo.
+	 * @param curve parâmetros da curva.
+	 * @return grupo compartilhado, com o gerador pré-computado.
+	 * @throws AsymmetricKeyException se o grupo não puder ser criado.
+	 */
+	static const EC_GROUP * getGroup(const EllipticCurve &curve) throw (AsymmetricKeyException);
+
+	/**
+	 * Obtém o grupo de uma curva nomeada do OpenSSL.
+	 * @param curve NID da curva.
+	 * @return grupo compartilhado, com o gerador pré-computado.
+	 * @throws AsymmetricKeyException se o grupo não puder ser criado.
+	 */
+	static const EC_GROUP * getGroup(AsymmetricKey::Curve curve) throw (AsymmetricKeyException);
+
+	/**
+	 * Cria um novo grupo a partir dos parâmetros da curva, sem pré-computação.
+	 * @param curve parâmetros da curva.
+	 * @return novo grupo, que deve ser liberado pelo chamador.
+	 * @throws AsymmetricKeyException se o grupo não puder ser criado.
+	 */
+	static EC_GROUP * createGroup(const EllipticCurve &curve) throw (AsymmetricKeyException);
+
+	/**
+	 * @return quantidade de grupos registrados.
+	 */
+	static unsigned int size();
+
+private:
+
+	EllipticCurveRegistry();
+	static void init();
+	static void cleanup();
+	static std::string getKey(const EllipticCurve &curve);
+	static const EC_GROUP * find(const std::string &key);
+	static const EC_GROUP * insert(const std::string &key, EC_GROUP *group) throw (AsymmetricKeyException);
+
+	static CRYPTO_ONCE once;
+	static CRYPTO_RWLOCK *lock;
+	static std::map<std::string, EC_GROUP *> *groups;
+};
+
+#endif /* ELLIPTICCURVEREGISTRY_H_ */
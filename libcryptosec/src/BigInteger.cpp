@@ -1,5 +1,9 @@
 #include <libcryptosec/BigInteger.h>
 
+CRYPTO_ONCE BigInteger::once = CRYPTO_ONCE_STATIC_INIT;
+CRYPTO_THREAD_LOCAL BigInteger::context;
+bool BigInteger::contextReady = false;
+
 BigInteger::BigInteger() throw(BigIntegerException)
 {
 	if(!(this->bigInt = BN_new()))
@@ -57,12 +61,10 @@ BigInteger::BigInteger(ByteArray& b) throw(BigIntegerException)
 
 BigInteger::BigInteger(BigInteger const& b) throw(BigIntegerException)
 {
-	if(!(this->bigInt = BN_new()))
+	if(!(this->bigInt = BN_dup(b.getBIGNUM())))
 	{
 		throw BigIntegerException(BigIntegerException::MEMORY_ALLOC, "BigInteger::BigInteger");
 	}
-	
-	*this = b;
 }
 
 BigInteger::BigInteger(std::string dec) throw(BigIntegerException)
@@ -82,18 +84,7 @@ BigInteger::~BigInteger()
 
 void BigInteger::setValue(const long val) throw(BigIntegerException)
 {
-	unsigned long copy;
-	
-	if(val < 0)
-	{
-		copy = static_cast<unsigned long>(-val);
-	}
-	else
-	{
-		copy = static_cast<unsigned long>(val);
-	}
-	
-	if(!(BN_set_word(this->bigInt, copy)))
+	if(!(BN_set_word(this->bigInt, BigInteger::magnitude(val))))
 	{
 		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::BigInteger");
 	}
@@ -290,188 +281,212 @@ BigInteger& BigInteger::add(BigInteger const& a) throw(BigIntegerException)
 
 BigInteger& BigInteger::add(long const a) throw(BigIntegerException)
 {
-	BigInteger b(a);
+	int rc;
+	
+	if(a < 0)
+	{
+		rc = BN_sub_word(this->bigInt, BigInteger::magnitude(a));
+	}
+	else
+	{
+		rc = BN_add_word(this->bigInt, BigInteger::magnitude(a));
+	}
 	
-	return this->add(b);
+	if(!rc)
+	{
+		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::add");
+	}
+	return *this;
 }
 
 BigInteger& BigInteger::sub(BigInteger const& a) throw(BigIntegerException)
 {
 	if(!(BN_sub(this->bigInt, this->bigInt, a.getBIGNUM())))
 	{
-		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::add");
+		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::sub");
 	}
 	return *this;
 }
 
 BigInteger& BigInteger::sub(long const a) throw(BigIntegerException)
 {
-	BigInteger tmp(a);
-	return this->sub(tmp);
-}
-
-BigInteger& BigInteger::mul(BigInteger const& a) throw(BigIntegerException)
-{
-	BN_CTX* ctx = NULL;
-	BIGNUM* r = NULL;
+	int rc;
 	
-	if(!(r = BN_new()))
+	if(a < 0)
 	{
-		throw BigIntegerException(BigIntegerException::MEMORY_ALLOC, "BigInteger::mul");
+		rc = BN_add_word(this->bigInt, BigInteger::magnitude(a));
 	}
-	
-	if(!(ctx = BN_CTX_new()))
+	else
 	{
-		throw BigIntegerException(BigIntegerException::MEMORY_ALLOC, "BigInteger::mul");
+		rc = BN_sub_word(this->bigInt, BigInteger::magnitude(a));
 	}
 	
-	if(!BN_mul(r, this->bigInt, a.getBIGNUM(), ctx))
+	if(!rc)
 	{
-		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::mul");
+		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::sub");
 	}
-	
-	if(BN_copy(this->bigInt, r) == NULL)
+	return *this;
+}
+
+BigInteger& BigInteger::mul(BigInteger const& a) throw(BigIntegerException)
+{
+	/* BN_mul aceita que o resultado seja um dos operandos */
+	if(!BN_mul(this->bigInt, this->bigInt, a.getBIGNUM(), BigInteger::getContext()))
 	{
 		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::mul");
 	}
 	
-	BN_free(r);
-	BN_CTX_free(ctx);
 	return (*this);
 }
 
 BigInteger& BigInteger::mul(long const a) throw(BigIntegerException)
 {
-	BigInteger tmp(a);
-	return this->mul(tmp);
+	if(!BN_mul_word(this->bigInt, BigInteger::magnitude(a)))
+	{
+		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::mul");
+	}
+	
+	if(a < 0)
+	{
+		this->setNegative(!this->isNegative());
+	}
+	return (*this);
 }
 
 BigInteger BigInteger::operator*(BigInteger const& a) const throw(BigIntegerException)
 {
-	BigInteger tmp(*this);
-	return tmp.mul(a);
+	BigInteger ret(*this);
+	ret.mul(a);
+	return ret;
 }
 
 BigInteger BigInteger::operator*(long const c) const throw(BigIntegerException)
 {
-	BigInteger tmp1(*this);
-	BigInteger tmp2(c);
-	return tmp1.mul(tmp2);
+	BigInteger ret(*this);
+	ret.mul(c);
+	return ret;
 }
 
 BigInteger& BigInteger::div(BigInteger const& a) throw(BigIntegerException)
 {
-	BN_CTX* ctx = NULL;
-	BIGNUM* dv = NULL;
-	BIGNUM* rem = NULL;
+	BN_CTX* ctx;
+	BIGNUM* dv;
+	bool rc;
 	
-	if(a == 0)
+	if(BN_is_zero(a.getBIGNUM()))
 	{
 		throw BigIntegerException(BigIntegerException::DIVISION_BY_ZERO, "BigInteger::div");
 	}
 	
-	if(!(dv = BN_new()))
-	{
-		throw BigIntegerException(BigIntegerException::MEMORY_ALLOC, "BigInteger::div");
-	}
+	ctx = BigInteger::getContext();
+	BN_CTX_start(ctx);
+	dv = BN_CTX_get(ctx);
+	rc = dv != NULL
+			&& BN_div(dv, NULL, this->bigInt, a.getBIGNUM(), ctx)
+			&& BN_copy(this->bigInt, dv) != NULL;
+	BN_CTX_end(ctx);
 	
-	if(!(rem = BN_new()))
+	if(!rc)
 	{
-		throw BigIntegerException(BigIntegerException::MEMORY_ALLOC, "BigInteger::div");
+		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::div");
 	}
-	
-	if(!(ctx = BN_CTX_new()))
+	return (*this);
+}
+
+BigInteger& BigInteger::div(long const a) throw(BigIntegerException)
+{
+	if(a == 0)
 	{
-		throw BigIntegerException(BigIntegerException::MEMORY_ALLOC, "BigInteger::div");
+		throw BigIntegerException(BigIntegerException::DIVISION_BY_ZERO, "BigInteger::div");
 	}
 	
-	if(!BN_div(dv, rem, this->bigInt, a.getBIGNUM(), ctx))
+	/* o quociente de BN_div_word mantém o sinal do dividendo, como o de BN_div */
+	if(BN_div_word(this->bigInt, BigInteger::magnitude(a)) == (BN_ULONG) -1)
 	{
 		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::div");
 	}
 	
-	if(BN_copy(this->bigInt, dv) == NULL)
+	if(a < 0)
 	{
-		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::div");
+		this->setNegative(!this->isNegative());
 	}
-	
-	BN_free(dv);
-	BN_free(rem);
-	BN_CTX_free(ctx);
 	return (*this);
 }
 
-BigInteger& BigInteger::div(long const a) throw(BigIntegerException)
-{
-	BigInteger tmp(a);
-	return this->div(tmp);
-}
-
 BigInteger BigInteger::operator/(BigInteger const& a) const throw(BigIntegerException)
 {
-	BigInteger tmp(*this);
-	return tmp.div(a);
+	BigInteger ret(*this);
+	ret.div(a);
+	return ret;
 }
 
 BigInteger BigInteger::operator/(long const c) const throw(BigIntegerException)
 {
-	BigInteger a(*this);
-	BigInteger b(c);
-	
-	return a.div(b);
+	BigInteger ret(*this);
+	ret.div(c);
+	return ret;
 }
 
 BigInteger& BigInteger::mod(BigInteger const& a) throw(BigIntegerException)
 {
-	BN_CTX* ctx = NULL;
-	BIGNUM* rem = NULL;
+	BN_CTX* ctx;
+	BIGNUM* rem;
+	bool rc;
 	
-	if(a == 0)
+	if(BN_is_zero(a.getBIGNUM()))
 	{
 		throw BigIntegerException(BigIntegerException::DIVISION_BY_ZERO, "BigInteger::mod");
 	}
 	
-	if(!(rem = BN_new()))
-	{
-		throw BigIntegerException(BigIntegerException::MEMORY_ALLOC, "BigInteger::mod");
-	}
+	ctx = BigInteger::getContext();
+	BN_CTX_start(ctx);
+	rem = BN_CTX_get(ctx);
+	rc = rem != NULL
+			&& BN_mod(rem, this->bigInt, a.getBIGNUM(), ctx)
+			&& BN_copy(this->bigInt, rem) != NULL;
+	BN_CTX_end(ctx);
 	
-	if(!(ctx = BN_CTX_new()))
+	if(!rc)
 	{
-		throw BigIntegerException(BigIntegerException::MEMORY_ALLOC, "BigInteger::mod");
+		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::mod");
 	}
+	return (*this);
+}
+
+BigInteger& BigInteger::mod(long const a) throw(BigIntegerException)
+{
+	BN_ULONG rem;
+	bool negative;
 	
-	if(!BN_mod(rem, this->bigInt, a.getBIGNUM(), ctx))
+	if(a == 0)
 	{
-		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::mod");
+		throw BigIntegerException(BigIntegerException::DIVISION_BY_ZERO, "BigInteger::mod");
 	}
 	
-	if(BN_copy(this->bigInt, rem) == NULL)
+	/* BN_mod_word ignora o sinal; o resto de BN_mod tem o sinal do dividendo */
+	negative = this->isNegative();
+	rem = BN_mod_word(this->bigInt, BigInteger::magnitude(a));
+	if(rem == (BN_ULONG) -1 || !BN_set_word(this->bigInt, rem))
 	{
 		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::mod");
 	}
 	
-	BN_free(rem);
-	BN_CTX_free(ctx);
+	this->setNegative(negative);
 	return (*this);
 }
 
-BigInteger& BigInteger::mod(long const a) throw(BigIntegerException)
-{
-	BigInteger tmp(a);
-	return this->mod(tmp);
-}
-
 BigInteger BigInteger::operator%(BigInteger const& a) const throw(BigIntegerException)
 {
-	BigInteger tmp(*this);
-	return tmp.mod(a);
+	BigInteger ret(*this);
+	ret.mod(a);
+	return ret;
 }
 
 BigInteger BigInteger::operator%(long const c) const throw(BigIntegerException)
 {
-	BigInteger tmp(*this);
-	return tmp.mod(c);
+	BigInteger ret(*this);
+	ret.mod(c);
+	return ret;
 }
 
 int BigInteger::compare(BigInteger const& a) const throw()
@@ -479,18 +494,51 @@ int BigInteger::compare(BigInteger const& a) const throw()
 	return BN_cmp(this->getBIGNUM(), a.getBIGNUM());
 }
 
+int BigInteger::compare(long const a) const throw()
+{
+	unsigned long value, other;
+	bool negative;
+	int ret;
+	
+	negative = this->isNegative();
+	if(negative != (a < 0))
+	{
+		return negative ? -1 : 1;
+	}
+	
+	other = BigInteger::magnitude(a);
+	if(BN_num_bits(this->bigInt) > static_cast<int>(8 * sizeof(unsigned long)))
+	{
+		ret = 1;
+	}
+	else
+	{
+		value = BN_get_word(this->bigInt);
+		ret = (value > other) ? 1 : ((value < other) ? -1 : 0);
+	}
+	
+	return negative ? -ret : ret;
+}
+
+void BigInteger::swap(BigInteger& b) throw()
+{
+	BIGNUM* tmp = this->bigInt;
+	this->bigInt = b.bigInt;
+	b.bigInt = tmp;
+}
+
 BigInteger BigInteger::operator+(BigInteger const& c) const throw(BigIntegerException)
 {
-	BigInteger ret;
-	ret.add(*this);
-	return ret.add(c);
+	BigInteger ret(*this);
+	ret.add(c);
+	return ret;
 }
 
 BigInteger BigInteger::operator+(long const c) const throw(BigIntegerException)
 {
-	BigInteger ret;
-	ret.add(*this);
-	return ret.add(c);
+	BigInteger ret(*this);
+	ret.add(c);
+	return ret;
 }
 
 BigInteger& BigInteger::operator+=(BigInteger const& c) throw(BigIntegerException)
@@ -500,8 +548,7 @@ BigInteger& BigInteger::operator+=(BigInteger const& c) throw(BigIntegerExceptio
 
 BigInteger& BigInteger::operator+=(long const c) throw(BigIntegerException)
 {
-	BigInteger tmp(c);
-	return this->add(tmp);
+	return this->add(c);
 }
 
 BigInteger& BigInteger::operator-=(BigInteger const& c) throw(BigIntegerException)
@@ -511,22 +558,21 @@ BigInteger& BigInteger::operator-=(BigInteger const& c) throw(BigIntegerExceptio
 
 BigInteger& BigInteger::operator-=(long const c) throw(BigIntegerException)
 {
-    BigInteger tmp(c);
-    return this->sub(tmp);
+    return this->sub(c);
 }
 
 BigInteger BigInteger::operator-(BigInteger const& c) const throw(BigIntegerException)
 {
-	BigInteger ret;
-	ret.add(*this);
-	return ret.sub(c);
+	BigInteger ret(*this);
+	ret.sub(c);
+	return ret;
 }
 
 BigInteger BigInteger::operator-(long const c) const throw(BigIntegerException)
 {
-	BigInteger ret;
-	ret.add(*this);
-	return ret.sub(c);
+	BigInteger ret(*this);
+	ret.sub(c);
+	return ret;
 }
 
 BigInteger& BigInteger::operator=(BigInteger const& c) throw(BigIntegerException)
@@ -552,8 +598,7 @@ bool BigInteger::operator==(BigInteger const& c) const throw()
 
 bool BigInteger::operator==(long const c) const throw(BigIntegerException)
 {
-	BigInteger tmp(c);
-	return this->compare(tmp) == 0;
+	return this->compare(c) == 0;
 }
 
 bool BigInteger::operator!=(BigInteger const& c) const throw()
@@ -563,8 +608,7 @@ bool BigInteger::operator!=(BigInteger const& c) const throw()
 
 bool BigInteger::operator!=(long const c) const throw(BigIntegerException)
 {
-	BigInteger tmp(c);
-	return this->compare(tmp) != 0;
+	return this->compare(c) != 0;
 }
 
 bool BigInteger::operator>(BigInteger const& c) const throw()
@@ -574,8 +618,7 @@ bool BigInteger::operator>(BigInteger const& c) const throw()
 
 bool BigInteger::operator>(long const c) const throw(BigIntegerException)
 {
-	BigInteger tmp(c);
-	return this->compare(tmp) == 1;
+	return this->compare(c) == 1;
 }
 
 bool BigInteger::operator>=(BigInteger const& c) const throw()
@@ -585,8 +628,7 @@ bool BigInteger::operator>=(BigInteger const& c) const throw()
 
 bool BigInteger::operator>=(long const c) const throw(BigIntegerException)
 {
-	BigInteger tmp(c);
-	return (*this >= tmp);
+	return (this->compare(c) >= 0);
 }
 
 bool BigInteger::operator<(BigInteger const& c) const throw()
@@ -596,8 +638,7 @@ bool BigInteger::operator<(BigInteger const& c) const throw()
 
 bool BigInteger::operator<(long const c) const throw(BigIntegerException)
 {
-	BigInteger tmp(c);
-	return this->compare(tmp) == -1;
+	return this->compare(c) == -1;
 }
 
 bool BigInteger::operator<=(BigInteger const& c) const throw()
@@ -607,26 +648,25 @@ bool BigInteger::operator<=(BigInteger const& c) const throw()
 
 bool BigInteger::operator<=(long const c) const throw(BigIntegerException)
 {
-	BigInteger tmp(c);
-	return (*this <= tmp);
+	return (this->compare(c) <= 0);
 }
 
 bool BigInteger::operator!() const throw()
 {
-	return ((*this) == 0);
+	return BN_is_zero(this->bigInt);
 }
 
 bool BigInteger::operator||(BigInteger const& c) const throw()
 {
-	bool a = !((*this) == 0);
-	bool b = !(c == 0);
+	bool a = !BN_is_zero(this->bigInt);
+	bool b = !BN_is_zero(c.getBIGNUM());
 	
 	return a || b;
 }
 
 bool BigInteger::operator||(long const c) const throw(BigIntegerException)
 {
-	bool a = !((*this) == 0);
+	bool a = !BN_is_zero(this->bigInt);
 	bool b = c != 0;
 	
 	return a || b;
@@ -634,20 +674,62 @@ bool BigInteger::operator||(long const c) const throw(BigIntegerException)
 
 bool BigInteger::operator&&(BigInteger const& c) const throw()
 {
-	bool a = !((*this) == 0);
-	bool b = !(c == 0);
+	bool a = !BN_is_zero(this->bigInt);
+	bool b = !BN_is_zero(c.getBIGNUM());
 	
 	return a && b;
 }
 
 bool BigInteger::operator&&(long const c) const throw(BigIntegerException)
 {
-	bool a = !((*this) == 0);
+	bool a = !BN_is_zero(this->bigInt);
 	bool b = c != 0;
 	
 	return a && b;
 }
 
+BN_CTX* BigInteger::getContext() throw(BigIntegerException)
+{
+	BN_CTX* ret;
+	
+	if(!CRYPTO_THREAD_run_once(&BigInteger::once, BigInteger::init) || !BigInteger::contextReady)
+	{
+		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::getContext");
+	}
+	
+	ret = static_cast<BN_CTX*>(CRYPTO_THREAD_get_local(&BigInteger::context));
+	if(ret == NULL)
+	{
+		if(!(ret = BN_CTX_new()))
+		{
+			throw BigIntegerException(BigIntegerException::MEMORY_ALLOC, "BigInteger::getContext");
+		}
+		
+		if(!CRYPTO_THREAD_set_local(&BigInteger::context, ret))
+		{
+			BN_CTX_free(ret);
+			throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "BigInteger::getContext");
+		}
+	}
+	return ret;
+}
+
+void BigInteger::init()
+{
+	BigInteger::contextReady = (CRYPTO_THREAD_init_local(&BigInteger::context, BigInteger::freeContext) == 1);
+}
+
+void BigInteger::freeContext(void *ctx)
+{
+	BN_CTX_free(static_cast<BN_CTX*>(ctx));
+}
+
+unsigned long BigInteger::magnitude(long const a) throw()
+{
+	/* sem overflow para LONG_MIN */
+	return (a < 0) ? static_cast<unsigned long>(-(a + 1)) + 1 : static_cast<unsigned long>(a);
+}
+
 BigInteger operator+(long const c, BigInteger const& d) throw(BigIntegerException)
 {
 	return d + c;
@@ -655,6 +737,7 @@ BigInteger operator+(long const c, BigInteger const& d) throw(BigIntegerExceptio
 
 BigInteger operator-(long const c, BigInteger const& d) throw(BigIntegerException)
 {
-	BigInteger tmp(c);
-	return tmp - d;
+	BigInteger ret(c);
+	ret.sub(d);
+	return ret;
 }
@@ -0,0 +1,129 @@
+#include <libcryptosec/BloomFilter.h>
+
+#include <math.h>
+
+/* acima disso o ganho na taxa de falsos positivos não compensa o custo das consultas */
+#define MAX_HASHES	16
+
+BloomFilter::BloomFilter(unsigned long entries, double falsePositiveRate, unsigned long maxSizeBits)
+	: entries(entries), lookups(0), rejections(0)
+{
+	double bits;
+
+	/* m = -n ln p / (ln 2)^2 e k = (m / n) ln 2 */
+	if (falsePositiveRate <= 0.0 || falsePositiveRate >= 1.0)
+	{
+		falsePositiveRate = 0.01;
+	}
+	bits = -((double) (entries > 0 ? entries : 1)) * log(falsePositiveRate) / (M_LN2 * M_LN2);
+	this->sizeBits = (bits < 64.0) ? 64 : (unsigned long) bits;
+	if (maxSizeBits >= 64 && this->sizeBits > maxSizeBits)
+	{
+		this->sizeBits = maxSizeBits;
+	}
+	this->sizeBits = (this->sizeBits + 7) / 8 * 8;
+	this->hashes = (unsigned int) ((double) this->sizeBits / (entries > 0 ? entries : 1) * M_LN2 + 0.5);
+	if (this->hashes < 1)
+	{
+		this->hashes = 1;
+	}
+	else if (this->hashes > MAX_HASHES)
+	{
+		this->hashes = MAX_HASHES;
+	}
+	this->bits.resize(this->sizeBits / 8);
+}
+
+BloomFilter::~BloomFilter()
+{
+}
+
+void BloomFilter::add(uint64_t hash)
+{
+	BloomFilter::set(&this->bits[0], this->sizeBits, this->hashes, hash);
+}
+
+bool BloomFilter::mightContain(uint64_t hash) const
+{
+	bool ret;
+
+	ret = BloomFilter::test(&this->bits[0], this->sizeBits, this->hashes, hash);
+	/* only statistics: nothing is ordered by them */
+	__atomic_fetch_add(&this->lookups, 1, __ATOMIC_RELAXED);
+	if (!ret)
+	{
+		__atomic_fetch_add(&this->rejections, 1, __ATOMIC_RELAXED);
+	}
+	return ret;
+}
+
+unsigned long BloomFilter::getSizeBits() const
+{
+	return this->sizeBits;
+}
+
+unsigned int BloomFilter::getHashCount() const
+{
+	return this->hashes;
+}
+
+double BloomFilter::getFalsePositiveRate() const
+{
+	/* (1 - e^(-kn/m))^k */
+	return pow(1.0 - exp(-((double) this->hashes * this->entries) / this->sizeBits), (double) this->hashes);
+}
+
+uint64_t BloomFilter::getLookups() const
+{
+	return __atomic_load_n(&this->lookups, __ATOMIC_RELAXED);
+}
+
+uint64_t BloomFilter::getRejections() const
+{
+	return __atomic_load_n(&this->rejections, __ATOMIC_RELAXED);
+}
+
+uint64_t BloomFilter::hash(const unsigned char *data, unsigned long length)
+{
+	uint64_t ret = 14695981039346656037ULL;
+	unsigned long i;
+
+	for (i = 0; i < length; i++)
+	{
+		ret ^= data[i];
+		ret *= 1099511628211ULL;
+	}
+	return ret;
+}
+
+void BloomFilter::set(unsigned char *bits, unsigned long sizeBits, unsigned int hashes, uint64_t hash)
+{
+	unsigned long first, step, position;
+	unsigned int i;
+
+	first = (unsigned long) (hash & 0xffffffffUL);
+	step = (unsigned long) (hash >> 32) | 1;
+	for (i = 0; i < hashes; i++)
+	{
+		position = (first + i * step) % sizeBits;
+		bits[position / 8] |= 1 << (position % 8);
+	}
+}
+
+bool BloomFilter::test(const unsigned char *bits, unsigned long sizeBits, unsigned int hashes, uint64_t hash)
+{
+	unsigned long first, step, position;
+	unsigned int i;
+
+	first = (unsigned long) (hash & 0xffffffffUL);
+	step = (unsigned long) (hash >> 32) | 1;
+	for (i = 0; i < hashes; i++)
+	{
+		position = (first + i * step) % sizeBits;
+		if ((bits[position / 8] & (1 << (position % 8))) == 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
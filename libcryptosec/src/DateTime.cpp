@@ -1,5 +1,12 @@
 #include <libcryptosec/DateTime.h>
 
+#include <string.h>
+
+#define SECONDS_PER_DAY	86400LL
+/* intervalo de datas codificadas como UTCTime (RFC 5280, seção 4.1.2.5.1): [1950, 2050) */
+#define UTC_TIME_BEGIN	-631152000LL
+#define UTC_TIME_END	2524608000LL
+
 //pegar hora local
 DateTime::DateTime() throw(BigIntegerException)
 {
@@ -18,103 +25,36 @@ DateTime::DateTime(BigInteger const& dateTime) throw(BigIntegerException)
 
 DateTime::DateTime(ASN1_TIME *asn1Time) throw(BigIntegerException)
 {
-/*	tm dateTimeTm;
-	std::string dateTimeWr;
-	int size, i;
-	unsigned char *dateTimeBin;
-	char temp[5];
-	if (!asn1Time)
+	struct tm tm;
+	bool der;
+
+	this->seconds = 0;
+	if (asn1Time == NULL)
 	{
-		this->dateTime = 0;
+		return;
 	}
-	else
+	/* o tipo decide o formato, e não o tamanho: um UTCTime com 15 caracteres não é um GeneralizedTime */
+	der = (asn1Time->type == V_ASN1_UTCTIME && asn1Time->length == 13)
+			|| (asn1Time->type == V_ASN1_GENERALIZEDTIME && asn1Time->length == 15);
+	if (!der || !DateTime::parseTime(reinterpret_cast<char*>(asn1Time->data), asn1Time->length, this->seconds))
 	{
-		dateTimeBin = ASN1_STRING_data(asn1Time);
-		size = ASN1_STRING_length(asn1Time);
-		if (!(dateTimeBin) || ((size != 13) && (size != 15)))
+		/* formas aceitas pelo OpenSSL mas não pelo DER, como sem os segundos ou com fuso */
+		this->seconds = 0;
+		if (ASN1_TIME_to_tm(asn1Time, &tm) == 1)
 		{
-	//		throw CertificationException(CertificationException::SET_NO_VALUE, "DateTime::DateTime");
-			this->dateTime = 0;
+			this->seconds = DateTime::getDaysSinceEpoch(tm.tm_year + 1900, tm.tm_mon, tm.tm_mday) * SECONDS_PER_DAY
+					+ tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec;
 		}
-		else
-		{
-			for (i=0;i<size;i++)
-			{
-				dateTimeWr[i] = dateTimeBin[i];
-			}
-		    if (size == 13)
-		    {
-		    	temp[0] = dateTimeWr[10];
-		    	temp[1] = dateTimeWr[11];
-		    	temp[2] = '\0';
-				dateTimeTm.tm_sec = atoi(temp);
-				temp[0] = dateTimeWr[8];
-		    	temp[1] = dateTimeWr[9];
-		    	temp[2] = '\0';
-				dateTimeTm.tm_min = atoi(temp);
-				temp[0] = dateTimeWr[6];
-		    	temp[1] = dateTimeWr[7];
-		    	temp[2] = '\0';
-				dateTimeTm.tm_hour = atoi(temp);
-				temp[0] = dateTimeWr[4];
-		    	temp[1] = dateTimeWr[5];
-		    	temp[2] = '\0';
-				dateTimeTm.tm_mday = atoi(temp);
-				temp[0] = dateTimeWr[2];
-		    	temp[1] = dateTimeWr[3];
-		    	temp[2] = '\0';
-				dateTimeTm.tm_mon = atoi(temp) - 1;
-				dateTimeTm.tm_isdst = -1;
-				temp[0] = dateTimeWr[0];
-		    	temp[1] = dateTimeWr[1];
-		    	temp[2] = '\0';
-				dateTimeTm.tm_year = atoi(temp);
-				if (dateTimeTm.tm_year < 50)
-				{
-					dateTimeTm.tm_year += 100;
-				}
-		    }
-		    else
-		    {
-		    	temp[0] = dateTimeWr[12];
-		    	temp[1] = dateTimeWr[13];
-		    	temp[2] = '\0';
-				dateTimeTm.tm_sec = atoi(temp);
-				temp[0] = dateTimeWr[10];
-		    	temp[1] = dateTimeWr[11];
-		    	temp[2] = '\0';
-				dateTimeTm.tm_min = atoi(temp);
-				temp[0] = dateTimeWr[8];
-		    	temp[1] = dateTimeWr[9];
-		    	temp[2] = '\0';
-				dateTimeTm.tm_hour = atoi(temp);
-				temp[0] = dateTimeWr[6];
-		    	temp[1] = dateTimeWr[7];
-		    	temp[2] = '\0';
-				dateTimeTm.tm_mday = atoi(temp);
-				temp[0] = dateTimeWr[4];
-		    	temp[1] = dateTimeWr[5];
-		    	temp[2] = '\0';
-				dateTimeTm.tm_mon = atoi(temp) - 1;
-				dateTimeTm.tm_isdst = -1;
-				temp[0] = dateTimeWr[0];
-		    	temp[1] = dateTimeWr[1];
-		    	temp[2] = dateTimeWr[2];
-		    	temp[3] = dateTimeWr[3];
-		    	temp[4] = '\0';
-				dateTimeTm.tm_year = atoi(temp) - 1900;
-			}
-			this->dateTime = timegm(&dateTimeTm);
-		}
-	}*/
-	
-	string str(reinterpret_cast<char*>(asn1Time->data), asn1Time->length);
-	this->setDateTime(this->date2epoch(str));
+	}
 }
 
-DateTime::DateTime(std::string s) throw(BigIntegerException)
+DateTime::DateTime(std::string s) throw(BigIntegerException, EncodeException)
 {
-	this->setDateTime(DateTime::date2epoch(s));
+	this->seconds = 0;
+	if (!DateTime::parseTime(s.data(), s.size(), this->seconds))
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "DateTime::DateTime");
+	}
 }
 
 DateTime::~DateTime()
@@ -128,66 +68,28 @@ void DateTime::setDateTime(time_t dateTime) throw(BigIntegerException)
 
 void DateTime::setDateTime(BigInteger const& b) throw(BigIntegerException)
 {
-	this->seconds = b;
+	this->seconds = static_cast<long long>(b.getValue());
 }
 
 time_t DateTime::getDateTime() const throw(BigIntegerException)
 {
-/*	struct tm stm;
-	std::istringstream stream; 
-	std::string aString;
-	
-	aString = std::string(reinterpret_cast<char*>(this->dateTime->data), this->dateTime->length);
-	
-	//year
-	stream.str(aString.substr(0,2));
-	stream >> stm.tm_year;
-	
-	//month
-	stream.str(aString.substr(aString.size() - 11,2));
-	stream >> stm.tm_mon;
-	stm.tm_mon = stm.tm_mon + 2000 - 1900;
-	
-	//day
-	stream.str(aString.substr(aString.size() - 9,2));
-	stream >> stm.tm_mday;
-	
-	//hour
-	stream.str(aString.substr(aString.size() - 7,2));
-	stream >> stm.tm_hour;
-	
-	//min
-	stream.str(aString.substr(aString.size() - 5,2));
-	stream >> stm.tm_min;
-	
-	//sec
-	stream.str(aString.substr(aString.size() - 3,2));
-	stream >> stm.tm_dec;
-	
-	return mktime(&stm);*/
-	
-	return static_cast<time_t>(this->seconds.getValue());
+	return static_cast<time_t>(this->seconds);
 }
 
-std::string DateTime::getXmlEncoded(std::string tab) const throw(BigIntegerException)
+std::string DateTime::getXmlEncoded(std::string tab) const throw(BigIntegerException, EncodeException)
 {	
-	ASN1_TIME* gt;
-	string str;
-	
-	gt = this->getAsn1Time();
-	str = string(reinterpret_cast<char*>(gt->data), gt->length);
-	
-	str = tab + str; 
-	
-	return str;	
+	char date[16];
+	unsigned int length;
+
+	length = DateTime::formatTime(this->seconds, DateTime::isUTCTime(this->seconds), date);
+	return tab + std::string(date, length);
 }
 
-ASN1_TIME* DateTime::getAsn1Time() const throw(BigIntegerException)
+ASN1_TIME* DateTime::getAsn1Time() const throw(BigIntegerException, EncodeException)
 {
-	BigInteger limit("2524608000");// segundos para 01/01/2050 00:00:00 Zulu
 	ASN1_TIME* ret = NULL;
 	
-	if(this->seconds < limit)
+	if(DateTime::isUTCTime(this->seconds))
 	{
 		ret = this->getUTCTime();
 	}
@@ -199,89 +101,38 @@ ASN1_TIME* DateTime::getAsn1Time() const throw(BigIntegerException)
 	return ret;
 }
 
-ASN1_TIME* DateTime::getGeneralizedTime() const throw(BigIntegerException)
+ASN1_TIME* DateTime::getGeneralizedTime() const throw(BigIntegerException, EncodeException)
 {
 	ASN1_TIME *ret;
-	DateVal date;
-	stringstream stream;
-	string gt;
-	
-	date = DateTime::getDate(this->seconds);
-	
-	stream.setf(ios_base::right);
-	stream.fill('0');
-	
-	stream.width(4); //no maximo 4 digitos para ano
-	stream << date.year;
-	
-	stream.width(2);
-	stream << (date.mon + 1);	
-	stream.width(2);
-	stream << date.dayOfMonth;
-	stream.width(2);
-	stream << date.hour;
-	stream.width(2);
-	stream << date.min;
-	stream.width(2);
-	stream << date.sec;
-	stream.width(1);
-	stream << "Z";
-
-	gt = stream.str();
-	
+	char date[16];
+	unsigned int length;
+
+	length = DateTime::formatTime(this->seconds, false, date);
 	ret = ASN1_TIME_new();
-	
-	//pode retornar 1 no caso de falha de alocacao de memoria
-	ASN1_TIME_set_string_X509(ret, gt.c_str());
+
+	//pode falhar no caso de falha de alocacao de memoria
+	if (ret != NULL && ASN1_STRING_set(ret, date, length))
+	{
+		ret->type = V_ASN1_GENERALIZEDTIME;
+	}
 
 	return ret;
 }
 
-ASN1_TIME* DateTime::getUTCTime() const throw(BigIntegerException)
+ASN1_TIME* DateTime::getUTCTime() const throw(BigIntegerException, EncodeException)
 {
 	ASN1_TIME *ret;
-	DateVal date;
-	stringstream stream;
-	string tmp;
-	string utc;
-	
-	date = DateTime::getDate(this->seconds);
-	
-	stream.setf(ios_base::right);
-	stream.fill('0');
-	
-	stream.width(2); //define um tamanho minimo de 2 chars
-	stream << date.year;
-	stream >> tmp;
-	
-	//pega apenas os dois numeros mais a direita
-	if(tmp.size() > 2)
-	{
-		tmp = tmp.substr(tmp.size() - 2);
-	}
-	stream.clear();
-	stream.str("");
-	
-	stream << tmp;
-	stream.width(2);
-	stream << (date.mon + 1);	
-	stream.width(2);
-	stream << date.dayOfMonth;
-	stream.width(2);
-	stream << date.hour;
-	stream.width(2);
-	stream << date.min;
-	stream.width(2);
-	stream << date.sec;
-	stream.width(1);
-	stream << "Z";
-
-	utc = stream.str();
-	
+	char date[16];
+	unsigned int length;
+
+	length = DateTime::formatTime(this->seconds, true, date);
 	ret = ASN1_TIME_new();
 
-	//pode retornar 1 no caso de falha de alocacao de memoria
-	ASN1_TIME_set_string_X509(ret, utc.c_str());
+	//pode falhar no caso de falha de alocacao de memoria
+	if (ret != NULL && ASN1_STRING_set(ret, date, length))
+	{
+		ret->type = V_ASN1_UTCTIME;
+	}
 
 	return ret;
 }
@@ -289,97 +140,219 @@ ASN1_TIME* DateTime::getUTCTime() const throw(BigIntegerException)
 std::string DateTime::getISODate() const throw(BigIntegerException)
 {
 	DateVal date;
-	stringstream stream;
+	char iso[32];
+	int length;
 	
 	date = DateTime::getDate(this->seconds);
+	length = snprintf(iso, sizeof(iso), "%04d-%02d-%02dT%02d:%02d:%02d", date.year, date.mon + 1,
+			date.dayOfMonth, date.hour, date.min, date.sec);
 	
-	stream.setf(ios_base::right);
-	stream.fill('0');
-	
-	stream.width(4); //no maximo 4 digitos para ano
-	stream << date.year;
-	
-	stream.width(1);
-	stream << "-"; //delimitador
-	
-	stream.width(2);
-	stream << (date.mon + 1);	
-
-	stream.width(1);
-	stream << "-"; //delimitador
-	
-	stream.width(2);
-	stream << date.dayOfMonth;
-	
-	stream.width(1);
-	stream << "T"; //delimitador
-	
-	stream.width(2);
-	stream << date.hour;
-	
-	stream.width(1);
-	stream << ":"; //delimitador
-	
-	stream.width(2);
-	stream << date.min;
-
-	stream.width(1);
-	stream << ":"; //delimitador
-	
-	stream.width(2);
-	stream << date.sec;
-	
-	return stream.str();
+	return std::string(iso, length);
 }
 
 DateTime& DateTime::operator =(const DateTime& aDate) throw(BigIntegerException)
 {
-	this->setDateTime(aDate.getSeconds());
+	this->seconds = aDate.seconds;
 	return(*this);	
 }
 
-BigInteger const& DateTime::getSeconds() const throw()
+BigInteger DateTime::getSeconds() const throw(BigIntegerException)
 {
-	return this->seconds;
+	return BigInteger(static_cast<long>(this->seconds));
 }
 
 void DateTime::addSeconds(long b) throw(BigIntegerException)
 {
-	this->seconds.add(b);
+	this->seconds += b;
 }
 
 void DateTime::addMinutes(long b) throw(BigIntegerException)
 {
-	BigInteger tmp(b);
-	tmp.mul(60);
-	this->seconds.add(tmp);
+	this->seconds += b * 60LL;
 }
 
 void DateTime::addHours(long b) throw(BigIntegerException)
 {
-	BigInteger tmp(b);
-	tmp.mul(60);
-	tmp.mul(60);
-	this->seconds.add(tmp);
+	this->seconds += b * 3600LL;
 }
 
 void DateTime::addDays(long b) throw(BigIntegerException)
 {
-	BigInteger tmp(b);
-	tmp.mul(60);
-	tmp.mul(60);
-	tmp.mul(24);
-	this->seconds.add(tmp);
+	this->seconds += b * SECONDS_PER_DAY;
 }
 
 void DateTime::addYears(long b) throw(BigIntegerException)
 {
-	BigInteger tmp(b);
-	tmp.mul(60);
-	tmp.mul(60);
-	tmp.mul(24);
-	tmp.mul(365);
-	this->seconds.add(tmp);
+	this->seconds += b * 365 * SECONDS_PER_DAY;
+}
+
+DateTime::DateVal DateTime::getDate(BigInteger const& epoch) throw(BigIntegerException)
+{
+	return DateTime::getDate(static_cast<long long>(epoch.getValue()));
+}
+
+DateTime::DateVal DateTime::getDate(long long epoch) throw()
+{
+	DateTime::DateVal ret;
+	long long days, era;
+	int seconds, dayOfEra, yearOfEra, dayOfYear, month;
+
+	/* divisão arredondada para baixo, para que datas anteriores a 1970 caiam no dia certo */
+	days = epoch / SECONDS_PER_DAY;
+	if (epoch % SECONDS_PER_DAY < 0)
+	{
+		days--;
+	}
+	seconds = static_cast<int>(epoch - days * SECONDS_PER_DAY);
+	ret.hour = seconds / 3600;
+	ret.min = (seconds % 3600) / 60;
+	ret.sec = seconds % 60;
+
+	/* 01/01/1970 foi uma quinta-feira */
+	ret.dayOfWeek = static_cast<int>((days % 7 + 11) % 7);
+
+	/* eras de 400 anos começando em 1 de Março, como em getDaysSinceEpoch */
+	days += 719468;
+	era = (days >= 0 ? days : days - 146096) / 146097;
+	dayOfEra = static_cast<int>(days - era * 146097);
+	yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+	dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+	month = (5 * dayOfYear + 2) / 153;
+	ret.dayOfMonth = dayOfYear - (153 * month + 2) / 5 + 1;
+	ret.mon = (month < 10) ? month + 2 : month - 10;
+	ret.year = static_cast<int>(yearOfEra + era * 400) + (ret.mon <= 1 ? 1 : 0);
+	ret.dayOfYear = static_cast<int>(days - 719468 - DateTime::getDaysSinceEpoch(ret.year, 0, 1));
+
+	return ret;
+}
+
+BigInteger DateTime::date2epoch(string aString) throw(BigIntegerException, EncodeException)
+{
+	long long epoch = 0;
+
+	if (!DateTime::parseTime(aString.data(), aString.size(), epoch))
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "DateTime::date2epoch");
+	}
+	return BigInteger(static_cast<long>(epoch));
+}
+
+BigInteger DateTime::date2epoch(int year, int month, int day, int hour, int min, int sec) throw(BigIntegerException)
+{
+	long long epoch;
+
+	epoch = DateTime::getDaysSinceEpoch(year, month, day) * SECONDS_PER_DAY + hour * 3600 + min * 60 + sec;
+	return BigInteger(static_cast<long>(epoch));
+}
+
+long long DateTime::getDaysSinceEpoch(int year, int month, int day) throw()
+{
+	long long era;
+	int yearOfEra, dayOfYear;
+
+	/* o ano começa em 1 de Março, para que o dia bissexto seja o último do ano */
+	month++;
+	if (month <= 2)
+	{
+		year--;
+	}
+	era = (year >= 0 ? year : year - 399) / 400;
+	yearOfEra = static_cast<int>(year - era * 400);
+	dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	return era * 146097 + 365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100 + dayOfYear - 719468;
+}
+
+bool DateTime::parseTime(const char *data, unsigned long length, long long &epoch) throw()
+{
+	int digits[14], year, month, day, hour, min, sec, count, i;
+
+	if (data == NULL || (length != 13 && length != 15))
+	{
+		return false;
+	}
+	count = length - 1;
+	if (data[count] != 'Z')
+	{
+		return false;
+	}
+	for (i = 0; i < count; i++)
+	{
+		if (data[i] < '0' || data[i] > '9')
+		{
+			return false;
+		}
+		digits[i] = data[i] - '0';
+	}
+	if (count == 12)
+	{
+		year = digits[0] * 10 + digits[1];
+		year += (year >= 50) ? 1900 : 2000;
+		i = 2;
+	}
+	else
+	{
+		year = digits[0] * 1000 + digits[1] * 100 + digits[2] * 10 + digits[3];
+		i = 4;
+	}
+	month = digits[i] * 10 + digits[i + 1];
+	day = digits[i + 2] * 10 + digits[i + 3];
+	hour = digits[i + 4] * 10 + digits[i + 5];
+	min = digits[i + 6] * 10 + digits[i + 7];
+	sec = digits[i + 8] * 10 + digits[i + 9];
+	/* segundo 60 para o leap second */
+	if (month < 1 || month > 12 || day < 1 || day > DateTime::getMonthSize(month - 1, year)
+			|| hour > 23 || min > 59 || sec > 60)
+	{
+		return false;
+	}
+	epoch = DateTime::getDaysSinceEpoch(year, month - 1, day) * SECONDS_PER_DAY + hour * 3600 + min * 60 + sec;
+	return true;
+}
+
+unsigned int DateTime::formatTime(long long epoch, bool utcTime, char *out) throw(EncodeException)
+{
+	DateTime::DateVal date;
+	unsigned int length = 0;
+	int year;
+
+	date = DateTime::getDate(epoch);
+	/* anos que não cabem no formato seriam truncados para outra data */
+	if ((utcTime && !DateTime::isUTCTime(epoch)) || date.year < 0 || date.year > 9999)
+	{
+		throw EncodeException(EncodeException::DER_ENCODE, "DateTime::formatTime");
+	}
+	if (utcTime)
+	{
+		year = date.year % 100;
+		out[length++] = '0' + year / 10;
+		out[length++] = '0' + year % 10;
+	}
+	else
+	{
+		year = date.year;
+		out[length++] = '0' + year / 1000;
+		out[length++] = '0' + year / 100 % 10;
+		out[length++] = '0' + year / 10 % 10;
+		out[length++] = '0' + year % 10;
+	}
+	out[length++] = '0' + (date.mon + 1) / 10;
+	out[length++] = '0' + (date.mon + 1) % 10;
+	out[length++] = '0' + date.dayOfMonth / 10;
+	out[length++] = '0' + date.dayOfMonth % 10;
+	out[length++] = '0' + date.hour / 10;
+	out[length++] = '0' + date.hour % 10;
+	out[length++] = '0' + date.min / 10;
+	out[length++] = '0' + date.min % 10;
+	out[length++] = '0' + date.sec / 10;
+	out[length++] = '0' + date.sec % 10;
+	out[length++] = 'Z';
+	out[length] = '\0';
+	return length;
+}
+
+bool DateTime::isUTCTime(long long epoch) throw()
+{
+	return epoch >= UTC_TIME_BEGIN && epoch < UTC_TIME_END;
 }
 
 //versao antiga, sem suporte a biginteger
@@ -484,30 +457,30 @@ void DateTime::addYears(long b) throw(BigIntegerException)
 
 bool DateTime::operator==(const DateTime& other) const throw()
 {
-	return (this->getSeconds() == other.getSeconds());
+	return (this->seconds == other.seconds);
 }
 
 bool DateTime::operator==(time_t other) const throw(BigIntegerException)
 {
-	return (this->getSeconds() == other);
+	return (this->seconds == other);
 }
 
 bool DateTime::operator<(const DateTime& other) const throw()
 {
-	return (this->getSeconds() < other.getSeconds());
+	return (this->seconds < other.seconds);
 }
 
 bool DateTime::operator<(time_t other) const throw(BigIntegerException)
 {
-	return (this->getSeconds() < other);
+	return (this->seconds < other);
 }
 
 bool DateTime::operator>(const DateTime& other) const throw()
 {
-	return (this->getSeconds() > other.getSeconds());
+	return (this->seconds > other.seconds);
 }
 
 bool DateTime::operator>(time_t other) const throw(BigIntegerException)
 {
-	return (this->getSeconds() > other);
+	return (this->seconds > other);
 }
@@ -4,7 +4,12 @@ ECDSAKeyPair::ECDSAKeyPair(ByteArray& derEncoded) throw (AsymmetricKeyException)
 	this->key = NULL;
 	this->engine = NULL;
 	EC_GROUP * group = createGroup(derEncoded);
-	generateKey(group);
+	try {
+		generateKey(group);
+	} catch (...) {
+		EC_GROUP_free(group);
+		throw;
+	}
 	EC_GROUP_free(group);
 }
 
@@ -13,16 +18,20 @@ ECDSAKeyPair::ECDSAKeyPair(std::string& encoded) throw (AsymmetricKeyException)
 	this->engine = NULL;
 	ByteArray derEncoded = Base64::decode(encoded);
 	EC_GROUP * group = createGroup(derEncoded);
-	generateKey(group);
+	try {
+		generateKey(group);
+	} catch (...) {
+		EC_GROUP_free(group);
+		throw;
+	}
 	EC_GROUP_free(group);
 }
 
 ECDSAKeyPair::ECDSAKeyPair(const EllipticCurve & curve) throw (AsymmetricKeyException) {
 	this->key = NULL;
 	this->engine = NULL;
-	EC_GROUP * group = createGroup(curve);
-	generateKey(group);
-	EC_GROUP_free(group);
+	/* the group is shared through the registry and must not be freed here */
+	generateKey(EllipticCurveRegistry::getGroup(curve));
 }
 
 ECDSAKeyPair::ECDSAKeyPair(AsymmetricKey::Curve curve, bool named)
@@ -31,12 +40,22 @@ ECDSAKeyPair::ECDSAKeyPair(AsymmetricKey::Curve curve, bool named)
 	this->key = NULL;
 	this->engine = NULL;
 	eckey = NULL;
-	eckey = EC_KEY_new_by_curve_name(curve);
+	eckey = EC_KEY_new();
 
 	if (!eckey) {
 		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
 				"ECDSAKeyPair::ECDSAKeyPair");
 	}
+
+	try {
+		if (EC_KEY_set_group(eckey, EllipticCurveRegistry::getGroup(curve)) == 0) {
+			throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
+					"ECDSAKeyPair::ECDSAKeyPair");
+		}
+	} catch (...) {
+		EC_KEY_free(eckey);
+		throw;
+	}
 	
 	if (named)
 		EC_KEY_set_asn1_flag(eckey, OPENSSL_EC_NAMED_CURVE);
@@ -66,7 +85,7 @@ ECDSAKeyPair::~ECDSAKeyPair() {
 	}
 }
 
-void ECDSAKeyPair::generateKey(EC_GROUP * group) throw (AsymmetricKeyException) {
+void ECDSAKeyPair::generateKey(const EC_GROUP * group) throw (AsymmetricKeyException) {
 
 	EC_KEY* eckey = EC_KEY_new();
 
@@ -79,21 +98,18 @@ void ECDSAKeyPair::generateKey(EC_GROUP * group) throw (AsymmetricKeyException)
 
 	if (EC_KEY_set_group(eckey, group) == 0){
 		EC_KEY_free(eckey);
-		EC_GROUP_free(group);
 		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
 				"Failed to set group", "ECDSAKeyPair::generateKey");
 	}
 
 	if (!EC_KEY_generate_key(eckey)) {
 		EC_KEY_free(eckey);
-		EC_GROUP_free(group);
 		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
 				"Failed to generate keys", "ECDSAKeyPair::generateKey");
 	}
 
 	if (!eckey) {
 		EC_KEY_free(eckey);
-		EC_GROUP_free(group);
 		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
 				"Failed to generate keys", "ECDSAKeyPair::generateKey");
 	}
@@ -102,7 +118,6 @@ void ECDSAKeyPair::generateKey(EC_GROUP * group) throw (AsymmetricKeyException)
 	EVP_PKEY_assign_EC_KEY(this->key, eckey);
 	if (!this->key) {
 		EC_KEY_free(eckey);
-		EC_GROUP_free(group);
 		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
 				"Failed to assert EC_KEY into EVP_KEY", "ECDSAKeyPair::generateKey");
 	}
@@ -110,54 +125,11 @@ void ECDSAKeyPair::generateKey(EC_GROUP * group) throw (AsymmetricKeyException)
 }
 
 EC_GROUP * ECDSAKeyPair::createGroup(const EllipticCurve& curve) {
-	BN_CTX *ctx;
-	EC_GROUP *group;
-	EC_POINT *generator;
-
-	/* Set up the BN_CTX */
-	ctx = BN_CTX_new();
-	if (ctx == NULL){
-		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
-				"Failed to create BN_CTX", "ECDSAKeyPair::createGroup");
-	}
-
-	/* Create the curve */
-	group = EC_GROUP_new_curve_GFp(curve.BN_p(), curve.BN_a(),	curve.BN_b(), ctx);
+	EC_GROUP *group = EC_GROUP_dup(EllipticCurveRegistry::getGroup(curve));
 	if (group == NULL) {
-		BN_CTX_free(ctx);
 		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
 				"Failed to create group", "ECDSAKeyPair::createGroup");
 	}
-
-	/* Create the generator */
-	generator = EC_POINT_new(group);
-	if (generator == NULL) {
-		BN_CTX_free(ctx);
-		EC_GROUP_free(group);
-		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
-				"Failed to create generator", "ECDSAKeyPair::createGroup");
-	}
-
-	if (1 != EC_POINT_set_affine_coordinates_GFp(group, generator, curve.BN_x(), curve.BN_y(), ctx)) {
-		BN_CTX_free(ctx);
-		EC_GROUP_free(group);
-		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
-				"Failed to set the affine coordinates of a EC_POINT over GFp",
-				"ECDSAKeyPair::createGroup");
-	}
-
-	/* Set the generator and the order */
-	if (1 != EC_GROUP_set_generator(group, generator, curve.BN_order(),	curve.BN_cofactor())) {
-		BN_CTX_free(ctx);
-		EC_GROUP_free(group);
-		EC_POINT_free(generator);
-		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
-				"Failed to set generator and order", "ECDSAKeyPair::createGroup");
-	}
-
-	EC_POINT_free(generator);
-	BN_CTX_free(ctx);
-
 	return group;
 }
 
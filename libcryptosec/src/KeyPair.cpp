@@ -1,4 +1,5 @@
 #include <libcryptosec/KeyPair.h>
+#include <libcryptosec/RSAKeyPair.h>
 
 KeyPair::KeyPair()
 {
@@ -52,6 +53,26 @@ KeyPair::KeyPair(AsymmetricKey::Algorithm algorithm, int length)
 	}
 }
 
+KeyPair::KeyPair(AsymmetricKey::Algorithm algorithm, int length, int primes, bool parallel)
+		throw (AsymmetricKeyException)
+{
+	RSA *rsa;
+	this->key = NULL;
+	this->engine = NULL;
+	if (algorithm != AsymmetricKey::RSA)
+	{
+		throw AsymmetricKeyException(AsymmetricKeyException::INVALID_TYPE, "KeyPair::KeyPair");
+	}
+	rsa = RSAKeyPair::generateKey(length, primes, parallel ? RSAKeyPair::PARALLEL : RSAKeyPair::SEQUENTIAL);
+	this->key = EVP_PKEY_new();
+	if (!this->key)
+	{
+		RSA_free(rsa);
+		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR, "KeyPair::KeyPair");
+	}
+	EVP_PKEY_assign_RSA(this->key, rsa);
+}
+
 KeyPair::KeyPair(Engine *engine, std::string keyId)
 		throw (EngineException)
 {
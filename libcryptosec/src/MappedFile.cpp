@@ -0,0 +1,59 @@
+#include <libcryptosec/MappedFile.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(std::string path) throw (EncodeException)
+{
+	struct stat st;
+	void *addr;
+	int fd;
+
+	this->data = NULL;
+	this->size = 0;
+	fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		throw EncodeException(EncodeException::BUFFER_READING, "MappedFile::MappedFile");
+	}
+	if (fstat(fd, &st) != 0)
+	{
+		close(fd);
+		throw EncodeException(EncodeException::BUFFER_READING, "MappedFile::MappedFile");
+	}
+	/* mmap does not accept empty mappings */
+	if (st.st_size > 0)
+	{
+		addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr == MAP_FAILED)
+		{
+			close(fd);
+			throw EncodeException(EncodeException::BUFFER_READING, "MappedFile::MappedFile");
+		}
+		/* the whole file is going to be scanned from start to end */
+		madvise(addr, st.st_size, MADV_SEQUENTIAL);
+		this->data = (unsigned char *) addr;
+		this->size = st.st_size;
+	}
+	close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if (this->data != NULL)
+	{
+		munmap(this->data, this->size);
+	}
+}
+
+const unsigned char* MappedFile::getData() const
+{
+	return this->data;
+}
+
+unsigned long MappedFile::getSize() const
+{
+	return this->size;
+}
@@ -184,6 +184,24 @@ const EVP_MD* MessageDigest::getMessageDigest(MessageDigest::Algorithm algorithm
 	return md;
 }
 
+const EVP_MD* MessageDigest::getMessageDigest(MessageDigest::Algorithm algorithm, EVP_PKEY *key)
+{
+	int pkeyType, nid;
+
+	/* 2 with NID_undef: the key type forbids a digest */
+	if (EVP_PKEY_get_default_digest_nid(key, &nid) == 2 && nid == NID_undef)
+	{
+		return NULL;
+	}
+	/* EdDSA types of OpenSSL builds whose methods do not report it */
+	pkeyType = EVP_PKEY_base_id(key);
+	if (pkeyType == OBJ_sn2nid("ED25519") || pkeyType == OBJ_sn2nid("ED521") || pkeyType == OBJ_sn2nid("ED448"))
+	{
+		return NULL;
+	}
+	return MessageDigest::getMessageDigest(algorithm);
+}
+
 ObjectIdentifier MessageDigest::getMessageDigestOid(MessageDigest::Algorithm algorithm) throw (MessageDigestException)
 {
 	ASN1_OBJECT* asn1object = NULL;
@@ -0,0 +1,212 @@
+#include <libcryptosec/PublicKeyCache.h>
+
+#include <openssl/sha.h>
+#include <limits.h>
+
+CRYPTO_ONCE PublicKeyCache::once = CRYPTO_ONCE_STATIC_INIT;
+PublicKeyCache *PublicKeyCache::defaultCache = NULL;
+
+PublicKeyCache::PublicKeyCache(unsigned int capacity, unsigned int shards)
+{
+	unsigned int i;
+	Shard *shard;
+
+	if (shards == 0)
+	{
+		shards = 1;
+	}
+	if (capacity < shards)
+	{
+		capacity = shards;
+	}
+	this->shardCapacity = capacity / shards;
+	for (i = 0; i < shards; i++)
+	{
+		shard = new Shard();
+		shard->lock = CRYPTO_THREAD_lock_new();
+		shard->hits = 0;
+		shard->misses = 0;
+		shard->evictions = 0;
+		this->shards.push_back(shard);
+	}
+}
+
+PublicKeyCache::~PublicKeyCache()
+{
+	unsigned int i;
+	this->clear();
+	for (i = 0; i < this->shards.size(); i++)
+	{
+		CRYPTO_THREAD_lock_free(this->shards[i]->lock);
+		delete this->shards[i];
+	}
+}
+
+EVP_PKEY* PublicKeyCache::get(const unsigned char *derEncoded, unsigned long length)
+{
+	std::string key;
+	const unsigned char *p;
+	EVP_PKEY *ret;
+
+	if (derEncoded == NULL || length == 0 || length > LONG_MAX)
+	{
+		return NULL;
+	}
+	key = PublicKeyCache::getKey(derEncoded, length);
+	Shard &shard = this->getShard(key);
+	ret = this->find(shard, key);
+	if (ret == NULL)
+	{
+		/* the decoding is done outside the lock; trailing bytes would give the same key another entry */
+		p = derEncoded;
+		ret = d2i_PUBKEY(NULL, &p, (long) length);
+		if (ret != NULL && p != derEncoded + length)
+		{
+			EVP_PKEY_free(ret);
+			ret = NULL;
+		}
+		if (ret != NULL)
+		{
+			ret = this->insert(shard, key, ret);
+		}
+	}
+	return ret;
+}
+
+EVP_PKEY* PublicKeyCache::get(ByteArray &derEncoded)
+{
+	return this->get(derEncoded.getDataPointer(), derEncoded.size());
+}
+
+PublicKeyCache::Stats PublicKeyCache::getStats()
+{
+	Stats ret;
+	unsigned int i;
+
+	ret.hits = 0;
+	ret.misses = 0;
+	ret.evictions = 0;
+	ret.size = 0;
+	for (i = 0; i < this->shards.size(); i++)
+	{
+		CRYPTO_THREAD_read_lock(this->shards[i]->lock);
+		ret.hits += this->shards[i]->hits;
+		ret.misses += this->shards[i]->misses;
+		ret.evictions += this->shards[i]->evictions;
+		ret.size += this->shards[i]->index.size();
+		CRYPTO_THREAD_unlock(this->shards[i]->lock);
+	}
+	return ret;
+}
+
+unsigned int PublicKeyCache::getCapacity() const
+{
+	return this->shardCapacity * this->shards.size();
+}
+
+void PublicKeyCache::clear()
+{
+	std::list<Entry>::iterator it;
+	unsigned int i;
+	Shard *shard;
+
+	for (i = 0; i < this->shards.size(); i++)
+	{
+		shard = this->shards[i];
+		CRYPTO_THREAD_write_lock(shard->lock);
+		for (it = shard->entries.begin(); it != shard->entries.end(); it++)
+		{
+			EVP_PKEY_free(it->pkey);
+		}
+		shard->entries.clear();
+		shard->index.clear();
+		shard->hits = 0;
+		shard->misses = 0;
+		shard->evictions = 0;
+		CRYPTO_THREAD_unlock(shard->lock);
+	}
+}
+
+PublicKeyCache& PublicKeyCache::getDefault()
+{
+	CRYPTO_THREAD_run_once(&PublicKeyCache::once, PublicKeyCache::init);
+	return *PublicKeyCache::defaultCache;
+}
+
+void PublicKeyCache::init()
+{
+	PublicKeyCache::defaultCache = new PublicKeyCache();
+}
+
+PublicKeyCache::Shard& PublicKeyCache::getShard(const std::string &key)
+{
+	/* the key is a digest, so its first bytes are already uniformly distributed */
+	unsigned int pos;
+	pos = ((unsigned char) key[0] << 8) | (unsigned char) key[1];
+	return *this->shards[pos % this->shards.size()];
+}
+
+EVP_PKEY* PublicKeyCache::find(Shard &shard, const std::string &key)
+{
+	std::map<std::string, std::list<Entry>::iterator>::iterator it;
+	EVP_PKEY *ret = NULL;
+
+	/* a hit reorders the LRU list, so even lookups take the write lock */
+	CRYPTO_THREAD_write_lock(shard.lock);
+	it = shard.index.find(key);
+	if (it != shard.index.end())
+	{
+		shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+		ret = it->second->pkey;
+		EVP_PKEY_up_ref(ret);
+		shard.hits++;
+	}
+	else
+	{
+		shard.misses++;
+	}
+	CRYPTO_THREAD_unlock(shard.lock);
+	return ret;
+}
+
+EVP_PKEY* PublicKeyCache::insert(Shard &shard, const std::string &key, EVP_PKEY *pkey)
+{
+	std::map<std::string, std::list<Entry>::iterator>::iterator it;
+	EVP_PKEY *ret;
+	Entry entry;
+
+	CRYPTO_THREAD_write_lock(shard.lock);
+	it = shard.index.find(key);
+	if (it != shard.index.end())
+	{
+		/* another thread decoded the same key first */
+		EVP_PKEY_free(pkey);
+		ret = it->second->pkey;
+	}
+	else
+	{
+		entry.key = key;
+		entry.pkey = pkey;
+		shard.entries.push_front(entry);
+		shard.index[key] = shard.entries.begin();
+		ret = pkey;
+		while (shard.index.size() > this->shardCapacity)
+		{
+			shard.index.erase(shard.entries.back().key);
+			EVP_PKEY_free(shard.entries.back().pkey);
+			shard.entries.pop_back();
+			shard.evictions++;
+		}
+	}
+	/* one reference stays in the cache, the other goes to the caller */
+	EVP_PKEY_up_ref(ret);
+	CRYPTO_THREAD_unlock(shard.lock);
+	return ret;
+}
+
+std::string PublicKeyCache::getKey(const unsigned char *derEncoded, unsigned long length)
+{
+	unsigned char digest[SHA256_DIGEST_LENGTH];
+	SHA256(derEncoded, length, digest);
+	return std::string((const char *) digest, SHA256_DIGEST_LENGTH);
+}
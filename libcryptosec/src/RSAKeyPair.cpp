@@ -1,5 +1,83 @@
 #include <libcryptosec/RSAKeyPair.h>
 
+#include <pthread.h>
+
+#define RSAKEYPAIR_MAX_PRIMES 4
+
+/*
+ * State of the search of one prime. All the searches of the same key share the
+ * cancellation flag, so a failing search stops its siblings at the next candidate.
+ */
+struct RSAPrimeSearch
+{
+	BIGNUM *prime;
+	int bits;
+	const BIGNUM *e;
+	int *cancelled;
+	CRYPTO_RWLOCK *lock;
+	bool ok;
+};
+
+static bool rsaPrimeSearchCancelled(RSAPrimeSearch *search)
+{
+	bool ret;
+	CRYPTO_THREAD_read_lock(search->lock);
+	ret = (*search->cancelled != 0);
+	CRYPTO_THREAD_unlock(search->lock);
+	return ret;
+}
+
+static void rsaPrimeSearchCancel(RSAPrimeSearch *search)
+{
+	CRYPTO_THREAD_write_lock(search->lock);
+	*search->cancelled = 1;
+	CRYPTO_THREAD_unlock(search->lock);
+}
+
+/* returning 0 makes BN_generate_prime_ex give up the search */
+static int rsaPrimeSearchCallback(int, int, BN_GENCB *cb)
+{
+	return !rsaPrimeSearchCancelled((RSAPrimeSearch *)BN_GENCB_get_arg(cb));
+}
+
+static void* rsaPrimeSearchRun(void *arg)
+{
+	RSAPrimeSearch *search;
+	BN_GENCB *cb;
+	BN_CTX *ctx;
+	BIGNUM *r;
+	search = (RSAPrimeSearch *)arg;
+	search->ok = false;
+	cb = BN_GENCB_new();
+	ctx = BN_CTX_new();
+	r = BN_new();
+	if (cb && ctx && r)
+	{
+		BN_GENCB_set(cb, rsaPrimeSearchCallback, search);
+		while (BN_generate_prime_ex(search->prime, search->bits, 0, NULL, NULL, cb))
+		{
+			/* prime - 1 must be coprime with the public exponent */
+			if (!BN_sub(r, search->prime, BN_value_one()) || !BN_gcd(r, r, search->e, ctx))
+			{
+				break;
+			}
+			if (BN_is_one(r))
+			{
+				search->ok = true;
+				break;
+			}
+		}
+	}
+	if (!search->ok)
+	{
+		rsaPrimeSearchCancel(search);
+	}
+	BN_free(r);
+	BN_CTX_free(ctx);
+	BN_GENCB_free(cb);
+	return NULL;
+}
+
 RSAKeyPair::RSAKeyPair(int length)
 		throw (AsymmetricKeyException)
 {
@@ -25,6 +103,22 @@ RSAKeyPair::RSAKeyPair(int length)
 	}
 }
 
+RSAKeyPair::RSAKeyPair(int length, int primes, RSAKeyPair::GenerationMode mode)
+		throw (AsymmetricKeyException)
+{
+	RSA *rsa;
+	this->key = NULL;
+	this->engine = NULL;
+	rsa = RSAKeyPair::generateKey(length, primes, mode);
+	this->key = EVP_PKEY_new();
+	if (!this->key)
+	{
+		RSA_free(rsa);
+		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR, "RSAKeyPair::RSAKeyPair");
+	}
+	EVP_PKEY_assign_RSA(this->key, rsa);
+}
+
 RSAKeyPair::~RSAKeyPair()
 {
 	if (this->key)
@@ -90,3 +184,286 @@ AsymmetricKey::Algorithm RSAKeyPair::getAlgorithm()
 {
 	return AsymmetricKey::RSA;
 }
+
+int RSAKeyPair::getPrimesNumber()
+		throw (AsymmetricKeyException)
+{
+	const RSA *rsa;
+	if (this->key == NULL)
+	{
+		throw AsymmetricKeyException(AsymmetricKeyException::SET_NO_VALUE, "RSAKeyPair::getPrimesNumber");
+	}
+	rsa = EVP_PKEY_get0_RSA(this->key);
+	if (rsa == NULL)
+	{
+		throw AsymmetricKeyException(AsymmetricKeyException::INVALID_TYPE, "RSAKeyPair::getPrimesNumber");
+	}
+	return RSA_get_multi_prime_extra_count(rsa) + 2;
+}
+
+int RSAKeyPair::getMaxPrimesNumber(int length)
+{
+	/* same caps used by OpenSSL (rsa_multip_cap), limited to RSAKEYPAIR_MAX_PRIMES */
+	if (length < 1024)
+	{
+		return 2;
+	}
+	if (length < 4096)
+	{
+		return 3;
+	}
+	return RSAKEYPAIR_MAX_PRIMES;
+}
+
+RSA* RSAKeyPair::generateKey(int length, int primes, RSAKeyPair::GenerationMode mode)
+		throw (AsymmetricKeyException)
+{
+	RSA *rsa;
+	BIGNUM *e;
+	int rc;
+	if (primes < 2 || primes > RSAKeyPair::getMaxPrimesNumber(length))
+	{
+		throw AsymmetricKeyException(AsymmetricKeyException::INVALID_ASYMMETRIC_KEY, "Unsupported number of primes for this key length", "RSAKeyPair::generateKey");
+	}
+	if (mode == RSAKeyPair::PARALLEL)
+	{
+		return RSAKeyPair::generateKeyParallel(length, primes);
+	}
+	rsa = RSA_new();
+	e = BN_new();
+	if (!rsa || !e || !BN_set_word(e, RSA_F4))
+	{
+		RSA_free(rsa);
+		BN_free(e);
+		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR, "RSAKeyPair::generateKey");
+	}
+	if (primes == 2)
+	{
+		rc = RSA_generate_key_ex(rsa, length, e, NULL);
+	}
+	else
+	{
+		rc = RSA_generate_multi_prime_key(rsa, length, primes, e, NULL);
+	}
+	BN_free(e);
+	if (!rc)
+	{
+		RSA_free(rsa);
+		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR, "RSAKeyPair::generateKey");
+	}
+	return rsa;
+}
+
+RSA* RSAKeyPair::generateKeyParallel(int length, int primes)
+		throw (AsymmetricKeyException)
+{
+	RSAPrimeSearch searches[RSAKEYPAIR_MAX_PRIMES];
+	pthread_t threads[RSAKEYPAIR_MAX_PRIMES];
+	bool started[RSAKEYPAIR_MAX_PRIMES];
+	BIGNUM *p[RSAKEYPAIR_MAX_PRIMES];
+	BIGNUM *e, *n;
+	BN_CTX *ctx;
+	CRYPTO_RWLOCK *lock;
+	RSA *ret;
+	bool ok, distinct;
+	int cancelled, i, j;
+	ret = NULL;
+	e = BN_new();
+	n = BN_new();
+	ctx = BN_CTX_new();
+	lock = CRYPTO_THREAD_lock_new();
+	ok = (e && n && ctx && lock && BN_set_word(e, RSA_F4));
+	for (i = 0; i < primes; i++)
+	{
+		p[i] = BN_new();
+		ok = ok && p[i];
+	}
+	while (ok && ret == NULL)
+	{
+		cancelled = 0;
+		for (i = 0; i < primes; i++)
+		{
+			searches[i].prime = p[i];
+			searches[i].bits = length / primes + ((i < length % primes) ? 1 : 0);
+			searches[i].e = e;
+			searches[i].cancelled = &cancelled;
+			searches[i].lock = lock;
+			searches[i].ok = false;
+		}
+		/* the calling thread searches the first prime itself */
+		for (i = 1; i < primes; i++)
+		{
+			started[i] = (pthread_create(&threads[i], NULL, rsaPrimeSearchRun, &searches[i]) == 0);
+		}
+		rsaPrimeSearchRun(&searches[0]);
+		for (i = 1; i < primes; i++)
+		{
+			if (started[i])
+			{
+				pthread_join(threads[i], NULL);
+			}
+			else
+			{
+				rsaPrimeSearchRun(&searches[i]);
+			}
+		}
+		for (i = 0; i < primes; i++)
+		{
+			ok = ok && searches[i].ok;
+		}
+		if (!ok)
+		{
+			break;
+		}
+		/* the primes must be distinct and their product must have exactly the requested length */
+		distinct = true;
+		ok = (BN_copy(n, p[0]) != NULL);
+		for (i = 1; ok && i < primes; i++)
+		{
+			for (j = 0; j < i; j++)
+			{
+				distinct = distinct && (BN_cmp(p[i], p[j]) != 0);
+			}
+			ok = BN_mul(n, n, p[i], ctx);
+		}
+		if (ok && distinct && BN_num_bits(n) == length)
+		{
+			ret = RSAKeyPair::buildKey(p, primes, e);
+			ok = (ret != NULL);
+		}
+	}
+	for (i = 0; i < primes; i++)
+	{
+		BN_clear_free(p[i]);
+	}
+	BN_free(e);
+	BN_free(n);
+	BN_CTX_free(ctx);
+	CRYPTO_THREAD_lock_free(lock);
+	if (ret == NULL)
+	{
+		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR, "RSAKeyPair::generateKeyParallel");
+	}
+	return ret;
+}
+
+RSA* RSAKeyPair::buildKey(BIGNUM **primes, int nprimes, const BIGNUM *e)
+{
+	BIGNUM *n, *d, *phi, *r, *prod, *publicExponent;
+	BIGNUM *factors[RSAKEYPAIR_MAX_PRIMES], *exps[RSAKEYPAIR_MAX_PRIMES], *coeffs[RSAKEYPAIR_MAX_PRIMES];
+	BN_CTX *ctx;
+	RSA *rsa;
+	bool ok;
+	int i;
+	rsa = RSA_new();
+	ctx = BN_CTX_new();
+	n = BN_new();
+	phi = BN_new();
+	r = BN_new();
+	prod = BN_new();
+	publicExponent = BN_dup(e);
+	d = NULL;
+	ok = (rsa && ctx && n && phi && r && prod && publicExponent);
+	for (i = 0; i < nprimes; i++)
+	{
+		factors[i] = BN_dup(primes[i]);
+		exps[i] = BN_new();
+		coeffs[i] = NULL;
+		ok = ok && factors[i] && exps[i];
+		if (ok)
+		{
+			BN_set_flags(factors[i], BN_FLG_CONSTTIME);
+		}
+	}
+	/* n = p1 * ... * pk, phi = (p1 - 1) * ... * (pk - 1) */
+	ok = ok && BN_one(n) && BN_one(phi);
+	for (i = 0; ok && i < nprimes; i++)
+	{
+		ok = BN_mul(n, n, factors[i], ctx) && BN_sub(r, factors[i], BN_value_one()) && BN_mul(phi, phi, r, ctx);
+	}
+	if (ok)
+	{
+		BN_set_flags(phi, BN_FLG_CONSTTIME);
+		d = BN_mod_inverse(NULL, e, phi, ctx);
+		ok = (d != NULL);
+	}
+	/*
+	 * CRT exponents d mod (pi - 1), the coefficient q^-1 mod p and, for the
+	 * additional primes, the coefficients (p1 * ... * pi-1)^-1 mod pi
+	 */
+	ok = ok && BN_mul(prod, factors[0], factors[1], ctx);
+	for (i = 0; ok && i < nprimes; i++)
+	{
+		ok = BN_sub(r, factors[i], BN_value_one()) && BN_mod(exps[i], d, r, ctx);
+		if (ok && i == 1)
+		{
+			coeffs[i] = BN_mod_inverse(NULL, factors[1], factors[0], ctx);
+			ok = (coeffs[i] != NULL);
+		}
+		else if (ok && i > 1)
+		{
+			coeffs[i] = BN_mod_inverse(NULL, prod, factors[i], ctx);
+			ok = (coeffs[i] != NULL) && BN_mul(prod, prod, factors[i], ctx);
+		}
+	}
+	/* RSA_set0_* take ownership of the numbers only on success */
+	if (ok && RSA_set0_key(rsa, n, publicExponent, d))
+	{
+		n = NULL;
+		publicExponent = NULL;
+		d = NULL;
+	}
+	else
+	{
+		ok = false;
+	}
+	if (ok && RSA_set0_factors(rsa, factors[0], factors[1]))
+	{
+		factors[0] = factors[1] = NULL;
+	}
+	else
+	{
+		ok = false;
+	}
+	if (ok && RSA_set0_crt_params(rsa, exps[0], exps[1], coeffs[1]))
+	{
+		exps[0] = exps[1] = coeffs[1] = NULL;
+	}
+	else
+	{
+		ok = false;
+	}
+	if (ok && nprimes > 2)
+	{
+		if (RSA_set0_multi_prime_params(rsa, &factors[2], &exps[2], &coeffs[2], nprimes - 2))
+		{
+			for (i = 2; i < nprimes; i++)
+			{
+				factors[i] = exps[i] = coeffs[i] = NULL;
+			}
+		}
+		else
+		{
+			ok = false;
+		}
+	}
+	for (i = 0; i < nprimes; i++)
+	{
+		BN_clear_free(factors[i]);
+		BN_clear_free(exps[i]);
+		BN_clear_free(coeffs[i]);
+	}
+	BN_free(n);
+	BN_free(publicExponent);
+	BN_clear_free(d);
+	BN_clear_free(phi);
+	BN_clear_free(r);
+	BN_clear_free(prod);
+	BN_CTX_free(ctx);
+	if (!ok)
+	{
+		RSA_free(rsa);
+		return NULL;
+	}
+	return rsa;
+}
@@ -12,6 +12,22 @@ AccessDescription::AccessDescription(ACCESS_DESCRIPTION *accessDescription) {
 	}
 }
 
+void AccessDescription::encode(DerWriter &writer) const
+{
+	writer.begin(DerWriter::SEQUENCE);
+	writer.writeObject(this->accessMethod);
+	this->accessLocation.encode(writer);
+	writer.end();
+}
+
+void AccessDescription::write(DocumentWriter &writer)
+{
+	writer.begin("accessDescription");
+	writer.write("accessMethod", this->accessMethod.getOid());
+	this->accessLocation.write(writer);
+	writer.end();
+}
+
 ACCESS_DESCRIPTION* AccessDescription::getAccessDescription() {
 	ACCESS_DESCRIPTION* accessDescription = ACCESS_DESCRIPTION_new();
 
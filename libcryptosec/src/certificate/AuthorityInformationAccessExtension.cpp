@@ -25,10 +25,36 @@ AuthorityInformationAccessExtension::AuthorityInformationAccessExtension(X509_EX
 	AUTHORITY_INFO_ACCESS_free(authorityInfoAccess);
 }
 
+void AuthorityInformationAccessExtension::encodeValue(DerWriter &writer)
+{
+	writer.begin(DerWriter::SEQUENCE);
+	for (unsigned int i = 0; i < this->accessDescriptions.size(); i++)
+	{
+		this->accessDescriptions[i].encode(writer);
+	}
+	writer.end();
+}
+
+void AuthorityInformationAccessExtension::writeValue(DocumentWriter &writer)
+{
+	writer.beginList("accessDescriptions");
+	for (unsigned int i = 0; i < this->accessDescriptions.size(); i++)
+	{
+		this->accessDescriptions[i].write(writer);
+	}
+	writer.end();
+}
+
 X509_EXTENSION* AuthorityInformationAccessExtension::getX509Extension() {
 	X509_EXTENSION *ret;
 	AUTHORITY_INFO_ACCESS *authorityInfoAccess;
 
+	ret = this->encodeX509Extension(NID_info_access);
+	if (ret != NULL)
+	{
+		return ret;
+	}
+	/* values the writer does not handle are encoded by OpenSSL */
 	authorityInfoAccess = AUTHORITY_INFO_ACCESS_new();
 	unsigned int i;
 	for (i=0;i<this->accessDescriptions.size();i++)
@@ -134,11 +134,51 @@ long AuthorityKeyIdentifierExtension::getAuthorityCertSerialNumber()
 	return this->serialNumber;
 }
 
+void AuthorityKeyIdentifierExtension::encodeValue(DerWriter &writer)
+{
+	writer.begin(DerWriter::SEQUENCE);
+	if (this->keyIdentifier.size() > 0)
+	{
+		writer.writePrimitive(DerWriter::CONTEXT_SPECIFIC | 0, this->keyIdentifier.getDataPointer(), this->keyIdentifier.size());
+	}
+	if (this->authorityCertIssuer.getNumberOfEntries() > 0)
+	{
+		this->authorityCertIssuer.encode(writer, DerWriter::CONTEXT_CONSTRUCTED | 1);
+	}
+	if (this->serialNumber >= 0)
+	{
+		writer.writeInteger(this->serialNumber, DerWriter::CONTEXT_SPECIFIC | 2);
+	}
+	writer.end();
+}
+
+void AuthorityKeyIdentifierExtension::writeValue(DocumentWriter &writer)
+{
+	if (this->keyIdentifier.size() > 0)
+	{
+		writer.writeBase64("keyIdentifier", this->keyIdentifier.getDataPointer(), this->keyIdentifier.size());
+	}
+	if (this->authorityCertIssuer.getNumberOfEntries() > 0)
+	{
+		this->authorityCertIssuer.write(writer, "authorityCertIssuer");
+	}
+	if (this->serialNumber > 0)
+	{
+		writer.write("authorityCertSerialNumber", this->serialNumber);
+	}
+}
+
 X509_EXTENSION* AuthorityKeyIdentifierExtension::getX509Extension()
 {
 	X509_EXTENSION *ret;
 	AUTHORITY_KEYID *authKeyId;
 	ByteArray temp;
+	ret = this->encodeX509Extension(NID_authority_key_identifier);
+	if (ret != NULL)
+	{
+		return ret;
+	}
+	/* values the writer does not handle are encoded by OpenSSL */
 	authKeyId = AUTHORITY_KEYID_new();
 	if (this->keyIdentifier.size() > 0)
 	{
@@ -111,18 +111,30 @@ long BasicConstraintsExtension::getPathLen()
 	return this->pathLen;
 }
 
-X509_EXTENSION* BasicConstraintsExtension::getX509Extension()
+void BasicConstraintsExtension::encodeValue(DerWriter &writer)
 {
-	X509_EXTENSION *ret;
-	BASIC_CONSTRAINTS_st *basicConstraints;
-	basicConstraints = BASIC_CONSTRAINTS_new();
-	basicConstraints->ca = this->ca?255:0;
+	writer.begin(DerWriter::SEQUENCE);
+	if (this->ca)
+	{
+		writer.writeBoolean(true);
+	}
 	if (this->pathLen >= 0)
 	{
-		basicConstraints->pathlen = ASN1_INTEGER_new();
-		ASN1_INTEGER_set(basicConstraints->pathlen, this->pathLen);
+		writer.writeInteger(this->pathLen);
 	}
-	ret = X509V3_EXT_i2d(NID_basic_constraints, this->critical?1:0, (void *)basicConstraints);
-	BASIC_CONSTRAINTS_free(basicConstraints);
-	return ret;
+	writer.end();
+}
+
+void BasicConstraintsExtension::writeValue(DocumentWriter &writer)
+{
+	writer.write("ca", this->ca);
+	if (this->pathLen >= 0)
+	{
+		writer.write("pathLenConstraint", this->pathLen);
+	}
+}
+
+X509_EXTENSION* BasicConstraintsExtension::getX509Extension()
+{
+	return this->encodeX509Extension(NID_basic_constraints);
 }
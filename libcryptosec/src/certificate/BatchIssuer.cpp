@@ -0,0 +1,490 @@
+#include <libcryptosec/certificate/BatchIssuer.h>
+
+#include <openssl/err.h>
+#include <string.h>
+#include <unistd.h>
+
+/* requisições em andamento por thread quando o limite não é definido */
+#define JOBS_PER_THREAD	4
+/* dados codificados por linha PEM (64 caracteres Base64) */
+#define PEM_LINE_BYTES	48
+
+BatchIssuer::StreamSource::StreamSource(std::istream &in) : in(in)
+{
+}
+
+BatchIssuer::StreamSource::~StreamSource()
+{
+}
+
+bool BatchIssuer::StreamSource::next(std::string &request)
+{
+	std::string line;
+	bool inside = false;
+
+	while (std::getline(this->in, line))
+	{
+		if (!line.empty() && line[line.size() - 1] == '\r')
+		{
+			line.erase(line.size() - 1);
+		}
+		if (!inside)
+		{
+			inside = (line == "-----BEGIN CERTIFICATE REQUEST-----" || line == "-----BEGIN NEW CERTIFICATE REQUEST-----");
+			request = line;
+		}
+		else
+		{
+			request += line;
+		}
+		if (inside)
+		{
+			request += '\n';
+			if (line.compare(0, 9, "-----END ") == 0)
+			{
+				return true;
+			}
+		}
+	}
+	if (inside)
+	{
+		throw EncodeException(EncodeException::PEM_DECODE, "BatchIssuer::StreamSource::next");
+	}
+	return false;
+}
+
+BatchIssuer::SequentialPolicy::SequentialPolicy(const BigInteger &firstSerialNumber, const DateTime &notBefore,
+		const DateTime &notAfter)
+	: firstSerialNumber(firstSerialNumber), notBefore(notBefore), notAfter(notAfter)
+{
+}
+
+BatchIssuer::SequentialPolicy::~SequentialPolicy()
+{
+}
+
+bool BatchIssuer::SequentialPolicy::apply(unsigned long index, CertificateRequest &, Issuance &issuance)
+{
+	issuance.serialNumber = this->firstSerialNumber + (long) index;
+	issuance.notBefore = this->notBefore;
+	issuance.notAfter = this->notAfter;
+	return true;
+}
+
+BatchIssuer::StreamSink::StreamSink(std::ostream &out) : out(out), rejected(0)
+{
+}
+
+BatchIssuer::StreamSink::~StreamSink()
+{
+}
+
+void BatchIssuer::StreamSink::write(unsigned long, CertificateRequest *, Status status,
+		const std::string &certificate)
+{
+	if (status == BatchIssuer::ISSUED)
+	{
+		this->out.write(certificate.data(), certificate.size());
+	}
+	else
+	{
+		this->rejected++;
+	}
+}
+
+unsigned long BatchIssuer::StreamSink::getRejected() const
+{
+	return this->rejected;
+}
+
+BatchIssuer::BatchIssuer(IssuanceTemplate &issuanceTemplate, Policy &policy)
+	: issuanceTemplate(issuanceTemplate), policy(policy), threads(0), queueSize(0), format(BatchIssuer::DER)
+{
+}
+
+BatchIssuer::~BatchIssuer()
+{
+}
+
+void BatchIssuer::setThreads(unsigned int threads)
+{
+	this->threads = threads;
+}
+
+void BatchIssuer::setQueueSize(unsigned int queueSize)
+{
+	this->queueSize = queueSize;
+}
+
+void BatchIssuer::setFormat(BatchIssuer::Format format)
+{
+	this->format = format;
+}
+
+BatchIssuer::Metrics BatchIssuer::issue(Source &source, Sink &sink)
+{
+	std::map<unsigned long, Job *>::iterator it;
+	std::vector<pthread_t> workers;
+	unsigned long nextIndex = 0, nextWrite = 0, capacity;
+	unsigned int count, i;
+	struct timespec total, begin;
+	Job *current = NULL;
+	bool exhausted = false, stalled = false, locked;
+	pthread_t worker;
+	Pipeline pipeline;
+	long cpus;
+
+	count = this->threads;
+	if (count == 0)
+	{
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		count = (cpus > 0) ? cpus : 1;
+	}
+	capacity = (this->queueSize > 0) ? this->queueSize : count * JOBS_PER_THREAD;
+
+	clock_gettime(CLOCK_MONOTONIC, &total);
+	memset(&pipeline.metrics, 0, sizeof(pipeline.metrics));
+	pipeline.issuer = this;
+	pipeline.nextContext = 0;
+	pipeline.finished = false;
+	try
+	{
+		/* um contexto de assinatura por thread */
+		for (i = 0; i < count; i++)
+		{
+			pipeline.contexts.push_back(this->issuanceTemplate.newSigningContext());
+		}
+	}
+	catch (...)
+	{
+		for (i = 0; i < pipeline.contexts.size(); i++)
+		{
+			EVP_MD_CTX_free(pipeline.contexts[i]);
+		}
+		throw;
+	}
+	pthread_mutex_init(&pipeline.mutex, NULL);
+	pthread_cond_init(&pipeline.pending, NULL);
+	pthread_cond_init(&pipeline.completed, NULL);
+
+	for (i = 0; i < count; i++)
+	{
+		if (pthread_create(&worker, NULL, BatchIssuer::run, &pipeline) == 0)
+		{
+			workers.push_back(worker);
+		}
+	}
+	if (workers.empty())
+	{
+		BatchIssuer::release(pipeline);
+		throw CertificationException(CertificationException::INTERNAL_ERROR, "BatchIssuer::issue");
+	}
+
+	pthread_mutex_lock(&pipeline.mutex);
+	locked = true;
+	try
+	{
+		while (true)
+		{
+			/* entrega, na ordem das requisições, o que já foi processado */
+			it = pipeline.done.begin();
+			if (it != pipeline.done.end() && it->first == nextWrite)
+			{
+				current = it->second;
+				pipeline.done.erase(it);
+				pthread_mutex_unlock(&pipeline.mutex);
+				locked = false;
+				clock_gettime(CLOCK_MONOTONIC, &begin);
+				sink.write(current->index, current->request, current->status, current->certificate);
+				pipeline.metrics.writeMs += BatchIssuer::getElapsedMs(begin);
+				switch (current->status)
+				{
+					case BatchIssuer::ISSUED:
+						pipeline.metrics.issued++;
+						break;
+					case BatchIssuer::INVALID_REQUEST:
+						pipeline.metrics.invalidRequest++;
+						break;
+					case BatchIssuer::INVALID_SIGNATURE:
+						pipeline.metrics.invalidSignature++;
+						break;
+					case BatchIssuer::REFUSED:
+						pipeline.metrics.refused++;
+						break;
+					default:
+						pipeline.metrics.failed++;
+						break;
+				}
+				delete current->request;
+				delete current;
+				current = NULL;
+				pthread_mutex_lock(&pipeline.mutex);
+				locked = true;
+				nextWrite++;
+				continue;
+			}
+			if (!exhausted && nextIndex - nextWrite < capacity)
+			{
+				pthread_mutex_unlock(&pipeline.mutex);
+				locked = false;
+				current = new Job();
+				current->index = nextIndex;
+				current->request = NULL;
+				current->status = BatchIssuer::FAILED;
+				clock_gettime(CLOCK_MONOTONIC, &begin);
+				exhausted = !source.next(current->encoded);
+				pipeline.metrics.readMs += BatchIssuer::getElapsedMs(begin);
+				pthread_mutex_lock(&pipeline.mutex);
+				locked = true;
+				if (exhausted)
+				{
+					delete current;
+					current = NULL;
+				}
+				else
+				{
+					pipeline.queue.push_back(current);
+					current = NULL;
+					pipeline.metrics.read++;
+					nextIndex++;
+					stalled = false;
+					pthread_cond_signal(&pipeline.pending);
+				}
+				continue;
+			}
+			if (exhausted && nextWrite == nextIndex)
+			{
+				break;
+			}
+			if (!exhausted && !stalled)
+			{
+				/* o limite de requisições em andamento foi atingido; as esperas seguintes, até
+				 * a próxima leitura, são o mesmo bloqueio */
+				pipeline.metrics.stalls++;
+				stalled = true;
+			}
+			pthread_cond_wait(&pipeline.completed, &pipeline.mutex);
+		}
+	}
+	catch (...)
+	{
+		if (!locked)
+		{
+			pthread_mutex_lock(&pipeline.mutex);
+		}
+		while (!pipeline.queue.empty())
+		{
+			delete pipeline.queue.front()->request;
+			delete pipeline.queue.front();
+			pipeline.queue.pop_front();
+		}
+		pipeline.finished = true;
+		pthread_cond_broadcast(&pipeline.pending);
+		pthread_mutex_unlock(&pipeline.mutex);
+		for (i = 0; i < workers.size(); i++)
+		{
+			pthread_join(workers[i], NULL);
+		}
+		if (current != NULL)
+		{
+			delete current->request;
+			delete current;
+		}
+		BatchIssuer::release(pipeline);
+		throw;
+	}
+	pipeline.finished = true;
+	pthread_cond_broadcast(&pipeline.pending);
+	pthread_mutex_unlock(&pipeline.mutex);
+	for (i = 0; i < workers.size(); i++)
+	{
+		pthread_join(workers[i], NULL);
+	}
+
+	BatchIssuer::release(pipeline);
+	pipeline.metrics.totalMs = BatchIssuer::getElapsedMs(total);
+	return pipeline.metrics;
+}
+
+void *BatchIssuer::run(void *arg)
+{
+	Pipeline *pipeline = (Pipeline *) arg;
+	EVP_MD_CTX *context;
+	Metrics metrics;
+	Job *job;
+
+	memset(&metrics, 0, sizeof(metrics));
+	pthread_mutex_lock(&pipeline->mutex);
+	context = pipeline->contexts[pipeline->nextContext++];
+	while (true)
+	{
+		while (pipeline->queue.empty() && !pipeline->finished)
+		{
+			pthread_cond_wait(&pipeline->pending, &pipeline->mutex);
+		}
+		if (pipeline->queue.empty())
+		{
+			break;
+		}
+		job = pipeline->queue.front();
+		pipeline->queue.pop_front();
+		pthread_mutex_unlock(&pipeline->mutex);
+
+		try
+		{
+			pipeline->issuer->process(job, context, metrics);
+		}
+		catch (...)
+		{
+			/* process() reports its own failures; this only covers the issuance fields themselves */
+			job->status = BatchIssuer::FAILED;
+		}
+
+		pthread_mutex_lock(&pipeline->mutex);
+		pipeline->done[job->index] = job;
+		pthread_cond_signal(&pipeline->completed);
+	}
+	pipeline->metrics.decodeMs += metrics.decodeMs;
+	pipeline->metrics.verifyMs += metrics.verifyMs;
+	pipeline->metrics.policyMs += metrics.policyMs;
+	pipeline->metrics.signMs += metrics.signMs;
+	pthread_mutex_unlock(&pipeline->mutex);
+	return NULL;
+}
+
+void BatchIssuer::process(Job *job, EVP_MD_CTX *context, Metrics &metrics)
+{
+	struct timespec begin;
+	Issuance issuance;
+	EVP_PKEY *publicKey;
+	X509_REQ *req;
+	unsigned int i;
+	bool valid;
+
+	/* nothing may escape: the exception would end the worker thread and the whole process */
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	try
+	{
+		if (!job->encoded.empty() && job->encoded[0] == 0x30)
+		{
+			ByteArray der((const unsigned char *) job->encoded.data(), job->encoded.size());
+			job->request = new CertificateRequest(der);
+		}
+		else
+		{
+			job->request = new CertificateRequest(job->encoded);
+		}
+	}
+	catch (EncodeException &e)
+	{
+		job->status = BatchIssuer::INVALID_REQUEST;
+	}
+	catch (...)
+	{
+		job->status = BatchIssuer::FAILED;
+	}
+	metrics.decodeMs += BatchIssuer::getElapsedMs(begin);
+	job->encoded.clear();
+	if (job->request == NULL)
+	{
+		ERR_clear_error();
+		return;
+	}
+
+	try
+	{
+		clock_gettime(CLOCK_MONOTONIC, &begin);
+		req = job->request->getX509Req();
+		publicKey = (req != NULL) ? X509_REQ_get0_pubkey(req) : NULL;
+		valid = (publicKey != NULL && X509_REQ_verify(req, publicKey) == 1);
+		metrics.verifyMs += BatchIssuer::getElapsedMs(begin);
+		if (!valid)
+		{
+			job->status = BatchIssuer::INVALID_SIGNATURE;
+		}
+		else
+		{
+			clock_gettime(CLOCK_MONOTONIC, &begin);
+			valid = this->policy.apply(job->index, *job->request, issuance);
+			metrics.policyMs += BatchIssuer::getElapsedMs(begin);
+			if (!valid)
+			{
+				job->status = BatchIssuer::REFUSED;
+			}
+			else
+			{
+				clock_gettime(CLOCK_MONOTONIC, &begin);
+				ByteArray der = this->issuanceTemplate.issueDerEncoded(issuance.serialNumber, *job->request,
+						issuance.notBefore, issuance.notAfter, issuance.extensions, context);
+				job->certificate.assign((const char *) der.getDataPointer(), der.size());
+				if (this->format == BatchIssuer::PEM)
+				{
+					job->certificate = BatchIssuer::toPem(job->certificate);
+				}
+				metrics.signMs += BatchIssuer::getElapsedMs(begin);
+				job->status = BatchIssuer::ISSUED;
+			}
+		}
+	}
+	catch (...)
+	{
+		job->status = BatchIssuer::FAILED;
+		job->certificate.clear();
+	}
+	/* não deixa erros da verificação ou da assinatura na fila da thread */
+	if (job->status != BatchIssuer::ISSUED)
+	{
+		ERR_clear_error();
+	}
+	for (i = 0; i < issuance.extensions.size(); i++)
+	{
+		delete issuance.extensions[i];
+	}
+}
+
+std::string BatchIssuer::toPem(const std::string &der)
+{
+	unsigned char line[PEM_LINE_BYTES * 4 / 3 + 1];
+	std::string ret("-----BEGIN CERTIFICATE-----\n");
+	unsigned long offset, length;
+	int encoded;
+
+	for (offset = 0; offset < der.size(); offset += length)
+	{
+		length = (der.size() - offset < PEM_LINE_BYTES) ? der.size() - offset : PEM_LINE_BYTES;
+		encoded = EVP_EncodeBlock(line, (const unsigned char *) der.data() + offset, length);
+		ret.append((const char *) line, encoded);
+		ret += '\n';
+	}
+	ret += "-----END CERTIFICATE-----\n";
+	return ret;
+}
+
+double BatchIssuer::getElapsedMs(const struct timespec &begin)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - begin.tv_sec) * 1000.0 + (now.tv_nsec - begin.tv_nsec) / 1000000.0;
+}
+
+void BatchIssuer::release(Pipeline &pipeline)
+{
+	std::map<unsigned long, Job *>::iterator it;
+	unsigned int i;
+
+	for (it = pipeline.done.begin(); it != pipeline.done.end(); it++)
+	{
+		delete it->second->request;
+		delete it->second;
+	}
+	pipeline.done.clear();
+	for (i = 0; i < pipeline.contexts.size(); i++)
+	{
+		EVP_MD_CTX_free(pipeline.contexts[i]);
+	}
+	pipeline.contexts.clear();
+	pthread_cond_destroy(&pipeline.completed);
+	pthread_cond_destroy(&pipeline.pending);
+	pthread_mutex_destroy(&pipeline.mutex);
+}
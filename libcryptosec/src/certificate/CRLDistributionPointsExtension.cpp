@@ -106,11 +106,37 @@ std::vector<DistributionPoint> CRLDistributionPointsExtension::getDistributionPo
 	return this->distributionPoints;
 }
 
+void CRLDistributionPointsExtension::encodeValue(DerWriter &writer)
+{
+	writer.begin(DerWriter::SEQUENCE);
+	for (unsigned int i = 0; i < this->distributionPoints.size(); i++)
+	{
+		this->distributionPoints[i].encode(writer);
+	}
+	writer.end();
+}
+
+void CRLDistributionPointsExtension::writeValue(DocumentWriter &writer)
+{
+	writer.beginList("distributionPoints");
+	for (unsigned int i = 0; i < this->distributionPoints.size(); i++)
+	{
+		this->distributionPoints[i].write(writer);
+	}
+	writer.end();
+}
+
 X509_EXTENSION* CRLDistributionPointsExtension::getX509Extension()
 {
 	X509_EXTENSION *ret;
 	CRL_DIST_POINTS *distPoints;
 	unsigned int i;
+	ret = this->encodeX509Extension(NID_crl_distribution_points);
+	if (ret != NULL)
+	{
+		return ret;
+	}
+	/* values the writer does not handle are encoded by OpenSSL */
 	distPoints = CRL_DIST_POINTS_new();
 	for (i=0;i<this->distributionPoints.size();i++)
 	{
@@ -101,3 +101,8 @@ X509_EXTENSION* CRLNumberExtension::getX509Extension()
 	ASN1_INTEGER_free(serialAsn1);
 	return ret;
 }
+
+void CRLNumberExtension::writeValue(DocumentWriter &writer)
+{
+	writer.write("crlNumber", (long) this->serial);
+}
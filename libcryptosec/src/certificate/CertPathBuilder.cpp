@@ -0,0 +1,344 @@
+#include <libcryptosec/certificate/CertPathBuilder.h>
+
+#include <queue>
+
+CertPathBuilder::CertPathBuilder(std::vector<Certificate>& pool, std::vector<Certificate>& trustedChain, DateTime when)
+	: trustedStore(NULL), when(when), maxDepth(10), maxExpansions(1000)
+{
+	X509 *cert;
+
+	for (unsigned int i = 0; i < pool.size(); i++)
+	{
+		cert = pool[i].getX509();
+		X509_up_ref(cert);
+		this->pool.push_back(cert);
+		this->index(cert, this->poolByKeyIdentifier, this->poolBySubject);
+	}
+	for (unsigned int i = 0; i < trustedChain.size(); i++)
+	{
+		cert = trustedChain[i].getX509();
+		X509_up_ref(cert);
+		this->anchors.push_back(cert);
+		this->index(cert, this->anchorsByKeyIdentifier, this->anchorsBySubject);
+	}
+	this->cost.expansions = 0;
+	this->cost.candidates = 0;
+	this->cost.pruned = 0;
+	this->cost.signatureChecks = 0;
+}
+
+CertPathBuilder::CertPathBuilder(std::vector<Certificate>& pool, CertificateStore& trustedStore, DateTime when)
+	: trustedStore(&trustedStore), when(when), maxDepth(10), maxExpansions(1000)
+{
+	X509 *cert;
+
+	for (unsigned int i = 0; i < pool.size(); i++)
+	{
+		cert = pool[i].getX509();
+		X509_up_ref(cert);
+		this->pool.push_back(cert);
+		this->index(cert, this->poolByKeyIdentifier, this->poolBySubject);
+	}
+	this->cost.expansions = 0;
+	this->cost.candidates = 0;
+	this->cost.pruned = 0;
+	this->cost.signatureChecks = 0;
+}
+
+CertPathBuilder::~CertPathBuilder()
+{
+	for (unsigned int i = 0; i < this->pool.size(); i++)
+	{
+		X509_free(this->pool[i]);
+	}
+	for (unsigned int i = 0; i < this->anchors.size(); i++)
+	{
+		X509_free(this->anchors[i]);
+	}
+}
+
+void CertPathBuilder::setMaxDepth(unsigned int maxDepth)
+{
+	this->maxDepth = maxDepth;
+}
+
+void CertPathBuilder::setMaxExpansions(unsigned int maxExpansions)
+{
+	this->maxExpansions = maxExpansions;
+}
+
+void CertPathBuilder::setTime(DateTime when)
+{
+	this->when = when;
+}
+
+CertPathBuilder::Cost CertPathBuilder::getCost() const
+{
+	return this->cost;
+}
+
+bool CertPathBuilder::build(Certificate& certificate, std::vector<Certificate>& path)
+{
+	std::priority_queue<Node *, std::vector<Node *>, NodeOrder> queue;
+	std::vector<Node *> nodes;
+	std::vector<X509 *> storeIssuers, found;
+	STACK_OF(X509) *issuers = NULL;
+	const ASN1_OCTET_STRING *keyIdentifier, *subjectKeyIdentifier;
+	const Node *best = NULL;
+	Node *node, *child;
+	unsigned int anchorCount;
+	X509 *top, *candidate;
+	const ASN1_TIME *notAfter;
+
+	this->cost.expansions = 0;
+	this->cost.candidates = 0;
+	this->cost.pruned = 0;
+	this->cost.signatureChecks = 0;
+	this->signatures.clear();
+	path.clear();
+
+	/* the nodes and the issuer references are owned here, so anything thrown during the search releases them */
+	try
+	{
+		node = new Node();
+		nodes.push_back(node);
+		node->path.push_back(certificate.getX509());
+		node->cost = 0;
+		node->notAfter = X509_get0_notAfter(certificate.getX509());
+		node->complete = this->isTrusted(certificate.getX509());
+		queue.push(node);
+
+		while (!queue.empty())
+		{
+			node = queue.top();
+			queue.pop();
+			/* costs only grow along a path, so the first complete path taken from the queue is the best one */
+			if (node->complete)
+			{
+				best = node;
+				break;
+			}
+			if (this->cost.expansions >= this->maxExpansions)
+			{
+				break;
+			}
+			this->cost.expansions++;
+
+			top = node->path.back();
+			found.clear();
+			if (this->trustedStore != NULL)
+			{
+				issuers = this->trustedStore->getX509Issuers(top);
+				if (issuers != NULL)
+				{
+					/* reserved first, so that no reference is left between the stack and the vector */
+					storeIssuers.reserve(storeIssuers.size() + sk_X509_num(issuers));
+				}
+				while (issuers != NULL && sk_X509_num(issuers) > 0)
+				{
+					/* the references are kept until the search ends */
+					storeIssuers.push_back(sk_X509_shift(issuers));
+					found.push_back(storeIssuers.back());
+				}
+				sk_X509_free(issuers);
+				issuers = NULL;
+			}
+			else
+			{
+				this->findCandidates(top, this->anchorsByKeyIdentifier, this->anchorsBySubject, found);
+			}
+			anchorCount = found.size();
+			this->findCandidates(top, this->poolByKeyIdentifier, this->poolBySubject, found);
+
+			keyIdentifier = X509_get0_authority_key_id(top);
+			for (unsigned int i = 0; i < found.size(); i++)
+			{
+				candidate = found[i];
+				this->cost.candidates++;
+				if (!this->accept(node, candidate) || !this->checkSignature(top, candidate))
+				{
+					this->cost.pruned++;
+					continue;
+				}
+				child = new Node();
+				nodes.push_back(child);
+				child->path = node->path;
+				child->path.push_back(candidate);
+				subjectKeyIdentifier = X509_get0_subject_key_id(candidate);
+				child->cost = node->cost + ((keyIdentifier != NULL && subjectKeyIdentifier != NULL
+						&& ASN1_OCTET_STRING_cmp(keyIdentifier, subjectKeyIdentifier) == 0) ? 1 : 2);
+				notAfter = X509_get0_notAfter(candidate);
+				child->notAfter = (ASN1_TIME_compare(notAfter, node->notAfter) < 0) ? notAfter : node->notAfter;
+				child->complete = (i < anchorCount);
+				queue.push(child);
+			}
+		}
+
+		if (best != NULL)
+		{
+			path.reserve(best->path.size());
+			for (unsigned int i = 0; i < best->path.size(); i++)
+			{
+				/* the temporary takes this reference and releases it once push_back has copied it */
+				X509_up_ref(best->path[i]);
+				path.push_back(Certificate(best->path[i]));
+			}
+		}
+	}
+	catch (...)
+	{
+		path.clear();
+		sk_X509_pop_free(issuers, X509_free);
+		CertPathBuilder::release(nodes, storeIssuers);
+		throw;
+	}
+	CertPathBuilder::release(nodes, storeIssuers);
+	return (best != NULL);
+}
+
+void CertPathBuilder::release(std::vector<Node *> &nodes, std::vector<X509 *> &storeIssuers)
+{
+	for (unsigned int i = 0; i < nodes.size(); i++)
+	{
+		delete nodes[i];
+	}
+	nodes.clear();
+	for (unsigned int i = 0; i < storeIssuers.size(); i++)
+	{
+		X509_free(storeIssuers[i]);
+	}
+	storeIssuers.clear();
+}
+
+bool CertPathBuilder::NodeOrder::operator()(const Node *a, const Node *b) const
+{
+	/* std::priority_queue keeps the greatest element on top */
+	if (a->cost != b->cost)
+	{
+		return a->cost > b->cost;
+	}
+	return ASN1_TIME_compare(a->notAfter, b->notAfter) < 0;
+}
+
+void CertPathBuilder::index(X509 *cert, std::multimap<std::string, X509 *> &byKeyIdentifier, std::multimap<unsigned long, X509 *> &bySubject)
+{
+	const ASN1_OCTET_STRING *keyIdentifier;
+
+	keyIdentifier = X509_get0_subject_key_id(cert);
+	if (keyIdentifier != NULL)
+	{
+		byKeyIdentifier.insert(std::make_pair(CertPathBuilder::getKeyIdentifier(keyIdentifier), cert));
+	}
+	bySubject.insert(std::make_pair(X509_NAME_hash(X509_get_subject_name(cert)), cert));
+}
+
+void CertPathBuilder::findCandidates(X509 *cert, const std::multimap<std::string, X509 *> &byKeyIdentifier,
+		const std::multimap<unsigned long, X509 *> &bySubject, std::vector<X509 *> &found)
+{
+	std::pair<std::multimap<std::string, X509 *>::const_iterator, std::multimap<std::string, X509 *>::const_iterator> byKey;
+	std::pair<std::multimap<unsigned long, X509 *>::const_iterator, std::multimap<unsigned long, X509 *>::const_iterator> byName;
+	const ASN1_OCTET_STRING *keyIdentifier;
+	unsigned int count = found.size();
+
+	keyIdentifier = X509_get0_authority_key_id(cert);
+	if (keyIdentifier != NULL)
+	{
+		byKey = byKeyIdentifier.equal_range(CertPathBuilder::getKeyIdentifier(keyIdentifier));
+		for (; byKey.first != byKey.second; byKey.first++)
+		{
+			found.push_back(byKey.first->second);
+		}
+	}
+	/* without an Authority Key Identifier, or when no issuer has the identifier, the name is used */
+	if (found.size() == count)
+	{
+		byName = bySubject.equal_range(X509_NAME_hash(X509_get_issuer_name(cert)));
+		for (; byName.first != byName.second; byName.first++)
+		{
+			found.push_back(byName.first->second);
+		}
+	}
+}
+
+bool CertPathBuilder::isTrusted(X509 *cert)
+{
+	std::pair<std::multimap<unsigned long, X509 *>::const_iterator, std::multimap<unsigned long, X509 *>::const_iterator> byName;
+
+	if (this->trustedStore != NULL)
+	{
+		X509_up_ref(cert);
+		Certificate wrapper(cert);
+		return this->trustedStore->contains(wrapper);
+	}
+	byName = this->anchorsBySubject.equal_range(X509_NAME_hash(X509_get_subject_name(cert)));
+	for (; byName.first != byName.second; byName.first++)
+	{
+		if (X509_cmp(byName.first->second, cert) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CertPathBuilder::accept(const Node *node, X509 *issuer)
+{
+	time_t now = this->when.getDateTime();
+	long pathLength;
+
+	if (node->path.size() >= this->maxDepth)
+	{
+		return false;
+	}
+	for (unsigned int i = 0; i < node->path.size(); i++)
+	{
+		if (node->path[i] == issuer || X509_cmp(node->path[i], issuer) == 0)
+		{
+			return false;
+		}
+	}
+	if (X509_cmp_time(X509_get0_notBefore(issuer), &now) > 0 || X509_cmp_time(X509_get0_notAfter(issuer), &now) < 0)
+	{
+		return false;
+	}
+	if (X509_check_ca(issuer) == 0)
+	{
+		return false;
+	}
+	if ((X509_get_extension_flags(issuer) & EXFLAG_KUSAGE) && !(X509_get_key_usage(issuer) & KU_KEY_CERT_SIGN))
+	{
+		return false;
+	}
+	/* the intermediates below the issuer are every certificate of the path but the first */
+	pathLength = X509_get_pathlen(issuer);
+	if (pathLength >= 0 && (long) node->path.size() - 1 > pathLength)
+	{
+		return false;
+	}
+	return X509_check_issued(issuer, node->path.back()) == X509_V_OK;
+}
+
+bool CertPathBuilder::checkSignature(X509 *cert, X509 *issuer)
+{
+	std::map<std::pair<X509 *, X509 *>, bool>::iterator it;
+	std::pair<X509 *, X509 *> key(cert, issuer);
+	EVP_PKEY *pkey;
+	bool ret;
+
+	it = this->signatures.find(key);
+	if (it != this->signatures.end())
+	{
+		return it->second;
+	}
+	this->cost.signatureChecks++;
+	/* the key was decoded when the issuer was parsed */
+	pkey = X509_get0_pubkey(issuer);
+	ret = (pkey != NULL && X509_verify(cert, pkey) > 0);
+	this->signatures[key] = ret;
+	return ret;
+}
+
+std::string CertPathBuilder::getKeyIdentifier(const ASN1_OCTET_STRING *keyIdentifier)
+{
+	return std::string((const char *) ASN1_STRING_get0_data(keyIdentifier), ASN1_STRING_length(keyIdentifier));
+}
@@ -1,15 +1,33 @@
 #include <libcryptosec/certificate/CertPathValidator.h>
 
-/*instancia variavel estatica*/
-vector<CertPathValidatorResult> CertPathValidator::results;
+#include <pthread.h>
+#include <unistd.h>
+#include <sstream>
 
-/*CertPathValidator::CertPathValidator()
+/* minimum number of certificates worth a thread of its own in verifyBatch */
+#define CERTIFICATES_PER_THREAD 16
+/* certificates taken at a time by each thread of verifyBatch */
+#define BATCH_CHUNK 8
+
+/*instancia variaveis estaticas*/
+int CertPathValidator::storeIndex = -1;
+int CertPathValidator::resultsIndex = -1;
+int CertPathValidator::memoIndex = -1;
+CRYPTO_ONCE CertPathValidator::indexesOnce = CRYPTO_ONCE_STATIC_INIT;
+
+CertPathValidator::CertPathValidator(const CertPathValidator& validator)
+	: flags(validator.flags), when(validator.when), untrusted(validator.untrusted),
+	  trustedChain(&validator.trustedChain == &validator.noTrustedChain ? noTrustedChain : validator.trustedChain),
+	  untrustedChain(validator.untrustedChain), crls(validator.crls), results(validator.results),
+	  trustedStore(validator.trustedStore), cache(validator.cache), store(NULL), lock(CRYPTO_THREAD_lock_new())
 {
-}*/
+}
 
-/*CertPathValidator::~CertPathValidator()
+CertPathValidator::~CertPathValidator()
 {
-}*/
+	X509_STORE_free(this->store);
+	CRYPTO_THREAD_lock_free(this->lock);
+}
 
 void CertPathValidator::setTime(DateTime when)
 {
@@ -29,16 +47,31 @@ void CertPathValidator::setUnstrustedChain(vector<Certificate>& certs)
 void CertPathValidator::setTrustedChain(vector<Certificate>& certs)
 {
 	this->trustedChain = certs;
+	this->resetStore();
+}
+
+void CertPathValidator::setTrustedStore(CertificateStore& store)
+{
+	this->trustedStore = &store;
+	this->resetStore();
 }
 
 void CertPathValidator::setCrls(vector<CertificateRevocationList>& crls)
 {
 	this->crls = crls;
+	this->resetStore();
 }
 
 void CertPathValidator::setVerificationFlags(ValidationFlags flag)
 {
 	this->flags.push_back(flag);
+	this->resetStore();
+}
+
+void CertPathValidator::setCache(CertPathValidatorCache& cache)
+{
+	this->cache = &cache;
+	this->resetStore();
 }
 
 /*void CertPathValidator::setResult(CertPathValidatorResult** result)
@@ -46,22 +79,160 @@ void CertPathValidator::setVerificationFlags(ValidationFlags flag)
 	this->result = result;
 }*/
 
+void CertPathValidator::resetStore()
+{
+	CRYPTO_THREAD_write_lock(this->lock);
+	X509_STORE_free(this->store);
+	this->store = NULL;
+	this->configuration.clear();
+	CRYPTO_THREAD_unlock(this->lock);
+}
+
+X509_STORE* CertPathValidator::getStore(std::string &configuration)
+{
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	unsigned int digestLength;
+	EVP_MD_CTX *mdCtx;
+	X509_STORE *ret;
+	int flag;
+
+	CRYPTO_THREAD_read_lock(this->lock);
+	ret = this->store;
+	if (ret != NULL)
+	{
+		X509_STORE_up_ref(ret);
+		configuration = this->configuration;
+	}
+	CRYPTO_THREAD_unlock(this->lock);
+	if (ret != NULL)
+	{
+		return ret;
+	}
+
+	CRYPTO_THREAD_write_lock(this->lock);
+	/* outra thread pode ter montado o store enquanto a trava estava livre */
+	if (this->store == NULL)
+	{
+		OpenSSL_add_all_algorithms();
+		ERR_load_crypto_strings();
+
+		/*instancia store de certificados
+		 * ignorou-se a possibilidade de falta de memoria
+		 */
+		this->store = X509_STORE_new();
+
+		//define funcao de callback
+		X509_STORE_set_verify_cb_func(this->store, CertPathValidator::callback);
+
+		//define repositorio de certificados confiaveis, consultado pelos indices
+		if (this->trustedStore != NULL)
+		{
+			X509_STORE_set_ex_data(this->store, CertPathValidator::storeIndex, this->trustedStore);
+			X509_STORE_set_get_issuer(this->store, CertPathValidator::getIssuer);
+			X509_STORE_set_lookup_certs(this->store, CertPathValidator::lookupCerts);
+		}
+
+		//define certificados confiaveis
+		for(unsigned int i = 0 ;  i < this->trustedChain.size(); i++)
+		{
+			X509_STORE_add_cert(this->store, trustedChain.at(i).getX509());
+		}
+
+		//define flags
+		for(unsigned int i = 0 ; i < this->flags.size() ; i++)
+		{
+			switch(this->flags.at(i))
+			{
+				case CRL_CHECK:
+					X509_STORE_set_flags(this->store, X509_V_FLAG_CRL_CHECK);
+					break;
+
+				case CRL_CHECK_ALL:
+					/*precisa por CRL_CHECK tambem, caso contrario o openssl nao verifica CRL*/
+					X509_STORE_set_flags(this->store, X509_V_FLAG_CRL_CHECK);
+					X509_STORE_set_flags(this->store, X509_V_FLAG_CRL_CHECK_ALL);
+					break;
+			}
+		}
+
+		/*adiciona crls ao store*/
+		for(unsigned int i = 0 ; i < this->crls.size() ; i++)
+		{
+			X509_STORE_add_crl(this->store, this->crls.at(i).getX509Crl());
+		}
+
+		/*resume a configuracao para as chaves do cache; o repositorio entra na chave a cada validacao*/
+		if (this->cache != NULL)
+		{
+			mdCtx = EVP_MD_CTX_new();
+			EVP_DigestInit_ex(mdCtx, EVP_sha256(), NULL);
+			for(unsigned int i = 0 ; i < this->trustedChain.size() ; i++)
+			{
+				X509_digest(this->trustedChain.at(i).getX509(), EVP_sha256(), digest, &digestLength);
+				EVP_DigestUpdate(mdCtx, digest, digestLength);
+			}
+			for(unsigned int i = 0 ; i < this->crls.size() ; i++)
+			{
+				X509_CRL_digest(this->crls.at(i).getX509Crl(), EVP_sha256(), digest, &digestLength);
+				EVP_DigestUpdate(mdCtx, digest, digestLength);
+			}
+			for(unsigned int i = 0 ; i < this->flags.size() ; i++)
+			{
+				flag = this->flags.at(i);
+				EVP_DigestUpdate(mdCtx, &flag, sizeof(flag));
+			}
+			EVP_DigestFinal_ex(mdCtx, digest, &digestLength);
+			EVP_MD_CTX_free(mdCtx);
+			this->configuration.assign((const char *) digest, digestLength);
+		}
+	}
+	ret = this->store;
+	configuration = this->configuration;
+	X509_STORE_up_ref(ret);
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
 bool CertPathValidator::verify()
 {
-	//BIO *p7bio;
+	return this->verify(this->untrusted, this->untrustedChain, this->results);
+}
+
+bool CertPathValidator::verify(Certificate& certificate, vector<CertPathValidatorResult>& results)
+{
+	return this->verify(certificate, this->untrustedChain, results);
+}
+
+bool CertPathValidator::verify(Certificate& certificate, vector<Certificate>& untrustedChain, vector<CertPathValidatorResult>& results)
+{
+	return this->verify(certificate, untrustedChain, results, NULL);
+}
+
+bool CertPathValidator::verify(Certificate& certificate, vector<Certificate>& untrustedChain, vector<CertPathValidatorResult>& results, SignatureMemo *memo)
+{
 	bool ret;
 	int rc;	
-	X509_STORE *store = NULL;
+	X509_STORE *store;
 	X509_STORE_CTX *cert_ctx;
 	STACK_OF(X509) *certs = NULL;
+	std::string configuration, key;
+	time_t notBefore, notAfter;
 
-	OpenSSL_add_all_algorithms();
-	ERR_load_crypto_strings();
-	
-	/*instancia store de certificados
-	 * ignorou-se a possibilidade de falta de memoria
-	 */
-	store = X509_STORE_new();
+	CRYPTO_THREAD_run_once(&CertPathValidator::indexesOnce, CertPathValidator::initIndexes);
+
+	/*configuracao de confianca compartilhada; a referencia obtida eh liberada ao final*/
+	store = this->getStore(configuration);
+
+	/*consulta o cache de resultados*/
+	if (this->cache != NULL)
+	{
+		key = this->getCacheKey(certificate, untrustedChain, configuration);
+		if (this->cache->find(key, this->when.getDateTime(), ret, results))
+		{
+			X509_STORE_free(store);
+			return ret;
+		}
+	}
 	
 	/*instancia contexto
 	 * ignorou-se a possibilidade de falta de memoria
@@ -74,51 +245,19 @@ bool CertPathValidator::verify()
 	certs = sk_X509_new_null();
 	
 	//popula pilha
-	for(unsigned int k = 0 ; k < this->untrustedChain.size() ; k++)
+	for(unsigned int k = 0 ; k < untrustedChain.size() ; k++)
 	{
 		/* ignorou-se o retorno do push na pilha. 
 		 * Retorno de erro (0) ocorreria no caso de falta de memoria. 
 		 * Ver funcao sk_insert do openssl
 		 */
-		sk_X509_push(certs, this->untrustedChain.at(k).getX509());
-	}
-	
-	//define funcao de callback
-	X509_STORE_set_verify_cb_func(store, CertPathValidator::callback);
-	
-	//define certificados confiaveis
-	for(unsigned int i = 0 ;  i < this->trustedChain.size(); i++)
-	{
-		X509_STORE_add_cert(store, trustedChain.at(i).getX509());
-	}			
-	
-	//define flags
-	for(unsigned int i = 0 ; i < this->flags.size() ; i++)
-	{
-		switch(this->flags.at(i))
-		{
-			case CRL_CHECK:
-				X509_STORE_set_flags(store, X509_V_FLAG_CRL_CHECK);
-				break;
-			
-			case CRL_CHECK_ALL:
-				/*precisa por CRL_CHECK tambem, caso contrario o openssl nao verifica CRL*/
-				X509_STORE_set_flags(store, X509_V_FLAG_CRL_CHECK);
-				X509_STORE_set_flags(store, X509_V_FLAG_CRL_CHECK_ALL);
-				break;
-		}
-	}
-	
-	/*adiciona crls ao store*/
-	for(unsigned int i = 0 ; i < this->crls.size() ; i++)
-	{
-		X509_STORE_add_crl(store, this->crls.at(i).getX509Crl());
+		sk_X509_push(certs, untrustedChain.at(k).getX509());
 	}
 	
 	/* inicializa contexto
 	 * ignorou-se a possibilidade de falta de memoria
 	 */
-	X509_STORE_CTX_init(cert_ctx, store, this->untrusted.getX509(), certs);
+	X509_STORE_CTX_init(cert_ctx, store, certificate.getX509(), certs);
 	
 	
 	/* define a data para verificar os certificados da cadeia
@@ -129,7 +268,16 @@ bool CertPathValidator::verify()
 	X509_STORE_CTX_set_time(cert_ctx, 0 ,this->when.getDateTime());
 	
 	/*Garante que não há informações de validações prévias*/
-	CertPathValidator::results.clear();
+	results.clear();
+	/*os resultados desta validacao sao preenchidos pela funcao de callback*/
+	X509_STORE_CTX_set_ex_data(cert_ctx, CertPathValidator::resultsIndex, &results);
+
+	/*em um lote, as assinaturas ja verificadas dos certificados intermediarios sao reaproveitadas*/
+	if (memo != NULL)
+	{
+		X509_STORE_CTX_set_ex_data(cert_ctx, CertPathValidator::memoIndex, memo);
+		X509_STORE_CTX_set_verify(cert_ctx, CertPathValidator::verifySignatures);
+	}
 	
 	/*verifica certificado*/
 	rc = X509_verify_cert(cert_ctx);
@@ -141,26 +289,365 @@ bool CertPathValidator::verify()
 	{
 		//this case can be a error 
 		ret = false;
-		
-		//código antigo, que não previa warnings
-/*		if(this->result)
-		{
-			faz copia do objeto
-			*this->result = new CertPathValidatorResult(CertPathValidator::cpvr);
-		}*/
+	}
+
+	/*armazena o resultado no cache, valido enquanto o caminho e as LCRs forem validos*/
+	if (this->cache != NULL)
+	{
+		this->getValidityInterval(cert_ctx, notBefore, notAfter);
+		this->cache->insert(key, notBefore, notAfter, ret, results);
 	}
 	
 	/*desaloca estruturas*/
 	sk_X509_free(certs);
-	X509_STORE_free(store);
 	X509_STORE_CTX_free(cert_ctx);
+	X509_STORE_free(store);
 	return ret;
 
 }
 
+vector<bool> CertPathValidator::verifyBatch(vector<Certificate>& certificates, vector<vector<CertPathValidatorResult> >& results, unsigned int threads)
+{
+	std::map<std::pair<X509 *, X509 *>, bool>::iterator it;
+	std::vector<pthread_t> workers;
+	vector<char> valid(certificates.size(), 0);
+	SignatureMemo memo;
+	BatchTask task;
+	unsigned int count, i;
+	pthread_t worker;
+	long cpus;
+
+	results.assign(certificates.size(), vector<CertPathValidatorResult>());
+	if (certificates.empty())
+	{
+		return vector<bool>();
+	}
+
+	count = threads;
+	if (count == 0)
+	{
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		count = (cpus > 0) ? cpus : 1;
+	}
+	if (count > certificates.size() / CERTIFICATES_PER_THREAD)
+	{
+		count = certificates.size() / CERTIFICATES_PER_THREAD;
+	}
+	if (count == 0)
+	{
+		count = 1;
+	}
+
+	memo.lock = CRYPTO_THREAD_lock_new();
+	task.validator = this;
+	task.certificates = &certificates;
+	task.results = &results;
+	task.valid = &valid;
+	task.memo = &memo;
+	task.lock = CRYPTO_THREAD_lock_new();
+	task.next = 0;
+
+	/* each thread takes the next chunk of certificates, so a slow chain does not hold the others back */
+	for (i = 1; i < count; i++)
+	{
+		if (pthread_create(&worker, NULL, CertPathValidator::runBatch, &task) == 0)
+		{
+			workers.push_back(worker);
+		}
+	}
+	CertPathValidator::runBatch(&task);
+	for (i = 0; i < workers.size(); i++)
+	{
+		pthread_join(workers[i], NULL);
+	}
+
+	for (it = memo.verified.begin(); it != memo.verified.end(); it++)
+	{
+		X509_free(it->first.first);
+		X509_free(it->first.second);
+	}
+	CRYPTO_THREAD_lock_free(memo.lock);
+	CRYPTO_THREAD_lock_free(task.lock);
+	return vector<bool>(valid.begin(), valid.end());
+}
+
+void *CertPathValidator::runBatch(void *arg)
+{
+	BatchTask *task = (BatchTask *) arg;
+	unsigned int begin, end, i, total;
+
+	total = task->certificates->size();
+	while (true)
+	{
+		CRYPTO_THREAD_write_lock(task->lock);
+		begin = task->next;
+		end = (begin + BATCH_CHUNK < total) ? begin + BATCH_CHUNK : total;
+		task->next = end;
+		CRYPTO_THREAD_unlock(task->lock);
+		if (begin >= total)
+		{
+			break;
+		}
+		for (i = begin; i < end; i++)
+		{
+			(*task->valid)[i] = task->validator->verify(task->certificates->at(i), task->validator->untrustedChain, task->results->at(i), task->memo);
+		}
+	}
+	return NULL;
+}
+
+int CertPathValidator::verifySignatures(X509_STORE_CTX *ctx)
+{
+	STACK_OF(X509) *chain;
+	unsigned long flags;
+	X509 *xi, *xs;
+	int n;
+
+	chain = X509_STORE_CTX_get0_chain(ctx);
+	flags = X509_VERIFY_PARAM_get_flags(X509_STORE_CTX_get0_param(ctx));
+	n = sk_X509_num(chain) - 1;
+	xi = sk_X509_value(chain, n);
+
+	if (X509_STORE_CTX_get_check_issued(ctx)(ctx, xi, xi))
+	{
+		xs = xi;
+	}
+	else if (flags & X509_V_FLAG_PARTIAL_CHAIN)
+	{
+		/* the top of a partial chain has no issuer to check its signature against */
+		xs = xi;
+		if (!CertPathValidator::checkTime(ctx, xs, n))
+		{
+			return 0;
+		}
+		X509_STORE_CTX_set_error_depth(ctx, n);
+		X509_STORE_CTX_set_current_cert(ctx, xs);
+		if (!X509_STORE_CTX_get_verify_cb(ctx)(1, ctx))
+		{
+			return 0;
+		}
+		if (--n < 0)
+		{
+			return 1;
+		}
+		xi = xs;
+		xs = sk_X509_value(chain, n);
+	}
+	else
+	{
+		if (n <= 0)
+		{
+			return CertPathValidator::reportError(ctx, xi, 0, X509_V_ERR_UNABLE_TO_VERIFY_LEAF_SIGNATURE);
+		}
+		n--;
+		xs = sk_X509_value(chain, n);
+	}
+
+	while (n >= 0)
+	{
+		X509_STORE_CTX_set_error_depth(ctx, n);
+		/* the self-signed trust anchor's signature is only checked when asked for */
+		if (xs != xi || (flags & X509_V_FLAG_CHECK_SS_SIGNATURE))
+		{
+			if (X509_get0_pubkey(xi) == NULL)
+			{
+				if (!CertPathValidator::reportError(ctx, xi, xi != xs ? n + 1 : n, X509_V_ERR_UNABLE_TO_DECODE_ISSUER_PUBLIC_KEY))
+				{
+					return 0;
+				}
+			}
+			else if (!CertPathValidator::checkSignature(ctx, xs, xi, n > 0))
+			{
+				if (!CertPathValidator::reportError(ctx, xs, n, X509_V_ERR_CERT_SIGNATURE_FAILURE))
+				{
+					return 0;
+				}
+			}
+		}
+		if (!CertPathValidator::checkTime(ctx, xs, n))
+		{
+			return 0;
+		}
+		X509_STORE_CTX_set_error_depth(ctx, n);
+		X509_STORE_CTX_set_current_cert(ctx, xs);
+		if (!X509_STORE_CTX_get_verify_cb(ctx)(1, ctx))
+		{
+			return 0;
+		}
+		if (--n >= 0)
+		{
+			xi = xs;
+			xs = sk_X509_value(chain, n);
+		}
+	}
+	return 1;
+}
+
+bool CertPathValidator::checkSignature(X509_STORE_CTX *ctx, X509 *subject, X509 *issuer, bool memoize)
+{
+	std::map<std::pair<X509 *, X509 *>, bool>::iterator it;
+	std::pair<X509 *, X509 *> key(subject, issuer);
+	SignatureMemo *memo;
+	EVP_PKEY *pkey;
+	bool ret;
+
+	memo = (SignatureMemo *) X509_STORE_CTX_get_ex_data(ctx, CertPathValidator::memoIndex);
+	if (memoize && memo != NULL)
+	{
+		CRYPTO_THREAD_read_lock(memo->lock);
+		it = memo->verified.find(key);
+		if (it != memo->verified.end())
+		{
+			ret = it->second;
+			CRYPTO_THREAD_unlock(memo->lock);
+			return ret;
+		}
+		CRYPTO_THREAD_unlock(memo->lock);
+	}
+
+	/* the key was decoded when the issuer was parsed */
+	pkey = X509_get0_pubkey(issuer);
+	ret = (pkey != NULL && X509_verify(subject, pkey) > 0);
+
+	if (memoize && memo != NULL)
+	{
+		CRYPTO_THREAD_write_lock(memo->lock);
+		if (memo->verified.insert(std::make_pair(key, ret)).second)
+		{
+			/* the references keep the addresses from being reused during the batch */
+			X509_up_ref(subject);
+			X509_up_ref(issuer);
+		}
+		CRYPTO_THREAD_unlock(memo->lock);
+	}
+	return ret;
+}
+
+int CertPathValidator::checkTime(X509_STORE_CTX *ctx, X509 *cert, int depth)
+{
+	X509_VERIFY_PARAM *param;
+	time_t now, *when = NULL;
+	int i;
+
+	param = X509_STORE_CTX_get0_param(ctx);
+	if (X509_VERIFY_PARAM_get_flags(param) & X509_V_FLAG_NO_CHECK_TIME)
+	{
+		return 1;
+	}
+	if (X509_VERIFY_PARAM_get_flags(param) & X509_V_FLAG_USE_CHECK_TIME)
+	{
+		now = X509_VERIFY_PARAM_get_time(param);
+		when = &now;
+	}
+
+	i = X509_cmp_time(X509_get0_notBefore(cert), when);
+	if (i == 0 && !CertPathValidator::reportError(ctx, cert, depth, X509_V_ERR_ERROR_IN_CERT_NOT_BEFORE_FIELD))
+	{
+		return 0;
+	}
+	if (i > 0 && !CertPathValidator::reportError(ctx, cert, depth, X509_V_ERR_CERT_NOT_YET_VALID))
+	{
+		return 0;
+	}
+	i = X509_cmp_time(X509_get0_notAfter(cert), when);
+	if (i == 0 && !CertPathValidator::reportError(ctx, cert, depth, X509_V_ERR_ERROR_IN_CERT_NOT_AFTER_FIELD))
+	{
+		return 0;
+	}
+	if (i < 0 && !CertPathValidator::reportError(ctx, cert, depth, X509_V_ERR_CERT_HAS_EXPIRED))
+	{
+		return 0;
+	}
+	return 1;
+}
+
+int CertPathValidator::reportError(X509_STORE_CTX *ctx, X509 *cert, int depth, int error)
+{
+	X509_STORE_CTX_set_error_depth(ctx, depth);
+	X509_STORE_CTX_set_current_cert(ctx, cert);
+	X509_STORE_CTX_set_error(ctx, error);
+	return X509_STORE_CTX_get_verify_cb(ctx)(0, ctx);
+}
+
+std::string CertPathValidator::getCacheKey(Certificate& certificate, vector<Certificate>& untrustedChain, const std::string &configuration)
+{
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	unsigned int digestLength;
+	std::ostringstream stream;
+	std::string ret;
+
+	/*o resumo do certificado vem primeiro, ele distribui as chaves entre as particoes do cache*/
+	X509_digest(certificate.getX509(), EVP_sha256(), digest, &digestLength);
+	ret.append((const char *) digest, digestLength);
+	for(unsigned int i = 0 ; i < untrustedChain.size() ; i++)
+	{
+		X509_digest(untrustedChain.at(i).getX509(), EVP_sha256(), digest, &digestLength);
+		ret.append((const char *) digest, digestLength);
+	}
+	ret.append(configuration);
+	if (this->trustedStore != NULL)
+	{
+		stream << "|" << this->trustedStore->getIdentifier() << "." << this->trustedStore->getGeneration();
+		ret.append(stream.str());
+	}
+	return ret;
+}
+
+void CertPathValidator::getValidityInterval(X509_STORE_CTX *ctx, time_t &notBefore, time_t &notAfter)
+{
+	STACK_OF(X509) *chain;
+	X509_CRL *crl;
+	time_t t;
+	X509 *x;
+
+	notBefore = 0;
+	notAfter = 0;
+	chain = X509_STORE_CTX_get0_chain(ctx);
+	if (chain == NULL || sk_X509_num(chain) == 0)
+	{
+		return;
+	}
+	for (int i = 0; i < sk_X509_num(chain); i++)
+	{
+		x = sk_X509_value(chain, i);
+		t = DateTime((ASN1_TIME *) X509_get0_notBefore(x)).getDateTime();
+		if (i == 0 || t > notBefore)
+		{
+			notBefore = t;
+		}
+		t = DateTime((ASN1_TIME *) X509_get0_notAfter(x)).getDateTime();
+		if (i == 0 || t < notAfter)
+		{
+			notAfter = t;
+		}
+	}
+	/*as LCRs so influenciam o resultado quando ha verificacao de revogacao*/
+	if (this->flags.empty())
+	{
+		return;
+	}
+	for(unsigned int i = 0 ; i < this->crls.size() ; i++)
+	{
+		crl = this->crls.at(i).getX509Crl();
+		t = DateTime((ASN1_TIME *) X509_CRL_get0_lastUpdate(crl)).getDateTime();
+		if (t > notBefore)
+		{
+			notBefore = t;
+		}
+		if (X509_CRL_get0_nextUpdate(crl) != NULL)
+		{
+			t = DateTime((ASN1_TIME *) X509_CRL_get0_nextUpdate(crl)).getDateTime();
+			if (t < notAfter)
+			{
+				notAfter = t;
+			}
+		}
+	}
+}
+
 vector<CertPathValidatorResult> CertPathValidator::getResults()
 {
-	return CertPathValidator::results;
+	return this->results;
 }
 
 bool CertPathValidator::getWarningsStatus()
@@ -175,17 +662,106 @@ bool CertPathValidator::getWarningsStatus()
 	return ret;
 }
 
+void CertPathValidator::initIndexes()
+{
+	CertPathValidator::storeIndex = X509_STORE_get_ex_new_index(0, NULL, NULL, NULL, NULL);
+	CertPathValidator::resultsIndex = X509_STORE_CTX_get_ex_new_index(0, NULL, NULL, NULL, NULL);
+	CertPathValidator::memoIndex = X509_STORE_CTX_get_ex_new_index(0, NULL, NULL, NULL, NULL);
+}
+
+int CertPathValidator::getIssuer(X509 **issuer, X509_STORE_CTX *ctx, X509 *x)
+{
+	X509_STORE_CTX_check_issued_fn checkIssued;
+	CertificateStore *trustedStore;
+	STACK_OF(X509) *candidates;
+	X509_VERIFY_PARAM *param;
+	time_t now, *when = NULL;
+	X509 *candidate;
+
+	*issuer = NULL;
+	trustedStore = (CertificateStore *) X509_STORE_get_ex_data(X509_STORE_CTX_get0_store(ctx), CertPathValidator::storeIndex);
+	candidates = trustedStore->getX509Issuers(x);
+	if (candidates != NULL)
+	{
+		param = X509_STORE_CTX_get0_param(ctx);
+		if (X509_VERIFY_PARAM_get_flags(param) & X509_V_FLAG_USE_CHECK_TIME)
+		{
+			now = X509_VERIFY_PARAM_get_time(param);
+			when = &now;
+		}
+		checkIssued = X509_STORE_CTX_get_check_issued(ctx);
+		/* as in X509_STORE_CTX_get1_issuer, an issuer valid at the validation time is preferred */
+		for (int i = 0; i < sk_X509_num(candidates); i++)
+		{
+			candidate = sk_X509_value(candidates, i);
+			if (!checkIssued(ctx, x, candidate))
+			{
+				continue;
+			}
+			if (X509_cmp_time(X509_get0_notBefore(candidate), when) <= 0
+					&& X509_cmp_time(X509_get0_notAfter(candidate), when) >= 0)
+			{
+				*issuer = candidate;
+				break;
+			}
+			if (*issuer == NULL)
+			{
+				*issuer = candidate;
+			}
+		}
+		if (*issuer != NULL)
+		{
+			X509_up_ref(*issuer);
+		}
+		sk_X509_pop_free(candidates, X509_free);
+	}
+	if (*issuer != NULL)
+	{
+		return 1;
+	}
+	/* falls back to the certificates added with setTrustedChain */
+	return X509_STORE_CTX_get1_issuer(issuer, ctx, x);
+}
+
+STACK_OF(X509)* CertPathValidator::lookupCerts(X509_STORE_CTX *ctx, X509_NAME *name)
+{
+	CertificateStore *trustedStore;
+	STACK_OF(X509) *ret, *found;
+
+	trustedStore = (CertificateStore *) X509_STORE_get_ex_data(X509_STORE_CTX_get0_store(ctx), CertPathValidator::storeIndex);
+	ret = X509_STORE_CTX_get1_certs(ctx, name);
+	found = trustedStore->getX509BySubject(name);
+	if (found == NULL)
+	{
+		return ret;
+	}
+	if (ret == NULL)
+	{
+		return found;
+	}
+	while (sk_X509_num(found) > 0)
+	{
+		sk_X509_push(ret, sk_X509_shift(found));
+	}
+	sk_X509_free(found);
+	return ret;
+}
+
 int CertPathValidator::callback(int ok, X509_STORE_CTX *ctx)
 	{
-	Certificate* cert = NULL;
+	vector<CertPathValidatorResult> *results;
 	CertPathValidatorResult aResult;
+	X509 *current;
 	
 	if (!ok)
 	{
-		cert = new Certificate(X509_STORE_CTX_get_current_cert(ctx));
-		if (cert)
+		current = X509_STORE_CTX_get_current_cert(ctx);
+		if (current)
 		{
-			aResult.setInvalidCertificate(cert);
+			/* setInvalidCertificate faz uma copia; a referencia extra eh liberada por cert */
+			X509_up_ref(current);
+			Certificate cert(current);
+			aResult.setInvalidCertificate(&cert);
 		}
 
 		aResult.setDepth(X509_STORE_CTX_get_error_depth(ctx));
@@ -212,12 +788,21 @@ int CertPathValidator::callback(int ok, X509_STORE_CTX *ctx)
 		/* 
 		 * Na ocorrência de erro, os avisos (warnings) antigos são descartados
 		 * */
+		/*
+		 * Contextos internos do OpenSSL (caminho de LCRs indiretas) nao tem o vetor de resultados
+		 * */
+		results = (vector<CertPathValidatorResult> *) X509_STORE_CTX_get_ex_data(ctx, CertPathValidator::resultsIndex);
+		if (results == NULL)
+		{
+			return ok;
+		}
+
 		if(!ok)
 		{
-			CertPathValidator::results.clear();
+			results->clear();
 		}
 		
-		CertPathValidator::results.push_back(aResult);
+		results->push_back(aResult);
 		
 		//TODO incluir informacoes de erro de politicas na classe CertPathValidatorResult
 	/*
@@ -0,0 +1,175 @@
+#include <libcryptosec/certificate/CertPathValidatorCache.h>
+
+CertPathValidatorCache::CertPathValidatorCache(unsigned int capacity, unsigned int shards)
+{
+	unsigned int i;
+	Shard *shard;
+
+	if (shards == 0)
+	{
+		shards = 1;
+	}
+	if (capacity < shards)
+	{
+		capacity = shards;
+	}
+	this->shardCapacity = capacity / shards;
+	for (i = 0; i < shards; i++)
+	{
+		shard = new Shard();
+		shard->lock = CRYPTO_THREAD_lock_new();
+		shard->hits = 0;
+		shard->misses = 0;
+		shard->expirations = 0;
+		shard->evictions = 0;
+		this->shards.push_back(shard);
+	}
+}
+
+CertPathValidatorCache::~CertPathValidatorCache()
+{
+	unsigned int i;
+	for (i = 0; i < this->shards.size(); i++)
+	{
+		CRYPTO_THREAD_lock_free(this->shards[i]->lock);
+		delete this->shards[i];
+	}
+}
+
+bool CertPathValidatorCache::find(const std::string &key, time_t when, bool &valid, std::vector<CertPathValidatorResult> &results)
+{
+	std::map<std::string, std::list<Entry>::iterator>::iterator it;
+	Shard &shard = this->getShard(key);
+	bool ret = false;
+
+	/* a hit reorders the LRU list, so even lookups take the write lock */
+	CRYPTO_THREAD_write_lock(shard.lock);
+	it = shard.index.find(key);
+	if (it != shard.index.end())
+	{
+		if (when >= it->second->notBefore && when < it->second->notAfter)
+		{
+			shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+			valid = it->second->valid;
+			results = it->second->results;
+			ret = true;
+		}
+		else if (when >= it->second->notAfter)
+		{
+			/* a certificate or CRL of the path has expired since the entry was stored */
+			shard.entries.erase(it->second);
+			shard.index.erase(it);
+			shard.expirations++;
+		}
+	}
+	if (ret)
+	{
+		shard.hits++;
+	}
+	else
+	{
+		shard.misses++;
+	}
+	CRYPTO_THREAD_unlock(shard.lock);
+	return ret;
+}
+
+void CertPathValidatorCache::insert(const std::string &key, time_t notBefore, time_t notAfter, bool valid, const std::vector<CertPathValidatorResult> &results)
+{
+	std::map<std::string, std::list<Entry>::iterator>::iterator it;
+	Shard &shard = this->getShard(key);
+	Entry entry;
+
+	if (notBefore >= notAfter)
+	{
+		return;
+	}
+	entry.key = key;
+	entry.notBefore = notBefore;
+	entry.notAfter = notAfter;
+	entry.valid = valid;
+	entry.results = results;
+
+	CRYPTO_THREAD_write_lock(shard.lock);
+	it = shard.index.find(key);
+	if (it != shard.index.end())
+	{
+		/* replaces an entry stored by another thread or for another validity interval */
+		shard.entries.erase(it->second);
+		shard.index.erase(it);
+	}
+	shard.entries.push_front(entry);
+	shard.index[key] = shard.entries.begin();
+	while (shard.index.size() > this->shardCapacity)
+	{
+		shard.index.erase(shard.entries.back().key);
+		shard.entries.pop_back();
+		shard.evictions++;
+	}
+	CRYPTO_THREAD_unlock(shard.lock);
+}
+
+CertPathValidatorCache::Stats CertPathValidatorCache::getStats()
+{
+	Stats ret;
+	unsigned int i;
+
+	ret.hits = 0;
+	ret.misses = 0;
+	ret.expirations = 0;
+	ret.evictions = 0;
+	ret.size = 0;
+	for (i = 0; i < this->shards.size(); i++)
+	{
+		CRYPTO_THREAD_read_lock(this->shards[i]->lock);
+		ret.hits += this->shards[i]->hits;
+		ret.misses += this->shards[i]->misses;
+		ret.expirations += this->shards[i]->expirations;
+		ret.evictions += this->shards[i]->evictions;
+		ret.size += this->shards[i]->index.size();
+		CRYPTO_THREAD_unlock(this->shards[i]->lock);
+	}
+	return ret;
+}
+
+double CertPathValidatorCache::getHitRate()
+{
+	Stats stats = this->getStats();
+	if (stats.hits + stats.misses == 0)
+	{
+		return 0.0;
+	}
+	return (double) stats.hits / (stats.hits + stats.misses);
+}
+
+unsigned int CertPathValidatorCache::getCapacity() const
+{
+	return this->shardCapacity * this->shards.size();
+}
+
+void CertPathValidatorCache::clear()
+{
+	unsigned int i;
+	Shard *shard;
+
+	for (i = 0; i < this->shards.size(); i++)
+	{
+		shard = this->shards[i];
+		CRYPTO_THREAD_write_lock(shard->lock);
+		shard->entries.clear();
+		shard->index.clear();
+		shard->hits = 0;
+		shard->misses = 0;
+		shard->expirations = 0;
+		shard->evictions = 0;
+		CRYPTO_THREAD_unlock(shard->lock);
+	}
+}
+
+CertPathValidatorCache::Shard& CertPathValidatorCache::getShard(const std::string &key)
+{
+	/* the key starts with a digest, so its first bytes are already uniformly distributed */
+	unsigned int pos;
+	pos = ((unsigned char) key[0] << 8) | (unsigned char) key[1];
+	return *this->shards[pos % this->shards.size()];
+}
@@ -1,12 +1,14 @@
 #include <libcryptosec/certificate/Certificate.h>
 
 Certificate::Certificate(X509 *cert)
+	: extensionIndex(NULL), extensionIndexLock(CRYPTO_THREAD_lock_new())
 {
 	this->cert = cert;
 }
 
 Certificate::Certificate(std::string pemEncoded)
 		throw (EncodeException)
+	: extensionIndex(NULL), extensionIndexLock(NULL)
 {
 	BIO *buffer;
 	buffer = BIO_new(BIO_s_mem());
@@ -26,10 +28,12 @@ Certificate::Certificate(std::string pemEncoded)
 		throw EncodeException(EncodeException::PEM_DECODE, "Certificate::Certificate");
 	}
 	BIO_free(buffer);
+	this->extensionIndexLock = CRYPTO_THREAD_lock_new();
 }
 
 Certificate::Certificate(ByteArray &derEncoded)
 	throw (EncodeException)
+	: extensionIndex(NULL), extensionIndexLock(NULL)
 {
 	BIO *buffer;
 	buffer = BIO_new(BIO_s_mem());
@@ -49,9 +53,11 @@ Certificate::Certificate(ByteArray &derEncoded)
 		throw EncodeException(EncodeException::DER_DECODE, "Certificate::Certificate");
 	}
 	BIO_free(buffer);
+	this->extensionIndexLock = CRYPTO_THREAD_lock_new();
 }
 
 Certificate::Certificate(const Certificate& cert)
+	: extensionIndex(NULL), extensionIndexLock(CRYPTO_THREAD_lock_new())
 {
 	this->cert = X509_dup(cert.getX509());
 }
@@ -60,6 +66,25 @@ Certificate::~Certificate()
 {
 	X509_free(this->cert);
 	this->cert = NULL;
+	delete this->extensionIndex;
+	CRYPTO_THREAD_lock_free(this->extensionIndexLock);
+}
+
+Certificate::ExtensionIndex::ExtensionIndex()
+{
+	for (int i = 0; i <= Extension::DELTA_CRL_INDICATOR; i++)
+	{
+		this->positions[i] = -1;
+		this->decoded[i] = NULL;
+	}
+}
+
+Certificate::ExtensionIndex::~ExtensionIndex()
+{
+	for (int i = 0; i <= Extension::DELTA_CRL_INDICATOR; i++)
+	{
+		delete this->decoded[i];
+	}
 }
 
  std::string Certificate::getXmlEncoded()
@@ -78,7 +103,8 @@ Certificate::~Certificate()
  	ByteArray data;
  	char temp[15];
  	long value;
- 	std::vector<Extension *> extensions;
+ 	const ExtensionIndex *index;
+ 	Extension *extension;
  	unsigned int i;
 
  	ret = "<?xml version=\"1.0\"?>\n";
@@ -191,11 +217,13 @@ Certificate::~Certificate()
  		}
 
  		ret += "\t\t<extensions>\n";
- 		extensions = this->getExtensions();
- 		for (i=0;i<extensions.size();i++)
+ 		/* one extension at a time, instead of decoding them all with getExtensions() */
+ 		index = this->getExtensionIndex();
+ 		for (i=0;i<index->names.size();i++)
  		{
- 			ret += extensions.at(i)->toXml("\t\t\t");
- 			delete extensions.at(i);
+ 			extension = Certificate::newExtension(X509_get_ext(this->cert, i), index->names[i]);
+ 			ret += extension->toXml("\t\t\t");
+ 			delete extension;
  		}
  		ret += "\t\t</extensions>\n";
  		ASN1_BIT_STRING_free(const_cast<ASN1_BIT_STRING *>(piuid));
@@ -232,6 +260,68 @@ Certificate::~Certificate()
  }
 
 
+void Certificate::write(DocumentWriter &writer)
+{
+	const ExtensionIndex *index;
+	Extension *extension;
+	X509_PUBKEY *publicKeyInfo;
+	ASN1_OBJECT *publicKeyAlgorithm;
+	const unsigned char *publicKey;
+	int publicKeyLength;
+	const ASN1_BIT_STRING *issuerUid, *subjectUid;
+	const ASN1_BIT_STRING *signature;
+	const X509_ALGOR *algorithm;
+
+	writer.begin("certificate");
+	writer.begin("tbsCertificate");
+	writer.write("version", X509_get_version(this->cert));
+	writer.write("serialNumber", this->getSerialNumberBigInt().toDec());
+	writer.write("signature", OBJ_nid2ln(X509_get_signature_nid(this->cert)));
+	RDNSequence::write(writer, "issuer", X509_get_issuer_name(this->cert));
+	writer.begin("validity");
+	writer.writeTime("notBefore", X509_get0_notBefore(this->cert));
+	writer.writeTime("notAfter", X509_get0_notAfter(this->cert));
+	writer.end();
+	RDNSequence::write(writer, "subject", X509_get_subject_name(this->cert));
+
+	writer.begin("subjectPublicKeyInfo");
+	publicKeyInfo = X509_get_X509_PUBKEY(this->cert);
+	if (publicKeyInfo != NULL && X509_PUBKEY_get0_param(&publicKeyAlgorithm, &publicKey, &publicKeyLength, NULL, publicKeyInfo))
+	{
+		writer.write("algorithm", OBJ_nid2ln(OBJ_obj2nid(publicKeyAlgorithm)));
+		writer.writeBase64("subjectPublicKey", publicKey, publicKeyLength);
+	}
+	writer.end();
+
+	X509_get0_uids(this->cert, &issuerUid, &subjectUid);
+	if (issuerUid != NULL)
+	{
+		writer.writeBase64("issuerUniqueID", issuerUid->data, issuerUid->length);
+	}
+	if (subjectUid != NULL)
+	{
+		writer.writeBase64("subjectUniqueID", subjectUid->data, subjectUid->length);
+	}
+
+	writer.beginList("extensions");
+	index = this->getExtensionIndex();
+	for (unsigned int i = 0; i < index->names.size(); i++)
+	{
+		extension = Certificate::newExtension(X509_get_ext(this->cert, i), index->names[i]);
+		extension->write(writer);
+		delete extension;
+	}
+	writer.end();
+	writer.end();
+
+	writer.begin("signatureAlgorithm");
+	writer.write("algorithm", OBJ_nid2ln(X509_get_signature_nid(this->cert)));
+	writer.end();
+	X509_get0_signature(&signature, &algorithm, this->cert);
+	writer.writeBase64("signatureValue", signature->data, signature->length);
+	writer.end();
+}
+
 std::string Certificate::getPemEncoded() const
 		throw (EncodeException)
 {
@@ -443,56 +533,14 @@ RDNSequence Certificate::getSubject()
 
 std::vector<Extension*> Certificate::getExtension(Extension::Name extensionName)
 {
-	int next, i;
-	X509_EXTENSION *ext;
+	const ExtensionIndex *index;
 	std::vector<Extension *> ret;
-	Extension *oneExt;
-	next = X509_get_ext_count(this->cert);
-	for (i=0;i<next;i++)
+	index = this->getExtensionIndex();
+	for (unsigned int i = 0; i < index->names.size(); i++)
 	{
-		ext = X509_get_ext(this->cert, i);
-		if (Extension::getName(ext) == extensionName)
+		if (index->names[i] == extensionName)
 		{
-			switch (Extension::getName(ext))
-			{
-				case Extension::KEY_USAGE:
-					oneExt = new KeyUsageExtension(ext);
-					break;
-				case Extension::EXTENDED_KEY_USAGE:
-					oneExt = new ExtendedKeyUsageExtension(ext);
-					break;
-				case Extension::AUTHORITY_KEY_IDENTIFIER:
-					oneExt = new AuthorityKeyIdentifierExtension(ext);
-					break;
-				case Extension::CRL_DISTRIBUTION_POINTS:
-					oneExt = new CRLDistributionPointsExtension(ext);
-					break;
-				case Extension::AUTHORITY_INFORMATION_ACCESS:
-					oneExt = new AuthorityInformationAccessExtension(ext);
-					break;
-				case Extension::BASIC_CONSTRAINTS:
-					oneExt = new BasicConstraintsExtension(ext);
-					break;
-				case Extension::CERTIFICATE_POLICIES:
-					oneExt = new CertificatePoliciesExtension(ext);
-					break;
-				case Extension::ISSUER_ALTERNATIVE_NAME:
-					oneExt = new IssuerAlternativeNameExtension(ext);
-					break;
-				case Extension::SUBJECT_ALTERNATIVE_NAME:
-					oneExt = new SubjectAlternativeNameExtension(ext);
-					break;
-				case Extension::SUBJECT_INFORMATION_ACCESS:
-					oneExt = new SubjectInformationAccessExtension(ext);
-					break;
-				case Extension::SUBJECT_KEY_IDENTIFIER:
-					oneExt = new SubjectKeyIdentifierExtension(ext);
-					break;
-				default:
-					oneExt = new Extension(ext);
-					break;
-			}
-			ret.push_back(oneExt);
+			ret.push_back(Certificate::newExtension(X509_get_ext(this->cert, i), extensionName));
 		}
 	}
 	return ret;
@@ -500,54 +548,12 @@ std::vector<Extension*> Certificate::getExtension(Extension::Name extensionName)
 
 std::vector<Extension*> Certificate::getExtensions()
 {
-	int next, i;
-	X509_EXTENSION *ext;
+	const ExtensionIndex *index;
 	std::vector<Extension *> ret;
-	Extension *oneExt;
-	next = X509_get_ext_count(this->cert);
-	for (i=0;i<next;i++)
+	index = this->getExtensionIndex();
+	for (unsigned int i = 0; i < index->names.size(); i++)
 	{
-		ext = X509_get_ext(this->cert, i);
-		switch (Extension::getName(ext))
-		{
-			case Extension::KEY_USAGE:
-				oneExt = new KeyUsageExtension(ext);
-				break;
-			case Extension::EXTENDED_KEY_USAGE:
-				oneExt = new ExtendedKeyUsageExtension(ext);
-				break;
-			case Extension::AUTHORITY_KEY_IDENTIFIER:
-				oneExt = new AuthorityKeyIdentifierExtension(ext);
-				break;
-			case Extension::CRL_DISTRIBUTION_POINTS:
-				oneExt = new CRLDistributionPointsExtension(ext);
-				break;
-			case Extension::AUTHORITY_INFORMATION_ACCESS:
-				oneExt = new AuthorityInformationAccessExtension(ext);
-				break;
-			case Extension::BASIC_CONSTRAINTS:
-				oneExt = new BasicConstraintsExtension(ext);
-				break;
-			case Extension::CERTIFICATE_POLICIES:
-				oneExt = new CertificatePoliciesExtension(ext);
-				break;
-			case Extension::ISSUER_ALTERNATIVE_NAME:
-				oneExt = new IssuerAlternativeNameExtension(ext);
-				break;
-			case Extension::SUBJECT_ALTERNATIVE_NAME:
-				oneExt = new SubjectAlternativeNameExtension(ext);
-				break;
-			case Extension::SUBJECT_INFORMATION_ACCESS:
-				oneExt = new SubjectInformationAccessExtension(ext);
-				break;			
-			case Extension::SUBJECT_KEY_IDENTIFIER:
-				oneExt = new SubjectKeyIdentifierExtension(ext);
-				break;
-			default:
-				oneExt = new Extension(ext);
-				break;
-		}
-		ret.push_back(oneExt);
+		ret.push_back(Certificate::newExtension(X509_get_ext(this->cert, i), index->names[i]));
 	}
 	return ret;
 }
@@ -574,6 +580,206 @@ std::vector<Extension *> Certificate::getUnknownExtensions()
 	return ret;
 }
 
+bool Certificate::hasExtension(Extension::Name extensionName) const
+{
+	return this->getExtensionIndex()->positions[extensionName] != -1;
+}
+
+BasicConstraintsExtension Certificate::getBasicConstraints() const throw (CertificationException)
+{
+	return *static_cast<const BasicConstraintsExtension *>(
+			this->getDecodedExtension(Extension::BASIC_CONSTRAINTS, "Certificate::getBasicConstraints"));
+}
+
+KeyUsageExtension Certificate::getKeyUsage() const throw (CertificationException)
+{
+	return *static_cast<const KeyUsageExtension *>(
+			this->getDecodedExtension(Extension::KEY_USAGE, "Certificate::getKeyUsage"));
+}
+
+ExtendedKeyUsageExtension Certificate::getExtendedKeyUsage() const throw (CertificationException)
+{
+	return *static_cast<const ExtendedKeyUsageExtension *>(
+			this->getDecodedExtension(Extension::EXTENDED_KEY_USAGE, "Certificate::getExtendedKeyUsage"));
+}
+
+SubjectKeyIdentifierExtension Certificate::getSubjectKeyIdentifier() const throw (CertificationException)
+{
+	return *static_cast<const SubjectKeyIdentifierExtension *>(
+			this->getDecodedExtension(Extension::SUBJECT_KEY_IDENTIFIER, "Certificate::getSubjectKeyIdentifier"));
+}
+
+AuthorityKeyIdentifierExtension Certificate::getAuthorityKeyIdentifier() const throw (CertificationException)
+{
+	return *static_cast<const AuthorityKeyIdentifierExtension *>(
+			this->getDecodedExtension(Extension::AUTHORITY_KEY_IDENTIFIER, "Certificate::getAuthorityKeyIdentifier"));
+}
+
+SubjectAlternativeNameExtension Certificate::getSubjectAlternativeName() const throw (CertificationException)
+{
+	return *static_cast<const SubjectAlternativeNameExtension *>(
+			this->getDecodedExtension(Extension::SUBJECT_ALTERNATIVE_NAME, "Certificate::getSubjectAlternativeName"));
+}
+
+IssuerAlternativeNameExtension Certificate::getIssuerAlternativeName() const throw (CertificationException)
+{
+	return *static_cast<const IssuerAlternativeNameExtension *>(
+			this->getDecodedExtension(Extension::ISSUER_ALTERNATIVE_NAME, "Certificate::getIssuerAlternativeName"));
+}
+
+CRLDistributionPointsExtension Certificate::getCRLDistributionPoints() const throw (CertificationException)
+{
+	return *static_cast<const CRLDistributionPointsExtension *>(
+			this->getDecodedExtension(Extension::CRL_DISTRIBUTION_POINTS, "Certificate::getCRLDistributionPoints"));
+}
+
+CertificatePoliciesExtension Certificate::getCertificatePolicies() const throw (CertificationException)
+{
+	return *static_cast<const CertificatePoliciesExtension *>(
+			this->getDecodedExtension(Extension::CERTIFICATE_POLICIES, "Certificate::getCertificatePolicies"));
+}
+
+AuthorityInformationAccessExtension Certificate::getAuthorityInformationAccess() const throw (CertificationException)
+{
+	return *static_cast<const AuthorityInformationAccessExtension *>(
+			this->getDecodedExtension(Extension::AUTHORITY_INFORMATION_ACCESS, "Certificate::getAuthorityInformationAccess"));
+}
+
+SubjectInformationAccessExtension Certificate::getSubjectInformationAccess() const throw (CertificationException)
+{
+	return *static_cast<const SubjectInformationAccessExtension *>(
+			this->getDecodedExtension(Extension::SUBJECT_INFORMATION_ACCESS, "Certificate::getSubjectInformationAccess"));
+}
+
+const Certificate::ExtensionIndex* Certificate::getExtensionIndex() const
+{
+	ExtensionIndex *index;
+	Extension::Name name;
+	int count;
+
+	CRYPTO_THREAD_read_lock(this->extensionIndexLock);
+	index = this->extensionIndex;
+	CRYPTO_THREAD_unlock(this->extensionIndexLock);
+	if (index != NULL)
+	{
+		return index;
+	}
+
+	/* only the OIDs are looked at; if two threads race, the first index is kept */
+	index = new ExtensionIndex();
+	count = (this->cert != NULL) ? X509_get_ext_count(this->cert) : 0;
+	for (int i = 0; i < count; i++)
+	{
+		name = Extension::getName(X509_get_ext(this->cert, i));
+		index->names.push_back(name);
+		if (index->positions[name] == -1)
+		{
+			index->positions[name] = i;
+		}
+	}
+
+	CRYPTO_THREAD_write_lock(this->extensionIndexLock);
+	if (this->extensionIndex == NULL)
+	{
+		this->extensionIndex = index;
+	}
+	else
+	{
+		delete index;
+		index = this->extensionIndex;
+	}
+	CRYPTO_THREAD_unlock(this->extensionIndexLock);
+	return index;
+}
+
+void Certificate::resetExtensionIndex()
+{
+	CRYPTO_THREAD_write_lock(this->extensionIndexLock);
+	delete this->extensionIndex;
+	this->extensionIndex = NULL;
+	CRYPTO_THREAD_unlock(this->extensionIndexLock);
+}
+
+const Extension* Certificate::getDecodedExtension(Extension::Name extensionName, const char *where) const
+		throw (CertificationException)
+{
+	ExtensionIndex *index;
+	Extension *ret;
+
+	index = const_cast<ExtensionIndex *>(this->getExtensionIndex());
+	if (index->positions[extensionName] == -1)
+	{
+		throw CertificationException(CertificationException::SET_NO_VALUE, where);
+	}
+	CRYPTO_THREAD_read_lock(this->extensionIndexLock);
+	ret = index->decoded[extensionName];
+	CRYPTO_THREAD_unlock(this->extensionIndexLock);
+	if (ret != NULL)
+	{
+		return ret;
+	}
+
+	/* decoded outside the lock, like the index itself */
+	ret = Certificate::newExtension(X509_get_ext(this->cert, index->positions[extensionName]), extensionName);
+	CRYPTO_THREAD_write_lock(this->extensionIndexLock);
+	if (index->decoded[extensionName] == NULL)
+	{
+		index->decoded[extensionName] = ret;
+	}
+	else
+	{
+		delete ret;
+		ret = index->decoded[extensionName];
+	}
+	CRYPTO_THREAD_unlock(this->extensionIndexLock);
+	return ret;
+}
+
+Extension* Certificate::newExtension(X509_EXTENSION *ext, Extension::Name extensionName) throw (CertificationException)
+{
+	Extension *ret;
+	switch (extensionName)
+	{
+		case Extension::KEY_USAGE:
+			ret = new KeyUsageExtension(ext);
+			break;
+		case Extension::EXTENDED_KEY_USAGE:
+			ret = new ExtendedKeyUsageExtension(ext);
+			break;
+		case Extension::AUTHORITY_KEY_IDENTIFIER:
+			ret = new AuthorityKeyIdentifierExtension(ext);
+			break;
+		case Extension::CRL_DISTRIBUTION_POINTS:
+			ret = new CRLDistributionPointsExtension(ext);
+			break;
+		case Extension::AUTHORITY_INFORMATION_ACCESS:
+			ret = new AuthorityInformationAccessExtension(ext);
+			break;
+		case Extension::BASIC_CONSTRAINTS:
+			ret = new BasicConstraintsExtension(ext);
+			break;
+		case Extension::CERTIFICATE_POLICIES:
+			ret = new CertificatePoliciesExtension(ext);
+			break;
+		case Extension::ISSUER_ALTERNATIVE_NAME:
+			ret = new IssuerAlternativeNameExtension(ext);
+			break;
+		case Extension::SUBJECT_ALTERNATIVE_NAME:
+			ret = new SubjectAlternativeNameExtension(ext);
+			break;
+		case Extension::SUBJECT_INFORMATION_ACCESS:
+			ret = new SubjectInformationAccessExtension(ext);
+			break;
+		case Extension::SUBJECT_KEY_IDENTIFIER:
+			ret = new SubjectKeyIdentifierExtension(ext);
+			break;
+		default:
+			ret = new Extension(ext);
+			break;
+	}
+	return ret;
+}
+
 ByteArray Certificate::getFingerPrint(MessageDigest::Algorithm algorithm) const
 		throw (CertificationException, EncodeException, MessageDigestException)
 {
@@ -592,6 +798,19 @@ bool Certificate::verify(PublicKey &publicKey)
 	return (ok == 1);
 }
 
+bool Certificate::verify(const Certificate &issuer)
+{
+	EVP_PKEY *key;
+	int ok;
+	key = X509_get0_pubkey(issuer.getX509());
+	if (key == NULL)
+	{
+		return false;
+	}
+	ok = X509_verify(this->cert, key);
+	return (ok == 1);
+}
+
 X509* Certificate::getX509() const
 {
 	return this->cert;
@@ -616,6 +835,7 @@ Certificate& Certificate::operator =(const Certificate& value)
 		X509_free(this->cert);
 	}
     this->cert = X509_dup(value.getX509());
+    this->resetExtensionIndex();
     return (*this);
 }
 
@@ -518,64 +518,46 @@ void CertificateBuilder::alterSubject(RDNSequence &name)
 		throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateBuilder::alterSubject");
 	}
 	std::vector<std::pair<ObjectIdentifier, std::string> > entries = name.getEntries();
+	std::vector<int> positions(entries.size());
 	X509_NAME_ENTRY *newEntry;
+	bool rc;
 
-	int addedFieldType = this->getCodification(name);
-
-	std::string data;
-	for(std::vector<std::pair<ObjectIdentifier, std::string> >::iterator entry = entries.begin(); entry != entries.end(); entry++)
+	/* each entry is looked up once, both for its own codification and for the one of new entries */
+	for(unsigned int i = 0; i < entries.size(); i++)
 	{
-		data = entry->second;
-		newEntry = X509_NAME_ENTRY_new();
+		positions[i] = X509_NAME_get_index_by_NID(subject, entries[i].first.getNid(), -1);
+	}
+	int addedFieldType = this->getCodification(subject, entries, positions);
 
-		int position = X509_NAME_get_index_by_NID(subject, entry->first.getNid(), -1);
+	for(unsigned int i = 0; i < entries.size(); i++)
+	{
+		const std::string &data = entries[i].second;
+		int entryType = addedFieldType;
 
-		if(!data.empty()) // If entry is not empty, add entry
+		if(data.empty()) // If entry is empty, it is not added
 		{
-			if(position != -1)
-			{
-				X509_NAME_ENTRY* oldEntry = X509_NAME_get_entry(subject, position);
-
-				int entryType = X509_NAME_ENTRY_get_data(oldEntry)->type; //martin: oldEntry->value->type;
-
-				if(!X509_NAME_ENTRY_set_object(newEntry, entry->first.getObjectIdentifier()))
-				{
-					throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateBuilder::alterSubject");
-				}
-
-				if(!X509_NAME_ENTRY_set_data(newEntry, entryType, (unsigned char *)data.c_str(), data.length()))
-				{
-					throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateBuilder::alterSubject");
-				}
-
-				if(!X509_NAME_add_entry(subjectName, newEntry, -1, 0))
-				{
-					throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateBuilder::alterSubject");
-				}
-
-				X509_NAME_ENTRY_free(newEntry);
+			continue;
+		}
+		if(positions[i] != -1)
+		{
+			X509_NAME_ENTRY* oldEntry = X509_NAME_get_entry(subject, positions[i]);
+			entryType = X509_NAME_ENTRY_get_data(oldEntry)->type; //martin: oldEntry->value->type;
+		}
 
-			}
-			else
-			{
-				if(!X509_NAME_ENTRY_set_object(newEntry, entry->first.getObjectIdentifier()))
-				{
-					throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateBuilder::alterSubject");
-				}
-				if(!X509_NAME_ENTRY_set_data(newEntry, addedFieldType, (unsigned char *)data.c_str(), data.length()))
-				{
-					throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateBuilder::alterSubject");
-				}
-				if(!X509_NAME_add_entry(subjectName, newEntry, -1, 0))
-				{
-					throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateBuilder::alterSubject");
-				}
-				X509_NAME_ENTRY_free(newEntry);
-			}
+		newEntry = X509_NAME_ENTRY_new();
+		rc = newEntry != NULL
+				&& X509_NAME_ENTRY_set_object(newEntry, entries[i].first.getObjectIdentifier())
+				&& X509_NAME_ENTRY_set_data(newEntry, entryType, (unsigned char *)data.c_str(), data.length())
+				&& X509_NAME_add_entry(subjectName, newEntry, -1, 0);
+		X509_NAME_ENTRY_free(newEntry);
+		if(!rc)
+		{
+			X509_NAME_free(subjectName);
+			throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateBuilder::alterSubject");
 		}
 	}
 
-	int rc = X509_set_subject_name(this->cert, subjectName);
+	rc = X509_set_subject_name(this->cert, subjectName);
 	X509_NAME_free(subjectName);
 
 	if(!rc)
@@ -1050,22 +1032,16 @@ void CertificateBuilder::includeEcdsaParameters() {
 	}
 }
 
-int CertificateBuilder::getCodification(RDNSequence& name){
+int CertificateBuilder::getCodification(X509_NAME *subject,
+		const std::vector<std::pair<ObjectIdentifier, std::string> > &entries, const std::vector<int> &positions)
+{
 	int entryType = MBSTRING_ASC;
-	X509_NAME *subject = X509_get_subject_name(this->cert);
-	if(subject == NULL)
-	{
-		throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateBuilder::alterSubject");
-	}
-
-	std::vector<std::pair<ObjectIdentifier, std::string> > entries = name.getEntries();
 
-	for(std::vector<std::pair<ObjectIdentifier, std::string> >::iterator entry = entries.begin(); entry != entries.end(); entry++)
+	for(unsigned int i = 0; i < entries.size(); i++)
 	{
-		int position = X509_NAME_get_index_by_NID(subject, entry->first.getNid(), -1);
-		if(position != -1 && entry->first.getNid() != NID_countryName)
+		if(positions[i] != -1 && entries[i].first.getNid() != NID_countryName)
 		{
-			X509_NAME_ENTRY* oldEntry = X509_NAME_get_entry(subject, position);
+			X509_NAME_ENTRY* oldEntry = X509_NAME_get_entry(subject, positions[i]);
 			entryType = X509_NAME_ENTRY_get_data(oldEntry)->type; //martin: oldEntry->value->type;
 			if(entryType != MBSTRING_FLAG) {
 				return entryType;
@@ -75,12 +75,38 @@ std::vector<PolicyInformation> CertificatePoliciesExtension::getPoliciesInformat
 	return this->policiesInformation;
 }
 
+void CertificatePoliciesExtension::encodeValue(DerWriter &writer)
+{
+	writer.begin(DerWriter::SEQUENCE);
+	for (unsigned int i = 0; i < this->policiesInformation.size(); i++)
+	{
+		this->policiesInformation[i].encode(writer);
+	}
+	writer.end();
+}
+
+void CertificatePoliciesExtension::writeValue(DocumentWriter &writer)
+{
+	writer.beginList("policiesInformation");
+	for (unsigned int i = 0; i < this->policiesInformation.size(); i++)
+	{
+		this->policiesInformation[i].write(writer);
+	}
+	writer.end();
+}
+
 X509_EXTENSION* CertificatePoliciesExtension::getX509Extension()
 {
 	X509_EXTENSION *ret;
 	CERTIFICATEPOLICIES *certificatePolicies;
 //	POLICYINFO *policyInformation;
 	unsigned int i;
+	ret = this->encodeX509Extension(NID_certificate_policies);
+	if (ret != NULL)
+	{
+		return ret;
+	}
+	/* values the writer does not handle are encoded by OpenSSL */
 	certificatePolicies = CERTIFICATEPOLICIES_new();
 	for (i=0;i<this->policiesInformation.size();i++)
 	{
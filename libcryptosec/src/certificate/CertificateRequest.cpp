@@ -123,6 +123,33 @@ std::string CertificateRequest::toXml(std::string tab)
 	return ret;
 }
 
+void CertificateRequest::write(DocumentWriter &writer)
+{
+	std::vector<Extension *> extensions;
+	ByteArray publicKeyInfo;
+
+	writer.begin("certificateRequest");
+	writer.write("version", this->getVersion());
+	RDNSequence::write(writer, "subject", X509_REQ_get_subject_name(this->req));
+	try
+	{
+		publicKeyInfo = this->getPublicKeyInfo();
+		writer.writeBase64("publicKeyInfo", publicKeyInfo.getDataPointer(), publicKeyInfo.size());
+	}
+	catch (...)
+	{
+	}
+	writer.beginList("extensions");
+	extensions = this->getExtensions();
+	for (unsigned int i = 0; i < extensions.size(); i++)
+	{
+		extensions[i]->write(writer);
+		delete extensions[i];
+	}
+	writer.end();
+	writer.end();
+}
+
 std::string CertificateRequest::getPemEncoded()
 		throw (EncodeException)
 {
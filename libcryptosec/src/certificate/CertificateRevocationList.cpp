@@ -1,12 +1,21 @@
 #include <libcryptosec/certificate/CertificateRevocationList.h>
+#include <libcryptosec/certificate/Certificate.h>
+
+#include <algorithm>
+
+#define DEFAULT_BLOOM_FILTER_RATE	0.01
 
 CertificateRevocationList::CertificateRevocationList(X509_CRL *crl)
+	: serialIndex(NULL), serialIndexLock(CRYPTO_THREAD_lock_new()),
+	  bloomFilterRate(DEFAULT_BLOOM_FILTER_RATE), bloomFilterMaxBits(0)
 {
 	this->crl = crl;
 }
 
 CertificateRevocationList::CertificateRevocationList(std::string pemEncoded)
 		throw (EncodeException)
+	: serialIndex(NULL), serialIndexLock(NULL),
+	  bloomFilterRate(DEFAULT_BLOOM_FILTER_RATE), bloomFilterMaxBits(0)
 {
 	BIO *buffer;
 	buffer = BIO_new(BIO_s_mem());
@@ -26,10 +35,13 @@ CertificateRevocationList::CertificateRevocationList(std::string pemEncoded)
 		throw EncodeException(EncodeException::PEM_DECODE, "CertificateBuilder::CertificateBuilder");
 	}
 	BIO_free(buffer);
+	this->serialIndexLock = CRYPTO_THREAD_lock_new();
 }
 
 CertificateRevocationList::CertificateRevocationList(ByteArray &derEncoded)
 	throw (EncodeException)
+	: serialIndex(NULL), serialIndexLock(NULL),
+	  bloomFilterRate(DEFAULT_BLOOM_FILTER_RATE), bloomFilterMaxBits(0)
 {
 	BIO *buffer;
 	buffer = BIO_new(BIO_s_mem());
@@ -49,9 +61,12 @@ CertificateRevocationList::CertificateRevocationList(ByteArray &derEncoded)
 		throw EncodeException(EncodeException::DER_DECODE, "CertificateRevocationList::CertificateRevocationList");
 	}
 	BIO_free(buffer);
+	this->serialIndexLock = CRYPTO_THREAD_lock_new();
 }
 
 CertificateRevocationList::CertificateRevocationList(const CertificateRevocationList& crl)
+	: serialIndex(NULL), serialIndexLock(CRYPTO_THREAD_lock_new()),
+	  bloomFilterRate(crl.bloomFilterRate), bloomFilterMaxBits(crl.bloomFilterMaxBits)
 {
 	this->crl = X509_CRL_dup(crl.getX509Crl());
 }
@@ -59,6 +74,8 @@ CertificateRevocationList::CertificateRevocationList(const CertificateRevocation
 CertificateRevocationList::~CertificateRevocationList()
 {
 	X509_CRL_free(this->crl);
+	delete this->serialIndex;
+	CRYPTO_THREAD_lock_free(this->serialIndexLock);
 }
 
 std::string CertificateRevocationList::getXmlEncoded()
@@ -71,8 +88,8 @@ std::string CertificateRevocationList::getXmlEncoded(std::string tab)
 	std::string ret, string;
 	ByteArray data;
 	char temp[11];
-	std::vector<RevokedCertificate> revokedCertificates;
-	unsigned int i;
+	STACK_OF(X509_REVOKED) *revokedStack;
+	int i;
 	ret = tab + "<certificateRevocationList>\n";
 	
 	ret += tab + "\t<tbsCertList>\n";
@@ -104,10 +121,11 @@ std::string CertificateRevocationList::getXmlEncoded(std::string tab)
 		ret += tab + "\t\t<nextUpdate>" + this->getNextUpdate().getXmlEncoded() + "</nextUpdate>\n";
 		
 		ret += tab + "\t\t<revokedCertificates>\n";
-			revokedCertificates = this->getRevokedCertificate();
-			for (i=0;i<revokedCertificates.size();i++)
+			/* one entry at a time, instead of copying them all with getRevokedCertificate() */
+			revokedStack = X509_CRL_get_REVOKED(this->crl);
+			for (i=0;i<sk_X509_REVOKED_num(revokedStack);i++)
 			{
-				ret += revokedCertificates.at(i).getXmlEncoded(tab + "\t\t\t");
+				ret += RevokedCertificate(sk_X509_REVOKED_value(revokedStack, i)).getXmlEncoded(tab + "\t\t\t");
 			}
 		ret += tab + "\t\t</revokedCertificates>\n";
 
@@ -141,6 +159,50 @@ std::string CertificateRevocationList::getXmlEncoded(std::string tab)
 	return ret;
 }
 
+void CertificateRevocationList::write(DocumentWriter &writer)
+{
+	STACK_OF(X509_REVOKED) *revokedStack;
+	std::vector<Extension *> extensions;
+	const ASN1_BIT_STRING *signature;
+	const X509_ALGOR *algorithm;
+
+	writer.begin("certificateRevocationList");
+	writer.begin("tbsCertList");
+	writer.write("version", X509_CRL_get_version(this->crl));
+	writer.write("signature", OBJ_nid2ln(X509_CRL_get_signature_nid(this->crl)));
+	RDNSequence::write(writer, "issuer", X509_CRL_get_issuer(this->crl));
+	writer.writeTime("thisUpdate", X509_CRL_get0_lastUpdate(this->crl));
+	if (X509_CRL_get0_nextUpdate(this->crl) != NULL)
+	{
+		writer.writeTime("nextUpdate", X509_CRL_get0_nextUpdate(this->crl));
+	}
+
+	writer.beginList("revokedCertificates");
+	revokedStack = X509_CRL_get_REVOKED(this->crl);
+	for (int i = 0; i < sk_X509_REVOKED_num(revokedStack); i++)
+	{
+		RevokedCertificate::write(writer, sk_X509_REVOKED_value(revokedStack, i));
+	}
+	writer.end();
+
+	writer.beginList("crlExtensions");
+	extensions = this->getExtensions();
+	for (unsigned int i = 0; i < extensions.size(); i++)
+	{
+		extensions[i]->write(writer);
+		delete extensions[i];
+	}
+	writer.end();
+	writer.end();
+
+	writer.begin("signatureAlgorithm");
+	writer.write("algorithm", OBJ_nid2ln(X509_CRL_get_signature_nid(this->crl)));
+	writer.end();
+	X509_CRL_get0_signature(this->crl, &signature, &algorithm);
+	writer.writeBase64("signatureValue", signature->data, signature->length);
+	writer.end();
+}
+
 std::string CertificateRevocationList::getPemEncoded()
 		throw (EncodeException)
 {
@@ -343,6 +405,177 @@ std::vector<RevokedCertificate> CertificateRevocationList::getRevokedCertificate
     return ret;
 }
 
+bool CertificateRevocationList::isRevoked(const BigInteger &serialNumber)
+{
+	return (this->findRevoked(serialNumber) != NULL);
+}
+
+RevokedCertificate* CertificateRevocationList::getRevocation(const BigInteger &serialNumber)
+{
+	X509_REVOKED *revoked;
+	revoked = this->findRevoked(serialNumber);
+	if (revoked == NULL)
+	{
+		return NULL;
+	}
+	return new RevokedCertificate(revoked);
+}
+
+void CertificateRevocationList::setBloomFilter(double falsePositiveRate, unsigned long maxSizeBits)
+{
+	this->bloomFilterRate = falsePositiveRate;
+	this->bloomFilterMaxBits = maxSizeBits;
+	this->resetSerialIndex();
+}
+
+const BloomFilter* CertificateRevocationList::getBloomFilter() const
+{
+	const BloomFilter *ret;
+	CRYPTO_THREAD_read_lock(this->serialIndexLock);
+	ret = (this->serialIndex != NULL) ? this->serialIndex->filter : NULL;
+	CRYPTO_THREAD_unlock(this->serialIndexLock);
+	return ret;
+}
+
+X509_REVOKED* CertificateRevocationList::findRevoked(const BigInteger &serialNumber)
+{
+	std::vector<SerialIndexEntry>::const_iterator it;
+	const SerialIndex *index;
+	X509_REVOKED *ret = NULL;
+	ASN1_INTEGER *serial;
+	SerialIndexEntry key;
+
+	index = this->getSerialIndex();
+	if (index == NULL || index->entries.empty())
+	{
+		return NULL;
+	}
+	/* most serials are not revoked; the filter clears them before the number is even converted */
+	key.hash = CertificateRevocationList::hashSerial(serialNumber.getBIGNUM());
+	if (index->filter != NULL && !index->filter->mightContain(key.hash))
+	{
+		return NULL;
+	}
+	serial = serialNumber.getASN1Value();
+	/* entries with the same hash are compared with the actual serial numbers */
+	for (it = std::lower_bound(index->entries.begin(), index->entries.end(), key);
+			it != index->entries.end() && it->hash == key.hash; it++)
+	{
+		if (ASN1_INTEGER_cmp(X509_REVOKED_get0_serialNumber(it->revoked), serial) == 0)
+		{
+			ret = it->revoked;
+			break;
+		}
+	}
+	ASN1_INTEGER_free(serial);
+	return ret;
+}
+
+const CertificateRevocationList::SerialIndex* CertificateRevocationList::getSerialIndex()
+{
+	STACK_OF(X509_REVOKED) *revokedStack;
+	SerialIndex *index;
+	SerialIndexEntry entry;
+	int size;
+
+	CRYPTO_THREAD_read_lock(this->serialIndexLock);
+	index = this->serialIndex;
+	CRYPTO_THREAD_unlock(this->serialIndexLock);
+	if (index != NULL || this->crl == NULL)
+	{
+		return index;
+	}
+
+	/* the index is built outside the lock; if two threads race, the first one is kept */
+	revokedStack = X509_CRL_get_REVOKED(this->crl);
+	size = sk_X509_REVOKED_num(revokedStack);
+	index = new SerialIndex();
+	index->entries.reserve(size > 0 ? size : 0);
+	if (size > 0 && this->bloomFilterRate > 0.0)
+	{
+		index->filter = new BloomFilter(size, this->bloomFilterRate, this->bloomFilterMaxBits);
+	}
+	for (int i = 0; i < size; i++)
+	{
+		entry.revoked = sk_X509_REVOKED_value(revokedStack, i);
+		entry.hash = CertificateRevocationList::hashSerial(X509_REVOKED_get0_serialNumber(entry.revoked));
+		index->entries.push_back(entry);
+		if (index->filter != NULL)
+		{
+			index->filter->add(entry.hash);
+		}
+	}
+	std::sort(index->entries.begin(), index->entries.end());
+
+	CRYPTO_THREAD_write_lock(this->serialIndexLock);
+	if (this->serialIndex == NULL)
+	{
+		this->serialIndex = index;
+	}
+	else
+	{
+		delete index;
+		index = this->serialIndex;
+	}
+	CRYPTO_THREAD_unlock(this->serialIndexLock);
+	return index;
+}
+
+void CertificateRevocationList::resetSerialIndex()
+{
+	CRYPTO_THREAD_write_lock(this->serialIndexLock);
+	delete this->serialIndex;
+	this->serialIndex = NULL;
+	CRYPTO_THREAD_unlock(this->serialIndexLock);
+}
+
+uint64_t CertificateRevocationList::hashSerial(const ASN1_INTEGER *serial)
+{
+	/* FNV-1a over the sign and the magnitude bytes; the type is V_ASN1_NEG_INTEGER (0x102) for
+	 * negative numbers, which a cast to a byte would turn into V_ASN1_INTEGER */
+	const unsigned char *data;
+	uint64_t ret = 14695981039346656037ULL;
+	int length;
+
+	ret = (ret ^ (ASN1_STRING_type(serial) == V_ASN1_NEG_INTEGER ? 1 : 0)) * 1099511628211ULL;
+	data = ASN1_STRING_get0_data(serial);
+	length = ASN1_STRING_length(serial);
+	for (int i = 0; i < length; i++)
+	{
+		ret = (ret ^ data[i]) * 1099511628211ULL;
+	}
+	return ret;
+}
+
+uint64_t CertificateRevocationList::hashSerial(const BIGNUM *serial)
+{
+	/* the magnitude as BN_to_ASN1_INTEGER stores it: big-endian, zero as a single byte */
+	unsigned char buffer[64];
+	std::vector<unsigned char> large;
+	unsigned char *data = buffer;
+	uint64_t ret = 14695981039346656037ULL;
+	int length;
+
+	ret = (ret ^ (BN_is_negative(serial) ? 1 : 0)) * 1099511628211ULL;
+	length = BN_num_bytes(serial);
+	if (length > (int) sizeof(buffer))
+	{
+		large.resize(length);
+		data = &large[0];
+	}
+	length = BN_bn2bin(serial, data);
+	if (length == 0)
+	{
+		data[0] = 0;
+		length = 1;
+	}
+	for (int i = 0; i < length; i++)
+	{
+		ret = (ret ^ data[i]) * 1099511628211ULL;
+	}
+	return ret;
+}
+
 bool CertificateRevocationList::verify(PublicKey &publicKey)
 {
 	int rc;
@@ -350,6 +583,19 @@ bool CertificateRevocationList::verify(PublicKey &publicKey)
 	return (rc?1:0);
 }
 
+bool CertificateRevocationList::verify(const Certificate &issuer)
+{
+	EVP_PKEY *key;
+	int rc;
+	key = X509_get0_pubkey(issuer.getX509());
+	if (key == NULL)
+	{
+		return false;
+	}
+	rc = X509_CRL_verify(this->crl, key);
+	return (rc == 1);
+}
+
 X509_CRL* CertificateRevocationList::getX509Crl() const
 {
 	return this->crl;
@@ -362,6 +608,9 @@ CertificateRevocationList& CertificateRevocationList::operator =(const Certifica
 		X509_CRL_free(this->crl);
 	}
     this->crl = X509_CRL_dup(value.getX509Crl());
+    this->bloomFilterRate = value.bloomFilterRate;
+    this->bloomFilterMaxBits = value.bloomFilterMaxBits;
+    this->resetSerialIndex();
     return (*this);
 }
 
@@ -1,4 +1,10 @@
 #include <libcryptosec/certificate/CertificateRevocationListBuilder.h>
+#include <libcryptosec/certificate/DerWriter.h>
+
+#include <openssl/objects.h>
+
+/* bloco de entradas codificadas entregue de cada vez ao resumo ou ao fluxo */
+#define REVOKED_CHUNK_SIZE	65536
 
 CertificateRevocationListBuilder::CertificateRevocationListBuilder()
 {
@@ -367,6 +373,177 @@ CertificateRevocationList* CertificateRevocationListBuilder::sign(PrivateKey &pr
     return ret;
 }
 
+unsigned long CertificateRevocationListBuilder::sign(PrivateKey &privateKey, MessageDigest::Algorithm messageDigestAlgorithm,
+		const std::vector<RevokedEntry> &revoked, std::ostream &out)
+		throw (CertificationException, EncodeException)
+{
+	std::string algorithm, head, tail, revokedHeader, tbsHeader, chunk, tbs, signature, header, trailer;
+	unsigned long i, next, entriesLength, tbsLength, total;
+	bool entryExtensions;
+	const unsigned char *serial;
+	unsigned char *p;
+	int length, rc;
+	size_t signatureLength;
+	const EVP_MD *md;
+	EVP_MD_CTX *ctx;
+	const ASN1_TIME *nextUpdate;
+	const STACK_OF(X509_EXTENSION) *extensions;
+	EVP_PKEY *pkey = privateKey.getEvpPkey();
+
+	if (sk_X509_REVOKED_num(X509_CRL_get_REVOKED(this->crl)) > 0)
+	{
+		throw CertificationException(CertificationException::INVALID_CRL, "CertificateRevocationListBuilder::sign");
+	}
+
+	/* primeira passagem: confere as entradas e calcula o tamanho da lista */
+	entriesLength = 0;
+	entryExtensions = false;
+	for (i = 0; i < revoked.size(); i++)
+	{
+		serial = (const unsigned char *) revoked[i].serialNumber.data();
+		if (revoked[i].serialNumber.empty() || (serial[0] & 0x80)
+				|| (revoked[i].serialNumber.size() > 1 && serial[0] == 0 && !(serial[1] & 0x80))
+				|| !RevokedCertificate::isReasonCode(RevokedCertificate::toCrlReason(revoked[i].reasonCode))
+				|| (i > 0 && !(revoked[i - 1] < revoked[i])))
+		{
+			throw EncodeException(EncodeException::DER_ENCODE, "CertificateRevocationListBuilder::sign");
+		}
+		entriesLength += CertificateRevocationListBuilder::encodeRevokedEntry(revoked[i], NULL);
+		if (revoked[i].reasonCode != RevokedCertificate::UNSPECIFIED)
+		{
+			entryExtensions = true;
+		}
+	}
+
+	/* chaves EdDSA ignoram o resumo pedido e assinam o TBSCertList inteiro */
+	md = MessageDigest::getMessageDigest(messageDigestAlgorithm, pkey);
+	if (!DerWriter::encodeSignatureAlgorithm(pkey, md, algorithm))
+	{
+		throw CertificationException(CertificationException::UNSUPPORTED_ASYMMETRIC_KEY_TYPE, "CertificateRevocationListBuilder::sign");
+	}
+
+	/* campos do TBSCertList antes e depois da lista, copiados da estrutura deste builder */
+	extensions = X509_CRL_get0_extensions(this->crl);
+	/* as in sign(): the version follows the content, not setVersion; extensions require v2 */
+	if (sk_X509_EXTENSION_num(extensions) > 0 || entryExtensions)
+	{
+		head.append("\x02\x01\x01", 3);
+	}
+	head += algorithm;
+	length = i2d_X509_NAME(X509_CRL_get_issuer(this->crl), NULL);
+	if (length <= 0)
+	{
+		throw EncodeException(EncodeException::DER_ENCODE, "CertificateRevocationListBuilder::sign");
+	}
+	head.resize(head.size() + length);
+	p = (unsigned char *) &head[head.size() - length];
+	i2d_X509_NAME(X509_CRL_get_issuer(this->crl), &p);
+	length = i2d_ASN1_TIME(X509_CRL_get0_lastUpdate(this->crl), NULL);
+	if (length <= 0)
+	{
+		throw EncodeException(EncodeException::DER_ENCODE, "CertificateRevocationListBuilder::sign");
+	}
+	head.resize(head.size() + length);
+	p = (unsigned char *) &head[head.size() - length];
+	i2d_ASN1_TIME(X509_CRL_get0_lastUpdate(this->crl), &p);
+	nextUpdate = X509_CRL_get0_nextUpdate(this->crl);
+	if (nextUpdate != NULL)
+	{
+		length = i2d_ASN1_TIME(nextUpdate, NULL);
+		head.resize(head.size() + length);
+		p = (unsigned char *) &head[head.size() - length];
+		i2d_ASN1_TIME(nextUpdate, &p);
+	}
+	if (sk_X509_EXTENSION_num(extensions) > 0)
+	{
+		length = i2d_X509_EXTENSIONS((X509_EXTENSIONS *) extensions, NULL);
+		if (length <= 0)
+		{
+			throw EncodeException(EncodeException::DER_ENCODE, "CertificateRevocationListBuilder::sign");
+		}
+		DerWriter::encodeHeader(0xa0, length, tail);
+		tail.resize(tail.size() + length);
+		p = (unsigned char *) &tail[tail.size() - length];
+		i2d_X509_EXTENSIONS((X509_EXTENSIONS *) extensions, &p);
+	}
+	if (!revoked.empty())
+	{
+		DerWriter::encodeHeader(0x30, entriesLength, revokedHeader);
+	}
+	tbsLength = head.size() + revokedHeader.size() + entriesLength + tail.size();
+	DerWriter::encodeHeader(0x30, tbsLength, tbsHeader);
+
+	/* segunda passagem: resumo do TBSCertList; EdDSA assina a mensagem inteira */
+	ctx = EVP_MD_CTX_new();
+	rc = EVP_DigestSignInit(ctx, NULL, md, NULL, pkey);
+	if (md == NULL)
+	{
+		tbs.reserve(tbsHeader.size() + tbsLength);
+		tbs = tbsHeader + head + revokedHeader;
+		for (next = 0; next < revoked.size(); tbs += chunk)
+		{
+			CertificateRevocationListBuilder::encodeRevokedEntries(revoked, next, chunk);
+		}
+		tbs += tail;
+		rc = rc == 1 && EVP_DigestSign(ctx, NULL, &signatureLength, (const unsigned char *) tbs.data(), tbs.size()) == 1;
+		if (rc)
+		{
+			signature.resize(signatureLength);
+			rc = EVP_DigestSign(ctx, (unsigned char *) &signature[0], &signatureLength,
+					(const unsigned char *) tbs.data(), tbs.size()) == 1;
+		}
+		std::string().swap(tbs);
+	}
+	else
+	{
+		rc = rc == 1 && EVP_DigestSignUpdate(ctx, tbsHeader.data(), tbsHeader.size()) == 1
+				&& EVP_DigestSignUpdate(ctx, head.data(), head.size()) == 1
+				&& EVP_DigestSignUpdate(ctx, revokedHeader.data(), revokedHeader.size()) == 1;
+		for (next = 0; rc && next < revoked.size(); )
+		{
+			CertificateRevocationListBuilder::encodeRevokedEntries(revoked, next, chunk);
+			rc = EVP_DigestSignUpdate(ctx, chunk.data(), chunk.size()) == 1;
+		}
+		rc = rc && EVP_DigestSignUpdate(ctx, tail.data(), tail.size()) == 1
+				&& EVP_DigestSignFinal(ctx, NULL, &signatureLength) == 1;
+		if (rc)
+		{
+			signature.resize(signatureLength);
+			rc = EVP_DigestSignFinal(ctx, (unsigned char *) &signature[0], &signatureLength) == 1;
+		}
+	}
+	EVP_MD_CTX_free(ctx);
+	if (!rc)
+	{
+		throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateRevocationListBuilder::sign");
+	}
+	signature.resize(signatureLength);
+
+	/* terceira passagem: escrita, agora que o tamanho da assinatura é conhecido */
+	trailer = algorithm;
+	DerWriter::encodeHeader(0x03, signature.size() + 1, trailer);
+	trailer += '\0';
+	trailer += signature;
+	DerWriter::encodeHeader(0x30, tbsHeader.size() + tbsLength + trailer.size(), header);
+	total = header.size() + tbsHeader.size() + tbsLength + trailer.size();
+	header += tbsHeader;
+	header += head;
+	header += revokedHeader;
+	out.write(header.data(), header.size());
+	for (next = 0; out.good() && next < revoked.size(); )
+	{
+		CertificateRevocationListBuilder::encodeRevokedEntries(revoked, next, chunk);
+		out.write(chunk.data(), chunk.size());
+	}
+	out.write(tail.data(), tail.size());
+	out.write(trailer.data(), trailer.size());
+	if (!out.good())
+	{
+		throw EncodeException(EncodeException::BUFFER_WRITING, "CertificateRevocationListBuilder::sign");
+	}
+	return total;
+}
+
 X509_CRL* CertificateRevocationListBuilder::getX509Crl() const
 {
 	return this->crl;
@@ -570,3 +747,50 @@ std::vector<Extension *> CertificateRevocationListBuilder::getUnknownExtensions(
 	}
 	return ret;
 }
+
+unsigned long CertificateRevocationListBuilder::encodeRevokedEntry(const RevokedEntry &entry, std::string *out)
+{
+	/* crlEntryExtensions com apenas a extensão reasonCode (2.5.29.21), sem o valor do ENUMERATED */
+	static const char reasonCode[] = "\x30\x0c\x30\x0a\x06\x03\x55\x1d\x15\x04\x03\x0a\x01";
+	unsigned long serialLength, timeLength, contentLength;
+	bool utcTime;
+	char date[16];
+
+	serialLength = DerWriter::getHeaderLength(entry.serialNumber.size()) + entry.serialNumber.size();
+	utcTime = DateTime::isUTCTime(entry.revocationDate);
+	/* formata também na passagem que só mede, para que uma data inválida falhe antes de qualquer escrita */
+	DateTime::formatTime(entry.revocationDate, utcTime, date);
+	timeLength = utcTime ? 15 : 17;
+	contentLength = serialLength + timeLength;
+	if (entry.reasonCode != RevokedCertificate::UNSPECIFIED)
+	{
+		/* prefixo e o byte do motivo */
+		contentLength += sizeof(reasonCode) - 1 + 1;
+	}
+	if (out != NULL)
+	{
+		DerWriter::encodeHeader(0x30, contentLength, *out);
+		DerWriter::encodeHeader(0x02, entry.serialNumber.size(), *out);
+		*out += entry.serialNumber;
+		DerWriter::encodeHeader(utcTime ? V_ASN1_UTCTIME : V_ASN1_GENERALIZEDTIME, timeLength - 2, *out);
+		out->append(date, timeLength - 2);
+		if (entry.reasonCode != RevokedCertificate::UNSPECIFIED)
+		{
+			out->append(reasonCode, sizeof(reasonCode) - 1);
+			*out += (char) RevokedCertificate::toCrlReason(entry.reasonCode);
+		}
+	}
+	return DerWriter::getHeaderLength(contentLength) + contentLength;
+}
+
+void CertificateRevocationListBuilder::encodeRevokedEntries(const std::vector<RevokedEntry> &revoked,
+		unsigned long &next, std::string &chunk)
+{
+	chunk.clear();
+	do
+	{
+		CertificateRevocationListBuilder::encodeRevokedEntry(revoked[next], &chunk);
+		next++;
+	}
+	while (next < revoked.size() && chunk.size() < REVOKED_CHUNK_SIZE);
+}
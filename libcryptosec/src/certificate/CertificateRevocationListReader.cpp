@@ -0,0 +1,802 @@
+#include <libcryptosec/certificate/CertificateRevocationListReader.h>
+
+#include <string.h>
+
+#define TAG_BOOLEAN				0x01
+#define TAG_INTEGER				0x02
+#define TAG_BIT_STRING			0x03
+#define TAG_OCTET_STRING		0x04
+#define TAG_OBJECT				0x06
+#define TAG_ENUMERATED			0x0A
+#define TAG_UTC_TIME			0x17
+#define TAG_GENERALIZED_TIME	0x18
+#define TAG_SEQUENCE			0x30
+
+/* tamanho dos blocos lidos do fluxo e descartados de uma vez por skip() */
+#define READ_CHUNK		65536
+/* maior elemento lido inteiro no buffer: uma entrada, o nome do emissor, o algoritmo ou a assinatura */
+#define MAX_ELEMENT_LENGTH	(1024 * 1024)
+
+/* id-ce-cRLReasons (2.5.29.21) */
+static const unsigned char REASON_CODE_OID[] = { 0x55, 0x1D, 0x15 };
+
+BigInteger CertificateRevocationListReader::Entry::getSerialNumberBigInt() const throw (BigIntegerException)
+{
+	ASN1_INTEGER *serial;
+	unsigned char *der;
+	const unsigned char *p;
+	unsigned long length, header, i;
+	BigInteger ret;
+
+	/* reconstrói o TLV para que o OpenSSL trate o sinal */
+	header = 2;
+	for (i = this->serialNumberLength; this->serialNumberLength >= 0x80 && i > 0; i >>= 8)
+	{
+		header++;
+	}
+	length = header + this->serialNumberLength;
+	der = new unsigned char[length];
+	der[0] = TAG_INTEGER;
+	if (header == 2)
+	{
+		der[1] = (unsigned char) this->serialNumberLength;
+	}
+	else
+	{
+		der[1] = 0x80 | (header - 2);
+		for (i = 0; i < header - 2; i++)
+		{
+			der[header - 1 - i] = (this->serialNumberLength >> (8 * i)) & 0xff;
+		}
+	}
+	memcpy(der + header, this->serialNumber, this->serialNumberLength);
+	p = der;
+	serial = d2i_ASN1_INTEGER(NULL, &p, length);
+	delete[] der;
+	if (serial == NULL)
+	{
+		throw BigIntegerException(BigIntegerException::INTERNAL_ERROR, "CertificateRevocationListReader::Entry::getSerialNumberBigInt");
+	}
+	try
+	{
+		ret = BigInteger(serial);
+	}
+	catch (...)
+	{
+		ASN1_INTEGER_free(serial);
+		throw;
+	}
+	ASN1_INTEGER_free(serial);
+	return ret;
+}
+
+CertificateRevocationListReader::CertificateRevocationListReader(std::istream &stream)
+{
+	this->init();
+	this->stream = &stream;
+}
+
+CertificateRevocationListReader::CertificateRevocationListReader(const unsigned char *data, unsigned long length)
+{
+	this->init();
+	this->data = data;
+	this->limit = length;
+}
+
+CertificateRevocationListReader::CertificateRevocationListReader(const MappedFile &file)
+{
+	this->init();
+	this->data = file.getData();
+	this->limit = file.getSize();
+}
+
+CertificateRevocationListReader::~CertificateRevocationListReader()
+{
+	if (this->digest)
+	{
+		EVP_MD_CTX_free(this->digest);
+	}
+	if (this->key)
+	{
+		EVP_PKEY_free(this->key);
+	}
+}
+
+void CertificateRevocationListReader::init()
+{
+	this->stream = NULL;
+	this->data = NULL;
+	this->position = 0;
+	this->limit = 0;
+	this->offset = 0;
+	this->state = CertificateRevocationListReader::START;
+	this->crlEnd = 0;
+	this->tbsBegin = 0;
+	this->tbsEnd = 0;
+	this->entriesEnd = 0;
+	this->count = 0;
+	this->version = 0;
+	this->thisUpdate = 0;
+	this->nextUpdate = 0;
+	this->key = NULL;
+	this->digest = NULL;
+	this->keepTbs = false;
+	this->valid = false;
+}
+
+void CertificateRevocationListReader::setIssuer(const Certificate &issuer) throw (CertificationException)
+{
+	EVP_PKEY *pkey;
+	if (this->state != CertificateRevocationListReader::START)
+	{
+		throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateRevocationListReader::setIssuer");
+	}
+	pkey = X509_get0_pubkey(issuer.getX509());
+	if (pkey == NULL)
+	{
+		throw CertificationException(CertificationException::INVALID_CERTIFICATE, "CertificateRevocationListReader::setIssuer");
+	}
+	/* the reader keeps its own reference, released with the key set by setPublicKey */
+	EVP_PKEY_up_ref(pkey);
+	if (this->key)
+	{
+		EVP_PKEY_free(this->key);
+	}
+	this->key = pkey;
+}
+
+void CertificateRevocationListReader::setPublicKey(PublicKey &publicKey) throw (CertificationException)
+{
+	if (this->state != CertificateRevocationListReader::START)
+	{
+		throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateRevocationListReader::setPublicKey");
+	}
+	if (this->key)
+	{
+		EVP_PKEY_free(this->key);
+	}
+	this->key = publicKey.getEvpPkey();
+	EVP_PKEY_up_ref(this->key);
+}
+
+long CertificateRevocationListReader::getVersion() throw (EncodeException)
+{
+	this->readHeader();
+	return this->version;
+}
+
+RDNSequence CertificateRevocationListReader::getIssuer() throw (EncodeException)
+{
+	const unsigned char *p;
+	X509_NAME *name;
+	RDNSequence ret;
+
+	this->readHeader();
+	p = (const unsigned char *) this->issuer.data();
+	name = d2i_X509_NAME(NULL, &p, this->issuer.size());
+	if (name == NULL)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateRevocationListReader::getIssuer");
+	}
+	ret = RDNSequence(name);
+	X509_NAME_free(name);
+	return ret;
+}
+
+time_t CertificateRevocationListReader::getThisUpdate() throw (EncodeException)
+{
+	this->readHeader();
+	return this->thisUpdate;
+}
+
+time_t CertificateRevocationListReader::getNextUpdate() throw (EncodeException)
+{
+	this->readHeader();
+	return this->nextUpdate;
+}
+
+bool CertificateRevocationListReader::next(CertificateRevocationListReader::Entry &entry) throw (EncodeException)
+{
+	unsigned char tag;
+	unsigned long headerLength, contentLength, total;
+
+	this->readHeader();
+	if (this->state != CertificateRevocationListReader::ENTRIES)
+	{
+		return false;
+	}
+	if (this->offset >= this->entriesEnd)
+	{
+		this->state = CertificateRevocationListReader::TRAILER;
+		return false;
+	}
+	this->peekHeader(0, tag, headerLength, contentLength, "CertificateRevocationListReader::next");
+	total = headerLength + contentLength;
+	if (tag != TAG_SEQUENCE || !this->isWithin(0, total, this->entriesEnd) || !this->fill(total))
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateRevocationListReader::next");
+	}
+	/* consume() não move o buffer, então a entrada pode apontar para ele */
+	this->readEntry(this->data + this->position + headerLength, this->data + this->position + total, entry);
+	this->consume(total);
+	this->count++;
+	return true;
+}
+
+unsigned long CertificateRevocationListReader::read(CertificateRevocationListReader::Handler &handler) throw (EncodeException)
+{
+	CertificateRevocationListReader::Entry entry;
+	unsigned long ret = 0;
+	while (this->next(entry))
+	{
+		ret++;
+		if (!handler.revoked(entry))
+		{
+			break;
+		}
+	}
+	return ret;
+}
+
+unsigned long CertificateRevocationListReader::write(DocumentWriter &writer) throw (EncodeException)
+{
+	CertificateRevocationListReader::Entry entry;
+	unsigned long ret = 0;
+	BIGNUM *serial;
+	X509_NAME *issuer;
+	const unsigned char *p;
+	char *decimal;
+
+	this->readHeader();
+	p = (const unsigned char *) this->issuer.data();
+	issuer = d2i_X509_NAME(NULL, &p, this->issuer.size());
+	if (issuer == NULL)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateRevocationListReader::write");
+	}
+	writer.begin("certificateRevocationList");
+	writer.begin("tbsCertList");
+	writer.write("version", this->version);
+	RDNSequence::write(writer, "issuer", issuer);
+	X509_NAME_free(issuer);
+	writer.writeTime("thisUpdate", this->thisUpdate);
+	if (this->nextUpdate != 0)
+	{
+		writer.writeTime("nextUpdate", this->nextUpdate);
+	}
+	writer.beginList("revokedCertificates");
+	serial = BN_new();
+	try
+	{
+		while (this->next(entry))
+		{
+			writer.begin("revokedCertificate");
+			/* the common positive serials skip the TLV rebuilt by getSerialNumberBigInt() */
+			if (entry.serialNumberLength > 0 && !(entry.serialNumber[0] & 0x80)
+					&& BN_bin2bn(entry.serialNumber, entry.serialNumberLength, serial) != NULL
+					&& (decimal = BN_bn2dec(serial)) != NULL)
+			{
+				writer.write("certificateSerialNumber", decimal);
+				OPENSSL_free(decimal);
+			}
+			else
+			{
+				try
+				{
+					writer.write("certificateSerialNumber", entry.getSerialNumberBigInt().toDec());
+				}
+				catch (BigIntegerException &ex)
+				{
+					throw EncodeException(EncodeException::DER_DECODE, "CertificateRevocationListReader::write");
+				}
+			}
+			writer.writeTime("revocationDate", entry.revocationDate);
+			if (entry.reasonCode != RevokedCertificate::UNSPECIFIED)
+			{
+				writer.write("reason", RevokedCertificate::reasonCode2Name(entry.reasonCode));
+			}
+			writer.end();
+			ret++;
+		}
+	}
+	catch (...)
+	{
+		BN_free(serial);
+		throw;
+	}
+	BN_free(serial);
+	writer.end();
+	writer.end();
+	writer.end();
+	return ret;
+}
+
+bool CertificateRevocationListReader::verify() throw (EncodeException)
+{
+	this->readHeader();
+	this->readTrailer();
+	return this->valid;
+}
+
+unsigned long CertificateRevocationListReader::getCount() const
+{
+	return this->count;
+}
+
+bool CertificateRevocationListReader::getSerialNumberContent(const BigInteger &serialNumber, std::string &content)
+{
+	ASN1_INTEGER *serial;
+	unsigned char *der = NULL;
+	unsigned long header;
+	int length;
+
+	try
+	{
+		serial = serialNumber.getASN1Value();
+	}
+	catch (...)
+	{
+		return false;
+	}
+	length = i2d_ASN1_INTEGER(serial, &der);
+	ASN1_INTEGER_free(serial);
+	if (length < 2)
+	{
+		OPENSSL_free(der);
+		return false;
+	}
+	header = (der[1] < 0x80) ? 2 : 2 + (der[1] & 0x7f);
+	content.assign((const char *) der + header, length - header);
+	OPENSSL_free(der);
+	return true;
+}
+
+void CertificateRevocationListReader::readHeader() throw (EncodeException)
+{
+	unsigned char tag;
+	unsigned long headerLength, contentLength, at;
+	const char *where = "CertificateRevocationListReader::readHeader";
+
+	if (this->state != CertificateRevocationListReader::START)
+	{
+		return;
+	}
+
+	/* CertificateList e TBSCertList: só os cabeçalhos, o conteúdo vem em seguida */
+	this->peekHeader(0, tag, headerLength, contentLength, where);
+	if (tag != TAG_SEQUENCE)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, where);
+	}
+	this->crlEnd = this->offset + headerLength + contentLength;
+	at = headerLength;
+	/* os tamanhos vêm da entrada: cada elemento deve caber no que o contém antes de ser lido */
+	this->peekHeader(at, tag, headerLength, contentLength, where);
+	if (tag != TAG_SEQUENCE || headerLength > this->crlEnd - (this->offset + at)
+			|| contentLength > this->crlEnd - (this->offset + at) - headerLength)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, where);
+	}
+	this->tbsBegin = this->offset + at;
+	this->tbsEnd = this->tbsBegin + headerLength + contentLength;
+	at += headerLength;
+
+	this->peekHeader(at, tag, headerLength, contentLength, where);
+	if (tag == TAG_INTEGER)
+	{
+		if (contentLength != 1 || !this->isWithin(at, headerLength + 1, this->tbsEnd) || !this->fill(at + headerLength + 1))
+		{
+			throw EncodeException(EncodeException::DER_DECODE, where);
+		}
+		this->version = this->data[this->position + at + headerLength];
+		at += headerLength + contentLength;
+		this->peekHeader(at, tag, headerLength, contentLength, where);
+	}
+
+	/* o algoritmo de assinatura define o resumo antes do primeiro byte resumido */
+	if (tag != TAG_SEQUENCE || !this->isWithin(at, headerLength + contentLength, this->tbsEnd)
+			|| !this->fill(at + headerLength + contentLength))
+	{
+		throw EncodeException(EncodeException::DER_DECODE, where);
+	}
+	this->startDigest(this->data + this->position + at, headerLength + contentLength);
+	this->consume(at + headerLength + contentLength);
+
+	this->peekHeader(0, tag, headerLength, contentLength, where);
+	if (tag != TAG_SEQUENCE || !this->isWithin(0, headerLength + contentLength, this->tbsEnd)
+			|| !this->fill(headerLength + contentLength))
+	{
+		throw EncodeException(EncodeException::DER_DECODE, where);
+	}
+	this->issuer.assign((const char *) this->data + this->position, headerLength + contentLength);
+	this->consume(headerLength + contentLength);
+
+	this->peekHeader(0, tag, headerLength, contentLength, where);
+	if (!this->isWithin(0, headerLength + contentLength, this->tbsEnd) || !this->fill(headerLength + contentLength)
+			|| !CertificateRevocationListReader::readTime(this->data + this->position + headerLength, tag, contentLength, this->thisUpdate))
+	{
+		throw EncodeException(EncodeException::DER_DECODE, where);
+	}
+	this->consume(headerLength + contentLength);
+
+	if (this->offset < this->tbsEnd)
+	{
+		this->peekHeader(0, tag, headerLength, contentLength, where);
+		if (tag == TAG_UTC_TIME || tag == TAG_GENERALIZED_TIME)
+		{
+			if (!this->isWithin(0, headerLength + contentLength, this->tbsEnd) || !this->fill(headerLength + contentLength)
+					|| !CertificateRevocationListReader::readTime(this->data + this->position + headerLength, tag, contentLength, this->nextUpdate))
+			{
+				throw EncodeException(EncodeException::DER_DECODE, where);
+			}
+			this->consume(headerLength + contentLength);
+		}
+	}
+
+	this->entriesEnd = this->offset;
+	if (this->offset < this->tbsEnd)
+	{
+		this->peekHeader(0, tag, headerLength, contentLength, where);
+		if (tag == TAG_SEQUENCE)
+		{
+			if (headerLength > this->tbsEnd - this->offset || contentLength > this->tbsEnd - this->offset - headerLength)
+			{
+				throw EncodeException(EncodeException::DER_DECODE, where);
+			}
+			this->consume(headerLength);
+			this->entriesEnd = this->offset + contentLength;
+		}
+	}
+	if (this->offset > this->tbsEnd || this->entriesEnd > this->tbsEnd)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, where);
+	}
+	this->state = CertificateRevocationListReader::ENTRIES;
+}
+
+void CertificateRevocationListReader::readTrailer() throw (EncodeException)
+{
+	unsigned char tag;
+	unsigned long headerLength, contentLength;
+	const unsigned char *p;
+	const char *where = "CertificateRevocationListReader::readTrailer";
+	X509_ALGOR *algorithm;
+	ASN1_BIT_STRING *signature;
+	X509_CRL_INFO *info;
+	bool matches;
+
+	if (this->state == CertificateRevocationListReader::DONE)
+	{
+		return;
+	}
+	/* entradas restantes e extensões da LCR só passam pelo resumo */
+	this->skip(this->tbsEnd - this->offset);
+
+	this->peekHeader(0, tag, headerLength, contentLength, where);
+	if (tag != TAG_SEQUENCE || !this->isWithin(0, headerLength + contentLength, this->crlEnd)
+			|| !this->fill(headerLength + contentLength))
+	{
+		throw EncodeException(EncodeException::DER_DECODE, where);
+	}
+	/* RFC 5280: o algoritmo externo deve ser igual ao do TBSCertList */
+	matches = (this->signatureAlgorithm.compare(0, std::string::npos,
+			(const char *) this->data + this->position, headerLength + contentLength) == 0);
+	this->consume(headerLength + contentLength);
+
+	this->peekHeader(0, tag, headerLength, contentLength, where);
+	if (tag != TAG_BIT_STRING || contentLength < 1 || !this->isWithin(0, headerLength + contentLength, this->crlEnd)
+			|| !this->fill(headerLength + contentLength))
+	{
+		throw EncodeException(EncodeException::DER_DECODE, where);
+	}
+	p = this->data + this->position;
+	if (!matches || this->key == NULL)
+	{
+		this->valid = false;
+	}
+	else if (this->digest && p[headerLength] == 0)
+	{
+		this->valid = (EVP_DigestVerifyFinal(this->digest, p + headerLength + 1, contentLength - 1) == 1);
+	}
+	else if (this->keepTbs)
+	{
+		signature = d2i_ASN1_BIT_STRING(NULL, &p, headerLength + contentLength);
+		p = (const unsigned char *) this->signatureAlgorithm.data();
+		algorithm = d2i_X509_ALGOR(NULL, &p, this->signatureAlgorithm.size());
+		p = (const unsigned char *) this->tbs.data();
+		info = d2i_X509_CRL_INFO(NULL, &p, this->tbs.size());
+		if (signature && algorithm && info)
+		{
+			this->valid = (ASN1_item_verify(ASN1_ITEM_rptr(X509_CRL_INFO), algorithm, signature, info, this->key) == 1);
+		}
+		ASN1_BIT_STRING_free(signature);
+		X509_ALGOR_free(algorithm);
+		X509_CRL_INFO_free(info);
+		this->tbs.clear();
+	}
+	this->consume(headerLength + contentLength);
+	this->state = CertificateRevocationListReader::DONE;
+}
+
+void CertificateRevocationListReader::startDigest(const unsigned char *algorithm, unsigned long length)
+{
+	const unsigned char *p;
+	const ASN1_OBJECT *object;
+	const EVP_MD *md;
+	X509_ALGOR *alg;
+	int mdNid, pkeyNid;
+
+	this->signatureAlgorithm.assign((const char *) algorithm, length);
+	if (this->key == NULL)
+	{
+		return;
+	}
+	p = algorithm;
+	alg = d2i_X509_ALGOR(NULL, &p, length);
+	if (alg == NULL)
+	{
+		return;
+	}
+	X509_ALGOR_get0(&object, NULL, NULL, alg);
+	if (OBJ_find_sigid_algs(OBJ_obj2nid(object), &mdNid, &pkeyNid))
+	{
+		if (mdNid == NID_undef)
+		{
+			/* o próprio método da chave trata os parâmetros (PSS) ou assina a mensagem inteira */
+			this->keepTbs = true;
+		}
+		else if (EVP_PKEY_type(pkeyNid) == EVP_PKEY_base_id(this->key)
+				&& (md = EVP_get_digestbynid(mdNid)) != NULL)
+		{
+			this->digest = EVP_MD_CTX_new();
+			if (EVP_DigestVerifyInit(this->digest, NULL, md, NULL, this->key) != 1)
+			{
+				EVP_MD_CTX_free(this->digest);
+				this->digest = NULL;
+			}
+		}
+	}
+	X509_ALGOR_free(alg);
+}
+
+bool CertificateRevocationListReader::fill(unsigned long length) throw (EncodeException)
+{
+	unsigned long size;
+
+	if (this->limit - this->position >= length)
+	{
+		return true;
+	}
+	if (this->stream == NULL)
+	{
+		return false;
+	}
+	if (this->position > 0)
+	{
+		memmove(&this->buffer[0], &this->buffer[this->position], this->limit - this->position);
+		this->limit -= this->position;
+		this->position = 0;
+	}
+	size = (length > READ_CHUNK) ? length : READ_CHUNK;
+	if (this->buffer.size() < size)
+	{
+		this->buffer.resize(size);
+	}
+	while (this->limit < length && this->stream->good())
+	{
+		this->stream->read((char *) &this->buffer[this->limit], this->buffer.size() - this->limit);
+		this->limit += this->stream->gcount();
+	}
+	if (this->stream->bad())
+	{
+		throw EncodeException(EncodeException::BUFFER_READING, "CertificateRevocationListReader::fill");
+	}
+	this->data = &this->buffer[0];
+	return (this->limit >= length);
+}
+
+bool CertificateRevocationListReader::isWithin(unsigned long at, unsigned long length, unsigned long end) const
+{
+	unsigned long start = this->offset + at;
+	return (start <= end && length <= end - start && length <= MAX_ELEMENT_LENGTH);
+}
+
+void CertificateRevocationListReader::peekHeader(unsigned long at, unsigned char &tag,
+		unsigned long &headerLength, unsigned long &contentLength, const char *where) throw (EncodeException)
+{
+	const unsigned char *p;
+	unsigned long count;
+
+	if (!this->fill(at + 2))
+	{
+		throw EncodeException(EncodeException::DER_DECODE, where);
+	}
+	count = this->data[this->position + at + 1];
+	count = (count & 0x80) ? (count & 0x7f) : 0;
+	if (!this->fill(at + 2 + count))
+	{
+		throw EncodeException(EncodeException::DER_DECODE, where);
+	}
+	p = this->data + this->position + at;
+	if (!CertificateRevocationListReader::readHeader(p, this->data + this->limit, tag, headerLength, contentLength))
+	{
+		throw EncodeException(EncodeException::DER_DECODE, where);
+	}
+}
+
+void CertificateRevocationListReader::consume(unsigned long length) throw (EncodeException)
+{
+	unsigned long from, to;
+	const unsigned char *p;
+
+	if ((this->digest || this->keepTbs)
+			&& this->offset < this->tbsEnd && this->offset + length > this->tbsBegin)
+	{
+		from = (this->offset > this->tbsBegin) ? this->offset : this->tbsBegin;
+		to = (this->offset + length < this->tbsEnd) ? this->offset + length : this->tbsEnd;
+		p = this->data + this->position + (from - this->offset);
+		if (this->digest && EVP_DigestVerifyUpdate(this->digest, p, to - from) != 1)
+		{
+			EVP_MD_CTX_free(this->digest);
+			this->digest = NULL;
+		}
+		if (this->keepTbs)
+		{
+			this->tbs.append((const char *) p, to - from);
+		}
+	}
+	this->position += length;
+	this->offset += length;
+}
+
+void CertificateRevocationListReader::skip(unsigned long length) throw (EncodeException)
+{
+	unsigned long chunk;
+	while (length > 0)
+	{
+		chunk = (length > READ_CHUNK) ? READ_CHUNK : length;
+		if (!this->fill(chunk))
+		{
+			throw EncodeException(EncodeException::DER_DECODE, "CertificateRevocationListReader::skip");
+		}
+		this->consume(chunk);
+		length -= chunk;
+	}
+}
+
+void CertificateRevocationListReader::readEntry(const unsigned char *p, const unsigned char *end,
+		CertificateRevocationListReader::Entry &entry) throw (EncodeException)
+{
+	unsigned char tag;
+	unsigned long headerLength, contentLength;
+	const unsigned char *extension, *extensionEnd, *value;
+	bool reasonCode, critical;
+	const char *where = "CertificateRevocationListReader::readEntry";
+
+	if (!CertificateRevocationListReader::readHeader(p, end, tag, headerLength, contentLength)
+			|| tag != TAG_INTEGER || contentLength == 0 || contentLength > (unsigned long) (end - p) - headerLength)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, where);
+	}
+	entry.serialNumber = p + headerLength;
+	entry.serialNumberLength = contentLength;
+	p += headerLength + contentLength;
+
+	if (!CertificateRevocationListReader::readHeader(p, end, tag, headerLength, contentLength)
+			|| contentLength > (unsigned long) (end - p) - headerLength
+			|| !CertificateRevocationListReader::readTime(p + headerLength, tag, contentLength, entry.revocationDate))
+	{
+		throw EncodeException(EncodeException::DER_DECODE, where);
+	}
+	p += headerLength + contentLength;
+
+	entry.reasonCode = RevokedCertificate::UNSPECIFIED;
+	entry.removeFromCrl = false;
+	if (p == end)
+	{
+		return;
+	}
+	if (!CertificateRevocationListReader::readHeader(p, end, tag, headerLength, contentLength)
+			|| tag != TAG_SEQUENCE || contentLength != (unsigned long) (end - p) - headerLength)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, where);
+	}
+	p += headerLength;
+	while (p < end)
+	{
+		if (!CertificateRevocationListReader::readHeader(p, end, tag, headerLength, contentLength)
+				|| tag != TAG_SEQUENCE || contentLength > (unsigned long) (end - p) - headerLength)
+		{
+			throw EncodeException(EncodeException::DER_DECODE, where);
+		}
+		extension = p + headerLength;
+		extensionEnd = extension + contentLength;
+		p = extensionEnd;
+		if (!CertificateRevocationListReader::readHeader(extension, extensionEnd, tag, headerLength, contentLength)
+				|| tag != TAG_OBJECT || contentLength > (unsigned long) (extensionEnd - extension) - headerLength)
+		{
+			throw EncodeException(EncodeException::DER_DECODE, where);
+		}
+		reasonCode = (contentLength == sizeof(REASON_CODE_OID)
+				&& memcmp(extension + headerLength, REASON_CODE_OID, sizeof(REASON_CODE_OID)) == 0);
+		value = extension + headerLength + contentLength;
+		critical = false;
+		if (CertificateRevocationListReader::readHeader(value, extensionEnd, tag, headerLength, contentLength)
+				&& tag == TAG_BOOLEAN)
+		{
+			if (contentLength != 1 || headerLength + contentLength > (unsigned long) (extensionEnd - value))
+			{
+				throw EncodeException(EncodeException::DER_DECODE, where);
+			}
+			critical = (value[headerLength] != 0);
+			value += headerLength + contentLength;
+		}
+		if (!reasonCode)
+		{
+			/* RFC 5280, 5.3: a CRL with an unrecognized critical entry extension must be rejected */
+			if (critical)
+			{
+				throw EncodeException(EncodeException::DER_DECODE, where);
+			}
+			continue;
+		}
+		/* extnValue: OCTET STRING com o ENUMERATED do motivo; valores fora da RFC viram UNSPECIFIED */
+		if (extensionEnd - value != 5 || value[0] != TAG_OCTET_STRING || value[1] != 3
+				|| value[2] != TAG_ENUMERATED || value[3] != 1)
+		{
+			throw EncodeException(EncodeException::DER_DECODE, where);
+		}
+		entry.reasonCode = RevokedCertificate::fromCrlReason(value[4]);
+		entry.removeFromCrl = (value[4] == CRL_REASON_REMOVE_FROM_CRL);
+	}
+}
+
+bool CertificateRevocationListReader::readHeader(const unsigned char *p, const unsigned char *end,
+		unsigned char &tag, unsigned long &headerLength, unsigned long &contentLength)
+{
+	unsigned long count, i;
+
+	if (p >= end || end - p < 2)
+	{
+		return false;
+	}
+	tag = p[0];
+	if ((tag & 0x1f) == 0x1f)
+	{
+		return false;
+	}
+	if (p[1] < 0x80)
+	{
+		headerLength = 2;
+		contentLength = p[1];
+		return true;
+	}
+	/* DER forbids the indefinite form (0x80) */
+	count = p[1] & 0x7f;
+	if (count == 0 || count > 4 || (unsigned long) (end - p) < 2 + count)
+	{
+		return false;
+	}
+	contentLength = 0;
+	for (i = 0; i < count; i++)
+	{
+		contentLength = (contentLength << 8) | p[2 + i];
+	}
+	headerLength = 2 + count;
+	/* headerLength + contentLength não pode estourar, nem com unsigned long de 32 bits */
+	return (contentLength <= (unsigned long) -1 - headerLength);
+}
+
+bool CertificateRevocationListReader::readTime(const unsigned char *p, unsigned char tag, unsigned long length, time_t &time)
+{
+	long long epoch;
+
+	if ((tag == TAG_UTC_TIME && length != 13) || (tag == TAG_GENERALIZED_TIME && length != 15)
+			|| (tag != TAG_UTC_TIME && tag != TAG_GENERALIZED_TIME)
+			|| !DateTime::parseTime((const char *) p, length, epoch))
+	{
+		return false;
+	}
+	time = (time_t) epoch;
+	return true;
+}
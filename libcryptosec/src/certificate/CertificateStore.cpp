@@ -0,0 +1,755 @@
+#include <libcryptosec/certificate/CertificateStore.h>
+
+#include <dirent.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <openssl/sha.h>
+
+/* minimum number of certificates worth a thread of its own */
+#define CERTIFICATES_PER_THREAD 64
+
+CRYPTO_ONCE CertificateStore::identifiersOnce = CRYPTO_ONCE_STATIC_INIT;
+CRYPTO_RWLOCK *CertificateStore::identifiersLock = NULL;
+unsigned long CertificateStore::nextIdentifier = 1;
+
+CertificateStore::CertificateStore()
+{
+	CRYPTO_THREAD_run_once(&CertificateStore::identifiersOnce, CertificateStore::initIdentifiers);
+	CRYPTO_THREAD_write_lock(CertificateStore::identifiersLock);
+	this->identifier = CertificateStore::nextIdentifier++;
+	CRYPTO_THREAD_unlock(CertificateStore::identifiersLock);
+	this->threads = 0;
+	this->deduplicate = false;
+	this->snapshot = new Snapshot();
+	this->snapshot->generation = 0;
+	this->lock = CRYPTO_THREAD_lock_new();
+	this->writeLock = CRYPTO_THREAD_lock_new();
+}
+
+CertificateStore::~CertificateStore()
+{
+	CertificateStore::freeSnapshot(this->snapshot);
+	CRYPTO_THREAD_lock_free(this->lock);
+	CRYPTO_THREAD_lock_free(this->writeLock);
+}
+
+void CertificateStore::setThreads(unsigned int threads)
+{
+	this->threads = threads;
+}
+
+void CertificateStore::setDeduplicate(bool deduplicate)
+{
+	this->deduplicate = deduplicate;
+}
+
+unsigned int CertificateStore::loadPemBundle(std::string path) throw (EncodeException)
+{
+	std::vector<Block> blocks;
+	MappedFile file(path);
+	CertificateStore::scanPem(file.getData(), file.getSize(), blocks);
+	/* the blocks point into the mapped file, which must outlive the decoding */
+	return this->load(blocks);
+}
+
+unsigned int CertificateStore::loadDirectory(std::string path) throw (EncodeException)
+{
+	std::vector<MappedFile *> files;
+	std::vector<Block> blocks;
+	std::vector<std::string> names;
+	struct dirent *entry;
+	struct stat st;
+	std::string name;
+	unsigned int ret;
+	DIR *dir;
+
+	dir = opendir(path.c_str());
+	if (dir == NULL)
+	{
+		throw EncodeException(EncodeException::BUFFER_READING, "CertificateStore::loadDirectory");
+	}
+	while ((entry = readdir(dir)) != NULL)
+	{
+		name = path + "/" + entry->d_name;
+		if (entry->d_name[0] != '.' && stat(name.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+		{
+			names.push_back(name);
+		}
+	}
+	closedir(dir);
+
+	try
+	{
+		for (unsigned int i = 0; i < names.size(); i++)
+		{
+			files.push_back(new MappedFile(names[i]));
+			const unsigned char *data = files.back()->getData();
+			unsigned long size = files.back()->getSize();
+			if (size == 0)
+			{
+				continue;
+			}
+			/* the first byte cannot tell them apart: 0x30 is also '0' in a text file */
+			if (memmem(data, size, "-----BEGIN ", 11) != NULL)
+			{
+				CertificateStore::scanPem(data, size, blocks);
+			}
+			else
+			{
+				CertificateStore::scanDer(data, size, blocks);
+			}
+		}
+		ret = this->load(blocks);
+	}
+	catch (...)
+	{
+		for (unsigned int i = 0; i < files.size(); i++)
+		{
+			delete files[i];
+		}
+		throw;
+	}
+	for (unsigned int i = 0; i < files.size(); i++)
+	{
+		delete files[i];
+	}
+	return ret;
+}
+
+bool CertificateStore::addCertificate(const Certificate &certificate)
+{
+	std::vector<Certificate> certificates(1, certificate);
+	return (this->addCertificates(certificates) == 1);
+}
+
+unsigned int CertificateStore::addCertificates(const std::vector<Certificate> &certificates)
+{
+	std::vector<std::string> fingerprints;
+	std::vector<X509 *> certs;
+	std::string fingerprint;
+	X509 *cert;
+
+	for (unsigned int i = 0; i < certificates.size(); i++)
+	{
+		cert = certificates[i].getX509();
+		if (CertificateStore::getFingerPrint(cert, fingerprint))
+		{
+			X509_up_ref(cert);
+			certs.push_back(cert);
+			fingerprints.push_back(fingerprint);
+		}
+	}
+	if (certs.empty())
+	{
+		return 0;
+	}
+	return this->publish(certs, fingerprints);
+}
+
+unsigned int CertificateStore::size() const
+{
+	unsigned int ret;
+	CRYPTO_THREAD_read_lock(this->lock);
+	ret = this->snapshot->certificates.size();
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+std::vector<Certificate *> CertificateStore::getCertificates() const
+{
+	std::vector<Certificate *> ret;
+	CRYPTO_THREAD_read_lock(this->lock);
+	ret = CertificateStore::toCertificates(this->snapshot->certificates);
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+unsigned long CertificateStore::getGeneration() const
+{
+	unsigned long ret;
+	CRYPTO_THREAD_read_lock(this->lock);
+	ret = this->snapshot->generation;
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+unsigned long CertificateStore::getIdentifier() const
+{
+	return this->identifier;
+}
+
+void CertificateStore::initIdentifiers()
+{
+	CertificateStore::identifiersLock = CRYPTO_THREAD_lock_new();
+}
+
+bool CertificateStore::contains(const Certificate &certificate) const
+{
+	std::string fingerprint;
+	bool ret;
+
+	if (!CertificateStore::getFingerPrint(certificate.getX509(), fingerprint))
+	{
+		return false;
+	}
+	CRYPTO_THREAD_read_lock(this->lock);
+	ret = (this->snapshot->byFingerprint.count(fingerprint) > 0);
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+std::vector<Certificate *> CertificateStore::findBySubject(RDNSequence &subject) const
+{
+	std::vector<Certificate *> ret;
+	std::vector<X509 *> found;
+	X509_NAME *name;
+
+	name = subject.getX509Name();
+	CRYPTO_THREAD_read_lock(this->lock);
+	this->findBySubject(this->snapshot, name, found);
+	ret = CertificateStore::toCertificates(found);
+	CRYPTO_THREAD_unlock(this->lock);
+	X509_NAME_free(name);
+	return ret;
+}
+
+std::vector<Certificate *> CertificateStore::findByKeyIdentifier(ByteArray &keyIdentifier) const
+{
+	std::multimap<std::string, X509 *>::const_iterator it, end;
+	std::vector<Certificate *> ret;
+	std::vector<X509 *> found;
+	std::string key;
+
+	key.assign((const char *) keyIdentifier.getDataPointer(), keyIdentifier.size());
+	CRYPTO_THREAD_read_lock(this->lock);
+	end = this->snapshot->byKeyIdentifier.upper_bound(key);
+	for (it = this->snapshot->byKeyIdentifier.lower_bound(key); it != end; it++)
+	{
+		found.push_back(it->second);
+	}
+	ret = CertificateStore::toCertificates(found);
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+Certificate* CertificateStore::findByIssuerAndSerial(RDNSequence &issuer, const BigInteger &serialNumber) const
+{
+	std::multimap<std::string, X509 *>::const_iterator it, end;
+	ASN1_INTEGER *serial;
+	Certificate *ret = NULL;
+	X509_NAME *name;
+	std::string key;
+
+	name = issuer.getX509Name();
+	serial = serialNumber.getASN1Value();
+	key = CertificateStore::getIssuerSerialKey(name, serial);
+	CRYPTO_THREAD_read_lock(this->lock);
+	end = this->snapshot->byIssuerSerial.upper_bound(key);
+	for (it = this->snapshot->byIssuerSerial.lower_bound(key); it != end && ret == NULL; it++)
+	{
+		/* the key holds only a hash of the name */
+		if (X509_NAME_cmp(X509_get_issuer_name(it->second), name) == 0)
+		{
+			X509_up_ref(it->second);
+			ret = new Certificate(it->second);
+		}
+	}
+	CRYPTO_THREAD_unlock(this->lock);
+	ASN1_INTEGER_free(serial);
+	X509_NAME_free(name);
+	return ret;
+}
+
+Certificate* CertificateStore::findByFingerPrint(ByteArray &fingerprint) const
+{
+	std::map<std::string, X509 *>::const_iterator it;
+	Certificate *ret = NULL;
+	std::string key;
+
+	key.assign((const char *) fingerprint.getDataPointer(), fingerprint.size());
+	CRYPTO_THREAD_read_lock(this->lock);
+	it = this->snapshot->byFingerprint.find(key);
+	if (it != this->snapshot->byFingerprint.end())
+	{
+		X509_up_ref(it->second);
+		ret = new Certificate(it->second);
+	}
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+std::vector<Certificate *> CertificateStore::findIssuers(const Certificate &certificate) const
+{
+	std::vector<Certificate *> ret;
+	std::vector<X509 *> found;
+	CRYPTO_THREAD_read_lock(this->lock);
+	this->findIssuers(this->snapshot, certificate.getX509(), found);
+	ret = CertificateStore::toCertificates(found);
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+STACK_OF(X509)* CertificateStore::getX509BySubject(X509_NAME *name) const
+{
+	STACK_OF(X509) *ret = NULL;
+	std::vector<X509 *> found;
+
+	CRYPTO_THREAD_read_lock(this->lock);
+	this->findBySubject(this->snapshot, name, found);
+	if (!found.empty())
+	{
+		ret = sk_X509_new_null();
+		for (unsigned int i = 0; i < found.size(); i++)
+		{
+			X509_up_ref(found[i]);
+			sk_X509_push(ret, found[i]);
+		}
+	}
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+STACK_OF(X509)* CertificateStore::getX509Issuers(X509 *cert) const
+{
+	STACK_OF(X509) *ret = NULL;
+	std::vector<X509 *> found;
+
+	CRYPTO_THREAD_read_lock(this->lock);
+	this->findIssuers(this->snapshot, cert, found);
+	if (!found.empty())
+	{
+		ret = sk_X509_new_null();
+		for (unsigned int i = 0; i < found.size(); i++)
+		{
+			X509_up_ref(found[i]);
+			sk_X509_push(ret, found[i]);
+		}
+	}
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+unsigned int CertificateStore::load(const std::vector<Block> &blocks) throw (EncodeException)
+{
+	std::vector<X509 *> decoded(blocks.size(), (X509 *) NULL);
+	std::vector<std::string> fingerprints(blocks.size());
+	std::vector<DecodeTask> tasks;
+	std::vector<pthread_t> workers;
+	unsigned int count, chunk, i;
+	bool failed = false;
+	pthread_t worker;
+
+	if (blocks.empty())
+	{
+		return 0;
+	}
+
+	/* contiguous slices keep the bundle order in the results */
+	count = this->getThreadCount(blocks.size());
+	chunk = (blocks.size() + count - 1) / count;
+	tasks.resize(count);
+	for (i = 0; i < count; i++)
+	{
+		tasks[i].blocks = &blocks;
+		tasks[i].begin = i * chunk;
+		tasks[i].end = (i + 1) * chunk < blocks.size() ? (i + 1) * chunk : blocks.size();
+		tasks[i].certificates = &decoded;
+		tasks[i].fingerprints = &fingerprints;
+		tasks[i].failed = false;
+	}
+	/* the calling thread decodes the first slice itself */
+	for (i = 1; i < count; i++)
+	{
+		if (pthread_create(&worker, NULL, CertificateStore::decode, &tasks[i]) == 0)
+		{
+			workers.push_back(worker);
+		}
+		else
+		{
+			CertificateStore::decode(&tasks[i]);
+		}
+	}
+	CertificateStore::decode(&tasks[0]);
+	for (i = 0; i < workers.size(); i++)
+	{
+		pthread_join(workers[i], NULL);
+	}
+	for (i = 0; i < count; i++)
+	{
+		failed = failed || tasks[i].failed;
+	}
+
+	if (failed)
+	{
+		for (i = 0; i < decoded.size(); i++)
+		{
+			X509_free(decoded[i]);
+		}
+		throw EncodeException(EncodeException::PEM_DECODE, "CertificateStore::load");
+	}
+
+	return this->publish(decoded, fingerprints);
+}
+
+unsigned int CertificateStore::getThreadCount(unsigned int jobs) const
+{
+	unsigned int ret;
+	long cpus;
+
+	ret = this->threads;
+	if (ret == 0)
+	{
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		ret = (cpus > 0) ? cpus : 1;
+	}
+	if (ret > jobs / CERTIFICATES_PER_THREAD)
+	{
+		ret = jobs / CERTIFICATES_PER_THREAD;
+	}
+	return (ret > 0) ? ret : 1;
+}
+
+void CertificateStore::scanPem(const unsigned char *data, unsigned long length, std::vector<Block> &blocks) throw (EncodeException)
+{
+	static const char begin[] = "-----BEGIN ";
+	static const char end[] = "-----END ";
+	const unsigned char *p, *limit, *label, *body, *footer;
+	unsigned long labelLength;
+	Block block;
+
+	if (data == NULL)
+	{
+		return;
+	}
+	p = data;
+	limit = data + length;
+	while ((p = (const unsigned char *) memmem(p, limit - p, begin, sizeof(begin) - 1)) != NULL)
+	{
+		label = p + sizeof(begin) - 1;
+		p = (const unsigned char *) memmem(label, limit - label, "-----", 5);
+		if (p == NULL)
+		{
+			throw EncodeException(EncodeException::PEM_DECODE, "CertificateStore::scanPem");
+		}
+		labelLength = p - label;
+		body = p + 5;
+		footer = (const unsigned char *) memmem(body, limit - body, end, sizeof(end) - 1);
+		if (footer == NULL)
+		{
+			throw EncodeException(EncodeException::PEM_DECODE, "CertificateStore::scanPem");
+		}
+		p = footer + sizeof(end) - 1;
+		/* only plain certificates; TRUSTED CERTIFICATE carries auxiliary data after the DER */
+		if ((labelLength == 11 && memcmp(label, "CERTIFICATE", 11) == 0)
+				|| (labelLength == 16 && memcmp(label, "X509 CERTIFICATE", 16) == 0))
+		{
+			block.data = body;
+			block.length = footer - body;
+			block.base64 = true;
+			blocks.push_back(block);
+		}
+	}
+}
+
+void CertificateStore::scanDer(const unsigned char *data, unsigned long length, std::vector<Block> &blocks)
+{
+	unsigned long offset = 0;
+	Block block;
+
+	while (offset < length)
+	{
+		try
+		{
+			CertificateView view(data + offset, length - offset);
+			block.data = data + offset;
+			block.length = view.getEncodedLength();
+			block.base64 = false;
+			blocks.push_back(block);
+			offset += block.length;
+		}
+		catch (EncodeException &ex)
+		{
+			/* anything that is not a certificate (keys, CRLs) ends the scan */
+			return;
+		}
+	}
+}
+
+bool CertificateStore::decodeBase64(const unsigned char *data, unsigned long length, std::string &out)
+{
+	unsigned long i, bits = 0, value = 0;
+	unsigned int padding = 0;
+	unsigned char c;
+	int digit;
+
+	out.clear();
+	out.reserve(length * 3 / 4);
+	for (i = 0; i < length; i++)
+	{
+		c = data[i];
+		if (c >= 'A' && c <= 'Z')
+		{
+			digit = c - 'A';
+		}
+		else if (c >= 'a' && c <= 'z')
+		{
+			digit = c - 'a' + 26;
+		}
+		else if (c >= '0' && c <= '9')
+		{
+			digit = c - '0' + 52;
+		}
+		else if (c == '+')
+		{
+			digit = 62;
+		}
+		else if (c == '/')
+		{
+			digit = 63;
+		}
+		else if (c == '=')
+		{
+			padding++;
+			continue;
+		}
+		else if (c == '\n' || c == '\r' || c == ' ' || c == '\t')
+		{
+			continue;
+		}
+		else
+		{
+			return false;
+		}
+		/* nothing but padding may follow the padding */
+		if (padding > 0)
+		{
+			return false;
+		}
+		value = (value << 6) | digit;
+		bits += 6;
+		if (bits >= 8)
+		{
+			bits -= 8;
+			out.push_back((char) ((value >> bits) & 0xff));
+		}
+	}
+	return (padding <= 2 && !out.empty());
+}
+
+std::string CertificateStore::getFingerPrint(const unsigned char *der, unsigned long length)
+{
+	unsigned char digest[SHA256_DIGEST_LENGTH];
+	SHA256(der, length, digest);
+	return std::string((const char *) digest, SHA256_DIGEST_LENGTH);
+}
+
+bool CertificateStore::getFingerPrint(X509 *cert, std::string &fingerprint)
+{
+	unsigned char *der = NULL;
+	int len;
+
+	len = i2d_X509(cert, &der);
+	if (len <= 0)
+	{
+		return false;
+	}
+	fingerprint = CertificateStore::getFingerPrint(der, len);
+	OPENSSL_free(der);
+	return true;
+}
+
+void *CertificateStore::decode(void *arg)
+{
+	DecodeTask *task = (DecodeTask *) arg;
+	const unsigned char *der, *p;
+	unsigned long length;
+	std::string buffer;
+	X509 *cert;
+
+	for (unsigned int i = task->begin; i < task->end && !task->failed; i++)
+	{
+		const Block &block = (*task->blocks)[i];
+		if (block.base64)
+		{
+			if (!CertificateStore::decodeBase64(block.data, block.length, buffer))
+			{
+				task->failed = true;
+				break;
+			}
+			der = (const unsigned char *) buffer.data();
+			length = buffer.size();
+		}
+		else
+		{
+			der = block.data;
+			length = block.length;
+		}
+		p = der;
+		cert = d2i_X509(NULL, &p, length);
+		if (cert == NULL || (unsigned long) (p - der) != length)
+		{
+			X509_free(cert);
+			task->failed = true;
+			break;
+		}
+		(*task->certificates)[i] = cert;
+		(*task->fingerprints)[i] = CertificateStore::getFingerPrint(der, length);
+	}
+	return NULL;
+}
+
+CertificateStore::Snapshot* CertificateStore::copySnapshot(const Snapshot *snapshot)
+{
+	Snapshot *ret;
+	ret = new Snapshot(*snapshot);
+	for (unsigned int i = 0; i < ret->certificates.size(); i++)
+	{
+		X509_up_ref(ret->certificates[i]);
+	}
+	return ret;
+}
+
+void CertificateStore::freeSnapshot(Snapshot *snapshot)
+{
+	for (unsigned int i = 0; i < snapshot->certificates.size(); i++)
+	{
+		X509_free(snapshot->certificates[i]);
+	}
+	delete snapshot;
+}
+
+bool CertificateStore::insert(Snapshot *snapshot, X509 *cert, const std::string &fingerprint, bool deduplicate)
+{
+	const ASN1_OCTET_STRING *keyIdentifier;
+
+	if (snapshot->byFingerprint.count(fingerprint) > 0)
+	{
+		if (deduplicate)
+		{
+			X509_free(cert);
+			return false;
+		}
+	}
+	else
+	{
+		snapshot->byFingerprint[fingerprint] = cert;
+	}
+	snapshot->certificates.push_back(cert);
+	snapshot->bySubject.insert(std::make_pair(X509_NAME_hash(X509_get_subject_name(cert)), cert));
+	snapshot->byIssuerSerial.insert(std::make_pair(
+			CertificateStore::getIssuerSerialKey(X509_get_issuer_name(cert), X509_get0_serialNumber(cert)), cert));
+	keyIdentifier = X509_get0_subject_key_id(cert);
+	if (keyIdentifier != NULL)
+	{
+		snapshot->byKeyIdentifier.insert(std::make_pair(CertificateStore::getKeyIdentifierKey(keyIdentifier), cert));
+	}
+	return true;
+}
+
+std::string CertificateStore::getIssuerSerialKey(X509_NAME *issuer, const ASN1_INTEGER *serial)
+{
+	std::string ret;
+	unsigned long hash;
+
+	/* a hash is enough for the key: lookups compare the full name afterwards */
+	hash = X509_NAME_hash(issuer);
+	ret.assign((const char *) &hash, sizeof(hash));
+	ret.append((const char *) ASN1_STRING_get0_data(serial), ASN1_STRING_length(serial));
+	return ret;
+}
+
+std::string CertificateStore::getKeyIdentifierKey(const ASN1_OCTET_STRING *keyIdentifier)
+{
+	return std::string((const char *) ASN1_STRING_get0_data(keyIdentifier), ASN1_STRING_length(keyIdentifier));
+}
+
+unsigned int CertificateStore::publish(const std::vector<X509 *> &certs, const std::vector<std::string> &fingerprints)
+{
+	Snapshot *next, *previous;
+	unsigned int ret = 0;
+
+	/* the new version is built without blocking readers */
+	CRYPTO_THREAD_write_lock(this->writeLock);
+	CRYPTO_THREAD_read_lock(this->lock);
+	next = CertificateStore::copySnapshot(this->snapshot);
+	CRYPTO_THREAD_unlock(this->lock);
+	for (unsigned int i = 0; i < certs.size(); i++)
+	{
+		if (CertificateStore::insert(next, certs[i], fingerprints[i], this->deduplicate))
+		{
+			ret++;
+		}
+	}
+	next->generation++;
+
+	CRYPTO_THREAD_write_lock(this->lock);
+	previous = this->snapshot;
+	this->snapshot = next;
+	CRYPTO_THREAD_unlock(this->lock);
+	CRYPTO_THREAD_unlock(this->writeLock);
+
+	/* readers hold the shared lock for the whole lookup, so nobody sees the old version anymore */
+	CertificateStore::freeSnapshot(previous);
+	return ret;
+}
+
+void CertificateStore::findBySubject(const Snapshot *snapshot, X509_NAME *name, std::vector<X509 *> &found) const
+{
+	std::multimap<unsigned long, X509 *>::const_iterator it, end;
+	unsigned long hash;
+
+	hash = X509_NAME_hash(name);
+	end = snapshot->bySubject.upper_bound(hash);
+	for (it = snapshot->bySubject.lower_bound(hash); it != end; it++)
+	{
+		if (X509_NAME_cmp(X509_get_subject_name(it->second), name) == 0)
+		{
+			found.push_back(it->second);
+		}
+	}
+}
+
+void CertificateStore::findIssuers(const Snapshot *snapshot, X509 *cert, std::vector<X509 *> &found) const
+{
+	std::multimap<std::string, X509 *>::const_iterator it, end;
+	const ASN1_OCTET_STRING *keyIdentifier;
+	std::vector<X509 *> candidates;
+	std::string key;
+
+	keyIdentifier = X509_get0_authority_key_id(cert);
+	if (keyIdentifier != NULL)
+	{
+		key = CertificateStore::getKeyIdentifierKey(keyIdentifier);
+		end = snapshot->byKeyIdentifier.upper_bound(key);
+		for (it = snapshot->byKeyIdentifier.lower_bound(key); it != end; it++)
+		{
+			candidates.push_back(it->second);
+		}
+	}
+	/* issuers without SKI can still match by name */
+	if (candidates.empty())
+	{
+		this->findBySubject(snapshot, X509_get_issuer_name(cert), candidates);
+	}
+	for (unsigned int i = 0; i < candidates.size(); i++)
+	{
+		if (X509_check_issued(candidates[i], cert) == X509_V_OK)
+		{
+			found.push_back(candidates[i]);
+		}
+	}
+}
+
+std::vector<Certificate *> CertificateStore::toCertificates(const std::vector<X509 *> &certs)
+{
+	std::vector<Certificate *> ret;
+	for (unsigned int i = 0; i < certs.size(); i++)
+	{
+		X509_up_ref(certs[i]);
+		ret.push_back(new Certificate(certs[i]));
+	}
+	return ret;
+}
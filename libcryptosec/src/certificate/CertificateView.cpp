@@ -0,0 +1,457 @@
+#include <libcryptosec/certificate/CertificateView.h>
+
+/* DER tags of the certificate fields */
+#define TAG_INTEGER			0x02
+#define TAG_BIT_STRING		0x03
+#define TAG_UTC_TIME		0x17
+#define TAG_GENERALIZED_TIME	0x18
+#define TAG_SEQUENCE		0x30
+#define TAG_VERSION			0xA0
+#define TAG_ISSUER_UID		0x81
+#define TAG_SUBJECT_UID		0x82
+#define TAG_EXTENSIONS		0xA3
+
+CertificateView::CertificateView(const unsigned char *der, unsigned long length) throw (EncodeException)
+{
+	this->der = der;
+	this->index(length);
+}
+
+CertificateView::CertificateView(ByteArray &derEncoded) throw (EncodeException)
+{
+	this->der = derEncoded.getDataPointer();
+	this->index(derEncoded.size());
+}
+
+CertificateView::~CertificateView()
+{
+}
+
+unsigned long CertificateView::getEncodedLength() const
+{
+	return this->length;
+}
+
+const unsigned char* CertificateView::getEncoded() const
+{
+	return this->der;
+}
+
+bool CertificateView::hasField(CertificateView::Field field) const
+{
+	return (field >= 0 && field < FIELD_COUNT && this->lengths[field] > 0);
+}
+
+const unsigned char* CertificateView::getField(CertificateView::Field field, unsigned long &length) const
+{
+	if (!this->hasField(field))
+	{
+		length = 0;
+		return NULL;
+	}
+	length = this->lengths[field];
+	return this->der + this->offsets[field];
+}
+
+ByteArray CertificateView::getFieldDerEncoded(CertificateView::Field field) const throw (CertificationException)
+{
+	const unsigned char *data;
+	unsigned long size;
+	data = this->getField(field, size);
+	if (data == NULL)
+	{
+		throw CertificationException(CertificationException::SET_NO_VALUE, "CertificateView::getFieldDerEncoded");
+	}
+	return ByteArray(data, size);
+}
+
+long CertificateView::getVersion() const throw (CertificationException)
+{
+	const unsigned char *p, *end;
+	unsigned long size, headerLength, contentLength;
+	unsigned char tag;
+	long ret;
+
+	/* the version is DEFAULT v1, so it is omitted from v1 certificates */
+	p = this->getField(CertificateView::VERSION, size);
+	if (p == NULL)
+	{
+		return 0;
+	}
+	end = p + size;
+	/* skips the [0] EXPLICIT wrapper and reads the INTEGER inside it */
+	CertificateView::readHeader(p, end, tag, headerLength, contentLength);
+	p += headerLength;
+	if (!CertificateView::readHeader(p, end, tag, headerLength, contentLength)
+			|| tag != TAG_INTEGER || contentLength != 1)
+	{
+		throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateView::getVersion");
+	}
+	ret = p[headerLength];
+	if (ret > 2)
+	{
+		throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateView::getVersion");
+	}
+	return ret;
+}
+
+BigInteger CertificateView::getSerialNumberBigInt() const throw (CertificationException)
+{
+	const unsigned char *p;
+	unsigned long size;
+	ASN1_INTEGER *serial;
+	BigInteger ret;
+
+	p = this->getField(CertificateView::SERIAL_NUMBER, size);
+	serial = d2i_ASN1_INTEGER(NULL, &p, size);
+	if (serial == NULL)
+	{
+		throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateView::getSerialNumberBigInt");
+	}
+	try
+	{
+		ret = BigInteger(serial);
+	}
+	catch (...)
+	{
+		ASN1_INTEGER_free(serial);
+		throw CertificationException(CertificationException::INTERNAL_ERROR, "CertificateView::getSerialNumberBigInt");
+	}
+	ASN1_INTEGER_free(serial);
+	return ret;
+}
+
+RDNSequence CertificateView::getIssuer() const throw (CertificationException)
+{
+	X509_NAME *name;
+	RDNSequence ret;
+	name = this->decodeName(CertificateView::ISSUER, "CertificateView::getIssuer");
+	ret = RDNSequence(name);
+	X509_NAME_free(name);
+	return ret;
+}
+
+RDNSequence CertificateView::getSubject() const throw (CertificationException)
+{
+	X509_NAME *name;
+	RDNSequence ret;
+	name = this->decodeName(CertificateView::SUBJECT, "CertificateView::getSubject");
+	ret = RDNSequence(name);
+	X509_NAME_free(name);
+	return ret;
+}
+
+unsigned long CertificateView::getIssuerHash() const throw (CertificationException)
+{
+	X509_NAME *name;
+	unsigned long ret;
+	name = this->decodeName(CertificateView::ISSUER, "CertificateView::getIssuerHash");
+	ret = X509_NAME_hash(name);
+	X509_NAME_free(name);
+	return ret;
+}
+
+unsigned long CertificateView::getSubjectHash() const throw (CertificationException)
+{
+	X509_NAME *name;
+	unsigned long ret;
+	name = this->decodeName(CertificateView::SUBJECT, "CertificateView::getSubjectHash");
+	ret = X509_NAME_hash(name);
+	X509_NAME_free(name);
+	return ret;
+}
+
+DateTime CertificateView::getNotBefore() const throw (CertificationException)
+{
+	return this->decodeTime(CertificateView::NOT_BEFORE, "CertificateView::getNotBefore");
+}
+
+DateTime CertificateView::getNotAfter() const throw (CertificationException)
+{
+	return this->decodeTime(CertificateView::NOT_AFTER, "CertificateView::getNotAfter");
+}
+
+PublicKey* CertificateView::getPublicKey() const throw (CertificationException, AsymmetricKeyException)
+{
+	const unsigned char *p;
+	unsigned long size;
+	EVP_PKEY *key;
+	PublicKey *ret;
+
+	p = this->getField(CertificateView::SUBJECT_PUBLIC_KEY_INFO, size);
+	key = d2i_PUBKEY(NULL, &p, size);
+	if (key == NULL)
+	{
+		throw CertificationException(CertificationException::SET_NO_VALUE, "CertificateView::getPublicKey");
+	}
+	try
+	{
+		ret = new PublicKey(key);
+	}
+	catch (...)
+	{
+		EVP_PKEY_free(key);
+		throw;
+	}
+	return ret;
+}
+
+ByteArray CertificateView::getFingerPrint(MessageDigest::Algorithm algorithm) const throw (MessageDigestException)
+{
+	ByteArray ret(EVP_MAX_MD_SIZE);
+	unsigned int size;
+	if (!EVP_Digest(this->der, this->length, ret.getDataPointer(), &size,
+			MessageDigest::getMessageDigest(algorithm), NULL))
+	{
+		throw MessageDigestException(MessageDigestException::CTX_INIT, "CertificateView::getFingerPrint");
+	}
+	return ByteArray(ret.getDataPointer(), size);
+}
+
+Certificate CertificateView::toCertificate() const throw (EncodeException)
+{
+	const unsigned char *p;
+	X509 *cert;
+	p = this->der;
+	cert = d2i_X509(NULL, &p, this->length);
+	if (cert == NULL)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::toCertificate");
+	}
+	return Certificate(cert);
+}
+
+void CertificateView::index(unsigned long length) throw (EncodeException)
+{
+	const unsigned char *p, *end, *tbsEnd, *validityEnd;
+	unsigned long headerLength, contentLength;
+	unsigned char tag;
+	int i;
+
+	for (i = 0; i < FIELD_COUNT; i++)
+	{
+		this->offsets[i] = 0;
+		this->lengths[i] = 0;
+	}
+	if (this->der == NULL)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+
+	/* Certificate ::= SEQUENCE { tbsCertificate, signatureAlgorithm, signatureValue } */
+	p = this->der;
+	if (!CertificateView::readHeader(p, p + length, tag, headerLength, contentLength) || tag != TAG_SEQUENCE)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+	this->length = headerLength + contentLength;
+	end = p + this->length;
+	p += headerLength;
+
+	if (!CertificateView::readHeader(p, end, tag, headerLength, contentLength) || tag != TAG_SEQUENCE)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+	this->setField(CertificateView::TBS_CERTIFICATE, p, headerLength + contentLength);
+	tbsEnd = p + headerLength + contentLength;
+	p += headerLength;
+
+	/* version [0] EXPLICIT Version DEFAULT v1 */
+	if (!CertificateView::readHeader(p, tbsEnd, tag, headerLength, contentLength))
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+	if (tag == TAG_VERSION)
+	{
+		this->setField(CertificateView::VERSION, p, headerLength + contentLength);
+		p += headerLength + contentLength;
+		if (!CertificateView::readHeader(p, tbsEnd, tag, headerLength, contentLength))
+		{
+			throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+		}
+	}
+
+	if (tag != TAG_INTEGER)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+	this->setField(CertificateView::SERIAL_NUMBER, p, headerLength + contentLength);
+	p += headerLength + contentLength;
+
+	if (!CertificateView::readHeader(p, tbsEnd, tag, headerLength, contentLength) || tag != TAG_SEQUENCE)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+	this->setField(CertificateView::TBS_SIGNATURE_ALGORITHM, p, headerLength + contentLength);
+	p += headerLength + contentLength;
+
+	if (!CertificateView::readHeader(p, tbsEnd, tag, headerLength, contentLength) || tag != TAG_SEQUENCE)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+	this->setField(CertificateView::ISSUER, p, headerLength + contentLength);
+	p += headerLength + contentLength;
+
+	/* Validity ::= SEQUENCE { notBefore Time, notAfter Time } */
+	if (!CertificateView::readHeader(p, tbsEnd, tag, headerLength, contentLength) || tag != TAG_SEQUENCE)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+	this->setField(CertificateView::VALIDITY, p, headerLength + contentLength);
+	validityEnd = p + headerLength + contentLength;
+	p += headerLength;
+	if (!CertificateView::readHeader(p, validityEnd, tag, headerLength, contentLength)
+			|| (tag != TAG_UTC_TIME && tag != TAG_GENERALIZED_TIME))
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+	this->setField(CertificateView::NOT_BEFORE, p, headerLength + contentLength);
+	p += headerLength + contentLength;
+	if (!CertificateView::readHeader(p, validityEnd, tag, headerLength, contentLength)
+			|| (tag != TAG_UTC_TIME && tag != TAG_GENERALIZED_TIME)
+			|| p + headerLength + contentLength != validityEnd)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+	this->setField(CertificateView::NOT_AFTER, p, headerLength + contentLength);
+	p = validityEnd;
+
+	if (!CertificateView::readHeader(p, tbsEnd, tag, headerLength, contentLength) || tag != TAG_SEQUENCE)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+	this->setField(CertificateView::SUBJECT, p, headerLength + contentLength);
+	p += headerLength + contentLength;
+
+	if (!CertificateView::readHeader(p, tbsEnd, tag, headerLength, contentLength) || tag != TAG_SEQUENCE)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+	this->setField(CertificateView::SUBJECT_PUBLIC_KEY_INFO, p, headerLength + contentLength);
+	p += headerLength + contentLength;
+
+	/* optional fields, in this order: [1] issuerUniqueID, [2] subjectUniqueID, [3] extensions */
+	if (p < tbsEnd && CertificateView::readHeader(p, tbsEnd, tag, headerLength, contentLength) && tag == TAG_ISSUER_UID)
+	{
+		this->setField(CertificateView::ISSUER_UNIQUE_ID, p, headerLength + contentLength);
+		p += headerLength + contentLength;
+	}
+	if (p < tbsEnd && CertificateView::readHeader(p, tbsEnd, tag, headerLength, contentLength) && tag == TAG_SUBJECT_UID)
+	{
+		this->setField(CertificateView::SUBJECT_UNIQUE_ID, p, headerLength + contentLength);
+		p += headerLength + contentLength;
+	}
+	if (p < tbsEnd && CertificateView::readHeader(p, tbsEnd, tag, headerLength, contentLength) && tag == TAG_EXTENSIONS)
+	{
+		this->setField(CertificateView::EXTENSIONS, p, headerLength + contentLength);
+		p += headerLength + contentLength;
+	}
+	if (p != tbsEnd)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+
+	if (!CertificateView::readHeader(p, end, tag, headerLength, contentLength) || tag != TAG_SEQUENCE)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+	this->setField(CertificateView::SIGNATURE_ALGORITHM, p, headerLength + contentLength);
+	p += headerLength + contentLength;
+
+	if (!CertificateView::readHeader(p, end, tag, headerLength, contentLength) || tag != TAG_BIT_STRING
+			|| p + headerLength + contentLength != end)
+	{
+		throw EncodeException(EncodeException::DER_DECODE, "CertificateView::CertificateView");
+	}
+	this->setField(CertificateView::SIGNATURE_VALUE, p, headerLength + contentLength);
+}
+
+void CertificateView::setField(CertificateView::Field field, const unsigned char *begin, unsigned long length)
+{
+	this->offsets[field] = begin - this->der;
+	this->lengths[field] = length;
+}
+
+X509_NAME* CertificateView::decodeName(CertificateView::Field field, const char *where) const throw (CertificationException)
+{
+	const unsigned char *p;
+	unsigned long size;
+	X509_NAME *ret;
+	p = this->getField(field, size);
+	ret = d2i_X509_NAME(NULL, &p, size);
+	if (ret == NULL)
+	{
+		throw CertificationException(CertificationException::INTERNAL_ERROR, where);
+	}
+	return ret;
+}
+
+DateTime CertificateView::decodeTime(CertificateView::Field field, const char *where) const throw (CertificationException)
+{
+	const unsigned char *p;
+	unsigned long size;
+	ASN1_TIME *time;
+	DateTime ret;
+	long long epoch;
+	p = this->getField(field, size);
+	if (((size == 15 && p[0] == V_ASN1_UTCTIME) || (size == 17 && p[0] == V_ASN1_GENERALIZEDTIME))
+			&& p[1] == size - 2 && DateTime::parseTime((const char *) p + 2, size - 2, epoch))
+	{
+		return DateTime((time_t) epoch);
+	}
+	time = d2i_ASN1_TIME(NULL, &p, size);
+	if (time == NULL)
+	{
+		throw CertificationException(CertificationException::INTERNAL_ERROR, where);
+	}
+	try
+	{
+		ret = DateTime(time);
+	}
+	catch (...)
+	{
+		ASN1_TIME_free(time);
+		throw CertificationException(CertificationException::INTERNAL_ERROR, where);
+	}
+	ASN1_TIME_free(time);
+	return ret;
+}
+
+bool CertificateView::readHeader(const unsigned char *p, const unsigned char *end,
+		unsigned char &tag, unsigned long &headerLength, unsigned long &contentLength)
+{
+	unsigned long available, count, i;
+
+	if (p >= end || end - p < 2)
+	{
+		return false;
+	}
+	available = end - p;
+	tag = p[0];
+	/* high tag numbers do not appear in certificates */
+	if ((tag & 0x1f) == 0x1f)
+	{
+		return false;
+	}
+	if (p[1] < 0x80)
+	{
+		headerLength = 2;
+		contentLength = p[1];
+	}
+	else
+	{
+		/* DER forbids the indefinite form (0x80) */
+		count = p[1] & 0x7f;
+		if (count == 0 || count > 4 || available < 2 + count)
+		{
+			return false;
+		}
+		contentLength = 0;
+		for (i = 0; i < count; i++)
+		{
+			contentLength = (contentLength << 8) | p[2 + i];
+		}
+		headerLength = 2 + count;
+	}
+	return (contentLength <= available - headerLength);
+}
@@ -96,3 +96,8 @@ X509_EXTENSION* DeltaCRLIndicatorExtension::getX509Extension()
 	ret = X509V3_EXT_i2d(NID_delta_crl, this->critical?1:0, (void *)baseCrlNumber);
 	return ret;
 }
+
+void DeltaCRLIndicatorExtension::writeValue(DocumentWriter &writer)
+{
+	writer.write("baseCRLNumber", (long) this->baseCrlNumber);
+}
@@ -0,0 +1,302 @@
+#include <libcryptosec/certificate/DerWriter.h>
+
+#include <openssl/x509.h>
+
+#include <string.h>
+
+DerWriter::DerWriter()
+	: next(0), total(0), position(NULL), limit(NULL), writing(false), failed(false)
+{
+	this->lengths.reserve(16);
+	this->open.reserve(8);
+}
+
+DerWriter::~DerWriter()
+{
+}
+
+void DerWriter::begin(unsigned char tag)
+{
+	if (this->writing)
+	{
+		if (this->next < this->lengths.size())
+		{
+			this->writeHeader(tag, this->lengths[this->next++]);
+		}
+		else
+		{
+			this->failed = true;
+		}
+		return;
+	}
+	this->open.push_back(this->lengths.size());
+	this->lengths.push_back(0);
+}
+
+void DerWriter::end()
+{
+	unsigned long length;
+
+	if (this->writing)
+	{
+		return;
+	}
+	if (this->open.empty())
+	{
+		this->failed = true;
+		return;
+	}
+	length = this->lengths[this->open.back()];
+	this->open.pop_back();
+	this->add(DerWriter::getHeaderLength(length) + length);
+}
+
+void DerWriter::writeBoolean(bool value)
+{
+	unsigned char data = value ? 0xff : 0x00;
+	this->writePrimitive(DerWriter::BOOLEAN, &data, 1);
+}
+
+void DerWriter::writeInteger(long value, unsigned char tag)
+{
+	unsigned char data[sizeof(long)];
+	unsigned long bits = (unsigned long) value;
+	unsigned int start;
+
+	for (unsigned int i = sizeof(long); i > 0; i--)
+	{
+		data[i - 1] = bits & 0xff;
+		bits >>= 8;
+	}
+	/* two's complement with no redundant leading bytes */
+	for (start = 0; start < sizeof(long) - 1; start++)
+	{
+		if (!(data[start] == 0x00 && !(data[start + 1] & 0x80))
+				&& !(data[start] == 0xff && (data[start + 1] & 0x80)))
+		{
+			break;
+		}
+	}
+	this->writePrimitive(tag, data + start, sizeof(long) - start);
+}
+
+void DerWriter::writeObject(const ASN1_OBJECT *object)
+{
+	if (object == NULL || OBJ_length(object) == 0)
+	{
+		this->failed = true;
+		return;
+	}
+	this->writePrimitive(DerWriter::OBJECT, OBJ_get0_data(object), OBJ_length(object));
+}
+
+void DerWriter::writeObject(const ObjectIdentifier &objectIdentifier)
+{
+	this->writeObject(objectIdentifier.getObjectIdentifier());
+}
+
+void DerWriter::writePrimitive(unsigned char tag, const unsigned char *data, unsigned int length)
+{
+	if (!this->writing)
+	{
+		this->add(DerWriter::getHeaderLength(length) + length);
+		return;
+	}
+	this->writeHeader(tag, length);
+	if (length > 0 && this->reserve(length))
+	{
+		memcpy(this->position, data, length);
+		this->position += length;
+	}
+}
+
+void DerWriter::writePrimitive(unsigned char tag, const std::string &data)
+{
+	this->writePrimitive(tag, (const unsigned char *) data.data(), data.size());
+}
+
+void DerWriter::writeBitString(const bool *bits, unsigned int count, unsigned char tag)
+{
+	unsigned char data[32];
+	unsigned int length, unused;
+
+	if (count > 8 * (sizeof(data) - 1))
+	{
+		this->failed = true;
+		return;
+	}
+	memset(data, 0, sizeof(data));
+	length = 0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (bits[i])
+		{
+			data[1 + i / 8] |= 0x80 >> (i % 8);
+			length = i / 8 + 1;
+		}
+	}
+	/* the first content byte holds the number of unused bits in the last one */
+	unused = 0;
+	if (length > 0)
+	{
+		while (!(data[length] & (0x01 << unused)))
+		{
+			unused++;
+		}
+	}
+	data[0] = unused;
+	this->writePrimitive(tag, data, length + 1);
+}
+
+void DerWriter::writeEncoded(const unsigned char *data, unsigned int length)
+{
+	if (!this->writing)
+	{
+		this->add(length);
+		return;
+	}
+	if (this->reserve(length))
+	{
+		memcpy(this->position, data, length);
+		this->position += length;
+	}
+}
+
+void DerWriter::fail()
+{
+	this->failed = true;
+}
+
+bool DerWriter::startWriting()
+{
+	if (this->failed || !this->open.empty())
+	{
+		return false;
+	}
+	this->encoded = ByteArray((unsigned int) this->total);
+	this->position = this->encoded.getDataPointer();
+	this->limit = this->position + this->total;
+	this->next = 0;
+	this->writing = true;
+	return true;
+}
+
+bool DerWriter::isWriting() const
+{
+	return this->writing;
+}
+
+bool DerWriter::hasFailed() const
+{
+	return this->failed;
+}
+
+ByteArray& DerWriter::getEncoded()
+{
+	return this->encoded;
+}
+
+void DerWriter::add(unsigned long length)
+{
+	if (this->open.empty())
+	{
+		this->total += length;
+	}
+	else
+	{
+		this->lengths[this->open.back()] += length;
+	}
+}
+
+bool DerWriter::reserve(unsigned long length)
+{
+	/* the second pass must repeat the calls of the first one */
+	if (this->failed || (unsigned long) (this->limit - this->position) < length)
+	{
+		this->failed = true;
+		return false;
+	}
+	return true;
+}
+
+void DerWriter::writeHeader(unsigned char tag, unsigned long length)
+{
+	unsigned int bytes;
+
+	bytes = DerWriter::getHeaderLength(length);
+	if (!this->reserve(bytes))
+	{
+		return;
+	}
+	DerWriter::encodeHeader(tag, length, this->position);
+	this->position += bytes;
+}
+
+void DerWriter::encodeHeader(unsigned char tag, unsigned long length, std::string &out)
+{
+	unsigned char header[2 + sizeof(unsigned long)];
+
+	DerWriter::encodeHeader(tag, length, header);
+	out.append((const char *) header, DerWriter::getHeaderLength(length));
+}
+
+void DerWriter::encodeHeader(unsigned char tag, unsigned long length, unsigned char *out)
+{
+	unsigned int bytes;
+
+	*out++ = tag;
+	if (length < 0x80)
+	{
+		*out = (unsigned char) length;
+		return;
+	}
+	bytes = DerWriter::getHeaderLength(length) - 2;
+	*out++ = 0x80 | bytes;
+	for (unsigned int i = bytes; i > 0; i--)
+	{
+		*out++ = (length >> (8 * (i - 1))) & 0xff;
+	}
+}
+
+unsigned int DerWriter::getHeaderLength(unsigned long length)
+{
+	unsigned int ret = 2;
+
+	if (length >= 0x80)
+	{
+		for (; length > 0; length >>= 8)
+		{
+			ret++;
+		}
+	}
+	return ret;
+}
+
+bool DerWriter::encodeSignatureAlgorithm(EVP_PKEY *key, const EVP_MD *md, std::string &out)
+{
+	ASN1_OCTET_STRING *empty = ASN1_OCTET_STRING_new();
+	ASN1_BIT_STRING *signature = ASN1_BIT_STRING_new();
+	X509_ALGOR *algorithm = X509_ALGOR_new();
+	EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+	unsigned char *p;
+	int length = 0;
+
+	/* the hooks that fill in the AlgorithmIdentifier are only reachable through a signature */
+	if (empty != NULL && signature != NULL && algorithm != NULL && ctx != NULL
+			&& EVP_DigestSignInit(ctx, NULL, md, NULL, key) == 1
+			&& ASN1_item_sign_ctx(ASN1_ITEM_rptr(ASN1_OCTET_STRING), algorithm, NULL, signature, empty, ctx) > 0)
+	{
+		length = i2d_X509_ALGOR(algorithm, NULL);
+		if (length > 0)
+		{
+			out.resize(out.size() + length);
+			p = (unsigned char *) &out[out.size() - length];
+			i2d_X509_ALGOR(algorithm, &p);
+		}
+	}
+	EVP_MD_CTX_free(ctx);
+	X509_ALGOR_free(algorithm);
+	ASN1_BIT_STRING_free(signature);
+	ASN1_OCTET_STRING_free(empty);
+	return (length > 0);
+}
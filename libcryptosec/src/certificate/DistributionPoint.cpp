@@ -161,6 +161,53 @@ GeneralNames DistributionPoint::getCrlIssuer()
 	return this->crlIssuer;
 }
 
+void DistributionPoint::encode(DerWriter &writer) const
+{
+	bool anyReasons;
+
+	writer.begin(DerWriter::SEQUENCE);
+	if (this->distributionPointName.getType() != DistributionPointName::UNDEFINED)
+	{
+		writer.begin(DerWriter::CONTEXT_CONSTRUCTED | 0);
+		this->distributionPointName.encode(writer);
+		writer.end();
+	}
+	anyReasons = false;
+	for (int i = 0; i < 7; i++)
+	{
+		anyReasons = anyReasons || this->reasons[i];
+	}
+	if (anyReasons)
+	{
+		writer.writeBitString(this->reasons, 7, DerWriter::CONTEXT_SPECIFIC | 1);
+	}
+	if (this->crlIssuer.getNumberOfEntries() > 0)
+	{
+		this->crlIssuer.encode(writer, DerWriter::CONTEXT_CONSTRUCTED | 2);
+	}
+	writer.end();
+}
+
+void DistributionPoint::write(DocumentWriter &writer)
+{
+	writer.begin("distributionPoint");
+	if (this->distributionPointName.getType() != DistributionPointName::UNDEFINED)
+	{
+		this->distributionPointName.write(writer);
+	}
+	writer.begin("reasonFlag");
+	for (int i = 0; i < 7; i++)
+	{
+		writer.write(DistributionPoint::reasonFlag2Name((DistributionPoint::ReasonFlags) i), this->reasons[i]);
+	}
+	writer.end();
+	if (this->crlIssuer.getNumberOfEntries() > 0)
+	{
+		this->crlIssuer.write(writer, "cRLIssuer");
+	}
+	writer.end();
+}
+
 DIST_POINT* DistributionPoint::getDistPoint()
 {
 	DIST_POINT *ret;
@@ -120,6 +120,37 @@ DistributionPointName::Type DistributionPointName::getType() const
 	return this->type;
 }
 
+void DistributionPointName::encode(DerWriter &writer) const
+{
+	switch (this->type)
+	{
+		case DistributionPointName::FULL_NAME:
+			this->fullName.encode(writer, DerWriter::CONTEXT_CONSTRUCTED | 0);
+			break;
+		default:
+			/* the relative name is a single RDN, left to OpenSSL */
+			writer.fail();
+			break;
+	}
+}
+
+void DistributionPointName::write(DocumentWriter &writer)
+{
+	writer.begin("distributionPointName");
+	switch (this->type)
+	{
+		case DistributionPointName::FULL_NAME:
+			this->fullName.write(writer, "fullName");
+			break;
+		case DistributionPointName::RELATIVE_NAME:
+			this->relativeName.write(writer, "nameRelativeToCRLIssuer");
+			break;
+		default:
+			break;
+	}
+	writer.end();
+}
+
 DIST_POINT_NAME* DistributionPointName::getDistPointName()
 {
 	DIST_POINT_NAME *ret;
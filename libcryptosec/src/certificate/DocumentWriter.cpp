@@ -0,0 +1,68 @@
+#include <libcryptosec/certificate/DocumentWriter.h>
+
+#include <libcryptosec/Base64.h>
+#include <libcryptosec/DateTime.h>
+
+#include <stdio.h>
+
+DocumentWriter::DocumentWriter(std::ostream &stream)
+	: stream(stream)
+{
+}
+
+DocumentWriter::~DocumentWriter()
+{
+}
+
+void DocumentWriter::write(const std::string &name, const std::string &value)
+{
+	this->writeField(name, value, true);
+}
+
+void DocumentWriter::write(const std::string &name, const char *value)
+{
+	this->writeField(name, (value != NULL) ? value : "", true);
+}
+
+void DocumentWriter::write(const std::string &name, int value)
+{
+	this->write(name, (long) value);
+}
+
+void DocumentWriter::write(const std::string &name, long value)
+{
+	char temp[24];
+
+	sprintf(temp, "%ld", value);
+	this->writeField(name, temp, false);
+}
+
+void DocumentWriter::write(const std::string &name, bool value)
+{
+	this->writeField(name, value ? "true" : "false", false);
+}
+
+void DocumentWriter::writeBase64(const std::string &name, const unsigned char *data, unsigned int length)
+{
+	ByteArray value(data, length);
+
+	this->writeField(name, Base64::encode(value), true);
+}
+
+void DocumentWriter::writeTime(const std::string &name, time_t value)
+{
+	DateTime date(value);
+
+	this->writeField(name, date.getISODate() + "Z", true);
+}
+
+void DocumentWriter::writeTime(const std::string &name, const ASN1_TIME *value)
+{
+	if (value == NULL || !ASN1_TIME_check(value))
+	{
+		this->writeField(name, "", true);
+		return;
+	}
+	DateTime date(const_cast<ASN1_TIME *>(value));
+	this->writeField(name, date.getISODate() + "Z", true);
+}
@@ -124,12 +124,38 @@ std::vector<ObjectIdentifier> ExtendedKeyUsageExtension::getUsages()
 	return this->usages;
 }
 
+void ExtendedKeyUsageExtension::encodeValue(DerWriter &writer)
+{
+	writer.begin(DerWriter::SEQUENCE);
+	for (unsigned int i = 0; i < this->usages.size(); i++)
+	{
+		writer.writeObject(this->usages[i]);
+	}
+	writer.end();
+}
+
+void ExtendedKeyUsageExtension::writeValue(DocumentWriter &writer)
+{
+	writer.beginList("usages");
+	for (unsigned int i = 0; i < this->usages.size(); i++)
+	{
+		writer.write("usage", this->usages[i].getName());
+	}
+	writer.end();
+}
+
 X509_EXTENSION* ExtendedKeyUsageExtension::getX509Extension()
 {
 	X509_EXTENSION *ret;
 	ASN1_OBJECT *asn1Obj;
 	STACK_OF(ASN1_OBJECT) *extKeyUsages;
 	unsigned int i;
+	ret = this->encodeX509Extension(NID_ext_key_usage);
+	if (ret != NULL)
+	{
+		return ret;
+	}
+	/* values the writer does not handle are encoded by OpenSSL */
 	extKeyUsages = sk_ASN1_OBJECT_new_null();
 	for (i=0;i<this->usages.size();i++)
 	{
@@ -46,6 +46,23 @@ std::string Extension::extValue2Xml(std::string tab)
 	return tab + "<base64Value>\n" +  tab + "\t" + this->getBase64Value() + "\n" + tab + "</base64Value>\n";
 }
 
+void Extension::write(DocumentWriter &writer)
+{
+	writer.begin("extension");
+	writer.write("extnID", this->getName());
+	writer.write("oid", this->objectIdentifier.getOid());
+	writer.write("critical", this->critical);
+	writer.begin("extnValue");
+	this->writeValue(writer);
+	writer.end();
+	writer.end();
+}
+
+void Extension::writeValue(DocumentWriter &writer)
+{
+	writer.writeBase64("base64Value", this->value.getDataPointer(), this->value.size());
+}
+
 std::string Extension::getXmlEncoded()
 {
 	return this->getXmlEncoded("");
@@ -114,6 +131,77 @@ X509_EXTENSION* Extension::getX509Extension()
 	return ret;
 }
 
+ByteArray Extension::getDerEncoded() throw (EncodeException)
+{
+	DerWriter writer;
+	X509_EXTENSION *ext;
+	unsigned char *data;
+	ByteArray ret;
+	int length;
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		writer.begin(DerWriter::SEQUENCE);
+		writer.writeObject(this->objectIdentifier);
+		if (this->critical)
+		{
+			writer.writeBoolean(true);
+		}
+		writer.begin(DerWriter::OCTET_STRING);
+		this->encodeValue(writer);
+		writer.end();
+		writer.end();
+		if (pass == 0 && !writer.startWriting())
+		{
+			break;
+		}
+	}
+	if (writer.isWriting() && !writer.hasFailed())
+	{
+		return writer.getEncoded();
+	}
+
+	ext = this->getX509Extension();
+	data = NULL;
+	length = (ext != NULL) ? i2d_X509_EXTENSION(ext, &data) : -1;
+	X509_EXTENSION_free(ext);
+	if (length <= 0)
+	{
+		throw EncodeException(EncodeException::DER_ENCODE, "Extension::getDerEncoded");
+	}
+	ret = ByteArray(data, length);
+	OPENSSL_free(data);
+	return ret;
+}
+
+void Extension::encodeValue(DerWriter &writer)
+{
+	writer.fail();
+}
+
+X509_EXTENSION* Extension::encodeX509Extension(int nid)
+{
+	DerWriter writer;
+	ASN1_OCTET_STRING *data;
+	X509_EXTENSION *ret;
+
+	this->encodeValue(writer);
+	if (!writer.startWriting())
+	{
+		return NULL;
+	}
+	this->encodeValue(writer);
+	if (writer.hasFailed())
+	{
+		return NULL;
+	}
+	data = ASN1_OCTET_STRING_new();
+	ASN1_OCTET_STRING_set(data, writer.getEncoded().getDataPointer(), writer.getEncoded().size());
+	ret = X509_EXTENSION_create_by_NID(NULL, nid, this->critical?1:0, data);
+	ASN1_OCTET_STRING_free(data);
+	return ret;
+}
+
 Extension::Name Extension::getName(int nid)
 {
 	Extension::Name ret;
@@ -1,5 +1,7 @@
 #include <libcryptosec/certificate/GeneralName.h>
 
+#include <libcryptosec/certificate/ObjectIdentifierTable.h>
+
 GeneralName::GeneralName()
 {
 	this->type = GeneralName::UNDEFINED;
@@ -266,6 +268,89 @@ GENERAL_NAME* GeneralName::getGeneralName()
 	return ret;
 }
 
+void GeneralName::encode(DerWriter &writer) const
+{
+	const ObjectIdentifierTable::Entry *entry;
+	unsigned char *ipAddress;
+	ByteArray der;
+
+	switch (this->type)
+	{
+		case GeneralName::OTHER_NAME:
+			entry = ObjectIdentifierTable::findByOid(this->oid);
+			if (entry == NULL)
+			{
+				writer.fail();
+				break;
+			}
+			writer.begin(DerWriter::CONTEXT_CONSTRUCTED | 0);
+			writer.writePrimitive(DerWriter::OBJECT, entry->der);
+			writer.begin(DerWriter::CONTEXT_CONSTRUCTED | 0);
+			writer.writePrimitive(DerWriter::OCTET_STRING, this->data);
+			writer.end();
+			writer.end();
+			break;
+		case GeneralName::RFC_822_NAME:
+			writer.writePrimitive(DerWriter::CONTEXT_SPECIFIC | 1, this->data);
+			break;
+		case GeneralName::DNS_NAME:
+			writer.writePrimitive(DerWriter::CONTEXT_SPECIFIC | 2, this->data);
+			break;
+		case GeneralName::DIRECTORY_NAME:
+			der = this->directoryName.getDerEncoded();
+			writer.begin(DerWriter::CONTEXT_CONSTRUCTED | 4);
+			writer.writeEncoded(der.getDataPointer(), der.size());
+			writer.end();
+			break;
+		case GeneralName::UNIFORM_RESOURCE_IDENTIFIER:
+			writer.writePrimitive(DerWriter::CONTEXT_SPECIFIC | 6, this->data);
+			break;
+		case GeneralName::IP_ADDRESS:
+			ipAddress = GeneralName::ipAddress2Data(this->data);
+			writer.writePrimitive(DerWriter::CONTEXT_SPECIFIC | 7, ipAddress, 4);
+			free(ipAddress);
+			break;
+		case GeneralName::REGISTERED_ID:
+			if (OBJ_length(this->registeredId.getObjectIdentifier()) == 0)
+			{
+				writer.fail();
+				break;
+			}
+			writer.writePrimitive(DerWriter::CONTEXT_SPECIFIC | 8,
+					OBJ_get0_data(this->registeredId.getObjectIdentifier()),
+					OBJ_length(this->registeredId.getObjectIdentifier()));
+			break;
+		case GeneralName::UNDEFINED:
+			/* an empty GENERAL_NAME is left out by OpenSSL as well */
+			break;
+	}
+}
+
+void GeneralName::write(DocumentWriter &writer)
+{
+	writer.begin("generalName");
+	writer.write("type", GeneralName::type2Name(this->type));
+	switch (this->type)
+	{
+		case GeneralName::OTHER_NAME:
+			writer.write("oid", this->oid);
+			writer.write("value", this->data);
+			break;
+		case GeneralName::DIRECTORY_NAME:
+			this->directoryName.write(writer, "value");
+			break;
+		case GeneralName::REGISTERED_ID:
+			writer.write("value", this->registeredId.getOid());
+			break;
+		case GeneralName::UNDEFINED:
+			break;
+		default:
+			writer.write("value", this->data);
+			break;
+	}
+	writer.end();
+}
+
 void GeneralName::clean()
 {
 	switch (this->type)
@@ -67,6 +67,26 @@ int GeneralNames::getNumberOfEntries() const
 	return this->generalNames.size();
 }
 
+void GeneralNames::encode(DerWriter &writer, unsigned char tag) const
+{
+	writer.begin(tag);
+	for (unsigned int i = 0; i < this->generalNames.size(); i++)
+	{
+		this->generalNames[i].encode(writer);
+	}
+	writer.end();
+}
+
+void GeneralNames::write(DocumentWriter &writer, const std::string &name)
+{
+	writer.beginList(name);
+	for (unsigned int i = 0; i < this->generalNames.size(); i++)
+	{
+		this->generalNames[i].write(writer);
+	}
+	writer.end();
+}
+
 GENERAL_NAMES* GeneralNames::getInternalGeneralNames()
 {
 	GENERAL_NAMES *ret;
@@ -0,0 +1,292 @@
+#include <libcryptosec/certificate/IssuanceTemplate.h>
+#include <libcryptosec/certificate/DerWriter.h>
+
+#include <openssl/objects.h>
+#include <openssl/sha.h>
+
+#include <algorithm>
+
+/* SubjectKeyIdentifier (2.5.29.14) com um OCTET STRING de 20 bytes, sem o valor */
+static const unsigned char SUBJECT_KEY_IDENTIFIER[] = {
+	0x30, 0x1d, 0x06, 0x03, 0x55, 0x1d, 0x0e, 0x04, 0x16, 0x04, 0x14
+};
+
+IssuanceTemplate::IssuanceTemplate(CertificateBuilder &builder, PrivateKey &privateKey,
+		MessageDigest::Algorithm messageDigestAlgorithm) throw (CertificationException, EncodeException)
+	: subjectKeyIdentifier(false)
+{
+	const STACK_OF(X509_EXTENSION) *builderExtensions;
+	X509_EXTENSION *extension;
+	X509 *cert = builder.getX509();
+	int i;
+	long version;
+	bool rc;
+
+	/* chaves EdDSA ignoram o resumo pedido e assinam o TBSCertificate inteiro */
+	this->md = MessageDigest::getMessageDigest(messageDigestAlgorithm, privateKey.getEvpPkey());
+	if (!DerWriter::encodeSignatureAlgorithm(privateKey.getEvpPkey(), this->md, this->algorithm))
+	{
+		throw CertificationException(CertificationException::UNSUPPORTED_ASYMMETRIC_KEY_TYPE, "IssuanceTemplate::IssuanceTemplate");
+	}
+	rc = IssuanceTemplate::append(X509_get_issuer_name(cert), i2d_X509_NAME, this->issuer);
+
+	builderExtensions = X509_get0_extensions(cert);
+	for (i = 0; rc && i < sk_X509_EXTENSION_num(builderExtensions); i++)
+	{
+		extension = sk_X509_EXTENSION_value(builderExtensions, i);
+		if (!IssuanceTemplate::addExtensionOid(X509_EXTENSION_get_object(extension), this->extensionOids))
+		{
+			throw CertificationException(CertificationException::ADDING_EXTENSION, "IssuanceTemplate::IssuanceTemplate");
+		}
+		rc = IssuanceTemplate::append(extension, i2d_X509_EXTENSION, this->extensions);
+	}
+	if (!rc)
+	{
+		throw EncodeException(EncodeException::DER_ENCODE, "IssuanceTemplate::IssuanceTemplate");
+	}
+
+	version = X509_get_version(cert);
+	if (!this->extensions.empty())
+	{
+		version = 2;
+	}
+	if (version > 0)
+	{
+		this->version.append("\xa0\x03\x02\x01", 4);
+		this->version += (char) version;
+	}
+
+	this->key = privateKey.getEvpPkey();
+	EVP_PKEY_up_ref(this->key);
+}
+
+IssuanceTemplate::~IssuanceTemplate()
+{
+	EVP_PKEY_free(this->key);
+}
+
+void IssuanceTemplate::setSubjectKeyIdentifier(bool subjectKeyIdentifier)
+{
+	this->subjectKeyIdentifier = subjectKeyIdentifier;
+}
+
+bool IssuanceTemplate::isSubjectKeyIdentifier() const
+{
+	return this->subjectKeyIdentifier;
+}
+
+ByteArray IssuanceTemplate::issueDerEncoded(const BigInteger &serialNumber, RDNSequence &subject, PublicKey &publicKey,
+		DateTime &notBefore, DateTime &notAfter, std::vector<Extension *> &extensions) const
+		throw (CertificationException, EncodeException)
+{
+	X509_PUBKEY *pubkey = NULL;
+	ByteArray name, ret;
+
+	if (!X509_PUBKEY_set(&pubkey, publicKey.getEvpPkey()))
+	{
+		throw EncodeException(EncodeException::DER_ENCODE, "IssuanceTemplate::issueDerEncoded");
+	}
+	/* o nome vem da codificação guardada pelo RDNSequence, sem montar um X509_NAME */
+	name = subject.getDerEncoded();
+	try
+	{
+		ret = this->encode(serialNumber, std::string((const char *) name.getDataPointer(), name.size()), pubkey,
+				notBefore, notAfter, extensions, NULL);
+	}
+	catch (...)
+	{
+		X509_PUBKEY_free(pubkey);
+		throw;
+	}
+	X509_PUBKEY_free(pubkey);
+	return ret;
+}
+
+ByteArray IssuanceTemplate::issueDerEncoded(const BigInteger &serialNumber, RDNSequence &subject, PublicKey &publicKey,
+		DateTime &notBefore, DateTime &notAfter) const
+		throw (CertificationException, EncodeException)
+{
+	std::vector<Extension *> extensions;
+	return this->issueDerEncoded(serialNumber, subject, publicKey, notBefore, notAfter, extensions);
+}
+
+ByteArray IssuanceTemplate::issueDerEncoded(const BigInteger &serialNumber, CertificateRequest &request,
+		DateTime &notBefore, DateTime &notAfter, std::vector<Extension *> &extensions,
+		EVP_MD_CTX *signingContext) const
+		throw (CertificationException, EncodeException)
+{
+	X509_REQ *req = request.getX509Req();
+	X509_PUBKEY *publicKey;
+	std::string subject;
+
+	/* a chave é copiada já codificada, sem passar por EVP_PKEY */
+	publicKey = (req != NULL) ? X509_REQ_get_X509_PUBKEY(req) : NULL;
+	if (publicKey == NULL)
+	{
+		throw CertificationException(CertificationException::SET_NO_VALUE, "IssuanceTemplate::issueDerEncoded");
+	}
+	if (!IssuanceTemplate::append(X509_REQ_get_subject_name(req), i2d_X509_NAME, subject))
+	{
+		throw EncodeException(EncodeException::DER_ENCODE, "IssuanceTemplate::issueDerEncoded");
+	}
+	return this->encode(serialNumber, subject, publicKey, notBefore, notAfter, extensions, signingContext);
+}
+
+Certificate* IssuanceTemplate::issue(const BigInteger &serialNumber, RDNSequence &subject, PublicKey &publicKey,
+		DateTime &notBefore, DateTime &notAfter, std::vector<Extension *> &extensions) const
+		throw (CertificationException, EncodeException)
+{
+	ByteArray der = this->issueDerEncoded(serialNumber, subject, publicKey, notBefore, notAfter, extensions);
+	return new Certificate(der);
+}
+
+EVP_MD_CTX* IssuanceTemplate::newSigningContext() const throw (CertificationException)
+{
+	EVP_MD_CTX *ret;
+
+	ret = EVP_MD_CTX_new();
+	if (ret == NULL || EVP_DigestSignInit(ret, NULL, this->md, NULL, this->key) != 1)
+	{
+		EVP_MD_CTX_free(ret);
+		throw CertificationException(CertificationException::INTERNAL_ERROR, "IssuanceTemplate::newSigningContext");
+	}
+	return ret;
+}
+
+ByteArray IssuanceTemplate::encode(const BigInteger &serialNumber, const std::string &subject, X509_PUBKEY *publicKey,
+		DateTime &notBefore, DateTime &notAfter, std::vector<Extension *> &extensions,
+		EVP_MD_CTX *signingContext) const
+		throw (CertificationException, EncodeException)
+{
+	std::string content, validity, certificateExtensions, tbs, signature, ret;
+	std::vector<std::string> oids;
+	unsigned char keyIdentifier[SHA_DIGEST_LENGTH];
+	const unsigned char *keyData;
+	ByteArray der;
+	ASN1_INTEGER *serial;
+	EVP_MD_CTX *ctx;
+	size_t signatureLength;
+	unsigned int i;
+	int keyLength;
+	bool rc;
+
+	if (notBefore > notAfter)
+	{
+		throw CertificationException(CertificationException::INVALID_CERTIFICATE, "IssuanceTemplate::encode");
+	}
+	/* uma extensão só pode aparecer uma vez (RFC 5280, seção 4.2) */
+	oids = this->extensionOids;
+	if (this->subjectKeyIdentifier
+			&& !IssuanceTemplate::addExtensionOid(OBJ_nid2obj(NID_subject_key_identifier), oids))
+	{
+		throw CertificationException(CertificationException::ADDING_EXTENSION, "IssuanceTemplate::encode");
+	}
+	for (i = 0; i < extensions.size(); i++)
+	{
+		if (!IssuanceTemplate::addExtensionOid(extensions[i]->getObjectIdentifier().getObjectIdentifier(), oids))
+		{
+			throw CertificationException(CertificationException::ADDING_EXTENSION, "IssuanceTemplate::encode");
+		}
+	}
+
+	/* os campos variáveis, entre os fragmentos codificados na criação do modelo */
+	content = this->version;
+	serial = serialNumber.getASN1Value();
+	rc = IssuanceTemplate::append(serial, i2d_ASN1_INTEGER, content);
+	ASN1_INTEGER_free(serial);
+	content += this->algorithm;
+	content += this->issuer;
+	IssuanceTemplate::encodeTime(notBefore.getDateTime(), validity);
+	IssuanceTemplate::encodeTime(notAfter.getDateTime(), validity);
+	DerWriter::encodeHeader(0x30, validity.size(), content);
+	content += validity;
+	content += subject;
+	rc = rc && IssuanceTemplate::append(publicKey, i2d_X509_PUBKEY, content);
+
+	certificateExtensions = this->extensions;
+	if (rc && this->subjectKeyIdentifier)
+	{
+		rc = X509_PUBKEY_get0_param(NULL, &keyData, &keyLength, NULL, publicKey) == 1;
+	}
+	if (rc && this->subjectKeyIdentifier)
+	{
+		SHA1(keyData, keyLength, keyIdentifier);
+		certificateExtensions.append((const char *) SUBJECT_KEY_IDENTIFIER, sizeof(SUBJECT_KEY_IDENTIFIER));
+		certificateExtensions.append((const char *) keyIdentifier, sizeof(keyIdentifier));
+	}
+	for (i = 0; rc && i < extensions.size(); i++)
+	{
+		der = extensions[i]->getDerEncoded();
+		certificateExtensions.append((const char *) der.getDataPointer(), der.size());
+	}
+	if (!rc)
+	{
+		throw EncodeException(EncodeException::DER_ENCODE, "IssuanceTemplate::encode");
+	}
+	if (!certificateExtensions.empty())
+	{
+		if (this->version.empty())
+		{
+			/* só as extensões do certificado exigem v3 */
+			content.insert(0, "\xa0\x03\x02\x01\x02", 5);
+		}
+		DerWriter::encodeHeader(0xa3, DerWriter::getHeaderLength(certificateExtensions.size())
+				+ certificateExtensions.size(), content);
+		DerWriter::encodeHeader(0x30, certificateExtensions.size(), content);
+		content += certificateExtensions;
+	}
+	DerWriter::encodeHeader(0x30, content.size(), tbs);
+	tbs += content;
+
+	/* o TBSCertificate é resumido uma única vez */
+	ctx = EVP_MD_CTX_new();
+	/* nem todo tipo de chave permite copiar o contexto (EdDSA no OpenSSL 1.1.1) */
+	rc = (signingContext != NULL && EVP_MD_CTX_copy_ex(ctx, signingContext) == 1)
+			|| EVP_DigestSignInit(ctx, NULL, this->md, NULL, this->key) == 1;
+	rc = rc && EVP_DigestSign(ctx, NULL, &signatureLength, (const unsigned char *) tbs.data(), tbs.size()) == 1;
+	if (rc)
+	{
+		signature.resize(signatureLength);
+		rc = EVP_DigestSign(ctx, (unsigned char *) &signature[0], &signatureLength,
+				(const unsigned char *) tbs.data(), tbs.size()) == 1;
+		signature.resize(signatureLength);
+	}
+	EVP_MD_CTX_free(ctx);
+	if (!rc)
+	{
+		throw CertificationException(CertificationException::INTERNAL_ERROR, "IssuanceTemplate::encode");
+	}
+
+	content = tbs;
+	content += this->algorithm;
+	DerWriter::encodeHeader(0x03, signature.size() + 1, content);
+	content += '\0';
+	content += signature;
+	DerWriter::encodeHeader(0x30, content.size(), ret);
+	ret += content;
+	return ByteArray((const unsigned char *) ret.data(), ret.size());
+}
+
+void IssuanceTemplate::encodeTime(time_t time, std::string &out)
+{
+	char date[16];
+	unsigned int length;
+	bool utcTime;
+
+	utcTime = DateTime::isUTCTime(time);
+	length = DateTime::formatTime(time, utcTime, date);
+	DerWriter::encodeHeader(utcTime ? V_ASN1_UTCTIME : V_ASN1_GENERALIZEDTIME, length, out);
+	out.append(date, length);
+}
+
+bool IssuanceTemplate::addExtensionOid(const ASN1_OBJECT *object, std::vector<std::string> &oids)
+{
+	std::string oid((const char *) OBJ_get0_data(object), OBJ_length(object));
+
+	if (std::find(oids.begin(), oids.end(), oid) != oids.end())
+	{
+		return false;
+	}
+	oids.push_back(oid);
+	return true;
+}
@@ -59,10 +59,26 @@ GeneralNames IssuerAlternativeNameExtension::getIssuerAltName()
 	return this->issuerAltName;
 }
 
+void IssuerAlternativeNameExtension::encodeValue(DerWriter &writer)
+{
+	this->issuerAltName.encode(writer);
+}
+
+void IssuerAlternativeNameExtension::writeValue(DocumentWriter &writer)
+{
+	this->issuerAltName.write(writer);
+}
+
 X509_EXTENSION* IssuerAlternativeNameExtension::getX509Extension()
 {
 	X509_EXTENSION *ret;
 	GENERAL_NAMES *generalNames;
+	ret = this->encodeX509Extension(NID_issuer_alt_name);
+	if (ret != NULL)
+	{
+		return ret;
+	}
+	/* values the writer does not handle are encoded by OpenSSL */
 	generalNames = this->issuerAltName.getInternalGeneralNames();
 	ret = X509V3_EXT_i2d(NID_issuer_alt_name, this->critical?1:0, (void *)generalNames);
 	sk_GENERAL_NAME_free(generalNames);
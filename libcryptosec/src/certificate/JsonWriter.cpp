@@ -0,0 +1,203 @@
+#include <libcryptosec/certificate/JsonWriter.h>
+
+#include <stdio.h>
+
+JsonWriter::JsonWriter(std::ostream &stream)
+	: DocumentWriter(stream)
+{
+}
+
+JsonWriter::~JsonWriter()
+{
+}
+
+void JsonWriter::begin(const std::string &name)
+{
+	this->open(name, false);
+}
+
+void JsonWriter::beginList(const std::string &name)
+{
+	this->open(name, true);
+}
+
+void JsonWriter::end()
+{
+	if (this->levels.empty())
+	{
+		return;
+	}
+	this->stream << (this->levels.back().list ? ']' : '}');
+	this->levels.pop_back();
+	if (this->levels.empty())
+	{
+		/* the object around the root */
+		this->stream << '}';
+	}
+}
+
+void JsonWriter::writeField(const std::string &name, const std::string &value, bool text)
+{
+	this->separate(name);
+	if (text)
+	{
+		this->stream << '"';
+		this->escape(value);
+		this->stream << '"';
+	}
+	else
+	{
+		this->stream << value;
+	}
+	if (this->levels.empty())
+	{
+		/* a field at the root is the whole document */
+		this->stream << '}';
+	}
+}
+
+void JsonWriter::separate(const std::string &name)
+{
+	if (this->levels.empty())
+	{
+		this->stream << '{';
+	}
+	else if (this->levels.back().empty)
+	{
+		this->levels.back().empty = false;
+	}
+	else
+	{
+		this->stream << ',';
+	}
+	if (this->levels.empty() || !this->levels.back().list)
+	{
+		this->stream << '"';
+		this->escape(name);
+		this->stream << "\":";
+	}
+}
+
+void JsonWriter::open(const std::string &name, bool list)
+{
+	Level level;
+
+	this->separate(name);
+	this->stream << (list ? '[' : '{');
+	level.list = list;
+	level.empty = true;
+	this->levels.push_back(level);
+}
+
+void JsonWriter::escape(const std::string &value)
+{
+	std::string::size_type begin, i;
+	unsigned int length;
+	unsigned char c;
+	char temp[8];
+
+	begin = 0;
+	for (i = 0; i < value.size(); i++)
+	{
+		c = value[i];
+		if (c >= 0x80)
+		{
+			length = JsonWriter::getSequenceLength(value, i);
+			if (length > 0)
+			{
+				i += length - 1;
+				continue;
+			}
+		}
+		else if (c != '"' && c != '\\' && c >= 0x20)
+		{
+			continue;
+		}
+		this->stream.write(value.data() + begin, i - begin);
+		begin = i + 1;
+		switch (c)
+		{
+			case '"':
+				this->stream << "\\\"";
+				break;
+			case '\\':
+				this->stream << "\\\\";
+				break;
+			case '\n':
+				this->stream << "\\n";
+				break;
+			case '\r':
+				this->stream << "\\r";
+				break;
+			case '\t':
+				this->stream << "\\t";
+				break;
+			default:
+				/* each byte of an invalid sequence is replaced on its own */
+				sprintf(temp, "\\u%04x", (c < 0x80) ? c : 0xfffd);
+				this->stream << temp;
+				break;
+		}
+	}
+	this->stream.write(value.data() + begin, value.size() - begin);
+}
+
+unsigned int JsonWriter::getSequenceLength(const std::string &value, std::string::size_type pos)
+{
+	unsigned char c, next;
+	unsigned int length, i;
+	unsigned char min, max;
+
+	c = value[pos];
+	/* RFC 3629: no overlong forms, no surrogates and nothing above U+10FFFF */
+	min = 0x80;
+	max = 0xbf;
+	if (c >= 0xc2 && c <= 0xdf)
+	{
+		length = 2;
+	}
+	else if (c >= 0xe0 && c <= 0xef)
+	{
+		length = 3;
+		if (c == 0xe0)
+		{
+			min = 0xa0;
+		}
+		else if (c == 0xed)
+		{
+			max = 0x9f;
+		}
+	}
+	else if (c >= 0xf0 && c <= 0xf4)
+	{
+		length = 4;
+		if (c == 0xf0)
+		{
+			min = 0x90;
+		}
+		else if (c == 0xf4)
+		{
+			max = 0x8f;
+		}
+	}
+	else
+	{
+		return 0;
+	}
+	if (value.size() - pos < length)
+	{
+		return 0;
+	}
+	for (i = 1; i < length; i++)
+	{
+		next = value[pos + i];
+		if (next < min || next > max)
+		{
+			return 0;
+		}
+		/* only the second byte has a narrower range */
+		min = 0x80;
+		max = 0xbf;
+	}
+	return length;
+}
@@ -140,19 +140,22 @@ bool KeyUsageExtension::getUsage(KeyUsageExtension::Usage usage)
 //	
 //}
 
-X509_EXTENSION* KeyUsageExtension::getX509Extension()
+void KeyUsageExtension::encodeValue(DerWriter &writer)
 {
-	X509_EXTENSION *ret;
-	ASN1_BIT_STRING *bitString;
-	int i;
-	bitString = ASN1_BIT_STRING_new();
-	for (i=0;i<9;i++)
+	writer.writeBitString(this->usages, 9);
+}
+
+void KeyUsageExtension::writeValue(DocumentWriter &writer)
+{
+	for (int i = 0; i < 9; i++)
 	{
-		ASN1_BIT_STRING_set_bit(bitString, i, this->usages[i]?1:0);
+		writer.write(KeyUsageExtension::usage2Name((KeyUsageExtension::Usage) i), this->usages[i]);
 	}
-	ret = X509V3_EXT_i2d(NID_key_usage, (this->isCritical())?1:0, (void *)bitString);
-	ASN1_BIT_STRING_free(bitString);
-	return ret;
+}
+
+X509_EXTENSION* KeyUsageExtension::getX509Extension()
+{
+	return this->encodeX509Extension(NID_key_usage);
 }
 
 std::string KeyUsageExtension::usage2Name(KeyUsageExtension::Usage usage)
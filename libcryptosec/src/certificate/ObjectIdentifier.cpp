@@ -1,5 +1,7 @@
 #include <libcryptosec/certificate/ObjectIdentifier.h>
 
+#include <libcryptosec/certificate/ObjectIdentifierTable.h>
+
 ObjectIdentifier::ObjectIdentifier()
 {
 	this->asn1Object = ASN1_OBJECT_new();
@@ -45,12 +47,18 @@ std::string ObjectIdentifier::getXmlEncoded(std::string tab)
 std::string ObjectIdentifier::getOid()
 		throw (CertificationException)
 {
+	const ObjectIdentifierTable::Entry *entry;
 	char data[30];
 
 	if (!OBJ_get0_data(this->asn1Object))
 	{
 		throw CertificationException(CertificationException::SET_NO_VALUE, "ObjectIdentifier::getOid");
 	}
+	entry = ObjectIdentifierTable::findByDer(OBJ_get0_data(this->asn1Object), OBJ_length(this->asn1Object));
+	if (entry != NULL)
+	{
+		return entry->oid;
+	}
 	OBJ_obj2txt(data, 30, this->asn1Object, 1);
 	return std::string(data);
 }
@@ -62,12 +70,18 @@ int ObjectIdentifier::getNid() const
 
 std::string ObjectIdentifier::getName()
 {
+	const ObjectIdentifierTable::Entry *entry;
 	const char *data;
 	std::string ret;
 	if (!OBJ_get0_data(this->asn1Object))
 	{
 		return "undefined";
 	}
+	entry = ObjectIdentifierTable::findByDer(OBJ_get0_data(this->asn1Object), OBJ_length(this->asn1Object));
+	if (entry != NULL)
+	{
+		return entry->name;
+	}
 	if (OBJ_obj2nid(this->asn1Object))
 	{
 		data = OBJ_nid2sn(OBJ_obj2nid(this->asn1Object));
@@ -1,9 +1,19 @@
 #include <libcryptosec/certificate/ObjectIdentifierFactory.h>
 
+#include <libcryptosec/certificate/ObjectIdentifierTable.h>
+
 ObjectIdentifier ObjectIdentifierFactory::getObjectIdentifier(std::string oid)
 		throw (CertificationException)
 {
+	const ObjectIdentifierTable::Entry *entry;
 	ASN1_OBJECT *asn1Obj;
+
+	/* registered OIDs are neither parsed nor allocated again */
+	entry = ObjectIdentifierTable::findByOid(oid);
+	if (entry != NULL)
+	{
+		return ObjectIdentifier(OBJ_dup(entry->object));
+	}
 	asn1Obj = OBJ_txt2obj(oid.c_str(), 1);
 	if (!asn1Obj)
 	{
@@ -15,7 +25,14 @@ ObjectIdentifier ObjectIdentifierFactory::getObjectIdentifier(std::string oid)
 ObjectIdentifier ObjectIdentifierFactory::getObjectIdentifier(int nid)
 		throw (CertificationException)
 {
+	const ObjectIdentifierTable::Entry *entry;
 	ASN1_OBJECT *asn1Obj;
+
+	entry = ObjectIdentifierTable::findByNid(nid);
+	if (entry != NULL)
+	{
+		return ObjectIdentifier(OBJ_dup(entry->object));
+	}
 	asn1Obj = OBJ_nid2obj(nid);
 	if (!asn1Obj)
 	{
@@ -27,7 +44,7 @@ ObjectIdentifier ObjectIdentifierFactory::getObjectIdentifier(int nid)
 ObjectIdentifier ObjectIdentifierFactory::createObjectIdentifier(std::string oid, std::string name)
 		throw (CertificationException)
 {
-	ASN1_OBJECT *asn1Obj;
+	const ObjectIdentifierTable::Entry *entry;
 	int nid;
 
 	ObjectIdentifierFactory::getObjectIdentifier(oid);
@@ -38,10 +55,11 @@ ObjectIdentifier ObjectIdentifierFactory::createObjectIdentifier(std::string oid
 	{
 		throw CertificationException(CertificationException::INTERNAL_ERROR, "ObjectIdentifierFactory::createObjectIdentifier");
 	}
-	asn1Obj = OBJ_nid2obj(nid);
-	if (!asn1Obj)
+	/* the object belongs to OpenSSL's table, so the ObjectIdentifier gets a copy */
+	entry = ObjectIdentifierTable::findByNid(nid);
+	if (entry == NULL)
 	{
 		throw CertificationException(CertificationException::INTERNAL_ERROR, "ObjectIdentifierFactory::createObjectIdentifier");
 	}
-	return ObjectIdentifier(asn1Obj);
+	return ObjectIdentifier(OBJ_dup(entry->object));
 }
@@ -0,0 +1,224 @@
+#include <libcryptosec/certificate/ObjectIdentifierTable.h>
+
+#include <openssl/err.h>
+#include <string.h>
+
+CRYPTO_ONCE ObjectIdentifierTable::once = CRYPTO_ONCE_STATIC_INIT;
+CRYPTO_RWLOCK *ObjectIdentifierTable::lock = NULL;
+std::vector<ObjectIdentifierTable::Entry *> *ObjectIdentifierTable::byNid = NULL;
+std::vector<ObjectIdentifierTable::Entry *> *ObjectIdentifierTable::byOid = NULL;
+std::vector<ObjectIdentifierTable::Entry *> *ObjectIdentifierTable::byDer = NULL;
+unsigned int ObjectIdentifierTable::count = 0;
+int ObjectIdentifierTable::builtinNids = 0;
+
+ObjectIdentifierTable::ObjectIdentifierTable()
+{
+//Nothing to do. This constructor is never called.
+}
+
+void ObjectIdentifierTable::init()
+{
+	Entry *entry;
+
+	ObjectIdentifierTable::lock = CRYPTO_THREAD_lock_new();
+	ObjectIdentifierTable::byNid = new std::vector<Entry *>();
+	ObjectIdentifierTable::byOid = new std::vector<Entry *>(1024, (Entry *) NULL);
+	ObjectIdentifierTable::byDer = new std::vector<Entry *>(1024, (Entry *) NULL);
+
+	/* every NID known so far; the ones without an object leave errors that are discarded */
+	ObjectIdentifierTable::builtinNids = OBJ_new_nid(0);
+	ObjectIdentifierTable::byNid->resize(ObjectIdentifierTable::builtinNids, (Entry *) NULL);
+	ERR_set_mark();
+	for (int nid = 1; nid < ObjectIdentifierTable::builtinNids; nid++)
+	{
+		entry = ObjectIdentifierTable::newEntry(nid);
+		if (entry != NULL)
+		{
+			ObjectIdentifierTable::add(entry);
+		}
+	}
+	ERR_pop_to_mark();
+}
+
+const ObjectIdentifierTable::Entry* ObjectIdentifierTable::findByNid(int nid)
+{
+	const Entry *ret = NULL;
+	Entry *entry;
+
+	CRYPTO_THREAD_run_once(&ObjectIdentifierTable::once, ObjectIdentifierTable::init);
+	if (nid <= NID_undef)
+	{
+		return NULL;
+	}
+	CRYPTO_THREAD_read_lock(ObjectIdentifierTable::lock);
+	if ((unsigned int) nid < ObjectIdentifierTable::byNid->size())
+	{
+		ret = (*ObjectIdentifierTable::byNid)[nid];
+	}
+	CRYPTO_THREAD_unlock(ObjectIdentifierTable::lock);
+
+	/* objects created after the table was filled are added on their first lookup */
+	if (ret == NULL && nid >= ObjectIdentifierTable::builtinNids)
+	{
+		ERR_set_mark();
+		entry = ObjectIdentifierTable::newEntry(nid);
+		ERR_pop_to_mark();
+		if (entry != NULL)
+		{
+			CRYPTO_THREAD_write_lock(ObjectIdentifierTable::lock);
+			ret = ObjectIdentifierTable::add(entry);
+			CRYPTO_THREAD_unlock(ObjectIdentifierTable::lock);
+		}
+	}
+	return ret;
+}
+
+const ObjectIdentifierTable::Entry* ObjectIdentifierTable::findByOid(const std::string &oid)
+{
+	const Entry *ret;
+
+	CRYPTO_THREAD_run_once(&ObjectIdentifierTable::once, ObjectIdentifierTable::init);
+	CRYPTO_THREAD_read_lock(ObjectIdentifierTable::lock);
+	ret = ObjectIdentifierTable::find(*ObjectIdentifierTable::byOid, oid.data(), oid.size(), &Entry::oid);
+	CRYPTO_THREAD_unlock(ObjectIdentifierTable::lock);
+	return ret;
+}
+
+const ObjectIdentifierTable::Entry* ObjectIdentifierTable::findByDer(const unsigned char *data, unsigned int length)
+{
+	const Entry *ret;
+
+	CRYPTO_THREAD_run_once(&ObjectIdentifierTable::once, ObjectIdentifierTable::init);
+	CRYPTO_THREAD_read_lock(ObjectIdentifierTable::lock);
+	ret = ObjectIdentifierTable::find(*ObjectIdentifierTable::byDer, (const char *) data, length, &Entry::der);
+	CRYPTO_THREAD_unlock(ObjectIdentifierTable::lock);
+	return ret;
+}
+
+unsigned int ObjectIdentifierTable::size()
+{
+	unsigned int ret;
+
+	CRYPTO_THREAD_run_once(&ObjectIdentifierTable::once, ObjectIdentifierTable::init);
+	CRYPTO_THREAD_read_lock(ObjectIdentifierTable::lock);
+	ret = ObjectIdentifierTable::count;
+	CRYPTO_THREAD_unlock(ObjectIdentifierTable::lock);
+	return ret;
+}
+
+ObjectIdentifierTable::Entry* ObjectIdentifierTable::newEntry(int nid)
+{
+	ASN1_OBJECT *object;
+	const char *name;
+	Entry *ret;
+	int length;
+
+	object = OBJ_nid2obj(nid);
+	if (object == NULL || OBJ_length(object) == 0)
+	{
+		return NULL;
+	}
+	length = OBJ_obj2txt(NULL, 0, object, 1);
+	if (length <= 0)
+	{
+		return NULL;
+	}
+
+	ret = new Entry();
+	ret->object = object;
+	ret->nid = nid;
+	ret->der.assign((const char *) OBJ_get0_data(object), OBJ_length(object));
+	ret->oid.resize(length + 1);
+	OBJ_obj2txt(&ret->oid[0], length + 1, object, 1);
+	ret->oid.resize(length);
+	name = OBJ_nid2sn(nid);
+	ret->name = (name != NULL) ? name : ret->oid;
+	return ret;
+}
+
+ObjectIdentifierTable::Entry* ObjectIdentifierTable::add(Entry *entry)
+{
+	std::vector<Entry *> &nids = *ObjectIdentifierTable::byNid;
+	unsigned int nid = entry->nid;
+
+	/* called with the write lock held, or from init() */
+	if (nid < nids.size() && nids[nid] != NULL)
+	{
+		delete entry;
+		return nids[nid];
+	}
+	if (nid >= nids.size())
+	{
+		nids.resize(nid + 1, (Entry *) NULL);
+	}
+	nids[nid] = entry;
+	ObjectIdentifierTable::count++;
+	if (ObjectIdentifierTable::count * 2 > ObjectIdentifierTable::byOid->size())
+	{
+		ObjectIdentifierTable::rehash(*ObjectIdentifierTable::byOid, &Entry::oid);
+		ObjectIdentifierTable::rehash(*ObjectIdentifierTable::byDer, &Entry::der);
+	}
+	ObjectIdentifierTable::index(*ObjectIdentifierTable::byOid, entry, &Entry::oid);
+	ObjectIdentifierTable::index(*ObjectIdentifierTable::byDer, entry, &Entry::der);
+	return entry;
+}
+
+void ObjectIdentifierTable::index(std::vector<Entry *> &slots, Entry *entry, std::string Entry::*key)
+{
+	const std::string &value = entry->*key;
+	unsigned long mask = slots.size() - 1;
+	unsigned long i;
+
+	/* linear probing; an OID shared by two NIDs keeps the first one */
+	for (i = (unsigned long) (ObjectIdentifierTable::hash(value.data(), value.size()) & mask); slots[i] != NULL; i = (i + 1) & mask)
+	{
+		if (slots[i]->*key == value)
+		{
+			return;
+		}
+	}
+	slots[i] = entry;
+}
+
+void ObjectIdentifierTable::rehash(std::vector<Entry *> &slots, std::string Entry::*key)
+{
+	std::vector<Entry *> previous(slots.size() * 2, (Entry *) NULL);
+
+	previous.swap(slots);
+	for (unsigned int i = 0; i < previous.size(); i++)
+	{
+		if (previous[i] != NULL)
+		{
+			ObjectIdentifierTable::index(slots, previous[i], key);
+		}
+	}
+}
+
+const ObjectIdentifierTable::Entry* ObjectIdentifierTable::find(const std::vector<Entry *> &slots, const char *data,
+		unsigned int length, std::string Entry::*key)
+{
+	unsigned long mask = slots.size() - 1;
+	unsigned long i;
+
+	for (i = (unsigned long) (ObjectIdentifierTable::hash(data, length) & mask); slots[i] != NULL; i = (i + 1) & mask)
+	{
+		const std::string &value = slots[i]->*key;
+		if (value.size() == length && memcmp(value.data(), data, length) == 0)
+		{
+			return slots[i];
+		}
+	}
+	return NULL;
+}
+
+uint64_t ObjectIdentifierTable::hash(const char *data, unsigned int length)
+{
+	/* FNV-1a */
+	uint64_t ret = 14695981039346656037ULL;
+
+	for (unsigned int i = 0; i < length; i++)
+	{
+		ret = (ret ^ (unsigned char) data[i]) * 1099511628211ULL;
+	}
+	return ret;
+}
@@ -64,6 +64,38 @@ std::vector<PolicyQualifierInfo> PolicyInformation::getPoliciesQualifierInfo()
 	return this->policyQualifiers;
 }
 
+void PolicyInformation::encode(DerWriter &writer) const
+{
+	writer.begin(DerWriter::SEQUENCE);
+	writer.writeObject(this->policyIdentifier);
+	if (this->policyQualifiers.size())
+	{
+		writer.begin(DerWriter::SEQUENCE);
+		for (unsigned int i = 0; i < this->policyQualifiers.size(); i++)
+		{
+			this->policyQualifiers[i].encode(writer);
+		}
+		writer.end();
+	}
+	writer.end();
+}
+
+void PolicyInformation::write(DocumentWriter &writer)
+{
+	writer.begin("policyInformation");
+	writer.write("policyIdentifier", this->policyIdentifier.getOid());
+	if (this->policyQualifiers.size() > 0)
+	{
+		writer.beginList("policyQualifiers");
+		for (unsigned int i = 0; i < this->policyQualifiers.size(); i++)
+		{
+			this->policyQualifiers[i].write(writer);
+		}
+		writer.end();
+	}
+	writer.end();
+}
+
 POLICYINFO* PolicyInformation::getPolicyInfo() const
 {
 	POLICYINFO *ret;
@@ -107,6 +107,47 @@ PolicyQualifierInfo::Type PolicyQualifierInfo::getType()
 	return this->type;
 }
 
+void PolicyQualifierInfo::encode(DerWriter &writer) const
+{
+	switch (this->type)
+	{
+		case PolicyQualifierInfo::CPS_URI:
+			writer.begin(DerWriter::SEQUENCE);
+			writer.writeObject(this->objectIdentifier);
+			writer.writePrimitive(DerWriter::IA5_STRING, this->cpsUri);
+			writer.end();
+			break;
+		case PolicyQualifierInfo::USER_NOTICE:
+			writer.begin(DerWriter::SEQUENCE);
+			writer.writeObject(this->objectIdentifier);
+			this->userNotice.encode(writer);
+			writer.end();
+			break;
+		default:
+			writer.fail();
+			break;
+	}
+}
+
+void PolicyQualifierInfo::write(DocumentWriter &writer)
+{
+	writer.begin("policyQualifierInfo");
+	switch (this->type)
+	{
+		case PolicyQualifierInfo::USER_NOTICE:
+			writer.write("policyQualifierId", this->objectIdentifier.getOid());
+			this->userNotice.write(writer);
+			break;
+		case PolicyQualifierInfo::CPS_URI:
+			writer.write("policyQualifierId", this->objectIdentifier.getOid());
+			writer.write("cPSuri", this->cpsUri);
+			break;
+		default:
+			break;
+	}
+	writer.end();
+}
+
 POLICYQUALINFO* PolicyQualifierInfo::getPolicyQualInfo() const
 {
 	POLICYQUALINFO *ret;
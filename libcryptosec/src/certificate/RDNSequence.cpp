@@ -1,12 +1,21 @@
 #include <libcryptosec/certificate/RDNSequence.h>
 
+#include <libcryptosec/certificate/DerWriter.h>
+
+#include <openssl/sha.h>
+
+CRYPTO_ONCE RDNSequence::encodingOnce = CRYPTO_ONCE_STATIC_INIT;
+CRYPTO_RWLOCK *RDNSequence::encodingLock = NULL;
+
 RDNSequence::RDNSequence()
+	: encoding(NULL)
 {
 	this->newEntries.clear();
 //	printf("NUM: %d\n", this->newEntries.size());
 }
 
 RDNSequence::RDNSequence(X509_NAME *rdn)
+	: encoding(NULL)
 {
 	X509_NAME_ENTRY *nameEntry;
 	int i, num;
@@ -58,6 +67,7 @@ RDNSequence::RDNSequence(X509_NAME *rdn)
 }
 
 RDNSequence::RDNSequence(STACK_OF(X509_NAME_ENTRY) *entries)
+	: encoding(NULL)
 {
 	X509_NAME_ENTRY *nameEntry;
 	int i, num;
@@ -111,8 +121,21 @@ RDNSequence::RDNSequence(STACK_OF(X509_NAME_ENTRY) *entries)
 	}
 }
 
+RDNSequence::RDNSequence(const RDNSequence& value)
+	: newEntries(value.newEntries), encoding(NULL)
+{
+	CRYPTO_THREAD_run_once(&RDNSequence::encodingOnce, RDNSequence::initEncodingLock);
+	CRYPTO_THREAD_read_lock(RDNSequence::encodingLock);
+	if (value.encoding != NULL)
+	{
+		this->encoding = new Encoding(*value.encoding);
+	}
+	CRYPTO_THREAD_unlock(RDNSequence::encodingLock);
+}
+
 RDNSequence::~RDNSequence()
 {
+	delete this->encoding;
 }
 
 std::string RDNSequence::getXmlEncoded()
@@ -160,6 +183,73 @@ std::string RDNSequence::getXmlEncoded(std::string tab)
 	return ret;
 }
 
+void RDNSequence::write(DocumentWriter &writer, const std::string &name)
+{
+	std::vector<std::pair<ObjectIdentifier, std::string> >::iterator iterEntries;
+	RDNSequence::EntryType type;
+
+	writer.beginList(name);
+	for (iterEntries = this->newEntries.begin(); iterEntries != this->newEntries.end(); iterEntries++)
+	{
+		writer.begin("attribute");
+		type = RDNSequence::id2Type(iterEntries->first.getNid());
+		if (type != RDNSequence::UNKNOWN)
+		{
+			writer.write("type", RDNSequence::getNameId(type));
+		}
+		else
+		{
+			writer.write("type", iterEntries->first.getOid());
+		}
+		writer.write("value", iterEntries->second);
+		writer.end();
+	}
+	writer.end();
+}
+
+void RDNSequence::write(DocumentWriter &writer, const std::string &name, X509_NAME *rdn)
+{
+	X509_NAME_ENTRY *entry;
+	ASN1_OBJECT *object;
+	RDNSequence::EntryType type;
+	unsigned char *utf8;
+	char oid[128];
+	int i, num, length;
+
+	writer.beginList(name);
+	num = (rdn != NULL) ? X509_NAME_entry_count(rdn) : 0;
+	for (i = 0; i < num; i++)
+	{
+		entry = X509_NAME_get_entry(rdn, i);
+		object = X509_NAME_ENTRY_get_object(entry);
+		writer.begin("attribute");
+		type = RDNSequence::id2Type(OBJ_obj2nid(object));
+		if (type != RDNSequence::UNKNOWN)
+		{
+			writer.write("type", RDNSequence::getNameId(type));
+		}
+		else
+		{
+			OBJ_obj2txt(oid, sizeof(oid), object, 1);
+			writer.write("type", oid);
+		}
+		/* strings that cannot be converted, like a BMPString with an odd length, are written empty */
+		utf8 = NULL;
+		length = ASN1_STRING_to_UTF8(&utf8, X509_NAME_ENTRY_get_data(entry));
+		if (length > 0)
+		{
+			writer.write("value", std::string((const char *) utf8, length));
+		}
+		else
+		{
+			writer.write("value", "");
+		}
+		OPENSSL_free(utf8);
+		writer.end();
+	}
+	writer.end();
+}
+
 void RDNSequence::addEntry(RDNSequence::EntryType type, std::string value)
 {
 //	this->entries[type].push_back(value);
@@ -170,6 +260,7 @@ void RDNSequence::addEntry(RDNSequence::EntryType type, std::string value)
 		oneEntry.first = ObjectIdentifierFactory::getObjectIdentifier(RDNSequence::type2Id(type));
 		oneEntry.second = value;
 		this->newEntries.push_back(oneEntry);
+		this->resetEncoding();
 	}
 }
 
@@ -220,7 +311,40 @@ std::vector<std::pair<ObjectIdentifier, std::string> > RDNSequence::getEntries()
 	return this->newEntries;
 }
 
-X509_NAME* RDNSequence::getX509Name()
+X509_NAME* RDNSequence::getX509Name() const
+{
+	const Encoding *encoding;
+	const unsigned char *p;
+	X509_NAME *ret = NULL;
+
+	/* the first call returns the name built for the encoding; the next ones decode the cached DER */
+	encoding = this->getEncoding(&ret);
+	if (ret == NULL)
+	{
+		p = (const unsigned char *) encoding->der.data();
+		ret = d2i_X509_NAME(NULL, &p, encoding->der.size());
+	}
+	if (ret == NULL)
+	{
+		ret = this->buildX509Name();
+	}
+	return ret;
+}
+
+ByteArray RDNSequence::getDerEncoded() const
+{
+	const Encoding *encoding;
+
+	encoding = this->getEncoding();
+	return ByteArray((const unsigned char *) encoding->der.data(), encoding->der.size());
+}
+
+unsigned long RDNSequence::getHash() const
+{
+	return this->getEncoding()->hash;
+}
+
+X509_NAME* RDNSequence::buildX509Name() const
 {
 //	unsigned int j;
 	X509_NAME *ret;
@@ -231,7 +355,7 @@ X509_NAME* RDNSequence::getX509Name()
 	
 //	std::vector<std::pair<std::string, std::string> >::iterator iterUnknown;
 
-	std::vector<std::pair<ObjectIdentifier, std::string> >::iterator iterEntries;
+	std::vector<std::pair<ObjectIdentifier, std::string> >::const_iterator iterEntries;
 	
 	ret = X509_NAME_new();
 	
@@ -451,8 +575,184 @@ int RDNSequence::type2Id(RDNSequence::EntryType type)
 	return ret;
 }
 
+const RDNSequence::Encoding* RDNSequence::getEncoding(X509_NAME **name) const
+{
+	unsigned char md[SHA_DIGEST_LENGTH];
+	unsigned char *der = NULL;
+	Encoding *ret;
+	X509_NAME *built;
+	int length;
+
+	CRYPTO_THREAD_run_once(&RDNSequence::encodingOnce, RDNSequence::initEncodingLock);
+	CRYPTO_THREAD_read_lock(RDNSequence::encodingLock);
+	ret = this->encoding;
+	CRYPTO_THREAD_unlock(RDNSequence::encodingLock);
+	if (ret != NULL)
+	{
+		return ret;
+	}
+
+	/* the encoding is built outside the lock; if two threads race, the first one is kept */
+	built = this->buildX509Name();
+	ret = new Encoding();
+	length = i2d_X509_NAME(built, &der);
+	if (length > 0)
+	{
+		ret->der.assign((const char *) der, length);
+		OPENSSL_free(der);
+	}
+	/* getX509Name() puts every entry in its own RDN, so the canonical form can be built entry by entry */
+	for (int i = 0; i < X509_NAME_entry_count(built); i++)
+	{
+		RDNSequence::appendCanonical(X509_NAME_get_entry(built, i), ret->canonical);
+	}
+	SHA1((const unsigned char *) ret->canonical.data(), ret->canonical.size(), md);
+	ret->hash = ((unsigned long) md[0] | ((unsigned long) md[1] << 8) | ((unsigned long) md[2] << 16)
+			| ((unsigned long) md[3] << 24)) & 0xffffffffL;
+
+	CRYPTO_THREAD_write_lock(RDNSequence::encodingLock);
+	if (this->encoding == NULL)
+	{
+		this->encoding = ret;
+	}
+	else
+	{
+		delete ret;
+		ret = this->encoding;
+	}
+	CRYPTO_THREAD_unlock(RDNSequence::encodingLock);
+
+	if (name != NULL)
+	{
+		*name = built;
+	}
+	else
+	{
+		X509_NAME_free(built);
+	}
+	return ret;
+}
+
+void RDNSequence::initEncodingLock()
+{
+	RDNSequence::encodingLock = CRYPTO_THREAD_lock_new();
+}
+
+void RDNSequence::resetEncoding()
+{
+	CRYPTO_THREAD_run_once(&RDNSequence::encodingOnce, RDNSequence::initEncodingLock);
+	CRYPTO_THREAD_write_lock(RDNSequence::encodingLock);
+	delete this->encoding;
+	this->encoding = NULL;
+	CRYPTO_THREAD_unlock(RDNSequence::encodingLock);
+}
+
+void RDNSequence::appendCanonical(X509_NAME_ENTRY *entry, std::string &out)
+{
+	/* same rules as the canonical encoding OpenSSL uses for X509_NAME_hash() and X509_NAME_cmp() */
+	const unsigned long textTypes = B_ASN1_UTF8STRING | B_ASN1_BMPSTRING | B_ASN1_UNIVERSALSTRING
+			| B_ASN1_PRINTABLESTRING | B_ASN1_T61STRING | B_ASN1_IA5STRING | B_ASN1_VISIBLESTRING;
+	X509_NAME_ENTRY *canonicalEntry = NULL;
+	unsigned char *utf8 = NULL, *der = NULL;
+	ASN1_STRING *value;
+	std::string text;
+	int length, begin, end;
+
+	value = X509_NAME_ENTRY_get_data(entry);
+	if (ASN1_tag2bit(ASN1_STRING_type(value)) & textTypes)
+	{
+		/* UTF-8, without leading and trailing spaces, with inner spaces collapsed and ASCII in lower case */
+		length = ASN1_STRING_to_UTF8(&utf8, value);
+		begin = 0;
+		end = (length > 0) ? length : 0;
+		while (begin < end && RDNSequence::isSpace(utf8[begin]))
+		{
+			begin++;
+		}
+		while (end > begin && RDNSequence::isSpace(utf8[end - 1]))
+		{
+			end--;
+		}
+		while (begin < end)
+		{
+			if (utf8[begin] > 0x7f)
+			{
+				text += (char) utf8[begin++];
+			}
+			else if (RDNSequence::isSpace(utf8[begin]))
+			{
+				text += ' ';
+				while (begin < end && RDNSequence::isSpace(utf8[begin]))
+				{
+					begin++;
+				}
+			}
+			else
+			{
+				text += (char) ((utf8[begin] >= 'A' && utf8[begin] <= 'Z') ? utf8[begin] + ('a' - 'A') : utf8[begin]);
+				begin++;
+			}
+		}
+		OPENSSL_free(utf8);
+		canonicalEntry = X509_NAME_ENTRY_create_by_OBJ(NULL, X509_NAME_ENTRY_get_object(entry), V_ASN1_UTF8STRING,
+				(const unsigned char *) text.data(), text.size());
+		entry = canonicalEntry;
+	}
+	length = (entry != NULL) ? i2d_X509_NAME_ENTRY(entry, &der) : 0;
+	X509_NAME_ENTRY_free(canonicalEntry);
+	if (length <= 0)
+	{
+		return;
+	}
+
+	/* each RDN is a SET with a single entry */
+	DerWriter::encodeHeader(0x31, length, out);
+	out.append((const char *) der, length);
+	OPENSSL_free(der);
+}
+
+bool RDNSequence::isSpace(unsigned char c)
+{
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
 RDNSequence& RDNSequence::operator =(const RDNSequence& value)
 {
+	Encoding *encoding = NULL;
+
+	if (this == &value)
+	{
+		return *this;
+	}
 	this->newEntries = value.getEntries();
+	CRYPTO_THREAD_run_once(&RDNSequence::encodingOnce, RDNSequence::initEncodingLock);
+	CRYPTO_THREAD_read_lock(RDNSequence::encodingLock);
+	if (value.encoding != NULL)
+	{
+		encoding = new Encoding(*value.encoding);
+	}
+	CRYPTO_THREAD_unlock(RDNSequence::encodingLock);
+	CRYPTO_THREAD_write_lock(RDNSequence::encodingLock);
+	delete this->encoding;
+	this->encoding = encoding;
+	CRYPTO_THREAD_unlock(RDNSequence::encodingLock);
 	return *this;
 }
+
+bool RDNSequence::operator ==(const RDNSequence& value) const
+{
+	const Encoding *encoding, *other;
+
+	if (this == &value)
+	{
+		return true;
+	}
+	encoding = this->getEncoding();
+	other = value.getEncoding();
+	return encoding->hash == other->hash && encoding->canonical == other->canonical;
+}
+
+bool RDNSequence::operator !=(const RDNSequence& value) const
+{
+	return !(*this == value);
+}
@@ -0,0 +1,394 @@
+#include <libcryptosec/certificate/RevocationSnapshot.h>
+
+#include <libcryptosec/certificate/CertificateRevocationListReader.h>
+#include <libcryptosec/BloomFilter.h>
+
+#include <openssl/sha.h>
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+#define SNAPSHOT_MAGIC			"LCSRSNAP"
+#define SNAPSHOT_VERSION		1
+#define SNAPSHOT_BLOOM			0x01
+
+/* posições dos campos do cabeçalho; a assinatura cobre os primeiros SIGNED_SIZE bytes */
+#define OFFSET_VERSION			8
+#define OFFSET_FLAGS			12
+#define OFFSET_COUNT			16
+#define OFFSET_SERIAL_WIDTH		24
+#define OFFSET_BLOOM_HASHES		28
+#define OFFSET_BLOOM_BITS		32
+#define OFFSET_THIS_UPDATE		40
+#define OFFSET_NEXT_UPDATE		48
+#define OFFSET_CRL_HASH			56
+#define OFFSET_BODY_HASH		88
+#define SIGNED_SIZE				120
+#define HEADER_SIZE				124
+
+/* RFC 5280 limita o número de série a 20 bytes; a largura é guardada em um byte */
+#define MAX_SERIAL_WIDTH		255
+#define MAX_BLOOM_HASHES		16
+
+static void put32(unsigned char *p, unsigned long value)
+{
+	p[0] = (value >> 24) & 0xff;
+	p[1] = (value >> 16) & 0xff;
+	p[2] = (value >> 8) & 0xff;
+	p[3] = value & 0xff;
+}
+
+static void put64(unsigned char *p, unsigned long long value)
+{
+	put32(p, (unsigned long) (value >> 32));
+	put32(p + 4, (unsigned long) (value & 0xffffffffUL));
+}
+
+static unsigned long get32(const unsigned char *p)
+{
+	return ((unsigned long) p[0] << 24) | ((unsigned long) p[1] << 16) | ((unsigned long) p[2] << 8) | p[3];
+}
+
+static unsigned long long get64(const unsigned char *p)
+{
+	return ((unsigned long long) get32(p) << 32) | get32(p + 4);
+}
+
+/*
+ * Ordena as entradas pelo tamanho e conteúdo do número de série, que é uma
+ * ordem total porque o DER exige a codificação mínima do INTEGER.
+ */
+struct RecordLess
+{
+	const unsigned char *records;
+	unsigned int recordSize;
+	unsigned int keySize;
+
+	bool operator()(unsigned long a, unsigned long b) const
+	{
+		return memcmp(this->records + a * this->recordSize, this->records + b * this->recordSize, this->keySize) < 0;
+	}
+};
+
+RevocationSnapshot::RevocationSnapshot(std::string path, PublicKey &publicKey, ByteArray &crlHash)
+		throw (EncodeException, CertificationException)
+{
+	const unsigned char *data;
+	unsigned char digest[SHA256_DIGEST_LENGTH];
+	unsigned long long size, expected, signatureLength, bloomBytes;
+	unsigned long flags;
+	EVP_MD_CTX *ctx;
+	int rc;
+
+	this->file = new MappedFile(path);
+	try
+	{
+		data = this->file->getData();
+		size = this->file->getSize();
+		if (size < HEADER_SIZE || memcmp(data, SNAPSHOT_MAGIC, 8) != 0
+				|| get32(data + OFFSET_VERSION) != SNAPSHOT_VERSION)
+		{
+			throw EncodeException(EncodeException::BUFFER_READING, "RevocationSnapshot::RevocationSnapshot");
+		}
+		flags = get32(data + OFFSET_FLAGS);
+		this->count = get64(data + OFFSET_COUNT);
+		this->serialWidth = get32(data + OFFSET_SERIAL_WIDTH);
+		this->bloomHashes = get32(data + OFFSET_BLOOM_HASHES);
+		this->bloomBits = get64(data + OFFSET_BLOOM_BITS);
+		this->thisUpdate = (time_t) (long long) get64(data + OFFSET_THIS_UPDATE);
+		this->nextUpdate = (time_t) (long long) get64(data + OFFSET_NEXT_UPDATE);
+		signatureLength = get32(data + SIGNED_SIZE);
+		this->recordSize = this->serialWidth + 10;
+		bloomBytes = this->bloomBits / 8;
+
+		/* os tamanhos vêm do arquivo: são limitados antes de qualquer multiplicação */
+		if (this->serialWidth > MAX_SERIAL_WIDTH || this->bloomBits % 8 != 0 || this->count > size
+				|| bloomBytes > size || signatureLength > size
+				|| ((flags & SNAPSHOT_BLOOM) != 0) != (this->bloomBits > 0)
+				|| (this->bloomBits > 0 && (this->bloomHashes == 0 || this->bloomHashes > MAX_BLOOM_HASHES)))
+		{
+			throw EncodeException(EncodeException::BUFFER_READING, "RevocationSnapshot::RevocationSnapshot");
+		}
+		expected = HEADER_SIZE + signatureLength + bloomBytes + this->count * this->recordSize;
+		if (expected != size)
+		{
+			throw EncodeException(EncodeException::BUFFER_READING, "RevocationSnapshot::RevocationSnapshot");
+		}
+
+		ctx = RevocationSnapshot::newSigningContext(publicKey.getEvpPkey(), false);
+		rc = (ctx != NULL) ? EVP_DigestVerify(ctx, data + HEADER_SIZE, signatureLength, data, SIGNED_SIZE) : 0;
+		EVP_MD_CTX_free(ctx);
+		if (rc != 1)
+		{
+			throw CertificationException(CertificationException::INVALID_CRL, "RevocationSnapshot::RevocationSnapshot");
+		}
+		if (crlHash.size() != SHA256_DIGEST_LENGTH
+				|| memcmp(crlHash.getDataPointer(), data + OFFSET_CRL_HASH, SHA256_DIGEST_LENGTH) != 0)
+		{
+			throw CertificationException(CertificationException::INVALID_CRL, "RevocationSnapshot::RevocationSnapshot");
+		}
+		SHA256(data + HEADER_SIZE + signatureLength, size - HEADER_SIZE - signatureLength, digest);
+		if (memcmp(digest, data + OFFSET_BODY_HASH, SHA256_DIGEST_LENGTH) != 0)
+		{
+			throw CertificationException(CertificationException::INVALID_CRL, "RevocationSnapshot::RevocationSnapshot");
+		}
+	}
+	catch (...)
+	{
+		delete this->file;
+		throw;
+	}
+	this->bloom = (this->bloomBits > 0) ? data + HEADER_SIZE + signatureLength : NULL;
+	this->records = data + HEADER_SIZE + signatureLength + bloomBytes;
+	this->crlHash = ByteArray(data + OFFSET_CRL_HASH, SHA256_DIGEST_LENGTH);
+}
+
+RevocationSnapshot::~RevocationSnapshot()
+{
+	delete this->file;
+}
+
+void RevocationSnapshot::write(CertificateRevocationList &crl, PrivateKey &privateKey, std::ostream &out,
+		unsigned int bloomBitsPerEntry) throw (EncodeException, CertificationException)
+{
+	ByteArray der = crl.getDerEncoded();
+	CertificateRevocationListReader::Entry entry;
+	std::vector<unsigned char> records, bloom;
+	std::vector<unsigned long> order;
+	unsigned char header[HEADER_SIZE];
+	unsigned char *record;
+	std::string body, signature;
+	unsigned long count, width, recordSize, i, bloomBits, bloomHashes;
+	unsigned long long date;
+	size_t signatureLength;
+	RecordLess less;
+	EVP_MD_CTX *ctx;
+	int rc;
+
+	/* primeira passada: quantidade de entradas e largura do número de série */
+	CertificateRevocationListReader sizes(der.getDataPointer(), der.size());
+	count = 0;
+	width = 0;
+	while (sizes.next(entry))
+	{
+		width = std::max(width, entry.serialNumberLength);
+		count++;
+	}
+	if (width > MAX_SERIAL_WIDTH)
+	{
+		throw EncodeException(EncodeException::BUFFER_WRITING, "RevocationSnapshot::write");
+	}
+	recordSize = width + 10;
+
+	CertificateRevocationListReader reader(der.getDataPointer(), der.size());
+	records.resize(count * recordSize);
+	order.resize(count);
+	for (i = 0; reader.next(entry); i++)
+	{
+		record = &records[i * recordSize];
+		record[0] = (unsigned char) entry.serialNumberLength;
+		memcpy(record + 1, entry.serialNumber, entry.serialNumberLength);
+		date = (unsigned long long) (long long) entry.revocationDate;
+		put64(record + 1 + width, date);
+		record[9 + width] = (unsigned char) RevokedCertificate::toCrlReason(entry.reasonCode);
+		order[i] = i;
+	}
+	less.records = records.empty() ? NULL : &records[0];
+	less.recordSize = recordSize;
+	less.keySize = width + 1;
+	std::sort(order.begin(), order.end(), less);
+
+	bloomBits = 0;
+	bloomHashes = 0;
+	if (bloomBitsPerEntry > 0)
+	{
+		bloomBits = std::max(64UL, count * bloomBitsPerEntry);
+		bloomBits = (bloomBits + 7) / 8 * 8;
+		/* k = (m/n) ln 2 minimiza a taxa de falsos positivos */
+		bloomHashes = std::min((unsigned long) MAX_BLOOM_HASHES, std::max(1UL, (unsigned long) (bloomBitsPerEntry * 0.693 + 0.5)));
+		bloom.resize(bloomBits / 8);
+		for (i = 0; i < count; i++)
+		{
+			record = &records[i * recordSize];
+			BloomFilter::set(&bloom[0], bloomBits, bloomHashes, BloomFilter::hash(record + 1, record[0]));
+		}
+	}
+
+	body.reserve(bloom.size() + records.size());
+	if (!bloom.empty())
+	{
+		body.append((const char *) &bloom[0], bloom.size());
+	}
+	for (i = 0; i < count; i++)
+	{
+		body.append((const char *) &records[order[i] * recordSize], recordSize);
+	}
+
+	memset(header, 0, sizeof(header));
+	memcpy(header, SNAPSHOT_MAGIC, 8);
+	put32(header + OFFSET_VERSION, SNAPSHOT_VERSION);
+	put32(header + OFFSET_FLAGS, (bloomBits > 0) ? SNAPSHOT_BLOOM : 0);
+	put64(header + OFFSET_COUNT, count);
+	put32(header + OFFSET_SERIAL_WIDTH, width);
+	put32(header + OFFSET_BLOOM_HASHES, bloomHashes);
+	put64(header + OFFSET_BLOOM_BITS, bloomBits);
+	put64(header + OFFSET_THIS_UPDATE, (unsigned long long) (long long) reader.getThisUpdate());
+	put64(header + OFFSET_NEXT_UPDATE, (unsigned long long) (long long) reader.getNextUpdate());
+	SHA256(der.getDataPointer(), der.size(), header + OFFSET_CRL_HASH);
+	SHA256((const unsigned char *) body.data(), body.size(), header + OFFSET_BODY_HASH);
+
+	ctx = RevocationSnapshot::newSigningContext(privateKey.getEvpPkey(), true);
+	rc = (ctx != NULL) ? EVP_DigestSign(ctx, NULL, &signatureLength, header, SIGNED_SIZE) : 0;
+	if (rc == 1)
+	{
+		signature.resize(signatureLength);
+		rc = EVP_DigestSign(ctx, (unsigned char *) &signature[0], &signatureLength, header, SIGNED_SIZE);
+		signature.resize(signatureLength);
+	}
+	EVP_MD_CTX_free(ctx);
+	if (rc != 1)
+	{
+		throw CertificationException(CertificationException::INTERNAL_ERROR, "RevocationSnapshot::write");
+	}
+	put32(header + SIGNED_SIZE, signature.size());
+
+	out.write((const char *) header, HEADER_SIZE);
+	out.write(signature.data(), signature.size());
+	out.write(body.data(), body.size());
+	if (!out)
+	{
+		throw EncodeException(EncodeException::BUFFER_WRITING, "RevocationSnapshot::write");
+	}
+}
+
+ByteArray RevocationSnapshot::getCrlHash(CertificateRevocationList &crl) throw (EncodeException)
+{
+	ByteArray der = crl.getDerEncoded();
+	return RevocationSnapshot::getCrlHash(der.getDataPointer(), der.size());
+}
+
+ByteArray RevocationSnapshot::getCrlHash(const unsigned char *der, unsigned long length)
+{
+	ByteArray ret(SHA256_DIGEST_LENGTH);
+	SHA256(der, length, ret.getDataPointer());
+	return ret;
+}
+
+bool RevocationSnapshot::isRevoked(const BigInteger &serialNumber) const
+{
+	return (this->find(serialNumber) != NULL);
+}
+
+RevokedCertificate* RevocationSnapshot::getRevocation(const BigInteger &serialNumber) const
+{
+	const unsigned char *record;
+	RevokedCertificate *ret;
+	DateTime date;
+
+	record = this->find(serialNumber);
+	if (record == NULL)
+	{
+		return NULL;
+	}
+	date = DateTime((time_t) (long long) get64(record + 1 + this->serialWidth));
+	ret = new RevokedCertificate();
+	ret->setCertificateSerialNumber(serialNumber);
+	ret->setRevocationDate(date);
+	/* the record keeps the CRLReason value; bytes outside RFC 5280 map to UNSPECIFIED */
+	ret->setReasonCode(RevokedCertificate::fromCrlReason(record[9 + this->serialWidth]));
+	return ret;
+}
+
+unsigned long RevocationSnapshot::getCount() const
+{
+	return this->count;
+}
+
+time_t RevocationSnapshot::getThisUpdate() const
+{
+	return this->thisUpdate;
+}
+
+time_t RevocationSnapshot::getNextUpdate() const
+{
+	return this->nextUpdate;
+}
+
+ByteArray RevocationSnapshot::getCrlHash() const
+{
+	return this->crlHash;
+}
+
+bool RevocationSnapshot::hasBloomFilter() const
+{
+	return (this->bloom != NULL);
+}
+
+const unsigned char* RevocationSnapshot::find(const BigInteger &serialNumber) const
+{
+	std::string content, key;
+	unsigned long low, high, middle;
+	const unsigned char *record;
+	int cmp;
+
+	if (!CertificateRevocationListReader::getSerialNumberContent(serialNumber, content) || content.size() > this->serialWidth)
+	{
+		return NULL;
+	}
+	if (this->bloom && !BloomFilter::test(this->bloom, this->bloomBits, this->bloomHashes,
+			BloomFilter::hash((const unsigned char *) content.data(), content.size())))
+	{
+		return NULL;
+	}
+	key.assign(1, (char) content.size());
+	key.append(content);
+	key.resize(this->serialWidth + 1, '\0');
+
+	low = 0;
+	high = this->count;
+	while (low < high)
+	{
+		middle = low + (high - low) / 2;
+		record = this->records + middle * this->recordSize;
+		cmp = memcmp(record, key.data(), key.size());
+		if (cmp == 0)
+		{
+			return record;
+		}
+		if (cmp < 0)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return NULL;
+}
+
+EVP_MD_CTX* RevocationSnapshot::newSigningContext(EVP_PKEY *pkey, bool sign)
+{
+	EVP_MD_CTX *ctx;
+	const EVP_MD *md;
+	int rc;
+
+	/* Ed25519 e Ed448 assinam a mensagem inteira, sem resumo separado */
+	md = (EVP_PKEY_base_id(pkey) == EVP_PKEY_ED25519 || EVP_PKEY_base_id(pkey) == EVP_PKEY_ED448) ? NULL : EVP_sha256();
+	ctx = EVP_MD_CTX_new();
+	if (sign)
+	{
+		rc = EVP_DigestSignInit(ctx, NULL, md, NULL, pkey);
+	}
+	else
+	{
+		rc = EVP_DigestVerifyInit(ctx, NULL, md, NULL, pkey);
+	}
+	if (rc != 1)
+	{
+		EVP_MD_CTX_free(ctx);
+		return NULL;
+	}
+	return ctx;
+}
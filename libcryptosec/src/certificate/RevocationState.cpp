@@ -0,0 +1,269 @@
+#include <libcryptosec/certificate/RevocationState.h>
+
+#include <libcryptosec/certificate/CertificateRevocationListReader.h>
+
+#include <algorithm>
+
+RevocationState::RevocationState(CertificateRevocationList &base, PublicKey &issuerKey)
+		throw (CertificationException, EncodeException)
+{
+	ASN1_INTEGER *baseNumber;
+
+	baseNumber = (ASN1_INTEGER *) X509_CRL_get_ext_d2i(base.getX509Crl(), NID_delta_crl, NULL, NULL);
+	if (baseNumber != NULL)
+	{
+		ASN1_INTEGER_free(baseNumber);
+		throw CertificationException(CertificationException::INVALID_CRL, "RevocationState::RevocationState");
+	}
+	this->snapshot = new Snapshot();
+	try
+	{
+		this->snapshot->crlNumber = base.getSerialNumberBigInt();
+		RevocationState::readEntries(base, issuerKey.getEvpPkey(), *this->snapshot);
+	}
+	catch (...)
+	{
+		delete this->snapshot;
+		throw;
+	}
+	RevocationState::sort(this->snapshot->entries);
+	this->snapshot->generation = 0;
+	this->issuer = X509_NAME_dup(X509_CRL_get_issuer(base.getX509Crl()));
+	this->issuerKey = issuerKey.getEvpPkey();
+	EVP_PKEY_up_ref(this->issuerKey);
+	this->lock = CRYPTO_THREAD_lock_new();
+	this->writeLock = CRYPTO_THREAD_lock_new();
+	if (this->issuer == NULL || this->lock == NULL || this->writeLock == NULL)
+	{
+		this->release();
+		throw CertificationException(CertificationException::INTERNAL_ERROR, "RevocationState::RevocationState");
+	}
+}
+
+RevocationState::~RevocationState()
+{
+	this->release();
+}
+
+void RevocationState::release()
+{
+	delete this->snapshot;
+	X509_NAME_free(this->issuer);
+	EVP_PKEY_free(this->issuerKey);
+	CRYPTO_THREAD_lock_free(this->lock);
+	CRYPTO_THREAD_lock_free(this->writeLock);
+}
+
+void RevocationState::applyDelta(CertificateRevocationList &delta) throw (CertificationException, EncodeException)
+{
+	Snapshot changes, *next, *previous;
+	BigInteger baseNumber;
+	std::vector<Entry>::const_iterator current, change;
+
+	if (X509_NAME_cmp(X509_CRL_get_issuer(delta.getX509Crl()), this->issuer) != 0)
+	{
+		throw CertificationException(CertificationException::INVALID_CRL, "RevocationState::applyDelta");
+	}
+	baseNumber = delta.getBaseCRLNumberBigInt();
+	changes.crlNumber = delta.getSerialNumberBigInt();
+	RevocationState::readEntries(delta, this->issuerKey, changes);
+	RevocationState::sort(changes.entries);
+
+	/* only one delta at a time; the state the checks below see cannot change until the swap */
+	CRYPTO_THREAD_write_lock(this->writeLock);
+	previous = this->snapshot;
+	if (baseNumber > previous->crlNumber || changes.crlNumber <= previous->crlNumber)
+	{
+		CRYPTO_THREAD_unlock(this->writeLock);
+		throw CertificationException(CertificationException::INVALID_CRL, "RevocationState::applyDelta");
+	}
+
+	/* merge of two sorted lists without repeated numbers; delta entries replace base entries */
+	next = new Snapshot();
+	next->generation = previous->generation + 1;
+	next->crlNumber = changes.crlNumber;
+	next->thisUpdate = changes.thisUpdate;
+	next->nextUpdate = changes.nextUpdate;
+	next->entries.reserve(previous->entries.size() + changes.entries.size());
+	current = previous->entries.begin();
+	for (change = changes.entries.begin(); change != changes.entries.end(); change++)
+	{
+		while (current != previous->entries.end() && *current < *change)
+		{
+			next->entries.push_back(*current);
+			current++;
+		}
+		if (current != previous->entries.end() && !(*change < *current))
+		{
+			current++;
+		}
+		if (!change->removeFromCrl)
+		{
+			next->entries.push_back(*change);
+		}
+	}
+	next->entries.insert(next->entries.end(), current, (std::vector<Entry>::const_iterator) previous->entries.end());
+
+	CRYPTO_THREAD_write_lock(this->lock);
+	this->snapshot = next;
+	CRYPTO_THREAD_unlock(this->lock);
+	CRYPTO_THREAD_unlock(this->writeLock);
+
+	/* readers hold the shared lock for the whole lookup, so nobody sees the old version anymore */
+	delete previous;
+}
+
+bool RevocationState::isRevoked(const BigInteger &serialNumber) const
+{
+	Entry key;
+	bool ret;
+	if (!CertificateRevocationListReader::getSerialNumberContent(serialNumber, key.serialNumber))
+	{
+		return false;
+	}
+	CRYPTO_THREAD_read_lock(this->lock);
+	ret = (RevocationState::find(this->snapshot, key) != NULL);
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+RevokedCertificate* RevocationState::getRevocation(const BigInteger &serialNumber) const
+{
+	const Entry *entry;
+	RevokedCertificate *ret = NULL;
+	time_t revocationDate;
+	RevokedCertificate::ReasonCode reasonCode;
+	Entry key;
+
+	if (!CertificateRevocationListReader::getSerialNumberContent(serialNumber, key.serialNumber))
+	{
+		return NULL;
+	}
+	CRYPTO_THREAD_read_lock(this->lock);
+	entry = RevocationState::find(this->snapshot, key);
+	if (entry != NULL)
+	{
+		revocationDate = entry->revocationDate;
+		reasonCode = entry->reasonCode;
+	}
+	CRYPTO_THREAD_unlock(this->lock);
+	if (entry != NULL)
+	{
+		DateTime date(revocationDate);
+		ret = new RevokedCertificate();
+		ret->setCertificateSerialNumber(serialNumber);
+		ret->setRevocationDate(date);
+		ret->setReasonCode(reasonCode);
+	}
+	return ret;
+}
+
+BigInteger RevocationState::getCrlNumber() const
+{
+	BigInteger ret;
+	CRYPTO_THREAD_read_lock(this->lock);
+	ret = this->snapshot->crlNumber;
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+time_t RevocationState::getThisUpdate() const
+{
+	time_t ret;
+	CRYPTO_THREAD_read_lock(this->lock);
+	ret = this->snapshot->thisUpdate;
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+time_t RevocationState::getNextUpdate() const
+{
+	time_t ret;
+	CRYPTO_THREAD_read_lock(this->lock);
+	ret = this->snapshot->nextUpdate;
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+unsigned long RevocationState::size() const
+{
+	unsigned long ret;
+	CRYPTO_THREAD_read_lock(this->lock);
+	ret = this->snapshot->entries.size();
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+unsigned long RevocationState::getGeneration() const
+{
+	unsigned long ret;
+	CRYPTO_THREAD_read_lock(this->lock);
+	ret = this->snapshot->generation;
+	CRYPTO_THREAD_unlock(this->lock);
+	return ret;
+}
+
+void RevocationState::readEntries(CertificateRevocationList &crl, EVP_PKEY *key, Snapshot &snapshot)
+		throw (CertificationException, EncodeException)
+{
+	ByteArray der = crl.getDerEncoded();
+	CertificateRevocationListReader reader(der.getDataPointer(), der.size());
+	CertificateRevocationListReader::Entry entry;
+	Entry item;
+
+	/* PublicKey takes ownership of the EVP_PKEY it receives */
+	EVP_PKEY_up_ref(key);
+	PublicKey publicKey(key);
+	reader.setPublicKey(publicKey);
+	snapshot.thisUpdate = reader.getThisUpdate();
+	snapshot.nextUpdate = reader.getNextUpdate();
+	while (reader.next(entry))
+	{
+		item.serialNumber.assign((const char *) entry.serialNumber, entry.serialNumberLength);
+		item.revocationDate = entry.revocationDate;
+		item.reasonCode = entry.reasonCode;
+		item.removeFromCrl = entry.removeFromCrl;
+		snapshot.entries.push_back(item);
+	}
+	if (!reader.verify())
+	{
+		throw CertificationException(CertificationException::INVALID_CRL, "RevocationState::readEntries");
+	}
+}
+
+void RevocationState::sort(std::vector<Entry> &entries)
+{
+	unsigned long i, count;
+
+	/* a LCR pode repetir um número de série; fica a última entrada */
+	std::stable_sort(entries.begin(), entries.end());
+	count = 0;
+	for (i = 0; i < entries.size(); i++)
+	{
+		if (count > 0 && !(entries[count - 1] < entries[i]))
+		{
+			entries[count - 1] = entries[i];
+		}
+		else
+		{
+			if (count != i)
+			{
+				entries[count] = entries[i];
+			}
+			count++;
+		}
+	}
+	entries.resize(count);
+}
+
+const RevocationState::Entry* RevocationState::find(const Snapshot *snapshot, const Entry &key)
+{
+	std::vector<Entry>::const_iterator it;
+
+	it = std::lower_bound(snapshot->entries.begin(), snapshot->entries.end(), key);
+	if (it == snapshot->entries.end() || key < *it)
+	{
+		return NULL;
+	}
+	return &(*it);
+}
@@ -27,7 +27,7 @@ RevokedCertificate::RevokedCertificate(X509_REVOKED *revoked)
 		asn1Enumerated = (ASN1_ENUMERATED*) X509_REVOKED_get_ext_d2i(revoked, NID_crl_reason, NULL, NULL);
 		if (asn1Enumerated != NULL)
 		{
-			this->reasonCode = (RevokedCertificate::ReasonCode)ASN1_ENUMERATED_get(asn1Enumerated);
+			this->reasonCode = RevokedCertificate::fromCrlReason(ASN1_ENUMERATED_get(asn1Enumerated));
 			ASN1_ENUMERATED_free(asn1Enumerated);
 		}
 		else
@@ -66,6 +66,45 @@ std::string RevokedCertificate::getXmlEncoded(std::string tab)
 	return ret;
 }
 
+void RevokedCertificate::write(DocumentWriter &writer)
+{
+	writer.begin("revokedCertificate");
+	writer.write("certificateSerialNumber", this->certificateSerialNumber.toDec());
+	writer.writeTime("revocationDate", this->revocationDate.getDateTime());
+	if (this->reasonCode != RevokedCertificate::UNSPECIFIED)
+	{
+		writer.write("reason", RevokedCertificate::reasonCode2Name(this->reasonCode));
+	}
+	writer.end();
+}
+
+void RevokedCertificate::write(DocumentWriter &writer, const X509_REVOKED *revoked)
+{
+	ASN1_ENUMERATED *asn1Enumerated;
+	BIGNUM *serial;
+	char *decimal;
+	RevokedCertificate::ReasonCode reasonCode;
+
+	writer.begin("revokedCertificate");
+	serial = ASN1_INTEGER_to_BN(X509_REVOKED_get0_serialNumber(revoked), NULL);
+	decimal = (serial != NULL) ? BN_bn2dec(serial) : NULL;
+	writer.write("certificateSerialNumber", decimal);
+	OPENSSL_free(decimal);
+	BN_free(serial);
+	writer.writeTime("revocationDate", X509_REVOKED_get0_revocationDate(revoked));
+	asn1Enumerated = (ASN1_ENUMERATED *) X509_REVOKED_get_ext_d2i(revoked, NID_crl_reason, NULL, NULL);
+	if (asn1Enumerated != NULL)
+	{
+		reasonCode = RevokedCertificate::fromCrlReason(ASN1_ENUMERATED_get(asn1Enumerated));
+		ASN1_ENUMERATED_free(asn1Enumerated);
+		if (reasonCode != RevokedCertificate::UNSPECIFIED)
+		{
+			writer.write("reason", RevokedCertificate::reasonCode2Name(reasonCode));
+		}
+	}
+	writer.end();
+}
+
 void RevokedCertificate::setCertificateSerialNumber(long certificateSerialNumber)
 	throw(BigIntegerException)
 {
@@ -120,13 +159,93 @@ X509_REVOKED* RevokedCertificate::getX509Revoked()
 	if (this->reasonCode != RevokedCertificate::UNSPECIFIED)
 	{
 		asn1Enumerated = ASN1_ENUMERATED_new();
-		ASN1_ENUMERATED_set(asn1Enumerated, this->reasonCode);
+		ASN1_ENUMERATED_set(asn1Enumerated, RevokedCertificate::toCrlReason(this->reasonCode));
 		X509_REVOKED_add1_ext_i2d(ret, NID_crl_reason, asn1Enumerated, 0, 0);
 		ASN1_ENUMERATED_free(asn1Enumerated);
 	}
 	return ret;
 }
 
+bool RevokedCertificate::isReasonCode(long value)
+{
+	return (value >= 0 && value <= 10 && value != 7);
+}
+
+long RevokedCertificate::toCrlReason(RevokedCertificate::ReasonCode reasonCode)
+{
+	long ret;
+	switch (reasonCode)
+	{
+		case RevokedCertificate::UNSPECIFIED:
+			ret = CRL_REASON_UNSPECIFIED;
+			break;
+		case RevokedCertificate::KEY_COMPROMISE:
+			ret = CRL_REASON_KEY_COMPROMISE;
+			break;
+		case RevokedCertificate::CA_COMPROMISE:
+			ret = CRL_REASON_CA_COMPROMISE;
+			break;
+		case RevokedCertificate::AFFILIATION_CHANGED:
+			ret = CRL_REASON_AFFILIATION_CHANGED;
+			break;
+		case RevokedCertificate::SUPER_SEDED:
+			ret = CRL_REASON_SUPERSEDED;
+			break;
+		case RevokedCertificate::CESSATION_OF_OPERATION:
+			ret = CRL_REASON_CESSATION_OF_OPERATION;
+			break;
+		case RevokedCertificate::CERTIFICATE_HOLD:
+			ret = CRL_REASON_CERTIFICATE_HOLD;
+			break;
+		case RevokedCertificate::PRIVILEGE_WITH_DRAWN:
+			ret = CRL_REASON_PRIVILEGE_WITHDRAWN;
+			break;
+		case RevokedCertificate::AACOMPROMISE:
+			ret = CRL_REASON_AA_COMPROMISE;
+			break;
+		default:
+			ret = -1;
+			break;
+	}
+	return ret;
+}
+
+RevokedCertificate::ReasonCode RevokedCertificate::fromCrlReason(long value)
+{
+	RevokedCertificate::ReasonCode ret;
+	switch (value)
+	{
+		case CRL_REASON_KEY_COMPROMISE:
+			ret = RevokedCertificate::KEY_COMPROMISE;
+			break;
+		case CRL_REASON_CA_COMPROMISE:
+			ret = RevokedCertificate::CA_COMPROMISE;
+			break;
+		case CRL_REASON_AFFILIATION_CHANGED:
+			ret = RevokedCertificate::AFFILIATION_CHANGED;
+			break;
+		case CRL_REASON_SUPERSEDED:
+			ret = RevokedCertificate::SUPER_SEDED;
+			break;
+		case CRL_REASON_CESSATION_OF_OPERATION:
+			ret = RevokedCertificate::CESSATION_OF_OPERATION;
+			break;
+		case CRL_REASON_CERTIFICATE_HOLD:
+			ret = RevokedCertificate::CERTIFICATE_HOLD;
+			break;
+		case CRL_REASON_PRIVILEGE_WITHDRAWN:
+			ret = RevokedCertificate::PRIVILEGE_WITH_DRAWN;
+			break;
+		case CRL_REASON_AA_COMPROMISE:
+			ret = RevokedCertificate::AACOMPROMISE;
+			break;
+		default:
+			ret = RevokedCertificate::UNSPECIFIED;
+			break;
+	}
+	return ret;
+}
+
 std::string RevokedCertificate::reasonCode2Name(RevokedCertificate::ReasonCode reasonCode)
 {
 	std::string ret;
@@ -57,10 +57,26 @@ GeneralNames SubjectAlternativeNameExtension::getSubjectAltName()
 	return this->subjectAltName;
 }
 
+void SubjectAlternativeNameExtension::encodeValue(DerWriter &writer)
+{
+	this->subjectAltName.encode(writer);
+}
+
+void SubjectAlternativeNameExtension::writeValue(DocumentWriter &writer)
+{
+	this->subjectAltName.write(writer);
+}
+
 X509_EXTENSION* SubjectAlternativeNameExtension::getX509Extension()
 {
 	X509_EXTENSION *ret;
 	GENERAL_NAMES *generalNames;
+	ret = this->encodeX509Extension(NID_subject_alt_name);
+	if (ret != NULL)
+	{
+		return ret;
+	}
+	/* values the writer does not handle are encoded by OpenSSL */
 	generalNames = this->subjectAltName.getInternalGeneralNames();
 	ret = X509V3_EXT_i2d(NID_subject_alt_name, this->critical?1:0, (void *)generalNames);
 	sk_GENERAL_NAME_pop_free(generalNames, GENERAL_NAME_free);
@@ -28,10 +28,36 @@ SubjectInformationAccessExtension::SubjectInformationAccessExtension(X509_EXTENS
 SubjectInformationAccessExtension::~SubjectInformationAccessExtension() {
 }
 
+void SubjectInformationAccessExtension::encodeValue(DerWriter &writer)
+{
+	writer.begin(DerWriter::SEQUENCE);
+	for (unsigned int i = 0; i < this->accessDescriptions.size(); i++)
+	{
+		this->accessDescriptions[i].encode(writer);
+	}
+	writer.end();
+}
+
+void SubjectInformationAccessExtension::writeValue(DocumentWriter &writer)
+{
+	writer.beginList("accessDescriptions");
+	for (unsigned int i = 0; i < this->accessDescriptions.size(); i++)
+	{
+		this->accessDescriptions[i].write(writer);
+	}
+	writer.end();
+}
+
 X509_EXTENSION* SubjectInformationAccessExtension::getX509Extension() {
 	X509_EXTENSION *ret;
 	STACK_OF(ACCESS_DESCRIPTION) *subjectInfoAccess;
 
+	ret = this->encodeX509Extension(NID_sinfo_access);
+	if (ret != NULL)
+	{
+		return ret;
+	}
+	/* values the writer does not handle are encoded by OpenSSL */
 	subjectInfoAccess = sk_ACCESS_DESCRIPTION_new_null();
 	unsigned int i;
 	for (i=0;i<this->accessDescriptions.size();i++)
@@ -63,16 +63,17 @@ ByteArray SubjectKeyIdentifierExtension::getKeyIdentifier() const
 	return this->keyIdentifier;
 }
 
+void SubjectKeyIdentifierExtension::encodeValue(DerWriter &writer)
+{
+	writer.writePrimitive(DerWriter::OCTET_STRING, this->keyIdentifier.getDataPointer(), this->keyIdentifier.size());
+}
+
+void SubjectKeyIdentifierExtension::writeValue(DocumentWriter &writer)
+{
+	writer.writeBase64("keyIdentifier", this->keyIdentifier.getDataPointer(), this->keyIdentifier.size());
+}
+
 X509_EXTENSION* SubjectKeyIdentifierExtension::getX509Extension()
 {
-	X509_EXTENSION *ret;
-	ASN1_OCTET_STRING *octetString;
-	ByteArray data;
-	
-	ret = X509_EXTENSION_new();
-	octetString = ASN1_OCTET_STRING_new();
-	data = this->keyIdentifier;
-	ASN1_OCTET_STRING_set(octetString, data.getDataPointer(), data.size());
-	ret = X509V3_EXT_i2d(NID_subject_key_identifier, this->critical?1:0, (void *)octetString);
-	return ret;
+	return this->encodeX509Extension(NID_subject_key_identifier);
 }
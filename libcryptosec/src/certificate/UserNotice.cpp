@@ -118,6 +118,50 @@ std::string UserNotice::getExplicitText()
 	return this->explicitText;
 }
 
+void UserNotice::encode(DerWriter &writer) const
+{
+	writer.begin(DerWriter::SEQUENCE);
+	if (!this->organization.empty())
+	{
+		writer.begin(DerWriter::SEQUENCE);
+		writer.writePrimitive(DerWriter::UTF8_STRING, this->organization);
+		writer.begin(DerWriter::SEQUENCE);
+		for (unsigned int i = 0; i < this->noticeNumbers.size(); i++)
+		{
+			writer.writeInteger(this->noticeNumbers[i]);
+		}
+		writer.end();
+		writer.end();
+	}
+	if (!this->explicitText.empty())
+	{
+		writer.writePrimitive(DerWriter::UTF8_STRING, this->explicitText);
+	}
+	writer.end();
+}
+
+void UserNotice::write(DocumentWriter &writer)
+{
+	writer.begin("userNotice");
+	if (!this->organization.empty())
+	{
+		writer.begin("noticeRef");
+		writer.write("organization", this->organization);
+		writer.beginList("noticeNumbers");
+		for (unsigned int i = 0; i < this->noticeNumbers.size(); i++)
+		{
+			writer.write("noticeNumber", this->noticeNumbers[i]);
+		}
+		writer.end();
+		writer.end();
+	}
+	if (!this->explicitText.empty())
+	{
+		writer.write("explicitText", this->explicitText);
+	}
+	writer.end();
+}
+
 USERNOTICE* UserNotice::getUserNotice() const
 {
 	USERNOTICE *ret;
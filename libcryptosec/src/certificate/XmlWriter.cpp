@@ -0,0 +1,93 @@
+#include <libcryptosec/certificate/XmlWriter.h>
+
+#include <libcryptosec/exception/EncodeException.h>
+
+XmlWriter::XmlWriter(std::ostream &stream, bool declaration)
+	: DocumentWriter(stream)
+{
+	if (declaration)
+	{
+		this->stream << "<?xml version=\"1.0\"?>\n";
+	}
+}
+
+XmlWriter::~XmlWriter()
+{
+}
+
+void XmlWriter::begin(const std::string &name)
+{
+	this->indent();
+	this->stream << '<' << name << ">\n";
+	this->names.push_back(name);
+}
+
+void XmlWriter::beginList(const std::string &name)
+{
+	/* a list is just an element whose children are the items */
+	this->begin(name);
+}
+
+void XmlWriter::end()
+{
+	if (this->names.empty())
+	{
+		return;
+	}
+	std::string name = this->names.back();
+	this->names.pop_back();
+	this->indent();
+	this->stream << "</" << name << ">\n";
+}
+
+void XmlWriter::writeField(const std::string &name, const std::string &value, bool)
+{
+	/* XML 1.0 has no way to represent the C0 controls other than tab, line feed and carriage return,
+	 * not even as character references; checked before anything of the field is written */
+	static const std::string controls("\x00\x01\x02\x03\x04\x05\x06\x07\x08\x0b\x0c\x0e\x0f"
+			"\x10\x11\x12\x13\x14\x15\x16\x17\x18\x19\x1a\x1b\x1c\x1d\x1e\x1f", 29);
+
+	if (value.find_first_of(controls) != std::string::npos)
+	{
+		throw EncodeException(EncodeException::BUFFER_WRITING, "XmlWriter::writeField");
+	}
+	this->indent();
+	this->stream << '<' << name << '>';
+	this->escape(value);
+	this->stream << "</" << name << ">\n";
+}
+
+void XmlWriter::indent()
+{
+	for (unsigned int i = 0; i < this->names.size(); i++)
+	{
+		this->stream << '\t';
+	}
+}
+
+void XmlWriter::escape(const std::string &value)
+{
+	std::string::size_type begin, next;
+
+	for (begin = 0; (next = value.find_first_of("&<>\r", begin)) != std::string::npos; begin = next + 1)
+	{
+		this->stream.write(value.data() + begin, next - begin);
+		switch (value[next])
+		{
+			case '&':
+				this->stream << "&amp;";
+				break;
+			case '<':
+				this->stream << "&lt;";
+				break;
+			case '>':
+				this->stream << "&gt;";
+				break;
+			default:
+				/* a literal carriage return would be normalized to a line feed by the parser */
+				this->stream << "&#13;";
+				break;
+		}
+	}
+	this->stream.write(value.data() + begin, value.size() - begin);
+}
@@ -1,61 +1,66 @@
 #include <libcryptosec/ec/BrainpoolCurveFactory.h>
 
+#include <stdlib.h>
+
 BrainpoolCurveFactory::BrainpoolCurveFactory() {
 //Nothing to do. This constructor is never called.
 }
 
+CRYPTO_ONCE BrainpoolCurveFactory::once = CRYPTO_ONCE_STATIC_INIT;
+const EllipticCurve* BrainpoolCurveFactory::curves[BrainpoolCurveFactory::BP512t1 + 1];
+
 const EllipticCurve* BrainpoolCurveFactory::getCurve(
 		BrainpoolCurveFactory::CurveName curveName) throw (BigIntegerException) {
+	const EllipticCurve *curve = BrainpoolCurveFactory::getSharedCurve(curveName);
+	if (curve == NULL) {
+		return NULL;
+	}
+	return new EllipticCurve(*curve);
+}
+
+const EllipticCurve* BrainpoolCurveFactory::getSharedCurve(
+		BrainpoolCurveFactory::CurveName curveName) throw (BigIntegerException) {
 
-	switch (curveName) {
-	case BP160r1:
-		return bp160r1();
-		break;
-	case BP160t1:
-		return bp160t1();
-		break;
-	case BP192r1:
-		return bp192r1();
-		break;
-	case BP192t1:
-		return bp192t1();
-		break;
-	case BP224r1:
-		return bp224r1();
-		break;
-	case BP224t1:
-		return bp224t1();
-		break;
-	case BP256r1:
-		return bp256r1();
-		break;
-	case BP256t1:
-		return bp256t1();
-		break;
-	case BP320r1:
-		return bp320r1();
-		break;
-	case BP320t1:
-		return bp320t1();
-		break;
-	case BP384r1:
-		return bp384r1();
-		break;
-	case BP384t1:
-		return bp384t1();
-		break;
-	case BP512r1:
-		return bp512r1();
-		break;
-	case BP512t1:
-		return bp512t1();
-		break;
-	default:
+	if (curveName < BP160r1 || curveName > BP512t1) {
 		//TODO throw EC exception curve not implemented or not specified
 		return NULL;
-		break;
+	}
+
+	CRYPTO_THREAD_run_once(&BrainpoolCurveFactory::once, BrainpoolCurveFactory::init);
+	return BrainpoolCurveFactory::curves[curveName];
+}
+
+const EC_GROUP* BrainpoolCurveFactory::getGroup(
+		BrainpoolCurveFactory::CurveName curveName) throw (BigIntegerException, AsymmetricKeyException) {
+	const EllipticCurve *curve = BrainpoolCurveFactory::getSharedCurve(curveName);
+	if (curve == NULL) {
+		return NULL;
+	}
+	return EllipticCurveRegistry::getGroup(*curve);
+}
+
+void BrainpoolCurveFactory::init() {
+	curves[BP160r1] = bp160r1();
+	curves[BP160t1] = bp160t1();
+	curves[BP192r1] = bp192r1();
+	curves[BP192t1] = bp192t1();
+	curves[BP224r1] = bp224r1();
+	curves[BP224t1] = bp224t1();
+	curves[BP256r1] = bp256r1();
+	curves[BP256t1] = bp256t1();
+	curves[BP320r1] = bp320r1();
+	curves[BP320t1] = bp320t1();
+	curves[BP384r1] = bp384r1();
+	curves[BP384t1] = bp384t1();
+	curves[BP512r1] = bp512r1();
+	curves[BP512t1] = bp512t1();
+	atexit(BrainpoolCurveFactory::cleanup);
+}
 
-		return 0;
+void BrainpoolCurveFactory::cleanup() {
+	for (int i = BP160r1; i <= BP512t1; i++) {
+		delete curves[i];
+		curves[i] = NULL;
 	}
 }
 
@@ -0,0 +1,168 @@
+#include <libcryptosec/ec/EllipticCurveRegistry.h>
+
+#include <sstream>
+
+#include <stdlib.h>
+
+CRYPTO_ONCE EllipticCurveRegistry::once = CRYPTO_ONCE_STATIC_INIT;
+CRYPTO_RWLOCK *EllipticCurveRegistry::lock = NULL;
+std::map<std::string, EC_GROUP *> *EllipticCurveRegistry::groups = NULL;
+
+EllipticCurveRegistry::EllipticCurveRegistry() {
+//Nothing to do. This constructor is never called.
+}
+
+void EllipticCurveRegistry::init() {
+	EllipticCurveRegistry::lock = CRYPTO_THREAD_lock_new();
+	EllipticCurveRegistry::groups = new std::map<std::string, EC_GROUP *>();
+	/* OpenSSL registers its exit handler on initialization; ours, registered later, runs first */
+	OPENSSL_init_crypto(0, NULL);
+	atexit(EllipticCurveRegistry::cleanup);
+}
+
+void EllipticCurveRegistry::cleanup() {
+	std::map<std::string, EC_GROUP *>::iterator it;
+
+	for (it = EllipticCurveRegistry::groups->begin(); it != EllipticCurveRegistry::groups->end(); it++) {
+		EC_GROUP_free(it->second);
+	}
+	delete EllipticCurveRegistry::groups;
+	EllipticCurveRegistry::groups = NULL;
+	CRYPTO_THREAD_lock_free(EllipticCurveRegistry::lock);
+	EllipticCurveRegistry::lock = NULL;
+}
+
+const EC_GROUP * EllipticCurveRegistry::getGroup(const EllipticCurve &curve) throw (AsymmetricKeyException) {
+	std::string key = EllipticCurveRegistry::getKey(curve);
+	const EC_GROUP *ret = EllipticCurveRegistry::find(key);
+	if (ret == NULL) {
+		ret = EllipticCurveRegistry::insert(key, EllipticCurveRegistry::createGroup(curve));
+	}
+	return ret;
+}
+
+const EC_GROUP * EllipticCurveRegistry::getGroup(AsymmetricKey::Curve curve) throw (AsymmetricKeyException) {
+	std::ostringstream key;
+	const EC_GROUP *ret;
+	EC_GROUP *group;
+
+	key << "nid:" << (int) curve;
+	ret = EllipticCurveRegistry::find(key.str());
+	if (ret == NULL) {
+		group = EC_GROUP_new_by_curve_name(curve);
+		if (group == NULL) {
+			throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
+					"Failed to create group", "EllipticCurveRegistry::getGroup");
+		}
+		ret = EllipticCurveRegistry::insert(key.str(), group);
+	}
+	return ret;
+}
+
+EC_GROUP * EllipticCurveRegistry::createGroup(const EllipticCurve &curve) throw (AsymmetricKeyException) {
+	BN_CTX *ctx;
+	EC_GROUP *group;
+	EC_POINT *generator;
+
+	/* Set up the BN_CTX */
+	ctx = BN_CTX_new();
+	if (ctx == NULL){
+		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
+				"Failed to create BN_CTX", "EllipticCurveRegistry::createGroup");
+	}
+
+	/* Create the curve */
+	group = EC_GROUP_new_curve_GFp(curve.BN_p(), curve.BN_a(), curve.BN_b(), ctx);
+	if (group == NULL) {
+		BN_CTX_free(ctx);
+		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
+				"Failed to create group", "EllipticCurveRegistry::createGroup");
+	}
+
+	/* Create the generator */
+	generator = EC_POINT_new(group);
+	if (generator == NULL) {
+		BN_CTX_free(ctx);
+		EC_GROUP_free(group);
+		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
+				"Failed to create generator", "EllipticCurveRegistry::createGroup");
+	}
+
+	if (1 != EC_POINT_set_affine_coordinates_GFp(group, generator, curve.BN_x(), curve.BN_y(), ctx)) {
+		BN_CTX_free(ctx);
+		EC_GROUP_free(group);
+		EC_POINT_free(generator);
+		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
+				"Failed to set the affine coordinates of a EC_POINT over GFp",
+				"EllipticCurveRegistry::createGroup");
+	}
+
+	/* Set the generator and the order */
+	if (1 != EC_GROUP_set_generator(group, generator, curve.BN_order(), curve.BN_cofactor())) {
+		BN_CTX_free(ctx);
+		EC_GROUP_free(group);
+		EC_POINT_free(generator);
+		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
+				"Failed to set generator and order", "EllipticCurveRegistry::createGroup");
+	}
+
+	EC_POINT_free(generator);
+	BN_CTX_free(ctx);
+
+	return group;
+}
+
+unsigned int EllipticCurveRegistry::size() {
+	unsigned int ret;
+	CRYPTO_THREAD_run_once(&EllipticCurveRegistry::once, EllipticCurveRegistry::init);
+	CRYPTO_THREAD_read_lock(EllipticCurveRegistry::lock);
+	ret = EllipticCurveRegistry::groups->size();
+	CRYPTO_THREAD_unlock(EllipticCurveRegistry::lock);
+	return ret;
+}
+
+std::string EllipticCurveRegistry::getKey(const EllipticCurve &curve) {
+	/* the name is not part of the key: custom curves may share names but not parameters */
+	return curve.getP().toHex() + ":" + curve.getA().toHex() + ":" + curve.getB().toHex() + ":"
+			+ curve.getX().toHex() + ":" + curve.getY().toHex() + ":"
+			+ curve.getOrder().toHex() + ":" + curve.getCofactor().toHex();
+}
+
+const EC_GROUP * EllipticCurveRegistry::find(const std::string &key) {
+	std::map<std::string, EC_GROUP *>::const_iterator it;
+	const EC_GROUP *ret = NULL;
+
+	CRYPTO_THREAD_run_once(&EllipticCurveRegistry::once, EllipticCurveRegistry::init);
+	CRYPTO_THREAD_read_lock(EllipticCurveRegistry::lock);
+	it = EllipticCurveRegistry::groups->find(key);
+	if (it != EllipticCurveRegistry::groups->end()) {
+		ret = it->second;
+	}
+	CRYPTO_THREAD_unlock(EllipticCurveRegistry::lock);
+	return ret;
+}
+
+const EC_GROUP * EllipticCurveRegistry::insert(const std::string &key, EC_GROUP *group) throw (AsymmetricKeyException) {
+	std::map<std::string, EC_GROUP *>::iterator it;
+	const EC_GROUP *ret;
+
+	/* the expensive precomputation is done before taking the lock */
+	if (!EC_GROUP_precompute_mult(group, NULL)) {
+		EC_GROUP_free(group);
+		throw AsymmetricKeyException(AsymmetricKeyException::INTERNAL_ERROR,
+				"Failed to precompute generator multiples", "EllipticCurveRegistry::insert");
+	}
+
+	CRYPTO_THREAD_write_lock(EllipticCurveRegistry::lock);
+	it = EllipticCurveRegistry::groups->find(key);
+	if (it == EllipticCurveRegistry::groups->end()) {
+		(*EllipticCurveRegistry::groups)[key] = group;
+		ret = group;
+	} else {
+		/* another thread registered the same curve first */
+		ret = it->second;
+		EC_GROUP_free(group);
+	}
+	CRYPTO_THREAD_unlock(EllipticCurveRegistry::lock);
+	return ret;
+}
@@ -0,0 +1,149 @@
+#include <libcryptosec/certificate/BatchIssuer.h>
+
+#include <stdio.h>
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "CertificateFixtures.h"
+
+/**
+ * @brief Benchmarks da emissão em lote a partir de requisições
+ */
+class BatchIssuerBenchmark : public ::testing::Test {
+
+protected:
+    class VectorSource : public BatchIssuer::Source {
+    public:
+        VectorSource(std::vector<std::string> &ders) : ders(ders), read(0) {}
+
+        virtual bool next(std::string &request) {
+            if (read == ders.size()) {
+                return false;
+            }
+            request = ders[read++];
+            return true;
+        }
+
+        std::vector<std::string> &ders;
+        unsigned long read;
+    };
+
+    class CountingSink : public BatchIssuer::Sink {
+    public:
+        CountingSink() : bytes(0) {}
+
+        virtual void write(unsigned long index, CertificateRequest *request, BatchIssuer::Status status, const std::string &certificate) {
+            bytes += certificate.size();
+        }
+
+        unsigned long bytes;
+    };
+
+    virtual void SetUp() {
+        char name[64];
+
+        EVP_PKEY_up_ref(fixtures.key);
+        privateKey = new PrivateKey(fixtures.key);
+        EVP_PKEY_up_ref(fixtures.key);
+        publicKey = new PublicKey(fixtures.key);
+        issuer.addEntry(RDNSequence::ORGANIZATION, "LibCryptoSec");
+        issuer.addEntry(RDNSequence::COMMON_NAME, "Benchmark CA");
+        keyUsage.setUsage(KeyUsageExtension::DIGITAL_SIGNATURE, true);
+        keyUsage.setCritical(true);
+        basicConstraints.setCa(false);
+        basicConstraints.setCritical(true);
+        for (int i = 0; i < count; i++) {
+            CertificateRequest request;
+            RDNSequence subject;
+            snprintf(name, sizeof(name), "Benchmark Leaf %d", i);
+            subject.addEntry(RDNSequence::ORGANIZATION, "LibCryptoSec");
+            subject.addEntry(RDNSequence::COMMON_NAME, name);
+            request.setSubject(subject);
+            request.setPublicKey(*publicKey);
+            request.sign(*privateKey, MessageDigest::SHA256);
+            ByteArray der = request.getDerEncoded();
+            requests.push_back(std::string((const char *) der.getDataPointer(), der.size()));
+        }
+    }
+
+    virtual void TearDown() {
+        delete privateKey;
+        delete publicKey;
+    }
+
+    /**
+     * @brief Mede o laço com CertificateBuilder: verificação, campos e assinatura de cada requisição
+     */
+    void benchBuilder() {
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+        unsigned long checksum = 0;
+        Benchmark timer;
+
+        for (int i = 0; i < count; i++) {
+            ByteArray der((const unsigned char *) requests[i].data(), requests[i].size());
+            CertificateRequest request(der);
+            if (!request.verify()) {
+                continue;
+            }
+            CertificateBuilder builder(request);
+            builder.setVersion(2);
+            builder.setSerialNumber(i + 1);
+            builder.setIssuer(issuer);
+            builder.setNotBefore(notBefore);
+            builder.setNotAfter(notAfter);
+            builder.addExtension(keyUsage);
+            builder.addExtension(basicConstraints);
+            Certificate *cert = builder.sign(*privateKey, MessageDigest::SHA256);
+            checksum += cert->getDerEncoded().size();
+            delete cert;
+        }
+        Benchmark::reportRate("CertificateBuilder loop", timer.elapsedMs(), count);
+        ASSERT_NE(checksum, 0);
+    }
+
+    void benchBatch(unsigned int threads, const std::string &name) {
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+        CertificateBuilder invariant;
+        CountingSink sink;
+
+        invariant.setIssuer(issuer);
+        invariant.addExtension(keyUsage);
+        invariant.addExtension(basicConstraints);
+        IssuanceTemplate issuance(invariant, *privateKey, MessageDigest::SHA256);
+        BatchIssuer::SequentialPolicy policy(BigInteger(1L), notBefore, notAfter);
+        VectorSource source(requests);
+        BatchIssuer batch(issuance, policy);
+        batch.setThreads(threads);
+
+        Benchmark timer;
+        BatchIssuer::Metrics metrics = batch.issue(source, sink);
+        Benchmark::reportRate(name, timer.elapsedMs(), count);
+        printf("[ BENCH    ]   read %.1f ms, decode %.1f ms, verify %.1f ms, policy %.1f ms, sign %.1f ms, write %.1f ms, stalls %lu\n",
+                metrics.readMs, metrics.decodeMs, metrics.verifyMs, metrics.policyMs, metrics.signMs, metrics.writeMs, metrics.stalls);
+        ASSERT_EQ(metrics.issued, (unsigned long) count);
+        ASSERT_NE(sink.bytes, 0);
+    }
+
+    static const int count = 20000;
+    static const time_t epochBefore = 1487889918;
+    static const time_t epochAfter = 1519425918;
+    CertificateFixtures fixtures;
+    PrivateKey *privateKey;
+    PublicKey *publicKey;
+    RDNSequence issuer;
+    KeyUsageExtension keyUsage;
+    BasicConstraintsExtension basicConstraints;
+    std::vector<std::string> requests;
+};
+
+TEST_F(BatchIssuerBenchmark, Builder) {
+    benchBuilder();
+}
+
+TEST_F(BatchIssuerBenchmark, BatchOneThread) {
+    benchBatch(1, "BatchIssuer, 1 thread");
+}
+
+TEST_F(BatchIssuerBenchmark, Batch) {
+    benchBatch(0, "BatchIssuer, 1 thread per processor");
+}
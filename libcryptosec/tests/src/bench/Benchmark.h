@@ -0,0 +1,46 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <time.h>
+#include <stdio.h>
+#include <string>
+
+/**
+ * @brief Utilitários para os benchmarks, medindo o tempo de parede em milissegundos.
+ */
+class Benchmark {
+
+public:
+    Benchmark() {
+        reset();
+    }
+
+    void reset() {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+    }
+
+    double elapsedMs() const {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (now.tv_sec - start.tv_sec) * 1000.0 + (now.tv_nsec - start.tv_nsec) / 1000000.0;
+    }
+
+    /**
+     * @brief Imprime a latência média de uma operação repetida iterations vezes
+     */
+    static void report(const std::string &name, double totalMs, int iterations) {
+        printf("[ BENCH    ] %-48s %10.3f ms/op (%d ops)\n", name.c_str(), totalMs / iterations, iterations);
+    }
+
+    /**
+     * @brief Imprime a vazão de uma operação repetida items vezes
+     */
+    static void reportRate(const std::string &name, double totalMs, long items) {
+        printf("[ BENCH    ] %-48s %10.0f ops/s (%ld ops in %.1f ms)\n", name.c_str(), items * 1000.0 / totalMs, items, totalMs);
+    }
+
+private:
+    struct timespec start;
+};
+
+#endif /* BENCHMARK_H_ */
@@ -0,0 +1,80 @@
+#include <libcryptosec/BigInteger.h>
+
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+
+/**
+ * @brief Benchmarks da aritmética de BigInteger com valores que cabem em 64 bits
+ */
+class BigIntegerBenchmark : public ::testing::Test {
+
+protected:
+    /**
+     * @brief Mede mul, div e mod entre BigIntegers, que usam o BN_CTX da thread
+     */
+    void benchBigInteger() {
+        BigInteger factor(86400L);
+        BigInteger divisor(3600L);
+        long checksum = 0;
+        Benchmark timer;
+
+        for (long i = 0; i < count; i++) {
+            BigInteger value(i);
+            value.mul(factor);
+            value.div(divisor);
+            value.mod(factor);
+            checksum += (value > 0L) ? 1 : 0;
+        }
+        Benchmark::reportRate("BigInteger mul/div/mod (BigInteger)", timer.elapsedMs(), count);
+        ASSERT_NE(checksum, 0);
+    }
+
+    /**
+     * @brief Mede as mesmas operações com long, além de soma e comparação
+     */
+    void benchLong() {
+        long checksum = 0;
+        Benchmark timer;
+
+        for (long i = 0; i < count; i++) {
+            BigInteger value(i);
+            value.mul(86400L);
+            value.div(3600L);
+            value.mod(86400L);
+            value.add(7L);
+            checksum += (value > 7L) ? 1 : 0;
+        }
+        Benchmark::reportRate("BigInteger mul/div/mod/add (long)", timer.elapsedMs(), count);
+        ASSERT_NE(checksum, 0);
+    }
+
+    /**
+     * @brief Mede os operadores que retornam um novo BigInteger
+     */
+    void benchOperators() {
+        BigInteger step(1000003L);
+        BigInteger value(1L);
+        Benchmark timer;
+
+        for (long i = 0; i < count; i++) {
+            value = (value * step + i) % 1000000007L;
+        }
+        Benchmark::reportRate("BigInteger (a * b + i) % m", timer.elapsedMs(), count);
+        ASSERT_NE(value, 0L);
+    }
+
+    static const long count = 1000000;
+};
+
+TEST_F(BigIntegerBenchmark, BigInteger) {
+    benchBigInteger();
+}
+
+TEST_F(BigIntegerBenchmark, Long) {
+    benchLong();
+}
+
+TEST_F(BigIntegerBenchmark, Operators) {
+    benchOperators();
+}
@@ -0,0 +1,102 @@
+#include <libcryptosec/certificate/CertPathBuilder.h>
+#include <libcryptosec/certificate/CertPathValidator.h>
+
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "CertificateFixtures.h"
+
+/**
+ * @brief Benchmarks da construção de caminhos em um conjunto grande de intermediárias
+ */
+class CertPathBuilderBenchmark : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        char subject[64], issuer[64];
+        X509_up_ref(fixtures.ca);
+        trusted.push_back(Certificate(fixtures.ca));
+        /* chains of `depth` intermediates hang from the CA, and the leaf sits under the last one */
+        for (int i = 0; i < intermediates; i++) {
+            snprintf(subject, sizeof(subject), "Benchmark Intermediate %d", i);
+            if (i % depth == 0) {
+                snprintf(issuer, sizeof(issuer), "Benchmark CA");
+            } else {
+                snprintf(issuer, sizeof(issuer), "Benchmark Intermediate %d", i - 1);
+            }
+            pool.push_back(Certificate(fixtures.build(subject, issuer, i + 10, true)));
+        }
+        snprintf(issuer, sizeof(issuer), "Benchmark Intermediate %d", intermediates - 1);
+        leaf = new Certificate(fixtures.build("Benchmark Leaf", issuer, 5));
+    }
+
+    virtual void TearDown() {
+        delete leaf;
+    }
+
+    /**
+     * @brief Mede a validação com todas as intermediárias no caminho de certificação
+     */
+    void benchValidatorPool() {
+        vector<CertPathValidatorResult> results;
+        CertPathValidator validator(*leaf, pool, trusted);
+        Benchmark timer;
+        for (int i = 0; i < iterations; i++) {
+            ASSERT_TRUE(validator.verify(*leaf, results));
+        }
+        Benchmark::report("verify, pool of 500 intermediates", timer.elapsedMs(), iterations);
+    }
+
+    /**
+     * @brief Mede a construção do caminho seguida da validação do caminho encontrado
+     */
+    void benchBuilder() {
+        vector<CertPathValidatorResult> results;
+        vector<Certificate> path, chain;
+        CertPathBuilder builder(pool, trusted);
+        CertPathValidator validator(*leaf, chain, trusted);
+        Benchmark timer;
+        for (int i = 0; i < iterations; i++) {
+            ASSERT_TRUE(builder.build(*leaf, path));
+            chain.assign(path.begin() + 1, path.end() - 1);
+            ASSERT_TRUE(validator.verify(*leaf, chain, results));
+        }
+        Benchmark::report("build + verify, pool of 500 intermediates", timer.elapsedMs(), iterations);
+        CertPathBuilder::Cost cost = builder.getCost();
+        printf("[ BENCH    ] search cost: %lu expansions, %lu candidates, %lu pruned, %lu signatures\n",
+                cost.expansions, cost.candidates, cost.pruned, cost.signatureChecks);
+    }
+
+    /**
+     * @brief Mede apenas a construção do caminho
+     */
+    void benchBuildOnly() {
+        vector<Certificate> path;
+        CertPathBuilder builder(pool, trusted);
+        Benchmark timer;
+        for (int i = 0; i < iterations; i++) {
+            ASSERT_TRUE(builder.build(*leaf, path));
+        }
+        Benchmark::report("build, pool of 500 intermediates", timer.elapsedMs(), iterations);
+    }
+
+    static const int intermediates = 500;
+    static const int depth = 5;
+    static const int iterations = 200;
+    CertificateFixtures fixtures;
+    vector<Certificate> trusted;
+    vector<Certificate> pool;
+    Certificate *leaf;
+};
+
+TEST_F(CertPathBuilderBenchmark, ValidatorPool) {
+    benchValidatorPool();
+}
+
+TEST_F(CertPathBuilderBenchmark, Builder) {
+    benchBuilder();
+}
+
+TEST_F(CertPathBuilderBenchmark, BuildOnly) {
+    benchBuildOnly();
+}
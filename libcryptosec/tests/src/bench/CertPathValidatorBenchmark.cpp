@@ -0,0 +1,147 @@
+#include <libcryptosec/certificate/CertPathValidator.h>
+
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "CertificateFixtures.h"
+
+/**
+ * @brief Benchmarks da validação de caminhos com muitas âncoras de confiança
+ */
+class CertPathValidatorBenchmark : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        char subject[64];
+        X509_up_ref(fixtures.ca);
+        trusted.push_back(Certificate(fixtures.ca));
+        for (int i = 0; i < anchors; i++) {
+            snprintf(subject, sizeof(subject), "Benchmark Anchor %d", i);
+            trusted.push_back(Certificate(fixtures.build(subject, subject, i + 10, true)));
+        }
+        leaf = new Certificate(fixtures.build("Benchmark Leaf", "Benchmark CA", 5));
+    }
+
+    virtual void TearDown() {
+        delete leaf;
+    }
+
+    /**
+     * @brief Mede a validação com as âncoras passadas em um vetor, copiadas a cada chamada
+     */
+    void benchTrustedChain() {
+        vector<Certificate> untrustedChain;
+        CertPathValidator validator(*leaf, untrustedChain, trusted);
+        Benchmark timer;
+        for (int i = 0; i < iterations; i++) {
+            ASSERT_TRUE(validator.verify());
+        }
+        Benchmark::report("verify, vector of 2000 anchors", timer.elapsedMs(), iterations);
+    }
+
+    /**
+     * @brief Mede a validação com as âncoras em um CertificateStore indexado
+     */
+    void benchTrustedStore() {
+        vector<Certificate> untrustedChain;
+        CertificateStore store;
+        store.addCertificates(trusted);
+        CertPathValidator validator(*leaf, untrustedChain, store);
+        Benchmark timer;
+        for (int i = 0; i < iterations; i++) {
+            ASSERT_TRUE(validator.verify());
+        }
+        Benchmark::report("verify, CertificateStore of 2000 anchors", timer.elapsedMs(), iterations);
+    }
+
+    /**
+     * @brief Mede validações repetidas do mesmo certificado com e sem o cache de resultados
+     */
+    void benchCache(bool cached) {
+        vector<Certificate> untrustedChain;
+        vector<CertPathValidatorResult> results;
+        CertPathValidatorCache cache;
+        CertificateStore store;
+        char name[96];
+        store.addCertificates(trusted);
+        CertPathValidator validator(*leaf, untrustedChain, store);
+        if (cached) {
+            validator.setCache(cache);
+        }
+        Benchmark timer;
+        for (int i = 0; i < iterations * 10; i++) {
+            ASSERT_TRUE(validator.verify(*leaf, results));
+        }
+        snprintf(name, sizeof(name), "verify(certificate, results), %s", cached ? "cached" : "not cached");
+        Benchmark::report(name, timer.elapsedMs(), iterations * 10);
+        if (cached) {
+            printf("[ BENCH    ] cache hit rate %.3f\n", cache.getHitRate());
+        }
+    }
+
+    /**
+     * @brief Mede a validação de um lote de folhas emitidas por uma AC intermediária
+     */
+    void benchBatch(int threads) {
+        vector<Certificate> untrustedChain, anchor, leaves;
+        vector<vector<CertPathValidatorResult> > results;
+        vector<CertPathValidatorResult> single;
+        char name[96];
+        untrustedChain.push_back(Certificate(fixtures.build("Benchmark Intermediate", "Benchmark CA", 3, true)));
+        anchor.push_back(trusted[0]);
+        for (int i = 0; i < batch; i++) {
+            snprintf(name, sizeof(name), "Benchmark Batch Leaf %d", i);
+            leaves.push_back(Certificate(fixtures.build(name, "Benchmark Intermediate", 100000 + i)));
+        }
+        CertPathValidator validator(*leaf, untrustedChain, anchor);
+        Benchmark timer;
+        if (threads < 0) {
+            for (int i = 0; i < batch; i++) {
+                ASSERT_TRUE(validator.verify(leaves[i], single));
+            }
+            Benchmark::reportRate("verify(certificate, results) one by one", timer.elapsedMs(), batch);
+            return;
+        }
+        vector<bool> valid = validator.verifyBatch(leaves, results, threads);
+        snprintf(name, sizeof(name), "verifyBatch, %d thread(s)", threads);
+        Benchmark::reportRate(name, timer.elapsedMs(), batch);
+        for (int i = 0; i < batch; i++) {
+            ASSERT_TRUE(valid[i]);
+        }
+    }
+
+    static const int anchors = 2000;
+    static const int batch = 2000;
+    static const int iterations = 200;
+    CertificateFixtures fixtures;
+    vector<Certificate> trusted;
+    Certificate *leaf;
+};
+
+TEST_F(CertPathValidatorBenchmark, TrustedChain) {
+    benchTrustedChain();
+}
+
+TEST_F(CertPathValidatorBenchmark, TrustedStore) {
+    benchTrustedStore();
+}
+
+TEST_F(CertPathValidatorBenchmark, NotCached) {
+    benchCache(false);
+}
+
+TEST_F(CertPathValidatorBenchmark, Cached) {
+    benchCache(true);
+}
+
+TEST_F(CertPathValidatorBenchmark, BatchOneByOne) {
+    benchBatch(-1);
+}
+
+TEST_F(CertPathValidatorBenchmark, BatchSingleThread) {
+    benchBatch(1);
+}
+
+TEST_F(CertPathValidatorBenchmark, BatchAllProcessors) {
+    benchBatch(0);
+}
@@ -0,0 +1,99 @@
+#include <libcryptosec/certificate/Certificate.h>
+
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "CertificateFixtures.h"
+
+/**
+ * @brief Benchmarks da leitura de BasicConstraints e KeyUsage de certificados com várias extensões
+ */
+class CertificateExtensionBenchmark : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        const char *values[][2] = {
+            {"keyUsage", "critical,digitalSignature,keyEncipherment"},
+            {"extendedKeyUsage", "serverAuth,clientAuth"},
+            {"subjectAltName", "DNS:a.example,DNS:b.example,DNS:c.example,email:leaf@example"},
+            {"certificatePolicies", "1.3.6.1.4.1.99999.1.1,1.3.6.1.4.1.99999.1.2"},
+            {"crlDistributionPoints", "URI:http://crl.example/ca.crl"},
+            {"authorityInfoAccess", "caIssuers;URI:http://ca.example/ca.crt,OCSP;URI:http://ocsp.example"},
+        };
+        X509V3_CTX ctx;
+
+        for (int i = 0; i < count; i++) {
+            X509 *cert = fixtures.build("Benchmark Leaf", "Benchmark CA", 1000 + i);
+            X509V3_set_ctx(&ctx, fixtures.ca, cert, NULL, NULL, 0);
+            for (unsigned int j = 0; j < sizeof(values) / sizeof(values[0]); j++) {
+                X509_EXTENSION *ext = X509V3_EXT_conf(NULL, &ctx, values[j][0], values[j][1]);
+                X509_add_ext(cert, ext, -1);
+                X509_EXTENSION_free(ext);
+            }
+            X509_sign(cert, fixtures.key, EVP_sha256());
+            certificates.push_back(new Certificate(cert));
+        }
+    }
+
+    virtual void TearDown() {
+        for (unsigned int i = 0; i < certificates.size(); i++) {
+            delete certificates[i];
+        }
+    }
+
+    /**
+     * @brief Mede a leitura com getExtensions(), que decodifica todas as extensões
+     */
+    void benchGetExtensions() {
+        unsigned long checksum = 0;
+        Benchmark timer;
+
+        for (unsigned int i = 0; i < certificates.size(); i++) {
+            std::vector<Extension *> extensions = certificates[i]->getExtensions();
+            for (unsigned int j = 0; j < extensions.size(); j++) {
+                if (extensions[j]->getName() == "basicConstraints") {
+                    checksum += ((BasicConstraintsExtension *) extensions[j])->isCa() ? 1 : 2;
+                } else if (extensions[j]->getName() == "keyUsage") {
+                    checksum += ((KeyUsageExtension *) extensions[j])->getUsage(KeyUsageExtension::DIGITAL_SIGNATURE);
+                }
+                delete extensions[j];
+            }
+        }
+        Benchmark::reportRate("Certificate::getExtensions", timer.elapsedMs(), certificates.size());
+        ASSERT_NE(checksum, 0);
+    }
+
+    /**
+     * @brief Mede a leitura com os métodos tipados, que decodificam só as extensões pedidas
+     */
+    void benchTyped() {
+        unsigned long checksum = 0;
+        Benchmark timer;
+
+        for (unsigned int i = 0; i < certificates.size(); i++) {
+            checksum += certificates[i]->getBasicConstraints().isCa() ? 1 : 2;
+            checksum += certificates[i]->getKeyUsage().getUsage(KeyUsageExtension::DIGITAL_SIGNATURE);
+        }
+        Benchmark::reportRate("Certificate typed extensions (first call)", timer.elapsedMs(), certificates.size());
+
+        Benchmark cached;
+        for (unsigned int i = 0; i < certificates.size(); i++) {
+            checksum += certificates[i]->getBasicConstraints().isCa() ? 1 : 2;
+            checksum += certificates[i]->getKeyUsage().getUsage(KeyUsageExtension::DIGITAL_SIGNATURE);
+        }
+        Benchmark::reportRate("Certificate typed extensions (cached)", cached.elapsedMs(), certificates.size());
+        ASSERT_NE(checksum, 0);
+    }
+
+    static const int count = 5000;
+    CertificateFixtures fixtures;
+    std::vector<Certificate *> certificates;
+};
+
+TEST_F(CertificateExtensionBenchmark, GetExtensions) {
+    benchGetExtensions();
+}
+
+TEST_F(CertificateExtensionBenchmark, Typed) {
+    benchTyped();
+}
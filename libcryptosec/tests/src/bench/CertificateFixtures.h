@@ -0,0 +1,86 @@
+#ifndef CERTIFICATEFIXTURES_H_
+#define CERTIFICATEFIXTURES_H_
+
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Gera lotes de certificados sintéticos para os benchmarks.
+ * Todos são emitidos por uma mesma AC com chave P-256, para que o custo de
+ * geração fique baixo mesmo com centenas de milhares de certificados.
+ */
+class CertificateFixtures {
+
+public:
+    CertificateFixtures() {
+        EC_KEY *eckey = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+        EC_KEY_generate_key(eckey);
+        key = EVP_PKEY_new();
+        EVP_PKEY_assign_EC_KEY(key, eckey);
+        ca = build("Benchmark CA", "Benchmark CA", 1, true);
+    }
+
+    ~CertificateFixtures() {
+        X509_free(ca);
+        EVP_PKEY_free(key);
+    }
+
+    /**
+     * @brief Emite um certificado com o titular e o número de série informados
+     */
+    X509 *build(const std::string &subject, const std::string &issuer, long serial, bool authority = false) {
+        X509 *cert = X509_new();
+        X509_NAME *name;
+        X509_EXTENSION *ext;
+        X509V3_CTX ctx;
+
+        X509_set_version(cert, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), serial);
+        name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "O", MBSTRING_ASC, (const unsigned char *) "LibCryptoSec", -1, -1, 0);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *) subject.c_str(), -1, -1, 0);
+        name = X509_get_issuer_name(cert);
+        X509_NAME_add_entry_by_txt(name, "O", MBSTRING_ASC, (const unsigned char *) "LibCryptoSec", -1, -1, 0);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *) issuer.c_str(), -1, -1, 0);
+        X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 365L * 24 * 3600);
+        X509_set_pubkey(cert, key);
+        X509V3_set_ctx(&ctx, cert, cert, NULL, NULL, 0);
+        ext = X509V3_EXT_conf_nid(NULL, &ctx, NID_subject_key_identifier, (char *) "hash");
+        X509_add_ext(cert, ext, -1);
+        X509_EXTENSION_free(ext);
+        ext = X509V3_EXT_conf_nid(NULL, &ctx, NID_basic_constraints, authority ? (char *) "critical,CA:TRUE" : (char *) "critical,CA:FALSE");
+        X509_add_ext(cert, ext, -1);
+        X509_EXTENSION_free(ext);
+        X509_sign(cert, key, EVP_sha256());
+        return cert;
+    }
+
+    /**
+     * @brief Gera count certificados codificados em DER
+     */
+    std::vector<std::string> derBatch(int count) {
+        std::vector<std::string> ret;
+        char subject[64];
+        for (int i = 0; i < count; i++) {
+            snprintf(subject, sizeof(subject), "Benchmark Leaf %d", i);
+            X509 *cert = build(subject, "Benchmark CA", 1000 + i);
+            unsigned char *der = NULL;
+            int len = i2d_X509(cert, &der);
+            ret.push_back(std::string((const char *) der, len));
+            OPENSSL_free(der);
+            X509_free(cert);
+        }
+        return ret;
+    }
+
+    X509 *ca;
+    EVP_PKEY *key;
+};
+
+#endif /* CERTIFICATEFIXTURES_H_ */
@@ -0,0 +1,231 @@
+#include <libcryptosec/certificate/CertificateRevocationList.h>
+#include <libcryptosec/certificate/CertificateRevocationListBuilder.h>
+#include <libcryptosec/certificate/CertificateRevocationListReader.h>
+#include <libcryptosec/certificate/RevocationSnapshot.h>
+
+#include <fstream>
+#include <sstream>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "CertificateFixtures.h"
+
+/**
+ * @brief Benchmarks da consulta de números de série em LCRs grandes
+ */
+class CertificateRevocationListBenchmark : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        X509_CRL *x509Crl = X509_CRL_new();
+        ASN1_TIME *date = ASN1_TIME_set(NULL, 1487889918);
+        X509_CRL_set1_lastUpdate(x509Crl, date);
+        for (long i = 0; i < entries; i++) {
+            X509_REVOKED *revoked = X509_REVOKED_new();
+            ASN1_INTEGER *serial = ASN1_INTEGER_new();
+            /* spread the serial numbers the way random serials would be */
+            ASN1_INTEGER_set(serial, i * 7919 + 1000000007L);
+            X509_REVOKED_set_serialNumber(revoked, serial);
+            X509_REVOKED_set_revocationDate(revoked, date);
+            ASN1_INTEGER_free(serial);
+            X509_CRL_add0_revoked(x509Crl, revoked);
+        }
+        ASN1_TIME_free(date);
+        X509_CRL_sign(x509Crl, fixtures.key, EVP_sha256());
+        crl = new CertificateRevocationList(x509Crl);
+    }
+
+    virtual void TearDown() {
+        delete crl;
+    }
+
+    /**
+     * @brief Mede a busca percorrendo getRevokedCertificate, como era feito antes
+     */
+    void benchScan() {
+        BigInteger serial(entries / 2 * 7919 + 1000000007L);
+        Benchmark timer;
+        for (int i = 0; i < scans; i++) {
+            std::vector<RevokedCertificate> revoked = crl->getRevokedCertificate();
+            bool found = false;
+            for (unsigned int j = 0; j < revoked.size() && !found; j++) {
+                found = (revoked[j].getCertificateSerialNumberBigInt() == serial);
+            }
+            ASSERT_TRUE(found);
+        }
+        Benchmark::report("getRevokedCertificate scan, 200000 entries", timer.elapsedMs(), scans);
+    }
+
+    /**
+     * @brief Mede isRevoked, incluindo a montagem do índice na primeira consulta
+     */
+    void benchIsRevoked() {
+        Benchmark build;
+        ASSERT_TRUE(crl->isRevoked(BigInteger(1000000007L)));
+        Benchmark::report("isRevoked, first lookup (index build)", build.elapsedMs(), 1);
+        Benchmark timer;
+        for (long i = 0; i < lookups; i++) {
+            ASSERT_EQ(crl->isRevoked(BigInteger(i * 7919 + 1000000007L + (i % 2))), i % 2 == 0);
+        }
+        Benchmark::reportRate("isRevoked, 200000 entries", timer.elapsedMs(), lookups);
+    }
+
+    /**
+     * @brief Mede consultas de números não revogados com e sem o filtro de Bloom
+     */
+    void benchIsRevokedMisses(double falsePositiveRate) {
+        char name[96];
+        crl->setBloomFilter(falsePositiveRate);
+        ASSERT_TRUE(crl->isRevoked(BigInteger(1000000007L)));
+        Benchmark timer;
+        for (long i = 0; i < lookups; i++) {
+            ASSERT_FALSE(crl->isRevoked(BigInteger(i * 7919 + 1000000008L)));
+        }
+        snprintf(name, sizeof(name), "isRevoked misses, bloom filter rate %g", falsePositiveRate);
+        Benchmark::reportRate(name, timer.elapsedMs(), lookups);
+        if (crl->getBloomFilter() != NULL) {
+            ASSERT_GT(crl->getBloomFilter()->getRejections(), (unsigned long) lookups * 9 / 10);
+        }
+    }
+
+    /**
+     * @brief Compara a decodificação completa da LCR com a leitura sequencial das entradas
+     */
+    void benchRead() {
+        ByteArray der = crl->getDerEncoded();
+        CertificateRevocationListReader::Entry entry;
+        Benchmark decode;
+        CertificateRevocationList decoded(der);
+        Benchmark::reportRate("CertificateRevocationList(der), 200000 entries", decode.elapsedMs(), entries);
+        Benchmark timer;
+        CertificateRevocationListReader reader(der.getDataPointer(), der.size());
+        while (reader.next(entry)) {
+        }
+        Benchmark::reportRate("CertificateRevocationListReader::next, 200000 entries", timer.elapsedMs(), entries);
+        ASSERT_EQ(reader.getCount(), (unsigned long) entries);
+    }
+
+    /**
+     * @brief Compara a inicialização a partir da LCR com a abertura de um RevocationSnapshot
+     */
+    void benchSnapshot(unsigned int bloomBitsPerEntry) {
+        char path[] = "/tmp/revocationSnapshotBenchXXXXXX";
+        char name[96];
+        ByteArray der = crl->getDerEncoded();
+        close(mkstemp(path));
+        EVP_PKEY_up_ref(fixtures.key);
+        PrivateKey privateKey(fixtures.key);
+        EVP_PKEY_up_ref(fixtures.key);
+        PublicKey publicKey(fixtures.key);
+        {
+            std::ofstream out(path, std::ios::out | std::ios::binary);
+            RevocationSnapshot::write(*crl, privateKey, out, bloomBitsPerEntry);
+        }
+
+        Benchmark decode;
+        CertificateRevocationList decoded(der);
+        ASSERT_TRUE(decoded.verify(publicKey));
+        ASSERT_TRUE(decoded.isRevoked(BigInteger(1000000007L)));
+        Benchmark::report("startup from CRL (decode, verify, index)", decode.elapsedMs(), 1);
+
+        Benchmark open;
+        ByteArray hash = RevocationSnapshot::getCrlHash(der.getDataPointer(), der.size());
+        RevocationSnapshot snapshot(path, publicKey, hash);
+        Benchmark::report("startup from RevocationSnapshot (hash, verify)", open.elapsedMs(), 1);
+
+        Benchmark timer;
+        for (long i = 0; i < lookups; i++) {
+            ASSERT_EQ(snapshot.isRevoked(BigInteger(i * 7919 + 1000000007L + (i % 2))), i % 2 == 0);
+        }
+        snprintf(name, sizeof(name), "RevocationSnapshot::isRevoked, bloom %u bits/entry", bloomBitsPerEntry);
+        Benchmark::reportRate(name, timer.elapsedMs(), lookups);
+        unlink(path);
+    }
+
+    /**
+     * @brief Compara sign com addRevokedCertificate e a geração em fluxo com as mesmas entradas
+     */
+    void benchBuild() {
+        std::vector<CertificateRevocationListBuilder::RevokedEntry> revoked(entries);
+        DateTime date(1487889918);
+        EVP_PKEY_up_ref(fixtures.key);
+        PrivateKey privateKey(fixtures.key);
+        EVP_PKEY_up_ref(fixtures.key);
+        PublicKey publicKey(fixtures.key);
+        for (long i = 0; i < entries; i++) {
+            CertificateRevocationListReader::getSerialNumberContent(BigInteger(i * 7919 + 1000000007L),
+                    revoked[i].serialNumber);
+            revoked[i].revocationDate = 1487889918;
+            revoked[i].reasonCode = RevokedCertificate::KEY_COMPROMISE;
+        }
+
+        Benchmark add;
+        CertificateRevocationListBuilder builder;
+        for (long i = 0; i < entries; i++) {
+            RevokedCertificate entry;
+            entry.setCertificateSerialNumber(BigInteger(i * 7919 + 1000000007L));
+            entry.setRevocationDate(date);
+            entry.setReasonCode(RevokedCertificate::KEY_COMPROMISE);
+            builder.addRevokedCertificate(entry);
+        }
+        CertificateRevocationList *built = builder.sign(privateKey, MessageDigest::SHA256);
+        ByteArray der = built->getDerEncoded();
+        delete built;
+        Benchmark::reportRate("addRevokedCertificate + sign + getDerEncoded, 200000 entries", add.elapsedMs(), entries);
+
+        Benchmark stream;
+        CertificateRevocationListBuilder header;
+        std::ostringstream out;
+        header.sign(privateKey, MessageDigest::SHA256, revoked, out);
+        Benchmark::reportRate("sign to std::ostream, 200000 entries", stream.elapsedMs(), entries);
+        std::string streamed = out.str();
+        CertificateRevocationListReader reader((const unsigned char *) streamed.data(), streamed.size());
+        CertificateRevocationListReader::Entry entry;
+        reader.setPublicKey(publicKey);
+        while (reader.next(entry)) {
+        }
+        ASSERT_EQ(reader.getCount(), (unsigned long) entries);
+        ASSERT_TRUE(reader.verify());
+    }
+
+    static const long entries = 200000;
+    static const int scans = 3;
+    static const long lookups = 100000;
+    CertificateFixtures fixtures;
+    CertificateRevocationList *crl;
+};
+
+TEST_F(CertificateRevocationListBenchmark, Scan) {
+    benchScan();
+}
+
+TEST_F(CertificateRevocationListBenchmark, IsRevoked) {
+    benchIsRevoked();
+}
+
+TEST_F(CertificateRevocationListBenchmark, IsRevokedMisses) {
+    benchIsRevokedMisses(0.0);
+}
+
+TEST_F(CertificateRevocationListBenchmark, IsRevokedMissesBloom) {
+    benchIsRevokedMisses(0.01);
+}
+
+TEST_F(CertificateRevocationListBenchmark, Read) {
+    benchRead();
+}
+
+TEST_F(CertificateRevocationListBenchmark, Snapshot) {
+    benchSnapshot(0);
+}
+
+TEST_F(CertificateRevocationListBenchmark, SnapshotBloom) {
+    benchSnapshot(10);
+}
+
+TEST_F(CertificateRevocationListBenchmark, Build) {
+    benchBuild();
+}
@@ -0,0 +1,103 @@
+#include <libcryptosec/certificate/CertificateStore.h>
+
+#include <openssl/pem.h>
+#include <fstream>
+#include <stdlib.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "CertificateFixtures.h"
+
+/**
+ * @brief Benchmarks da carga de pacotes PEM grandes
+ */
+class CertificateStoreBenchmark : public ::testing::Test {
+
+protected:
+    static void SetUpTestCase() {
+        CertificateFixtures fixtures;
+        std::vector<std::string> ders = fixtures.derBatch(count);
+        char path[] = "/tmp/certificateStoreBenchXXXXXX";
+        int fd = mkstemp(path);
+        close(fd);
+        bundlePath = path;
+
+        std::ofstream file(path, std::ios::out | std::ios::binary);
+        for (unsigned int i = 0; i < ders.size(); i++) {
+            const unsigned char *p = (const unsigned char *) ders[i].data();
+            X509 *cert = d2i_X509(NULL, &p, ders[i].size());
+            BIO *bio = BIO_new(BIO_s_mem());
+            char *data;
+            PEM_write_bio_X509(bio, cert);
+            long len = BIO_get_mem_data(bio, &data);
+            pems.push_back(std::string(data, len));
+            file << pems.back();
+            BIO_free(bio);
+            X509_free(cert);
+        }
+        file.close();
+    }
+
+    static void TearDownTestCase() {
+        unlink(bundlePath.c_str());
+        pems.clear();
+    }
+
+    /**
+     * @brief Mede a carga um a um com Certificate(std::string), como era feito antes
+     */
+    void benchOneByOne() {
+        Benchmark timer;
+        std::vector<Certificate *> certs;
+        for (unsigned int i = 0; i < pems.size(); i++) {
+            certs.push_back(new Certificate(pems[i]));
+        }
+        Benchmark::reportRate("Certificate(pem) one by one", timer.elapsedMs(), certs.size());
+        for (unsigned int i = 0; i < certs.size(); i++) {
+            delete certs[i];
+        }
+    }
+
+    /**
+     * @brief Mede loadPemBundle com a quantidade de threads informada
+     */
+    void benchBundle(unsigned int threads, bool deduplicate) {
+        CertificateStore store;
+        char name[96];
+        store.setThreads(threads);
+        store.setDeduplicate(deduplicate);
+        Benchmark timer;
+        unsigned int loaded = store.loadPemBundle(bundlePath);
+        snprintf(name, sizeof(name), "loadPemBundle, %u thread(s)%s", threads, deduplicate ? ", dedup" : "");
+        Benchmark::reportRate(name, timer.elapsedMs(), loaded);
+        ASSERT_EQ(loaded, (unsigned int) count);
+    }
+
+    static const int count = 20000;
+    static std::string bundlePath;
+    static std::vector<std::string> pems;
+};
+
+std::string CertificateStoreBenchmark::bundlePath;
+std::vector<std::string> CertificateStoreBenchmark::pems;
+
+TEST_F(CertificateStoreBenchmark, OneByOne) {
+    benchOneByOne();
+}
+
+TEST_F(CertificateStoreBenchmark, BundleSingleThread) {
+    benchBundle(1, false);
+}
+
+TEST_F(CertificateStoreBenchmark, BundleFourThreads) {
+    benchBundle(4, false);
+}
+
+TEST_F(CertificateStoreBenchmark, BundleAllProcessors) {
+    benchBundle(0, false);
+}
+
+TEST_F(CertificateStoreBenchmark, BundleAllProcessorsDeduplicate) {
+    benchBundle(0, true);
+}
@@ -0,0 +1,83 @@
+#include <libcryptosec/certificate/CertificateView.h>
+
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "CertificateFixtures.h"
+
+/**
+ * @brief Benchmarks da leitura de número de série, hash do emissor e fim da validade
+ */
+class CertificateViewBenchmark : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        ders = fixtures.derBatch(count);
+    }
+
+    /**
+     * @brief Mede a decodificação completa com Certificate
+     */
+    void benchCertificate() {
+        unsigned long checksum = 0;
+        Benchmark timer;
+
+        for (unsigned int i = 0; i < ders.size(); i++) {
+            ByteArray der((const unsigned char *) ders[i].data(), ders[i].size());
+            Certificate cert(der);
+            checksum += cert.getSerialNumberBigInt().getValue();
+            checksum += X509_issuer_name_hash(cert.getX509());
+            checksum += cert.getNotAfter().getDateTime();
+        }
+        Benchmark::reportRate("Certificate serial/issuer hash/notAfter", timer.elapsedMs(), ders.size());
+        ASSERT_NE(checksum, 0);
+    }
+
+    /**
+     * @brief Mede a mesma leitura com CertificateView sobre o buffer original
+     */
+    void benchView() {
+        unsigned long checksum = 0;
+        Benchmark timer;
+
+        for (unsigned int i = 0; i < ders.size(); i++) {
+            CertificateView view((const unsigned char *) ders[i].data(), ders[i].size());
+            checksum += view.getSerialNumberBigInt().getValue();
+            checksum += view.getIssuerHash();
+            checksum += view.getNotAfter().getDateTime();
+        }
+        Benchmark::reportRate("CertificateView serial/issuer hash/notAfter", timer.elapsedMs(), ders.size());
+        ASSERT_NE(checksum, 0);
+    }
+
+    /**
+     * @brief Mede apenas a indexação dos campos
+     */
+    void benchIndex() {
+        unsigned long checksum = 0;
+        Benchmark timer;
+
+        for (unsigned int i = 0; i < ders.size(); i++) {
+            CertificateView view((const unsigned char *) ders[i].data(), ders[i].size());
+            checksum += view.getEncodedLength();
+        }
+        Benchmark::reportRate("CertificateView index only", timer.elapsedMs(), ders.size());
+        ASSERT_NE(checksum, 0);
+    }
+
+    static const int count = 20000;
+    CertificateFixtures fixtures;
+    std::vector<std::string> ders;
+};
+
+TEST_F(CertificateViewBenchmark, Certificate) {
+    benchCertificate();
+}
+
+TEST_F(CertificateViewBenchmark, View) {
+    benchView();
+}
+
+TEST_F(CertificateViewBenchmark, IndexOnly) {
+    benchIndex();
+}
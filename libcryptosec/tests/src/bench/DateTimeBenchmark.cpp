@@ -0,0 +1,96 @@
+#include <libcryptosec/DateTime.h>
+
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+
+/**
+ * @brief Benchmarks da leitura, escrita e aritmética de datas
+ */
+class DateTimeBenchmark : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        for (int i = 0; i < size; i++) {
+            times[i] = DateTime((time_t) (1487889907L + i * 86399L)).getAsn1Time();
+        }
+    }
+
+    virtual void TearDown() {
+        for (int i = 0; i < size; i++) {
+            ASN1_TIME_free(times[i]);
+        }
+    }
+
+    /**
+     * @brief Mede a leitura de ASN1_TIME pelo OpenSSL, com ASN1_TIME_to_tm e timegm
+     */
+    void benchOpenSSLParse() {
+        unsigned long checksum = 0;
+        struct tm tm;
+        Benchmark timer;
+
+        for (int i = 0; i < count; i++) {
+            ASN1_TIME_to_tm(times[i % size], &tm);
+            checksum += timegm(&tm);
+        }
+        Benchmark::reportRate("ASN1_TIME_to_tm + timegm", timer.elapsedMs(), count);
+        ASSERT_NE(checksum, 0);
+    }
+
+    /**
+     * @brief Mede DateTime(ASN1_TIME*) e getAsn1Time(), que não passam pelo OpenSSL
+     */
+    void benchDateTime() {
+        unsigned long checksum = 0;
+        Benchmark timer;
+
+        for (int i = 0; i < count; i++) {
+            checksum += DateTime(times[i % size]).getDateTime();
+        }
+        Benchmark::reportRate("DateTime(ASN1_TIME*)", timer.elapsedMs(), count);
+
+        Benchmark encode;
+        for (int i = 0; i < count; i++) {
+            ASN1_TIME *time = DateTime((time_t) (1487889907L + i)).getAsn1Time();
+            checksum += time->length;
+            ASN1_TIME_free(time);
+        }
+        Benchmark::reportRate("DateTime::getAsn1Time", encode.elapsedMs(), count);
+        ASSERT_NE(checksum, 0);
+    }
+
+    /**
+     * @brief Mede addDays() e a comparação de datas, usadas na verificação de validade
+     */
+    void benchArithmetic() {
+        unsigned long checksum = 0;
+        DateTime now((time_t) 1487889907L);
+        DateTime date;
+        Benchmark timer;
+
+        for (int i = 0; i < count; i++) {
+            date = now;
+            date.addDays(i % 1000);
+            checksum += (date > now) ? 1 : 0;
+        }
+        Benchmark::reportRate("DateTime::addDays + operator>", timer.elapsedMs(), count);
+        ASSERT_NE(checksum, 0);
+    }
+
+    static const int count = 1000000;
+    static const int size = 1000;
+    ASN1_TIME *times[size];
+};
+
+TEST_F(DateTimeBenchmark, OpenSSLParse) {
+    benchOpenSSLParse();
+}
+
+TEST_F(DateTimeBenchmark, DateTime) {
+    benchDateTime();
+}
+
+TEST_F(DateTimeBenchmark, Arithmetic) {
+    benchArithmetic();
+}
@@ -0,0 +1,109 @@
+#include <libcryptosec/certificate/CertificateRevocationList.h>
+#include <libcryptosec/certificate/CertificateRevocationListReader.h>
+#include <libcryptosec/certificate/JsonWriter.h>
+#include <libcryptosec/certificate/XmlWriter.h>
+
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "CertificateFixtures.h"
+
+/**
+ * @brief Benchmarks da escrita de uma LCR grande em XML e JSON
+ */
+class DocumentWriterBenchmark : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        X509_CRL *x509Crl = X509_CRL_new();
+        ASN1_TIME *date = ASN1_TIME_set(NULL, 1487889918);
+        ASN1_TIME *nextUpdate = ASN1_TIME_set(NULL, 1487889918 + 7 * 86400);
+        unsigned char *der = NULL;
+        int length;
+
+        X509_CRL_set_version(x509Crl, 1);
+        X509_CRL_set_issuer_name(x509Crl, X509_get_subject_name(fixtures.ca));
+        X509_CRL_set1_lastUpdate(x509Crl, date);
+        X509_CRL_set1_nextUpdate(x509Crl, nextUpdate);
+        for (long i = 0; i < entries; i++) {
+            X509_REVOKED *revoked = X509_REVOKED_new();
+            ASN1_INTEGER *serial = ASN1_INTEGER_new();
+            ASN1_ENUMERATED *reason = ASN1_ENUMERATED_new();
+            ASN1_INTEGER_set(serial, i * 7919 + 1000000007L);
+            X509_REVOKED_set_serialNumber(revoked, serial);
+            X509_REVOKED_set_revocationDate(revoked, date);
+            ASN1_ENUMERATED_set(reason, i % 2);
+            X509_REVOKED_add1_ext_i2d(revoked, NID_crl_reason, reason, 0, 0);
+            ASN1_INTEGER_free(serial);
+            ASN1_ENUMERATED_free(reason);
+            X509_CRL_add0_revoked(x509Crl, revoked);
+        }
+        ASN1_TIME_free(date);
+        ASN1_TIME_free(nextUpdate);
+        X509_CRL_sign(x509Crl, fixtures.key, EVP_sha256());
+        length = i2d_X509_CRL(x509Crl, &der);
+        crlDer.assign((const char *) der, length);
+        OPENSSL_free(der);
+        crl = new CertificateRevocationList(x509Crl);
+        output.open("/dev/null");
+    }
+
+    virtual void TearDown() {
+        delete crl;
+    }
+
+    /**
+     * @brief Mede getXmlEncoded(), que monta o documento inteiro em uma string
+     */
+    void benchXmlEncoded() {
+        Benchmark timer;
+        output << crl->getXmlEncoded();
+        Benchmark::reportRate("CRL getXmlEncoded, entries", timer.elapsedMs(), entries);
+    }
+
+    /**
+     * @brief Mede write() com os dois formatos, escrevendo direto no fluxo
+     */
+    void benchWrite() {
+        Benchmark xml;
+        XmlWriter xmlWriter(output);
+        crl->write(xmlWriter);
+        Benchmark::reportRate("CRL write to XmlWriter, entries", xml.elapsedMs(), entries);
+
+        Benchmark json;
+        JsonWriter jsonWriter(output);
+        crl->write(jsonWriter);
+        Benchmark::reportRate("CRL write to JsonWriter, entries", json.elapsedMs(), entries);
+    }
+
+    /**
+     * @brief Mede a escrita das entradas à medida que são lidas do DER, sem decodificar a LCR
+     */
+    void benchReaderWrite() {
+        Benchmark timer;
+        CertificateRevocationListReader reader((const unsigned char *) crlDer.data(), crlDer.size());
+        JsonWriter writer(output);
+        ASSERT_EQ(reader.write(writer), (unsigned long) entries);
+        Benchmark::reportRate("CRL reader write to JsonWriter, entries", timer.elapsedMs(), entries);
+    }
+
+    static const long entries = 200000;
+    CertificateFixtures fixtures;
+    CertificateRevocationList *crl;
+    std::string crlDer;
+    std::ofstream output;
+};
+
+TEST_F(DocumentWriterBenchmark, XmlEncoded) {
+    benchXmlEncoded();
+}
+
+TEST_F(DocumentWriterBenchmark, Write) {
+    benchWrite();
+}
+
+TEST_F(DocumentWriterBenchmark, ReaderWrite) {
+    benchReaderWrite();
+}
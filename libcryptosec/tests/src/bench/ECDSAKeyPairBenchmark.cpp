@@ -0,0 +1,100 @@
+#include <libcryptosec/ECDSAKeyPair.h>
+#include <libcryptosec/ec/BrainpoolCurveFactory.h>
+#include <libcryptosec/ec/EllipticCurveRegistry.h>
+
+#include <openssl/ecdsa.h>
+#include <sstream>
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+
+/**
+ * @brief Benchmarks de geração de chaves e assinatura com curvas Brainpool
+ */
+class ECDSAKeyPairBenchmark : public ::testing::Test {
+
+protected:
+    /**
+     * @brief Mede a geração de chaves construindo um grupo novo a cada par (comportamento antigo)
+     */
+    void benchGenerateFreshGroup(BrainpoolCurveFactory::CurveName name) {
+        const EllipticCurve *curve = BrainpoolCurveFactory::getSharedCurve(name);
+        Benchmark timer;
+
+        for (int i = 0; i < iterations; i++) {
+            EC_GROUP *group = EllipticCurveRegistry::createGroup(*curve);
+            EC_KEY *eckey = EC_KEY_new();
+            EC_KEY_set_group(eckey, group);
+            EC_KEY_generate_key(eckey);
+            EC_KEY_free(eckey);
+            EC_GROUP_free(group);
+        }
+        Benchmark::report("ECDSA keygen, fresh group, " + curve->getName(), timer.elapsedMs(), iterations);
+    }
+
+    /**
+     * @brief Mede a geração de chaves com o grupo compartilhado do registro
+     */
+    void benchGenerateSharedGroup(BrainpoolCurveFactory::CurveName name) {
+        const EllipticCurve *curve = BrainpoolCurveFactory::getSharedCurve(name);
+        EllipticCurveRegistry::getGroup(*curve);
+        Benchmark timer;
+
+        for (int i = 0; i < iterations; i++) {
+            ECDSAKeyPair keyPair(*curve);
+        }
+        Benchmark::report("ECDSA keygen, shared group, " + curve->getName(), timer.elapsedMs(), iterations);
+    }
+
+    /**
+     * @brief Mede a verificação de assinaturas com e sem a pré-computação do gerador
+     */
+    void benchVerify(BrainpoolCurveFactory::CurveName name, bool precomputed) {
+        const EllipticCurve *curve = BrainpoolCurveFactory::getSharedCurve(name);
+        EC_GROUP *group = precomputed ? EC_GROUP_dup(EllipticCurveRegistry::getGroup(*curve))
+                                      : EllipticCurveRegistry::createGroup(*curve);
+        EC_KEY *eckey = EC_KEY_new();
+        unsigned char digest[32] = {1};
+        EC_KEY_set_group(eckey, group);
+        EC_KEY_generate_key(eckey);
+        ECDSA_SIG *sig = ECDSA_do_sign(digest, sizeof(digest), eckey);
+        Benchmark timer;
+
+        for (int i = 0; i < iterations; i++) {
+            ASSERT_EQ(ECDSA_do_verify(digest, sizeof(digest), sig, eckey), 1);
+        }
+        Benchmark::report("ECDSA verify, " + std::string(precomputed ? "precomputed, " : "plain, ") + curve->getName(),
+                timer.elapsedMs(), iterations);
+        ECDSA_SIG_free(sig);
+        EC_KEY_free(eckey);
+        EC_GROUP_free(group);
+    }
+
+    static int iterations;
+};
+
+int ECDSAKeyPairBenchmark::iterations = 500;
+
+TEST_F(ECDSAKeyPairBenchmark, GenerateFreshGroupBP256r1) {
+  benchGenerateFreshGroup(BrainpoolCurveFactory::BP256r1);
+}
+
+TEST_F(ECDSAKeyPairBenchmark, GenerateSharedGroupBP256r1) {
+  benchGenerateSharedGroup(BrainpoolCurveFactory::BP256r1);
+}
+
+TEST_F(ECDSAKeyPairBenchmark, VerifyPlainBP256r1) {
+  benchVerify(BrainpoolCurveFactory::BP256r1, false);
+}
+
+TEST_F(ECDSAKeyPairBenchmark, VerifyPrecomputedBP256r1) {
+  benchVerify(BrainpoolCurveFactory::BP256r1, true);
+}
+
+TEST_F(ECDSAKeyPairBenchmark, GenerateFreshGroupBP512r1) {
+  benchGenerateFreshGroup(BrainpoolCurveFactory::BP512r1);
+}
+
+TEST_F(ECDSAKeyPairBenchmark, GenerateSharedGroupBP512r1) {
+  benchGenerateSharedGroup(BrainpoolCurveFactory::BP512r1);
+}
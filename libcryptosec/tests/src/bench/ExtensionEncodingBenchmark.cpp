@@ -0,0 +1,129 @@
+#include <libcryptosec/certificate/AuthorityInformationAccessExtension.h>
+#include <libcryptosec/certificate/CRLDistributionPointsExtension.h>
+#include <libcryptosec/certificate/SubjectAlternativeNameExtension.h>
+
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+
+/**
+ * @brief Benchmarks da codificação das extensões com nomes, pelo OpenSSL e pelo DerWriter
+ */
+class ExtensionEncodingBenchmark : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        GeneralNames names;
+        GeneralName dns, email, uri, ocspUri;
+        DistributionPointName fullName;
+        GeneralNames crlNames;
+        AccessDescription ocsp;
+
+        dns.setDnsName("a.example");
+        names.addGeneralName(dns);
+        dns.setDnsName("b.example");
+        names.addGeneralName(dns);
+        dns.setDnsName("c.example");
+        names.addGeneralName(dns);
+        email.setRfc822Name("leaf@example");
+        names.addGeneralName(email);
+        subjectAltName.setSubjectAltName(names);
+
+        uri.setUniformResourceIdentifier("http://crl.example/ca.crl");
+        crlNames.addGeneralName(uri);
+        fullName.setFullName(crlNames);
+        distributionPoint.setDistributionPointName(fullName);
+        crlDistributionPoints.addDistributionPoint(distributionPoint);
+
+        ocspUri.setUniformResourceIdentifier("http://ocsp.example");
+        ocsp.setAccessMethod(ObjectIdentifierFactory::getObjectIdentifier(NID_ad_OCSP));
+        ocsp.setAccessLocation(ocspUri);
+        authorityInfoAccess.addAccessDescription(ocsp);
+    }
+
+    virtual void TearDown() {
+    }
+
+    /**
+     * @brief Mede a codificação pelas estruturas do OpenSSL, como era feita antes do DerWriter
+     */
+    void benchOpenSSL() {
+        unsigned long total = 0;
+        Benchmark timer;
+
+        for (int i = 0; i < count; i++) {
+            GENERAL_NAMES *generalNames = subjectAltName.getSubjectAltName().getInternalGeneralNames();
+            CRL_DIST_POINTS *distPoints = CRL_DIST_POINTS_new();
+            sk_DIST_POINT_push(distPoints, distributionPoint.getDistPoint());
+
+            total += encode(X509V3_EXT_i2d(NID_subject_alt_name, 0, generalNames));
+            total += encode(X509V3_EXT_i2d(NID_crl_distribution_points, 0, distPoints));
+            sk_GENERAL_NAME_pop_free(generalNames, GENERAL_NAME_free);
+            CRL_DIST_POINTS_free(distPoints);
+        }
+        Benchmark::reportRate("SAN + CDP via OpenSSL ASN1 items", timer.elapsedMs(), count);
+        ASSERT_GT(total, 0);
+    }
+
+    /**
+     * @brief Mede getX509Extension(), que agora escreve o valor com o DerWriter
+     */
+    void benchX509Extension() {
+        unsigned long total = 0;
+        Benchmark timer;
+
+        for (int i = 0; i < count; i++) {
+            total += encode(subjectAltName.getX509Extension());
+            total += encode(crlDistributionPoints.getX509Extension());
+        }
+        Benchmark::reportRate("SAN + CDP via getX509Extension", timer.elapsedMs(), count);
+        ASSERT_GT(total, 0);
+    }
+
+    /**
+     * @brief Mede getDerEncoded(), que não monta nenhuma estrutura do OpenSSL
+     */
+    void benchDerEncoded() {
+        unsigned long total = 0;
+        Benchmark timer;
+
+        for (int i = 0; i < count; i++) {
+            total += subjectAltName.getDerEncoded().size();
+            total += crlDistributionPoints.getDerEncoded().size();
+        }
+        Benchmark::reportRate("SAN + CDP via getDerEncoded", timer.elapsedMs(), count);
+
+        Benchmark access;
+        for (int i = 0; i < count; i++) {
+            total += authorityInfoAccess.getDerEncoded().size();
+        }
+        Benchmark::reportRate("AIA via getDerEncoded", access.elapsedMs(), count);
+        ASSERT_GT(total, 0);
+    }
+
+    static unsigned long encode(X509_EXTENSION *ext) {
+        unsigned char *data = NULL;
+        int length = i2d_X509_EXTENSION(ext, &data);
+        OPENSSL_free(data);
+        X509_EXTENSION_free(ext);
+        return length;
+    }
+
+    static const int count = 50000;
+    SubjectAlternativeNameExtension subjectAltName;
+    DistributionPoint distributionPoint;
+    CRLDistributionPointsExtension crlDistributionPoints;
+    AuthorityInformationAccessExtension authorityInfoAccess;
+};
+
+TEST_F(ExtensionEncodingBenchmark, OpenSSL) {
+    benchOpenSSL();
+}
+
+TEST_F(ExtensionEncodingBenchmark, X509Extension) {
+    benchX509Extension();
+}
+
+TEST_F(ExtensionEncodingBenchmark, DerEncoded) {
+    benchDerEncoded();
+}
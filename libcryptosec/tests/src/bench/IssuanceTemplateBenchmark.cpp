@@ -0,0 +1,135 @@
+#include <libcryptosec/certificate/IssuanceTemplate.h>
+
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "CertificateFixtures.h"
+
+/**
+ * @brief Benchmarks da emissão de certificados com os mesmos campos invariantes
+ */
+class IssuanceTemplateBenchmark : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        EVP_PKEY_up_ref(fixtures.key);
+        privateKey = new PrivateKey(fixtures.key);
+        EVP_PKEY_up_ref(fixtures.key);
+        publicKey = new PublicKey(fixtures.key);
+        issuer.addEntry(RDNSequence::ORGANIZATION, "LibCryptoSec");
+        issuer.addEntry(RDNSequence::COMMON_NAME, "Benchmark CA");
+        subject.addEntry(RDNSequence::ORGANIZATION, "LibCryptoSec");
+        subject.addEntry(RDNSequence::COMMON_NAME, "Benchmark Leaf");
+        keyUsage.setUsage(KeyUsageExtension::DIGITAL_SIGNATURE, true);
+        keyUsage.setCritical(true);
+        basicConstraints.setCa(false);
+        basicConstraints.setCritical(true);
+    }
+
+    virtual void TearDown() {
+        delete privateKey;
+        delete publicKey;
+    }
+
+    /**
+     * @brief Mede a emissão com CertificateBuilder, montando o X509 de cada certificado
+     */
+    void benchBuilder() {
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+        SubjectKeyIdentifierExtension keyIdentifier;
+        unsigned long checksum = 0;
+        Benchmark timer;
+
+        keyIdentifier.setKeyIdentifier(publicKey->getKeyIdentifier());
+        for (long i = 0; i < count; i++) {
+            CertificateBuilder builder;
+            builder.setVersion(2);
+            builder.setSerialNumber(i + 1);
+            builder.setIssuer(issuer);
+            builder.setSubject(subject);
+            builder.setPublicKey(*publicKey);
+            builder.setNotBefore(notBefore);
+            builder.setNotAfter(notAfter);
+            builder.addExtension(keyUsage);
+            builder.addExtension(basicConstraints);
+            builder.addExtension(keyIdentifier);
+            Certificate *cert = builder.sign(*privateKey, MessageDigest::SHA256);
+            checksum += cert->getDerEncoded().size();
+            delete cert;
+        }
+        Benchmark::reportRate("CertificateBuilder issuance", timer.elapsedMs(), count);
+        ASSERT_NE(checksum, 0);
+    }
+
+    /**
+     * @brief Mede a emissão com IssuanceTemplate, com os campos invariantes já codificados
+     */
+    void benchTemplate() {
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+        CertificateBuilder invariant;
+        unsigned long checksum = 0;
+
+        invariant.setIssuer(issuer);
+        invariant.addExtension(keyUsage);
+        invariant.addExtension(basicConstraints);
+        IssuanceTemplate issuance(invariant, *privateKey, MessageDigest::SHA256);
+        issuance.setSubjectKeyIdentifier(true);
+
+        Benchmark timer;
+        for (long i = 0; i < count; i++) {
+            checksum += issuance.issueDerEncoded(BigInteger(i + 1), subject, *publicKey, notBefore, notAfter).size();
+        }
+        Benchmark::reportRate("IssuanceTemplate issuance", timer.elapsedMs(), count);
+        ASSERT_NE(checksum, 0);
+    }
+
+    /**
+     * @brief Mede a emissão com IssuanceTemplate a partir de uma requisição, com a chave já codificada
+     */
+    void benchTemplateFromRequest() {
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+        std::vector<Extension *> extensions;
+        CertificateBuilder invariant;
+        CertificateRequest request;
+        unsigned long checksum = 0;
+
+        request.setSubject(subject);
+        request.setPublicKey(*publicKey);
+        request.sign(*privateKey, MessageDigest::SHA256);
+        invariant.setIssuer(issuer);
+        invariant.addExtension(keyUsage);
+        invariant.addExtension(basicConstraints);
+        IssuanceTemplate issuance(invariant, *privateKey, MessageDigest::SHA256);
+        issuance.setSubjectKeyIdentifier(true);
+
+        Benchmark timer;
+        for (long i = 0; i < count; i++) {
+            checksum += issuance.issueDerEncoded(BigInteger(i + 1), request, notBefore, notAfter, extensions).size();
+        }
+        Benchmark::reportRate("IssuanceTemplate issuance from request", timer.elapsedMs(), count);
+        ASSERT_NE(checksum, 0);
+    }
+
+    static const long count = 20000;
+    static const time_t epochBefore = 1487889918;
+    static const time_t epochAfter = 1519425918;
+    CertificateFixtures fixtures;
+    PrivateKey *privateKey;
+    PublicKey *publicKey;
+    RDNSequence issuer;
+    RDNSequence subject;
+    KeyUsageExtension keyUsage;
+    BasicConstraintsExtension basicConstraints;
+};
+
+TEST_F(IssuanceTemplateBenchmark, Builder) {
+    benchBuilder();
+}
+
+TEST_F(IssuanceTemplateBenchmark, Template) {
+    benchTemplate();
+}
+
+TEST_F(IssuanceTemplateBenchmark, TemplateFromRequest) {
+    benchTemplateFromRequest();
+}
@@ -0,0 +1,104 @@
+#include <libcryptosec/PublicKeyCache.h>
+
+#include <openssl/rsa.h>
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "CertificateFixtures.h"
+
+/**
+ * @brief Benchmarks do cache de chaves públicas
+ * Compara a obtenção da chave de um certificado já decodificado, a decodificação
+ * do SubjectPublicKeyInfo a cada uso e a consulta ao cache com os mesmos bytes.
+ */
+class PublicKeyCacheBenchmark : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, NULL);
+        EVP_PKEY *rsa = NULL;
+        EVP_PKEY_keygen_init(ctx);
+        EVP_PKEY_CTX_set_rsa_keygen_bits(ctx, 2048);
+        EVP_PKEY_keygen(ctx, &rsa);
+        EVP_PKEY_CTX_free(ctx);
+        rsaKey = encode(rsa);
+        EVP_PKEY_free(rsa);
+        ecKey = encode(fixtures.key);
+    }
+
+    static std::string encode(EVP_PKEY *key) {
+        unsigned char *der = NULL;
+        int len = i2d_PUBKEY(key, &der);
+        std::string ret((const char *) der, len);
+        OPENSSL_free(der);
+        return ret;
+    }
+
+    /**
+     * @brief Mede X509_get0_pubkey, o caminho das verificações com o certificado do emissor
+     */
+    void benchParsedCertificate() {
+        EVP_PKEY *key = NULL;
+        Benchmark timer;
+        for (int i = 0; i < iterations; i++) {
+            key = X509_get0_pubkey(fixtures.ca);
+        }
+        Benchmark::reportRate("X509_get0_pubkey, parsed certificate", timer.elapsedMs(), iterations);
+        ASSERT_TRUE(key);
+    }
+
+    /**
+     * @brief Mede a decodificação do SubjectPublicKeyInfo a cada uso
+     */
+    void benchDecode(const std::string &der, const char *name) {
+        Benchmark timer;
+        for (int i = 0; i < decodeIterations; i++) {
+            const unsigned char *p = (const unsigned char *) der.data();
+            EVP_PKEY *key = d2i_PUBKEY(NULL, &p, der.size());
+            ASSERT_TRUE(key);
+            EVP_PKEY_free(key);
+        }
+        Benchmark::reportRate(name, timer.elapsedMs(), decodeIterations);
+    }
+
+    /**
+     * @brief Mede a consulta ao cache com os mesmos bytes; só a primeira é uma falta
+     */
+    void benchCache(const std::string &der, const char *name) {
+        PublicKeyCache cache;
+        Benchmark timer;
+        for (int i = 0; i < iterations; i++) {
+            EVP_PKEY *key = cache.get((const unsigned char *) der.data(), der.size());
+            ASSERT_TRUE(key);
+            EVP_PKEY_free(key);
+        }
+        Benchmark::reportRate(name, timer.elapsedMs(), iterations);
+        ASSERT_EQ(cache.getStats().misses, 1UL);
+    }
+
+    static const int iterations = 200000;
+    static const int decodeIterations = 20000;
+    CertificateFixtures fixtures;
+    std::string rsaKey;
+    std::string ecKey;
+};
+
+TEST_F(PublicKeyCacheBenchmark, ParsedCertificate) {
+    benchParsedCertificate();
+}
+
+TEST_F(PublicKeyCacheBenchmark, DecodeRsa) {
+    benchDecode(rsaKey, "d2i_PUBKEY, RSA 2048");
+}
+
+TEST_F(PublicKeyCacheBenchmark, CacheRsa) {
+    benchCache(rsaKey, "PublicKeyCache::get, RSA 2048");
+}
+
+TEST_F(PublicKeyCacheBenchmark, DecodeEc) {
+    benchDecode(ecKey, "d2i_PUBKEY, P-256");
+}
+
+TEST_F(PublicKeyCacheBenchmark, CacheEc) {
+    benchCache(ecKey, "PublicKeyCache::get, P-256");
+}
@@ -0,0 +1,61 @@
+#include <libcryptosec/RSAKeyPair.h>
+
+#include <sstream>
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+
+/**
+ * @brief Benchmarks da latência de geração de chaves RSA
+ */
+class RSAKeyPairBenchmark : public ::testing::Test {
+
+protected:
+    /**
+     * @brief Mede a latência média da geração de chaves com os parâmetros dados
+     */
+    void benchGenerate(int length, int primes, RSAKeyPair::GenerationMode mode) {
+        std::ostringstream name;
+        Benchmark timer;
+
+        for (int i = 0; i < iterations; i++) {
+            RSAKeyPair keyPair(length, primes, mode);
+        }
+
+        name << "RSAKeyPair " << length << " bits, " << primes << " primes, "
+             << (mode == RSAKeyPair::PARALLEL ? "parallel" : "sequential");
+        Benchmark::report(name.str(), timer.elapsedMs(), iterations);
+    }
+
+    static int iterations;
+};
+
+int RSAKeyPairBenchmark::iterations = 10;
+
+TEST_F(RSAKeyPairBenchmark, Generate2048Sequential) {
+  benchGenerate(2048, 2, RSAKeyPair::SEQUENTIAL);
+}
+
+TEST_F(RSAKeyPairBenchmark, Generate2048Parallel) {
+  benchGenerate(2048, 2, RSAKeyPair::PARALLEL);
+}
+
+TEST_F(RSAKeyPairBenchmark, Generate2048ThreePrimesSequential) {
+  benchGenerate(2048, 3, RSAKeyPair::SEQUENTIAL);
+}
+
+TEST_F(RSAKeyPairBenchmark, Generate2048ThreePrimesParallel) {
+  benchGenerate(2048, 3, RSAKeyPair::PARALLEL);
+}
+
+TEST_F(RSAKeyPairBenchmark, Generate4096Sequential) {
+  benchGenerate(4096, 2, RSAKeyPair::SEQUENTIAL);
+}
+
+TEST_F(RSAKeyPairBenchmark, Generate4096Parallel) {
+  benchGenerate(4096, 2, RSAKeyPair::PARALLEL);
+}
+
+TEST_F(RSAKeyPairBenchmark, Generate4096FourPrimesParallel) {
+  benchGenerate(4096, 4, RSAKeyPair::PARALLEL);
+}
@@ -0,0 +1,359 @@
+#include <libcryptosec/certificate/BatchIssuer.h>
+#include <libcryptosec/ECDSAKeyPair.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe BatchIssuer
+ */
+class BatchIssuerTest : public ::testing::Test {
+
+protected:
+    /* hands out the requests DER encoded and counts how many were read */
+    class VectorSource : public BatchIssuer::Source {
+    public:
+        VectorSource(std::vector<CertificateRequest> &requests) : requests(requests), read(0) {}
+
+        virtual bool next(std::string &request) {
+            if (read == requests.size()) {
+                return false;
+            }
+            ByteArray der = requests[read++].getDerEncoded();
+            request.assign((const char *) der.getDataPointer(), der.size());
+            return true;
+        }
+
+        std::vector<CertificateRequest> &requests;
+        unsigned long read;
+    };
+
+    /* keeps every result, checking the order and, optionally, how far ahead the source was read */
+    class VectorSink : public BatchIssuer::Sink {
+    public:
+        VectorSink(VectorSource *source = NULL, unsigned long queueSize = 0)
+            : source(source), queueSize(queueSize), outOfOrder(false), aheadOfQueue(false), throwAt(-1) {}
+
+        virtual void write(unsigned long index, CertificateRequest *, BatchIssuer::Status status, const std::string &certificate) {
+            if ((long) index == throwAt) {
+                throw EncodeException(EncodeException::BUFFER_WRITING, "VectorSink::write");
+            }
+            if (index != statuses.size()) {
+                outOfOrder = true;
+            }
+            if (source != NULL && source->read > index + 1 + queueSize) {
+                aheadOfQueue = true;
+            }
+            statuses.push_back(status);
+            certificates.push_back(certificate);
+        }
+
+        VectorSource *source;
+        unsigned long queueSize;
+        bool outOfOrder;
+        bool aheadOfQueue;
+        long throwAt;
+        std::vector<BatchIssuer::Status> statuses;
+        std::vector<std::string> certificates;
+    };
+
+    /* refuses every request whose index is a multiple of refuseEvery */
+    class RefusingPolicy : public BatchIssuer::SequentialPolicy {
+    public:
+        RefusingPolicy(const BigInteger &first, const DateTime &notBefore, const DateTime &notAfter, unsigned long refuseEvery)
+            : BatchIssuer::SequentialPolicy(first, notBefore, notAfter), refuseEvery(refuseEvery) {}
+
+        virtual bool apply(unsigned long index, CertificateRequest &request, BatchIssuer::Issuance &issuance) {
+            BasicConstraintsExtension *basicConstraints;
+            if (index % refuseEvery == 0) {
+                return false;
+            }
+            basicConstraints = new BasicConstraintsExtension();
+            basicConstraints->setCa(false);
+            issuance.extensions.push_back(basicConstraints);
+            return BatchIssuer::SequentialPolicy::apply(index, request, issuance);
+        }
+
+        unsigned long refuseEvery;
+    };
+
+    /* takes a while per request, so that the source gets ahead of the workers */
+    class SlowPolicy : public BatchIssuer::SequentialPolicy {
+    public:
+        SlowPolicy(const BigInteger &first, const DateTime &notBefore, const DateTime &notAfter)
+            : BatchIssuer::SequentialPolicy(first, notBefore, notAfter) {}
+
+        virtual bool apply(unsigned long index, CertificateRequest &request, BatchIssuer::Issuance &issuance) {
+            usleep(2000);
+            return BatchIssuer::SequentialPolicy::apply(index, request, issuance);
+        }
+    };
+
+    /* throws for every request whose index is a multiple of throwEvery, after adding an extension */
+    class ThrowingPolicy : public BatchIssuer::SequentialPolicy {
+    public:
+        ThrowingPolicy(const BigInteger &first, const DateTime &notBefore, const DateTime &notAfter, unsigned long throwEvery)
+            : BatchIssuer::SequentialPolicy(first, notBefore, notAfter), throwEvery(throwEvery) {}
+
+        virtual bool apply(unsigned long index, CertificateRequest &request, BatchIssuer::Issuance &issuance) {
+            issuance.extensions.push_back(new BasicConstraintsExtension());
+            if (index % throwEvery == 0) {
+                throw std::runtime_error("ThrowingPolicy::apply");
+            }
+            return BatchIssuer::SequentialPolicy::apply(index, request, issuance);
+        }
+
+        unsigned long throwEvery;
+    };
+
+    virtual void SetUp() {
+        RDNSequence issuer;
+        issuer.addEntry(RDNSequence::COMMON_NAME, "Batch CA");
+        invariant.setIssuer(issuer);
+        issuance = new IssuanceTemplate(invariant, *keyPair->getPrivateKey(), MessageDigest::SHA256);
+    }
+
+    virtual void TearDown() {
+        delete issuance;
+    }
+
+    /* every badEvery-th request is signed with a key other than its own */
+    void fillRequests(std::vector<CertificateRequest> &requests, unsigned long count, unsigned long badEvery) {
+        for (unsigned long i = 0; i < count; i++) {
+            CertificateRequest request;
+            RDNSequence subject;
+            std::ostringstream name;
+            name << "Batch Subject " << i;
+            subject.addEntry(RDNSequence::COMMON_NAME, name.str());
+            request.setSubject(subject);
+            request.setPublicKey(*subjectKeyPair->getPublicKey());
+            if (badEvery > 0 && i % badEvery == badEvery - 1) {
+                request.sign(*keyPair->getPrivateKey(), MessageDigest::SHA256);
+            } else {
+                request.sign(*subjectKeyPair->getPrivateKey(), MessageDigest::SHA256);
+            }
+            requests.push_back(request);
+        }
+    }
+
+    /**
+     * @brief Tests the result of each request, delivered in order
+     */
+    void testIssue() {
+        std::vector<CertificateRequest> requests;
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+        RefusingPolicy policy(BigInteger(100L), notBefore, notAfter, 10);
+
+        fillRequests(requests, 100, 7);
+        VectorSource source(requests);
+        VectorSink sink;
+        BatchIssuer batch(*issuance, policy);
+        batch.setThreads(4);
+        BatchIssuer::Metrics metrics = batch.issue(source, sink);
+
+        ASSERT_FALSE(sink.outOfOrder);
+        ASSERT_EQ(sink.statuses.size(), requests.size());
+        ASSERT_EQ(metrics.read, requests.size());
+        ASSERT_EQ(metrics.invalidSignature, 14UL);
+        ASSERT_EQ(metrics.refused, 8UL);
+        ASSERT_EQ(metrics.failed, 0UL);
+        ASSERT_EQ(metrics.issued, 78UL);
+        ASSERT_GT(metrics.signMs, 0.0);
+        ASSERT_GT(metrics.totalMs, 0.0);
+
+        for (unsigned long i = 0; i < sink.statuses.size(); i++) {
+            if (i % 7 == 6) {
+                ASSERT_EQ(sink.statuses[i], BatchIssuer::INVALID_SIGNATURE);
+            } else if (i % 10 == 0) {
+                ASSERT_EQ(sink.statuses[i], BatchIssuer::REFUSED);
+            } else {
+                ASSERT_EQ(sink.statuses[i], BatchIssuer::ISSUED);
+                ByteArray der((const unsigned char *) sink.certificates[i].data(), sink.certificates[i].size());
+                Certificate cert(der);
+                ASSERT_TRUE(cert.verify(*keyPair->getPublicKey()));
+                ASSERT_EQ(cert.getSerialNumber(), (long) (100 + i));
+                ASSERT_EQ(cert.getSubject().getEntries(RDNSequence::COMMON_NAME)[0],
+                        requests[i].getSubject().getEntries(RDNSequence::COMMON_NAME)[0]);
+                ASSERT_EQ(cert.getExtension(Extension::BASIC_CONSTRAINTS).size(), 1);
+                ASSERT_EQ(cert.getNotAfter().getDateTime(), epochAfter);
+                continue;
+            }
+            ASSERT_TRUE(sink.certificates[i].empty());
+        }
+    }
+
+    /**
+     * @brief Tests reading PEM requests from a stream and writing PEM certificates to another
+     */
+    void testStreams() {
+        std::vector<CertificateRequest> requests;
+        std::ostringstream pem;
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+        BatchIssuer::SequentialPolicy policy(BigInteger(1L), notBefore, notAfter);
+
+        fillRequests(requests, 20, 0);
+        for (unsigned long i = 0; i < requests.size(); i++) {
+            pem << requests[i].getPemEncoded();
+        }
+        std::istringstream in(pem.str());
+        std::ostringstream out;
+        BatchIssuer::StreamSource source(in);
+        BatchIssuer::StreamSink sink(out);
+        BatchIssuer batch(*issuance, policy);
+        batch.setFormat(BatchIssuer::PEM);
+        BatchIssuer::Metrics metrics = batch.issue(source, sink);
+
+        ASSERT_EQ(metrics.issued, requests.size());
+        ASSERT_EQ(sink.getRejected(), 0UL);
+        ASSERT_GT(metrics.decodeMs, 0.0);
+
+        std::string certificates = out.str();
+        std::string::size_type begin = 0, end;
+        for (unsigned long i = 0; i < requests.size(); i++) {
+            end = certificates.find("-----END CERTIFICATE-----\n", begin);
+            ASSERT_NE(end, std::string::npos);
+            end += 26;
+            std::string block = certificates.substr(begin, end - begin);
+            Certificate cert(block);
+            ASSERT_TRUE(cert.verify(*keyPair->getPublicKey()));
+            ASSERT_EQ(cert.getSerialNumber(), (long) (1 + i));
+            begin = end;
+        }
+        ASSERT_EQ(begin, certificates.size());
+    }
+
+    /**
+     * @brief Tests that requests that cannot be decoded are reported without stopping the batch
+     */
+    void testInvalidRequest() {
+        std::vector<CertificateRequest> requests;
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+        BatchIssuer::SequentialPolicy policy(BigInteger(1L), notBefore, notAfter);
+        std::string pem;
+
+        fillRequests(requests, 3, 0);
+        pem = requests[0].getPemEncoded();
+        pem += "-----BEGIN CERTIFICATE REQUEST-----\nAAAA\n-----END CERTIFICATE REQUEST-----\n";
+        pem += requests[1].getPemEncoded();
+        std::istringstream in(pem);
+        std::ostringstream out;
+        BatchIssuer::StreamSource source(in);
+        BatchIssuer::StreamSink sink(out);
+        BatchIssuer batch(*issuance, policy);
+        BatchIssuer::Metrics metrics = batch.issue(source, sink);
+
+        ASSERT_EQ(metrics.read, 3UL);
+        ASSERT_EQ(metrics.issued, 2UL);
+        ASSERT_EQ(metrics.invalidRequest, 1UL);
+        ASSERT_EQ(sink.getRejected(), 1UL);
+
+        /* a stream that ends inside a request */
+        std::istringstream truncated(requests[2].getPemEncoded().substr(0, 100));
+        BatchIssuer::StreamSource truncatedSource(truncated);
+        ASSERT_THROW(batch.issue(truncatedSource, sink), EncodeException);
+    }
+
+    /**
+     * @brief Tests that the source is not read further than the queue size ahead of the sink
+     */
+    void testBackpressure() {
+        std::vector<CertificateRequest> requests;
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+        SlowPolicy policy(BigInteger(1L), notBefore, notAfter);
+
+        fillRequests(requests, 60, 0);
+        VectorSource source(requests);
+        VectorSink sink(&source, 3);
+        BatchIssuer batch(*issuance, policy);
+        batch.setThreads(2);
+        batch.setQueueSize(3);
+        BatchIssuer::Metrics metrics = batch.issue(source, sink);
+
+        ASSERT_FALSE(sink.aheadOfQueue);
+        ASSERT_EQ(metrics.issued, requests.size());
+        ASSERT_GT(metrics.stalls, 0UL);
+        /* one per blocking episode, and each episode ends with a read */
+        ASSERT_LE(metrics.stalls, metrics.read);
+    }
+
+    /**
+     * @brief Tests that an exception thrown by the sink stops the batch and reaches the caller
+     */
+    void testSinkException() {
+        std::vector<CertificateRequest> requests;
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+        BatchIssuer::SequentialPolicy policy(BigInteger(1L), notBefore, notAfter);
+
+        fillRequests(requests, 40, 0);
+        VectorSource source(requests);
+        VectorSink sink;
+        sink.throwAt = 5;
+        BatchIssuer batch(*issuance, policy);
+        batch.setThreads(3);
+        ASSERT_THROW(batch.issue(source, sink), EncodeException);
+        ASSERT_EQ(sink.statuses.size(), 5UL);
+        ASSERT_LT(source.read, requests.size());
+    }
+
+    /**
+     * @brief Tests that an exception thrown while processing a request fails only that request
+     */
+    void testPolicyException() {
+        std::vector<CertificateRequest> requests;
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+        ThrowingPolicy policy(BigInteger(1L), notBefore, notAfter, 4);
+
+        fillRequests(requests, 20, 0);
+        VectorSource source(requests);
+        VectorSink sink;
+        BatchIssuer batch(*issuance, policy);
+        batch.setThreads(3);
+        BatchIssuer::Metrics metrics = batch.issue(source, sink);
+
+        ASSERT_EQ(metrics.failed, 5UL);
+        ASSERT_EQ(metrics.issued, 15UL);
+        for (unsigned long i = 0; i < sink.statuses.size(); i++) {
+            ASSERT_EQ(sink.statuses[i], (i % 4 == 0) ? BatchIssuer::FAILED : BatchIssuer::ISSUED);
+            ASSERT_EQ(sink.certificates[i].empty(), i % 4 == 0);
+        }
+    }
+
+    static ECDSAKeyPair *keyPair;
+    static ECDSAKeyPair *subjectKeyPair;
+    static const time_t epochBefore = 1487889918;
+    static const time_t epochAfter = 1519425918;
+
+    CertificateBuilder invariant;
+    IssuanceTemplate *issuance;
+};
+
+ECDSAKeyPair* BatchIssuerTest::keyPair = new ECDSAKeyPair(AsymmetricKey::X962_PRIME256V1);
+ECDSAKeyPair* BatchIssuerTest::subjectKeyPair = new ECDSAKeyPair(AsymmetricKey::X962_PRIME256V1);
+const time_t BatchIssuerTest::epochBefore;
+const time_t BatchIssuerTest::epochAfter;
+
+TEST_F(BatchIssuerTest, Issue) {
+    testIssue();
+}
+
+TEST_F(BatchIssuerTest, Streams) {
+    testStreams();
+}
+
+TEST_F(BatchIssuerTest, InvalidRequest) {
+    testInvalidRequest();
+}
+
+TEST_F(BatchIssuerTest, Backpressure) {
+    testBackpressure();
+}
+
+TEST_F(BatchIssuerTest, SinkException) {
+    testSinkException();
+}
+
+TEST_F(BatchIssuerTest, PolicyException) {
+    testPolicyException();
+}
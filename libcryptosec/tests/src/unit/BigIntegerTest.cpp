@@ -1,8 +1,11 @@
 #include <libcryptosec/BigInteger.h>
 
+#include <climits>
 #include <sstream>
+#include <thread>
 #include <gtest/gtest.h>
 #include <utility>
+#include <vector>
 
 
 /**
@@ -466,6 +469,99 @@ protected:
         ASSERT_TRUE(pair.first != pair.second);
     }
 
+    /**
+     * @brief Testa se as operações com long dão o mesmo resultado que as operações com BigInteger
+     */
+    void testLongOperations() {
+        long values[] = {0, 1, -1, 7, -7, 86400, -86400, longValue, longValueNeg, LONG_MAX, LONG_MIN};
+        unsigned int count = sizeof(values) / sizeof(values[0]);
+        BigInteger big;
+
+        big.setDecValue("-340282366920938463463374607431768211457");
+        for (unsigned int i = 0; i < count + 1; i++) {
+            BigInteger a = (i < count) ? BigInteger(values[i]) : big;
+            for (unsigned int j = 0; j < count; j++) {
+                BigInteger b(values[j]);
+                BigInteger expected, result;
+
+                expected = a;
+                expected.add(b);
+                result = a;
+                ASSERT_EQ(result.add(values[j]), expected);
+                expected = a;
+                expected.sub(b);
+                result = a;
+                ASSERT_EQ(result.sub(values[j]), expected);
+                expected = a;
+                expected.mul(b);
+                result = a;
+                ASSERT_EQ(result.mul(values[j]), expected);
+                if (values[j] != 0) {
+                    expected = a;
+                    expected.div(b);
+                    result = a;
+                    ASSERT_EQ(result.div(values[j]), expected) << a.toDec() << " / " << values[j];
+                    expected = a;
+                    expected.mod(b);
+                    result = a;
+                    ASSERT_EQ(result.mod(values[j]), expected) << a.toDec() << " % " << values[j];
+                }
+                ASSERT_EQ(a.compare(values[j]), a.compare(b)) << a.toDec() << " <=> " << values[j];
+            }
+        }
+    }
+
+    /**
+     * @brief Testa a divisão por zero com long
+     */
+    void testDivisionByZero() {
+        BigInteger value(longValue);
+
+        ASSERT_THROW(value.div(0L), BigIntegerException);
+        ASSERT_THROW(value.mod(0L), BigIntegerException);
+        ASSERT_THROW(value.div(BigInteger()), BigIntegerException);
+        ASSERT_THROW(value.mod(BigInteger()), BigIntegerException);
+        ASSERT_EQ(value, longValue);
+    }
+
+    /**
+     * @brief Testa se swap troca os valores
+     */
+    void testSwap() {
+        BigInteger a(longValue);
+        BigInteger b(longValueNeg);
+        const BIGNUM *bn = a.getBIGNUM();
+
+        a.swap(b);
+        ASSERT_EQ(a, longValueNeg);
+        ASSERT_EQ(b, longValue);
+        ASSERT_EQ(b.getBIGNUM(), bn);
+    }
+
+    /**
+     * @brief Testa multiplicações e divisões em várias threads, cada uma com o seu BN_CTX
+     */
+    void testThreads() {
+        std::vector<std::thread> threads;
+        std::vector<int> failures(4, 0);
+
+        for (int i = 0; i < 4; i++) {
+            threads.push_back(std::thread([&failures, i]() {
+                for (long j = 1; j < 2000; j++) {
+                    BigInteger value(longValue);
+                    value.mul(BigInteger(j + i)).div(BigInteger(j + i));
+                    if (value != longValue || (value % BigInteger(j)) != longValue % j) {
+                        failures[i]++;
+                    }
+                }
+            }));
+        }
+        for (unsigned int i = 0; i < threads.size(); i++) {
+            threads[i].join();
+            ASSERT_EQ(failures[i], 0);
+        }
+    }
+
 
     static long longValue;
     static long longValueNeg;
@@ -666,3 +762,19 @@ TEST_F(BigIntegerTest, ByteArrayConstructor) {
     auto pair = CreatePairFromByteArray();
     testGeneric(pair);
 }
+
+TEST_F(BigIntegerTest, LongOperations) {
+    testLongOperations();
+}
+
+TEST_F(BigIntegerTest, DivisionByZero) {
+    testDivisionByZero();
+}
+
+TEST_F(BigIntegerTest, Swap) {
+    testSwap();
+}
+
+TEST_F(BigIntegerTest, Threads) {
+    testThreads();
+}
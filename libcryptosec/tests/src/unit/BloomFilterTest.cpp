@@ -0,0 +1,93 @@
+#include <libcryptosec/BloomFilter.h>
+
+#include <string>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe BloomFilter
+ */
+class BloomFilterTest : public ::testing::Test {
+
+protected:
+    static unsigned long long hashOf(unsigned long value) {
+        std::string data = std::to_string(value);
+        return BloomFilter::hash((const unsigned char *) data.data(), data.size());
+    }
+
+    /**
+     * @brief Tests the size and number of hashes chosen for a false positive rate
+     */
+    void testSizing() {
+        BloomFilter filter(10000, 0.01);
+
+        /* about 9.6 bits and 7 hashes per entry */
+        ASSERT_GE(filter.getSizeBits(), 95000UL);
+        ASSERT_LE(filter.getSizeBits(), 97000UL);
+        ASSERT_EQ(filter.getSizeBits() % 8, 0UL);
+        ASSERT_EQ(filter.getHashCount(), 7U);
+        ASSERT_NEAR(filter.getFalsePositiveRate(), 0.01, 0.001);
+
+        BloomFilter limited(10000, 0.01, 40000);
+        ASSERT_EQ(limited.getSizeBits(), 40000UL);
+        ASSERT_EQ(limited.getHashCount(), 3U);
+        ASSERT_GT(limited.getFalsePositiveRate(), 0.05);
+
+        BloomFilter empty(0, 0.01);
+        ASSERT_EQ(empty.getSizeBits(), 64UL);
+        ASSERT_FALSE(empty.mightContain(hashOf(1)));
+    }
+
+    /**
+     * @brief Tests that added values are always found and that the false positive rate is close to the expected one
+     */
+    void testLookups() {
+        BloomFilter filter(entries, 0.01);
+        unsigned long falsePositives = 0;
+
+        for (unsigned long i = 0; i < entries; i++) {
+            filter.add(hashOf(i));
+        }
+        for (unsigned long i = 0; i < entries; i++) {
+            ASSERT_TRUE(filter.mightContain(hashOf(i)));
+        }
+        for (unsigned long i = entries; i < entries * 11; i++) {
+            if (filter.mightContain(hashOf(i))) {
+                falsePositives++;
+            }
+        }
+        ASSERT_LT(falsePositives, entries * 10 / 50);
+
+        ASSERT_EQ(filter.getLookups(), entries * 11);
+        ASSERT_EQ(filter.getRejections(), entries * 10 - falsePositives);
+    }
+
+    /**
+     * @brief Tests the functions used with filters stored outside the object
+     */
+    void testExternalBits() {
+        unsigned char bits[128] = { 0 };
+
+        BloomFilter::set(bits, sizeof(bits) * 8, 5, hashOf(42));
+        ASSERT_TRUE(BloomFilter::test(bits, sizeof(bits) * 8, 5, hashOf(42)));
+        ASSERT_FALSE(BloomFilter::test(bits, sizeof(bits) * 8, 5, hashOf(43)));
+        /* FNV-1a test vectors */
+        ASSERT_EQ(BloomFilter::hash((const unsigned char *) "", 0), 0xcbf29ce484222325ULL);
+        ASSERT_EQ(BloomFilter::hash((const unsigned char *) "a", 1), 0xaf63dc4c8601ec8cULL);
+    }
+
+    static const unsigned long entries = 10000;
+};
+
+const unsigned long BloomFilterTest::entries;
+
+TEST_F(BloomFilterTest, Sizing) {
+    testSizing();
+}
+
+TEST_F(BloomFilterTest, Lookups) {
+    testLookups();
+}
+
+TEST_F(BloomFilterTest, ExternalBits) {
+    testExternalBits();
+}
@@ -11,9 +11,11 @@ class BrainpoolCurveFactoryTest : public ::testing::Test {
 
 protected:
     virtual void SetUp() {
+      curve = NULL;
     }
 
     virtual void TearDown() {
+      delete curve;
     }
 
     void chooseCurve(BrainpoolCurveFactory::CurveName curveName) {
@@ -198,3 +200,13 @@ TEST_F(BrainpoolCurveFactoryTest, BP512t1) {
   testCurve(BrainpoolCurveFactoryTest::bp512t1);
 }
 
+
+TEST_F(BrainpoolCurveFactoryTest, SharedInstance) {
+  const EllipticCurve *shared = BrainpoolCurveFactory::getSharedCurve(BrainpoolCurveFactory::BP256r1);
+  chooseCurve(BrainpoolCurveFactory::BP256r1);
+  ASSERT_NE(curve, shared);
+  ASSERT_EQ(curve->getP(), shared->getP());
+  ASSERT_EQ(shared, BrainpoolCurveFactory::getSharedCurve(BrainpoolCurveFactory::BP256r1));
+  ASSERT_EQ(BrainpoolCurveFactory::getGroup(BrainpoolCurveFactory::BP256r1),
+            BrainpoolCurveFactory::getGroup(BrainpoolCurveFactory::BP256r1));
+}
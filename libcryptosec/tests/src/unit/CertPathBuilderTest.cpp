@@ -0,0 +1,249 @@
+#include <libcryptosec/certificate/CertPathBuilder.h>
+#include <libcryptosec/certificate/CertPathValidator.h>
+
+#include <openssl/ec.h>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe CertPathBuilder
+ */
+class CertPathBuilderTest : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+      rootKey = newKey();
+      otherRootKey = newKey();
+      intermediateKey = newKey();
+      leafKey = newKey();
+      root = new Certificate(issue("Root", NULL, rootKey, rootKey, 1, true));
+      otherRoot = new Certificate(issue("Other Root", NULL, otherRootKey, otherRootKey, 2, true));
+      intermediate = new Certificate(issue("Intermediate", root->getX509(), intermediateKey, rootKey, 3, true));
+      leaf = new Certificate(issue("Leaf", intermediate->getX509(), leafKey, intermediateKey, 4, false));
+    }
+
+    virtual void TearDown() {
+      delete root;
+      delete otherRoot;
+      delete intermediate;
+      delete leaf;
+      EVP_PKEY_free(rootKey);
+      EVP_PKEY_free(otherRootKey);
+      EVP_PKEY_free(intermediateKey);
+      EVP_PKEY_free(leafKey);
+    }
+
+    X509 *issue(std::string subject, X509 *issuer, EVP_PKEY *subjectKey, EVP_PKEY *issuerKey, long serial, bool ca,
+        long notBefore = -3600, long notAfter = 3600, const char *keyUsage = NULL) {
+      X509 *cert = X509_new();
+      X509V3_CTX ctx;
+      X509_EXTENSION *ext;
+
+      X509_set_version(cert, 2);
+      ASN1_INTEGER_set(X509_get_serialNumber(cert), serial);
+      X509_NAME_add_entry_by_txt(X509_get_subject_name(cert), "CN", MBSTRING_ASC, (const unsigned char *) subject.c_str(), -1, -1, 0);
+      X509_set_issuer_name(cert, issuer ? X509_get_subject_name(issuer) : X509_get_subject_name(cert));
+      X509_gmtime_adj(X509_getm_notBefore(cert), notBefore);
+      X509_gmtime_adj(X509_getm_notAfter(cert), notAfter);
+      X509_set_pubkey(cert, subjectKey);
+      X509V3_set_ctx(&ctx, issuer ? issuer : cert, cert, NULL, NULL, 0);
+      ext = X509V3_EXT_conf_nid(NULL, &ctx, NID_subject_key_identifier, (char *) "hash");
+      X509_add_ext(cert, ext, -1);
+      X509_EXTENSION_free(ext);
+      if (issuer) {
+        ext = X509V3_EXT_conf_nid(NULL, &ctx, NID_authority_key_identifier, (char *) "keyid:always");
+        X509_add_ext(cert, ext, -1);
+        X509_EXTENSION_free(ext);
+      }
+      ext = X509V3_EXT_conf_nid(NULL, &ctx, NID_basic_constraints, ca ? (char *) "critical,CA:TRUE" : (char *) "critical,CA:FALSE");
+      X509_add_ext(cert, ext, -1);
+      X509_EXTENSION_free(ext);
+      if (keyUsage) {
+        ext = X509V3_EXT_conf_nid(NULL, &ctx, NID_key_usage, (char *) keyUsage);
+        X509_add_ext(cert, ext, -1);
+        X509_EXTENSION_free(ext);
+      }
+      X509_sign(cert, issuerKey, EVP_sha256());
+      return cert;
+    }
+
+    EVP_PKEY *newKey() {
+      EVP_PKEY *key = EVP_PKEY_new();
+      EC_KEY *eckey = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+      EC_KEY_generate_key(eckey);
+      EVP_PKEY_assign_EC_KEY(key, eckey);
+      return key;
+    }
+
+    /**
+     * @brief Finds the path through an intermediate mixed with unrelated certificates, and validates it
+     */
+    void testSimplePath() {
+      std::vector<Certificate> pool, trusted, path, untrustedChain;
+      EVP_PKEY *key = newKey();
+
+      pool.push_back(Certificate(issue("Unrelated", otherRoot->getX509(), key, otherRootKey, 10, true)));
+      pool.push_back(*intermediate);
+      trusted.push_back(*otherRoot);
+      trusted.push_back(*root);
+
+      CertPathBuilder builder(pool, trusted);
+      ASSERT_TRUE(builder.build(*leaf, path));
+      ASSERT_EQ(path.size(), 3);
+      ASSERT_TRUE(path[0] == *leaf);
+      ASSERT_TRUE(path[1] == *intermediate);
+      ASSERT_TRUE(path[2] == *root);
+      ASSERT_EQ(builder.getCost().expansions, 2);
+
+      untrustedChain.push_back(path[1]);
+      CertPathValidator validator(*leaf, untrustedChain, trusted);
+      ASSERT_TRUE(validator.verify());
+
+      EVP_PKEY_free(key);
+    }
+
+    /**
+     * @brief Finds a path that goes through a cross certificate to another root
+     */
+    void testCrossCertificate() {
+      std::vector<Certificate> pool, trusted, path;
+      EVP_PKEY *bridgeKey = newKey();
+      X509 *bridge = issue("Bridge", NULL, bridgeKey, bridgeKey, 20, true);
+      Certificate bridgeIntermediate(issue("Intermediate", bridge, intermediateKey, bridgeKey, 21, true));
+      Certificate cross(issue("Bridge", otherRoot->getX509(), bridgeKey, otherRootKey, 22, true));
+
+      pool.push_back(bridgeIntermediate);
+      pool.push_back(cross);
+      trusted.push_back(*otherRoot);
+
+      CertPathBuilder builder(pool, trusted);
+      ASSERT_TRUE(builder.build(*leaf, path));
+      ASSERT_EQ(path.size(), 4);
+      ASSERT_TRUE(path[1] == bridgeIntermediate);
+      ASSERT_TRUE(path[2] == cross);
+      ASSERT_TRUE(path[3] == *otherRoot);
+
+      X509_free(bridge);
+      EVP_PKEY_free(bridgeKey);
+    }
+
+    /**
+     * @brief Prefers the shorter of two paths to trusted roots
+     */
+    void testShortestPath() {
+      std::vector<Certificate> pool, trusted, path;
+      Certificate cross(issue("Root", otherRoot->getX509(), rootKey, otherRootKey, 30, true));
+
+      pool.push_back(cross);
+      pool.push_back(*intermediate);
+      trusted.push_back(*otherRoot);
+      trusted.push_back(*root);
+
+      CertPathBuilder builder(pool, trusted);
+      ASSERT_TRUE(builder.build(*leaf, path));
+      ASSERT_EQ(path.size(), 3);
+      ASSERT_TRUE(path[2] == *root);
+    }
+
+    /**
+     * @brief Skips issuers that are expired, lack keyCertSign or fail the signature check
+     */
+    void testPruning() {
+      std::vector<Certificate> pool, trusted, path;
+      EVP_PKEY *wrongKey = newKey();
+      Certificate forged(issue("Leaf", intermediate->getX509(), leafKey, wrongKey, 42, false));
+
+      pool.push_back(Certificate(issue("Intermediate", root->getX509(), intermediateKey, rootKey, 40, true, -7200, -3600)));
+      pool.push_back(Certificate(issue("Intermediate", root->getX509(), intermediateKey, rootKey, 41, true, -3600, 3600, "digitalSignature")));
+      trusted.push_back(*root);
+
+      CertPathBuilder builder(pool, trusted);
+      ASSERT_FALSE(builder.build(*leaf, path));
+      ASSERT_EQ(path.size(), 0);
+      ASSERT_EQ(builder.getCost().candidates, 2);
+      ASSERT_EQ(builder.getCost().pruned, 2);
+      ASSERT_EQ(builder.getCost().signatureChecks, 0);
+
+      pool.push_back(*intermediate);
+      CertPathBuilder other(pool, trusted);
+      ASSERT_TRUE(other.build(*leaf, path));
+      ASSERT_TRUE(path[1] == *intermediate);
+
+      ASSERT_FALSE(other.build(forged, path));
+      ASSERT_EQ(other.getCost().signatureChecks, 1);
+      ASSERT_EQ(other.getCost().pruned, 3);
+
+      EVP_PKEY_free(wrongKey);
+    }
+
+    /**
+     * @brief Checks that the search stops at the expansion limit
+     */
+    void testExpansionLimit() {
+      std::vector<Certificate> pool, trusted, path;
+
+      pool.push_back(*intermediate);
+      trusted.push_back(*root);
+
+      CertPathBuilder builder(pool, trusted);
+      builder.setMaxExpansions(1);
+      ASSERT_FALSE(builder.build(*leaf, path));
+      ASSERT_EQ(builder.getCost().expansions, 1);
+
+      builder.setMaxExpansions(1000);
+      builder.setMaxDepth(2);
+      ASSERT_FALSE(builder.build(*leaf, path));
+    }
+
+    /**
+     * @brief Finds the root in a CertificateStore
+     */
+    void testTrustedStore() {
+      std::vector<Certificate> pool, path;
+      CertificateStore store;
+
+      store.addCertificate(*otherRoot);
+      store.addCertificate(*root);
+      pool.push_back(*intermediate);
+
+      CertPathBuilder builder(pool, store);
+      ASSERT_TRUE(builder.build(*leaf, path));
+      ASSERT_EQ(path.size(), 3);
+      ASSERT_TRUE(path[2] == *root);
+
+      ASSERT_TRUE(builder.build(*root, path));
+      ASSERT_EQ(path.size(), 1);
+    }
+
+    EVP_PKEY *rootKey;
+    EVP_PKEY *otherRootKey;
+    EVP_PKEY *intermediateKey;
+    EVP_PKEY *leafKey;
+    Certificate *root;
+    Certificate *otherRoot;
+    Certificate *intermediate;
+    Certificate *leaf;
+};
+
+TEST_F(CertPathBuilderTest, SimplePath) {
+  testSimplePath();
+}
+
+TEST_F(CertPathBuilderTest, CrossCertificate) {
+  testCrossCertificate();
+}
+
+TEST_F(CertPathBuilderTest, ShortestPath) {
+  testShortestPath();
+}
+
+TEST_F(CertPathBuilderTest, Pruning) {
+  testPruning();
+}
+
+TEST_F(CertPathBuilderTest, ExpansionLimit) {
+  testExpansionLimit();
+}
+
+TEST_F(CertPathBuilderTest, TrustedStore) {
+  testTrustedStore();
+}
@@ -0,0 +1,130 @@
+#include <libcryptosec/certificate/CertPathValidatorCache.h>
+
+#include <vector>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe CertPathValidatorCache
+ */
+class CertPathValidatorCacheTest : public ::testing::Test {
+
+protected:
+    /**
+     * @brief Builds a key whose first bytes select the shard, as the validator's digests do
+     */
+    static std::string key(unsigned char id) {
+      return std::string(32, (char) id);
+    }
+
+    /**
+     * @brief Tests that a stored result is found only inside its validity interval
+     */
+    void testFindInsideInterval() {
+      CertPathValidatorCache cache(16, 4);
+      std::vector<CertPathValidatorResult> results, found;
+      CertPathValidatorResult warning;
+      bool valid = false;
+
+      warning.setErrorCode(CertPathValidatorResult::INVALID_PURPOSE);
+      results.push_back(warning);
+      cache.insert(key(1), 1000, 2000, true, results);
+
+      ASSERT_FALSE(cache.find(key(1), 999, valid, found));
+      ASSERT_TRUE(cache.find(key(1), 1000, valid, found));
+      ASSERT_TRUE(valid);
+      ASSERT_EQ(found.size(), 1);
+      ASSERT_EQ(found[0].getErrorCode(), CertPathValidatorResult::INVALID_PURPOSE);
+      ASSERT_FALSE(cache.find(key(2), 1500, valid, found));
+
+      CertPathValidatorCache::Stats stats = cache.getStats();
+      ASSERT_EQ(stats.hits, 1);
+      ASSERT_EQ(stats.misses, 2);
+      ASSERT_EQ(stats.size, 1);
+      ASSERT_DOUBLE_EQ(cache.getHitRate(), 1.0 / 3);
+    }
+
+    /**
+     * @brief Tests that an entry is dropped once the validation time passes its end
+     */
+    void testExpiration() {
+      CertPathValidatorCache cache(16, 4);
+      std::vector<CertPathValidatorResult> results;
+      bool valid;
+
+      cache.insert(key(1), 1000, 2000, false, results);
+      ASSERT_FALSE(cache.find(key(1), 2000, valid, results));
+
+      CertPathValidatorCache::Stats stats = cache.getStats();
+      ASSERT_EQ(stats.expirations, 1);
+      ASSERT_EQ(stats.size, 0);
+    }
+
+    /**
+     * @brief Tests that empty intervals are not stored
+     */
+    void testEmptyInterval() {
+      CertPathValidatorCache cache(16, 4);
+      std::vector<CertPathValidatorResult> results;
+
+      cache.insert(key(1), 2000, 1000, true, results);
+      ASSERT_EQ(cache.getStats().size, 0);
+    }
+
+    /**
+     * @brief Tests that the least recently used entry is evicted when a shard is full
+     */
+    void testEviction() {
+      CertPathValidatorCache cache(2, 1);
+      std::vector<CertPathValidatorResult> results;
+      bool valid;
+
+      cache.insert(key(1), 0, 10, true, results);
+      cache.insert(key(2), 0, 10, true, results);
+      ASSERT_TRUE(cache.find(key(1), 5, valid, results));
+      cache.insert(key(3), 0, 10, true, results);
+
+      ASSERT_TRUE(cache.find(key(1), 5, valid, results));
+      ASSERT_FALSE(cache.find(key(2), 5, valid, results));
+      ASSERT_TRUE(cache.find(key(3), 5, valid, results));
+      ASSERT_EQ(cache.getStats().evictions, 1);
+      ASSERT_EQ(cache.getCapacity(), 2);
+    }
+
+    /**
+     * @brief Tests that clear removes the entries and resets the statistics
+     */
+    void testClear() {
+      CertPathValidatorCache cache;
+      std::vector<CertPathValidatorResult> results;
+      bool valid;
+
+      cache.insert(key(1), 0, 10, true, results);
+      ASSERT_TRUE(cache.find(key(1), 5, valid, results));
+      cache.clear();
+
+      CertPathValidatorCache::Stats stats = cache.getStats();
+      ASSERT_EQ(stats.hits, 0);
+      ASSERT_EQ(stats.size, 0);
+      ASSERT_FALSE(cache.find(key(1), 5, valid, results));
+    }
+};
+
+TEST_F(CertPathValidatorCacheTest, FindInsideInterval) {
+  testFindInsideInterval();
+}
+
+TEST_F(CertPathValidatorCacheTest, Expiration) {
+  testExpiration();
+}
+
+TEST_F(CertPathValidatorCacheTest, EmptyInterval) {
+  testEmptyInterval();
+}
+
+TEST_F(CertPathValidatorCacheTest, Eviction) {
+  testEviction();
+}
+
+TEST_F(CertPathValidatorCacheTest, Clear) {
+  testClear();
+}
@@ -1,6 +1,8 @@
 #include <libcryptosec/certificate/CertPathValidator.h>
 
 #include <sstream>
+#include <atomic>
+#include <thread>
 #include <gtest/gtest.h>
 #include <stdlib.h>
 
@@ -124,6 +126,212 @@ protected:
       ASSERT_EQ(validator.verify(), false);
     }
 
+    /**
+    * @brief Given a trusted store with the root CA, checks if validCert is valid
+    */
+    void testValidPathTrustedStore() {
+      vector<Certificate> untrustedChain;
+      CertificateStore store;
+
+      store.addCertificate(*untrustedIntermediateCa);
+      store.addCertificate(*trustedCa);
+      untrustedChain.push_back(*trustedIntermediateCa);
+
+      CertPathValidator validator(*validCert, untrustedChain, store);
+
+      ASSERT_EQ(validator.verify(), true);
+    }
+
+    /**
+    * @brief Given a trusted store with the whole path, checks if validCert is valid without an untrusted chain
+    */
+    void testTrustedStoreWithIntermediate() {
+      vector<Certificate> untrustedChain;
+      CertificateStore store;
+
+      store.addCertificate(*trustedCa);
+      store.addCertificate(*trustedIntermediateCa);
+
+      CertPathValidator validator(*validCert, untrustedChain, store);
+
+      ASSERT_EQ(validator.verify(), true);
+    }
+
+    /**
+    * @brief Given a trusted store without the root CA, checks if validCert is invalid
+    */
+    void testTrustedStoreMissingRoot() {
+      vector<Certificate> untrustedChain;
+      CertificateStore store;
+
+      store.addCertificate(*untrustedIntermediateCa);
+      untrustedChain.push_back(*trustedIntermediateCa);
+
+      CertPathValidator validator(*validCert, untrustedChain, store);
+
+      ASSERT_EQ(validator.verify(), false);
+    }
+
+    /**
+    * @brief Checks that a validator gives the same answers when reused and that setters take effect
+    */
+    void testReuse() {
+      vector<Certificate> trustedChain, untrustedChain;
+      vector<CertificateRevocationList> crls;
+      vector<CertPathValidatorResult> results;
+
+      trustedChain.push_back(*trustedCa);
+      untrustedChain.push_back(*trustedIntermediateCa);
+      crls.push_back(*intermediateCaCrl);
+
+      CertPathValidator validator(*validCert, untrustedChain, trustedChain, DateTime(time(NULL)), crls);
+
+      for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(validator.verify());
+        ASSERT_FALSE(validator.verify(*invalidCert, results));
+        ASSERT_EQ(results.size(), 1);
+        ASSERT_TRUE(validator.verify(*validCert, results));
+        ASSERT_EQ(results.size(), 0);
+      }
+
+      validator.setVerificationFlags(ValidationFlags::CRL_CHECK);
+      ASSERT_FALSE(validator.verify());
+      ASSERT_EQ(validator.getResults().at(0).getErrorCode(), CertPathValidatorResult::CERT_REVOKED);
+
+      vector<CertificateRevocationList> noCrls;
+      validator.setCrls(noCrls);
+      ASSERT_FALSE(validator.verify());
+      ASSERT_EQ(validator.getResults().at(0).getErrorCode(), CertPathValidatorResult::UNABLE_TO_GET_CRL);
+
+      CertPathValidator copy(validator);
+      ASSERT_FALSE(copy.verify());
+    }
+
+    /**
+    * @brief Checks validations running concurrently on the same validator
+    */
+    void testConcurrentVerify() {
+      vector<Certificate> trustedChain, untrustedChain;
+      std::vector<std::thread> workers;
+      std::atomic<int> failures(0);
+
+      trustedChain.push_back(*trustedCa);
+      untrustedChain.push_back(*trustedIntermediateCa);
+
+      CertPathValidator validator(*validCert, untrustedChain, trustedChain);
+
+      for (int i = 0; i < 4; i++) {
+        workers.push_back(std::thread([&validator, &failures, i, this]() {
+          vector<CertPathValidatorResult> results;
+          for (int j = 0; j < 50; j++) {
+            Certificate *cert = (i + j) % 2 ? this->validCert : this->invalidCert;
+            bool valid = validator.verify(*cert, results);
+            if (valid != (cert == this->validCert) || results.size() != (valid ? 0 : 1)) {
+              failures++;
+            }
+          }
+        }));
+      }
+      for (unsigned int i = 0; i < workers.size(); i++) {
+        workers[i].join();
+      }
+
+      ASSERT_EQ(failures.load(), 0);
+    }
+
+    /**
+    * @brief Checks that repeated validations are answered by the cache and that configuration changes miss it
+    */
+    void testCache() {
+      vector<Certificate> trustedChain, untrustedChain;
+      vector<CertificateRevocationList> crls;
+      vector<CertPathValidatorResult> results;
+      CertPathValidatorCache cache;
+
+      trustedChain.push_back(*trustedCa);
+      untrustedChain.push_back(*trustedIntermediateCa);
+      crls.push_back(*intermediateCaCrl);
+
+      CertPathValidator validator(*validCert, untrustedChain, trustedChain, DateTime(time(NULL)), crls);
+      validator.setCache(cache);
+
+      ASSERT_TRUE(validator.verify());
+      ASSERT_TRUE(validator.verify());
+      ASSERT_FALSE(validator.verify(*invalidCert, results));
+      ASSERT_FALSE(validator.verify(*invalidCert, results));
+      ASSERT_EQ(results.size(), 1);
+      ASSERT_EQ(cache.getStats().hits, 2);
+      ASSERT_EQ(cache.getStats().misses, 2);
+
+      // an independent validator with the same configuration shares the entries
+      CertPathValidator other(*validCert, untrustedChain, trustedChain, DateTime(time(NULL)), crls);
+      other.setCache(cache);
+      ASSERT_TRUE(other.verify());
+      ASSERT_EQ(cache.getStats().hits, 3);
+
+      // a new flag changes the configuration, so the revocation is seen
+      validator.setVerificationFlags(ValidationFlags::CRL_CHECK);
+      ASSERT_FALSE(validator.verify());
+      ASSERT_EQ(validator.getResults().at(0).getErrorCode(), CertPathValidatorResult::CERT_REVOKED);
+      // the CRL's lastUpdate is in the future, so the result is not kept
+      ASSERT_FALSE(validator.verify());
+      ASSERT_EQ(validator.getResults().at(0).getErrorCode(), CertPathValidatorResult::CERT_REVOKED);
+      ASSERT_EQ(cache.getStats().hits, 3);
+    }
+
+    /**
+    * @brief Checks that a change to the trusted store invalidates the cached results
+    */
+    void testCacheTrustedStoreChange() {
+      vector<Certificate> untrustedChain;
+      CertificateStore store;
+      CertPathValidatorCache cache;
+
+      untrustedChain.push_back(*trustedIntermediateCa);
+
+      CertPathValidator validator(*validCert, untrustedChain, store);
+      validator.setCache(cache);
+
+      ASSERT_FALSE(validator.verify());
+      ASSERT_FALSE(validator.verify());
+      store.addCertificate(*trustedCa);
+      ASSERT_TRUE(validator.verify());
+      ASSERT_TRUE(validator.verify());
+
+      CertPathValidatorCache::Stats stats = cache.getStats();
+      ASSERT_EQ(stats.hits, 2);
+      ASSERT_EQ(stats.misses, 2);
+    }
+
+    /**
+    * @brief Checks that verifyBatch returns, in input order, the same answers as verify
+    */
+    void testVerifyBatch(DateTime when, Certificate *intermediateCa, unsigned int threads) {
+      vector<Certificate> trustedChain, untrustedChain, certificates;
+      vector<vector<CertPathValidatorResult> > results;
+      vector<CertPathValidatorResult> expected;
+
+      trustedChain.push_back(*trustedCa);
+      untrustedChain.push_back(*intermediateCa);
+      for (int i = 0; i < 40; i++) {
+        certificates.push_back(i % 3 ? *validCert : *invalidCert);
+      }
+
+      CertPathValidator validator(*validCert, untrustedChain, trustedChain, when);
+      vector<bool> valid = validator.verifyBatch(certificates, results, threads);
+
+      ASSERT_EQ(valid.size(), certificates.size());
+      ASSERT_EQ(results.size(), certificates.size());
+      for (unsigned int i = 0; i < certificates.size(); i++) {
+        ASSERT_EQ(valid[i], validator.verify(certificates[i], expected));
+        ASSERT_EQ(results[i].size(), expected.size());
+        for (unsigned int j = 0; j < expected.size(); j++) {
+          ASSERT_EQ(results[i][j].getErrorCode(), expected[j].getErrorCode());
+          ASSERT_EQ(results[i][j].getDepth(), expected[j].getDepth());
+        }
+      }
+    }
+
     Certificate *trustedCa;
     Certificate *trustedIntermediateCa;
     Certificate *validCert;
@@ -286,3 +494,47 @@ TEST_F(CertPathValidatorTest, ValidPathRevokedCertificate) {
 TEST_F(CertPathValidatorTest, ValidPathRevokedIntermediateCa) {
   testValidPathRevokedIntermediateCa();
 }
+
+TEST_F(CertPathValidatorTest, ValidPathTrustedStore) {
+  testValidPathTrustedStore();
+}
+
+TEST_F(CertPathValidatorTest, TrustedStoreWithIntermediate) {
+  testTrustedStoreWithIntermediate();
+}
+
+TEST_F(CertPathValidatorTest, TrustedStoreMissingRoot) {
+  testTrustedStoreMissingRoot();
+}
+
+TEST_F(CertPathValidatorTest, Reuse) {
+  testReuse();
+}
+
+TEST_F(CertPathValidatorTest, ConcurrentVerify) {
+  testConcurrentVerify();
+}
+
+TEST_F(CertPathValidatorTest, Cache) {
+  testCache();
+}
+
+TEST_F(CertPathValidatorTest, CacheTrustedStoreChange) {
+  testCacheTrustedStoreChange();
+}
+
+TEST_F(CertPathValidatorTest, VerifyBatch) {
+  testVerifyBatch(DateTime(time(NULL)), trustedIntermediateCa, 4);
+}
+
+TEST_F(CertPathValidatorTest, VerifyBatchSingleThread) {
+  testVerifyBatch(DateTime(time(NULL)), trustedIntermediateCa, 1);
+}
+
+TEST_F(CertPathValidatorTest, VerifyBatchExpired) {
+  testVerifyBatch(DateTime("21000101010000Z"), trustedIntermediateCa, 4);
+}
+
+TEST_F(CertPathValidatorTest, VerifyBatchInvalidIntermediate) {
+  testVerifyBatch(DateTime(time(NULL)), untrustedIntermediateCa, 4);
+}
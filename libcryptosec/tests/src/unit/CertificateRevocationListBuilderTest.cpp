@@ -1,4 +1,5 @@
 #include <libcryptosec/certificate/CertificateRevocationListBuilder.h>
+#include <libcryptosec/certificate/CertificateRevocationListReader.h>
 #include <libcryptosec/RSAKeyPair.h>
 
 #include <sstream>
@@ -282,6 +283,222 @@ protected:
         ASSERT_TRUE(crl->verify(*keyPair->getPublicKey()));
     }
 
+    CertificateRevocationListBuilder::RevokedEntry createRevokedEntry(const BigInteger &serial, time_t date,
+            RevokedCertificate::ReasonCode reason)
+    {
+        CertificateRevocationListBuilder::RevokedEntry entry;
+        CertificateRevocationListReader::getSerialNumberContent(serial, entry.serialNumber);
+        entry.revocationDate = date;
+        entry.reasonCode = reason;
+        return entry;
+    }
+
+    void fillHeader(CertificateRevocationListBuilder *builder)
+    {
+        fillSerialNumber(builder);
+        fillIssuer(builder);
+        fillLastUpdate(builder);
+        fillNextUpdate(builder);
+        fillExtension(builder);
+    }
+
+    /**
+     * @brief Tests that streaming the CRL gives the same encoding as sign with the same content
+     */
+    void testSignToStream() {
+        CertificateRevocationListBuilder stream;
+        std::vector<CertificateRevocationListBuilder::RevokedEntry> entries;
+        std::ostringstream out;
+        BigInteger one, two;
+        unsigned long length;
+
+        fillHeader(builder);
+        fillHeader(&stream);
+        /* the RSA signatures are deterministic; entries are added in serial order */
+        RevokedCertificate revokedTwo = createRevokedCertificate(1);
+        RevokedCertificate revokedOne = createRevokedCertificate(0);
+        builder->addRevokedCertificate(revokedTwo);
+        builder->addRevokedCertificate(revokedOne);
+        crl = builder->sign(*keyPair->getPrivateKey(), mdAlgorithm);
+
+        two.setHexValue(revSerialTwo);
+        one.setHexValue(revSerialOne);
+        entries.push_back(createRevokedEntry(two, revEpochTwo, revReasonTwo));
+        entries.push_back(createRevokedEntry(one, revEpochOne, revReasonOne));
+        length = stream.sign(*keyPair->getPrivateKey(), mdAlgorithm, entries, out);
+
+        ASSERT_EQ(length, out.str().size());
+        ASSERT_EQ(ByteArray((const unsigned char *) out.str().data(), out.str().size()).toHex(),
+                crl->getDerEncoded().toHex());
+        /* the builder is left as it was */
+        checkIssuer(&stream);
+        checkExtension(&stream);
+        delete crl;
+    }
+
+    /**
+     * @brief Tests streaming a large CRL and reading it back
+     */
+    void testSignToStreamLarge() {
+        std::vector<CertificateRevocationListBuilder::RevokedEntry> entries;
+        std::ostringstream out;
+        BigInteger large("730750818665451459101842416358141509827966271488");
+
+        fillHeader(builder);
+        for (long i = 0; i < 20000; i++) {
+            entries.push_back(createRevokedEntry(BigInteger(i * 3 + 1), revEpochOne + i,
+                    (RevokedCertificate::ReasonCode) (i % 3)));
+        }
+        /* GeneralizedTime after 2049 */
+        entries.push_back(createRevokedEntry(large, 2524608000LL, RevokedCertificate::KEY_COMPROMISE));
+        builder->sign(*keyPair->getPrivateKey(), mdAlgorithm, entries, out);
+
+        ByteArray der((const unsigned char *) out.str().data(), out.str().size());
+        CertificateRevocationList decoded(der);
+        ASSERT_TRUE(decoded.verify(*keyPair->getPublicKey()));
+        ASSERT_EQ(decoded.getRevokedCertificate().size(), entries.size());
+        ASSERT_TRUE(decoded.isRevoked(BigInteger(30001L)));
+        ASSERT_FALSE(decoded.isRevoked(BigInteger(30002L)));
+
+        CertificateRevocationListReader reader(der.getDataPointer(), der.size());
+        CertificateRevocationListReader::Entry entry;
+        reader.setPublicKey(*keyPair->getPublicKey());
+        for (unsigned long i = 0; i < entries.size(); i++) {
+            ASSERT_TRUE(reader.next(entry));
+            ASSERT_EQ(std::string((const char *) entry.serialNumber, entry.serialNumberLength), entries[i].serialNumber);
+            ASSERT_EQ(entry.revocationDate, entries[i].revocationDate);
+            ASSERT_EQ(entry.reasonCode, entries[i].reasonCode);
+        }
+        ASSERT_TRUE(reader.verify());
+    }
+
+    /**
+     * @brief Tests streaming a CRL signed with an EdDSA key, which has no separate digest
+     */
+    void testSignToStreamEdDSA() {
+        std::vector<CertificateRevocationListBuilder::RevokedEntry> entries;
+        std::ostringstream out;
+        EVP_PKEY *pkey = NULL;
+        EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_ED25519, NULL);
+        EVP_PKEY_keygen_init(ctx);
+        EVP_PKEY_keygen(ctx, &pkey);
+        EVP_PKEY_CTX_free(ctx);
+        EVP_PKEY_up_ref(pkey);
+        PrivateKey privateKey(pkey);
+        PublicKey publicKey(pkey);
+
+        fillHeader(builder);
+        for (long i = 0; i < 1000; i++) {
+            entries.push_back(createRevokedEntry(BigInteger(i + 1), revEpochOne, RevokedCertificate::UNSPECIFIED));
+        }
+        builder->sign(privateKey, mdAlgorithm, entries, out);
+
+        ByteArray der((const unsigned char *) out.str().data(), out.str().size());
+        CertificateRevocationList decoded(der);
+        ASSERT_TRUE(decoded.verify(publicKey));
+        ASSERT_EQ(decoded.getRevokedCertificate().size(), entries.size());
+    }
+
+    /**
+     * @brief Tests streaming a CRL signed with an RSA-PSS key, whose AlgorithmIdentifier carries parameters
+     */
+    void testSignToStreamPss() {
+        std::vector<CertificateRevocationListBuilder::RevokedEntry> entries;
+        std::ostringstream out;
+        EVP_PKEY *pkey = NULL;
+        EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA_PSS, NULL);
+        EVP_PKEY_keygen_init(ctx);
+        EVP_PKEY_CTX_set_rsa_keygen_bits(ctx, 2048);
+        EVP_PKEY_keygen(ctx, &pkey);
+        EVP_PKEY_CTX_free(ctx);
+        EVP_PKEY_up_ref(pkey);
+        PrivateKey privateKey(pkey);
+        PublicKey publicKey(pkey);
+
+        fillHeader(builder);
+        for (long i = 0; i < 1000; i++) {
+            entries.push_back(createRevokedEntry(BigInteger(i + 1), revEpochOne, RevokedCertificate::KEY_COMPROMISE));
+        }
+        builder->sign(privateKey, mdAlgorithm, entries, out);
+
+        ByteArray der((const unsigned char *) out.str().data(), out.str().size());
+        CertificateRevocationList decoded(der);
+        const X509_ALGOR *algorithm = NULL;
+        X509_CRL_get0_signature(decoded.getX509Crl(), NULL, &algorithm);
+        ASSERT_EQ(OBJ_obj2nid(algorithm->algorithm), NID_rsassaPss);
+        ASSERT_NE(algorithm->parameter, (ASN1_TYPE *) NULL);
+        ASSERT_TRUE(decoded.verify(publicKey));
+    }
+
+    /**
+     * @brief Tests that the streamed CRL is v2 only when it has extensions, whatever version the builder has
+     */
+    void testSignToStreamVersion() {
+        CertificateRevocationListBuilder plain;
+        std::vector<CertificateRevocationListBuilder::RevokedEntry> entries;
+        std::ostringstream out, withReason, withExtension;
+
+        fillIssuer(&plain);
+        plain.setVersion(1);
+        entries.push_back(createRevokedEntry(BigInteger(1L), revEpochOne, RevokedCertificate::UNSPECIFIED));
+        plain.sign(*keyPair->getPrivateKey(), mdAlgorithm, entries, out);
+        ByteArray der((const unsigned char *) out.str().data(), out.str().size());
+        ASSERT_EQ(CertificateRevocationList(der).getVersion(), 0);
+        ASSERT_EQ(plain.getVersion(), 1);
+
+        entries[0].reasonCode = RevokedCertificate::AACOMPROMISE;
+        plain.setVersion(0);
+        plain.sign(*keyPair->getPrivateKey(), mdAlgorithm, entries, withReason);
+        der = ByteArray((const unsigned char *) withReason.str().data(), withReason.str().size());
+        CertificateRevocationList decoded(der);
+        ASSERT_EQ(decoded.getVersion(), 1);
+        ASSERT_EQ(decoded.getRevokedCertificate().at(0).getReasonCode(), RevokedCertificate::AACOMPROMISE);
+
+        fillHeader(builder);
+        builder->setVersion(0);
+        entries[0].reasonCode = RevokedCertificate::UNSPECIFIED;
+        builder->sign(*keyPair->getPrivateKey(), mdAlgorithm, entries, withExtension);
+        der = ByteArray((const unsigned char *) withExtension.str().data(), withExtension.str().size());
+        ASSERT_EQ(CertificateRevocationList(der).getVersion(), 1);
+    }
+
+    /**
+     * @brief Tests that entries out of order and builders with revoked certificates are rejected
+     */
+    void testSignToStreamInvalid() {
+        std::vector<CertificateRevocationListBuilder::RevokedEntry> entries;
+        std::ostringstream out;
+
+        fillHeader(builder);
+        entries.push_back(createRevokedEntry(BigInteger(2L), revEpochOne, RevokedCertificate::UNSPECIFIED));
+        entries.push_back(createRevokedEntry(BigInteger(1L), revEpochOne, RevokedCertificate::UNSPECIFIED));
+        ASSERT_THROW(builder->sign(*keyPair->getPrivateKey(), mdAlgorithm, entries, out), EncodeException);
+
+        entries[1] = entries[0];
+        ASSERT_THROW(builder->sign(*keyPair->getPrivateKey(), mdAlgorithm, entries, out), EncodeException);
+
+        entries.pop_back();
+        entries[0].serialNumber = std::string("\x00\x01", 2);
+        ASSERT_THROW(builder->sign(*keyPair->getPrivateKey(), mdAlgorithm, entries, out), EncodeException);
+
+        entries[0] = createRevokedEntry(BigInteger(-5L), revEpochOne, RevokedCertificate::UNSPECIFIED);
+        ASSERT_THROW(builder->sign(*keyPair->getPrivateKey(), mdAlgorithm, entries, out), EncodeException);
+
+        /* ano 10000 não cabe no GeneralizedTime; nada pode ser escrito */
+        entries[0] = createRevokedEntry(BigInteger(1L), (time_t) 253402300800LL, RevokedCertificate::UNSPECIFIED);
+        ASSERT_THROW(builder->sign(*keyPair->getPrivateKey(), mdAlgorithm, entries, out), EncodeException);
+        ASSERT_TRUE(out.str().empty());
+
+        /* fora de ReasonCode, sem valor do CRLReason correspondente */
+        entries[0] = createRevokedEntry(BigInteger(1L), revEpochOne, (RevokedCertificate::ReasonCode) 9);
+        ASSERT_THROW(builder->sign(*keyPair->getPrivateKey(), mdAlgorithm, entries, out), EncodeException);
+        ASSERT_TRUE(out.str().empty());
+
+        entries[0] = createRevokedEntry(BigInteger(1L), revEpochOne, RevokedCertificate::UNSPECIFIED);
+        fillRevokedCertificate(builder, 1);
+        ASSERT_THROW(builder->sign(*keyPair->getPrivateKey(), mdAlgorithm, entries, out), CertificationException);
+    }
+
     CertificateRevocationListBuilder *builder;
     CertificateRevocationList *crl;
 
@@ -464,4 +681,40 @@ TEST_F(CertificateRevocationListBuilderTest, FromDER) {
     ba = crl->getDerEncoded();
     builder = new CertificateRevocationListBuilder(ba);
     checkCertificateRevocationListBuilder(builder);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 
+ */
+TEST_F(CertificateRevocationListBuilderTest, SignToStream) {
+    testSignToStream();
+}
+
+/**
+ * @brief 
+ */
+TEST_F(CertificateRevocationListBuilderTest, SignToStreamLarge) {
+    testSignToStreamLarge();
+}
+
+/**
+ * @brief 
+ */
+TEST_F(CertificateRevocationListBuilderTest, SignToStreamEdDSA) {
+    testSignToStreamEdDSA();
+}
+
+TEST_F(CertificateRevocationListBuilderTest, SignToStreamPss) {
+    testSignToStreamPss();
+}
+
+TEST_F(CertificateRevocationListBuilderTest, SignToStreamVersion) {
+    testSignToStreamVersion();
+}
+
+/**
+ * @brief 
+ */
+TEST_F(CertificateRevocationListBuilderTest, SignToStreamInvalid) {
+    testSignToStreamInvalid();
+}
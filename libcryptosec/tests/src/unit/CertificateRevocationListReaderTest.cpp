@@ -0,0 +1,431 @@
+#include <libcryptosec/certificate/CertificateRevocationListReader.h>
+#include <libcryptosec/certificate/CertificateRevocationList.h>
+#include <libcryptosec/certificate/JsonWriter.h>
+#include <libcryptosec/certificate/XmlWriter.h>
+
+#include <openssl/ec.h>
+#include <sstream>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe CertificateRevocationListReader
+ */
+class CertificateRevocationListReaderTest : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        CertificateRevocationList crl(crlPem);
+        ByteArray der = crl.getDerEncoded();
+        crlDer.assign((const char *) der.getDataPointer(), der.size());
+    }
+
+    /**
+     * @brief Counts the entries and stops after a given number of them
+     */
+    class CountingHandler : public CertificateRevocationListReader::Handler {
+    public:
+        CountingHandler(unsigned long stop) : stop(stop), count(0), reasons(0) {}
+
+        virtual bool revoked(const CertificateRevocationListReader::Entry &entry) {
+            count++;
+            reasons += entry.reasonCode;
+            return (count < stop);
+        }
+
+        unsigned long stop;
+        unsigned long count;
+        unsigned long reasons;
+    };
+
+    /**
+     * @brief Builds a CRL with the given number of entries, signed with key
+     */
+    static std::string buildCrl(long entries, EVP_PKEY *key, const EVP_MD *md) {
+        X509_CRL *x509Crl = X509_CRL_new();
+        X509_NAME *name = X509_NAME_new();
+        ASN1_TIME *date = ASN1_TIME_set(NULL, 1487889918);
+        unsigned char *der = NULL;
+        std::string ret;
+        int len;
+
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *) "Reader CA", -1, -1, 0);
+        X509_CRL_set_version(x509Crl, 1);
+        X509_CRL_set_issuer_name(x509Crl, name);
+        X509_CRL_set1_lastUpdate(x509Crl, date);
+        for (long i = 0; i < entries; i++) {
+            X509_REVOKED *revoked = X509_REVOKED_new();
+            ASN1_INTEGER *serial = ASN1_INTEGER_new();
+            ASN1_ENUMERATED *reason = ASN1_ENUMERATED_new();
+            ASN1_INTEGER_set(serial, i * 7919 + 1000000007L);
+            X509_REVOKED_set_serialNumber(revoked, serial);
+            X509_REVOKED_set_revocationDate(revoked, date);
+            ASN1_ENUMERATED_set(reason, i % 2);
+            X509_REVOKED_add1_ext_i2d(revoked, NID_crl_reason, reason, 0, 0);
+            ASN1_INTEGER_free(serial);
+            ASN1_ENUMERATED_free(reason);
+            X509_CRL_add0_revoked(x509Crl, revoked);
+        }
+        X509_CRL_sort(x509Crl);
+        X509_CRL_sign(x509Crl, key, md);
+        len = i2d_X509_CRL(x509Crl, &der);
+        ret.assign((const char *) der, len);
+        OPENSSL_free(der);
+        ASN1_TIME_free(date);
+        X509_NAME_free(name);
+        X509_CRL_free(x509Crl);
+        return ret;
+    }
+
+    /**
+     * @brief Tests reading the fields that precede the entries
+     */
+    void testHeader() {
+        CertificateRevocationListReader reader((const unsigned char *) crlDer.data(), crlDer.size());
+
+        ASSERT_EQ(reader.getVersion(), 1);
+        ASSERT_EQ(reader.getIssuer().getEntries(RDNSequence::COMMON_NAME)[0], "Ronaldo Cert Signer V3");
+        ASSERT_EQ(reader.getThisUpdate(), 1487889907);
+        ASSERT_EQ(reader.getNextUpdate(), 1665096307);
+    }
+
+    /**
+     * @brief Tests reading the entries one by one
+     */
+    void testNext() {
+        CertificateRevocationListReader reader((const unsigned char *) crlDer.data(), crlDer.size());
+        CertificateRevocationListReader::Entry entry;
+
+        ASSERT_TRUE(reader.next(entry));
+        ASSERT_EQ(entry.getSerialNumberBigInt().toDec(), "11111111111111111111");
+        ASSERT_EQ(entry.revocationDate, 1487889918);
+        ASSERT_EQ(entry.reasonCode, RevokedCertificate::KEY_COMPROMISE);
+
+        ASSERT_TRUE(reader.next(entry));
+        ASSERT_EQ(entry.getSerialNumberBigInt().toDec(), "2222222222222222222");
+        ASSERT_EQ(entry.revocationDate, 1487989907);
+        ASSERT_EQ(entry.reasonCode, RevokedCertificate::CA_COMPROMISE);
+
+        ASSERT_FALSE(reader.next(entry));
+        ASSERT_FALSE(reader.next(entry));
+        ASSERT_EQ(reader.getCount(), 2);
+    }
+
+    /**
+     * @brief Tests verifying the signature while reading
+     */
+    void testVerify() {
+        CertificateRevocationListReader reader((const unsigned char *) crlDer.data(), crlDer.size());
+        CertificateRevocationListReader::Entry entry;
+
+        reader.setPublicKey(crlPublicKey);
+        ASSERT_TRUE(reader.next(entry));
+        ASSERT_THROW(reader.setPublicKey(crlPublicKey), CertificationException);
+        ASSERT_TRUE(reader.verify());
+        ASSERT_TRUE(reader.verify());
+        ASSERT_FALSE(reader.next(entry));
+    }
+
+    /**
+     * @brief Tests that verify() fails without a key, with the wrong key or with a changed entry
+     */
+    void testVerifyInvalid() {
+        std::string tampered = crlDer;
+        size_t date = tampered.find("170225023147Z");
+
+        CertificateRevocationListReader noKey((const unsigned char *) crlDer.data(), crlDer.size());
+        ASSERT_FALSE(noKey.verify());
+
+        CertificateRevocationListReader wrongKey((const unsigned char *) crlDer.data(), crlDer.size());
+        wrongKey.setPublicKey(crlWrongPublicKey);
+        ASSERT_FALSE(wrongKey.verify());
+
+        ASSERT_NE(date, std::string::npos);
+        tampered[date + 5] = '6';
+        CertificateRevocationListReader changed((const unsigned char *) tampered.data(), tampered.size());
+        CertificateRevocationListReader::Entry entry;
+        changed.setPublicKey(crlPublicKey);
+        ASSERT_TRUE(changed.next(entry));
+        ASSERT_TRUE(changed.next(entry));
+        ASSERT_EQ(entry.revocationDate, 1487989907 + 86400);
+        ASSERT_FALSE(changed.verify());
+    }
+
+    /**
+     * @brief Tests reading a large CRL from a stream, with a handler
+     */
+    void testStream() {
+        EC_KEY *eckey = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+        EVP_PKEY *key = EVP_PKEY_new();
+        EC_KEY_generate_key(eckey);
+        EVP_PKEY_assign_EC_KEY(key, eckey);
+        std::istringstream stream(buildCrl(50000, key, EVP_sha256()));
+        PublicKey publicKey(key);
+        CertificateRevocationListReader reader(stream);
+        CountingHandler handler(100);
+
+        reader.setPublicKey(publicKey);
+        ASSERT_EQ(reader.getIssuer().getEntries(RDNSequence::COMMON_NAME)[0], "Reader CA");
+        ASSERT_EQ(reader.read(handler), 100);
+        handler.stop = 1000000;
+        ASSERT_EQ(reader.read(handler), 50000 - 100);
+        ASSERT_EQ(handler.reasons, 25000);
+        ASSERT_EQ(reader.getCount(), 50000);
+        ASSERT_TRUE(reader.verify());
+    }
+
+    /**
+     * @brief Tests verifying a CRL signed with Ed25519, which has no separate digest
+     */
+    void testVerifyWithoutDigest() {
+        EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_ED25519, NULL);
+        EVP_PKEY *key = NULL;
+        EVP_PKEY_keygen_init(ctx);
+        EVP_PKEY_keygen(ctx, &key);
+        EVP_PKEY_CTX_free(ctx);
+        std::istringstream stream(buildCrl(1000, key, NULL));
+        PublicKey publicKey(key);
+        CertificateRevocationListReader reader(stream);
+
+        reader.setPublicKey(publicKey);
+        ASSERT_TRUE(reader.verify());
+        ASSERT_EQ(reader.getCount(), 0);
+    }
+
+    /**
+     * @brief Tests reading truncated and malformed encodings
+     */
+    void testInvalid() {
+        CertificateRevocationListReader::Entry entry;
+        std::string truncated = crlDer.substr(0, crlDer.size() - 10);
+        std::string garbage = "not a CRL at all";
+
+        CertificateRevocationListReader reader((const unsigned char *) truncated.data(), truncated.size());
+        ASSERT_TRUE(reader.next(entry));
+        ASSERT_TRUE(reader.next(entry));
+        ASSERT_FALSE(reader.next(entry));
+        ASSERT_THROW(reader.verify(), EncodeException);
+
+        std::istringstream stream(garbage);
+        CertificateRevocationListReader invalid(stream);
+        ASSERT_THROW(invalid.next(entry), EncodeException);
+
+        std::istringstream empty("");
+        CertificateRevocationListReader none(empty);
+        ASSERT_THROW(none.getVersion(), EncodeException);
+    }
+
+    /**
+     * @brief Tests that unknown reasons are read as unspecified and unknown critical extensions are rejected
+     */
+    void testEntryExtensions() {
+        CertificateRevocationListReader::Entry entry;
+
+        /* CRLReason 7 is unused and 11 is out of range */
+        std::string reason = crlDer;
+        size_t at = reason.find(std::string("\x04\x03\x0a\x01\x01", 5));
+        ASSERT_NE(at, std::string::npos);
+        for (char value = 7; value <= 11; value += 4) {
+            reason[at + 4] = value;
+            CertificateRevocationListReader unknown((const unsigned char *) reason.data(), reason.size());
+            ASSERT_TRUE(unknown.next(entry));
+            ASSERT_EQ(entry.reasonCode, RevokedCertificate::UNSPECIFIED);
+            ASSERT_FALSE(entry.removeFromCrl);
+            ASSERT_TRUE(unknown.next(entry));
+            ASSERT_EQ(entry.reasonCode, RevokedCertificate::CA_COMPROMISE);
+        }
+
+        EC_KEY *eckey = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+        EVP_PKEY *key = EVP_PKEY_new();
+        EC_KEY_generate_key(eckey);
+        EVP_PKEY_assign_EC_KEY(key, eckey);
+        X509_CRL *x509Crl = X509_CRL_new();
+        ASN1_TIME *date = ASN1_TIME_set(NULL, 1487889918);
+        ASN1_GENERALIZEDTIME *invalidity = ASN1_GENERALIZEDTIME_set(NULL, 1487800000);
+        ASN1_ENUMERATED *code = ASN1_ENUMERATED_new();
+        unsigned char *der = NULL;
+        X509_CRL_set_version(x509Crl, 1);
+        X509_CRL_set1_lastUpdate(x509Crl, date);
+        ASN1_ENUMERATED_set(code, CRL_REASON_KEY_COMPROMISE);
+        for (long i = 1; i <= 3; i++) {
+            X509_REVOKED *revoked = X509_REVOKED_new();
+            ASN1_INTEGER *serial = ASN1_INTEGER_new();
+            ASN1_INTEGER_set(serial, i);
+            X509_REVOKED_set_serialNumber(revoked, serial);
+            X509_REVOKED_set_revocationDate(revoked, date);
+            /* 1: non-critical invalidityDate, 2: critical reasonCode, 3: critical invalidityDate */
+            if (i == 2) {
+                X509_REVOKED_add1_ext_i2d(revoked, NID_crl_reason, code, 1, 0);
+            } else {
+                X509_REVOKED_add1_ext_i2d(revoked, NID_invalidity_date, invalidity, i == 3, 0);
+            }
+            ASN1_INTEGER_free(serial);
+            X509_CRL_add0_revoked(x509Crl, revoked);
+        }
+        X509_CRL_sign(x509Crl, key, EVP_sha256());
+        int len = i2d_X509_CRL(x509Crl, &der);
+        std::string encoded((const char *) der, len);
+        OPENSSL_free(der);
+        ASN1_ENUMERATED_free(code);
+        ASN1_GENERALIZEDTIME_free(invalidity);
+        ASN1_TIME_free(date);
+        X509_CRL_free(x509Crl);
+        EVP_PKEY_free(key);
+
+        CertificateRevocationListReader reader((const unsigned char *) encoded.data(), encoded.size());
+        ASSERT_TRUE(reader.next(entry));
+        ASSERT_EQ(entry.reasonCode, RevokedCertificate::UNSPECIFIED);
+        ASSERT_TRUE(reader.next(entry));
+        ASSERT_EQ(entry.reasonCode, RevokedCertificate::KEY_COMPROMISE);
+        ASSERT_THROW(reader.next(entry), EncodeException);
+    }
+
+    /**
+     * @brief Tests stream encodings whose lengths exceed the enclosing element or the element limit,
+     * which must fail before any buffer of that size is allocated
+     */
+    void testMalformedLengths() {
+        CertificateRevocationListReader::Entry entry;
+        /* CertificateList, TBSCertList, version, sha256WithRSAEncryption */
+        std::string header("\x30\x84\x7f\xff\xff\xf0\x30\x84\x7f\xff\xff\xe0\x02\x01\x01"
+                "\x30\x0d\x06\x09\x2a\x86\x48\x86\xf7\x0d\x01\x01\x0b\x05\x00", 30);
+        std::string times("\x17\x0d" "170223224507Z", 15);
+
+        std::istringstream tbs(std::string("\x30\x08\x30\x84\x7f\xff\xff\xff\x02\x01", 10));
+        CertificateRevocationListReader longTbs(tbs);
+        ASSERT_THROW(longTbs.getVersion(), EncodeException);
+
+        std::istringstream issuer(header + std::string("\x30\x84\x7f\x00\x00\x00\x31\x00", 8));
+        CertificateRevocationListReader longIssuer(issuer);
+        ASSERT_THROW(longIssuer.getIssuer(), EncodeException);
+
+        std::istringstream outer(std::string("\x30\x84\x00\x00\x00\x30", 6) + header.substr(6)
+                + std::string("\x30\x00", 2) + times);
+        CertificateRevocationListReader longTbsHeader(outer);
+        ASSERT_THROW(longTbsHeader.getVersion(), EncodeException);
+
+        std::istringstream entries(header + std::string("\x30\x00", 2) + times
+                + std::string("\x30\x84\x7f\x00\x00\x00\x30\x84\x10\x00\x00\x00\x02\x01\x01", 15));
+        CertificateRevocationListReader longEntry(entries);
+        ASSERT_EQ(longEntry.getThisUpdate(), 1487889907);
+        ASSERT_THROW(longEntry.next(entry), EncodeException);
+    }
+
+    /**
+     * @brief Tests writing the entries as they are read, with the fields of CertificateRevocationList::write()
+     */
+    void testWrite() {
+        CertificateRevocationListReader reader((const unsigned char *) crlDer.data(), crlDer.size());
+        CertificateRevocationList crl(crlPem);
+        std::ostringstream streamed, full, xml;
+        JsonWriter streamedWriter(streamed), fullWriter(full);
+        XmlWriter xmlWriter(xml);
+        std::string list = "\"revokedCertificates\":[";
+
+        ASSERT_EQ(reader.write(streamedWriter), 2);
+        ASSERT_EQ(streamed.str().find("{\"certificateRevocationList\":{\"tbsCertList\":{\"version\":1,\"issuer\":["), 0);
+        ASSERT_NE(streamed.str().find("\"thisUpdate\":\"2017-02-23T22:45:07Z\",\"nextUpdate\":\"2022-10-06T22:45:07Z\""), std::string::npos);
+        ASSERT_NE(streamed.str().find("{\"certificateSerialNumber\":\"11111111111111111111\",\"revocationDate\":\"2017-02-23T22:45:18Z\",\"reason\":\"keyCompromise\"}"), std::string::npos);
+        ASSERT_EQ(streamed.str().substr(streamed.str().size() - 4), "]}}}");
+
+        crl.write(fullWriter);
+        std::string entries = streamed.str().substr(streamed.str().find(list));
+        entries = entries.substr(0, entries.find("]") + 1);
+        ASSERT_NE(full.str().find(entries), std::string::npos);
+        ASSERT_NE(full.str().find("\"signatureValue\":\""), std::string::npos);
+
+        crl.write(xmlWriter);
+        ASSERT_NE(xml.str().find("\t\t<revokedCertificates>\n\t\t\t<revokedCertificate>\n"
+                "\t\t\t\t<certificateSerialNumber>11111111111111111111</certificateSerialNumber>\n"), std::string::npos);
+    }
+
+    std::string crlDer;
+
+    static std::string crlPem;
+    static std::string crlPublicKeyPem;
+    static std::string crlWrongPublicKeyPem;
+
+    static PublicKey crlPublicKey;
+    static PublicKey crlWrongPublicKey;
+};
+
+/*
+ * Initialization of variables used in the tests
+ */
+std::string CertificateRevocationListReaderTest::crlPem = "-----BEGIN X509 CRL-----" "\n"
+"MIICSDCCATACAQEwDQYJKoZIhvcNAQENBQAwbDELMAkGA1UEBhMCQlIxEjAQBgNV" "\n"
+"BAgMCVNhbyBQYXVsbzESMBAGA1UEBwwJU2FvIFBhdWxvMRQwEgYDVQQKDAtDZXJ0" "\n"
+"IFNpZ25lcjEfMB0GA1UEAwwWUm9uYWxkbyBDZXJ0IFNpZ25lciBWMxcNMTcwMjIz" "\n"
+"MjI0NTA3WhcNMjIxMDA2MjI0NTA3WjBTMCgCCQCaMpivtaxxxxcNMTcwMjIzMjI0" "\n"
+"NTE4WjAMMAoGA1UdFQQDCgEBMCcCCB7W61ZXiOOOFw0xNzAyMjUwMjMxNDdaMAww" "\n"
+"CgYDVR0VBAMKAQKgOzA5MAoGA1UdFAQDAgEUMAoGA1UdGwQDAgETMB8GA1UdIwQY" "\n"
+"MBaAFHLn9A7bmtn7rZAw+mnqinFVUq4/MA0GCSqGSIb3DQEBDQUAA4IBAQCJAyeY" "\n"
+"0sjQoEovkvKYXtUXXfsYtD39yHbJWmuFaLbxxODyNHnvFjfFAhJagHXitqohyH4W" "\n"
+"sYtefxx1UMk1KGjpChUKYtBExoXYG4XcNobXfOAdW5GaFVGwAELe/EPf20tR3q0O" "\n"
+"tUBUHW8+K7w0koO/EAlJyDoJ+O+DF96o7LE/XCAyrlNITAR3ebQS6PNxu8z/HakS" "\n"
+"Z75WFcpFguHc/cCX6jv/DtX9LFfsRk4sEoZic2G0vfmRg1Hp3m91zSLktkWCK2tM" "\n"
+"mwQAOySYNq9z1pXzoXbbhQJvblpXerG6o5DTTOohWtOq/596aLqKalgQF8SVPVw5" "\n"
+"F8lXjNm0euhjPQM9" "\n"
+"-----END X509 CRL-----" "\n";
+
+std::string CertificateRevocationListReaderTest::crlPublicKeyPem = "-----BEGIN PUBLIC KEY-----" "\n"
+"MIIBIjANBgkqhkiG9w0BAQEFAAOCAQ8AMIIBCgKCAQEAvCCfNp9f9MDwoJa/t9TM" "\n"
+"XcYjXGFCxpAqhAAzR8bSISzQ/qJdkEqmpIN1bEIWQZGpzeIXp4ZdslpZ2KMJ3OXJ" "\n"
+"Wdi7nEOg+F4Kcer+qRzVbjqGoZ5BTRoo8G/GmP/j8R7++vZhVUBSbDZWYA7sytEe" "\n"
+"n8HGeiRUXGDGJu2OLAdvgbsgDJr2DdDCNUP/Q8UT+geeikaJNFP7QjvxKJ29qKoR" "\n"
+"pUHzy02+tJmHk5xxPHP8TNd0Wqud1Eoa7QGtERxLkkSiPuSYZHoawNzovZRb74cT" "\n"
+"TgLs6swCEgA7clquXhGMnfVhO/9o2AezVkLr3x7hJMBSgz4SoPRZKs1F76HHD/yE" "\n"
+"swIDAQAB" "\n"
+"-----END PUBLIC KEY-----" "\n";
+
+std::string CertificateRevocationListReaderTest::crlWrongPublicKeyPem = "-----BEGIN PUBLIC KEY-----" "\n"
+"MIIBIjANBgkqhkiG9w0BAQEFAAOCAQ8AMIIBCgKCAQEAqaENXPUFvkjledWgw/4C" "\n"
+"bdv6v6d8+0DbdzRHGsNEO15XrLZDwC6pNj+GHQX81nrzFA/MlscywErx9Gj74YyD" "\n"
+"ONuSf6e+XwFNV0rYd78ndGgNaz3OD+tPT6+6UNv1+JIGGPTdCIhdF5D3PvXIoMiA" "\n"
+"iQRQI6jNWMlwGpsJ7E5FhW2dXne0+8tLVm4SmxoTqMfR5MBW0VBAagDc5OLO1Eti" "\n"
+"xjm3Z0eoJ2T4JECDGfFD4Biwmbvr2mXuafnr7VhCeHBzEDLM+r6NzocCV8GH25mC" "\n"
+"I0h7+2U5ZfqNNzYTfmEpc4zALRvL2HHIxKkWgBStzkO++KSLhZA7b4cFPV1tQfii" "\n"
+"IQIDAQAB" "\n"
+"-----END PUBLIC KEY-----" "\n";
+
+PublicKey CertificateRevocationListReaderTest::crlPublicKey = PublicKey(crlPublicKeyPem);
+PublicKey CertificateRevocationListReaderTest::crlWrongPublicKey = PublicKey(crlWrongPublicKeyPem);
+
+TEST_F(CertificateRevocationListReaderTest, Header) {
+    testHeader();
+}
+
+TEST_F(CertificateRevocationListReaderTest, Next) {
+    testNext();
+}
+
+TEST_F(CertificateRevocationListReaderTest, Verify) {
+    testVerify();
+}
+
+TEST_F(CertificateRevocationListReaderTest, VerifyInvalid) {
+    testVerifyInvalid();
+}
+
+TEST_F(CertificateRevocationListReaderTest, Stream) {
+    testStream();
+}
+
+TEST_F(CertificateRevocationListReaderTest, VerifyWithoutDigest) {
+    testVerifyWithoutDigest();
+}
+
+TEST_F(CertificateRevocationListReaderTest, Invalid) {
+    testInvalid();
+}
+
+TEST_F(CertificateRevocationListReaderTest, EntryExtensions) {
+    testEntryExtensions();
+}
+
+TEST_F(CertificateRevocationListReaderTest, MalformedLengths) {
+    testMalformedLengths();
+}
+
+TEST_F(CertificateRevocationListReaderTest, Write) {
+    testWrite();
+}
@@ -1,6 +1,8 @@
 #include <libcryptosec/certificate/CertificateRevocationListBuilder.h>
 
 #include <sstream>
+#include <atomic>
+#include <thread>
 #include <gtest/gtest.h>
 
 /**
@@ -304,6 +306,129 @@ protected:
         ASSERT_THROW(invalid.getPemEncoded(), EncodeException);
     }
 
+    /**
+     * @brief Tests looking up revoked and not revoked serial numbers
+     */
+    void testIsRevoked()
+    {
+        ASSERT_TRUE(crl->isRevoked(BigInteger(revSerialOneDec)));
+        ASSERT_TRUE(crl->isRevoked(BigInteger(revSerialTwoDec)));
+        ASSERT_FALSE(crl->isRevoked(BigInteger(3L)));
+        ASSERT_FALSE(crl->isRevoked(BigInteger(-2L)));
+    }
+
+    /**
+     * @brief Tests getting the entry of a revoked serial number
+     */
+    void testGetRevocation()
+    {
+        RevokedCertificate *rev = crl->getRevocation(BigInteger(revSerialTwoDec));
+
+        ASSERT_TRUE(rev);
+        ASSERT_EQ(rev->getCertificateSerialNumberBigInt().toHex(), revSerialTwo);
+        ASSERT_EQ(rev->getRevocationDate().getDateTime(), revEpochTwo);
+        ASSERT_EQ(rev->getReasonCode(), revReasonTwo);
+        delete rev;
+
+        ASSERT_EQ(crl->getRevocation(BigInteger(3L)), (RevokedCertificate *) NULL);
+    }
+
+    /**
+     * @brief Tests lookups in a large CRL from several threads, while the index is built
+     */
+    void testIsRevokedConcurrent()
+    {
+        X509_CRL *x509Crl = X509_CRL_new();
+        std::vector<std::thread> workers;
+        std::atomic<int> failures(0);
+
+        for (long i = 0; i < 20000; i++) {
+            X509_REVOKED *revoked = X509_REVOKED_new();
+            ASN1_INTEGER *serial = ASN1_INTEGER_new();
+            ASN1_INTEGER_set(serial, i * 2);
+            X509_REVOKED_set_serialNumber(revoked, serial);
+            ASN1_INTEGER_free(serial);
+            X509_CRL_add0_revoked(x509Crl, revoked);
+        }
+        CertificateRevocationList large(x509Crl);
+
+        for (int t = 0; t < 4; t++) {
+            workers.push_back(std::thread([&large, &failures, t]() {
+                for (long i = t; i < 40000; i += 37) {
+                    if (large.isRevoked(BigInteger(i)) != (i % 2 == 0)) {
+                        failures++;
+                    }
+                }
+            }));
+        }
+        for (unsigned int i = 0; i < workers.size(); i++) {
+            workers[i].join();
+        }
+
+        ASSERT_EQ(failures.load(), 0);
+        ASSERT_FALSE(large.isRevoked(BigInteger(40000L)));
+    }
+
+    /**
+     * @brief Tests the Bloom filter built with the serial index and its counters
+     */
+    void testBloomFilter()
+    {
+        X509_CRL *x509Crl = X509_CRL_new();
+        BigInteger large("730750818665451459101842416358141509827966271488");
+        long serials[] = { 0, -7, 1 };
+
+        for (long i = 0; i < 5000; i++) {
+            X509_REVOKED *revoked = X509_REVOKED_new();
+            ASN1_INTEGER *serial = ASN1_INTEGER_new();
+            ASN1_INTEGER_set(serial, i * 4 + 3);
+            X509_REVOKED_set_serialNumber(revoked, serial);
+            ASN1_INTEGER_free(serial);
+            X509_CRL_add0_revoked(x509Crl, revoked);
+        }
+        /* serials whose encodings are special cases of the hash: zero, negative and wide */
+        for (int i = 0; i < 3; i++) {
+            X509_REVOKED *revoked = X509_REVOKED_new();
+            ASN1_INTEGER *serial = (i == 2) ? large.getASN1Value() : ASN1_INTEGER_new();
+            if (i < 2) {
+                ASN1_INTEGER_set(serial, serials[i]);
+            }
+            X509_REVOKED_set_serialNumber(revoked, serial);
+            ASN1_INTEGER_free(serial);
+            X509_CRL_add0_revoked(x509Crl, revoked);
+        }
+        CertificateRevocationList filtered(x509Crl);
+
+        ASSERT_EQ(filtered.getBloomFilter(), (const BloomFilter *) NULL);
+        ASSERT_TRUE(filtered.isRevoked(BigInteger(0L)));
+        ASSERT_TRUE(filtered.isRevoked(BigInteger(-7L)));
+        ASSERT_TRUE(filtered.isRevoked(large));
+        const BloomFilter *filter = filtered.getBloomFilter();
+        ASSERT_TRUE(filter != NULL);
+        ASSERT_LE(filter->getFalsePositiveRate(), 0.011);
+
+        for (long i = 0; i < 20000; i++) {
+            ASSERT_EQ(filtered.isRevoked(BigInteger(i)), i % 4 == 3 || i == 0);
+        }
+        ASSERT_EQ(filter->getLookups(), 20003UL);
+        /* 15000 serials are not revoked; about 1% of them get past the filter */
+        ASSERT_GT(filter->getRejections(), 14500UL);
+        /* the sign is hashed apart from the magnitude */
+        ASSERT_FALSE(filtered.isRevoked(BigInteger(-3L)));
+
+        filtered.setBloomFilter(0.0);
+        ASSERT_TRUE(filtered.isRevoked(BigInteger(3L)));
+        ASSERT_FALSE(filtered.isRevoked(BigInteger(4L)));
+        ASSERT_EQ(filtered.getBloomFilter(), (const BloomFilter *) NULL);
+
+        /* a small filter is allowed, at the cost of more false positives */
+        filtered.setBloomFilter(0.001, 8192);
+        ASSERT_TRUE(filtered.isRevoked(BigInteger(7L)));
+        ASSERT_EQ(filtered.getBloomFilter()->getSizeBits(), 8192UL);
+        ASSERT_GT(filtered.getBloomFilter()->getFalsePositiveRate(), 0.01);
+        ASSERT_FALSE(filtered.isRevoked(BigInteger(8L)));
+    }
+
     CertificateRevocationList *crl;
 
     static std::string crlPem;
@@ -603,4 +728,19 @@ TEST_F(CertificateRevocationListTest, InvalidDER) {
 
 TEST_F(CertificateRevocationListTest, InvalidCRL) {
     testInvalidCRL();
-}
\ No newline at end of file
+}
+TEST_F(CertificateRevocationListTest, IsRevoked) {
+    testIsRevoked();
+}
+
+TEST_F(CertificateRevocationListTest, GetRevocation) {
+    testGetRevocation();
+}
+
+TEST_F(CertificateRevocationListTest, IsRevokedConcurrent) {
+    testIsRevokedConcurrent();
+}
+
+TEST_F(CertificateRevocationListTest, BloomFilter) {
+    testBloomFilter();
+}
@@ -0,0 +1,399 @@
+#include <libcryptosec/certificate/CertificateStore.h>
+
+#include <openssl/x509v3.h>
+#include <fstream>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe CertificateStore
+ */
+class CertificateStoreTest : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+      char path[] = "/tmp/certificateStoreTestXXXXXX";
+      ASSERT_TRUE(mkdtemp(path) != NULL);
+      dir = path;
+    }
+
+    virtual void TearDown() {
+      for (unsigned int i = 0; i < created.size(); i++) {
+        unlink(created[i].c_str());
+      }
+      rmdir(dir.c_str());
+    }
+
+    /**
+     * @brief Creates a file inside the temporary directory
+     */
+    std::string writeFile(std::string name, std::string content) {
+      std::string path = dir + "/" + name;
+      std::ofstream file(path.c_str(), std::ios::out | std::ios::binary);
+      file << content;
+      file.close();
+      created.push_back(path);
+      return path;
+    }
+
+    std::string der(std::string pem) {
+      Certificate cert(pem);
+      ByteArray der = cert.getDerEncoded();
+      return std::string((const char *) der.getDataPointer(), der.size());
+    }
+
+    void freeCertificates(std::vector<Certificate *> &certs) {
+      for (unsigned int i = 0; i < certs.size(); i++) {
+        delete certs[i];
+      }
+    }
+
+    /**
+     * @brief Tests loading a bundle with several certificates and other PEM blocks
+     */
+    void testLoadPemBundle() {
+      CertificateStore store;
+      std::string path = writeFile("bundle.pem", "comment before the first block\n" + caPem + "\n"
+          + "-----BEGIN X509 CRL-----\nMIIB\n-----END X509 CRL-----\n" + intermediatePem + "\n" + leafPem + "\n");
+
+      ASSERT_EQ(store.loadPemBundle(path), 3);
+      ASSERT_EQ(store.size(), 3);
+
+      std::vector<Certificate *> certs = store.getCertificates();
+      ASSERT_TRUE(*certs[0] == Certificate(caPem));
+      ASSERT_TRUE(*certs[1] == Certificate(intermediatePem));
+      ASSERT_TRUE(*certs[2] == Certificate(leafPem));
+      freeCertificates(certs);
+    }
+
+    /**
+     * @brief Tests that repeated certificates are kept unless deduplication is enabled
+     */
+    void testDeduplicate() {
+      std::string path = writeFile("repeated.pem", caPem + "\n" + leafPem + "\n" + caPem + "\n");
+      CertificateStore plain, unique;
+      unique.setDeduplicate(true);
+
+      ASSERT_EQ(plain.loadPemBundle(path), 3);
+      ASSERT_EQ(unique.loadPemBundle(path), 2);
+      ASSERT_EQ(unique.loadPemBundle(path), 0);
+      ASSERT_FALSE(unique.addCertificate(Certificate(leafPem)));
+      ASSERT_TRUE(unique.addCertificate(Certificate(intermediatePem)));
+      ASSERT_EQ(unique.size(), 3);
+
+      /* a batch is published as a single version */
+      std::vector<Certificate> batch;
+      batch.push_back(Certificate(leafPem));
+      batch.push_back(Certificate(caPem));
+      batch.push_back(Certificate(leafPem));
+      unsigned long generation = plain.getGeneration();
+      ASSERT_EQ(plain.addCertificates(batch), 3);
+      ASSERT_EQ(plain.getGeneration(), generation + 1);
+      ASSERT_EQ(plain.size(), 6);
+      ASSERT_EQ(unique.addCertificates(batch), 0);
+    }
+
+    /**
+     * @brief Tests that a malformed certificate rejects the whole bundle
+     */
+    void testMalformedBundle() {
+      CertificateStore store;
+      std::string broken = "-----BEGIN CERTIFICATE-----\nMIIC4zCC*AcsCCQ\n-----END CERTIFICATE-----\n";
+      std::string unterminated = "-----BEGIN CERTIFICATE-----\nMIIC4zCCAcsCCQ\n";
+
+      ASSERT_THROW(store.loadPemBundle(writeFile("broken.pem", caPem + "\n" + broken)), EncodeException);
+      ASSERT_THROW(store.loadPemBundle(writeFile("unterminated.pem", caPem + "\n" + unterminated)), EncodeException);
+      ASSERT_THROW(store.loadPemBundle(dir + "/missing.pem"), EncodeException);
+      ASSERT_EQ(store.size(), 0);
+    }
+
+    /**
+     * @brief Tests the parallel decoding of a large bundle
+     */
+    void testParallelLoad() {
+      std::string bundle;
+      for (int i = 0; i < 300; i++) {
+        bundle += (i % 3 == 0 ? caPem : (i % 3 == 1 ? intermediatePem : leafPem)) + "\n";
+      }
+      std::string path = writeFile("large.pem", bundle);
+      CertificateStore sequential, parallel;
+      sequential.setThreads(1);
+      parallel.setThreads(4);
+
+      ASSERT_EQ(sequential.loadPemBundle(path), 300);
+      ASSERT_EQ(parallel.loadPemBundle(path), 300);
+
+      std::vector<Certificate *> first = sequential.getCertificates();
+      std::vector<Certificate *> second = parallel.getCertificates();
+      for (unsigned int i = 0; i < first.size(); i++) {
+        ASSERT_TRUE(*first[i] == *second[i]);
+      }
+      freeCertificates(first);
+      freeCertificates(second);
+    }
+
+    /**
+     * @brief Tests loading a directory with PEM, concatenated DER and unrelated files
+     */
+    void testLoadDirectory() {
+      CertificateStore store;
+      /* text before the PEM block that starts with '0', the same byte as a DER SEQUENCE */
+      writeFile("ca.pem", "0 root certificate\n" + caPem);
+      writeFile("chain.der", der(intermediatePem) + der(leafPem));
+      writeFile("notes.txt", "nothing to see here");
+      writeFile(".hidden.pem", caPem);
+
+      ASSERT_EQ(store.loadDirectory(dir), 3);
+      ASSERT_THROW(store.loadDirectory(dir + "/missing"), EncodeException);
+    }
+
+    /**
+     * @brief Issues a certificate with Subject and Authority Key Identifier extensions
+     */
+    X509 *issue(std::string subject, X509 *issuer, EVP_PKEY *subjectKey, EVP_PKEY *issuerKey, long serial) {
+      X509 *cert = X509_new();
+      X509V3_CTX ctx;
+      X509_EXTENSION *ext;
+
+      X509_set_version(cert, 2);
+      ASN1_INTEGER_set(X509_get_serialNumber(cert), serial);
+      X509_NAME_add_entry_by_txt(X509_get_subject_name(cert), "CN", MBSTRING_ASC, (const unsigned char *) subject.c_str(), -1, -1, 0);
+      X509_set_issuer_name(cert, issuer ? X509_get_subject_name(issuer) : X509_get_subject_name(cert));
+      X509_gmtime_adj(X509_getm_notBefore(cert), -3600);
+      X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+      X509_set_pubkey(cert, subjectKey);
+      X509V3_set_ctx(&ctx, issuer ? issuer : cert, cert, NULL, NULL, 0);
+      ext = X509V3_EXT_conf_nid(NULL, &ctx, NID_subject_key_identifier, (char *) "hash");
+      X509_add_ext(cert, ext, -1);
+      X509_EXTENSION_free(ext);
+      if (issuer) {
+        ext = X509V3_EXT_conf_nid(NULL, &ctx, NID_authority_key_identifier, (char *) "keyid:always");
+        X509_add_ext(cert, ext, -1);
+        X509_EXTENSION_free(ext);
+      }
+      X509_sign(cert, issuerKey, EVP_sha256());
+      return cert;
+    }
+
+    EVP_PKEY *newKey() {
+      EVP_PKEY *key = EVP_PKEY_new();
+      EC_KEY *eckey = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+      EC_KEY_generate_key(eckey);
+      EVP_PKEY_assign_EC_KEY(key, eckey);
+      return key;
+    }
+
+    /**
+     * @brief Tests the subject, issuer and serial, fingerprint and issuer indexes
+     */
+    void testIndexes() {
+      CertificateStore store;
+      Certificate ca(caPem), intermediate(intermediatePem), leaf(leafPem);
+      unsigned long generation = store.getGeneration();
+
+      store.addCertificate(ca);
+      store.addCertificate(intermediate);
+      store.addCertificate(leaf);
+      ASSERT_EQ(store.getGeneration(), generation + 3);
+      ASSERT_TRUE(store.contains(leaf));
+
+      RDNSequence subject = intermediate.getSubject();
+      std::vector<Certificate *> found = store.findBySubject(subject);
+      ASSERT_EQ(found.size(), 1);
+      ASSERT_TRUE(*found[0] == intermediate);
+      freeCertificates(found);
+
+      RDNSequence issuer = leaf.getIssuer();
+      Certificate *bySerial = store.findByIssuerAndSerial(issuer, leaf.getSerialNumberBigInt());
+      ASSERT_TRUE(bySerial != NULL);
+      ASSERT_TRUE(*bySerial == leaf);
+      delete bySerial;
+      ASSERT_TRUE(store.findByIssuerAndSerial(issuer, BigInteger(12345L)) == NULL);
+
+      ByteArray fingerprint = ca.getFingerPrint(MessageDigest::SHA256);
+      Certificate *byFingerprint = store.findByFingerPrint(fingerprint);
+      ASSERT_TRUE(byFingerprint != NULL);
+      ASSERT_TRUE(*byFingerprint == ca);
+      delete byFingerprint;
+
+      found = store.findIssuers(leaf);
+      ASSERT_EQ(found.size(), 1);
+      ASSERT_TRUE(*found[0] == intermediate);
+      freeCertificates(found);
+
+      found = store.findIssuers(intermediate);
+      ASSERT_EQ(found.size(), 1);
+      ASSERT_TRUE(*found[0] == ca);
+      freeCertificates(found);
+    }
+
+    /**
+     * @brief Tests the key identifier index and the issuer lookup through the Authority Key Identifier
+     */
+    void testKeyIdentifiers() {
+      CertificateStore store;
+      EVP_PKEY *rootKey = newKey(), *oldKey = newKey(), *leafKey = newKey();
+      X509 *root = issue("Root", NULL, rootKey, rootKey, 1);
+      /* a second CA with the same name but another key must not be taken as the issuer */
+      X509 *rolledOver = issue("Root", NULL, oldKey, oldKey, 2);
+      X509 *leaf = issue("Leaf", root, leafKey, rootKey, 3);
+      Certificate rootCert(root), rolledOverCert(rolledOver), leafCert(leaf);
+
+      store.addCertificate(rolledOverCert);
+      store.addCertificate(rootCert);
+
+      ByteArray keyIdentifier(ASN1_STRING_get0_data(X509_get0_subject_key_id(root)),
+          ASN1_STRING_length(X509_get0_subject_key_id(root)));
+      std::vector<Certificate *> found = store.findByKeyIdentifier(keyIdentifier);
+      ASSERT_EQ(found.size(), 1);
+      ASSERT_TRUE(*found[0] == rootCert);
+      freeCertificates(found);
+
+      found = store.findIssuers(leafCert);
+      ASSERT_EQ(found.size(), 1);
+      ASSERT_TRUE(*found[0] == rootCert);
+      freeCertificates(found);
+
+      EVP_PKEY_free(rootKey);
+      EVP_PKEY_free(oldKey);
+      EVP_PKEY_free(leafKey);
+    }
+
+    /**
+     * @brief Tests lookups running while another thread keeps publishing new versions
+     */
+    void testConcurrentReaders() {
+      CertificateStore store;
+      Certificate ca(caPem), intermediate(intermediatePem), leaf(leafPem);
+      std::vector<std::thread> readers;
+      std::vector<int> failures(4, 0);
+      store.addCertificate(ca);
+      store.addCertificate(intermediate);
+
+      for (int i = 0; i < 4; i++) {
+        readers.push_back(std::thread([&store, &leaf, &failures, i]() {
+          for (int j = 0; j < 500; j++) {
+            std::vector<Certificate *> found = store.findIssuers(leaf);
+            if (found.size() != 1) {
+              failures[i]++;
+            }
+            for (unsigned int k = 0; k < found.size(); k++) {
+              delete found[k];
+            }
+          }
+        }));
+      }
+      for (int j = 0; j < 200; j++) {
+        store.addCertificate(leaf);
+      }
+      for (unsigned int i = 0; i < readers.size(); i++) {
+        readers[i].join();
+      }
+      for (unsigned int i = 0; i < failures.size(); i++) {
+        ASSERT_EQ(failures[i], 0);
+      }
+      ASSERT_EQ(store.size(), 202);
+    }
+
+    std::string dir;
+    std::vector<std::string> created;
+    static std::string caPem;
+    static std::string intermediatePem;
+    static std::string leafPem;
+};
+
+/*
+ * Initialization of variables used in the tests
+ */
+
+std::string CertificateStoreTest::caPem = "-----BEGIN CERTIFICATE-----" "\n"
+"MIIC4zCCAcsCCQDrfn+TvOi8KzANBgkqhkiG9w0BAQ0FADAoMSYwJAYDVQQDDB1U" "\n"
+"cnVzdGVkIENlcnRpZmljYXRlIEF1dGhvcml0eTAgFw0wMDAxMDEwMDAwMDBaGA8y" "\n"
+"MTAwMDEwMTAwMDAwMFowKDEmMCQGA1UEAwwdVHJ1c3RlZCBDZXJ0aWZpY2F0ZSBB" "\n"
+"dXRob3JpdHkwggEiMA0GCSqGSIb3DQEBAQUAA4IBDwAwggEKAoIBAQDTp8YbJmUZ" "\n"
+"JgwkRGICuAJpn1e7lEaf/9lHzmJGYbe+5zjE9YJxlqWbxRRERw5AsRsze0ittE5X" "\n"
+"0/hVQ74AMcWt+M5h2geKpdEUBXXXtJPG7R4825NHw6B65TdLJ9UB64Qd/za8uJnR" "\n"
+"Ym/9ZIe0tGDSvOtR9tJ5CuBkrWEDT6+76O/E7Clz1is3XznI1OFTVy+98nn7/fft" "\n"
+"84GY4RpIYskmJqIrk2SHAGB02X4UCxw3bmgBOHDJbmMQZE54U2jjwWFnvC3E8/tF" "\n"
+"kiMEd4aTaU6axl/mzLJoLzVHgDFTnuo9NES4mxZ4sNikk0FMzS5JarMFRFUNdr3m" "\n"
+"wCJ9c3j4iYDbAgMBAAGjEzARMA8GA1UdEwEB/wQFMAMBAf8wDQYJKoZIhvcNAQEN" "\n"
+"BQADggEBAATfZ1GwI3lbzPQ7ykkGg2u9gIC/6yUCarz5snvntIPInH6IbOpWWXYZ" "\n"
+"liPZKOItqR6APGiCxLswsWY6zwNlQelmXDZnnFXfHIhWjcOM9Cb0Be9w6elX+/8e" "\n"
+"Wp/N2JruLdf30MS4uXxQmpgR6+pcOUG73oqItOl3HTtcNRmKcX+SIgJB2dy5ELO2" "\n"
+"X1m6fVkiA021W1AI78YOGAzKhwQmUp4IRTMW0iK3FUDYGRO8FW3hZJMn+hM6MRe4" "\n"
+"sFUaRkiuisix2O5zGsV/UvC0oWbIs7umXLoYoe0AM88MHf4kpIq15lq6X6k1JAii" "\n"
+"DFOVgLYzxzmV2SMJ/NlZeB4S0VGm85E=" "\n"
+"-----END CERTIFICATE-----";
+
+std::string CertificateStoreTest::intermediatePem = "-----BEGIN CERTIFICATE-----" "\n"
+"MIIC8DCCAdgCCQCZY9E6IL8aazANBgkqhkiG9w0BAQ0FADAoMSYwJAYDVQQDDB1U" "\n"
+"cnVzdGVkIENlcnRpZmljYXRlIEF1dGhvcml0eTAgFw0wMDAxMDEwMDAwMDBaGA8y" "\n"
+"MTAwMDEwMTAwMDAwMFowNTEzMDEGA1UEAwwqVHJ1c3RlZCBJbnRlcm1lZGlhdGUg" "\n"
+"Q2VydGlmaWNhdGUgQXV0aG9yaXR5MIIBIjANBgkqhkiG9w0BAQEFAAOCAQ8AMIIB" "\n"
+"CgKCAQEAvv4WARioU+x8meSQBqD8IlG5bLNXlBLocVSOwoHU6gGIdUbiU2vQiGIM" "\n"
+"C1NGRztyjtmPGcH+93XdcjcWo/4Pya/A+DcZY/B6bHZCNkW0Ox95VrZWJrEP3EgZ" "\n"
+"GcuTx+Z+8b6xCP2s8ZMc6XU6aCnedfht1BTIVelaGOrZk5EeltWu6KqtQXDcaJ8O" "\n"
+"ncUW05zfke6A5KaDhyzuUpdQxJiJ7gxkoEAwwU0VeD7TIXZtDR/QhSZ/UYvPfvqO" "\n"
+"RUBLpZJ2EzOvVxQBmGadnNcvYdPtzvp7bibJiOCGxc2OgCQ8OVZ3CmhwGZ7q4SMn" "\n"
+"qQooAWqkUv6osVCgI8oCwDCp8+ZIQwIDAQABoxMwETAPBgNVHRMBAf8EBTADAQH/" "\n"
+"MA0GCSqGSIb3DQEBDQUAA4IBAQBJiDMri0naQ6T96XiPVdbmmm4vbw0DP2mKhCc9" "\n"
+"unvHOALLkcD2webJLrYb8GwYrg6KIriERBjxQKUV+0CuLbRblqHmfIggfFfKR0tw" "\n"
+"QfKfqggeq3X/0kOBHLPKsJUbB0KgLpsCJ0rfv5y6gZUpEf1Gr2Ytyj03YArsF4Cs" "\n"
+"fiEnPU3mDVN5Nql6Usvv6AR5DjWyPxos0zyvtGfAwN9dCTL3PQwd3p5pHRJs6Z65" "\n"
+"c9c0zDD/ludNQzIkFU2ZXbv20vru6xTzLP6sHJ5i8nqQQ/x053U3B+xTnZwOD1XG" "\n"
+"KHnX4A61PKSJo1hGD1+5wKD02zDO1SCXj3L5Hf4+XmHM4vxB" "\n"
+"-----END CERTIFICATE-----";
+
+std::string CertificateStoreTest::leafPem = "-----BEGIN CERTIFICATE-----" "\n"
+"MIICzjCCAbYCCQCELgBb5E+vFTANBgkqhkiG9w0BAQ0FADA1MTMwMQYDVQQDDCpU" "\n"
+"cnVzdGVkIEludGVybWVkaWF0ZSBDZXJ0aWZpY2F0ZSBBdXRob3JpdHkwIBcNMDAw" "\n"
+"MTAxMDAwMDAwWhgPMjEwMDAxMDEwMDAwMDBaMBsxGTAXBgNVBAMMEFRydXN0ZWQg" "\n"
+"T3BlcmF0b3IwggEiMA0GCSqGSIb3DQEBAQUAA4IBDwAwggEKAoIBAQC4qpnqD1ts" "\n"
+"+I9pYmlSvoxZgK2f+6+8sqQGjOECvdw/kpFnLERHcDRvLfuhIpD+Yqv52loBUb6Z" "\n"
+"LdnL6ZAfSXO5l4FXYZiGaf/s04l8x6PLGTtEFaDHlJz7ZtGM2voyyKe7ZgAtjL6L" "\n"
+"F60VFi5Z8CjZ+KS1Bd0K3zqGtXtsudVQneyAL7LwtHCCDI6kyyK/22SwGbu16ea4" "\n"
+"XOLnYz+lJ3KfKr6X2nZiWnmd00iengSo5vkCdQkNbTOLNqupuWGciDOjd7vV2geg" "\n"
+"HCT+O+Vfg4bTXOSj3Zrr6jk3KcTmyCT5qI7jvFmS0IlXgSOxUnN261u/PC4QZ3yJ" "\n"
+"YP3rxtgiin5TAgMBAAEwDQYJKoZIhvcNAQENBQADggEBAKeNKVk6aW2SCO1fnulV" "\n"
+"u3yHB8o0zg2UsRGyASmxC0p2vM9A2ztg8FyYYagUBxjQuyJfUvHZa6G52T1lz/As" "\n"
+"iMtX4lcurlzPKdpm8SlaCHwkkzp/+PUWZDvYiYyQeNU+nRE2WB3YS2K9JniSv6gM" "\n"
+"QYW4iTdS50k4EodmsZNBe8tJRMAHNB0R4G0qVRWiBvQ6vVT6AX5Dos3qR/dYunmX" "\n"
+"21KmcML2yUWqkMOMFUQUZ0/guoOXdNwhiUGjwEqT/11YRJwtJkMapP85sbuSJX9c" "\n"
+"7705E7OxdBsTLPCjOS3SyceKBZ8h0gSpMYwlxyylKUV7Vu4vsKSpskiP8pSa3yD0" "\n"
+"Kns=" "\n"
+"-----END CERTIFICATE-----";
+
+TEST_F(CertificateStoreTest, LoadPemBundle) {
+  testLoadPemBundle();
+}
+
+TEST_F(CertificateStoreTest, Deduplicate) {
+  testDeduplicate();
+}
+
+TEST_F(CertificateStoreTest, MalformedBundle) {
+  testMalformedBundle();
+}
+
+TEST_F(CertificateStoreTest, ParallelLoad) {
+  testParallelLoad();
+}
+
+TEST_F(CertificateStoreTest, LoadDirectory) {
+  testLoadDirectory();
+}
+
+TEST_F(CertificateStoreTest, Indexes) {
+  testIndexes();
+}
+
+TEST_F(CertificateStoreTest, KeyIdentifiers) {
+  testKeyIdentifiers();
+}
+
+TEST_F(CertificateStoreTest, ConcurrentReaders) {
+  testConcurrentReaders();
+}
@@ -1,9 +1,12 @@
 #include <libcryptosec/certificate/CertificateBuilder.h>
 #include <libcryptosec/certificate/CertificateRequest.h>
+#include <libcryptosec/certificate/JsonWriter.h>
+#include <libcryptosec/certificate/XmlWriter.h>
 #include <libcryptosec/RSAKeyPair.h>
 #include <libcryptosec/ECDSAKeyPair.h>
 
 #include <sstream>
+#include <thread>
 #include <gtest/gtest.h>
 
 
@@ -284,6 +287,83 @@ protected:
         checkKeyUsage(kuExt);
     }
 
+    void checkTypedExtensions(Certificate *cert)
+    {
+        ASSERT_TRUE(cert->hasExtension(Extension::BASIC_CONSTRAINTS));
+        ASSERT_TRUE(cert->hasExtension(Extension::KEY_USAGE));
+        ASSERT_FALSE(cert->hasExtension(Extension::SUBJECT_ALTERNATIVE_NAME));
+
+        /* the second call returns a copy of the cached extension */
+        for (int i = 0; i < 2; i++)
+        {
+            BasicConstraintsExtension bcExt = cert->getBasicConstraints();
+            KeyUsageExtension kuExt = cert->getKeyUsage();
+
+            checkBasicConstraints(&bcExt);
+            checkKeyUsage(&kuExt);
+            ASSERT_EQ(bcExt.getObjectIdentifier().getOid(), basicConstraintsOID);
+        }
+
+        ASSERT_THROW(cert->getSubjectAlternativeName(), CertificationException);
+        ASSERT_THROW(cert->getAuthorityKeyIdentifier(), CertificationException);
+
+        /* a copy of the certificate has its own index */
+        Certificate copy(*cert);
+        ASSERT_TRUE(copy.getBasicConstraints().isCa());
+    }
+
+    void checkConcurrentTypedExtensions(Certificate *cert)
+    {
+        std::vector<std::thread> threads;
+        std::vector<int> failures(4, 0);
+        Certificate shared(*cert);
+
+        for (int i = 0; i < 4; i++)
+        {
+            threads.push_back(std::thread([&shared, &failures, i]() {
+                for (int j = 0; j < 200; j++)
+                {
+                    if (!shared.getBasicConstraints().isCa() || !shared.hasExtension(Extension::KEY_USAGE)
+                            || shared.getKeyUsage().getUsage(KeyUsageExtension::KEY_CERT_SIGN))
+                    {
+                        failures[i]++;
+                    }
+                }
+            }));
+        }
+        for (unsigned int i = 0; i < threads.size(); i++)
+        {
+            threads[i].join();
+        }
+
+        for (unsigned int i = 0; i < failures.size(); i++)
+        {
+            ASSERT_EQ(failures[i], 0);
+        }
+    }
+
+    void checkWrite(Certificate* cert)
+    {
+        std::ostringstream json, xml;
+        JsonWriter jsonWriter(json);
+        XmlWriter xmlWriter(xml);
+
+        cert->write(jsonWriter);
+        ASSERT_EQ(json.str().find("{\"certificate\":{\"tbsCertificate\":{\"version\":2,\"serialNumber\":\"15894509802312198289\","), 0);
+        ASSERT_NE(json.str().find("\"validity\":{\"notBefore\":\"2017-02-23T22:45:07Z\",\"notAfter\":\"2022-10-06T22:45:07Z\"}"), std::string::npos);
+        ASSERT_NE(json.str().find("\"subject\":[{\"type\":\"countryName\",\"value\":\"BR\"}"), std::string::npos);
+        ASSERT_NE(json.str().find("{\"type\":\"commonName\",\"value\":\"" + rdnSubjectCommonName + "\"}]"), std::string::npos);
+        ASSERT_NE(json.str().find("\"critical\":false,\"extnValue\":{\"ca\":true,\"pathLenConstraint\":2}"), std::string::npos);
+        ASSERT_NE(json.str().find("\"digitalSignature\":true"), std::string::npos);
+        ASSERT_NE(json.str().find("\"dataEncipherment\":true"), std::string::npos);
+        ASSERT_EQ(json.str().substr(json.str().size() - 3), "\"}}");
+
+        cert->write(xmlWriter);
+        ASSERT_EQ(xml.str().find("<?xml version=\"1.0\"?>\n<certificate>\n\t<tbsCertificate>\n\t\t<version>2</version>\n"), 0);
+        ASSERT_NE(xml.str().find("\t\t<extensions>\n\t\t\t<extension>\n\t\t\t\t<extnID>basicConstraints</extnID>\n"), std::string::npos);
+        ASSERT_EQ(xml.str().substr(xml.str().size() - 15), "</certificate>\n");
+    }
+
     void checkSignature(Certificate* cert)
     {
         PublicKey *pubKey;
@@ -510,6 +590,20 @@ TEST_F(CertificateTest, Extension) {
     getExtension(certificate);
 }
 
+/**
+ * @brief Tests the typed Extension accessors of a Certificate
+ */
+TEST_F(CertificateTest, TypedExtensions) {
+    checkTypedExtensions(certificate);
+}
+
+/**
+ * @brief Tests the typed Extension accessors from several threads
+ */
+TEST_F(CertificateTest, ConcurrentTypedExtensions) {
+    checkConcurrentTypedExtensions(certificate);
+}
+
 /**
  * @brief Tests verifying the signature from a Certificate
  */
@@ -604,4 +698,11 @@ TEST_F(CertificateTest, OperatorNotEqual) {
     Certificate newCert = midCert;
 
     ASSERT_FALSE(midCert != newCert);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Tests writing the Certificate fields to JSON and XML documents
+ */
+TEST_F(CertificateTest, Write) {
+    checkWrite(certificate);
+}
@@ -0,0 +1,216 @@
+#include <libcryptosec/certificate/CertificateView.h>
+#include <libcryptosec/MappedFile.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe CertificateView
+ */
+class CertificateViewTest : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+      caCert = new Certificate(caPem);
+      leafCert = new Certificate(leafPem);
+      caDer = caCert->getDerEncoded();
+      leafDer = leafCert->getDerEncoded();
+    }
+
+    virtual void TearDown() {
+      delete caCert;
+      delete leafCert;
+    }
+
+    /**
+     * @brief Checks that every decoded field of the view matches the fully parsed certificate
+     */
+    void checkSameFields(CertificateView &view, Certificate &cert) {
+      ASSERT_EQ(view.getVersion(), cert.getVersion());
+      ASSERT_EQ(view.getSerialNumberBigInt().toHex(), cert.getSerialNumberBigInt().toHex());
+      ASSERT_EQ(view.getIssuer().getXmlEncoded(), cert.getIssuer().getXmlEncoded());
+      ASSERT_EQ(view.getSubject().getXmlEncoded(), cert.getSubject().getXmlEncoded());
+      ASSERT_EQ(view.getIssuerHash(), X509_issuer_name_hash(cert.getX509()));
+      ASSERT_EQ(view.getSubjectHash(), X509_subject_name_hash(cert.getX509()));
+      ASSERT_EQ(view.getNotBefore().getDateTime(), cert.getNotBefore().getDateTime());
+      ASSERT_EQ(view.getNotAfter().getDateTime(), cert.getNotAfter().getDateTime());
+      ASSERT_EQ(view.getFingerPrint(MessageDigest::SHA256), cert.getFingerPrint(MessageDigest::SHA256));
+    }
+
+    /**
+     * @brief Tests the decoded fields of a certificate with extensions
+     */
+    void testFields() {
+      CertificateView view(caDer);
+      checkSameFields(view, *caCert);
+      ASSERT_EQ(view.getEncodedLength(), caDer.size());
+      ASSERT_TRUE(view.hasField(CertificateView::EXTENSIONS));
+      ASSERT_FALSE(view.hasField(CertificateView::ISSUER_UNIQUE_ID));
+    }
+
+    /**
+     * @brief Tests a certificate without extensions
+     */
+    void testWithoutExtensions() {
+      CertificateView view(leafDer);
+      checkSameFields(view, *leafCert);
+      ASSERT_FALSE(view.hasField(CertificateView::EXTENSIONS));
+      ASSERT_THROW(view.getFieldDerEncoded(CertificateView::EXTENSIONS), CertificationException);
+    }
+
+    /**
+     * @brief Tests that fields point into the input buffer instead of copies
+     */
+    void testZeroCopy() {
+      CertificateView view(caDer);
+      unsigned long length;
+      const unsigned char *spki = view.getField(CertificateView::SUBJECT_PUBLIC_KEY_INFO, length);
+      PublicKey *key = view.getPublicKey();
+      PublicKey *expected = caCert->getPublicKey();
+      ByteArray keyDer = expected->getDerEncoded();
+
+      ASSERT_TRUE(spki >= caDer.getDataPointer());
+      ASSERT_TRUE(spki + length <= caDer.getDataPointer() + caDer.size());
+      ASSERT_EQ(ByteArray(spki, length), keyDer);
+      ASSERT_EQ(key->getDerEncoded(), keyDer);
+
+      delete key;
+      delete expected;
+    }
+
+    /**
+     * @brief Tests walking a buffer of concatenated certificates
+     */
+    void testConcatenated() {
+      ByteArray both(caDer.size() + leafDer.size());
+      memcpy(both.getDataPointer(), caDer.getDataPointer(), caDer.size());
+      memcpy(both.getDataPointer() + caDer.size(), leafDer.getDataPointer(), leafDer.size());
+
+      CertificateView first(both.getDataPointer(), both.size());
+      CertificateView second(both.getDataPointer() + first.getEncodedLength(), both.size() - first.getEncodedLength());
+
+      ASSERT_EQ(first.getEncodedLength(), caDer.size());
+      ASSERT_EQ(second.getEncodedLength(), leafDer.size());
+      checkSameFields(second, *leafCert);
+    }
+
+    /**
+     * @brief Tests that truncated and malformed encodings are rejected
+     */
+    void testInvalid() {
+      ByteArray garbage(std::string("not a certificate"));
+
+      ASSERT_THROW(CertificateView(caDer.getDataPointer(), caDer.size() - 1), EncodeException);
+      ASSERT_THROW(CertificateView(caDer.getDataPointer(), 1), EncodeException);
+      ASSERT_THROW({ CertificateView view(garbage); }, EncodeException);
+      ASSERT_THROW(CertificateView(NULL, 0), EncodeException);
+    }
+
+    /**
+     * @brief Tests the conversion to a fully decoded certificate
+     */
+    void testToCertificate() {
+      CertificateView view(leafDer);
+      Certificate cert = view.toCertificate();
+      ASSERT_TRUE(cert == *leafCert);
+    }
+
+    /**
+     * @brief Tests a view over a memory mapped file
+     */
+    void testMappedFile() {
+      char path[] = "/tmp/certificateViewTestXXXXXX";
+      int fd = mkstemp(path);
+      ASSERT_GE(fd, 0);
+      ASSERT_EQ(write(fd, caDer.getDataPointer(), caDer.size()), (ssize_t) caDer.size());
+      close(fd);
+
+      {
+        MappedFile file(path);
+        CertificateView view(file.getData(), file.getSize());
+        checkSameFields(view, *caCert);
+      }
+      unlink(path);
+
+      ASSERT_THROW(MappedFile("/nonexistent/certificate.der"), EncodeException);
+    }
+
+    Certificate *caCert;
+    Certificate *leafCert;
+    ByteArray caDer;
+    ByteArray leafDer;
+    static std::string caPem;
+    static std::string leafPem;
+};
+
+/*
+ * Initialization of variables used in the tests
+ */
+
+std::string CertificateViewTest::caPem = "-----BEGIN CERTIFICATE-----" "\n"
+"MIIC4zCCAcsCCQDrfn+TvOi8KzANBgkqhkiG9w0BAQ0FADAoMSYwJAYDVQQDDB1U" "\n"
+"cnVzdGVkIENlcnRpZmljYXRlIEF1dGhvcml0eTAgFw0wMDAxMDEwMDAwMDBaGA8y" "\n"
+"MTAwMDEwMTAwMDAwMFowKDEmMCQGA1UEAwwdVHJ1c3RlZCBDZXJ0aWZpY2F0ZSBB" "\n"
+"dXRob3JpdHkwggEiMA0GCSqGSIb3DQEBAQUAA4IBDwAwggEKAoIBAQDTp8YbJmUZ" "\n"
+"JgwkRGICuAJpn1e7lEaf/9lHzmJGYbe+5zjE9YJxlqWbxRRERw5AsRsze0ittE5X" "\n"
+"0/hVQ74AMcWt+M5h2geKpdEUBXXXtJPG7R4825NHw6B65TdLJ9UB64Qd/za8uJnR" "\n"
+"Ym/9ZIe0tGDSvOtR9tJ5CuBkrWEDT6+76O/E7Clz1is3XznI1OFTVy+98nn7/fft" "\n"
+"84GY4RpIYskmJqIrk2SHAGB02X4UCxw3bmgBOHDJbmMQZE54U2jjwWFnvC3E8/tF" "\n"
+"kiMEd4aTaU6axl/mzLJoLzVHgDFTnuo9NES4mxZ4sNikk0FMzS5JarMFRFUNdr3m" "\n"
+"wCJ9c3j4iYDbAgMBAAGjEzARMA8GA1UdEwEB/wQFMAMBAf8wDQYJKoZIhvcNAQEN" "\n"
+"BQADggEBAATfZ1GwI3lbzPQ7ykkGg2u9gIC/6yUCarz5snvntIPInH6IbOpWWXYZ" "\n"
+"liPZKOItqR6APGiCxLswsWY6zwNlQelmXDZnnFXfHIhWjcOM9Cb0Be9w6elX+/8e" "\n"
+"Wp/N2JruLdf30MS4uXxQmpgR6+pcOUG73oqItOl3HTtcNRmKcX+SIgJB2dy5ELO2" "\n"
+"X1m6fVkiA021W1AI78YOGAzKhwQmUp4IRTMW0iK3FUDYGRO8FW3hZJMn+hM6MRe4" "\n"
+"sFUaRkiuisix2O5zGsV/UvC0oWbIs7umXLoYoe0AM88MHf4kpIq15lq6X6k1JAii" "\n"
+"DFOVgLYzxzmV2SMJ/NlZeB4S0VGm85E=" "\n"
+"-----END CERTIFICATE-----";
+
+std::string CertificateViewTest::leafPem = "-----BEGIN CERTIFICATE-----" "\n"
+"MIICzjCCAbYCCQCELgBb5E+vFTANBgkqhkiG9w0BAQ0FADA1MTMwMQYDVQQDDCpU" "\n"
+"cnVzdGVkIEludGVybWVkaWF0ZSBDZXJ0aWZpY2F0ZSBBdXRob3JpdHkwIBcNMDAw" "\n"
+"MTAxMDAwMDAwWhgPMjEwMDAxMDEwMDAwMDBaMBsxGTAXBgNVBAMMEFRydXN0ZWQg" "\n"
+"T3BlcmF0b3IwggEiMA0GCSqGSIb3DQEBAQUAA4IBDwAwggEKAoIBAQC4qpnqD1ts" "\n"
+"+I9pYmlSvoxZgK2f+6+8sqQGjOECvdw/kpFnLERHcDRvLfuhIpD+Yqv52loBUb6Z" "\n"
+"LdnL6ZAfSXO5l4FXYZiGaf/s04l8x6PLGTtEFaDHlJz7ZtGM2voyyKe7ZgAtjL6L" "\n"
+"F60VFi5Z8CjZ+KS1Bd0K3zqGtXtsudVQneyAL7LwtHCCDI6kyyK/22SwGbu16ea4" "\n"
+"XOLnYz+lJ3KfKr6X2nZiWnmd00iengSo5vkCdQkNbTOLNqupuWGciDOjd7vV2geg" "\n"
+"HCT+O+Vfg4bTXOSj3Zrr6jk3KcTmyCT5qI7jvFmS0IlXgSOxUnN261u/PC4QZ3yJ" "\n"
+"YP3rxtgiin5TAgMBAAEwDQYJKoZIhvcNAQENBQADggEBAKeNKVk6aW2SCO1fnulV" "\n"
+"u3yHB8o0zg2UsRGyASmxC0p2vM9A2ztg8FyYYagUBxjQuyJfUvHZa6G52T1lz/As" "\n"
+"iMtX4lcurlzPKdpm8SlaCHwkkzp/+PUWZDvYiYyQeNU+nRE2WB3YS2K9JniSv6gM" "\n"
+"QYW4iTdS50k4EodmsZNBe8tJRMAHNB0R4G0qVRWiBvQ6vVT6AX5Dos3qR/dYunmX" "\n"
+"21KmcML2yUWqkMOMFUQUZ0/guoOXdNwhiUGjwEqT/11YRJwtJkMapP85sbuSJX9c" "\n"
+"7705E7OxdBsTLPCjOS3SyceKBZ8h0gSpMYwlxyylKUV7Vu4vsKSpskiP8pSa3yD0" "\n"
+"Kns=" "\n"
+"-----END CERTIFICATE-----";
+
+TEST_F(CertificateViewTest, Fields) {
+  testFields();
+}
+
+TEST_F(CertificateViewTest, WithoutExtensions) {
+  testWithoutExtensions();
+}
+
+TEST_F(CertificateViewTest, ZeroCopy) {
+  testZeroCopy();
+}
+
+TEST_F(CertificateViewTest, Concatenated) {
+  testConcatenated();
+}
+
+TEST_F(CertificateViewTest, Invalid) {
+  testInvalid();
+}
+
+TEST_F(CertificateViewTest, ToCertificate) {
+  testToCertificate();
+}
+
+TEST_F(CertificateViewTest, MappedFile) {
+  testMappedFile();
+}
@@ -11,7 +11,7 @@ class DateTimeTest : public ::testing::Test {
 
 protected:
     virtual void SetUp() {
-
+        dt = NULL;
     }
 
     virtual void TearDown() {
@@ -292,3 +292,110 @@ TEST_F(DateTimeTest, getMonthSize) {
     ASSERT_EQ(DateTime::getMonthSize(DateTimeTest::month ,DateTimeTest::leapYear), 29);
     ASSERT_EQ(DateTime::getMonthSize(DateTimeTest::month, DateTimeTest::year), 28);
 }
+
+/**
+ * @brief Tests dates before 1970 and before 1950, which must be encoded as GeneralizedTime
+ */
+TEST_F(DateTimeTest, BeforeEpoch) {
+    DateTime::DateVal date;
+
+    dt = new DateTime((time_t) -1);
+    ASSERT_EQ(dt->getISODate(), "1969-12-31T23:59:59");
+    ASSERT_EQ(dt->getXmlEncoded(), "691231235959Z");
+
+    date = DateTime::getDate(-1LL);
+    ASSERT_EQ(date.dayOfWeek, 3);
+    ASSERT_EQ(date.dayOfYear, 364);
+
+    *dt = DateTime((time_t) -631152001);
+    ASSERT_EQ(dt->getISODate(), "1949-12-31T23:59:59");
+    ASSERT_EQ(dt->getXmlEncoded(), "19491231235959Z");
+
+    *dt = DateTime(std::string("19000301000000Z"));
+    ASSERT_EQ(dt->getDateTime(), -2203891200);
+    ASSERT_EQ(DateTime::date2epoch(1900, 2, 1, 0, 0, 0).getValue(), -2203891200);
+}
+
+/**
+ * @brief Tests the UTCTime and GeneralizedTime limits of RFC 5280
+ */
+TEST_F(DateTimeTest, UTCTimeLimits) {
+    ASSERT_FALSE(DateTime::isUTCTime(-631152001LL));
+    ASSERT_TRUE(DateTime::isUTCTime(-631152000LL));
+    ASSERT_TRUE(DateTime::isUTCTime(2524607999LL));
+    ASSERT_FALSE(DateTime::isUTCTime(2524608000LL));
+
+    dt = new DateTime(std::string("491231235959Z"));
+    ASSERT_EQ(dt->getDateTime(), 2524607999);
+    *dt = DateTime(std::string("500101000000Z"));
+    ASSERT_EQ(dt->getDateTime(), -631152000);
+}
+
+/**
+ * @brief Tests parsing and formatting ASN.1 times without OpenSSL
+ */
+TEST_F(DateTimeTest, ParseAndFormat) {
+    const char *invalid[] = {
+        "", "1702232245Z", "170223224507", "1702232245070", "17022322450Z7",
+        "171323224507Z", "170229224507Z", "170223244507Z", "170223226007Z", "170223224561Z",
+        "20170223224507+0300", "2017022322450 Z"
+    };
+    long long epoch;
+    char date[16];
+
+    for (unsigned int i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        ASSERT_FALSE(DateTime::parseTime(invalid[i], strlen(invalid[i]), epoch)) << invalid[i];
+    }
+
+    ASSERT_TRUE(DateTime::parseTime("200229000000Z", 13, epoch));
+    ASSERT_EQ(epoch, 1582934400);
+    ASSERT_TRUE(DateTime::parseTime("161231235960Z", 13, epoch));
+    ASSERT_EQ(epoch, 1483228800);
+
+    for (epoch = -62135596800LL; epoch < 253402300800LL; epoch += 86399LL * 97) {
+        long long parsed;
+        bool utcTime = DateTime::isUTCTime(epoch);
+
+        ASSERT_EQ(DateTime::formatTime(epoch, utcTime, date), utcTime ? 13u : 15u);
+        ASSERT_TRUE(DateTime::parseTime(date, strlen(date), parsed)) << date;
+        ASSERT_EQ(parsed, epoch) << date;
+    }
+
+    ASSERT_THROW(DateTime::formatTime(-62167219201LL, false, date), EncodeException);
+    ASSERT_EQ(DateTime::formatTime(-62167219200LL, false, date), 15u);
+    ASSERT_STREQ(date, "00000101000000Z");
+    ASSERT_THROW(DateTime::formatTime(253402300800LL, false, date), EncodeException);
+    ASSERT_THROW(DateTime::formatTime(2524608000LL, true, date), EncodeException);
+    ASSERT_THROW(DateTime::formatTime(-631152001LL, true, date), EncodeException);
+    ASSERT_EQ(DateTime::formatTime(-631152001LL, false, date), 15u);
+
+    ASSERT_THROW(DateTime(std::string("1702232245Z")), EncodeException);
+    ASSERT_THROW(DateTime::date2epoch(std::string("20170223224507+0300")), EncodeException);
+}
+
+/**
+ * @brief Tests creation from a NULL ASN1_TIME and from times OpenSSL accepts but DER does not
+ */
+TEST_F(DateTimeTest, ASN1TimeFallback) {
+    ASN1_TIME *asn1time = ASN1_TIME_new();
+
+    dt = new DateTime((ASN1_TIME *) NULL);
+    ASSERT_EQ(dt->getDateTime(), 0);
+
+    ASN1_STRING_set(asn1time, "1702232245Z", 11);
+    asn1time->type = V_ASN1_UTCTIME;
+    *dt = DateTime(asn1time);
+    ASSERT_EQ(dt->getDateTime(), epoch - sec);
+
+    /* o tamanho de um GeneralizedTime com o tipo de UTCTime não pode ser lido como GeneralizedTime */
+    ASN1_STRING_set(asn1time, "20170223224507Z", 15);
+    asn1time->type = V_ASN1_UTCTIME;
+    *dt = DateTime(asn1time);
+    ASSERT_NE(dt->getDateTime(), epoch);
+
+    asn1time->type = V_ASN1_GENERALIZEDTIME;
+    *dt = DateTime(asn1time);
+    ASSERT_EQ(dt->getDateTime(), epoch);
+
+    ASN1_TIME_free(asn1time);
+}
@@ -0,0 +1,332 @@
+#include <libcryptosec/certificate/DerWriter.h>
+#include <libcryptosec/certificate/AuthorityInformationAccessExtension.h>
+#include <libcryptosec/certificate/AuthorityKeyIdentifierExtension.h>
+#include <libcryptosec/certificate/BasicConstraintsExtension.h>
+#include <libcryptosec/certificate/CRLDistributionPointsExtension.h>
+#include <libcryptosec/certificate/CertificatePoliciesExtension.h>
+#include <libcryptosec/certificate/ExtendedKeyUsageExtension.h>
+#include <libcryptosec/certificate/KeyUsageExtension.h>
+#include <libcryptosec/certificate/SubjectAlternativeNameExtension.h>
+#include <libcryptosec/certificate/SubjectKeyIdentifierExtension.h>
+
+#include <climits>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe DerWriter
+ */
+class DerWriterTest : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+    }
+
+    virtual void TearDown() {
+    }
+
+    static std::string toString(ByteArray value) {
+      return std::string((const char *) value.getDataPointer(), value.size());
+    }
+
+    template <class T>
+    static std::string encode(T *object, int (*i2d)(const T *, unsigned char **)) {
+      unsigned char *data = NULL;
+      int length = i2d(object, &data);
+      std::string ret((const char *) data, length > 0 ? length : 0);
+      OPENSSL_free(data);
+      return ret;
+    }
+
+    /* what the extension encoded with the OpenSSL structures looks like */
+    static std::string reference(int nid, bool critical, void *value) {
+      X509_EXTENSION *ext = X509V3_EXT_i2d(nid, critical ? 1 : 0, value);
+      std::string ret = encode(ext, i2d_X509_EXTENSION);
+      X509_EXTENSION_free(ext);
+      return ret;
+    }
+
+    static std::string encoded(Extension &extension) {
+      X509_EXTENSION *ext = extension.getX509Extension();
+      std::string ret = encode(ext, i2d_X509_EXTENSION);
+      X509_EXTENSION_free(ext);
+      EXPECT_EQ(ret, toString(extension.getDerEncoded()));
+      return ret;
+    }
+
+    GeneralNames genGeneralNames() {
+      GeneralNames ret;
+      GeneralName otherName, email, dns, directory, uri, ip, registered;
+      RDNSequence name;
+
+      otherName.setOtherName("1.3.6.1.4.1.311.20.2.3", "leaf@example");
+      email.setRfc822Name("leaf@example");
+      dns.setDnsName("leaf.example");
+      name.addEntry(RDNSequence::COUNTRY, "BR");
+      name.addEntry(RDNSequence::ORGANIZATION, "Example");
+      name.addEntry(RDNSequence::COMMON_NAME, "Leaf");
+      directory.setDirectoryName(name);
+      uri.setUniformResourceIdentifier(std::string(200, 'u'));
+      ip.setIpAddress("10.0.255.1");
+      registered.setRegisteredId(ObjectIdentifierFactory::getObjectIdentifier("1.2.3.4.5"));
+
+      ret.addGeneralName(otherName);
+      ret.addGeneralName(email);
+      ret.addGeneralName(dns);
+      ret.addGeneralName(directory);
+      ret.addGeneralName(uri);
+      ret.addGeneralName(ip);
+      ret.addGeneralName(registered);
+      return ret;
+    }
+
+    /**
+     * @brief Tests the primitive encodings against OpenSSL
+     */
+    void testPrimitives() {
+      long integers[] = {0, 1, 127, 128, 255, 256, 65535, -1, -128, -129, -32768, LONG_MAX, LONG_MIN};
+      for (unsigned int i = 0; i < sizeof(integers) / sizeof(integers[0]); i++) {
+        DerWriter writer;
+        ASN1_INTEGER *integer = ASN1_INTEGER_new();
+
+        writer.writeInteger(integers[i]);
+        ASSERT_TRUE(writer.startWriting());
+        writer.writeInteger(integers[i]);
+        ASN1_INTEGER_set(integer, integers[i]);
+        ASSERT_EQ(toString(writer.getEncoded()), encode(integer, i2d_ASN1_INTEGER)) << integers[i];
+        ASN1_INTEGER_free(integer);
+      }
+
+      for (unsigned int value = 0; value < 512; value++) {
+        DerWriter writer;
+        ASN1_BIT_STRING *bitString = ASN1_BIT_STRING_new();
+        bool bits[9];
+
+        for (int i = 0; i < 9; i++) {
+          bits[i] = (value >> i) & 1;
+          ASN1_BIT_STRING_set_bit(bitString, i, bits[i] ? 1 : 0);
+        }
+        writer.writeBitString(bits, 9);
+        ASSERT_TRUE(writer.startWriting());
+        writer.writeBitString(bits, 9);
+        ASSERT_EQ(toString(writer.getEncoded()), encode(bitString, i2d_ASN1_BIT_STRING)) << value;
+        ASN1_BIT_STRING_free(bitString);
+      }
+
+      /* short and long form lengths, nested */
+      unsigned int sizes[] = {0, 127, 128, 255, 256, 70000};
+      for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        std::string data(sizes[i], 'x');
+        DerWriter writer;
+        ASN1_OCTET_STRING *octetString = ASN1_OCTET_STRING_new();
+
+        for (int pass = 0; pass < 2; pass++) {
+          writer.begin(DerWriter::OCTET_STRING);
+          writer.writePrimitive(DerWriter::OCTET_STRING, data);
+          writer.end();
+          ASSERT_TRUE(pass == 1 || writer.startWriting());
+        }
+        ASSERT_FALSE(writer.hasFailed());
+        ASN1_OCTET_STRING_set(octetString, (const unsigned char *) data.data(), data.size());
+        std::string inner = encode(octetString, i2d_ASN1_OCTET_STRING);
+        ASN1_OCTET_STRING_set(octetString, (const unsigned char *) inner.data(), inner.size());
+        ASSERT_EQ(toString(writer.getEncoded()), encode(octetString, i2d_ASN1_OCTET_STRING)) << sizes[i];
+        ASN1_OCTET_STRING_free(octetString);
+      }
+    }
+
+    /**
+     * @brief Tests that misuse makes the encoding fail instead of writing out of the buffer
+     */
+    void testFailures() {
+      DerWriter unbalanced;
+      unbalanced.begin(DerWriter::SEQUENCE);
+      ASSERT_FALSE(unbalanced.startWriting());
+
+      DerWriter different;
+      different.writeBoolean(true);
+      ASSERT_TRUE(different.startWriting());
+      different.writePrimitive(DerWriter::OCTET_STRING, std::string(10, 'x'));
+      ASSERT_TRUE(different.hasFailed());
+
+      DerWriter empty;
+      empty.writeObject(ObjectIdentifier());
+      ASSERT_FALSE(empty.startWriting());
+    }
+
+    /**
+     * @brief Tests that every extension with its own writer matches the OpenSSL encoding
+     */
+    void testExtensions() {
+      for (int critical = 0; critical < 2; critical++) {
+        BasicConstraintsExtension basicConstraints;
+        BASIC_CONSTRAINTS *bc = BASIC_CONSTRAINTS_new();
+        basicConstraints.setCritical(critical);
+        ASSERT_EQ(encoded(basicConstraints), reference(NID_basic_constraints, critical, bc));
+        basicConstraints.setCa(true);
+        basicConstraints.setPathLen(300);
+        bc->ca = 255;
+        bc->pathlen = ASN1_INTEGER_new();
+        ASN1_INTEGER_set(bc->pathlen, 300);
+        ASSERT_EQ(encoded(basicConstraints), reference(NID_basic_constraints, critical, bc));
+        BASIC_CONSTRAINTS_free(bc);
+
+        KeyUsageExtension keyUsage;
+        ASN1_BIT_STRING *bitString = ASN1_BIT_STRING_new();
+        keyUsage.setCritical(critical);
+        keyUsage.setUsage(KeyUsageExtension::DIGITAL_SIGNATURE, true);
+        keyUsage.setUsage(KeyUsageExtension::DECIPHER_ONLY, true);
+        ASN1_BIT_STRING_set_bit(bitString, 0, 1);
+        ASN1_BIT_STRING_set_bit(bitString, 8, 1);
+        ASSERT_EQ(encoded(keyUsage), reference(NID_key_usage, critical, bitString));
+        ASN1_BIT_STRING_free(bitString);
+
+        SubjectKeyIdentifierExtension subjectKeyIdentifier;
+        ASN1_OCTET_STRING *keyId = ASN1_OCTET_STRING_new();
+        subjectKeyIdentifier.setCritical(critical);
+        subjectKeyIdentifier.setKeyIdentifier(ByteArray((const unsigned char *) "0123456789abcdefghij", 20));
+        ASN1_OCTET_STRING_set(keyId, (const unsigned char *) "0123456789abcdefghij", 20);
+        ASSERT_EQ(encoded(subjectKeyIdentifier), reference(NID_subject_key_identifier, critical, keyId));
+
+        GeneralNames names = genGeneralNames();
+        AuthorityKeyIdentifierExtension authorityKeyIdentifier;
+        AUTHORITY_KEYID *akid = AUTHORITY_KEYID_new();
+        authorityKeyIdentifier.setCritical(critical);
+        authorityKeyIdentifier.setKeyIdentifier(ByteArray((const unsigned char *) "0123456789abcdefghij", 20));
+        authorityKeyIdentifier.setAuthorityCertIssuer(names);
+        authorityKeyIdentifier.setAuthorityCertSerialNumber(40000);
+        akid->keyid = keyId;
+        akid->issuer = names.getInternalGeneralNames();
+        akid->serial = ASN1_INTEGER_new();
+        ASN1_INTEGER_set(akid->serial, 40000);
+        ASSERT_EQ(encoded(authorityKeyIdentifier), reference(NID_authority_key_identifier, critical, akid));
+        AUTHORITY_KEYID_free(akid);
+
+        ExtendedKeyUsageExtension extendedKeyUsage;
+        STACK_OF(ASN1_OBJECT) *usages = sk_ASN1_OBJECT_new_null();
+        extendedKeyUsage.setCritical(critical);
+        extendedKeyUsage.addUsage(ObjectIdentifierFactory::getObjectIdentifier(NID_server_auth));
+        extendedKeyUsage.addUsage(ObjectIdentifierFactory::getObjectIdentifier("1.3.6.1.4.1.99999.47"));
+        sk_ASN1_OBJECT_push(usages, OBJ_nid2obj(NID_server_auth));
+        sk_ASN1_OBJECT_push(usages, OBJ_txt2obj("1.3.6.1.4.1.99999.47", 1));
+        ASSERT_EQ(encoded(extendedKeyUsage), reference(NID_ext_key_usage, critical, usages));
+        sk_ASN1_OBJECT_pop_free(usages, ASN1_OBJECT_free);
+
+        SubjectAlternativeNameExtension subjectAltName;
+        GENERAL_NAMES *gns = names.getInternalGeneralNames();
+        subjectAltName.setCritical(critical);
+        subjectAltName.setSubjectAltName(names);
+        ASSERT_EQ(encoded(subjectAltName), reference(NID_subject_alt_name, critical, gns));
+        sk_GENERAL_NAME_pop_free(gns, GENERAL_NAME_free);
+
+        CRLDistributionPointsExtension crlDistributionPoints;
+        CRL_DIST_POINTS *distPoints = CRL_DIST_POINTS_new();
+        DistributionPoint withName, withIssuer;
+        DistributionPointName fullName;
+        fullName.setFullName(names);
+        withName.setDistributionPointName(fullName);
+        withIssuer.setReasonFlag(DistributionPoint::KEY_COMPROMISE, true);
+        withIssuer.setReasonFlag(DistributionPoint::CERTIFICATE_HOLD, true);
+        withIssuer.setCrlIssuer(names);
+        crlDistributionPoints.setCritical(critical);
+        crlDistributionPoints.addDistributionPoint(withName);
+        crlDistributionPoints.addDistributionPoint(withIssuer);
+        sk_DIST_POINT_push(distPoints, withName.getDistPoint());
+        sk_DIST_POINT_push(distPoints, withIssuer.getDistPoint());
+        ASSERT_EQ(encoded(crlDistributionPoints), reference(NID_crl_distribution_points, critical, distPoints));
+        CRL_DIST_POINTS_free(distPoints);
+
+        CertificatePoliciesExtension certificatePolicies;
+        CERTIFICATEPOLICIES *policies = CERTIFICATEPOLICIES_new();
+        PolicyInformation bare, qualified;
+        PolicyQualifierInfo cps, notice;
+        UserNotice userNotice;
+        std::vector<long> numbers;
+        numbers.push_back(1);
+        numbers.push_back(-200);
+        numbers.push_back(70000);
+        userNotice.setNoticeReference("Example", numbers);
+        userNotice.setExplicitText("Explicit text");
+        cps.setCpsUri("http://cps.example/");
+        notice.setUserNotice(userNotice);
+        bare.setPolicyIdentifier(ObjectIdentifierFactory::getObjectIdentifier(NID_any_policy));
+        qualified.setPolicyIdentifier(ObjectIdentifierFactory::getObjectIdentifier("1.3.6.1.4.1.99999.1.1"));
+        qualified.addPolicyQualifierInfo(cps);
+        qualified.addPolicyQualifierInfo(notice);
+        certificatePolicies.setCritical(critical);
+        certificatePolicies.addPolicyInformation(bare);
+        certificatePolicies.addPolicyInformation(qualified);
+        sk_POLICYINFO_push(policies, bare.getPolicyInfo());
+        sk_POLICYINFO_push(policies, qualified.getPolicyInfo());
+        ASSERT_EQ(encoded(certificatePolicies), reference(NID_certificate_policies, critical, policies));
+        sk_POLICYINFO_pop_free(policies, POLICYINFO_free);
+
+        AuthorityInformationAccessExtension authorityInfoAccess;
+        AUTHORITY_INFO_ACCESS *access = AUTHORITY_INFO_ACCESS_new();
+        AccessDescription ocsp, caIssuers;
+        GeneralName ocspUri, caIssuersUri;
+        ocspUri.setUniformResourceIdentifier("http://ocsp.example");
+        caIssuersUri.setUniformResourceIdentifier("http://ca.example/ca.crt");
+        ocsp.setAccessMethod(ObjectIdentifierFactory::getObjectIdentifier(NID_ad_OCSP));
+        ocsp.setAccessLocation(ocspUri);
+        caIssuers.setAccessMethod(ObjectIdentifierFactory::getObjectIdentifier(NID_ad_ca_issuers));
+        caIssuers.setAccessLocation(caIssuersUri);
+        authorityInfoAccess.setCritical(critical);
+        authorityInfoAccess.addAccessDescription(ocsp);
+        authorityInfoAccess.addAccessDescription(caIssuers);
+        sk_ACCESS_DESCRIPTION_push(access, ocsp.getAccessDescription());
+        sk_ACCESS_DESCRIPTION_push(access, caIssuers.getAccessDescription());
+        ASSERT_EQ(encoded(authorityInfoAccess), reference(NID_info_access, critical, access));
+        AUTHORITY_INFO_ACCESS_free(access);
+      }
+    }
+
+    /**
+     * @brief Tests that values the writer does not handle are still encoded by OpenSSL
+     */
+    void testFallback() {
+      CRLDistributionPointsExtension crlDistributionPoints;
+      CRL_DIST_POINTS *distPoints = CRL_DIST_POINTS_new();
+      DistributionPoint relative;
+      DistributionPointName name;
+      RDNSequence rdn;
+      rdn.addEntry(RDNSequence::COMMON_NAME, "CRL");
+      name.setNameRelativeToCrlIssuer(rdn);
+      relative.setDistributionPointName(name);
+      crlDistributionPoints.addDistributionPoint(relative);
+      sk_DIST_POINT_push(distPoints, relative.getDistPoint());
+      ASSERT_EQ(encoded(crlDistributionPoints), reference(NID_crl_distribution_points, false, distPoints));
+      CRL_DIST_POINTS_free(distPoints);
+
+      SubjectAlternativeNameExtension subjectAltName;
+      GeneralNames names;
+      GeneralName otherName;
+      otherName.setOtherName("1.3.6.1.4.1.99999.47.1", "unregistered");
+      names.addGeneralName(otherName);
+      subjectAltName.setSubjectAltName(names);
+      GENERAL_NAMES *gns = names.getInternalGeneralNames();
+      ASSERT_EQ(encoded(subjectAltName), reference(NID_subject_alt_name, false, gns));
+      sk_GENERAL_NAME_pop_free(gns, GENERAL_NAME_free);
+
+      /* extensions without a writer of their own */
+      Extension generic("1.3.6.1.4.1.99999.47.2", true, "BAMBAgM=");
+      X509_EXTENSION *ext = generic.getX509Extension();
+      ASSERT_EQ(toString(generic.getDerEncoded()), encode(ext, i2d_X509_EXTENSION));
+      X509_EXTENSION_free(ext);
+    }
+};
+
+TEST_F(DerWriterTest, Primitives) {
+  testPrimitives();
+}
+
+TEST_F(DerWriterTest, Failures) {
+  testFailures();
+}
+
+TEST_F(DerWriterTest, Extensions) {
+  testExtensions();
+}
+
+TEST_F(DerWriterTest, Fallback) {
+  testFallback();
+}
@@ -0,0 +1,129 @@
+#include <libcryptosec/ec/EllipticCurveRegistry.h>
+#include <libcryptosec/ec/BrainpoolCurveFactory.h>
+#include <libcryptosec/ECDSAKeyPair.h>
+
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe EllipticCurveRegistry
+ */
+class EllipticCurveRegistryTest : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+    }
+
+    virtual void TearDown() {
+    }
+
+    /**
+     * @brief Builds a custom curve with the same parameters as brainpoolP192r1
+     */
+    EllipticCurve customCurve(std::string name) {
+        const EllipticCurve *bp = BrainpoolCurveFactory::getSharedCurve(BrainpoolCurveFactory::BP192r1);
+        EllipticCurve curve;
+        curve.setName(name);
+        curve.setA(bp->getA());
+        curve.setB(bp->getB());
+        curve.setP(bp->getP());
+        curve.setX(bp->getX());
+        curve.setY(bp->getY());
+        curve.setOrder(bp->getOrder());
+        curve.setCofactor(bp->getCofactor());
+        return curve;
+    }
+
+    /**
+     * @brief Tests that the same parameters always map to the same precomputed group
+     */
+    void testSameGroup() {
+        EllipticCurve first = customCurve("first");
+        EllipticCurve second = customCurve("second");
+        const EC_GROUP *group = EllipticCurveRegistry::getGroup(first);
+
+        ASSERT_TRUE(group);
+        ASSERT_EQ(group, EllipticCurveRegistry::getGroup(second));
+        ASSERT_EQ(EC_GROUP_have_precompute_mult(group), 1);
+    }
+
+    /**
+     * @brief Tests that the group built by the registry matches the curve parameters
+     */
+    void testGroupParameters() {
+        const EllipticCurve *curve = BrainpoolCurveFactory::getSharedCurve(BrainpoolCurveFactory::BP256r1);
+        EC_GROUP *fresh = EllipticCurveRegistry::createGroup(*curve);
+        const EC_GROUP *shared = EllipticCurveRegistry::getGroup(*curve);
+
+        ASSERT_EQ(EC_GROUP_cmp(fresh, shared, NULL), 0);
+        ASSERT_EQ(EC_GROUP_have_precompute_mult(fresh), 0);
+        EC_GROUP_free(fresh);
+    }
+
+    /**
+     * @brief Tests the named curve groups
+     */
+    void testNamedCurve() {
+        const EC_GROUP *group = EllipticCurveRegistry::getGroup(AsymmetricKey::X962_PRIME256V1);
+
+        ASSERT_TRUE(group);
+        ASSERT_EQ(EC_GROUP_get_curve_name(group), (int) AsymmetricKey::X962_PRIME256V1);
+        ASSERT_EQ(group, EllipticCurveRegistry::getGroup(AsymmetricKey::X962_PRIME256V1));
+    }
+
+    /**
+     * @brief Tests that key pairs created from the shared group are valid keys of that curve
+     */
+    void testKeyPairWithSharedGroup() {
+        const EllipticCurve *curve = BrainpoolCurveFactory::getSharedCurve(BrainpoolCurveFactory::BP256r1);
+        ECDSAKeyPair keyPair(*curve);
+        const EC_KEY *eckey = EVP_PKEY_get0_EC_KEY(keyPair.getEvpPkey());
+
+        ASSERT_TRUE(eckey);
+        ASSERT_EQ(EC_KEY_check_key(eckey), 1);
+        ASSERT_EQ(EC_GROUP_cmp(EC_KEY_get0_group(eckey), EllipticCurveRegistry::getGroup(*curve), NULL), 0);
+    }
+
+    /**
+     * @brief Tests concurrent registration and use of the same curve
+     */
+    void testConcurrentAccess() {
+        std::vector<std::thread> threads;
+        std::vector<const EC_GROUP *> groups(8);
+        const EllipticCurve *curve = BrainpoolCurveFactory::getSharedCurve(BrainpoolCurveFactory::BP384t1);
+
+        for (unsigned int i = 0; i < groups.size(); i++) {
+            threads.push_back(std::thread([&groups, curve, i]() {
+                groups[i] = EllipticCurveRegistry::getGroup(*curve);
+                ECDSAKeyPair keyPair(*curve);
+            }));
+        }
+        for (unsigned int i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+        for (unsigned int i = 1; i < groups.size(); i++) {
+            ASSERT_EQ(groups[0], groups[i]);
+        }
+    }
+};
+
+TEST_F(EllipticCurveRegistryTest, SameGroup) {
+  testSameGroup();
+}
+
+TEST_F(EllipticCurveRegistryTest, GroupParameters) {
+  testGroupParameters();
+}
+
+TEST_F(EllipticCurveRegistryTest, NamedCurve) {
+  testNamedCurve();
+}
+
+TEST_F(EllipticCurveRegistryTest, KeyPairWithSharedGroup) {
+  testKeyPairWithSharedGroup();
+}
+
+TEST_F(EllipticCurveRegistryTest, ConcurrentAccess) {
+  testConcurrentAccess();
+}
@@ -0,0 +1,327 @@
+#include <libcryptosec/certificate/IssuanceTemplate.h>
+#include <libcryptosec/RSAKeyPair.h>
+
+#include <thread>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe IssuanceTemplate
+ */
+class IssuanceTemplateTest : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        issuer.addEntry(RDNSequence::COUNTRY, "BR");
+        issuer.addEntry(RDNSequence::ORGANIZATION, "Template Org");
+        issuer.addEntry(RDNSequence::COMMON_NAME, "Template CA");
+        subject.addEntry(RDNSequence::COUNTRY, "BR");
+        subject.addEntry(RDNSequence::COMMON_NAME, "Template Subject");
+    }
+
+    /* issuer and the extensions shared by every certificate */
+    void fillInvariant(CertificateBuilder &builder) {
+        KeyUsageExtension keyUsage;
+        BasicConstraintsExtension basicConstraints;
+
+        keyUsage.setUsage(KeyUsageExtension::DIGITAL_SIGNATURE, true);
+        keyUsage.setCritical(true);
+        basicConstraints.setCa(false);
+        builder.setIssuer(issuer);
+        builder.addExtension(keyUsage);
+        builder.addExtension(basicConstraints);
+    }
+
+    /**
+     * @brief Tests that the template gives the same encoding as CertificateBuilder with the same content
+     */
+    void testSameAsBuilder() {
+        CertificateBuilder invariant, builder;
+        SubjectKeyIdentifierExtension keyIdentifier;
+        std::vector<Extension *> extensions;
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+        BigInteger serial(serialNumber);
+        Certificate *cert;
+
+        fillInvariant(invariant);
+        IssuanceTemplate issuance(invariant, *keyPair->getPrivateKey(), mdAlgorithm);
+        issuance.setSubjectKeyIdentifier(true);
+        ASSERT_TRUE(issuance.isSubjectKeyIdentifier());
+
+        /* the RSA signatures are deterministic */
+        fillInvariant(builder);
+        builder.setVersion(2);
+        builder.setSerialNumber(serial);
+        builder.setSubject(subject);
+        builder.setPublicKey(*subjectKeyPair->getPublicKey());
+        builder.setNotBefore(notBefore);
+        builder.setNotAfter(notAfter);
+        keyIdentifier.setKeyIdentifier(subjectKeyPair->getPublicKey()->getKeyIdentifier());
+        builder.addExtension(keyIdentifier);
+        cert = builder.sign(*keyPair->getPrivateKey(), mdAlgorithm);
+
+        ByteArray der = issuance.issueDerEncoded(serial, subject, *subjectKeyPair->getPublicKey(),
+                notBefore, notAfter, extensions);
+        ASSERT_EQ(der.toHex(), cert->getDerEncoded().toHex());
+        delete cert;
+    }
+
+    /**
+     * @brief Tests certificates with their own extensions, issued from a request
+     */
+    void testIssueFromRequest() {
+        CertificateBuilder invariant;
+        CertificateRequest request;
+        SubjectAlternativeNameExtension alternativeName;
+        GeneralNames names;
+        GeneralName name;
+        std::vector<Extension *> extensions;
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+
+        request.setSubject(subject);
+        request.setPublicKey(*subjectKeyPair->getPublicKey());
+        request.sign(*subjectKeyPair->getPrivateKey(), mdAlgorithm);
+        name.setDnsName("template.example");
+        names.addGeneralName(name);
+        alternativeName.setSubjectAltName(names);
+        extensions.push_back(&alternativeName);
+
+        fillInvariant(invariant);
+        IssuanceTemplate issuance(invariant, *keyPair->getPrivateKey(), mdAlgorithm);
+        ByteArray der = issuance.issueDerEncoded(BigInteger(serialNumber), request, notBefore, notAfter, extensions);
+
+        Certificate cert(der);
+        ASSERT_TRUE(cert.verify(*keyPair->getPublicKey()));
+        ASSERT_EQ(cert.getVersion(), 2);
+        ASSERT_EQ(cert.getSerialNumber(), serialNumber);
+        ASSERT_EQ(cert.getSubject().getEntries(RDNSequence::COMMON_NAME)[0], "Template Subject");
+        ASSERT_EQ(cert.getIssuer().getEntries(RDNSequence::COMMON_NAME)[0], "Template CA");
+        ASSERT_EQ(cert.getNotBefore().getDateTime(), epochBefore);
+        ASSERT_EQ(cert.getNotAfter().getDateTime(), epochAfter);
+        ASSERT_EQ(cert.getExtensions().size(), 3);
+        ASSERT_EQ(cert.getExtension(Extension::SUBJECT_ALTERNATIVE_NAME).size(), 1);
+        PublicKey *publicKey = cert.getPublicKey();
+        ASSERT_EQ(publicKey->getKeyIdentifier().toHex(), subjectKeyPair->getPublicKey()->getKeyIdentifier().toHex());
+        delete publicKey;
+
+        /* the RSA signatures are deterministic, with or without a reused signing context */
+        EVP_MD_CTX *context = issuance.newSigningContext();
+        for (int i = 0; i < 2; i++) {
+            ASSERT_EQ(issuance.issueDerEncoded(BigInteger(serialNumber), request, notBefore, notAfter, extensions, context).toHex(),
+                    der.toHex());
+        }
+        EVP_MD_CTX_free(context);
+    }
+
+    /**
+     * @brief Tests a template signed with an EdDSA key, which has no separate digest
+     */
+    void testEdDSA() {
+        CertificateBuilder invariant;
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+        EVP_PKEY *pkey = NULL;
+        EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_ED25519, NULL);
+        EVP_PKEY_keygen_init(ctx);
+        EVP_PKEY_keygen(ctx, &pkey);
+        EVP_PKEY_CTX_free(ctx);
+        EVP_PKEY_up_ref(pkey);
+        PrivateKey privateKey(pkey);
+        PublicKey publicKey(pkey);
+
+        fillInvariant(invariant);
+        IssuanceTemplate issuance(invariant, privateKey, mdAlgorithm);
+        ByteArray der = issuance.issueDerEncoded(BigInteger(serialNumber), subject, *subjectKeyPair->getPublicKey(),
+                notBefore, notAfter);
+
+        Certificate cert(der);
+        ASSERT_TRUE(cert.verify(publicKey));
+        ASSERT_FALSE(cert.verify(*keyPair->getPublicKey()));
+
+        /* a signing context is reused for several certificates */
+        CertificateRequest request;
+        std::vector<Extension *> extensions;
+        request.setSubject(subject);
+        request.setPublicKey(*subjectKeyPair->getPublicKey());
+        request.sign(*subjectKeyPair->getPrivateKey(), mdAlgorithm);
+        EVP_MD_CTX *context = issuance.newSigningContext();
+        for (long i = 0; i < 3; i++) {
+            ByteArray reused = issuance.issueDerEncoded(BigInteger(i), request, notBefore, notAfter, extensions, context);
+            Certificate issued(reused);
+            ASSERT_TRUE(issued.verify(publicKey));
+        }
+        EVP_MD_CTX_free(context);
+    }
+
+    /**
+     * @brief Tests the version of certificates issued by a template without extensions
+     */
+    void testVersionOne() {
+        CertificateBuilder invariant;
+        BasicConstraintsExtension basicConstraints;
+        std::vector<Extension *> extensions;
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+
+        invariant.setIssuer(issuer);
+        IssuanceTemplate issuance(invariant, *keyPair->getPrivateKey(), mdAlgorithm);
+        Certificate *cert = issuance.issue(BigInteger(serialNumber), subject, *subjectKeyPair->getPublicKey(),
+                notBefore, notAfter, extensions);
+        ASSERT_EQ(cert->getVersion(), 0);
+        ASSERT_TRUE(cert->verify(*keyPair->getPublicKey()));
+        delete cert;
+
+        /* certificates with their own extensions are version 3 */
+        extensions.push_back(&basicConstraints);
+        cert = issuance.issue(BigInteger(serialNumber), subject, *subjectKeyPair->getPublicKey(),
+                notBefore, notAfter, extensions);
+        ASSERT_EQ(cert->getVersion(), 2);
+        ASSERT_EQ(cert->getExtensions().size(), 1);
+        ASSERT_TRUE(cert->verify(*keyPair->getPublicKey()));
+        delete cert;
+    }
+
+    /**
+     * @brief Tests a template signed with an RSA-PSS key, whose AlgorithmIdentifier carries parameters
+     */
+    void testPss() {
+        CertificateBuilder invariant;
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+        EVP_PKEY *pkey = NULL;
+        EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA_PSS, NULL);
+        EVP_PKEY_keygen_init(ctx);
+        EVP_PKEY_CTX_set_rsa_keygen_bits(ctx, 2048);
+        EVP_PKEY_keygen(ctx, &pkey);
+        EVP_PKEY_CTX_free(ctx);
+        EVP_PKEY_up_ref(pkey);
+        PrivateKey privateKey(pkey);
+        PublicKey publicKey(pkey);
+
+        fillInvariant(invariant);
+        IssuanceTemplate issuance(invariant, privateKey, mdAlgorithm);
+        ByteArray der = issuance.issueDerEncoded(BigInteger(serialNumber), subject, *subjectKeyPair->getPublicKey(),
+                notBefore, notAfter);
+
+        Certificate cert(der);
+        const X509_ALGOR *algorithm = NULL;
+        X509_get0_signature(NULL, &algorithm, cert.getX509());
+        ASSERT_EQ(OBJ_obj2nid(algorithm->algorithm), NID_rsassaPss);
+        ASSERT_NE(algorithm->parameter, (ASN1_TYPE *) NULL);
+        ASSERT_TRUE(cert.verify(publicKey));
+    }
+
+    /**
+     * @brief Tests that repeated extensions and inverted validity periods are rejected
+     */
+    void testRejected() {
+        CertificateBuilder invariant, repeated;
+        BasicConstraintsExtension basicConstraints;
+        SubjectKeyIdentifierExtension subjectKeyIdentifier;
+        ExtendedKeyUsageExtension extendedKeyUsage;
+        std::vector<Extension *> extensions;
+        DateTime notBefore(epochBefore), notAfter(epochAfter);
+
+        fillInvariant(invariant);
+        IssuanceTemplate issuance(invariant, *keyPair->getPrivateKey(), mdAlgorithm);
+        ASSERT_THROW(issuance.issueDerEncoded(BigInteger(serialNumber), subject, *subjectKeyPair->getPublicKey(),
+                notAfter, notBefore), CertificationException);
+
+        extensions.push_back(&basicConstraints);
+        ASSERT_THROW(issuance.issueDerEncoded(BigInteger(serialNumber), subject, *subjectKeyPair->getPublicKey(),
+                notBefore, notAfter, extensions), CertificationException);
+
+        extendedKeyUsage.addUsage(ObjectIdentifierFactory::getObjectIdentifier(NID_server_auth));
+        subjectKeyIdentifier.setKeyIdentifier(ByteArray(std::string("key identifier")));
+        extensions[0] = &extendedKeyUsage;
+        extensions.push_back(&subjectKeyIdentifier);
+        issuance.issueDerEncoded(BigInteger(serialNumber), subject, *subjectKeyPair->getPublicKey(),
+                notBefore, notAfter, extensions);
+        issuance.setSubjectKeyIdentifier(true);
+        ASSERT_THROW(issuance.issueDerEncoded(BigInteger(serialNumber), subject, *subjectKeyPair->getPublicKey(),
+                notBefore, notAfter, extensions), CertificationException);
+        extensions.pop_back();
+        extensions.push_back(&extendedKeyUsage);
+        ASSERT_THROW(issuance.issueDerEncoded(BigInteger(serialNumber), subject, *subjectKeyPair->getPublicKey(),
+                notBefore, notAfter, extensions), CertificationException);
+
+        fillInvariant(repeated);
+        repeated.addExtension(basicConstraints);
+        ASSERT_THROW(IssuanceTemplate(repeated, *keyPair->getPrivateKey(), mdAlgorithm), CertificationException);
+    }
+
+    /**
+     * @brief Tests issuing from several threads with the same template
+     */
+    void testConcurrentIssue() {
+        CertificateBuilder invariant;
+        std::vector<std::thread> issuers;
+        std::vector<int> failures(4, 0);
+
+        fillInvariant(invariant);
+        IssuanceTemplate issuance(invariant, *keyPair->getPrivateKey(), mdAlgorithm);
+        issuance.setSubjectKeyIdentifier(true);
+
+        for (int i = 0; i < 4; i++) {
+            issuers.push_back(std::thread([this, &issuance, &failures, i]() {
+                DateTime notBefore(epochBefore), notAfter(epochAfter);
+                for (long j = 0; j < 50; j++) {
+                    BigInteger serial(i * 1000L + j);
+                    ByteArray der = issuance.issueDerEncoded(serial, subject, *subjectKeyPair->getPublicKey(),
+                            notBefore, notAfter);
+                    Certificate cert(der);
+                    if (cert.getSerialNumber() != i * 1000L + j || !cert.verify(*keyPair->getPublicKey())) {
+                        failures[i]++;
+                    }
+                }
+            }));
+        }
+        for (unsigned int i = 0; i < issuers.size(); i++) {
+            issuers[i].join();
+        }
+
+        for (unsigned int i = 0; i < failures.size(); i++) {
+            ASSERT_EQ(failures[i], 0);
+        }
+    }
+
+    static RSAKeyPair *keyPair;
+    static RSAKeyPair *subjectKeyPair;
+    static const MessageDigest::Algorithm mdAlgorithm = MessageDigest::SHA256;
+    static const long serialNumber = 4567;
+    static const time_t epochBefore = 1487889918;
+    static const time_t epochAfter = 1519425918;
+
+    RDNSequence issuer;
+    RDNSequence subject;
+};
+
+RSAKeyPair* IssuanceTemplateTest::keyPair = new RSAKeyPair(2048);
+RSAKeyPair* IssuanceTemplateTest::subjectKeyPair = new RSAKeyPair(2048);
+const long IssuanceTemplateTest::serialNumber;
+const time_t IssuanceTemplateTest::epochBefore;
+const time_t IssuanceTemplateTest::epochAfter;
+
+TEST_F(IssuanceTemplateTest, SameAsBuilder) {
+    testSameAsBuilder();
+}
+
+TEST_F(IssuanceTemplateTest, IssueFromRequest) {
+    testIssueFromRequest();
+}
+
+TEST_F(IssuanceTemplateTest, EdDSA) {
+    testEdDSA();
+}
+
+TEST_F(IssuanceTemplateTest, Pss) {
+    testPss();
+}
+
+TEST_F(IssuanceTemplateTest, Rejected) {
+    testRejected();
+}
+
+TEST_F(IssuanceTemplateTest, VersionOne) {
+    testVersionOne();
+}
+
+TEST_F(IssuanceTemplateTest, ConcurrentIssue) {
+    testConcurrentIssue();
+}
@@ -0,0 +1,137 @@
+#include <libcryptosec/certificate/JsonWriter.h>
+
+#include <sstream>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe JsonWriter
+ */
+class JsonWriterTest : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+    }
+
+    virtual void TearDown() {
+    }
+
+    /**
+     * @brief Tests the objects, arrays and members written for structures, lists and fields
+     */
+    void testStructure() {
+        std::ostringstream stream;
+        JsonWriter writer(stream);
+        unsigned char data[] = { 0x01, 0x02, 0x03 };
+
+        writer.begin("root");
+        writer.write("text", "value");
+        writer.write("number", -42L);
+        writer.write("flag", true);
+        writer.writeBase64("data", data, sizeof(data));
+        writer.writeTime("time", (time_t) 1487889907);
+        writer.beginList("items");
+        writer.write("item", std::string("a"));
+        writer.begin("entry");
+        writer.write("flag", false);
+        writer.end();
+        writer.beginList("empty");
+        writer.end();
+        writer.end();
+        writer.begin("empty");
+        writer.end();
+        writer.end();
+
+        ASSERT_EQ(stream.str(),
+                "{\"root\":{\"text\":\"value\",\"number\":-42,\"flag\":true,\"data\":\"AQID\","
+                "\"time\":\"2017-02-23T22:45:07Z\",\"items\":[\"a\",{\"flag\":false},[]],\"empty\":{}}}");
+    }
+
+    /**
+     * @brief Tests escaping quotes, backslashes and control characters
+     */
+    void testEscape() {
+        std::ostringstream stream;
+        JsonWriter writer(stream);
+
+        writer.begin("root");
+        writer.write("va\"lue", std::string("a\"b\\c\nd\te\x01", 10));
+        writer.end();
+
+        ASSERT_EQ(stream.str(), "{\"root\":{\"va\\\"lue\":\"a\\\"b\\\\c\\nd\\te\\u0001\"}}");
+    }
+
+    /**
+     * @brief Tests that valid UTF-8 is kept and each byte of an invalid sequence becomes U+FFFD
+     */
+    void testUtf8() {
+        std::ostringstream stream;
+        JsonWriter writer(stream);
+        const unsigned char valid[] = { 0xc3, 0xa9, 0xe2, 0x82, 0xac, 0xf0, 0x9f, 0x98, 0x80 };
+        /* Latin-1, overlong, surrogate and truncated sequences */
+        const unsigned char invalid[] = { 0xe9, 'x', 0xc0, 0xaf, 0xed, 0xa0, 0x80, 0xe2, 0x82 };
+
+        writer.begin("root");
+        writer.write("valid", std::string((const char *) valid, sizeof(valid)));
+        writer.write("invalid", std::string((const char *) invalid, sizeof(invalid)));
+        writer.end();
+
+        ASSERT_EQ(stream.str(), "{\"root\":{\"valid\":\"" + std::string((const char *) valid, sizeof(valid))
+                + "\",\"invalid\":\"\\ufffdx\\ufffd\\ufffd\\ufffd\\ufffd\\ufffd\\ufffd\\ufffd\"}}");
+    }
+
+    /**
+     * @brief Tests times given as time_t and as ASN1_TIME, including years after 2049 and invalid times
+     */
+    void testTime() {
+        std::ostringstream stream;
+        JsonWriter writer(stream);
+        ASN1_TIME *generalized = ASN1_TIME_new();
+        ASN1_TIME *invalid = ASN1_TIME_new();
+        ASN1_TIME_set_string(generalized, "20500101000000Z");
+        ASN1_STRING_set(invalid, "2050", 4);
+        invalid->type = V_ASN1_GENERALIZEDTIME;
+
+        writer.begin("root");
+        writer.writeTime("before", (time_t) -86400);
+        writer.writeTime("after", (time_t) 4102444800LL);
+        writer.writeTime("generalized", generalized);
+        writer.writeTime("invalid", invalid);
+        writer.end();
+        ASN1_TIME_free(generalized);
+        ASN1_TIME_free(invalid);
+
+        ASSERT_EQ(stream.str(), "{\"root\":{\"before\":\"1969-12-31T00:00:00Z\",\"after\":\"2100-01-01T00:00:00Z\","
+                "\"generalized\":\"2050-01-01T00:00:00Z\",\"invalid\":\"\"}}");
+    }
+
+    /**
+     * @brief Tests a document made of a single field, which must still be a closed object, and int values
+     */
+    void testRootField() {
+        std::ostringstream stream;
+        JsonWriter writer(stream);
+
+        writer.write("version", 2);
+        ASSERT_EQ(stream.str(), "{\"version\":2}");
+    }
+};
+
+TEST_F(JsonWriterTest, Structure) {
+    testStructure();
+}
+
+TEST_F(JsonWriterTest, Escape) {
+    testEscape();
+}
+
+TEST_F(JsonWriterTest, RootField) {
+    testRootField();
+}
+
+TEST_F(JsonWriterTest, Utf8) {
+    testUtf8();
+}
+
+TEST_F(JsonWriterTest, Time) {
+    testTime();
+}
@@ -0,0 +1,158 @@
+#include <libcryptosec/certificate/ObjectIdentifierTable.h>
+#include <libcryptosec/certificate/ObjectIdentifierFactory.h>
+
+#include <thread>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe ObjectIdentifierTable
+ */
+class ObjectIdentifierTableTest : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+    }
+
+    virtual void TearDown() {
+    }
+
+    std::string toText(const ASN1_OBJECT *object) {
+      char data[128];
+      OBJ_obj2txt(data, sizeof(data), object, 1);
+      return std::string(data);
+    }
+
+    /**
+     * @brief Tests that every object OpenSSL knows is found by NID, text and DER
+     */
+    void testBuiltin() {
+      unsigned int found = 0;
+
+      for (int nid = 1; nid < OBJ_new_nid(0); nid++) {
+        const ObjectIdentifierTable::Entry *entry = ObjectIdentifierTable::findByNid(nid);
+        if (entry == NULL) {
+          continue;
+        }
+        found++;
+        ASSERT_EQ(entry->nid, nid);
+        ASSERT_EQ(entry->oid, toText(entry->object));
+        ASSERT_EQ(entry->name, std::string(OBJ_nid2sn(nid)));
+
+        /* an OID shared by two NIDs is found as the one OpenSSL resolves it to */
+        const ObjectIdentifierTable::Entry *byOid = ObjectIdentifierTable::findByOid(entry->oid);
+        const ObjectIdentifierTable::Entry *byDer = ObjectIdentifierTable::findByDer(
+            OBJ_get0_data(entry->object), OBJ_length(entry->object));
+        ASSERT_TRUE(byOid != NULL);
+        ASSERT_EQ(byOid, byDer);
+        ASSERT_EQ(OBJ_cmp(byOid->object, entry->object), 0);
+      }
+      ASSERT_GT(found, 1000);
+      ASSERT_GE(ObjectIdentifierTable::size(), found);
+
+      ASSERT_TRUE(ObjectIdentifierTable::findByNid(NID_undef) == NULL);
+      ASSERT_TRUE(ObjectIdentifierTable::findByOid("1.2.3.4.5.6.7.8.9") == NULL);
+      ASSERT_TRUE(ObjectIdentifierTable::findByOid("2.5.29.015") == NULL);
+    }
+
+    /**
+     * @brief Tests that the factory and ObjectIdentifier give the same results as OpenSSL
+     */
+    void testFactory() {
+      ObjectIdentifier keyUsage = ObjectIdentifierFactory::getObjectIdentifier("2.5.29.15");
+      ASSERT_EQ(keyUsage.getNid(), NID_key_usage);
+      ASSERT_EQ(keyUsage.getOid(), "2.5.29.15");
+      ASSERT_EQ(keyUsage.getName(), "keyUsage");
+      ASSERT_EQ(keyUsage.getObjectIdentifier(), OBJ_nid2obj(NID_key_usage));
+
+      /* objects decoded from DER are resolved through the table as well */
+      const unsigned char der[] = {0x06, 0x03, 0x55, 0x1d, 0x13};
+      const unsigned char *p = der;
+      ObjectIdentifier decoded(d2i_ASN1_OBJECT(NULL, &p, sizeof(der)));
+      ASSERT_EQ(decoded.getOid(), "2.5.29.19");
+      ASSERT_EQ(decoded.getName(), "basicConstraints");
+
+      /* unknown OIDs still work, without being registered */
+      unsigned int size = ObjectIdentifierTable::size();
+      ObjectIdentifier unknown = ObjectIdentifierFactory::getObjectIdentifier("1.2.3.4.5.6.7");
+      ASSERT_EQ(unknown.getOid(), "1.2.3.4.5.6.7");
+      ASSERT_EQ(unknown.getName(), "1.2.3.4.5.6.7");
+      ASSERT_EQ(ObjectIdentifierTable::size(), size);
+    }
+
+    /**
+     * @brief Tests that created objects go into the table
+     */
+    void testCreated() {
+      ObjectIdentifier created = ObjectIdentifierFactory::createObjectIdentifier(createdOid, createdName);
+      const ObjectIdentifierTable::Entry *entry = ObjectIdentifierTable::findByOid(createdOid);
+
+      ASSERT_TRUE(entry != NULL);
+      ASSERT_EQ(entry->nid, created.getNid());
+      ASSERT_EQ(entry->name, createdName);
+      ASSERT_EQ(ObjectIdentifierTable::findByNid(created.getNid()), entry);
+      ASSERT_EQ(ObjectIdentifierTable::findByDer(OBJ_get0_data(entry->object), OBJ_length(entry->object)), entry);
+
+      /* the ObjectIdentifier has its own copy; the one in the table stays valid */
+      {
+        ObjectIdentifier copy = ObjectIdentifierFactory::getObjectIdentifier(created.getNid());
+        ASSERT_EQ(copy.getOid(), createdOid);
+      }
+      ObjectIdentifier again = ObjectIdentifierFactory::getObjectIdentifier(createdOid);
+      ASSERT_EQ(again.getName(), createdName);
+      ASSERT_EQ(again.getNid(), created.getNid());
+    }
+
+    /**
+     * @brief Tests lookups from several threads while objects are created
+     */
+    void testConcurrentLookups() {
+      std::vector<std::thread> threads;
+      std::vector<int> failures(4, 0);
+
+      for (int i = 0; i < 4; i++) {
+        threads.push_back(std::thread([&failures, i]() {
+          for (int j = 0; j < 2000; j++) {
+            const ObjectIdentifierTable::Entry *entry = ObjectIdentifierTable::findByOid("2.5.4.3");
+            if (entry == NULL || entry->nid != NID_commonName
+                || ObjectIdentifierTable::findByNid(NID_commonName) != entry) {
+              failures[i]++;
+            }
+          }
+        }));
+      }
+      for (int i = 0; i < 20; i++) {
+        std::string oid = "1.3.6.1.4.1.99999.45." + std::to_string(i);
+        ObjectIdentifierFactory::createObjectIdentifier(oid, "tableTest" + std::to_string(i));
+      }
+      for (unsigned int i = 0; i < threads.size(); i++) {
+        threads[i].join();
+      }
+
+      for (unsigned int i = 0; i < failures.size(); i++) {
+        ASSERT_EQ(failures[i], 0);
+      }
+      ASSERT_TRUE(ObjectIdentifierTable::findByOid("1.3.6.1.4.1.99999.45.19") != NULL);
+    }
+
+    static std::string createdOid;
+    static std::string createdName;
+};
+
+std::string ObjectIdentifierTableTest::createdOid = "1.3.6.1.4.1.99999.44.1";
+std::string ObjectIdentifierTableTest::createdName = "tableTestCreated";
+
+TEST_F(ObjectIdentifierTableTest, Builtin) {
+  testBuiltin();
+}
+
+TEST_F(ObjectIdentifierTableTest, Factory) {
+  testFactory();
+}
+
+TEST_F(ObjectIdentifierTableTest, Created) {
+  testCreated();
+}
+
+TEST_F(ObjectIdentifierTableTest, ConcurrentLookups) {
+  testConcurrentLookups();
+}
@@ -0,0 +1,312 @@
+#include <libcryptosec/PublicKeyCache.h>
+#include <libcryptosec/certificate/Certificate.h>
+#include <libcryptosec/certificate/CertificateRevocationList.h>
+
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe PublicKeyCache
+ */
+class PublicKeyCacheTest : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+      rootCa = new Certificate(rootCaPem);
+      intermediateCa = new Certificate(intermediateCaPem);
+      leafCert = new Certificate(leafCertPem);
+      rootCrl = new CertificateRevocationList(rootCrlPem);
+      rootKey = getSpki(rootCa);
+      intermediateKey = getSpki(intermediateCa);
+      leafKey = getSpki(leafCert);
+    }
+
+    virtual void TearDown() {
+      delete rootCa;
+      delete intermediateCa;
+      delete leafCert;
+      delete rootCrl;
+    }
+
+    /* DER of the SubjectPublicKeyInfo, as a key received from outside a certificate */
+    static ByteArray getSpki(Certificate *cert) {
+      unsigned char *der = NULL;
+      int len = i2d_X509_PUBKEY(X509_get_X509_PUBKEY(cert->getX509()), &der);
+      ByteArray ret(der, len);
+      OPENSSL_free(der);
+      return ret;
+    }
+
+    /**
+     * @brief Tests that a second lookup of the same key is a hit on the same EVP_PKEY
+     */
+    void testHit() {
+      PublicKeyCache cache(16, 4);
+      EVP_PKEY *first = cache.get(rootKey);
+      EVP_PKEY *second = cache.get(rootKey);
+      PublicKeyCache::Stats stats = cache.getStats();
+
+      ASSERT_TRUE(first);
+      ASSERT_EQ(first, second);
+      ASSERT_EQ(stats.misses, 1);
+      ASSERT_EQ(stats.hits, 1);
+      ASSERT_EQ(stats.size, 1);
+
+      EVP_PKEY_free(first);
+      EVP_PKEY_free(second);
+    }
+
+    /**
+     * @brief Tests that separate copies of the same encoding share the cached key
+     */
+    void testSharedAcrossEncodings() {
+      PublicKeyCache cache;
+      ByteArray copy(rootKey);
+      EVP_PKEY *first = cache.get(rootKey.getDataPointer(), rootKey.size());
+      EVP_PKEY *second = cache.get(copy);
+      EVP_PKEY *other = cache.get(intermediateKey);
+
+      ASSERT_EQ(first, second);
+      ASSERT_NE(first, other);
+      ASSERT_EQ(EVP_PKEY_cmp(first, X509_get0_pubkey(rootCa->getX509())), 1);
+
+      EVP_PKEY_free(first);
+      EVP_PKEY_free(second);
+      EVP_PKEY_free(other);
+    }
+
+    /**
+     * @brief Tests that encodings that are not a single SubjectPublicKeyInfo are not cached
+     */
+    void testInvalid() {
+      PublicKeyCache cache;
+      ByteArray trailing(rootKey.size() + 1);
+      memcpy(trailing.getDataPointer(), rootKey.getDataPointer(), rootKey.size());
+      trailing.getDataPointer()[rootKey.size()] = 0;
+
+      ASSERT_EQ(cache.get(rootKey.getDataPointer(), rootKey.size() - 1), (EVP_PKEY *) NULL);
+      ASSERT_EQ(cache.get(trailing), (EVP_PKEY *) NULL);
+      ASSERT_EQ(cache.get(NULL, 0), (EVP_PKEY *) NULL);
+      ASSERT_EQ(cache.getStats().size, 0);
+    }
+
+    /**
+     * @brief Tests that the least recently used key is evicted when the cache is full
+     */
+    void testEviction() {
+      PublicKeyCache cache(2, 1);
+      EVP_PKEY_free(cache.get(rootKey));
+      EVP_PKEY_free(cache.get(intermediateKey));
+      /* touches the root key so the intermediate one becomes the oldest */
+      EVP_PKEY_free(cache.get(rootKey));
+      EVP_PKEY_free(cache.get(leafKey));
+
+      PublicKeyCache::Stats stats = cache.getStats();
+      ASSERT_EQ(stats.size, 2);
+      ASSERT_EQ(stats.evictions, 1);
+
+      EVP_PKEY_free(cache.get(rootKey));
+      ASSERT_EQ(cache.getStats().hits, 2);
+      EVP_PKEY_free(cache.get(intermediateKey));
+      ASSERT_EQ(cache.getStats().evictions, 2);
+    }
+
+    /**
+     * @brief Tests that evicted keys stay valid while the caller holds a reference
+     */
+    void testReferenceOutlivesEviction() {
+      PublicKeyCache cache(1, 1);
+      EVP_PKEY *key = cache.get(rootKey);
+      EVP_PKEY_free(cache.get(intermediateKey));
+
+      ASSERT_EQ(cache.getStats().evictions, 1);
+      ASSERT_EQ(X509_verify(intermediateCa->getX509(), key), 1);
+      EVP_PKEY_free(key);
+    }
+
+    /**
+     * @brief Tests that clear drops every key and resets the statistics
+     */
+    void testClear() {
+      PublicKeyCache cache;
+      EVP_PKEY_free(cache.get(rootKey));
+      EVP_PKEY_free(cache.get(rootKey));
+      cache.clear();
+
+      PublicKeyCache::Stats stats = cache.getStats();
+      ASSERT_EQ(stats.size, 0);
+      ASSERT_EQ(stats.hits, 0);
+      ASSERT_EQ(stats.misses, 0);
+    }
+
+    /**
+     * @brief Tests concurrent lookups of the same keys
+     */
+    void testConcurrentLookups() {
+      PublicKeyCache cache(64, 8);
+      std::vector<std::thread> threads;
+      std::vector<int> failures(8, 0);
+
+      for (int i = 0; i < 8; i++) {
+        threads.push_back(std::thread([this, &cache, &failures, i]() {
+          for (int j = 0; j < 200; j++) {
+            X509 *cert = (j % 2) ? rootCa->getX509() : intermediateCa->getX509();
+            EVP_PKEY *key = cache.get((j % 2) ? rootKey : intermediateKey);
+            if (key == NULL || EVP_PKEY_cmp(key, X509_get0_pubkey(cert)) != 1) {
+              failures[i]++;
+            }
+            EVP_PKEY_free(key);
+          }
+        }));
+      }
+      for (unsigned int i = 0; i < threads.size(); i++) {
+        threads[i].join();
+      }
+
+      PublicKeyCache::Stats stats = cache.getStats();
+      for (unsigned int i = 0; i < failures.size(); i++) {
+        ASSERT_EQ(failures[i], 0);
+      }
+      ASSERT_EQ(stats.size, 2);
+      ASSERT_EQ(stats.hits + stats.misses, 1600);
+    }
+
+    /**
+     * @brief Tests certificate signature verification against the issuer certificate
+     */
+    void testCertificateVerify() {
+      ASSERT_TRUE(intermediateCa->verify(*rootCa));
+      ASSERT_TRUE(leafCert->verify(*intermediateCa));
+      ASSERT_FALSE(leafCert->verify(*rootCa));
+    }
+
+    /**
+     * @brief Tests CRL signature verification against the issuer certificate
+     */
+    void testCrlVerify() {
+      ASSERT_TRUE(rootCrl->verify(*rootCa));
+      ASSERT_FALSE(rootCrl->verify(*intermediateCa));
+    }
+
+    Certificate *rootCa;
+    Certificate *intermediateCa;
+    Certificate *leafCert;
+    CertificateRevocationList *rootCrl;
+    ByteArray rootKey;
+    ByteArray intermediateKey;
+    ByteArray leafKey;
+    static std::string rootCaPem;
+    static std::string intermediateCaPem;
+    static std::string leafCertPem;
+    static std::string rootCrlPem;
+};
+
+/*
+ * Initialization of variables used in the tests
+ */
+
+std::string PublicKeyCacheTest::rootCaPem = "-----BEGIN CERTIFICATE-----" "\n"
+"MIIC4zCCAcsCCQDrfn+TvOi8KzANBgkqhkiG9w0BAQ0FADAoMSYwJAYDVQQDDB1U" "\n"
+"cnVzdGVkIENlcnRpZmljYXRlIEF1dGhvcml0eTAgFw0wMDAxMDEwMDAwMDBaGA8y" "\n"
+"MTAwMDEwMTAwMDAwMFowKDEmMCQGA1UEAwwdVHJ1c3RlZCBDZXJ0aWZpY2F0ZSBB" "\n"
+"dXRob3JpdHkwggEiMA0GCSqGSIb3DQEBAQUAA4IBDwAwggEKAoIBAQDTp8YbJmUZ" "\n"
+"JgwkRGICuAJpn1e7lEaf/9lHzmJGYbe+5zjE9YJxlqWbxRRERw5AsRsze0ittE5X" "\n"
+"0/hVQ74AMcWt+M5h2geKpdEUBXXXtJPG7R4825NHw6B65TdLJ9UB64Qd/za8uJnR" "\n"
+"Ym/9ZIe0tGDSvOtR9tJ5CuBkrWEDT6+76O/E7Clz1is3XznI1OFTVy+98nn7/fft" "\n"
+"84GY4RpIYskmJqIrk2SHAGB02X4UCxw3bmgBOHDJbmMQZE54U2jjwWFnvC3E8/tF" "\n"
+"kiMEd4aTaU6axl/mzLJoLzVHgDFTnuo9NES4mxZ4sNikk0FMzS5JarMFRFUNdr3m" "\n"
+"wCJ9c3j4iYDbAgMBAAGjEzARMA8GA1UdEwEB/wQFMAMBAf8wDQYJKoZIhvcNAQEN" "\n"
+"BQADggEBAATfZ1GwI3lbzPQ7ykkGg2u9gIC/6yUCarz5snvntIPInH6IbOpWWXYZ" "\n"
+"liPZKOItqR6APGiCxLswsWY6zwNlQelmXDZnnFXfHIhWjcOM9Cb0Be9w6elX+/8e" "\n"
+"Wp/N2JruLdf30MS4uXxQmpgR6+pcOUG73oqItOl3HTtcNRmKcX+SIgJB2dy5ELO2" "\n"
+"X1m6fVkiA021W1AI78YOGAzKhwQmUp4IRTMW0iK3FUDYGRO8FW3hZJMn+hM6MRe4" "\n"
+"sFUaRkiuisix2O5zGsV/UvC0oWbIs7umXLoYoe0AM88MHf4kpIq15lq6X6k1JAii" "\n"
+"DFOVgLYzxzmV2SMJ/NlZeB4S0VGm85E=" "\n"
+"-----END CERTIFICATE-----";
+
+std::string PublicKeyCacheTest::intermediateCaPem = "-----BEGIN CERTIFICATE-----" "\n"
+"MIIC8DCCAdgCCQCZY9E6IL8aazANBgkqhkiG9w0BAQ0FADAoMSYwJAYDVQQDDB1U" "\n"
+"cnVzdGVkIENlcnRpZmljYXRlIEF1dGhvcml0eTAgFw0wMDAxMDEwMDAwMDBaGA8y" "\n"
+"MTAwMDEwMTAwMDAwMFowNTEzMDEGA1UEAwwqVHJ1c3RlZCBJbnRlcm1lZGlhdGUg" "\n"
+"Q2VydGlmaWNhdGUgQXV0aG9yaXR5MIIBIjANBgkqhkiG9w0BAQEFAAOCAQ8AMIIB" "\n"
+"CgKCAQEAvv4WARioU+x8meSQBqD8IlG5bLNXlBLocVSOwoHU6gGIdUbiU2vQiGIM" "\n"
+"C1NGRztyjtmPGcH+93XdcjcWo/4Pya/A+DcZY/B6bHZCNkW0Ox95VrZWJrEP3EgZ" "\n"
+"GcuTx+Z+8b6xCP2s8ZMc6XU6aCnedfht1BTIVelaGOrZk5EeltWu6KqtQXDcaJ8O" "\n"
+"ncUW05zfke6A5KaDhyzuUpdQxJiJ7gxkoEAwwU0VeD7TIXZtDR/QhSZ/UYvPfvqO" "\n"
+"RUBLpZJ2EzOvVxQBmGadnNcvYdPtzvp7bibJiOCGxc2OgCQ8OVZ3CmhwGZ7q4SMn" "\n"
+"qQooAWqkUv6osVCgI8oCwDCp8+ZIQwIDAQABoxMwETAPBgNVHRMBAf8EBTADAQH/" "\n"
+"MA0GCSqGSIb3DQEBDQUAA4IBAQBJiDMri0naQ6T96XiPVdbmmm4vbw0DP2mKhCc9" "\n"
+"unvHOALLkcD2webJLrYb8GwYrg6KIriERBjxQKUV+0CuLbRblqHmfIggfFfKR0tw" "\n"
+"QfKfqggeq3X/0kOBHLPKsJUbB0KgLpsCJ0rfv5y6gZUpEf1Gr2Ytyj03YArsF4Cs" "\n"
+"fiEnPU3mDVN5Nql6Usvv6AR5DjWyPxos0zyvtGfAwN9dCTL3PQwd3p5pHRJs6Z65" "\n"
+"c9c0zDD/ludNQzIkFU2ZXbv20vru6xTzLP6sHJ5i8nqQQ/x053U3B+xTnZwOD1XG" "\n"
+"KHnX4A61PKSJo1hGD1+5wKD02zDO1SCXj3L5Hf4+XmHM4vxB" "\n"
+"-----END CERTIFICATE-----";
+
+std::string PublicKeyCacheTest::leafCertPem = "-----BEGIN CERTIFICATE-----" "\n"
+"MIICzjCCAbYCCQCELgBb5E+vFTANBgkqhkiG9w0BAQ0FADA1MTMwMQYDVQQDDCpU" "\n"
+"cnVzdGVkIEludGVybWVkaWF0ZSBDZXJ0aWZpY2F0ZSBBdXRob3JpdHkwIBcNMDAw" "\n"
+"MTAxMDAwMDAwWhgPMjEwMDAxMDEwMDAwMDBaMBsxGTAXBgNVBAMMEFRydXN0ZWQg" "\n"
+"T3BlcmF0b3IwggEiMA0GCSqGSIb3DQEBAQUAA4IBDwAwggEKAoIBAQC4qpnqD1ts" "\n"
+"+I9pYmlSvoxZgK2f+6+8sqQGjOECvdw/kpFnLERHcDRvLfuhIpD+Yqv52loBUb6Z" "\n"
+"LdnL6ZAfSXO5l4FXYZiGaf/s04l8x6PLGTtEFaDHlJz7ZtGM2voyyKe7ZgAtjL6L" "\n"
+"F60VFi5Z8CjZ+KS1Bd0K3zqGtXtsudVQneyAL7LwtHCCDI6kyyK/22SwGbu16ea4" "\n"
+"XOLnYz+lJ3KfKr6X2nZiWnmd00iengSo5vkCdQkNbTOLNqupuWGciDOjd7vV2geg" "\n"
+"HCT+O+Vfg4bTXOSj3Zrr6jk3KcTmyCT5qI7jvFmS0IlXgSOxUnN261u/PC4QZ3yJ" "\n"
+"YP3rxtgiin5TAgMBAAEwDQYJKoZIhvcNAQENBQADggEBAKeNKVk6aW2SCO1fnulV" "\n"
+"u3yHB8o0zg2UsRGyASmxC0p2vM9A2ztg8FyYYagUBxjQuyJfUvHZa6G52T1lz/As" "\n"
+"iMtX4lcurlzPKdpm8SlaCHwkkzp/+PUWZDvYiYyQeNU+nRE2WB3YS2K9JniSv6gM" "\n"
+"QYW4iTdS50k4EodmsZNBe8tJRMAHNB0R4G0qVRWiBvQ6vVT6AX5Dos3qR/dYunmX" "\n"
+"21KmcML2yUWqkMOMFUQUZ0/guoOXdNwhiUGjwEqT/11YRJwtJkMapP85sbuSJX9c" "\n"
+"7705E7OxdBsTLPCjOS3SyceKBZ8h0gSpMYwlxyylKUV7Vu4vsKSpskiP8pSa3yD0" "\n"
+"Kns=" "\n"
+"-----END CERTIFICATE-----";
+
+std::string PublicKeyCacheTest::rootCrlPem = "-----BEGIN X509 CRL-----" "\n"
+"MIIBozCBjAIBATANBgkqhkiG9w0BAQ0FADAoMSYwJAYDVQQDDB1UcnVzdGVkIENl" "\n"
+"cnRpZmljYXRlIEF1dGhvcml0eRcNMzAwMTAxMDAwMDAwWhgPMjEzMDAxMDEwMDAw" "\n"
+"MDBaMB4wHAIJAJlj0TogvxprGA8yMDUwMDEwMTAwMDAwMFqgDjAMMAoGA1UdFAQD" "\n"
+"AgEBMA0GCSqGSIb3DQEBDQUAA4IBAQBZ8wptno3hjqAUYhIBMUmrsaQQZ08nLUjf" "\n"
+"ngFNRiy2ALERtvg+t2HDFVGDTwf3xcYuO5Xxo73RFOc13vsljQoiBc25xX/aTy6D" "\n"
+"NvgfBS/gYegpE3y9KGJkFJTYpEmqCUHCFuOWPolFuUEIrIU1AYEKDBHrXkBfpO+G" "\n"
+"HcuAPt2HOMoQezHMbyjq8dIa3GjRRypQ5R0W4NgLxQ6Ei0jrgf5rRJZjk9iS4t5i" "\n"
+"Z0PkEOhfR9XAuzLQS3E4jMp+/uUNpMJvkFJfwFJ11dLtibA4GkFu19EmaJZxMOD/" "\n"
+"XUnH0Ryxl/ZB28JlT+Ptm3eyYQXke//qSE8MenPQGLC74xCwAZEi" "\n"
+"-----END X509 CRL-----";
+
+TEST_F(PublicKeyCacheTest, Hit) {
+  testHit();
+}
+
+TEST_F(PublicKeyCacheTest, SharedAcrossEncodings) {
+  testSharedAcrossEncodings();
+}
+
+TEST_F(PublicKeyCacheTest, Invalid) {
+  testInvalid();
+}
+
+TEST_F(PublicKeyCacheTest, Eviction) {
+  testEviction();
+}
+
+TEST_F(PublicKeyCacheTest, ReferenceOutlivesEviction) {
+  testReferenceOutlivesEviction();
+}
+
+TEST_F(PublicKeyCacheTest, Clear) {
+  testClear();
+}
+
+TEST_F(PublicKeyCacheTest, ConcurrentLookups) {
+  testConcurrentLookups();
+}
+
+TEST_F(PublicKeyCacheTest, CertificateVerify) {
+  testCertificateVerify();
+}
+
+TEST_F(PublicKeyCacheTest, CrlVerify) {
+  testCrlVerify();
+}
@@ -1,4 +1,5 @@
 #include <libcryptosec/certificate/RDNSequence.h>
+#include <libcryptosec/certificate/JsonWriter.h>
 
 #include <sstream>
 #include <gtest/gtest.h>
@@ -99,6 +100,117 @@ protected:
       testGeneric(copy);
     }
 
+    /**
+     * @brief Tests that the cached hash is the one OpenSSL computes for the same name
+     */
+    void testHash() {
+      std::vector<RDNSequence> names;
+      names.push_back(genRDNSequence());
+      names.push_back(genRDNSequenceVector());
+      names.push_back(RDNSequence());
+
+      RDNSequence spaced;
+      spaced.addEntry(RDNSequence::COMMON_NAME, "  Fulano \t da\n\n Silva ");
+      spaced.addEntry(RDNSequence::ORGANIZATION, "\xc9" "cole");
+      spaced.addEntry(RDNSequence::ORGANIZATION_UNIT, "");
+      names.push_back(spaced);
+
+      /* canonical RDNs longer than 64 KiB need a three-byte length */
+      X509_NAME *wide = X509_NAME_new();
+      std::string value(70000, 'a');
+      X509_NAME_add_entry_by_txt(wide, "1.2.3.4", V_ASN1_UTF8STRING, (const unsigned char *) value.data(), value.size(), -1, 0);
+      names.push_back(RDNSequence(wide));
+      X509_NAME_free(wide);
+
+      for (unsigned int i = 0; i < names.size(); i++) {
+        X509_NAME *x509 = names[i].getX509Name();
+        unsigned char *der = NULL;
+        int length = i2d_X509_NAME(x509, &der);
+
+        ASSERT_EQ(names[i].getHash(), X509_NAME_hash(x509));
+        ASSERT_EQ(names[i].getDerEncoded().toHex(), ByteArray(der, length).toHex());
+        OPENSSL_free(der);
+        X509_NAME_free(x509);
+      }
+    }
+
+    /**
+     * @brief Tests equality under the canonical form, as X509_NAME_cmp does
+     */
+    void testEquality() {
+      RDNSequence rdn, other, reordered;
+
+      rdn.addEntry(RDNSequence::COUNTRY, "BR");
+      rdn.addEntry(RDNSequence::COMMON_NAME, "Fulano da Silva");
+      other.addEntry(RDNSequence::COUNTRY, "br");
+      other.addEntry(RDNSequence::COMMON_NAME, " FULANO  da silva");
+      reordered.addEntry(RDNSequence::COMMON_NAME, "Fulano da Silva");
+      reordered.addEntry(RDNSequence::COUNTRY, "BR");
+
+      ASSERT_TRUE(rdn == other);
+      ASSERT_EQ(rdn.getHash(), other.getHash());
+      ASSERT_NE(rdn.getDerEncoded().toHex(), other.getDerEncoded().toHex());
+      ASSERT_TRUE(rdn != reordered);
+      ASSERT_TRUE(rdn == rdn);
+
+      X509_NAME *x509 = rdn.getX509Name();
+      X509_NAME *x509Other = other.getX509Name();
+      ASSERT_EQ(X509_NAME_cmp(x509, x509Other), 0);
+      X509_NAME_free(x509);
+      X509_NAME_free(x509Other);
+    }
+
+    /**
+     * @brief Tests that the cached encoding follows changes to the name and is kept by copies
+     */
+    void testCachedEncoding() {
+      RDNSequence rdn = genRDNSequence();
+      ByteArray before = rdn.getDerEncoded();
+      unsigned long hash = rdn.getHash();
+
+      RDNSequence copy(rdn);
+      RDNSequence assigned;
+      assigned = rdn;
+      ASSERT_TRUE(copy == rdn);
+      ASSERT_TRUE(assigned == rdn);
+      ASSERT_EQ(copy.getDerEncoded().toHex(), before.toHex());
+
+      rdn.addEntry(RDNSequence::COMMON_NAME, "Fulana de Souza");
+      ASSERT_NE(rdn.getDerEncoded().toHex(), before.toHex());
+      ASSERT_NE(rdn.getHash(), hash);
+      ASSERT_TRUE(rdn != copy);
+      ASSERT_EQ(copy.getHash(), hash);
+
+      /* repeated calls give the same name */
+      X509_NAME *first = rdn.getX509Name();
+      X509_NAME *second = rdn.getX509Name();
+      ASSERT_EQ(X509_NAME_cmp(first, second), 0);
+      RDNSequence decoded(second);
+      ASSERT_TRUE(decoded == rdn);
+      X509_NAME_free(first);
+      X509_NAME_free(second);
+    }
+
+    /**
+     * @brief Tests that the values of an X509_NAME are written in UTF-8 whatever their string type
+     */
+    void testWriteUtf8() {
+      const unsigned char bmp[] = { 0x00, 0xc9, 0x00, 'c', 0x00, 'o', 0x00, 'l', 0x00, 'e' };
+      const unsigned char latin1[] = { 0xc9, 'c', 'o', 'l', 'e' };
+      std::ostringstream stream;
+      JsonWriter writer(stream);
+      X509_NAME *name = X509_NAME_new();
+
+      X509_NAME_add_entry_by_NID(name, NID_commonName, V_ASN1_BMPSTRING, (unsigned char *) bmp, sizeof(bmp), -1, 0);
+      X509_NAME_add_entry_by_NID(name, NID_organizationName, V_ASN1_T61STRING, (unsigned char *) latin1, sizeof(latin1), -1, 0);
+      X509_NAME_add_entry_by_txt(name, "1.2.3.4", V_ASN1_UTF8STRING, (const unsigned char *) "x", 1, -1, 0);
+      RDNSequence::write(writer, "subject", name);
+      X509_NAME_free(name);
+
+      ASSERT_EQ(stream.str(), "{\"subject\":[{\"type\":\"commonName\",\"value\":\"\xc3\x89" "cole\"},"
+          "{\"type\":\"organizationName\",\"value\":\"\xc3\x89" "cole\"},{\"type\":\"1.2.3.4\",\"value\":\"x\"}]}");
+    }
+
     static std::vector<std::string> data;
     static std::vector<std::string> dataVector;
     static std::vector<std::string> entryNames;
@@ -142,3 +254,19 @@ TEST_F(RDNSequenceTest, XMLEncoded) {
 TEST_F(RDNSequenceTest, Sanity) {
   testSanity();
 }
+
+TEST_F(RDNSequenceTest, Hash) {
+  testHash();
+}
+
+TEST_F(RDNSequenceTest, Equality) {
+  testEquality();
+}
+
+TEST_F(RDNSequenceTest, CachedEncoding) {
+  testCachedEncoding();
+}
+
+TEST_F(RDNSequenceTest, WriteUtf8) {
+  testWriteUtf8();
+}
@@ -0,0 +1,133 @@
+#include <libcryptosec/RSAKeyPair.h>
+#include <libcryptosec/Signer.h>
+#include <libcryptosec/MessageDigest.h>
+
+#include <openssl/rsa.h>
+#include <sstream>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe RSAKeyPair
+ */
+class RSAKeyPairTest : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        MessageDigest::loadMessageDigestAlgorithms();
+    }
+
+    virtual void TearDown() {
+    }
+
+    /**
+     * @brief Checks the key consistency, its size, its number of primes and that it signs
+     */
+    void checkKeyPair(KeyPair &keyPair, int length, int primes) {
+        const RSA *rsa = EVP_PKEY_get0_RSA(keyPair.getEvpPkey());
+        ASSERT_TRUE(rsa);
+        ASSERT_EQ(RSA_check_key(rsa), 1);
+        ASSERT_EQ(keyPair.getSizeBits(), length);
+        ASSERT_EQ(RSA_get_multi_prime_extra_count(rsa) + 2, primes);
+
+        PrivateKey *privKey = keyPair.getPrivateKey();
+        PublicKey *pubKey = keyPair.getPublicKey();
+        MessageDigest md(MessageDigest::SHA256);
+        ByteArray hash = md.doFinal(data);
+        ByteArray signature = Signer::sign(*privKey, hash, MessageDigest::SHA256);
+        ASSERT_TRUE(Signer::verify(*pubKey, signature, hash, MessageDigest::SHA256));
+        delete privKey;
+        delete pubKey;
+    }
+
+    /**
+     * @brief Tests the generation of a key with the given parameters
+     */
+    void testGenerate(int length, int primes, RSAKeyPair::GenerationMode mode) {
+        RSAKeyPair keyPair(length, primes, mode);
+        ASSERT_EQ(keyPair.getPrimesNumber(), primes);
+        checkKeyPair(keyPair, length, primes);
+    }
+
+    /**
+     * @brief Tests the generation through the generic KeyPair constructor
+     */
+    void testGenerateKeyPair(int length, int primes, bool parallel) {
+        KeyPair keyPair(AsymmetricKey::RSA, length, primes, parallel);
+        ASSERT_EQ(keyPair.getAlgorithm(), AsymmetricKey::RSA);
+        checkKeyPair(keyPair, length, primes);
+    }
+
+    /**
+     * @brief Tests that an unsupported number of primes is rejected
+     */
+    void testInvalidPrimes() {
+        ASSERT_THROW(RSAKeyPair(1024, 1, RSAKeyPair::PARALLEL), AsymmetricKeyException);
+        ASSERT_THROW(RSAKeyPair(1023, 3, RSAKeyPair::PARALLEL), AsymmetricKeyException);
+        ASSERT_THROW(RSAKeyPair(2048, 4, RSAKeyPair::SEQUENTIAL), AsymmetricKeyException);
+        ASSERT_THROW(RSAKeyPair(4096, 5, RSAKeyPair::SEQUENTIAL), AsymmetricKeyException);
+    }
+
+    /**
+     * @brief Tests that the generic constructor only accepts RSA
+     */
+    void testKeyPairInvalidAlgorithm() {
+        ASSERT_THROW(KeyPair(AsymmetricKey::DSA, 1024, 2, true), AsymmetricKeyException);
+    }
+
+    /**
+     * @brief Tests the maximum number of primes for each key length
+     */
+    void testMaxPrimesNumber() {
+        ASSERT_EQ(RSAKeyPair::getMaxPrimesNumber(512), 2);
+        ASSERT_EQ(RSAKeyPair::getMaxPrimesNumber(1024), 3);
+        ASSERT_EQ(RSAKeyPair::getMaxPrimesNumber(2048), 3);
+        ASSERT_EQ(RSAKeyPair::getMaxPrimesNumber(4096), 4);
+    }
+
+    static std::string data;
+};
+
+/*
+ * Initialization of variables used in the tests
+ */
+std::string RSAKeyPairTest::data = "Arbitrary data to be signed";
+
+TEST_F(RSAKeyPairTest, GenerateSequential) {
+  testGenerate(1024, 2, RSAKeyPair::SEQUENTIAL);
+}
+
+TEST_F(RSAKeyPairTest, GenerateParallel) {
+  testGenerate(1024, 2, RSAKeyPair::PARALLEL);
+}
+
+TEST_F(RSAKeyPairTest, GenerateParallelOddLength) {
+  testGenerate(1023, 2, RSAKeyPair::PARALLEL);
+}
+
+TEST_F(RSAKeyPairTest, GenerateMultiPrimeSequential) {
+  testGenerate(2048, 3, RSAKeyPair::SEQUENTIAL);
+}
+
+TEST_F(RSAKeyPairTest, GenerateMultiPrimeParallel) {
+  testGenerate(2048, 3, RSAKeyPair::PARALLEL);
+}
+
+TEST_F(RSAKeyPairTest, GenerateFourPrimesParallel) {
+  testGenerate(4096, 4, RSAKeyPair::PARALLEL);
+}
+
+TEST_F(RSAKeyPairTest, GenerateKeyPair) {
+  testGenerateKeyPair(2048, 3, true);
+}
+
+TEST_F(RSAKeyPairTest, InvalidPrimes) {
+  testInvalidPrimes();
+}
+
+TEST_F(RSAKeyPairTest, KeyPairInvalidAlgorithm) {
+  testKeyPairInvalidAlgorithm();
+}
+
+TEST_F(RSAKeyPairTest, MaxPrimesNumber) {
+  testMaxPrimesNumber();
+}
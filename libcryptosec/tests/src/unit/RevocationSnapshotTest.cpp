@@ -0,0 +1,231 @@
+#include <libcryptosec/certificate/RevocationSnapshot.h>
+
+#include <openssl/ec.h>
+#include <fstream>
+#include <stdlib.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe RevocationSnapshot
+ */
+class RevocationSnapshotTest : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        X509_CRL *x509Crl = X509_CRL_new();
+        X509_NAME *name = X509_NAME_new();
+        ASN1_TIME *date = ASN1_TIME_set(NULL, revocationDate);
+        ASN1_TIME *next = ASN1_TIME_set(NULL, nextUpdate);
+        char path[] = "/tmp/revocationSnapshotTestXXXXXX";
+
+        key = generateKey();
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *) "Snapshot CA", -1, -1, 0);
+        X509_CRL_set_version(x509Crl, 1);
+        X509_CRL_set_issuer_name(x509Crl, name);
+        X509_CRL_set1_lastUpdate(x509Crl, date);
+        X509_CRL_set1_nextUpdate(x509Crl, next);
+        for (long i = 0; i < entries; i++) {
+            X509_REVOKED *revoked = X509_REVOKED_new();
+            ASN1_INTEGER *serial = ASN1_INTEGER_new();
+            ASN1_ENUMERATED *reason = ASN1_ENUMERATED_new();
+            ASN1_INTEGER_set(serial, i * 3 + 1);
+            X509_REVOKED_set_serialNumber(revoked, serial);
+            X509_REVOKED_set_revocationDate(revoked, date);
+            ASN1_ENUMERATED_set(reason, RevokedCertificate::SUPER_SEDED);
+            X509_REVOKED_add1_ext_i2d(revoked, NID_crl_reason, reason, 0, 0);
+            ASN1_INTEGER_free(serial);
+            ASN1_ENUMERATED_free(reason);
+            X509_CRL_add0_revoked(x509Crl, revoked);
+        }
+        /* a large serial, wider than the others */
+        X509_REVOKED *revoked = X509_REVOKED_new();
+        BigInteger large(largeSerial);
+        ASN1_INTEGER *serial = large.getASN1Value();
+        X509_REVOKED_set_serialNumber(revoked, serial);
+        X509_REVOKED_set_revocationDate(revoked, date);
+        ASN1_INTEGER_free(serial);
+        X509_CRL_add0_revoked(x509Crl, revoked);
+
+        X509_CRL_sign(x509Crl, key, EVP_sha256());
+        ASN1_TIME_free(date);
+        ASN1_TIME_free(next);
+        X509_NAME_free(name);
+        crl = new CertificateRevocationList(x509Crl);
+
+        close(mkstemp(path));
+        snapshotPath = path;
+    }
+
+    virtual void TearDown() {
+        unlink(snapshotPath.c_str());
+        delete crl;
+        EVP_PKEY_free(key);
+    }
+
+    static EVP_PKEY* generateKey() {
+        EC_KEY *eckey = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+        EVP_PKEY *ret = EVP_PKEY_new();
+        EC_KEY_generate_key(eckey);
+        EVP_PKEY_assign_EC_KEY(ret, eckey);
+        return ret;
+    }
+
+    void writeSnapshot(unsigned int bloomBitsPerEntry) {
+        std::ofstream out(snapshotPath.c_str(), std::ios::out | std::ios::binary);
+        EVP_PKEY_up_ref(key);
+        PrivateKey privateKey(key);
+        RevocationSnapshot::write(*crl, privateKey, out, bloomBitsPerEntry);
+    }
+
+    void checkLookups(RevocationSnapshot &snapshot) {
+        ASSERT_EQ(snapshot.getCount(), (unsigned long) entries + 1);
+        for (long i = 0; i < entries * 3 + 3; i++) {
+            ASSERT_EQ(snapshot.isRevoked(BigInteger(i)), i % 3 == 1 && i < entries * 3);
+        }
+        ASSERT_TRUE(snapshot.isRevoked(BigInteger(largeSerial)));
+        ASSERT_FALSE(snapshot.isRevoked(BigInteger(-1L)));
+        ASSERT_FALSE(snapshot.isRevoked(BigInteger(largeSerial + "0")));
+    }
+
+    /**
+     * @brief Tests writing and opening a snapshot without a Bloom filter
+     */
+    void testWriteAndOpen() {
+        writeSnapshot(0);
+        EVP_PKEY_up_ref(key);
+        PublicKey publicKey(key);
+        ByteArray hash = RevocationSnapshot::getCrlHash(*crl);
+        RevocationSnapshot snapshot(snapshotPath, publicKey, hash);
+
+        ASSERT_FALSE(snapshot.hasBloomFilter());
+        ASSERT_EQ(snapshot.getThisUpdate(), revocationDate);
+        ASSERT_EQ(snapshot.getNextUpdate(), nextUpdate);
+        ASSERT_TRUE(snapshot.getCrlHash() == hash);
+        checkLookups(snapshot);
+    }
+
+    /**
+     * @brief Tests lookups through the Bloom filter
+     */
+    void testBloomFilter() {
+        writeSnapshot(10);
+        EVP_PKEY_up_ref(key);
+        PublicKey publicKey(key);
+        ByteArray hash = RevocationSnapshot::getCrlHash(*crl);
+        RevocationSnapshot snapshot(snapshotPath, publicKey, hash);
+
+        ASSERT_TRUE(snapshot.hasBloomFilter());
+        checkLookups(snapshot);
+    }
+
+    /**
+     * @brief Tests getting the entry of a revoked serial number
+     */
+    void testGetRevocation() {
+        writeSnapshot(8);
+        EVP_PKEY_up_ref(key);
+        PublicKey publicKey(key);
+        ByteArray hash = RevocationSnapshot::getCrlHash(*crl);
+        RevocationSnapshot snapshot(snapshotPath, publicKey, hash);
+        RevokedCertificate *rev = snapshot.getRevocation(BigInteger(7L));
+
+        ASSERT_TRUE(rev);
+        ASSERT_EQ(rev->getCertificateSerialNumber(), 7);
+        ASSERT_EQ(rev->getRevocationDate().getDateTime(), revocationDate);
+        ASSERT_EQ(rev->getReasonCode(), RevokedCertificate::SUPER_SEDED);
+        delete rev;
+
+        rev = snapshot.getRevocation(BigInteger(largeSerial));
+        ASSERT_TRUE(rev);
+        ASSERT_EQ(rev->getReasonCode(), RevokedCertificate::UNSPECIFIED);
+        delete rev;
+
+        ASSERT_EQ(snapshot.getRevocation(BigInteger(8L)), (RevokedCertificate *) NULL);
+    }
+
+    /**
+     * @brief Tests that the header signature and the source CRL hash are checked
+     */
+    void testValidation() {
+        writeSnapshot(0);
+        PublicKey wrongKey(generateKey());
+        EVP_PKEY_up_ref(key);
+        PublicKey publicKey(key);
+        ByteArray hash = RevocationSnapshot::getCrlHash(*crl);
+        ByteArray otherHash = hash;
+        otherHash.getDataPointer()[0] ^= 1;
+
+        ASSERT_THROW(RevocationSnapshot snapshot(snapshotPath, wrongKey, hash), CertificationException);
+        ASSERT_THROW(RevocationSnapshot snapshot(snapshotPath, publicKey, otherHash), CertificationException);
+        ASSERT_THROW(RevocationSnapshot snapshot("/nonexistent/snapshot", publicKey, hash), EncodeException);
+    }
+
+    /**
+     * @brief Tests opening changed and truncated files
+     */
+    void testCorrupted() {
+        writeSnapshot(0);
+        EVP_PKEY_up_ref(key);
+        PublicKey publicKey(key);
+        ByteArray hash = RevocationSnapshot::getCrlHash(*crl);
+        std::string contents;
+        {
+            std::ifstream in(snapshotPath.c_str(), std::ios::in | std::ios::binary);
+            contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+
+        {
+            std::string changed = contents;
+            changed[changed.size() - 2] ^= 1;
+            std::ofstream out(snapshotPath.c_str(), std::ios::out | std::ios::binary);
+            out << changed;
+        }
+        ASSERT_THROW(RevocationSnapshot snapshot(snapshotPath, publicKey, hash), CertificationException);
+
+        {
+            std::ofstream out(snapshotPath.c_str(), std::ios::out | std::ios::binary);
+            out << contents.substr(0, contents.size() - 1);
+        }
+        ASSERT_THROW(RevocationSnapshot snapshot(snapshotPath, publicKey, hash), EncodeException);
+
+        {
+            std::ofstream out(snapshotPath.c_str(), std::ios::out | std::ios::binary);
+            out << "not a snapshot";
+        }
+        ASSERT_THROW(RevocationSnapshot snapshot(snapshotPath, publicKey, hash), EncodeException);
+    }
+
+    static const long entries = 5000;
+    static const time_t revocationDate = 1487889918;
+    static const time_t nextUpdate = 1665096307;
+    static std::string largeSerial;
+
+    EVP_PKEY *key;
+    CertificateRevocationList *crl;
+    std::string snapshotPath;
+};
+
+const time_t RevocationSnapshotTest::revocationDate;
+const time_t RevocationSnapshotTest::nextUpdate;
+std::string RevocationSnapshotTest::largeSerial = "730750818665451459101842416358141509827966271488";
+
+TEST_F(RevocationSnapshotTest, WriteAndOpen) {
+    testWriteAndOpen();
+}
+
+TEST_F(RevocationSnapshotTest, BloomFilter) {
+    testBloomFilter();
+}
+
+TEST_F(RevocationSnapshotTest, GetRevocation) {
+    testGetRevocation();
+}
+
+TEST_F(RevocationSnapshotTest, Validation) {
+    testValidation();
+}
+
+TEST_F(RevocationSnapshotTest, Corrupted) {
+    testCorrupted();
+}
@@ -0,0 +1,333 @@
+#include <libcryptosec/certificate/RevocationState.h>
+
+#include <openssl/ec.h>
+#include <thread>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe RevocationState
+ */
+class RevocationStateTest : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+        EC_KEY *eckey = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+        key = EVP_PKEY_new();
+        EC_KEY_generate_key(eckey);
+        EVP_PKEY_assign_EC_KEY(key, eckey);
+        EVP_PKEY_up_ref(key);
+        publicKey = new PublicKey(key);
+    }
+
+    virtual void TearDown() {
+        delete publicKey;
+        EVP_PKEY_free(key);
+    }
+
+    /* reason < 0 leaves the entry without the reasonCode extension */
+    static void addRevoked(X509_CRL *x509Crl, long serialNumber, time_t date, int reason) {
+        X509_REVOKED *revoked = X509_REVOKED_new();
+        ASN1_INTEGER *serial = ASN1_INTEGER_new();
+        ASN1_TIME *time = ASN1_TIME_set(NULL, date);
+        ASN1_INTEGER_set(serial, serialNumber);
+        X509_REVOKED_set_serialNumber(revoked, serial);
+        X509_REVOKED_set_revocationDate(revoked, time);
+        if (reason >= 0) {
+            ASN1_ENUMERATED *code = ASN1_ENUMERATED_new();
+            ASN1_ENUMERATED_set(code, reason);
+            X509_REVOKED_add1_ext_i2d(revoked, NID_crl_reason, code, 0, 0);
+            ASN1_ENUMERATED_free(code);
+        }
+        ASN1_INTEGER_free(serial);
+        ASN1_TIME_free(time);
+        X509_CRL_add0_revoked(x509Crl, revoked);
+    }
+
+    /* baseNumber < 0 creates a complete CRL */
+    X509_CRL* newCrl(const char *issuer, long number, long baseNumber, time_t thisUpdate) {
+        X509_CRL *x509Crl = X509_CRL_new();
+        X509_NAME *name = X509_NAME_new();
+        ASN1_TIME *time = ASN1_TIME_set(NULL, thisUpdate);
+        ASN1_TIME *next = ASN1_TIME_set(NULL, thisUpdate + 3600);
+        ASN1_INTEGER *value = ASN1_INTEGER_new();
+
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *) issuer, -1, -1, 0);
+        X509_CRL_set_version(x509Crl, 1);
+        X509_CRL_set_issuer_name(x509Crl, name);
+        X509_CRL_set1_lastUpdate(x509Crl, time);
+        X509_CRL_set1_nextUpdate(x509Crl, next);
+        ASN1_INTEGER_set(value, number);
+        X509_CRL_add1_ext_i2d(x509Crl, NID_crl_number, value, 0, 0);
+        if (baseNumber >= 0) {
+            ASN1_INTEGER_set(value, baseNumber);
+            X509_CRL_add1_ext_i2d(x509Crl, NID_delta_crl, value, 1, 0);
+        }
+        ASN1_INTEGER_free(value);
+        ASN1_TIME_free(time);
+        ASN1_TIME_free(next);
+        X509_NAME_free(name);
+        return x509Crl;
+    }
+
+    CertificateRevocationList* sign(X509_CRL *x509Crl) {
+        X509_CRL_sort(x509Crl);
+        X509_CRL_sign(x509Crl, key, EVP_sha256());
+        return new CertificateRevocationList(x509Crl);
+    }
+
+    /* base CRL number 10 with serials 1, 3, 5, ..., 2 * entries - 1 */
+    CertificateRevocationList* newBase() {
+        X509_CRL *x509Crl = newCrl("State CA", 10, -1, thisUpdate);
+        for (long i = 0; i < entries; i++) {
+            addRevoked(x509Crl, i * 2 + 1, revocationDate, RevokedCertificate::KEY_COMPROMISE);
+        }
+        return sign(x509Crl);
+    }
+
+    /**
+     * @brief Tests the state built from a complete CRL
+     */
+    void testBase() {
+        CertificateRevocationList *base = newBase();
+        RevocationState state(*base, *publicKey);
+        delete base;
+
+        ASSERT_EQ(state.size(), (unsigned long) entries);
+        ASSERT_EQ(state.getGeneration(), 0UL);
+        ASSERT_TRUE(state.getCrlNumber() == 10);
+        ASSERT_EQ(state.getThisUpdate(), thisUpdate);
+        ASSERT_EQ(state.getNextUpdate(), thisUpdate + 3600);
+        for (long i = 0; i < entries * 2 + 2; i++) {
+            ASSERT_EQ(state.isRevoked(BigInteger(i)), i % 2 == 1 && i < entries * 2);
+        }
+        ASSERT_FALSE(state.isRevoked(BigInteger(-1L)));
+
+        RevokedCertificate *rev = state.getRevocation(BigInteger(7L));
+        ASSERT_TRUE(rev);
+        ASSERT_EQ(rev->getCertificateSerialNumber(), 7);
+        ASSERT_EQ(rev->getRevocationDate().getDateTime(), revocationDate);
+        ASSERT_EQ(rev->getReasonCode(), RevokedCertificate::KEY_COMPROMISE);
+        delete rev;
+        ASSERT_EQ(state.getRevocation(BigInteger(8L)), (RevokedCertificate *) NULL);
+    }
+
+    /**
+     * @brief Tests additions, replacements and removals made by delta CRLs
+     */
+    void testApplyDelta() {
+        CertificateRevocationList *base = newBase();
+        RevocationState state(*base, *publicKey);
+        delete base;
+
+        X509_CRL *x509Crl = newCrl("State CA", 11, 10, thisUpdate + 60);
+        addRevoked(x509Crl, 2, thisUpdate + 30, RevokedCertificate::SUPER_SEDED);
+        addRevoked(x509Crl, 3, thisUpdate + 30, RevokedCertificate::CA_COMPROMISE);
+        addRevoked(x509Crl, 5, thisUpdate + 30, removeFromCRL);
+        addRevoked(x509Crl, 100000, thisUpdate + 30, -1);
+        CertificateRevocationList *delta = sign(x509Crl);
+        state.applyDelta(*delta);
+        delete delta;
+
+        ASSERT_EQ(state.getGeneration(), 1UL);
+        ASSERT_TRUE(state.getCrlNumber() == 11);
+        ASSERT_EQ(state.getThisUpdate(), thisUpdate + 60);
+        ASSERT_EQ(state.size(), (unsigned long) entries + 1);
+        ASSERT_TRUE(state.isRevoked(BigInteger(1L)));
+        ASSERT_TRUE(state.isRevoked(BigInteger(2L)));
+        ASSERT_FALSE(state.isRevoked(BigInteger(5L)));
+        ASSERT_TRUE(state.isRevoked(BigInteger(100000L)));
+
+        RevokedCertificate *rev = state.getRevocation(BigInteger(3L));
+        ASSERT_TRUE(rev);
+        ASSERT_EQ(rev->getRevocationDate().getDateTime(), thisUpdate + 30);
+        ASSERT_EQ(rev->getReasonCode(), RevokedCertificate::CA_COMPROMISE);
+        delete rev;
+
+        /* a later delta against the same base also carries the earlier changes */
+        x509Crl = newCrl("State CA", 12, 10, thisUpdate + 120);
+        addRevoked(x509Crl, 2, thisUpdate + 30, RevokedCertificate::SUPER_SEDED);
+        addRevoked(x509Crl, 3, thisUpdate + 30, RevokedCertificate::CA_COMPROMISE);
+        addRevoked(x509Crl, 5, thisUpdate + 30, removeFromCRL);
+        addRevoked(x509Crl, 7, thisUpdate + 90, removeFromCRL);
+        addRevoked(x509Crl, 100000, thisUpdate + 30, -1);
+        delta = sign(x509Crl);
+        state.applyDelta(*delta);
+        delete delta;
+
+        ASSERT_EQ(state.getGeneration(), 2UL);
+        ASSERT_EQ(state.size(), (unsigned long) entries);
+        ASSERT_TRUE(state.isRevoked(BigInteger(2L)));
+        ASSERT_FALSE(state.isRevoked(BigInteger(5L)));
+        ASSERT_FALSE(state.isRevoked(BigInteger(7L)));
+        ASSERT_TRUE(state.isRevoked(BigInteger(9L)));
+    }
+
+    /**
+     * @brief Tests that reasons numbered differently in RFC 5280 and ReasonCode keep the serial revoked
+     */
+    void testReasonCodes() {
+        CertificateRevocationList *base = newBase();
+        RevocationState state(*base, *publicKey);
+        delete base;
+
+        X509_CRL *x509Crl = newCrl("State CA", 11, 10, thisUpdate + 60);
+        BigInteger serial(5L);
+        DateTime date(thisUpdate + 30);
+        RevokedCertificate revoked;
+        revoked.setCertificateSerialNumber(serial);
+        revoked.setRevocationDate(date);
+        revoked.setReasonCode(RevokedCertificate::AACOMPROMISE);
+        X509_CRL_add0_revoked(x509Crl, revoked.getX509Revoked());
+        addRevoked(x509Crl, 7, thisUpdate + 30, CRL_REASON_PRIVILEGE_WITHDRAWN);
+        CertificateRevocationList *delta = sign(x509Crl);
+        state.applyDelta(*delta);
+        delete delta;
+
+        ASSERT_EQ(state.size(), (unsigned long) entries);
+        ASSERT_TRUE(state.isRevoked(BigInteger(5L)));
+        ASSERT_TRUE(state.isRevoked(BigInteger(7L)));
+
+        RevokedCertificate *rev = state.getRevocation(BigInteger(5L));
+        ASSERT_TRUE(rev);
+        ASSERT_EQ(rev->getReasonCode(), RevokedCertificate::AACOMPROMISE);
+        delete rev;
+        rev = state.getRevocation(BigInteger(7L));
+        ASSERT_TRUE(rev);
+        ASSERT_EQ(rev->getReasonCode(), RevokedCertificate::PRIVILEGE_WITH_DRAWN);
+        delete rev;
+    }
+
+    /**
+     * @brief Tests that CRLs that do not apply to the state are rejected
+     */
+    void testRejected() {
+        CertificateRevocationList *base = newBase();
+        RevocationState state(*base, *publicKey);
+
+        /* a delta cannot be the base */
+        CertificateRevocationList *delta = sign(newCrl("State CA", 11, 10, thisUpdate));
+        ASSERT_THROW(RevocationState other(*delta, *publicKey), CertificationException);
+        delete delta;
+
+        /* not a delta */
+        ASSERT_THROW(state.applyDelta(*base), CertificationException);
+        delete base;
+
+        /* another issuer */
+        delta = sign(newCrl("Other CA", 11, 10, thisUpdate));
+        ASSERT_THROW(state.applyDelta(*delta), CertificationException);
+        delete delta;
+
+        /* a base newer than the state */
+        delta = sign(newCrl("State CA", 12, 11, thisUpdate));
+        ASSERT_THROW(state.applyDelta(*delta), CertificationException);
+        delete delta;
+
+        /* not newer than the state */
+        delta = sign(newCrl("State CA", 10, 9, thisUpdate));
+        ASSERT_THROW(state.applyDelta(*delta), CertificationException);
+        delete delta;
+
+        /* signed by another key */
+        EC_KEY *eckey = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+        EVP_PKEY *otherKey = EVP_PKEY_new();
+        EC_KEY_generate_key(eckey);
+        EVP_PKEY_assign_EC_KEY(otherKey, eckey);
+        PublicKey otherPublicKey(otherKey);
+        X509_CRL *x509Crl = newCrl("State CA", 11, 10, thisUpdate);
+        X509_CRL_sign(x509Crl, otherKey, EVP_sha256());
+        delta = new CertificateRevocationList(x509Crl);
+        ASSERT_THROW(state.applyDelta(*delta), CertificationException);
+        delete delta;
+        base = newBase();
+        ASSERT_THROW(RevocationState other(*base, otherPublicKey), CertificationException);
+        delete base;
+
+        ASSERT_EQ(state.getGeneration(), 0UL);
+        ASSERT_TRUE(state.getCrlNumber() == 10);
+
+        delta = sign(newCrl("State CA", 11, 10, thisUpdate));
+        state.applyDelta(*delta);
+        ASSERT_THROW(state.applyDelta(*delta), CertificationException);
+        delete delta;
+        ASSERT_EQ(state.getGeneration(), 1UL);
+    }
+
+    /**
+     * @brief Tests lookups from several threads while deltas are applied
+     */
+    void testConcurrentLookups() {
+        CertificateRevocationList *base = newBase();
+        RevocationState state(*base, *publicKey);
+        std::vector<CertificateRevocationList *> deltas;
+        std::vector<std::thread> readers;
+        std::vector<int> failures(4, 0);
+        delete base;
+
+        /* each delta adds an even serial; odd serials never change */
+        for (long i = 0; i < 20; i++) {
+            X509_CRL *x509Crl = newCrl("State CA", 11 + i, 10, thisUpdate + i);
+            for (long j = 0; j <= i; j++) {
+                addRevoked(x509Crl, j * 2, thisUpdate, -1);
+            }
+            deltas.push_back(sign(x509Crl));
+        }
+
+        for (int i = 0; i < 4; i++) {
+            readers.push_back(std::thread([&state, &failures, i]() {
+                for (long j = 0; j < 5000; j++) {
+                    long serial = (j % entries) * 2 + 1;
+                    if (!state.isRevoked(BigInteger(serial))) {
+                        failures[i]++;
+                    }
+                }
+            }));
+        }
+        for (unsigned int i = 0; i < deltas.size(); i++) {
+            state.applyDelta(*deltas[i]);
+            delete deltas[i];
+        }
+        for (unsigned int i = 0; i < readers.size(); i++) {
+            readers[i].join();
+        }
+
+        for (unsigned int i = 0; i < failures.size(); i++) {
+            ASSERT_EQ(failures[i], 0);
+        }
+        ASSERT_EQ(state.getGeneration(), 20UL);
+        ASSERT_EQ(state.size(), (unsigned long) entries + 20);
+        ASSERT_TRUE(state.isRevoked(BigInteger(38L)));
+    }
+
+    static const long entries = 1000;
+    static const int removeFromCRL = CRL_REASON_REMOVE_FROM_CRL;
+    static const time_t thisUpdate = 1487889918;
+    static const time_t revocationDate = 1487800000;
+
+    EVP_PKEY *key;
+    PublicKey *publicKey;
+};
+
+const long RevocationStateTest::entries;
+const time_t RevocationStateTest::thisUpdate;
+const time_t RevocationStateTest::revocationDate;
+
+TEST_F(RevocationStateTest, Base) {
+    testBase();
+}
+
+TEST_F(RevocationStateTest, ApplyDelta) {
+    testApplyDelta();
+}
+
+TEST_F(RevocationStateTest, ReasonCodes) {
+    testReasonCodes();
+}
+
+TEST_F(RevocationStateTest, Rejected) {
+    testRejected();
+}
+
+TEST_F(RevocationStateTest, ConcurrentLookups) {
+    testConcurrentLookups();
+}
@@ -92,6 +92,22 @@ protected:
         }
     }
 
+    void checkCrlReason()
+    {
+        long values[] = {0, 1, 2, 3, 4, 5, 6, 9, 10};
+
+        for (int i = 0; i < 9; i++)
+        {
+            RevokedCertificate::ReasonCode reason = (RevokedCertificate::ReasonCode) i;
+
+            ASSERT_EQ(RevokedCertificate::toCrlReason(reason), values[i]);
+            ASSERT_EQ(RevokedCertificate::fromCrlReason(values[i]), reason);
+        }
+        ASSERT_EQ(RevokedCertificate::fromCrlReason(7), RevokedCertificate::UNSPECIFIED);
+        ASSERT_EQ(RevokedCertificate::fromCrlReason(CRL_REASON_REMOVE_FROM_CRL), RevokedCertificate::UNSPECIFIED);
+        ASSERT_EQ(RevokedCertificate::fromCrlReason(11), RevokedCertificate::UNSPECIFIED);
+    }
+
     RevokedCertificate *revoked;
 
     static std::string serialHex;
@@ -181,4 +197,11 @@ TEST_F(RevokedCertificateTest, FromX509Null) {
  */
 TEST_F(RevokedCertificateTest, ReasonCode2Name) {
     checkReasonCode2Name();
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Tests the translation between ReasonCode and the RFC 5280 CRLReason values
+ */
+TEST_F(RevokedCertificateTest, CrlReason) {
+    checkCrlReason();
+}
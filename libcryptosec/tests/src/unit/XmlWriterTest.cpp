@@ -0,0 +1,126 @@
+#include <libcryptosec/certificate/XmlWriter.h>
+#include <libcryptosec/exception/EncodeException.h>
+
+#include <sstream>
+#include <gtest/gtest.h>
+
+/**
+ * @brief Testes unitários da classe XmlWriter
+ */
+class XmlWriterTest : public ::testing::Test {
+
+protected:
+    virtual void SetUp() {
+    }
+
+    virtual void TearDown() {
+    }
+
+    /**
+     * @brief Tests the elements written for structures, lists and fields
+     */
+    void testStructure() {
+        std::ostringstream stream;
+        XmlWriter writer(stream);
+        unsigned char data[] = { 0x01, 0x02, 0x03 };
+
+        writer.begin("root");
+        writer.write("text", "value");
+        writer.write("number", -42L);
+        writer.write("flag", true);
+        writer.writeBase64("data", data, sizeof(data));
+        writer.writeTime("time", (time_t) 1487889907);
+        writer.beginList("items");
+        writer.write("item", std::string("a"));
+        writer.begin("entry");
+        writer.write("flag", false);
+        writer.end();
+        writer.end();
+        writer.end();
+
+        ASSERT_EQ(stream.str(),
+                "<?xml version=\"1.0\"?>\n"
+                "<root>\n"
+                "\t<text>value</text>\n"
+                "\t<number>-42</number>\n"
+                "\t<flag>true</flag>\n"
+                "\t<data>AQID</data>\n"
+                "\t<time>2017-02-23T22:45:07Z</time>\n"
+                "\t<items>\n"
+                "\t\t<item>a</item>\n"
+                "\t\t<entry>\n"
+                "\t\t\t<flag>false</flag>\n"
+                "\t\t</entry>\n"
+                "\t</items>\n"
+                "</root>\n");
+    }
+
+    /**
+     * @brief Tests escaping the characters that would break the document
+     */
+    void testEscape() {
+        std::ostringstream stream;
+        XmlWriter writer(stream, false);
+
+        writer.begin("root");
+        writer.write("value", "<a href=\"x\">&amp;</a>");
+        writer.end();
+
+        ASSERT_EQ(stream.str(), "<root>\n\t<value>&lt;a href=\"x\"&gt;&amp;amp;&lt;/a&gt;</value>\n</root>\n");
+    }
+
+    /**
+     * @brief Tests that control characters XML 1.0 cannot represent are rejected before the field is written
+     */
+    void testControl() {
+        std::ostringstream stream;
+        XmlWriter writer(stream, false);
+
+        writer.begin("root");
+        writer.write("value", "a\tb\r\nc");
+        ASSERT_THROW(writer.write("value", std::string("a\0b", 3)), EncodeException);
+        ASSERT_THROW(writer.write("value", "a\x1b[0m"), EncodeException);
+        writer.end();
+
+        ASSERT_EQ(stream.str(), "<root>\n\t<value>a\tb&#13;\nc</value>\n</root>\n");
+    }
+
+    /**
+     * @brief Tests writing an ASN1_TIME, in UTCTime and in GeneralizedTime
+     */
+    void testTime() {
+        std::ostringstream stream;
+        XmlWriter writer(stream, false);
+        ASN1_TIME *utcTime = ASN1_TIME_set(NULL, 1487889907);
+        ASN1_TIME *generalizedTime = ASN1_TIME_set(NULL, 2556144000L);
+
+        writer.begin("root");
+        writer.writeTime("utcTime", utcTime);
+        writer.writeTime("generalizedTime", generalizedTime);
+        writer.end();
+        ASN1_TIME_free(utcTime);
+        ASN1_TIME_free(generalizedTime);
+
+        ASSERT_EQ(stream.str(),
+                "<root>\n"
+                "\t<utcTime>2017-02-23T22:45:07Z</utcTime>\n"
+                "\t<generalizedTime>2051-01-01T00:00:00Z</generalizedTime>\n"
+                "</root>\n");
+    }
+};
+
+TEST_F(XmlWriterTest, Structure) {
+    testStructure();
+}
+
+TEST_F(XmlWriterTest, Escape) {
+    testEscape();
+}
+
+TEST_F(XmlWriterTest, Time) {
+    testTime();
+}
+
+TEST_F(XmlWriterTest, Control) {
+    testControl();
+}